@@ -109,10 +109,11 @@ enum {
 	 */
 	IPC_M_CONNECT_ME_TO,
 
-	/** Share a single page over IPC.
+	/** Share one or more consecutive pages over IPC.
 	 *
 	 * - ARG1 - page-aligned offset from the beginning of the memory object
-	 * - ARG2 - page size
+	 * - ARG2 - size of the window the kernel is willing to map, at least
+	 *          one page and at most AS_AREA_PAGE_IN_MAX pages
 	 * - ARG3 - user defined memory object ID
 	 * - ARG4 - user defined memory object ID
 	 * - ARG5 - user defined memory object ID
@@ -120,6 +121,11 @@ enum {
 	 * on answer, the recipient must set:
 	 *
 	 * - ARG1 - source user page address
+	 * - ARG2 - number of consecutive source pages starting at ARG1 that
+	 *          can be mapped (zero is treated as one)
+	 *
+	 * The kernel translates the pages into physical frames in ARG1 .. ARG4
+	 * and stores the number of frames in ARG5.
 	 */
 	IPC_M_PAGE_IN,
 
@@ -70,6 +70,9 @@ typedef struct {
 	sysarg_t id3;
 } as_area_pager_info_t;
 
+/** Maximum number of pages mapped by a single IPC_M_PAGE_IN request. */
+#define AS_AREA_PAGE_IN_MAX  4
+
 #endif
 
 /** @}
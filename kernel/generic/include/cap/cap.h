@@ -38,10 +38,8 @@
 #include <abi/cap.h>
 #include <typedefs.h>
 #include <adt/list.h>
-#include <adt/hash.h>
-#include <adt/hash_table.h>
-#include <lib/ra.h>
 #include <synch/mutex.h>
+#include <synch/rcu_types.h>
 #include <atomic.h>
 
 typedef enum {
@@ -76,11 +74,17 @@ extern kobject_ops_t *kobject_ops[];
 /*
  * Everything in kobject_t except for the atomic reference count, the capability
  * list and its lock is imutable.
+ *
+ * Once published, a kobject_t may be looked up by kobject_get() without any
+ * locks held and so its storage is reclaimed only after an RCU grace period.
  */
 typedef struct kobject {
 	kobject_type_t type;
 	atomic_t refcnt;
 
+	/** Item for the deferred reclamation of the kobject */
+	rcu_item_t rcu;
+
 	/** Mutex protecting caps_list */
 	mutex_t caps_list_lock;
 	/** List of published capabilities associated with the kobject */
@@ -96,7 +100,10 @@ typedef struct kobject {
 } kobject_t;
 
 /*
- * A cap_t may only be accessed under the protection of the cap_info_t lock.
+ * A cap_t may only be modified under the protection of the cap_info_t lock.
+ * Readers within an RCU read-side critical section may only look at the
+ * handle and the kobject pointer, which is NULL unless the capability is
+ * published.
  */
 typedef struct cap {
 	cap_state_t state;
@@ -110,19 +117,26 @@ typedef struct cap {
 	/* Link to the task's capabilities of the same kobject type. */
 	link_t type_link;
 
-	ht_link_t caps_link;
+	/* Item for the deferred reclamation of the capability. */
+	rcu_item_t rcu;
 
 	/* The underlying kernel object. */
 	kobject_t *kobject;
 } cap_t;
 
+struct cap_node;
+
 typedef struct cap_info {
 	mutex_t lock;
 
 	list_t type_list[KOBJECT_TYPE_MAX];
 
-	hash_table_t caps;
-	ra_arena_t *handles;
+	/** Root of the RCU-protected radix tree of capability slots. */
+	struct cap_node *root;
+	/** Index of the first slot on the free stack plus one, or zero. */
+	uint32_t free_head;
+	/** Number of slots taken from the radix tree so far. */
+	uint32_t slots_used;
 } cap_info_t;
 
 extern void caps_init(void);
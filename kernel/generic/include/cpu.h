@@ -37,6 +37,7 @@
 
 #include <mm/tlb.h>
 #include <synch/spinlock.h>
+#include <synch/rcu_types.h>
 #include <proc/scheduler.h>
 #include <arch/cpu.h>
 #include <arch/context.h>
@@ -96,6 +97,9 @@ typedef struct cpu {
 
 	struct thread *fpu_owner;
 
+	/** RCU grace period tracking and deferred callbacks. */
+	rcu_cpu_t rcu;
+
 	/**
 	 * Stack used by scheduler when there is no running thread.
 	 */
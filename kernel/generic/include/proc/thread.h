@@ -36,6 +36,7 @@
 #define KERN_THREAD_H_
 
 #include <synch/waitq.h>
+#include <synch/rcu_types.h>
 #include <proc/task.h>
 #include <time/timeout.h>
 #include <cpu.h>
@@ -75,6 +76,10 @@ typedef struct thread {
 
 	/** Link to @c threads ordered dictionary. */
 	odlink_t lthreads;
+	/** Next thread in the same bucket of the thread ID hash table. */
+	struct thread *hash_next;
+	/** Deferred freeing of the thread structure. */
+	rcu_item_t rcu;
 
 	/** Lock protecting thread structure.
 	 *
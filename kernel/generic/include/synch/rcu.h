@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup kernel_sync
+ * @{
+ */
+/** @file
+ */
+
+#ifndef KERN_RCU_H_
+#define KERN_RCU_H_
+
+#include <preemption.h>
+#include <synch/rcu_types.h>
+
+/** Load an RCU protected pointer in a reader.
+ *
+ * The pointer may be dereferenced until rcu_read_unlock().
+ */
+#define rcu_access(ptr) \
+	__atomic_load_n(&(ptr), __ATOMIC_ACQUIRE)
+
+/** Publish a pointer to an initialized object to RCU readers. */
+#define rcu_assign(ptr, value) \
+	__atomic_store_n(&(ptr), (value), __ATOMIC_RELEASE)
+
+/** Enter an RCU read-side critical section.
+ *
+ * Read sections may nest and must not sleep. Holding a spinlock implies
+ * a read section, too.
+ */
+#define rcu_read_lock()  preemption_disable()
+
+/** Leave an RCU read-side critical section. */
+#define rcu_read_unlock()  preemption_enable()
+
+/** Check whether the caller is in an RCU read-side critical section. */
+#define rcu_read_locked()  PREEMPTION_DISABLED
+
+extern void rcu_init(void);
+extern void rcu_cpu_init(void);
+extern void rcu_reclaimers_create(void);
+extern void rcu_call(rcu_item_t *, rcu_func_t);
+extern void rcu_synchronize(void);
+extern void rcu_context_switch(void);
+extern void rcu_tick(void);
+
+#endif
+
+/** @}
+ */
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup kernel_sync
+ * @{
+ */
+/** @file
+ */
+
+#ifndef KERN_RCU_TYPES_H_
+#define KERN_RCU_TYPES_H_
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <synch/waitq.h>
+
+typedef struct rcu_item rcu_item_t;
+
+/** Callback invoked once the grace period of an rcu_call() has elapsed. */
+typedef void (*rcu_func_t)(rcu_item_t *);
+
+/** Deferred callback, usually embedded in the object it is to free. */
+struct rcu_item {
+	rcu_func_t func;
+	rcu_item_t *next;
+};
+
+/** Per-CPU RCU state.
+ *
+ * Except for @c qs_needed, the members are only accessed by the owning
+ * CPU with interrupts disabled.
+ */
+typedef struct {
+	/** Callbacks queued on this CPU but not yet taken by the reclaimer. */
+	rcu_item_t *cb_head;
+	rcu_item_t **cb_tail;
+
+	/** The reclaimer thread of this CPU sleeps here. */
+	waitq_t reclaimer_wq;
+	/** The reclaimer is (about to go) sleeping on @c reclaimer_wq. */
+	bool reclaimer_idle;
+
+	/** The current grace period waits for this CPU. */
+	atomic_bool qs_needed;
+	/** The CPU noticed @c qs_needed at a clock tick. */
+	bool gp_noticed;
+	/** The CPU has switched context since it noticed @c qs_needed. */
+	bool qs_passed;
+} rcu_cpu_t;
+
+#endif
+
+/** @}
+ */
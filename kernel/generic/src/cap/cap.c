@@ -73,12 +73,28 @@
  * kobject_get() or kobject_add_ref(). When the kernel object is removed from
  * the container, the reference count should go down via a call to
  * kobject_put().
+ *
+ * Capabilities are kept in per-task slots which form the leaves of a radix
+ * tree indexed by the handle. Each slot has a sequence number which is bumped
+ * whenever the slot gets freed and which is also encoded in the handle. This
+ * makes it unlikely that a stale handle reaches a capability which later
+ * reused the slot, but as the sequence number has only CAPS_SEQ_BITS bits,
+ * a handle repeats once the slot has been reused 2^CAPS_SEQ_BITS times. Free
+ * slots are kept on a stack so that allocation and deallocation take
+ * constant time.
+ *
+ * Nodes of the radix tree are never freed during the lifetime of the task and
+ * the capabilities and the kernel objects are reclaimed only after an RCU grace
+ * period. This lets kobject_get() translate a handle to a new reference
+ * without taking the capability info lock. All modifications still happen
+ * under the lock.
  */
 
 #include <cap/cap.h>
 #include <abi/cap.h>
 #include <proc/task.h>
 #include <synch/mutex.h>
+#include <synch/rcu.h>
 #include <abi/errno.h>
 #include <mm/slab.h>
 #include <adt/list.h>
@@ -88,12 +104,48 @@
 #include <ipc/irq.h>
 
 #include <limits.h>
+#include <mem.h>
 #include <stdint.h>
 #include <stdlib.h>
 
+/*
+ * The bits of a handle above CAPS_START are split into the slot index and the
+ * slot sequence number so that the handle still fits into an int. The sequence
+ * number thus wraps around after 2^CAPS_SEQ_BITS reuses of a slot.
+ */
+#define CAPS_INDEX_BITS	24
+#define CAPS_SEQ_BITS	6
+#define CAPS_INDEX_MASK	((1U << CAPS_INDEX_BITS) - 1)
+#define CAPS_SEQ_MASK	((1U << CAPS_SEQ_BITS) - 1)
+
 #define CAPS_START	((intptr_t) CAP_NIL + 1)
-#define CAPS_SIZE	(INT_MAX - (int) CAPS_START)
-#define CAPS_LAST	(CAPS_SIZE - 1)
+#define CAPS_SIZE	((intptr_t) 1 << (CAPS_INDEX_BITS + CAPS_SEQ_BITS))
+#define CAPS_LAST	(CAPS_START + CAPS_SIZE - 1)
+
+/* Each radix tree node resolves CAPS_RADIX_BITS bits of the slot index. */
+#define CAPS_RADIX_BITS		8
+#define CAPS_RADIX_SIZE		(1U << CAPS_RADIX_BITS)
+#define CAPS_RADIX_MASK		(CAPS_RADIX_SIZE - 1)
+#define CAPS_RADIX_LEVELS	(CAPS_INDEX_BITS / CAPS_RADIX_BITS)
+
+typedef struct {
+	/** Capability occupying the slot or NULL. */
+	cap_t *cap;
+	/** Sequence number of the slot's current or next capability. */
+	uint32_t seq;
+	/** Index of the next slot on the free stack plus one, or zero. */
+	uint32_t next_free;
+} cap_slot_t;
+
+/** Inner node of the radix tree */
+typedef struct cap_node {
+	void *children[CAPS_RADIX_SIZE];
+} cap_node_t;
+
+/** Leaf of the radix tree */
+typedef struct {
+	cap_slot_t slots[CAPS_RADIX_SIZE];
+} cap_leaf_t;
 
 static slab_cache_t *cap_cache;
 static slab_cache_t *kobject_cache;
@@ -105,31 +157,6 @@ kobject_ops_t *kobject_ops[KOBJECT_TYPE_MAX] = {
 	[KOBJECT_TYPE_WAITQ] = &waitq_kobject_ops
 };
 
-static size_t caps_hash(const ht_link_t *item)
-{
-	cap_t *cap = hash_table_get_inst(item, cap_t, caps_link);
-	return hash_mix(cap_handle_raw(cap->handle));
-}
-
-static size_t caps_key_hash(const void *key)
-{
-	const cap_handle_t *handle = key;
-	return hash_mix(cap_handle_raw(*handle));
-}
-
-static bool caps_key_equal(const void *key, const ht_link_t *item)
-{
-	const cap_handle_t *handle = key;
-	cap_t *cap = hash_table_get_inst(item, cap_t, caps_link);
-	return *handle == cap->handle;
-}
-
-static hash_table_ops_t caps_ops = {
-	.hash = caps_hash,
-	.key_hash = caps_key_hash,
-	.key_equal = caps_key_equal
-};
-
 void caps_init(void)
 {
 	cap_cache = slab_cache_create("cap_t", sizeof(cap_t), 0, NULL,
@@ -147,20 +174,23 @@ errno_t caps_task_alloc(task_t *task)
 	task->cap_info = (cap_info_t *) malloc(sizeof(cap_info_t));
 	if (!task->cap_info)
 		return ENOMEM;
-	task->cap_info->handles = ra_arena_create();
-	if (!task->cap_info->handles)
-		goto error_handles;
-	if (!ra_span_add(task->cap_info->handles, CAPS_START, CAPS_SIZE))
-		goto error_span;
-	if (!hash_table_create(&task->cap_info->caps, 0, 0, &caps_ops))
-		goto error_span;
+	task->cap_info->root = NULL;
+	task->cap_info->free_head = 0;
+	task->cap_info->slots_used = 0;
 	return EOK;
+}
 
-error_span:
-	ra_arena_destroy(task->cap_info->handles);
-error_handles:
-	free(task->cap_info);
-	return ENOMEM;
+static void cap_node_free(void *node, unsigned int level)
+{
+	if (level > 0) {
+		cap_node_t *inner = node;
+		for (unsigned int i = 0; i < CAPS_RADIX_SIZE; i++) {
+			if (inner->children[i])
+				cap_node_free(inner->children[i], level - 1);
+		}
+	}
+
+	free(node);
 }
 
 /** Initialize the capability info structure
@@ -173,6 +203,19 @@ void caps_task_init(task_t *task)
 
 	for (kobject_type_t t = 0; t < KOBJECT_TYPE_MAX; t++)
 		list_initialize(&task->cap_info->type_list[t]);
+
+	/*
+	 * A reused task structure still carries the radix tree of its previous
+	 * incarnation. No lock-free reader can be looking at it anymore, as
+	 * the structure was reclaimed only after a grace period. Start afresh
+	 * so that the first capability gets the first handle again, which the
+	 * naming service phone relies upon.
+	 */
+	if (task->cap_info->root)
+		cap_node_free(task->cap_info->root, CAPS_RADIX_LEVELS - 1);
+	task->cap_info->root = NULL;
+	task->cap_info->free_head = 0;
+	task->cap_info->slots_used = 0;
 }
 
 /** Deallocate the capability info structure
@@ -181,8 +224,12 @@ void caps_task_init(task_t *task)
  */
 void caps_task_free(task_t *task)
 {
-	hash_table_destroy(&task->cap_info->caps);
-	ra_arena_destroy(task->cap_info->handles);
+	/*
+	 * This is called only when the task structure itself is being
+	 * reclaimed, i.e. well after a grace period following task_destroy().
+	 */
+	if (task->cap_info->root)
+		cap_node_free(task->cap_info->root, CAPS_RADIX_LEVELS - 1);
 	free(task->cap_info);
 }
 
@@ -229,6 +276,107 @@ static void cap_initialize(cap_t *cap, task_t *task, cap_handle_t handle)
 	link_initialize(&cap->type_link);
 }
 
+/** Compose capability handle from slot index and sequence number */
+static cap_handle_t cap_handle_make(uint32_t idx, uint32_t seq)
+{
+	return (cap_handle_t) (CAPS_START +
+	    (((intptr_t) seq << CAPS_INDEX_BITS) | idx));
+}
+
+/** Find slot with the given index
+ *
+ * The caller must either hold the capability info lock or be in an RCU
+ * read-side critical section.
+ *
+ * @param task  Task whose slot to find.
+ * @param idx   Slot index.
+ *
+ * @return Address of the slot or NULL if it was never allocated.
+ */
+static cap_slot_t *cap_slot_find(task_t *task, uint32_t idx)
+{
+	void *node = rcu_access(task->cap_info->root);
+
+	for (unsigned int level = CAPS_RADIX_LEVELS - 1; level > 0; level--) {
+		if (!node)
+			return NULL;
+		cap_node_t *inner = node;
+		node = rcu_access(inner->children[(idx >>
+		    (level * CAPS_RADIX_BITS)) & CAPS_RADIX_MASK]);
+	}
+
+	if (!node)
+		return NULL;
+	cap_leaf_t *leaf = node;
+	return &leaf->slots[idx & CAPS_RADIX_MASK];
+}
+
+/** Find slot with the given index, creating missing radix tree nodes
+ *
+ * @param task  Task whose slot to find.
+ * @param idx   Slot index.
+ *
+ * @return Address of the slot or NULL if there is not enough memory.
+ */
+static cap_slot_t *cap_slot_create(task_t *task, uint32_t idx)
+{
+	assert(mutex_locked(&task->cap_info->lock));
+
+	void **parent = (void **) &task->cap_info->root;
+
+	for (unsigned int level = CAPS_RADIX_LEVELS; level > 0; level--) {
+		if (!*parent) {
+			size_t size = (level > 1) ? sizeof(cap_node_t) :
+			    sizeof(cap_leaf_t);
+			void *node = malloc(size);
+			if (!node)
+				return NULL;
+			memset(node, 0, size);
+			rcu_assign(*parent, node);
+		}
+
+		if (level > 1) {
+			cap_node_t *inner = *parent;
+			parent = &inner->children[(idx >>
+			    ((level - 1) * CAPS_RADIX_BITS)) & CAPS_RADIX_MASK];
+		}
+	}
+
+	cap_leaf_t *leaf = *parent;
+	return &leaf->slots[idx & CAPS_RADIX_MASK];
+}
+
+/** Look up capability using capability handle
+ *
+ * The caller must either hold the capability info lock or be in an RCU
+ * read-side critical section.
+ *
+ * @param task    Task whose capability to look up.
+ * @param handle  Capability handle.
+ *
+ * @return Address of the capability or NULL if there is none.
+ */
+static cap_t *cap_lookup(task_t *task, cap_handle_t handle)
+{
+	if ((cap_handle_raw(handle) < CAPS_START) ||
+	    (cap_handle_raw(handle) > CAPS_LAST))
+		return NULL;
+
+	uint32_t val = cap_handle_raw(handle) - CAPS_START;
+	cap_slot_t *slot = cap_slot_find(task, val & CAPS_INDEX_MASK);
+	if (!slot)
+		return NULL;
+
+	/*
+	 * The handle is immutable, so a capability with a matching handle is
+	 * the right one even if the slot is being freed concurrently.
+	 */
+	cap_t *cap = rcu_access(slot->cap);
+	if (!cap || cap->handle != handle)
+		return NULL;
+	return cap;
+}
+
 /** Get capability using capability handle
  *
  * @param task    Task whose capability to get.
@@ -242,13 +390,9 @@ static cap_t *cap_get(task_t *task, cap_handle_t handle, cap_state_t state)
 {
 	assert(mutex_locked(&task->cap_info->lock));
 
-	if ((cap_handle_raw(handle) < CAPS_START) ||
-	    (cap_handle_raw(handle) > CAPS_LAST))
-		return NULL;
-	ht_link_t *link = hash_table_find(&task->cap_info->caps, &handle);
-	if (!link)
+	cap_t *cap = cap_lookup(task, handle);
+	if (!cap)
 		return NULL;
-	cap_t *cap = hash_table_get_inst(link, cap_t, caps_link);
 	if (cap->state != state)
 		return NULL;
 	return cap;
@@ -270,16 +414,29 @@ errno_t cap_alloc(task_t *task, cap_handle_t *handle)
 		mutex_unlock(&task->cap_info->lock);
 		return ENOMEM;
 	}
-	uintptr_t hbase;
-	if (!ra_alloc(task->cap_info->handles, 1, 1, &hbase)) {
-		slab_free(cap_cache, cap);
-		mutex_unlock(&task->cap_info->lock);
-		return ENOMEM;
+	cap_info_t *info = task->cap_info;
+	uint32_t idx;
+	cap_slot_t *slot;
+	if (info->free_head) {
+		idx = info->free_head - 1;
+		slot = cap_slot_find(task, idx);
+		info->free_head = slot->next_free;
+	} else {
+		idx = info->slots_used;
+		slot = (idx <= CAPS_INDEX_MASK) ? cap_slot_create(task, idx) :
+		    NULL;
+		if (!slot) {
+			slab_free(cap_cache, cap);
+			mutex_unlock(&info->lock);
+			return ENOMEM;
+		}
+		info->slots_used++;
 	}
-	cap_initialize(cap, task, (cap_handle_t) hbase);
-	hash_table_insert(&task->cap_info->caps, &cap->caps_link);
-
+	cap_initialize(cap, task, cap_handle_make(idx, slot->seq));
+	cap->kobject = NULL;
 	cap->state = CAP_STATE_ALLOCATED;
+	rcu_assign(slot->cap, cap);
+
 	*handle = cap->handle;
 	mutex_unlock(&task->cap_info->lock);
 
@@ -305,7 +462,7 @@ cap_publish(task_t *task, cap_handle_t handle, kobject_t *kobj)
 	assert(cap);
 	cap->state = CAP_STATE_PUBLISHED;
 	/* Hand over kobj's reference to cap */
-	cap->kobject = kobj;
+	rcu_assign(cap->kobject, kobj);
 	list_append(&cap->kobj_link, &kobj->caps_list);
 	list_append(&cap->type_link, &task->cap_info->type_list[kobj->type]);
 	mutex_unlock(&task->cap_info->lock);
@@ -314,7 +471,7 @@ cap_publish(task_t *task, cap_handle_t handle, kobject_t *kobj)
 
 static void cap_unpublish_unsafe(cap_t *cap)
 {
-	cap->kobject = NULL;
+	rcu_assign(cap->kobject, NULL);
 	list_remove(&cap->kobj_link);
 	list_remove(&cap->type_link);
 	cap->state = CAP_STATE_ALLOCATED;
@@ -386,6 +543,11 @@ void cap_revoke(kobject_t *kobj)
 	mutex_unlock(&kobj->caps_list_lock);
 }
 
+static void cap_free_rcu(rcu_item_t *item)
+{
+	slab_free(cap_cache, member_to_inst(item, cap_t, rcu));
+}
+
 /** Free allocated capability
  *
  * @param task    Task in which to free the capability.
@@ -401,9 +563,14 @@ void cap_free(task_t *task, cap_handle_t handle)
 
 	assert(cap);
 
-	hash_table_remove_item(&task->cap_info->caps, &cap->caps_link);
-	ra_free(task->cap_info->handles, cap_handle_raw(handle), 1);
-	slab_free(cap_cache, cap);
+	/* Retire the handle and push the slot on the free stack. */
+	uint32_t idx = (cap_handle_raw(handle) - CAPS_START) & CAPS_INDEX_MASK;
+	cap_slot_t *slot = cap_slot_find(task, idx);
+	rcu_assign(slot->cap, NULL);
+	slot->seq = (slot->seq + 1) & CAPS_SEQ_MASK;
+	slot->next_free = task->cap_info->free_head;
+	task->cap_info->free_head = idx + 1;
+	rcu_call(&cap->rcu, cap_free_rcu);
 	mutex_unlock(&task->cap_info->lock);
 }
 
@@ -412,11 +579,20 @@ kobject_t *kobject_alloc(unsigned int flags)
 	return slab_alloc(kobject_cache, flags);
 }
 
+/** Free kernel object which has never been published
+ *
+ * @param kobj  Kernel object to free.
+ */
 void kobject_free(kobject_t *kobj)
 {
 	slab_free(kobject_cache, kobj);
 }
 
+static void kobject_free_rcu(rcu_item_t *item)
+{
+	kobject_free(member_to_inst(item, kobject_t, rcu));
+}
+
 /** Initialize kernel object
  *
  * @param kobj  Kernel object to initialize.
@@ -449,15 +625,27 @@ kobject_get(struct task *task, cap_handle_t handle, kobject_type_t type)
 {
 	kobject_t *kobj = NULL;
 
-	mutex_lock(&task->cap_info->lock);
-	cap_t *cap = cap_get(task, handle, CAP_STATE_PUBLISHED);
-	if (cap) {
-		if (cap->kobject->type == type) {
-			kobj = cap->kobject;
-			atomic_inc(&kobj->refcnt);
-		}
+	rcu_read_lock();
+	cap_t *cap = cap_lookup(task, handle);
+	if (cap)
+		kobj = rcu_access(cap->kobject);
+	if (kobj && kobj->type == type) {
+		/*
+		 * The kobject may be just losing its last reference, in which
+		 * case it must not be revived.
+		 */
+		size_t refcnt = atomic_load(&kobj->refcnt);
+		do {
+			if (refcnt == 0) {
+				kobj = NULL;
+				break;
+			}
+		} while (!atomic_compare_exchange_weak(&kobj->refcnt, &refcnt,
+		    refcnt + 1));
+	} else {
+		kobj = NULL;
 	}
-	mutex_unlock(&task->cap_info->lock);
+	rcu_read_unlock();
 
 	return kobj;
 }
@@ -482,7 +670,7 @@ void kobject_put(kobject_t *kobj)
 {
 	if (atomic_postdec(&kobj->refcnt) == 1) {
 		KOBJECT_OP(kobj)->destroy(kobj->raw);
-		kobject_free(kobj);
+		rcu_call(&kobj->rcu, kobject_free_rcu);
 	}
 }
 
@@ -36,6 +36,7 @@
  */
 
 #include <cpu.h>
+#include <synch/rcu.h>
 #include <arch.h>
 #include <arch/cpu.h>
 #include <stdlib.h>
@@ -104,6 +105,8 @@ void cpu_init(void)
 	CPU->idle_cycles = 0;
 	CPU->busy_cycles = 0;
 
+	rcu_cpu_init();
+
 	cpu_identify();
 	cpu_arch_init();
 }
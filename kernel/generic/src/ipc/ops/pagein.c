@@ -57,6 +57,34 @@ static errno_t pagein_request_preprocess(call_t *call, phone_t *phone)
 		return EOK;
 }
 
+/** Translate a page of the pager's address space into a referenced frame.
+ *
+ * @param page  Virtual address of the page in the current address space.
+ * @param frame Place to store the physical address of the frame.
+ *
+ * @return True if the page is mapped, false otherwise.
+ */
+static bool pagein_frame_get(uintptr_t page, uintptr_t *frame)
+{
+	pte_t pte;
+
+	bool found = page_mapping_find(AS, page, false, &pte);
+	if (!found || !PTE_PRESENT(&pte))
+		return false;
+
+	*frame = PTE_GET_FRAME(&pte);
+	pfn_t pfn = ADDR2PFN(*frame);
+	if (find_zone(pfn, 1, 0) != (size_t) -1) {
+		/*
+		 * The frame is in physical memory managed by
+		 * the frame allocator.
+		 */
+		frame_reference_add(pfn);
+	}
+
+	return true;
+}
+
 static errno_t pagein_answer_preprocess(call_t *answer, ipc_data_t *olddata)
 {
 	/*
@@ -68,28 +96,43 @@ static errno_t pagein_answer_preprocess(call_t *answer, ipc_data_t *olddata)
 		return EOK;
 
 	if (!ipc_get_retval(&answer->data)) {
+		uintptr_t page = ipc_get_arg1(&answer->data);
+		size_t count = ipc_get_arg2(&answer->data);
+		size_t window = ipc_get_arg2(olddata) / PAGE_SIZE;
+		uintptr_t frames[AS_AREA_PAGE_IN_MAX];
+		size_t i;
 
-		pte_t pte;
-		uintptr_t frame;
+		/*
+		 * The pager may hand out more than one page, but never more
+		 * than what the kernel asked for.
+		 */
+		if (count == 0)
+			count = 1;
+		if (count > window)
+			count = window;
+		if (count > AS_AREA_PAGE_IN_MAX)
+			count = AS_AREA_PAGE_IN_MAX;
 
 		page_table_lock(AS, true);
-		bool found = page_mapping_find(AS, ipc_get_arg1(&answer->data),
-		    false, &pte);
-		if (found & PTE_PRESENT(&pte)) {
-			frame = PTE_GET_FRAME(&pte);
-			pfn_t pfn = ADDR2PFN(frame);
-			if (find_zone(pfn, 1, 0) != (size_t) -1) {
-				/*
-				 * The frame is in physical memory managed by
-				 * the frame allocator.
-				 */
-				frame_reference_add(ADDR2PFN(frame));
-			}
-			ipc_set_arg1(&answer->data, frame);
-		} else {
-			ipc_set_retval(&answer->data, ENOENT);
+		for (i = 0; i < count; i++) {
+			if (!pagein_frame_get(page + P2SZ(i), &frames[i]))
+				break;
 		}
 		page_table_unlock(AS, true);
+
+		if (i == 0) {
+			ipc_set_retval(&answer->data, ENOENT);
+			return EOK;
+		}
+
+		for (size_t j = i; j < AS_AREA_PAGE_IN_MAX; j++)
+			frames[j] = 0;
+
+		ipc_set_arg1(&answer->data, frames[0]);
+		ipc_set_arg2(&answer->data, frames[1]);
+		ipc_set_arg3(&answer->data, frames[2]);
+		ipc_set_arg4(&answer->data, frames[3]);
+		ipc_set_arg5(&answer->data, i);
 	}
 
 	return EOK;
@@ -77,6 +77,7 @@
 #include <smp/smp.h>
 #endif /* CONFIG_SMP */
 
+#include <synch/rcu.h>
 #include <synch/waitq.h>
 #include <synch/spinlock.h>
 
@@ -151,6 +152,9 @@ void kinit(void *arg)
 	 */
 	ARCH_OP(post_smp_init);
 
+	/* Start the RCU callback reclaimers of all CPUs */
+	rcu_reclaimers_create();
+
 	/* Start thread computing system load */
 	thread = thread_create(kload, NULL, TASK, THREAD_FLAG_NONE,
 	    "kload");
@@ -75,6 +75,7 @@
 #include <mm/as.h>
 #include <mm/slab.h>
 #include <mm/reserve.h>
+#include <synch/rcu.h>
 #include <synch/waitq.h>
 #include <synch/syswaitq.h>
 #include <arch/arch.h>
@@ -273,6 +274,7 @@ void main_bsp_separated_stack(void)
 	clock_counter_init();
 	timeout_init();
 	scheduler_init();
+	rcu_init();
 	caps_init();
 	task_init();
 	thread_init();
@@ -39,6 +39,8 @@
 #include <mm/as.h>
 #include <mm/page.h>
 #include <mm/frame.h>
+#include <genarch/mm/page_pt.h>
+#include <genarch/mm/page_ht.h>
 #include <abi/mm/as.h>
 #include <abi/ipc/methods.h>
 #include <ipc/sysipc.h>
@@ -117,10 +119,28 @@ int user_page_fault(as_area_t *area, uintptr_t upage, pf_access_t access)
 
 	as_area_pager_info_t *pager_info = &area->backend_data.pager_info;
 
+	/*
+	 * Offer the pager a window of consecutive pages that are not mapped
+	 * yet so that it can satisfy the neighbouring faults in advance.
+	 */
+	size_t window = 1;
+	while (window < AS_AREA_PAGE_IN_MAX) {
+		uintptr_t page = upage + P2SZ(window);
+		if (page >= area->base + P2SZ(area->pages))
+			break;
+
+		pte_t pte;
+		if (page_mapping_find(AS, page, true, &pte) &&
+		    PTE_PRESENT(&pte))
+			break;
+
+		window++;
+	}
+
 	ipc_data_t data = { };
 	ipc_set_imethod(&data, IPC_M_PAGE_IN);
 	ipc_set_arg1(&data, upage - area->base);
-	ipc_set_arg2(&data, PAGE_SIZE);
+	ipc_set_arg2(&data, P2SZ(window));
 	ipc_set_arg3(&data, pager_info->id1);
 	ipc_set_arg4(&data, pager_info->id2);
 	ipc_set_arg5(&data, pager_info->id3);
@@ -139,16 +159,45 @@ int user_page_fault(as_area_t *area, uintptr_t upage, pf_access_t access)
 		return AS_PF_FAULT;
 
 	/*
-	 * A successful reply will contain the physical frame in ARG1.
-	 * The physical frame will have the reference count already
-	 * incremented (if applicable).
+	 * A successful reply will contain up to AS_AREA_PAGE_IN_MAX physical
+	 * frames in ARG1 .. ARG4 and their number in ARG5. The physical frames
+	 * will have the reference count already incremented (if applicable).
 	 */
 
-	uintptr_t frame = ipc_get_arg1(&data);
-	page_mapping_insert(AS, upage, frame, as_area_get_flags(area));
+	uintptr_t frames[AS_AREA_PAGE_IN_MAX] = {
+		ipc_get_arg1(&data),
+		ipc_get_arg2(&data),
+		ipc_get_arg3(&data),
+		ipc_get_arg4(&data)
+	};
+	size_t count = ipc_get_arg5(&data);
+	if (count == 0 || count > window)
+		count = 1;
+
+	page_mapping_insert(AS, upage, frames[0], as_area_get_flags(area));
 	if (!used_space_insert(&area->used_space, upage, 1))
 		panic("Cannot insert used space.");
 
+	for (size_t i = 1; i < count; i++) {
+		uintptr_t page = upage + P2SZ(i);
+		pte_t pte;
+
+		/*
+		 * The page could have been mapped by another thread while
+		 * we were waiting for the pager.
+		 */
+		if (page_mapping_find(AS, page, true, &pte) &&
+		    PTE_PRESENT(&pte)) {
+			user_frame_free(area, page, frames[i]);
+			continue;
+		}
+
+		page_mapping_insert(AS, page, frames[i],
+		    as_area_get_flags(area));
+		if (!used_space_insert(&area->used_space, page, 1))
+			panic("Cannot insert used space.");
+	}
+
 	return AS_PF_OK;
 }
 
@@ -52,6 +52,7 @@
 #include <arch/faddr.h>
 #include <arch/cycle.h>
 #include <atomic.h>
+#include <synch/rcu.h>
 #include <synch/spinlock.h>
 #include <config.h>
 #include <context.h>
@@ -312,6 +313,8 @@ void scheduler(void)
 	if (atomic_load(&haltstate))
 		halt();
 
+	rcu_context_switch();
+
 	if (THREAD) {
 		irq_spinlock_lock(&THREAD->lock, false);
 
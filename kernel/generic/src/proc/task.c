@@ -42,6 +42,7 @@
 #include <mm/as.h>
 #include <mm/slab.h>
 #include <atomic.h>
+#include <synch/rcu.h>
 #include <synch/spinlock.h>
 #include <synch/waitq.h>
 #include <arch.h>
@@ -52,6 +53,7 @@
 #include <ipc/ipc.h>
 #include <ipc/ipcrsc.h>
 #include <ipc/event.h>
+#include <abi/ipc/methods.h>
 #include <stdio.h>
 #include <errno.h>
 #include <halt.h>
@@ -77,6 +79,17 @@ IRQ_SPINLOCK_INITIALIZE(tasks_lock);
  */
 odict_t tasks;
 
+/** Number of buckets of @c tasks_hash, a power of two. */
+#define TASKS_HASH_SIZE  256
+
+/** Hash table of active tasks by task ID.
+ *
+ * Mirrors the @c tasks ordered dictionary for lookups in RCU read
+ * sections. The chains are modified with the tasks_lock held and the task
+ * structures are freed only after a grace period.
+ */
+static task_t *tasks_hash[TASKS_HASH_SIZE];
+
 static task_id_t task_counter = 0;
 
 static slab_cache_t *task_cache;
@@ -89,6 +102,11 @@ static size_t tsk_destructor(void *);
 static void *tasks_getkey(odlink_t *);
 static int tasks_cmp(void *, void *);
 
+static task_t **tasks_hash_bucket(task_id_t id)
+{
+	return &tasks_hash[id & (TASKS_HASH_SIZE - 1)];
+}
+
 /** Initialize kernel tasks support.
  *
  */
@@ -244,6 +262,9 @@ task_t *task_create(as_t *as, const char *name)
 			return NULL;
 		}
 
+		/* Userspace expects the naming service at a well-known handle. */
+		assert(phone_handle == PHONE_NS);
+
 		kobject_t *phone_obj = kobject_get(task, phone_handle,
 		    KOBJECT_TYPE_PHONE);
 		(void) ipc_phone_connect(phone_obj->phone, ipc_box_0);
@@ -255,11 +276,22 @@ task_t *task_create(as_t *as, const char *name)
 	odlink_initialize(&task->ltasks);
 	odict_insert(&task->ltasks, &tasks, NULL);
 
+	task_t **bucket = tasks_hash_bucket(task->taskid);
+	task->hash_next = *bucket;
+	rcu_assign(*bucket, task);
+
 	irq_spinlock_unlock(&tasks_lock, true);
 
 	return task;
 }
 
+/** Free task structure after the RCU grace period. */
+static void task_free_rcu(rcu_item_t *item)
+{
+	task_t *task = member_to_inst(item, task_t, rcu);
+	slab_free(task_cache, task);
+}
+
 /** Destroy task.
  *
  * @param task Task to be destroyed.
@@ -268,10 +300,16 @@ task_t *task_create(as_t *as, const char *name)
 void task_destroy(task_t *task)
 {
 	/*
-	 * Remove the task from the task odict.
+	 * Remove the task from the task odict and hash table.
 	 */
 	irq_spinlock_lock(&tasks_lock, true);
 	odict_remove(&task->ltasks);
+
+	task_t **cur = tasks_hash_bucket(task->taskid);
+	while (*cur != task)
+		cur = &(*cur)->hash_next;
+	rcu_assign(*cur, task->hash_next);
+
 	irq_spinlock_unlock(&tasks_lock, true);
 
 	/*
@@ -284,7 +322,8 @@ void task_destroy(task_t *task)
 	 */
 	as_release(task->as);
 
-	slab_free(task_cache, task);
+	/* RCU readers may still be looking at the task. */
+	rcu_call(&task->rcu, task_free_rcu);
 }
 
 /** Hold a reference to a task.
@@ -415,8 +454,10 @@ sys_errno_t sys_task_kill(uspace_ptr_task_id_t uspace_taskid)
 
 /** Find task structure corresponding to task ID.
  *
- * The tasks_lock must be already held by the caller of this function and
- * interrupts must be disabled.
+ * The caller must be in an RCU read section (holding tasks_lock implies
+ * one). The task structure remains valid until the end of the read section,
+ * but the task may be in the middle of destruction unless tasks_lock is
+ * held. Use task_get_by_id() to get a reference instead.
  *
  * @param id Task ID.
  *
@@ -425,14 +466,44 @@ sys_errno_t sys_task_kill(uspace_ptr_task_id_t uspace_taskid)
  */
 task_t *task_find_by_id(task_id_t id)
 {
-	assert(interrupts_disabled());
-	assert(irq_spinlock_locked(&tasks_lock));
+	assert(rcu_read_locked());
 
-	odlink_t *odlink = odict_find_eq(&tasks, &id, NULL);
-	if (odlink != NULL)
-		return odict_get_instance(odlink, task_t, ltasks);
+	task_t *task = rcu_access(*tasks_hash_bucket(id));
+	while ((task != NULL) && (task->taskid != id))
+		task = rcu_access(task->hash_next);
 
-	return NULL;
+	return task;
+}
+
+/** Get a reference to the task corresponding to task ID.
+ *
+ * Does not take any global lock. Tasks which no longer have any
+ * references, i.e. are being destroyed, are not found.
+ *
+ * @param id Task ID.
+ *
+ * @return Task with its reference count incremented or NULL if there is no
+ *         such task. The reference is to be dropped with task_release().
+ *
+ */
+task_t *task_get_by_id(task_id_t id)
+{
+	rcu_read_lock();
+
+	task_t *task = task_find_by_id(id);
+	if (task != NULL) {
+		size_t refs = atomic_load(&task->refcount);
+		do {
+			if (refs == 0) {
+				task = NULL;
+				break;
+			}
+		} while (!atomic_compare_exchange_weak(&task->refcount, &refs,
+		    refs + 1));
+	}
+
+	rcu_read_unlock();
+	return task;
 }
 
 /** Get count of tasks.
@@ -568,17 +639,15 @@ errno_t task_kill(task_id_t id)
 	if (id == 1)
 		return EPERM;
 
-	irq_spinlock_lock(&tasks_lock, true);
-
-	task_t *task = task_find_by_id(id);
-	if (!task) {
-		irq_spinlock_unlock(&tasks_lock, true);
+	task_t *task = task_get_by_id(id);
+	if (!task)
 		return ENOENT;
-	}
 
+	ipl_t ipl = interrupts_disable();
 	task_kill_internal(task);
-	irq_spinlock_unlock(&tasks_lock, true);
+	interrupts_restore(ipl);
 
+	task_release(task);
 	return EOK;
 }
 
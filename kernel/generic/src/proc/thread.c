@@ -45,6 +45,7 @@
 #include <arch/asm.h>
 #include <arch/cycle.h>
 #include <arch.h>
+#include <synch/rcu.h>
 #include <synch/spinlock.h>
 #include <synch/waitq.h>
 #include <synch/syswaitq.h>
@@ -96,6 +97,17 @@ IRQ_SPINLOCK_INITIALIZE(threads_lock);
  */
 odict_t threads;
 
+/** Number of buckets of @c threads_hash, a power of two. */
+#define THREADS_HASH_SIZE  1024
+
+/** Hash table of threads by thread ID.
+ *
+ * Mirrors the @c threads ordered dictionary for lookups in RCU read
+ * sections. The chains are modified with the threads_lock held and the
+ * thread structures are freed only after a grace period.
+ */
+static thread_t *threads_hash[THREADS_HASH_SIZE];
+
 IRQ_SPINLOCK_STATIC_INITIALIZE(tidlock);
 static thread_id_t last_tid = 0;
 
@@ -108,6 +120,18 @@ slab_cache_t *fpu_context_cache;
 static void *threads_getkey(odlink_t *);
 static int threads_cmp(void *, void *);
 
+static thread_t **threads_hash_bucket(thread_id_t tid)
+{
+	return &threads_hash[tid & (THREADS_HASH_SIZE - 1)];
+}
+
+/** Free thread structure after the RCU grace period. */
+static void thread_free_rcu(rcu_item_t *item)
+{
+	thread_t *thread = member_to_inst(item, thread_t, rcu);
+	slab_free(thread_cache, thread);
+}
+
 /** Thread wrapper.
  *
  * This wrapper is provided to ensure that every thread makes a call to
@@ -441,6 +465,11 @@ void thread_destroy(thread_t *thread, bool irq_res)
 
 	odict_remove(&thread->lthreads);
 
+	thread_t **cur = threads_hash_bucket(thread->tid);
+	while (*cur != thread)
+		cur = &(*cur)->hash_next;
+	rcu_assign(*cur, thread->hash_next);
+
 	irq_spinlock_pass(&threads_lock, &thread->task->lock);
 
 	/*
@@ -453,7 +482,9 @@ void thread_destroy(thread_t *thread, bool irq_res)
 	 * Drop the reference to the containing task.
 	 */
 	task_release(thread->task);
-	slab_free(thread_cache, thread);
+
+	/* RCU readers may still be looking at the thread. */
+	rcu_call(&thread->rcu, thread_free_rcu);
 }
 
 /** Make the thread visible to the system.
@@ -487,6 +518,11 @@ void thread_attach(thread_t *thread, task_t *task)
 	 * Register this thread in the system-wide dictionary.
 	 */
 	odict_insert(&thread->lthreads, &threads, NULL);
+
+	thread_t **bucket = threads_hash_bucket(thread->tid);
+	thread->hash_next = *bucket;
+	rcu_assign(*bucket, thread);
+
 	irq_spinlock_unlock(&threads_lock, true);
 }
 
@@ -845,8 +881,10 @@ void thread_update_accounting(bool user)
 
 /** Find thread structure corresponding to thread ID.
  *
- * The threads_lock must be already held by the caller of this function and
- * interrupts must be disabled.
+ * The caller must be in an RCU read section (holding threads_lock implies
+ * one). The thread structure remains valid until the end of the read
+ * section, but the thread may be in the middle of destruction unless
+ * threads_lock is held.
  *
  * @param id Thread ID.
  *
@@ -855,20 +893,13 @@ void thread_update_accounting(bool user)
  */
 thread_t *thread_find_by_id(thread_id_t thread_id)
 {
-	thread_t *thread;
+	assert(rcu_read_locked());
 
-	assert(interrupts_disabled());
-	assert(irq_spinlock_locked(&threads_lock));
+	thread_t *thread = rcu_access(*threads_hash_bucket(thread_id));
+	while ((thread != NULL) && (thread->tid != thread_id))
+		thread = rcu_access(thread->hash_next);
 
-	thread = thread_first();
-	while (thread != NULL) {
-		if (thread->tid == thread_id)
-			return thread;
-
-		thread = thread_next(thread);
-	}
-
-	return NULL;
+	return thread;
 }
 
 /** Get count of threads.
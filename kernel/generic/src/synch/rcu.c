@@ -0,0 +1,288 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup kernel_sync
+ * @{
+ */
+
+/**
+ * @file
+ * @brief Read-copy-update.
+ *
+ * Readers of RCU protected data only disable preemption, so they neither
+ * write shared memory nor wait for updaters. An updater unpublishes an
+ * object and defers its reclamation with rcu_call() (or waits in
+ * rcu_synchronize()) until every CPU has passed a quiescent state, i.e. a
+ * point at which it cannot be inside a read section that could still see
+ * the object. The time it takes is the grace period.
+ *
+ * Grace periods are tracked per CPU and detected at clock ticks. A tick
+ * which interrupts code with preemption enabled, an idle CPU or a context
+ * switch since the grace period was noticed are all quiescent states.
+ * The CPU reports such a state once per grace period and the last CPU to
+ * report completes the grace period.
+ *
+ * Callbacks are queued on the CPU which calls rcu_call(). Each CPU has a
+ * reclaimer thread which takes the queued callbacks in batches, waits for
+ * a grace period and invokes them in thread context.
+ */
+
+#include <synch/rcu.h>
+#include <synch/condvar.h>
+#include <synch/spinlock.h>
+#include <synch/waitq.h>
+#include <proc/task.h>
+#include <proc/thread.h>
+#include <arch.h>
+#include <assert.h>
+#include <config.h>
+#include <cpu.h>
+#include <panic.h>
+
+/** Protects the grace period counters below. */
+IRQ_SPINLOCK_STATIC_INITIALIZE(rcu_lock);
+
+/** Number of the last started grace period. */
+static uint64_t rcu_cur_gp = 0;
+/** Number of the last completed grace period. */
+static uint64_t rcu_completed_gp = 0;
+/** Highest grace period somebody waits for. */
+static uint64_t rcu_req_gp = 0;
+/** Number of CPUs the current grace period still waits for. */
+static size_t rcu_remaining = 0;
+/** Broadcast whenever a grace period completes. */
+static condvar_t rcu_gp_done;
+
+/** Initialize the global RCU state. */
+void rcu_init(void)
+{
+	condvar_initialize(&rcu_gp_done);
+}
+
+/** Initialize the RCU state of the current CPU. */
+void rcu_cpu_init(void)
+{
+	CPU->rcu.cb_head = NULL;
+	CPU->rcu.cb_tail = &CPU->rcu.cb_head;
+	waitq_initialize(&CPU->rcu.reclaimer_wq);
+	CPU->rcu.reclaimer_idle = false;
+	atomic_store(&CPU->rcu.qs_needed, false);
+	CPU->rcu.gp_noticed = false;
+	CPU->rcu.qs_passed = false;
+}
+
+/** Start a new grace period.
+ *
+ * CPUs which become active later cannot hold references obtained before
+ * the grace period started, so only the active ones are waited for.
+ */
+static void rcu_gp_start(void)
+{
+	assert(irq_spinlock_locked(&rcu_lock));
+
+	rcu_cur_gp++;
+	rcu_remaining = 0;
+
+	for (unsigned int i = 0; i < config.cpu_count; i++) {
+		if (cpus[i].active) {
+			atomic_store(&cpus[i].rcu.qs_needed, true);
+			rcu_remaining++;
+		}
+	}
+}
+
+/** Request a grace period which starts after the caller's update.
+ *
+ * @return Number of the grace period to wait for.
+ */
+static uint64_t rcu_gp_request(void)
+{
+	assert(irq_spinlock_locked(&rcu_lock));
+
+	/* A grace period in progress may have started before the update. */
+	uint64_t gp = rcu_cur_gp + 1;
+	if (rcu_req_gp < gp)
+		rcu_req_gp = gp;
+
+	if (rcu_completed_gp == rcu_cur_gp)
+		rcu_gp_start();
+
+	return gp;
+}
+
+/** Report a quiescent state of the current CPU. */
+static void rcu_report_qs(void)
+{
+	irq_spinlock_lock(&rcu_lock, false);
+
+	atomic_store(&CPU->rcu.qs_needed, false);
+	CPU->rcu.gp_noticed = false;
+
+	assert(rcu_remaining > 0);
+	if (--rcu_remaining == 0) {
+		rcu_completed_gp = rcu_cur_gp;
+		condvar_broadcast(&rcu_gp_done);
+
+		if (rcu_req_gp > rcu_completed_gp)
+			rcu_gp_start();
+	}
+
+	irq_spinlock_unlock(&rcu_lock, false);
+}
+
+/** Wait until all read sections in progress have finished.
+ *
+ * Must not be called from a read section.
+ */
+void rcu_synchronize(void)
+{
+	assert(!rcu_read_locked());
+
+	irq_spinlock_lock(&rcu_lock, true);
+
+	uint64_t gp = rcu_gp_request();
+	while (rcu_completed_gp < gp) {
+		_condvar_wait_timeout_irq_spinlock(&rcu_gp_done, &rcu_lock,
+		    SYNCH_NO_TIMEOUT, SYNCH_FLAGS_NONE);
+	}
+
+	irq_spinlock_unlock(&rcu_lock, true);
+}
+
+/** Invoke a callback after the next grace period.
+ *
+ * May be called from any context, including interrupt handlers and read
+ * sections. The callback runs in a kernel thread.
+ *
+ * @param item Callback item, usually embedded in the object to reclaim.
+ * @param func Callback function.
+ */
+void rcu_call(rcu_item_t *item, rcu_func_t func)
+{
+	item->func = func;
+	item->next = NULL;
+
+	ipl_t ipl = interrupts_disable();
+	*CPU->rcu.cb_tail = item;
+	CPU->rcu.cb_tail = &item->next;
+	interrupts_restore(ipl);
+}
+
+/** Note a context switch on the current CPU.
+ *
+ * Called by the scheduler. Read sections cannot sleep nor be preempted,
+ * so no reader survives a context switch.
+ */
+void rcu_context_switch(void)
+{
+	assert(interrupts_disabled());
+
+	CPU->rcu.qs_passed = true;
+}
+
+/** Track grace periods on the current CPU.
+ *
+ * Called from clock() with interrupts disabled.
+ */
+void rcu_tick(void)
+{
+	assert(interrupts_disabled());
+
+	rcu_cpu_t *rcpu = &CPU->rcu;
+
+	if ((rcpu->cb_head != NULL) && (rcpu->reclaimer_idle)) {
+		rcpu->reclaimer_idle = false;
+		waitq_wakeup(&rcpu->reclaimer_wq, WAKEUP_FIRST);
+	}
+
+	if (!atomic_load(&rcpu->qs_needed))
+		return;
+
+	/* Context switches before the grace period started do not count. */
+	if (!rcpu->gp_noticed) {
+		rcpu->gp_noticed = true;
+		rcpu->qs_passed = false;
+	}
+
+	/* The interrupted code is not a reader if it can be preempted. */
+	if ((THREAD == NULL) || (rcpu->qs_passed) || (PREEMPTION_ENABLED))
+		rcu_report_qs();
+}
+
+/** Reclaimer thread of a CPU.
+ *
+ * Takes all callbacks queued on the CPU, waits for a grace period and
+ * invokes them. Callbacks queued meanwhile form the next batch.
+ */
+static void rcu_reclaimer(void *arg)
+{
+	rcu_cpu_t *rcpu = &CPU->rcu;
+
+	while (true) {
+		ipl_t ipl = interrupts_disable();
+		rcu_item_t *item = rcpu->cb_head;
+		rcpu->cb_head = NULL;
+		rcpu->cb_tail = &rcpu->cb_head;
+		rcpu->reclaimer_idle = (item == NULL);
+		interrupts_restore(ipl);
+
+		if (item == NULL) {
+			/* Woken up by rcu_tick() once there are callbacks. */
+			waitq_sleep(&rcpu->reclaimer_wq);
+			continue;
+		}
+
+		rcu_synchronize();
+
+		while (item != NULL) {
+			rcu_item_t *next = item->next;
+			item->func(item);
+			item = next;
+		}
+	}
+}
+
+/** Create the reclaimer threads of all active CPUs. */
+void rcu_reclaimers_create(void)
+{
+	for (unsigned int i = 0; i < config.cpu_count; i++) {
+		if (!cpus[i].active)
+			continue;
+
+		thread_t *thread = thread_create(rcu_reclaimer, NULL, TASK,
+		    THREAD_FLAG_UNCOUNTED, "krcu");
+		if (thread == NULL)
+			panic("Unable to create krcu thread for cpu%u.", i);
+
+		thread_wire(thread, &cpus[i]);
+		thread_ready(thread);
+	}
+}
+
+/** @}
+ */
@@ -39,6 +39,7 @@
 #include <abi/sysinfo.h>
 #include <sysinfo/stats.h>
 #include <sysinfo/sysinfo.h>
+#include <synch/rcu.h>
 #include <synch/spinlock.h>
 #include <synch/mutex.h>
 #include <time/clock.h>
@@ -525,13 +526,9 @@ static sysinfo_return_t get_stats_task(const char *name, bool dry_run,
 	if (str_uint64_t(name, NULL, 0, true, &task_id) != EOK)
 		return ret;
 
-	/* Messing with task structures, avoid deadlock */
-	irq_spinlock_lock(&tasks_lock, true);
-
-	task_t *task = task_find_by_id(task_id);
+	task_t *task = task_get_by_id(task_id);
 	if (task == NULL) {
 		/* No task with this ID */
-		irq_spinlock_unlock(&tasks_lock, true);
 		return ret;
 	}
 
@@ -539,14 +536,12 @@ static sysinfo_return_t get_stats_task(const char *name, bool dry_run,
 		ret.tag = SYSINFO_VAL_FUNCTION_DATA;
 		ret.data.data = NULL;
 		ret.data.size = sizeof(stats_task_t);
-
-		irq_spinlock_unlock(&tasks_lock, true);
 	} else {
 		/* Allocate stats_task_t structure */
 		stats_task_t *stats_task =
 		    (stats_task_t *) malloc(sizeof(stats_task_t));
 		if (stats_task == NULL) {
-			irq_spinlock_unlock(&tasks_lock, true);
+			task_release(task);
 			return ret;
 		}
 
@@ -555,14 +550,12 @@ static sysinfo_return_t get_stats_task(const char *name, bool dry_run,
 		ret.data.data = (void *) stats_task;
 		ret.data.size = sizeof(stats_task_t);
 
-		/* Hand-over-hand locking */
-		irq_spinlock_exchange(&tasks_lock, &task->lock);
-
+		irq_spinlock_lock(&task->lock, true);
 		produce_stats_task(task, stats_task);
-
 		irq_spinlock_unlock(&task->lock, true);
 	}
 
+	task_release(task);
 	return ret;
 }
 
@@ -596,13 +589,22 @@ static sysinfo_return_t get_stats_thread(const char *name, bool dry_run,
 	if (str_uint64_t(name, NULL, 0, true, &thread_id) != EOK)
 		return ret;
 
-	/* Messing with threads structures, avoid deadlock */
-	irq_spinlock_lock(&threads_lock, true);
+	/* Allocate stats_thread_t structure, the RCU read section cannot sleep */
+	stats_thread_t *stats_thread = NULL;
+	if (!dry_run) {
+		stats_thread = (stats_thread_t *) malloc(sizeof(stats_thread_t));
+		if (stats_thread == NULL)
+			return ret;
+	}
+
+	rcu_read_lock();
 
 	thread_t *thread = thread_find_by_id(thread_id);
 	if (thread == NULL) {
 		/* No thread with this ID */
-		irq_spinlock_unlock(&threads_lock, true);
+		rcu_read_unlock();
+		if (stats_thread != NULL)
+			free(stats_thread);
 		return ret;
 	}
 
@@ -610,30 +612,18 @@ static sysinfo_return_t get_stats_thread(const char *name, bool dry_run,
 		ret.tag = SYSINFO_VAL_FUNCTION_DATA;
 		ret.data.data = NULL;
 		ret.data.size = sizeof(stats_thread_t);
-
-		irq_spinlock_unlock(&threads_lock, true);
 	} else {
-		/* Allocate stats_thread_t structure */
-		stats_thread_t *stats_thread =
-		    (stats_thread_t *) malloc(sizeof(stats_thread_t));
-		if (stats_thread == NULL) {
-			irq_spinlock_unlock(&threads_lock, true);
-			return ret;
-		}
-
 		/* Correct return value */
 		ret.tag = SYSINFO_VAL_FUNCTION_DATA;
 		ret.data.data = (void *) stats_thread;
 		ret.data.size = sizeof(stats_thread_t);
 
-		/* Hand-over-hand locking */
-		irq_spinlock_exchange(&threads_lock, &thread->lock);
-
+		irq_spinlock_lock(&thread->lock, true);
 		produce_stats_thread(thread, stats_thread);
-
 		irq_spinlock_unlock(&thread->lock, true);
 	}
 
+	rcu_read_unlock();
 	return ret;
 }
 
@@ -43,6 +43,7 @@
 #include <time/clock.h>
 #include <time/timeout.h>
 #include <config.h>
+#include <synch/rcu.h>
 #include <synch/spinlock.h>
 #include <synch/waitq.h>
 #include <halt.h>
@@ -191,6 +192,8 @@ void clock(void)
 	}
 	CPU->missed_clock_ticks = 0;
 
+	rcu_tick();
+
 	/*
 	 * Do CPU usage accounting and find out whether to preempt THREAD.
 	 *
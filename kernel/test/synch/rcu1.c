@@ -0,0 +1,224 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <test.h>
+#include <arch.h>
+#include <atomic.h>
+#include <config.h>
+#include <cpu.h>
+#include <proc/thread.h>
+#include <synch/rcu.h>
+#include <synch/spinlock.h>
+#include <stdlib.h>
+
+#define NODE_MAGIC   0x52435531
+#define NODE_POISON  0xdeadbeef
+
+/** Duration of a single measurement in microseconds */
+#define RUN_USEC     500000
+/** Pause between two updates in microseconds */
+#define UPDATE_USEC  1000
+
+typedef struct {
+	uint32_t magic;
+	uint32_t value;
+	rcu_item_t rcu;
+} node_t;
+
+static node_t *shared;
+static bool use_rcu;
+
+SPINLOCK_INITIALIZE(shared_lock);
+
+static atomic_bool stop;
+static atomic_bool corrupted;
+static atomic_size_t reads;
+static atomic_size_t pending;
+
+static node_t *node_create(uint32_t value)
+{
+	node_t *node = malloc(sizeof(node_t));
+	if (node) {
+		node->magic = NODE_MAGIC;
+		node->value = value;
+	}
+
+	return node;
+}
+
+static void node_destroy(node_t *node)
+{
+	node->magic = NODE_POISON;
+	free(node);
+}
+
+static void node_free_rcu(rcu_item_t *item)
+{
+	node_destroy(member_to_inst(item, node_t, rcu));
+	atomic_dec(&pending);
+}
+
+static void reader(void *arg)
+{
+	size_t cnt = 0;
+
+	while (!atomic_load(&stop)) {
+		if (use_rcu) {
+			rcu_read_lock();
+			node_t *node = rcu_access(shared);
+			if (node->magic != NODE_MAGIC)
+				atomic_store(&corrupted, true);
+			rcu_read_unlock();
+		} else {
+			spinlock_lock(&shared_lock);
+			if (shared->magic != NODE_MAGIC)
+				atomic_store(&corrupted, true);
+			spinlock_unlock(&shared_lock);
+		}
+
+		cnt++;
+	}
+
+	atomic_fetch_add(&reads, cnt);
+}
+
+static void updater(void *arg)
+{
+	uint32_t value = 0;
+
+	while (!atomic_load(&stop)) {
+		node_t *node = node_create(++value);
+		if (!node) {
+			thread_usleep(UPDATE_USEC);
+			continue;
+		}
+
+		if (use_rcu) {
+			node_t *old = shared;
+			rcu_assign(shared, node);
+			atomic_inc(&pending);
+			rcu_call(&old->rcu, node_free_rcu);
+		} else {
+			spinlock_lock(&shared_lock);
+			node_t *old = shared;
+			shared = node;
+			spinlock_unlock(&shared_lock);
+			node_destroy(old);
+		}
+
+		thread_usleep(UPDATE_USEC);
+	}
+}
+
+/** Measure reads per second with the given number of readers
+ *
+ * @return Number of reads per second or zero on failure.
+ */
+static size_t run(size_t readers, bool rcu)
+{
+	thread_t *threads[readers + 1];
+	size_t created = 0;
+
+	use_rcu = rcu;
+	atomic_store(&stop, false);
+	atomic_store(&reads, 0);
+
+	thread_t *thread = thread_create(updater, NULL, TASK, THREAD_FLAG_NONE,
+	    "rcu1-updater");
+	if (!thread) {
+		TPRINTF("Unable to create updater\n");
+		return 0;
+	}
+	threads[created++] = thread;
+	thread_ready(thread);
+
+	for (size_t i = 0; i < config.cpu_count && created <= readers; i++) {
+		if (!cpus[i].active)
+			continue;
+
+		thread = thread_create(reader, NULL, TASK, THREAD_FLAG_NONE,
+		    "rcu1-reader");
+		if (!thread) {
+			TPRINTF("Unable to create reader\n");
+			break;
+		}
+
+		threads[created++] = thread;
+		thread_wire(thread, &cpus[i]);
+		thread_ready(thread);
+	}
+
+	thread_usleep(RUN_USEC);
+	atomic_store(&stop, true);
+
+	for (size_t i = 0; i < created; i++) {
+		thread_join(threads[i]);
+		thread_detach(threads[i]);
+	}
+
+	if (created <= readers)
+		return 0;
+
+	return atomic_load(&reads) * (1000000 / RUN_USEC);
+}
+
+const char *test_rcu1(void)
+{
+	atomic_store(&corrupted, false);
+	atomic_store(&pending, 0);
+
+	shared = node_create(0);
+	if (!shared)
+		return "Out of memory";
+
+	for (size_t readers = 1; readers <= config.cpu_active; readers++) {
+		size_t locked = run(readers, false);
+		size_t rcu = run(readers, true);
+		if ((locked == 0) || (rcu == 0))
+			return "Unable to create threads";
+
+		TPRINTF("%zu reader(s): %zu reads/s with spinlock, "
+		    "%zu reads/s with RCU\n", readers, locked, rcu);
+	}
+
+	/* Wait for all deferred frees to finish. */
+	rcu_synchronize();
+	for (unsigned int i = 0; atomic_load(&pending) > 0; i++) {
+		if (i == 100)
+			return "Deferred frees did not finish";
+		thread_usleep(10000);
+	}
+
+	node_destroy(shared);
+	shared = NULL;
+
+	if (atomic_load(&corrupted))
+		return "Reader saw a freed node";
+
+	return NULL;
+}
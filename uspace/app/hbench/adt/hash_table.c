@@ -0,0 +1,321 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <adt/hash_table.h>
+#include <adt/ihash_table.h>
+#include <adt/ohash_table.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <str.h>
+#include "../hbench.h"
+
+/** Kind of the benchmarked hash table (param 'table') */
+typedef enum {
+	/** hash_table_t */
+	table_chained,
+	/** ihash_table_t */
+	table_incremental,
+	/** ohash_table_t */
+	table_open
+} table_kind_t;
+
+typedef struct {
+	ht_link_t link;
+	uint64_t key;
+} bench_item_t;
+
+static table_kind_t table_kind;
+static hash_table_t chained_table;
+static ihash_table_t incremental_table;
+static ohash_table_t open_table;
+
+/** Items of the table built by setup() (param 'items') */
+static bench_item_t *items;
+static uint64_t item_cnt;
+
+static size_t item_key_hash(const void *key)
+{
+	return *(const uint64_t *) key;
+}
+
+static size_t item_hash(const ht_link_t *link)
+{
+	bench_item_t *item = hash_table_get_inst(link, bench_item_t, link);
+	return item->key;
+}
+
+static bool item_key_equal(const void *key, const ht_link_t *link)
+{
+	bench_item_t *item = hash_table_get_inst(link, bench_item_t, link);
+	return *(const uint64_t *) key == item->key;
+}
+
+static bool item_equal(const ht_link_t *link1, const ht_link_t *link2)
+{
+	return item_key_equal(&hash_table_get_inst(link1, bench_item_t,
+	    link)->key, link2);
+}
+
+static hash_table_ops_t item_ops = {
+	.hash = item_hash,
+	.key_hash = item_key_hash,
+	.key_equal = item_key_equal,
+	.equal = item_equal,
+	.remove_callback = NULL
+};
+
+static const void *oitem_key(const void *item)
+{
+	return &((const bench_item_t *) item)->key;
+}
+
+static bool oitem_key_equal(const void *key1, const void *key2)
+{
+	return *(const uint64_t *) key1 == *(const uint64_t *) key2;
+}
+
+static const ohash_table_ops_t oitem_ops = {
+	.key = oitem_key,
+	.key_hash = item_key_hash,
+	.key_equal = oitem_key_equal
+};
+
+/** Simple linear congruential generator to get reproducible keys. */
+static uint64_t next_rand(uint64_t *state)
+{
+	*state = *state * 6364136223846793005ULL + 1442695040888963407ULL;
+	return *state;
+}
+
+static bool table_create(void)
+{
+	switch (table_kind) {
+	case table_chained:
+		return hash_table_create(&chained_table, 0, 0, &item_ops);
+	case table_incremental:
+		return ihash_table_create(&incremental_table, 0, 0, &item_ops);
+	case table_open:
+		return ohash_table_create(&open_table, 0, &oitem_ops) == EOK;
+	}
+
+	return false;
+}
+
+static void table_destroy(void)
+{
+	switch (table_kind) {
+	case table_chained:
+		hash_table_destroy(&chained_table);
+		break;
+	case table_incremental:
+		ihash_table_destroy(&incremental_table);
+		break;
+	case table_open:
+		ohash_table_destroy(&open_table);
+		break;
+	}
+}
+
+static bool table_insert(bench_item_t *item)
+{
+	switch (table_kind) {
+	case table_chained:
+		hash_table_insert(&chained_table, &item->link);
+		return true;
+	case table_incremental:
+		ihash_table_insert(&incremental_table, &item->link);
+		return true;
+	case table_open:
+		return ohash_table_insert(&open_table, item) == EOK;
+	}
+
+	return false;
+}
+
+static bool table_find(uint64_t key)
+{
+	switch (table_kind) {
+	case table_chained:
+		return hash_table_find(&chained_table, &key) != NULL;
+	case table_incremental:
+		return ihash_table_find(&incremental_table, &key) != NULL;
+	case table_open:
+		return ohash_table_find(&open_table, &key) != NULL;
+	}
+
+	return false;
+}
+
+/** Allocate items with distinct pseudo-random keys. */
+static bench_item_t *items_create(uint64_t cnt)
+{
+	bench_item_t *new_items = calloc(cnt, sizeof(bench_item_t));
+	uint64_t state = 42;
+
+	if (new_items == NULL)
+		return NULL;
+
+	/* An odd multiplier keeps the keys distinct. */
+	for (uint64_t i = 0; i < cnt; i++)
+		new_items[i].key = (i + (next_rand(&state) << 32)) *
+		    0x9e3779b97f4a7c15ULL;
+
+	return new_items;
+}
+
+static bool setup_kind(bench_env_t *env, bench_run_t *run)
+{
+	const char *table = bench_env_param_get(env, "table", "chained");
+
+	if (str_cmp(table, "chained") == 0)
+		table_kind = table_chained;
+	else if (str_cmp(table, "incremental") == 0)
+		table_kind = table_incremental;
+	else if (str_cmp(table, "open") == 0)
+		table_kind = table_open;
+	else
+		return bench_run_fail(run, "unknown table '%s'", table);
+
+	return true;
+}
+
+static bool insert_runner(bench_env_t *env, bench_run_t *run, uint64_t size)
+{
+	bench_item_t *new_items = items_create(size);
+	if (new_items == NULL)
+		return bench_run_fail(run, "failed to allocate items");
+
+	if (!table_create()) {
+		free(new_items);
+		return bench_run_fail(run, "failed to create table");
+	}
+
+	bool ok = true;
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < size; i++) {
+		if (!table_insert(&new_items[i])) {
+			ok = false;
+			break;
+		}
+	}
+	bench_run_stop(run);
+
+	table_destroy();
+	free(new_items);
+
+	if (!ok)
+		return bench_run_fail(run, "failed to insert item");
+
+	return true;
+}
+
+static bool lookup_setup(bench_env_t *env, bench_run_t *run)
+{
+	const char *sitems = bench_env_param_get(env, "items", "100000");
+	errno_t rc;
+
+	if (!setup_kind(env, run))
+		return false;
+
+	rc = str_uint64_t(sitems, NULL, 10, true, &item_cnt);
+	if (rc != EOK || item_cnt == 0)
+		return bench_run_fail(run, "invalid number of items '%s'", sitems);
+
+	items = items_create(item_cnt);
+	if (items == NULL)
+		return bench_run_fail(run, "failed to allocate items");
+
+	if (!table_create()) {
+		free(items);
+		return bench_run_fail(run, "failed to create table");
+	}
+
+	for (uint64_t i = 0; i < item_cnt; i++) {
+		if (!table_insert(&items[i])) {
+			table_destroy();
+			free(items);
+			return bench_run_fail(run, "failed to insert item");
+		}
+	}
+
+	return true;
+}
+
+static bool lookup_teardown(bench_env_t *env, bench_run_t *run)
+{
+	table_destroy();
+	free(items);
+	return true;
+}
+
+static bool lookup_runner(bench_env_t *env, bench_run_t *run, uint64_t size)
+{
+	uint64_t state = 7;
+	uint64_t hits = 0;
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < size; i++) {
+		/* Every other lookup is for a key which is not present. */
+		uint64_t key = items[next_rand(&state) % item_cnt].key + (i & 1);
+		if (table_find(key))
+			hits++;
+	}
+	bench_run_stop(run);
+
+	if (hits < size / 2) {
+		return bench_run_fail(run, "only %" PRIu64 " of %" PRIu64
+		    " lookups matched", hits, size);
+	}
+
+	return true;
+}
+
+benchmark_t benchmark_hash_insert = {
+	.name = "hash_insert",
+	.desc = "Insert items into a hash table (param 'table' is one of "
+	    "'chained', 'incremental' and 'open')",
+	.entry = &insert_runner,
+	.setup = &setup_kind,
+	.teardown = NULL
+};
+
+benchmark_t benchmark_hash_lookup = {
+	.name = "hash_lookup",
+	.desc = "Look up keys in a hash table (params 'table' and 'items')",
+	.entry = &lookup_runner,
+	.setup = &lookup_setup,
+	.teardown = &lookup_teardown
+};
+
+/** @}
+ */
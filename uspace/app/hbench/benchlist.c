@@ -38,13 +38,26 @@
 #include "hbench.h"
 
 benchmark_t *benchmarks[] = {
+	&benchmark_conn_churn,
 	&benchmark_dir_read,
+	&benchmark_dlopen,
 	&benchmark_fibril_mutex,
 	&benchmark_file_read,
+	&benchmark_hash_insert,
+	&benchmark_hash_lookup,
+	&benchmark_lpm_lookup,
 	&benchmark_malloc1,
 	&benchmark_malloc2,
+	&benchmark_memchr,
+	&benchmark_memcmp,
+	&benchmark_memcpy,
 	&benchmark_ns_ping,
-	&benchmark_ping_pong
+	&benchmark_ping_pong,
+	&benchmark_queue_xfer,
+	&benchmark_str_cmp,
+	&benchmark_str_size,
+	&benchmark_task_start,
+	&benchmark_tcp_xfer
 };
 
 size_t benchmark_count = sizeof(benchmarks) / sizeof(benchmarks[0]);
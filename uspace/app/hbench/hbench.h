@@ -131,13 +131,26 @@ extern benchmark_t *benchmarks[];
 extern size_t benchmark_count;
 
 /* Put your benchmark descriptors here (and also to benchlist.c). */
+extern benchmark_t benchmark_conn_churn;
 extern benchmark_t benchmark_dir_read;
+extern benchmark_t benchmark_dlopen;
 extern benchmark_t benchmark_fibril_mutex;
 extern benchmark_t benchmark_file_read;
+extern benchmark_t benchmark_hash_insert;
+extern benchmark_t benchmark_hash_lookup;
+extern benchmark_t benchmark_lpm_lookup;
 extern benchmark_t benchmark_malloc1;
 extern benchmark_t benchmark_malloc2;
+extern benchmark_t benchmark_memchr;
+extern benchmark_t benchmark_memcmp;
+extern benchmark_t benchmark_memcpy;
 extern benchmark_t benchmark_ns_ping;
 extern benchmark_t benchmark_ping_pong;
+extern benchmark_t benchmark_queue_xfer;
+extern benchmark_t benchmark_str_cmp;
+extern benchmark_t benchmark_str_size;
+extern benchmark_t benchmark_task_start;
+extern benchmark_t benchmark_tcp_xfer;
 
 #endif
 
@@ -31,17 +31,43 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <ipc_test.h>
 #include <async.h>
 #include <errno.h>
+#include <fibril.h>
+#include <fibril_synch.h>
+#include <str.h>
 #include <str_error.h>
 #include "../hbench.h"
 
+typedef struct {
+	uint64_t count;
+	errno_t rc;
+	fibril_semaphore_t *done;
+} pinger_t;
+
 static ipc_test_t *test = NULL;
+static uint64_t pinger_cnt;
+/** Number of fibril runners spawned so far (they are never stopped). */
+static uint64_t runner_cnt = 1;
 
 static bool setup(bench_env_t *env, bench_run_t *run)
 {
-	errno_t rc = ipc_test_create(&test);
+	const char *sthreads = bench_env_param_get(env, "threads", "1");
+
+	errno_t rc = str_uint64_t(sthreads, NULL, 10, true, &pinger_cnt);
+	if (rc != EOK || pinger_cnt == 0) {
+		return bench_run_fail(run, "invalid number of threads '%s'",
+		    sthreads);
+	}
+
+	if (pinger_cnt > runner_cnt) {
+		runner_cnt += fibril_test_spawn_runners(pinger_cnt -
+		    runner_cnt);
+	}
+
+	rc = ipc_test_create(&test);
 	if (rc != EOK) {
 		return bench_run_fail(run,
 		    "failed contacting IPC test server (have you run /srv/test/ipc-test?): %s (%d)",
@@ -57,8 +83,73 @@ static bool teardown(bench_env_t *env, bench_run_t *run)
 	return true;
 }
 
+static errno_t pinger(void *arg)
+{
+	pinger_t *p = arg;
+
+	p->rc = EOK;
+	for (uint64_t count = 0; count < p->count; count++) {
+		p->rc = ipc_test_ping(test);
+		if (p->rc != EOK)
+			break;
+	}
+
+	fibril_semaphore_up(p->done);
+	return EOK;
+}
+
+/** Send the pings from several fibrils running in parallel */
+static bool runner_parallel(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	fibril_semaphore_t done;
+	pinger_t *pingers;
+	uint64_t started = 0;
+
+	pingers = calloc(pinger_cnt, sizeof(pinger_t));
+	if (pingers == NULL)
+		return bench_run_fail(run, "failed to allocate pingers");
+
+	fibril_semaphore_initialize(&done, 0);
+
+	bench_run_start(run);
+
+	for (uint64_t i = 0; i < pinger_cnt; i++) {
+		pingers[i].count = niter * (i + 1) / pinger_cnt -
+		    niter * i / pinger_cnt;
+		pingers[i].done = &done;
+
+		fid_t fid = fibril_create(pinger, &pingers[i]);
+		if (fid == 0)
+			break;
+
+		fibril_add_ready(fid);
+		started++;
+	}
+
+	for (uint64_t i = 0; i < started; i++)
+		fibril_semaphore_down(&done);
+
+	bench_run_stop(run);
+
+	errno_t rc = (started < pinger_cnt) ? ENOMEM : EOK;
+	for (uint64_t i = 0; i < started && rc == EOK; i++)
+		rc = pingers[i].rc;
+
+	free(pingers);
+
+	if (rc != EOK) {
+		return bench_run_fail(run, "failed sending ping message: %s (%d)",
+		    str_error(rc), rc);
+	}
+
+	return true;
+}
+
 static bool runner(bench_env_t *env, bench_run_t *run, uint64_t niter)
 {
+	if (pinger_cnt > 1)
+		return runner_parallel(env, run, niter);
+
 	bench_run_start(run);
 
 	for (uint64_t count = 0; count < niter; count++) {
@@ -77,7 +168,8 @@ static bool runner(bench_env_t *env, bench_run_t *run, uint64_t niter)
 
 benchmark_t benchmark_ping_pong = {
 	.name = "ping_pong",
-	.desc = "IPC ping-pong benchmark",
+	.desc = "IPC ping-pong benchmark (param 'threads' sends the pings "
+	    "from that many fibrils in parallel)",
 	.entry = &runner,
 	.setup = &setup,
 	.teardown = &teardown
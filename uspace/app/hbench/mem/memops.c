@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <errno.h>
+#include <mem.h>
+#include <stdlib.h>
+#include <str.h>
+#include "../hbench.h"
+
+/** Two buffers of equal contents, with a terminator at the end */
+static char *buf1;
+static char *buf2;
+
+/** Size of the data in the buffers (param 'size') */
+static size_t buf_size;
+
+/** Misalignment of the data in the buffers (param 'offset') */
+static size_t buf_offset;
+
+/** Prevents the compiler from optimizing the calls away */
+static volatile size_t sink;
+
+static bool setup(bench_env_t *env, bench_run_t *run)
+{
+	const char *ssize = bench_env_param_get(env, "size", "4096");
+	const char *soffset = bench_env_param_get(env, "offset", "0");
+	errno_t rc;
+
+	rc = str_size_t(ssize, NULL, 10, true, &buf_size);
+	if (rc != EOK || buf_size == 0)
+		return bench_run_fail(run, "invalid size '%s'", ssize);
+
+	rc = str_size_t(soffset, NULL, 10, true, &buf_offset);
+	if (rc != EOK || buf_offset >= 16)
+		return bench_run_fail(run, "invalid offset '%s'", soffset);
+
+	buf1 = malloc(buf_offset + buf_size + 1);
+	buf2 = malloc(buf_offset + buf_size + 1);
+	if (buf1 == NULL || buf2 == NULL) {
+		free(buf1);
+		free(buf2);
+		return bench_run_fail(run, "failed to allocate buffers");
+	}
+
+	buf1 += buf_offset;
+	buf2 += buf_offset;
+
+	memset(buf1, 'a', buf_size);
+	memset(buf2, 'a', buf_size);
+	buf1[buf_size] = '\0';
+	buf2[buf_size] = '\0';
+
+	return true;
+}
+
+static bool teardown(bench_env_t *env, bench_run_t *run)
+{
+	free(buf1 - buf_offset);
+	free(buf2 - buf_offset);
+	return true;
+}
+
+static bool memcpy_runner(bench_env_t *env, bench_run_t *run, uint64_t size)
+{
+	bench_run_start(run);
+	for (uint64_t i = 0; i < size; i++)
+		sink = (size_t) memcpy(buf1, buf2, buf_size);
+	bench_run_stop(run);
+
+	return true;
+}
+
+static bool memcmp_runner(bench_env_t *env, bench_run_t *run, uint64_t size)
+{
+	bench_run_start(run);
+	for (uint64_t i = 0; i < size; i++)
+		sink = memcmp(buf1, buf2, buf_size);
+	bench_run_stop(run);
+
+	if (sink != 0)
+		return bench_run_fail(run, "buffers differ");
+
+	return true;
+}
+
+static bool memchr_runner(bench_env_t *env, bench_run_t *run, uint64_t size)
+{
+	bench_run_start(run);
+	for (uint64_t i = 0; i < size; i++)
+		sink = (size_t) memchr(buf1, 'b', buf_size);
+	bench_run_stop(run);
+
+	if (sink != 0)
+		return bench_run_fail(run, "byte unexpectedly found");
+
+	return true;
+}
+
+static bool str_size_runner(bench_env_t *env, bench_run_t *run, uint64_t size)
+{
+	bench_run_start(run);
+	for (uint64_t i = 0; i < size; i++)
+		sink = str_size(buf1);
+	bench_run_stop(run);
+
+	if (sink != buf_size)
+		return bench_run_fail(run, "wrong length %zu", (size_t) sink);
+
+	return true;
+}
+
+static bool str_cmp_runner(bench_env_t *env, bench_run_t *run, uint64_t size)
+{
+	bench_run_start(run);
+	for (uint64_t i = 0; i < size; i++)
+		sink = str_cmp(buf1, buf2);
+	bench_run_stop(run);
+
+	if (sink != 0)
+		return bench_run_fail(run, "strings differ");
+
+	return true;
+}
+
+benchmark_t benchmark_memcpy = {
+	.name = "memcpy",
+	.desc = "Copy a buffer (params 'size' and 'offset')",
+	.entry = &memcpy_runner,
+	.setup = &setup,
+	.teardown = &teardown
+};
+
+benchmark_t benchmark_memcmp = {
+	.name = "memcmp",
+	.desc = "Compare two equal buffers (params 'size' and 'offset')",
+	.entry = &memcmp_runner,
+	.setup = &setup,
+	.teardown = &teardown
+};
+
+benchmark_t benchmark_memchr = {
+	.name = "memchr",
+	.desc = "Search a buffer for a missing byte (params 'size' and 'offset')",
+	.entry = &memchr_runner,
+	.setup = &setup,
+	.teardown = &teardown
+};
+
+benchmark_t benchmark_str_size = {
+	.name = "str_size",
+	.desc = "Measure size of a string (params 'size' and 'offset')",
+	.entry = &str_size_runner,
+	.setup = &setup,
+	.teardown = &teardown
+};
+
+benchmark_t benchmark_str_cmp = {
+	.name = "str_cmp",
+	.desc = "Compare two equal ASCII strings (params 'size' and 'offset')",
+	.entry = &str_cmp_runner,
+	.setup = &setup,
+	.teardown = &teardown
+};
+
+/** @}
+ */
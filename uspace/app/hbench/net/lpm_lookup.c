@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <errno.h>
+#include <inet/addr.h>
+#include <inet/lpm.h>
+#include <stdlib.h>
+#include <str.h>
+#include <str_error.h>
+#include "../hbench.h"
+
+static inet_lpm_t lpm;
+
+/** Dummy value stored for each route */
+static int route_value;
+
+/** Simple linear congruential generator to get reproducible addresses. */
+static uint32_t next_rand(uint32_t *state)
+{
+	*state = *state * 1103515245 + 12345;
+	return *state;
+}
+
+static bool runner(bench_env_t *env, bench_run_t *run, uint64_t size)
+{
+	inet_addr_t addr;
+	uint32_t state = 42;
+	uint64_t hits = 0;
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < size; i++) {
+		inet_addr_set(next_rand(&state), &addr);
+		if (inet_lpm_lookup(&lpm, &addr) != NULL)
+			hits++;
+	}
+	bench_run_stop(run);
+
+	/* The default route matches every address */
+	if (hits != size) {
+		return bench_run_fail(run, "only %" PRIu64 " of %" PRIu64
+		    " lookups matched", hits, size);
+	}
+
+	return true;
+}
+
+static bool setup(bench_env_t *env, bench_run_t *run)
+{
+	const char *sroutes = bench_env_param_get(env, "routes", "1000");
+	inet_naddr_t naddr;
+	uint32_t state = 7;
+	uint32_t routes;
+	uint32_t mask;
+	uint8_t prefix;
+	errno_t rc;
+
+	rc = str_uint32_t(sroutes, NULL, 10, true, &routes);
+	if (rc != EOK)
+		return bench_run_fail(run, "invalid number of routes '%s'", sroutes);
+
+	inet_lpm_init(&lpm);
+
+	/* Default route */
+	inet_naddr_set(0, 0, &naddr);
+	rc = inet_lpm_insert(&lpm, &naddr, &route_value);
+	if (rc != EOK)
+		goto error;
+
+	while (lpm.count < routes + 1) {
+		prefix = 8 + next_rand(&state) % 25;
+		mask = ~(uint32_t) 0 << (32 - prefix);
+		inet_naddr_set(next_rand(&state) & mask, prefix, &naddr);
+
+		rc = inet_lpm_insert(&lpm, &naddr, &route_value);
+		if (rc != EOK && rc != EEXIST)
+			goto error;
+	}
+
+	return true;
+error:
+	inet_lpm_fini(&lpm);
+	return bench_run_fail(run, "failed building route table: %s (%d)",
+	    str_error(rc), rc);
+}
+
+static bool teardown(bench_env_t *env, bench_run_t *run)
+{
+	inet_lpm_fini(&lpm);
+	return true;
+}
+
+benchmark_t benchmark_lpm_lookup = {
+	.name = "lpm_lookup",
+	.desc = "Longest prefix match lookup of IPv4 addresses in a table "
+	    "of random routes (param 'routes')",
+	.entry = &runner,
+	.setup = &setup,
+	.teardown = &teardown
+};
+
+/** @}
+ */
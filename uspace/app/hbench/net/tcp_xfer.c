@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <errno.h>
+#include <fibril_synch.h>
+#include <inet/endpoint.h>
+#include <inet/tcp.h>
+#include <stdlib.h>
+#include <str.h>
+#include <str_error.h>
+#include "../hbench.h"
+
+/** Amount of data sent in one iteration */
+#define CHUNK_SIZE (64 * 1024)
+
+static tcp_t *tcp;
+static tcp_listener_t *lst;
+static tcp_conn_t *conn;
+
+/** Protects @c rcvd and @c sink_done */
+static FIBRIL_MUTEX_INITIALIZE(sink_lock);
+/** Signalled when @c rcvd changes or the sink terminates */
+static FIBRIL_CONDVAR_INITIALIZE(sink_cv);
+/** Number of bytes received by the sink */
+static uint64_t rcvd;
+/** Sink connection has terminated */
+static bool sink_done;
+
+static void sink_new_conn(tcp_listener_t *, tcp_conn_t *);
+
+static tcp_listen_cb_t sink_listen_cb = {
+	.new_conn = sink_new_conn
+};
+
+static tcp_cb_t sink_conn_cb = {
+	.connected = NULL
+};
+
+static tcp_cb_t client_conn_cb = {
+	.connected = NULL
+};
+
+/** Receive and discard everything arriving over a connection. */
+static void sink_new_conn(tcp_listener_t *lst, tcp_conn_t *sconn)
+{
+	char *buf;
+	size_t nrecv;
+	errno_t rc;
+
+	buf = malloc(CHUNK_SIZE);
+	if (buf == NULL)
+		goto out;
+
+	while (true) {
+		rc = tcp_conn_recv_wait(sconn, buf, CHUNK_SIZE, &nrecv);
+		if (rc != EOK || nrecv == 0)
+			break;
+
+		fibril_mutex_lock(&sink_lock);
+		rcvd += nrecv;
+		fibril_condvar_broadcast(&sink_cv);
+		fibril_mutex_unlock(&sink_lock);
+	}
+
+	free(buf);
+out:
+	fibril_mutex_lock(&sink_lock);
+	sink_done = true;
+	fibril_condvar_broadcast(&sink_cv);
+	fibril_mutex_unlock(&sink_lock);
+}
+
+static bool setup(bench_env_t *env, bench_run_t *run)
+{
+	const char *sport = bench_env_param_get(env, "port", "9090");
+	inet_ep_t ep;
+	inet_ep2_t epp;
+	uint16_t port;
+	errno_t rc;
+
+	rc = str_uint16_t(sport, NULL, 10, true, &port);
+	if (rc != EOK)
+		return bench_run_fail(run, "invalid port '%s'", sport);
+
+	rc = tcp_create(&tcp);
+	if (rc != EOK) {
+		return bench_run_fail(run, "failed contacting TCP service: %s (%d)",
+		    str_error(rc), rc);
+	}
+
+	inet_ep_init(&ep);
+	inet_addr(&ep.addr, 127, 0, 0, 1);
+	ep.port = port;
+
+	rc = tcp_listener_create(tcp, &ep, &sink_listen_cb, NULL,
+	    &sink_conn_cb, NULL, &lst);
+	if (rc != EOK) {
+		tcp_destroy(tcp);
+		return bench_run_fail(run, "failed creating listener: %s (%d)",
+		    str_error(rc), rc);
+	}
+
+	rcvd = 0;
+	sink_done = false;
+
+	inet_ep2_init(&epp);
+	epp.remote = ep;
+
+	rc = tcp_conn_create(tcp, &epp, &client_conn_cb, NULL, &conn);
+	if (rc == EOK)
+		rc = tcp_conn_wait_connected(conn);
+	if (rc != EOK) {
+		tcp_listener_destroy(lst);
+		tcp_destroy(tcp);
+		return bench_run_fail(run, "failed connecting to sink: %s (%d)",
+		    str_error(rc), rc);
+	}
+
+	return true;
+}
+
+static bool teardown(bench_env_t *env, bench_run_t *run)
+{
+	tcp_conn_destroy(conn);
+	tcp_listener_destroy(lst);
+	tcp_destroy(tcp);
+	return true;
+}
+
+static bool runner(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	uint64_t target;
+	bool ret = true;
+	char *buf;
+	errno_t rc;
+
+	buf = calloc(1, CHUNK_SIZE);
+	if (buf == NULL)
+		return bench_run_fail(run, "failed to allocate %dB buffer", CHUNK_SIZE);
+
+	fibril_mutex_lock(&sink_lock);
+	target = rcvd + niter * CHUNK_SIZE;
+	fibril_mutex_unlock(&sink_lock);
+
+	bench_run_start(run);
+
+	for (uint64_t count = 0; count < niter; count++) {
+		rc = tcp_conn_send(conn, buf, CHUNK_SIZE);
+		if (rc != EOK) {
+			ret = bench_run_fail(run, "failed sending data: %s (%d)",
+			    str_error(rc), rc);
+			goto out;
+		}
+	}
+
+	rc = tcp_conn_push(conn);
+	if (rc != EOK) {
+		ret = bench_run_fail(run, "failed pushing data: %s (%d)",
+		    str_error(rc), rc);
+		goto out;
+	}
+
+	/* Wait until the sink has received everything */
+	fibril_mutex_lock(&sink_lock);
+	while (rcvd < target && !sink_done)
+		fibril_condvar_wait(&sink_cv, &sink_lock);
+	fibril_mutex_unlock(&sink_lock);
+
+	bench_run_stop(run);
+
+	if (rcvd < target)
+		ret = bench_run_fail(run, "sink connection terminated early");
+out:
+	free(buf);
+	return ret;
+}
+
+benchmark_t benchmark_tcp_xfer = {
+	.name = "tcp_xfer",
+	.desc = "TCP bulk transfer over loopback in 64 KiB chunks (use 'port' param to alter the default).",
+	.entry = &runner,
+	.setup = &setup,
+	.teardown = &teardown
+};
+
+/** @}
+ */
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <dlfcn.h>
+#include <stdio.h>
+#include "../hbench.h"
+
+/** Symbols looked up in each iteration. */
+static const char *dlopen_syms[] = {
+	"dl_get_constant",
+	"dl_get_constant_via_call",
+	"dl_get_private_var",
+	"dl_get_public_var",
+	"dl_get_private_fib_var",
+	"dl_public_var"
+};
+
+/** Execute dynamic library open and symbol lookup benchmark.
+ *
+ * Libraries cannot be unloaded so only the first dlopen() actually loads
+ * the library. The benchmark thus mostly measures the symbol lookup of
+ * the dynamic linker.
+ */
+static bool runner(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	const char *library = bench_env_param_get(env, "library",
+	    "libdltest.so.0");
+
+	bench_run_start(run);
+
+	for (uint64_t count = 0; count < niter; count++) {
+		void *handle = dlopen(library, 0);
+		if (handle == NULL)
+			return bench_run_fail(run, "failed to open %s", library);
+
+		for (size_t i = 0; i < sizeof(dlopen_syms) /
+		    sizeof(dlopen_syms[0]); i++) {
+			if (dlsym(handle, dlopen_syms[i]) == NULL) {
+				return bench_run_fail(run, "symbol %s not found in %s",
+				    dlopen_syms[i], library);
+			}
+		}
+	}
+
+	bench_run_stop(run);
+
+	return true;
+}
+
+benchmark_t benchmark_dlopen = {
+	.name = "dlopen",
+	.desc = "Dynamic library open and symbol lookup benchmark",
+	.entry = &runner,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+/** @}
+ */
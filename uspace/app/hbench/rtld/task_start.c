@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <str_error.h>
+#include <task.h>
+#include "../hbench.h"
+
+/** Execute task start-up benchmark.
+ *
+ * Each iteration spawns the program, which includes loading and relocating
+ * all its libraries, and waits for it to terminate. The default program
+ * is the dynamic linking test with its dlfcn tests skipped.
+ */
+static bool runner(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	const char *path = bench_env_param_get(env, "program", "/app/dltest");
+	const char *args[] = { path, "-n", NULL };
+
+	bench_run_start(run);
+
+	for (uint64_t count = 0; count < niter; count++) {
+		task_id_t id;
+		task_wait_t wait;
+		task_exit_t texit;
+		int retval;
+
+		errno_t rc = task_spawnvf(&id, &wait, path, args, -1, -1, -1);
+		if (rc != EOK) {
+			return bench_run_fail(run, "failed spawning %s: %s (%d)",
+			    path, str_error(rc), rc);
+		}
+
+		rc = task_wait(&wait, &texit, &retval);
+		if (rc != EOK || texit != TASK_EXIT_NORMAL || retval != 0) {
+			return bench_run_fail(run, "task %s did not exit normally",
+			    path);
+		}
+	}
+
+	bench_run_stop(run);
+
+	return true;
+}
+
+benchmark_t benchmark_task_start = {
+	.name = "task_start",
+	.desc = "Task spawning and dynamic linking benchmark",
+	.entry = &runner,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+/** @}
+ */
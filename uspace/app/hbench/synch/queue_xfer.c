@@ -0,0 +1,244 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <adt/prodcons.h>
+#include <errno.h>
+#include <fibril.h>
+#include <fibril_synch.h>
+#include <stdlib.h>
+#include <str.h>
+#include "../hbench.h"
+
+/*
+ * Several producer fibrils pass messages to one consumer fibril. The
+ * lock-free channels are compared with the mutex protected prodcons_t.
+ */
+
+/** Kind of the benchmarked queue (param 'queue') */
+typedef enum {
+	/** mpsc_t */
+	queue_mpsc,
+	/** mpmc_t */
+	queue_mpmc,
+	/** prodcons_t */
+	queue_prodcons
+} queue_kind_t;
+
+typedef struct {
+	link_t link;
+	uint64_t value;
+} bench_msg_t;
+
+typedef struct {
+	uint64_t first;
+	uint64_t count;
+	fibril_semaphore_t *done;
+} producer_t;
+
+static queue_kind_t queue_kind;
+static uint64_t producer_cnt;
+
+static mpsc_t *mpsc;
+static mpmc_t *mpmc;
+static prodcons_t prodcons;
+/** Messages passed through prodcons, it does not copy them */
+static bench_msg_t *msgs;
+
+static errno_t producer(void *arg)
+{
+	producer_t *p = arg;
+
+	for (uint64_t i = p->first; i < p->first + p->count; i++) {
+		switch (queue_kind) {
+		case queue_mpsc:
+			(void) mpsc_send(mpsc, &i);
+			break;
+		case queue_mpmc:
+			(void) mpmc_send(mpmc, &i, NULL);
+			break;
+		case queue_prodcons:
+			msgs[i].value = i;
+			prodcons_produce(&prodcons, &msgs[i].link);
+			break;
+		}
+	}
+
+	fibril_semaphore_up(p->done);
+	return EOK;
+}
+
+static bool consume(uint64_t *value)
+{
+	switch (queue_kind) {
+	case queue_mpsc:
+		return mpsc_receive(mpsc, value, NULL) == EOK;
+	case queue_mpmc:
+		return mpmc_receive(mpmc, value, NULL) == EOK;
+	case queue_prodcons:
+		*value = list_get_instance(prodcons_consume(&prodcons),
+		    bench_msg_t, link)->value;
+		return true;
+	}
+
+	return false;
+}
+
+static bool setup(bench_env_t *env, bench_run_t *run)
+{
+	const char *queue = bench_env_param_get(env, "queue", "mpsc");
+	const char *sproducers = bench_env_param_get(env, "producers", "2");
+	errno_t rc;
+
+	if (str_cmp(queue, "mpsc") == 0)
+		queue_kind = queue_mpsc;
+	else if (str_cmp(queue, "mpmc") == 0)
+		queue_kind = queue_mpmc;
+	else if (str_cmp(queue, "prodcons") == 0)
+		queue_kind = queue_prodcons;
+	else
+		return bench_run_fail(run, "unknown queue '%s'", queue);
+
+	rc = str_uint64_t(sproducers, NULL, 10, true, &producer_cnt);
+	if (rc != EOK || producer_cnt == 0) {
+		return bench_run_fail(run, "invalid number of producers '%s'",
+		    sproducers);
+	}
+
+	return true;
+}
+
+static bool runner(bench_env_t *env, bench_run_t *run, uint64_t size)
+{
+	fibril_semaphore_t done;
+	producer_t *prods;
+	uint64_t started = 0;
+	uint64_t expected = 0;
+	bool spawned = true;
+	bool ok = true;
+
+	prods = calloc(producer_cnt, sizeof(producer_t));
+	if (prods == NULL)
+		return bench_run_fail(run, "failed to allocate producers");
+
+	switch (queue_kind) {
+	case queue_mpsc:
+		mpsc = mpsc_create(sizeof(uint64_t));
+		ok = mpsc != NULL;
+		break;
+	case queue_mpmc:
+		mpmc = mpmc_create(sizeof(uint64_t), 256);
+		ok = mpmc != NULL;
+		break;
+	case queue_prodcons:
+		prodcons_initialize(&prodcons);
+		msgs = calloc(size, sizeof(bench_msg_t));
+		ok = msgs != NULL;
+		break;
+	}
+
+	if (!ok) {
+		free(prods);
+		return bench_run_fail(run, "failed to create queue");
+	}
+
+	fibril_semaphore_initialize(&done, 0);
+
+	bench_run_start(run);
+
+	for (uint64_t i = 0; i < producer_cnt; i++) {
+		prods[i].first = size * i / producer_cnt;
+		prods[i].count = size * (i + 1) / producer_cnt - prods[i].first;
+		prods[i].done = &done;
+
+		fid_t fid = fibril_create(producer, &prods[i]);
+		if (fid == 0) {
+			/*
+			 * Producers already started still need to have their
+			 * messages received before the run can be failed.
+			 */
+			spawned = false;
+			break;
+		}
+
+		fibril_add_ready(fid);
+		expected += prods[i].count;
+		started++;
+	}
+
+	for (uint64_t i = 0; i < expected; i++) {
+		uint64_t value;
+		if (!consume(&value)) {
+			ok = false;
+			break;
+		}
+	}
+
+	bench_run_stop(run);
+
+	for (uint64_t i = 0; i < started; i++)
+		fibril_semaphore_down(&done);
+
+	switch (queue_kind) {
+	case queue_mpsc:
+		mpsc_destroy(mpsc);
+		break;
+	case queue_mpmc:
+		mpmc_destroy(mpmc);
+		break;
+	case queue_prodcons:
+		free(msgs);
+		break;
+	}
+
+	free(prods);
+
+	if (!spawned)
+		return bench_run_fail(run, "failed to create producer fibril");
+
+	if (!ok)
+		return bench_run_fail(run, "failed to receive message");
+
+	return true;
+}
+
+benchmark_t benchmark_queue_xfer = {
+	.name = "queue_xfer",
+	.desc = "Pass messages from producer fibrils to a consumer (param "
+	    "'queue' is one of 'mpsc', 'mpmc' and 'prodcons', param "
+	    "'producers')",
+	.entry = &runner,
+	.setup = &setup,
+	.teardown = NULL
+};
+
+/** @}
+ */
@@ -55,14 +55,14 @@ typedef struct {
 } pending_call_t;
 
 typedef struct {
+	cap_phone_handle_t phone_handle;
 	int server;
 	proto_t *proto;
-} connection_t;
 
-#define MAX_PHONE 64
-connection_t connections[MAX_PHONE];
-int have_conn[MAX_PHONE];
+	ht_link_t link;
+} connection_t;
 
+static hash_table_t connections;
 static hash_table_t pending_calls;
 
 /*
@@ -99,22 +99,71 @@ static hash_table_ops_t pending_call_ops = {
 	.remove_callback = NULL
 };
 
+static size_t connection_key_hash(const void *key)
+{
+	const cap_phone_handle_t *phandle = key;
+	return cap_handle_raw(*phandle);
+}
+
+static size_t connection_hash(const ht_link_t *item)
+{
+	connection_t *conn = hash_table_get_inst(item, connection_t, link);
+	return cap_handle_raw(conn->phone_handle);
+}
+
+static bool connection_key_equal(const void *key, const ht_link_t *item)
+{
+	const cap_phone_handle_t *phandle = key;
+	connection_t *conn = hash_table_get_inst(item, connection_t, link);
+
+	return *phandle == conn->phone_handle;
+}
+
+static void connection_remove(ht_link_t *item)
+{
+	free(hash_table_get_inst(item, connection_t, link));
+}
+
+static hash_table_ops_t connection_ops = {
+	.hash = connection_hash,
+	.key_hash = connection_key_hash,
+	.key_equal = connection_key_equal,
+	.equal = NULL,
+	.remove_callback = connection_remove
+};
+
+static connection_t *ipcp_connection_find(cap_phone_handle_t phone)
+{
+	ht_link_t *item;
+
+	item = hash_table_find(&connections, &phone);
+	if (item == NULL)
+		return NULL;
+
+	return hash_table_get_inst(item, connection_t, link);
+}
+
 void ipcp_connection_set(cap_phone_handle_t phone, int server, proto_t *proto)
 {
-	// XXX: there is no longer a limit on the number of phones as phones are
-	// now handled using capabilities
-	if (cap_handle_raw(phone) < 0 || cap_handle_raw(phone) >= MAX_PHONE)
-		return;
-	connections[cap_handle_raw(phone)].server = server;
-	connections[cap_handle_raw(phone)].proto = proto;
-	have_conn[cap_handle_raw(phone)] = 1;
+	connection_t *conn;
+
+	conn = ipcp_connection_find(phone);
+	if (conn == NULL) {
+		conn = malloc(sizeof(connection_t));
+		if (conn == NULL)
+			return;
+
+		conn->phone_handle = phone;
+		hash_table_insert(&connections, &conn->link);
+	}
+
+	conn->server = server;
+	conn->proto = proto;
 }
 
 void ipcp_connection_clear(cap_phone_handle_t phone)
 {
-	have_conn[cap_handle_raw(phone)] = 0;
-	connections[cap_handle_raw(phone)].server = 0;
-	connections[cap_handle_raw(phone)].proto = NULL;
+	hash_table_remove(&connections, &phone);
 }
 
 static void ipc_m_print(proto_t *proto, sysarg_t method)
@@ -166,27 +215,30 @@ void ipcp_init(void)
 
 	bool ok = hash_table_create(&pending_calls, 0, 0, &pending_call_ops);
 	assert(ok);
+
+	ok = hash_table_create(&connections, 0, 0, &connection_ops);
+	assert(ok);
 }
 
 void ipcp_cleanup(void)
 {
 	proto_delete(proto_system);
 	hash_table_destroy(&pending_calls);
+	hash_table_destroy(&connections);
 }
 
 void ipcp_call_out(cap_phone_handle_t phandle, ipc_call_t *call,
     cap_call_handle_t chandle)
 {
 	pending_call_t *pcall;
+	connection_t *conn;
 	proto_t *proto;
 	oper_t *oper;
 	sysarg_t *args;
 	int i;
 
-	if (have_conn[cap_handle_raw(phandle)])
-		proto = connections[cap_handle_raw(phandle)].proto;
-	else
-		proto = NULL;
+	conn = ipcp_connection_find(phandle);
+	proto = (conn != NULL) ? conn->proto : NULL;
 
 	args = call->args;
 
@@ -349,10 +401,10 @@ void ipcp_call_in(ipc_call_t *call, cap_call_handle_t chandle)
 
 void ipcp_hangup(cap_phone_handle_t phone, errno_t rc)
 {
-	if ((display_mask & DM_SYSTEM) != 0) {
+	if ((display_mask & DM_SYSTEM) != 0)
 		printf("Hang up phone %p -> %s\n", phone, str_error_name(rc));
-		ipcp_connection_clear(phone);
-	}
+
+	ipcp_connection_clear(phone);
 }
 
 /** @}
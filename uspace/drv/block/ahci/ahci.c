@@ -31,7 +31,9 @@
  */
 
 #include <as.h>
+#include <assert.h>
 #include <errno.h>
+#include <macros.h>
 #include <stdio.h>
 #include <ddf/interrupt.h>
 #include <ddf/log.h>
@@ -116,8 +118,7 @@ static errno_t write_blocks(ddf_fun_t *, uint64_t, size_t, void *);
 
 static errno_t ahci_identify_device(sata_dev_t *);
 static errno_t ahci_set_highest_ultra_dma_mode(sata_dev_t *);
-static errno_t ahci_rb_fpdma(sata_dev_t *, uintptr_t, uint64_t);
-static errno_t ahci_wb_fpdma(sata_dev_t *, uintptr_t, uint64_t);
+static errno_t ahci_rw_blocks(sata_dev_t *, uint64_t, size_t, void *, bool);
 
 static void ahci_sata_devices_create(ahci_dev_t *, ddf_dev_t *);
 static ahci_dev_t *ahci_ahci_create(ddf_dev_t *);
@@ -229,32 +230,7 @@ static errno_t read_blocks(ddf_fun_t *fun, uint64_t blocknum,
 {
 	sata_dev_t *sata = fun_sata_dev(fun);
 
-	uintptr_t phys;
-	void *ibuf = AS_AREA_ANY;
-	errno_t rc = dmamem_map_anonymous(sata->block_size, DMAMEM_4GiB,
-	    AS_AREA_READ | AS_AREA_WRITE, 0, &phys, &ibuf);
-	if (rc != EOK) {
-		ddf_msg(LVL_ERROR, "Cannot allocate read buffer.");
-		return rc;
-	}
-
-	memset(buf, 0, sata->block_size);
-
-	fibril_mutex_lock(&sata->lock);
-
-	for (size_t cur = 0; cur < count; cur++) {
-		rc = ahci_rb_fpdma(sata, phys, blocknum + cur);
-		if (rc != EOK)
-			break;
-
-		memcpy((void *) (((uint8_t *) buf) + (sata->block_size * cur)),
-		    ibuf, sata->block_size);
-	}
-
-	fibril_mutex_unlock(&sata->lock);
-	dmamem_unmap_anonymous(ibuf);
-
-	return rc;
+	return ahci_rw_blocks(sata, blocknum, count, buf, false);
 }
 
 /** Write data blocks into SATA device.
@@ -272,29 +248,7 @@ static errno_t write_blocks(ddf_fun_t *fun, uint64_t blocknum,
 {
 	sata_dev_t *sata = fun_sata_dev(fun);
 
-	uintptr_t phys;
-	void *ibuf = AS_AREA_ANY;
-	errno_t rc = dmamem_map_anonymous(sata->block_size, DMAMEM_4GiB,
-	    AS_AREA_READ | AS_AREA_WRITE, 0, &phys, &ibuf);
-	if (rc != EOK) {
-		ddf_msg(LVL_ERROR, "Cannot allocate write buffer.");
-		return rc;
-	}
-
-	fibril_mutex_lock(&sata->lock);
-
-	for (size_t cur = 0; cur < count; cur++) {
-		memcpy(ibuf, (void *) (((uint8_t *) buf) + (sata->block_size * cur)),
-		    sata->block_size);
-		rc = ahci_wb_fpdma(sata, phys, blocknum + cur);
-		if (rc != EOK)
-			break;
-	}
-
-	fibril_mutex_unlock(&sata->lock);
-	dmamem_unmap_anonymous(ibuf);
-
-	return rc;
+	return ahci_rw_blocks(sata, blocknum, count, buf, true);
 }
 
 /*----------------------------------------------------------------------------*/
@@ -478,6 +432,9 @@ static errno_t ahci_identify_device(sata_dev_t *sata)
 		goto error;
 	}
 
+	/* Queue depth is limited further by the HBA later on */
+	sata->ncq_slots = min((idata->queue_depth & 0x1f) + 1U, AHCI_NCQ_SLOTS);
+
 	uint16_t logsec = idata->physical_logic_sector_size;
 	if ((logsec & 0xc000) == 0x4000) {
 		/* Length of sector may be larger than 512 B */
@@ -668,110 +625,80 @@ error:
 	return EINTR;
 }
 
-/** Set AHCI registers for reading one sector from the SATA device using FPDMA.
+/** Allocate a command slot.
  *
- * @param sata     SATA device structure.
- * @param phys     Physical address of buffer for sector data.
- * @param blocknum Block number to read.
+ * @param sata SATA device structure.
+ * @param wait Wait for a slot to become free if all of them are busy.
+ *
+ * @return Number of the allocated slot or -1 if no slot is free.
  *
  */
-static void ahci_rb_fpdma_cmd(sata_dev_t *sata, uintptr_t phys,
-    uint64_t blocknum)
+static int ahci_slot_alloc(sata_dev_t *sata, bool wait)
 {
-	volatile sata_ncq_command_frame_t *cmd =
-	    (sata_ncq_command_frame_t *) sata->cmd_table;
-
-	cmd->fis_type = SATA_CMD_FIS_TYPE;
-	cmd->c = SATA_CMD_FIS_COMMAND_INDICATOR;
-	cmd->command = 0x60;
-	cmd->tag = 0;
-	cmd->control = 0;
+	uint32_t all = (sata->ncq_slots == 32) ?
+	    0xffffffff : (1U << sata->ncq_slots) - 1;
 
-	cmd->reserved1 = 0;
-	cmd->reserved2 = 0;
-	cmd->reserved3 = 0;
-	cmd->reserved4 = 0;
-	cmd->reserved5 = 0;
-	cmd->reserved6 = 0;
+	fibril_mutex_lock(&sata->lock);
 
-	cmd->sector_count_low = 1;
-	cmd->sector_count_high = 0;
+	while ((sata->slots_busy & all) == all) {
+		if (!wait) {
+			fibril_mutex_unlock(&sata->lock);
+			return -1;
+		}
 
-	cmd->lba0 = blocknum & 0xff;
-	cmd->lba1 = (blocknum >> 8) & 0xff;
-	cmd->lba2 = (blocknum >> 16) & 0xff;
-	cmd->lba3 = (blocknum >> 24) & 0xff;
-	cmd->lba4 = (blocknum >> 32) & 0xff;
-	cmd->lba5 = (blocknum >> 40) & 0xff;
+		fibril_condvar_wait(&sata->slot_condvar, &sata->lock);
+	}
 
-	volatile ahci_cmd_prdt_t *prdt =
-	    (ahci_cmd_prdt_t *) (&sata->cmd_table[0x20]);
+	int slot = 0;
+	while ((sata->slots_busy & (1U << slot)) != 0)
+		slot++;
 
-	prdt->data_address_low = LO(phys);
-	prdt->data_address_upper = HI(phys);
-	prdt->reserved1 = 0;
-	prdt->dbc = sata->block_size - 1;
-	prdt->reserved2 = 0;
-	prdt->ioc = 0;
+	sata->slots_busy |= 1U << slot;
 
-	sata->cmd_header->prdtl = 1;
-	sata->cmd_header->flags =
-	    AHCI_CMDHDR_FLAGS_CLEAR_BUSY_UPON_OK |
-	    AHCI_CMDHDR_FLAGS_5DWCMD;
-	sata->cmd_header->bytesprocessed = 0;
+	fibril_mutex_unlock(&sata->lock);
 
-	sata->port->pxsact |= 1;
-	sata->port->pxci |= 1;
+	return slot;
 }
 
-/** Read one sector from the SATA device using FPDMA.
- *
- * @param sata     SATA device structure.
- * @param phys     Physical address of buffer for sector data.
- * @param blocknum Block number to read.
+/** Free a command slot.
  *
- * @return EOK if succeed, error code otherwise
+ * @param sata SATA device structure.
+ * @param slot Number of the slot.
  *
  */
-static errno_t ahci_rb_fpdma(sata_dev_t *sata, uintptr_t phys, uint64_t blocknum)
+static void ahci_slot_free(sata_dev_t *sata, unsigned int slot)
 {
-	if (sata->is_invalid_device) {
-		ddf_msg(LVL_ERROR,
-		    "%s: FPDMA read from invalid device", sata->model);
-		return EINTR;
-	}
+	fibril_mutex_lock(&sata->lock);
 
-	ahci_rb_fpdma_cmd(sata, phys, blocknum);
-	ahci_port_is_t pxis = ahci_wait_event(sata);
+	sata->slots_busy &= ~(1U << slot);
+	fibril_condvar_signal(&sata->slot_condvar);
 
-	if ((sata->is_invalid_device) || (ahci_port_is_error(pxis))) {
-		ddf_msg(LVL_ERROR,
-		    "%s: Unrecoverable error during FPDMA read", sata->model);
-		return EINTR;
-	}
-
-	return EOK;
+	fibril_mutex_unlock(&sata->lock);
 }
 
-/** Set AHCI registers for writing one sector to the SATA device, use FPDMA.
+/** Set AHCI registers for reading or writing sectors using FPDMA.
  *
- * @param sata     SATA device structure.
- * @param phys     Physical address of buffer with sector data.
- * @param blocknum Block number to write.
+ * The data buffer of the slot is described by as many physical region
+ * descriptors as needed.
  *
- * @return EOK if succeed, error code otherwise
+ * @param sata     SATA device structure.
+ * @param slot     Command slot, also used as the NCQ tag.
+ * @param write    Write sectors instead of reading them.
+ * @param blocknum Number of the first block.
+ * @param count    Number of blocks.
  *
  */
-static void ahci_wb_fpdma_cmd(sata_dev_t *sata, uintptr_t phys,
-    uint64_t blocknum)
+static void ahci_fpdma_cmd(sata_dev_t *sata, unsigned int slot, bool write,
+    uint64_t blocknum, size_t count)
 {
+	ahci_slot_t *sl = &sata->slots[slot];
 	volatile sata_ncq_command_frame_t *cmd =
-	    (sata_ncq_command_frame_t *) sata->cmd_table;
+	    (sata_ncq_command_frame_t *) sl->cmd_table;
 
 	cmd->fis_type = SATA_CMD_FIS_TYPE;
 	cmd->c = SATA_CMD_FIS_COMMAND_INDICATOR;
-	cmd->command = 0x61;
-	cmd->tag = 0;
+	cmd->command = write ? 0x61 : 0x60;
+	cmd->tag = slot << 3;
 	cmd->control = 0;
 
 	cmd->reserved1 = 0;
@@ -781,8 +708,8 @@ static void ahci_wb_fpdma_cmd(sata_dev_t *sata, uintptr_t phys,
 	cmd->reserved5 = 0;
 	cmd->reserved6 = 0;
 
-	cmd->sector_count_low = 1;
-	cmd->sector_count_high = 0;
+	cmd->sector_count_low = count & 0xff;
+	cmd->sector_count_high = (count >> 8) & 0xff;
 
 	cmd->lba0 = blocknum & 0xff;
 	cmd->lba1 = (blocknum >> 8) & 0xff;
@@ -792,53 +719,175 @@ static void ahci_wb_fpdma_cmd(sata_dev_t *sata, uintptr_t phys,
 	cmd->lba5 = (blocknum >> 40) & 0xff;
 
 	volatile ahci_cmd_prdt_t *prdt =
-	    (ahci_cmd_prdt_t *) (&sata->cmd_table[0x20]);
-
-	prdt->data_address_low = LO(phys);
-	prdt->data_address_upper = HI(phys);
-	prdt->reserved1 = 0;
-	prdt->dbc = sata->block_size - 1;
-	prdt->reserved2 = 0;
-	prdt->ioc = 0;
+	    (ahci_cmd_prdt_t *) (&sl->cmd_table[AHCI_CMD_TABLE_PRDT / 4]);
+
+	uintptr_t phys = sl->buf_phys;
+	size_t left = count * sata->block_size;
+	unsigned int prds = 0;
+
+	while (left > 0) {
+		size_t len = min(left, AHCI_PRD_MAX_BYTES);
+
+		assert(prds < AHCI_PRDT_ENTRIES);
+		prdt[prds].data_address_low = LO(phys);
+		prdt[prds].data_address_upper = HI(phys);
+		prdt[prds].reserved1 = 0;
+		prdt[prds].dbc = len - 1;
+		prdt[prds].reserved2 = 0;
+		prdt[prds].ioc = 0;
+
+		phys += len;
+		left -= len;
+		prds++;
+	}
 
-	sata->cmd_header->prdtl = 1;
-	sata->cmd_header->flags =
+	sl->cmd_header->prdtl = prds;
+	sl->cmd_header->flags =
 	    AHCI_CMDHDR_FLAGS_CLEAR_BUSY_UPON_OK |
-	    AHCI_CMDHDR_FLAGS_WRITE |
+	    (write ? AHCI_CMDHDR_FLAGS_WRITE : 0) |
 	    AHCI_CMDHDR_FLAGS_5DWCMD;
-	sata->cmd_header->bytesprocessed = 0;
+	sl->cmd_header->bytesprocessed = 0;
+}
 
-	sata->port->pxsact |= 1;
-	sata->port->pxci |= 1;
+/** Issue the command prepared in a command slot.
+ *
+ * @param sata SATA device structure.
+ * @param slot Command slot.
+ *
+ */
+static void ahci_fpdma_start(sata_dev_t *sata, unsigned int slot)
+{
+	fibril_mutex_lock(&sata->event_lock);
+
+	sata->slots[slot].done = false;
+
+	/* Only written ones take effect, do not touch the other slots. */
+	sata->port->pxsact = 1U << slot;
+	sata->port->pxci = 1U << slot;
+	sata->slots_active |= 1U << slot;
+
+	fibril_mutex_unlock(&sata->event_lock);
 }
 
-/** Write one sector into the SATA device, use FPDMA.
+/** Wait for the completion of the command issued in a command slot.
+ *
+ * @param sata SATA device structure.
+ * @param slot Command slot.
+ *
+ * @return EOK if succeed, error code otherwise
+ *
+ */
+static errno_t ahci_fpdma_wait(sata_dev_t *sata, unsigned int slot)
+{
+	ahci_slot_t *sl = &sata->slots[slot];
+
+	fibril_mutex_lock(&sata->event_lock);
+
+	while (!sl->done)
+		fibril_condvar_wait(&sata->slot_done_condvar, &sata->event_lock);
+
+	errno_t rc = sl->rc;
+
+	fibril_mutex_unlock(&sata->event_lock);
+
+	return rc;
+}
+
+/** Read or write sectors using FPDMA.
+ *
+ * The request is split into commands of at most AHCI_SLOT_BUF_SIZE bytes
+ * which are issued into as many free command slots as available and then
+ * reaped in order. Requests from other fibrils can use the remaining
+ * slots at the same time.
  *
  * @param sata     SATA device structure.
- * @param phys     Physical address of buffer with sector data.
- * @param blocknum Block number to write.
+ * @param blocknum Number of the first block.
+ * @param count    Number of blocks.
+ * @param buf      Buffer for data.
+ * @param write    Write the blocks instead of reading them.
  *
  * @return EOK if succeed, error code otherwise
  *
  */
-static errno_t ahci_wb_fpdma(sata_dev_t *sata, uintptr_t phys, uint64_t blocknum)
+static errno_t ahci_rw_blocks(sata_dev_t *sata, uint64_t blocknum,
+    size_t count, void *buf, bool write)
 {
-	if (sata->is_invalid_device) {
-		ddf_msg(LVL_ERROR,
-		    "%s: FPDMA write to invalid device", sata->model);
-		return EINTR;
-	}
+	size_t max_count = AHCI_SLOT_BUF_SIZE / sata->block_size;
+	unsigned int slot[AHCI_NCQ_SLOTS];
+	size_t cnt[AHCI_NCQ_SLOTS];
+	uint8_t *ibuf = (uint8_t *) buf;
+	uint8_t *cbuf = (uint8_t *) buf;
+	errno_t rc = EOK;
+
+	while (count > 0 && rc == EOK) {
+		unsigned int n = 0;
+
+		if (sata->is_invalid_device) {
+			ddf_msg(LVL_ERROR, "%s: FPDMA %s invalid device",
+			    sata->model, write ? "write to" : "read from");
+			return EINTR;
+		}
 
-	ahci_wb_fpdma_cmd(sata, phys, blocknum);
-	ahci_port_is_t pxis = ahci_wait_event(sata);
+		/*
+		 * Only wait for the first slot, so that fibrils holding some
+		 * slots while waiting for more cannot deadlock.
+		 */
+		while (count > 0 && n < AHCI_NCQ_SLOTS) {
+			int s = ahci_slot_alloc(sata, n == 0);
+			if (s < 0)
+				break;
+
+			ahci_slot_t *sl = &sata->slots[s];
+			if (sl->buf == NULL) {
+				sl->buf = AS_AREA_ANY;
+				rc = dmamem_map_anonymous(AHCI_SLOT_BUF_SIZE,
+				    DMAMEM_4GiB, AS_AREA_READ | AS_AREA_WRITE, 0,
+				    &sl->buf_phys, &sl->buf);
+				if (rc != EOK) {
+					ddf_msg(LVL_ERROR,
+					    "Cannot allocate slot buffer.");
+					sl->buf = NULL;
+					ahci_slot_free(sata, s);
+					break;
+				}
+			}
+
+			slot[n] = s;
+			cnt[n] = min(count, max_count);
+
+			if (write)
+				memcpy(sl->buf, ibuf, cnt[n] * sata->block_size);
+
+			ahci_fpdma_cmd(sata, s, write, blocknum, cnt[n]);
+			ahci_fpdma_start(sata, s);
+
+			ibuf += cnt[n] * sata->block_size;
+			blocknum += cnt[n];
+			count -= cnt[n];
+			n++;
+		}
 
-	if ((sata->is_invalid_device) || (ahci_port_is_error(pxis))) {
-		ddf_msg(LVL_ERROR,
-		    "%s: Unrecoverable error during FPDMA write", sata->model);
-		return EINTR;
+		for (unsigned int i = 0; i < n; i++) {
+			errno_t rc2 = ahci_fpdma_wait(sata, slot[i]);
+			if (rc2 != EOK) {
+				ddf_msg(LVL_ERROR,
+				    "%s: Unrecoverable error during FPDMA %s",
+				    sata->model, write ? "write" : "read");
+				if (rc == EOK)
+					rc = rc2;
+			}
+
+			if (!write && rc2 == EOK) {
+				memcpy(cbuf, sata->slots[slot[i]].buf,
+				    cnt[i] * sata->block_size);
+			}
+
+			cbuf += cnt[i] * sata->block_size;
+			ahci_slot_free(sata, slot[i]);
+		}
 	}
 
-	return EOK;
+	return rc;
 }
 
 /*----------------------------------------------------------------------------*/
@@ -914,6 +963,31 @@ static void ahci_interrupt(ipc_call_t *icall, ddf_dev_t *dev)
 		sata->event_pxis = pxis;
 		fibril_condvar_signal(&sata->event_condvar);
 
+		/*
+		 * Queued commands are complete once the device has cleared
+		 * their bits in SActive. An error aborts all of them.
+		 */
+		uint32_t done = sata->slots_active & ~sata->port->pxsact;
+		if (ahci_port_is_error(pxis))
+			done = sata->slots_active;
+
+		if (ahci_port_is_permanent_error(pxis))
+			sata->is_invalid_device = true;
+
+		if (done != 0) {
+			for (unsigned int i = 0; i < AHCI_NCQ_SLOTS; i++) {
+				if ((done & (1U << i)) == 0)
+					continue;
+
+				sata->slots[i].rc = ahci_port_is_error(pxis) ?
+				    EINTR : EOK;
+				sata->slots[i].done = true;
+			}
+
+			sata->slots_active &= ~done;
+			fibril_condvar_broadcast(&sata->slot_done_condvar);
+		}
+
 		fibril_mutex_unlock(&sata->event_lock);
 	}
 }
@@ -968,16 +1042,31 @@ static sata_dev_t *ahci_sata_allocate(ahci_dev_t *ahci, volatile ahci_port_t *po
 	sata->port->pxclb = LO(phys);
 	sata->cmd_header = (ahci_cmdhdr_t *) virt_cmd;
 
-	/* Allocate and init command table structure. */
-	rc = dmamem_map_anonymous(size, DMAMEM_4GiB,
-	    AS_AREA_READ | AS_AREA_WRITE, 0, &phys, &virt_table);
+	/* Allocate and init command table structures for all slots. */
+	rc = dmamem_map_anonymous(AHCI_NCQ_SLOTS * AHCI_CMD_TABLE_SIZE,
+	    DMAMEM_4GiB, AS_AREA_READ | AS_AREA_WRITE, 0, &phys, &virt_table);
 	if (rc != EOK)
 		goto error_table;
 
-	memset(virt_table, 0, size);
-	sata->cmd_header->cmdtableu = HI(phys);
-	sata->cmd_header->cmdtable = LO(phys);
-	sata->cmd_table = (uint32_t *) virt_table;
+	memset(virt_table, 0, AHCI_NCQ_SLOTS * AHCI_CMD_TABLE_SIZE);
+
+	for (unsigned int i = 0; i < AHCI_NCQ_SLOTS; i++) {
+		ahci_slot_t *sl = &sata->slots[i];
+
+		sl->cmd_header = (ahci_cmdhdr_t *)
+		    ((uint8_t *) virt_cmd + i * AHCI_CMDHDR_SIZE);
+		sl->cmd_table = (uint32_t *)
+		    ((uint8_t *) virt_table + i * AHCI_CMD_TABLE_SIZE);
+		sl->cmd_header->cmdtableu = HI(phys + i * AHCI_CMD_TABLE_SIZE);
+		sl->cmd_header->cmdtable = LO(phys + i * AHCI_CMD_TABLE_SIZE);
+		sl->buf = NULL;
+	}
+
+	/* Slot 0 is used for non-queued commands. */
+	sata->cmd_table = sata->slots[0].cmd_table;
+	sata->ncq_slots = 1;
+	sata->slots_busy = 0;
+	sata->slots_active = 0;
 
 	return sata;
 
@@ -1056,6 +1145,8 @@ static errno_t ahci_sata_create(ahci_dev_t *ahci, ddf_dev_t *dev,
 	fibril_mutex_initialize(&sata->lock);
 	fibril_mutex_initialize(&sata->event_lock);
 	fibril_condvar_initialize(&sata->event_condvar);
+	fibril_condvar_initialize(&sata->slot_condvar);
+	fibril_condvar_initialize(&sata->slot_done_condvar);
 
 	ahci_sata_hw_start(sata);
 
@@ -1067,6 +1158,11 @@ static errno_t ahci_sata_create(ahci_dev_t *ahci, ddf_dev_t *dev,
 	if (ahci_set_highest_ultra_dma_mode(sata) != EOK)
 		goto error;
 
+	/* Use as many command slots as both the HBA and the device support */
+	ahci_ghc_cap_t cap;
+	cap.u32 = ahci->memregs->ghc.cap;
+	sata->ncq_slots = min(sata->ncq_slots, cap.ncs + 1U);
+
 	/* Add device to the system */
 	char sata_dev_name[16];
 	snprintf(sata_dev_name, 16, "ahci_%u", sata_devices_count);
@@ -40,6 +40,28 @@
 #include <stdint.h>
 #include "ahci_hw.h"
 
+/** Maximum number of outstanding NCQ commands per port. */
+#define AHCI_NCQ_SLOTS  32
+
+/** Size of a command header in the command list. */
+#define AHCI_CMDHDR_SIZE  32
+
+/** Size of the command table of a command slot. */
+#define AHCI_CMD_TABLE_SIZE  256
+
+/** Offset of the physical region descriptor table in a command table. */
+#define AHCI_CMD_TABLE_PRDT  0x80
+
+/** Number of physical region descriptors in a command table. */
+#define AHCI_PRDT_ENTRIES \
+	((AHCI_CMD_TABLE_SIZE - AHCI_CMD_TABLE_PRDT) / sizeof(ahci_cmd_prdt_t))
+
+/** Maximum number of bytes described by a physical region descriptor. */
+#define AHCI_PRD_MAX_BYTES  (4 * 1024 * 1024)
+
+/** Size of DMA buffer of a command slot. */
+#define AHCI_SLOT_BUF_SIZE  (64 * 1024)
+
 /** AHCI Device. */
 typedef struct {
 	/** Pointer to ddf device. */
@@ -55,6 +77,27 @@ typedef struct {
 	async_sess_t *parent_sess;
 } ahci_dev_t;
 
+/** NCQ command slot. */
+typedef struct {
+	/** Pointer to command header of the slot. */
+	volatile ahci_cmdhdr_t *cmd_header;
+
+	/** Pointer to command table of the slot. */
+	volatile uint32_t *cmd_table;
+
+	/** DMA buffer for data, allocated on first use. */
+	void *buf;
+
+	/** Physical address of the DMA buffer. */
+	uintptr_t buf_phys;
+
+	/** Command completed. */
+	bool done;
+
+	/** Result of the completed command. */
+	errno_t rc;
+} ahci_slot_t;
+
 /** SATA Device. */
 typedef struct {
 	/** Pointer to AHCI device. */
@@ -78,9 +121,27 @@ typedef struct {
 	/** Pointer to command table. */
 	volatile uint32_t *cmd_table;
 
-	/** Mutex for single operation on device. */
+	/** Mutex for single operation on device and for slot allocation. */
 	fibril_mutex_t lock;
 
+	/** Condition variable signalled when a command slot is freed. */
+	fibril_condvar_t slot_condvar;
+
+	/** Number of command slots used for NCQ. */
+	unsigned int ncq_slots;
+
+	/** Bitmap of allocated command slots. */
+	uint32_t slots_busy;
+
+	/** Bitmap of issued commands which have not completed yet. */
+	uint32_t slots_active;
+
+	/** Condition variable signalled when commands complete. */
+	fibril_condvar_t slot_done_condvar;
+
+	/** NCQ command slots. */
+	ahci_slot_t slots[AHCI_NCQ_SLOTS];
+
 	/** Mutex for event signaling condition variable. */
 	fibril_mutex_t event_lock;
 
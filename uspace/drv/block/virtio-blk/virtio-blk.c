@@ -30,6 +30,7 @@
 
 #include <stdio.h>
 #include <stdint.h>
+#include <macros.h>
 
 #include <as.h>
 #include <ddf/driver.h>
@@ -56,6 +57,10 @@
  * used for request headers, the following RQ_BUFFERS descriptors are used
  * for in/out buffers and the last RQ_BUFFERS descriptors are used for request
  * footers.
+ *
+ * If the device supports indirect descriptors, the three descriptors of a
+ * request are kept in a per-request indirect table instead and only the
+ * first RQ_BUFFERS descriptors of the virtqueue are used.
  */
 #define REQ_HEADER_DESC(descno)	(0 * RQ_BUFFERS + (descno))
 #define REQ_BUFFER_DESC(descno)	(1 * RQ_BUFFERS + (descno))
@@ -83,6 +88,7 @@ static void virtio_blk_irq_handler(ipc_call_t *icall, ddf_dev_t *dev)
 	while (virtio_virtq_consume_used(vdev, RQ_QUEUE, &descno, &len)) {
 		assert(descno < RQ_BUFFERS);
 		fibril_mutex_lock(&virtio_blk->completion_lock[descno]);
+		virtio_blk->completion_done[descno] = true;
 		fibril_condvar_signal(&virtio_blk->completion_cv[descno]);
 		fibril_mutex_unlock(&virtio_blk->completion_lock[descno]);
 	}
@@ -157,22 +163,26 @@ static errno_t virtio_blk_bd_close(bd_srv_t *bd)
 	return EOK;
 }
 
-static errno_t virtio_blk_rw_block(virtio_blk_t *virtio_blk, bool read,
-    aoff64_t ba, void *buf)
+/** Allocate a request slot
+ *
+ * The allocated descno determines the header descriptor (REQ_HEADER_DESC),
+ * the buffer descriptor (REQ_BUFFER_DESC), the footer descriptor
+ * (REQ_FOOTER_DESC) and all DMA buffers of the request.
+ *
+ * @param virtio_blk  Virtio-blk device
+ * @param wait        Wait for a free slot if none is available
+ *
+ * @return Slot number or (uint16_t) -1U if @a wait is false and no slot
+ *         is free
+ */
+static uint16_t virtio_blk_rq_alloc(virtio_blk_t *virtio_blk, bool wait)
 {
 	virtio_dev_t *vdev = &virtio_blk->virtio_dev;
 
-	/*
-	 * Allocate a descriptor.
-	 *
-	 * The allocated descno will determine the header descriptor
-	 * (REQ_HEADER_DESC), the buffer descriptor (REQ_BUFFER_DESC) and the
-	 * footer (REQ_FOOTER_DESC) descriptor.
-	 */
 	fibril_mutex_lock(&virtio_blk->free_lock);
 	uint16_t descno = virtio_alloc_desc(vdev, RQ_QUEUE,
 	    &virtio_blk->rq_free_head);
-	while (descno == (uint16_t) -1U) {
+	while (wait && descno == (uint16_t) -1U) {
 		fibril_condvar_wait(&virtio_blk->free_cv,
 		    &virtio_blk->free_lock);
 		descno = virtio_alloc_desc(vdev, RQ_QUEUE,
@@ -180,7 +190,39 @@ static errno_t virtio_blk_rw_block(virtio_blk_t *virtio_blk, bool read,
 	}
 	fibril_mutex_unlock(&virtio_blk->free_lock);
 
-	assert(descno < RQ_BUFFERS);
+	assert(descno == (uint16_t) -1U || descno < RQ_BUFFERS);
+	return descno;
+}
+
+/** Return a request slot to the free list */
+static void virtio_blk_rq_free(virtio_blk_t *virtio_blk, uint16_t descno)
+{
+	virtio_dev_t *vdev = &virtio_blk->virtio_dev;
+
+	fibril_mutex_lock(&virtio_blk->free_lock);
+	virtio_free_desc(vdev, RQ_QUEUE, &virtio_blk->rq_free_head, descno);
+	fibril_condvar_signal(&virtio_blk->free_cv);
+	fibril_mutex_unlock(&virtio_blk->free_lock);
+}
+
+/** Make a request available to the device
+ *
+ * The device is not notified, the caller is expected to call
+ * virtio_virtq_notify() once it has submitted all requests of a batch.
+ * Write data must already be in the request's DMA buffer.
+ *
+ * @param virtio_blk  Virtio-blk device
+ * @param descno      Request slot
+ * @param read        @c true for read, @c false for write
+ * @param ba          Starting block address
+ * @param cnt         Number of blocks, at most RQ_BUF_BLOCKS
+ */
+static void virtio_blk_rq_submit(virtio_blk_t *virtio_blk, uint16_t descno,
+    bool read, aoff64_t ba, size_t cnt)
+{
+	virtio_dev_t *vdev = &virtio_blk->virtio_dev;
+
+	assert(cnt > 0 && cnt <= RQ_BUF_BLOCKS);
 
 	/* Setup the request header */
 	virtio_blk_req_header_t *req_header =
@@ -190,86 +232,146 @@ static errno_t virtio_blk_rw_block(virtio_blk_t *virtio_blk, bool read,
 	    read ? VIRTIO_BLK_T_IN : VIRTIO_BLK_T_OUT);
 	pio_write_le64(&req_header->sector, ba);
 
-	/* Copy write data to the request. */
-	if (!read)
-		memcpy(virtio_blk->rq_buf[descno], buf, VIRTIO_BLK_BLOCK_SIZE);
-
-	fibril_mutex_lock(&virtio_blk->completion_lock[descno]);
+	uint32_t len = cnt * VIRTIO_BLK_BLOCK_SIZE;
+	uint16_t buf_flags = read ? VIRTQ_DESC_F_WRITE : 0;
+
+	if (vdev->features & VIRTIO_F_INDIRECT_DESC) {
+		/*
+		 * The whole chain lives in the request's indirect table so
+		 * that the request occupies just one descriptor of the
+		 * virtqueue.
+		 */
+		virtq_desc_t *d = virtio_blk->rq_indirect[descno];
+		virtio_desc_set(&d[0], virtio_blk->rq_header_p[descno],
+		    sizeof(virtio_blk_req_header_t), VIRTQ_DESC_F_NEXT, 1);
+		virtio_desc_set(&d[1], virtio_blk->rq_buf_p[descno], len,
+		    VIRTQ_DESC_F_NEXT | buf_flags, 2);
+		virtio_desc_set(&d[2], virtio_blk->rq_footer_p[descno],
+		    sizeof(virtio_blk_req_footer_t), VIRTQ_DESC_F_WRITE, 0);
+
+		virtio_virtq_desc_set(vdev, RQ_QUEUE, REQ_HEADER_DESC(descno),
+		    virtio_blk->rq_indirect_p[descno],
+		    sizeof(virtq_desc_t[RQ_INDIRECT_DESCS]),
+		    VIRTQ_DESC_F_INDIRECT, 0);
+	} else {
+		virtio_virtq_desc_set(vdev, RQ_QUEUE, REQ_HEADER_DESC(descno),
+		    virtio_blk->rq_header_p[descno],
+		    sizeof(virtio_blk_req_header_t), VIRTQ_DESC_F_NEXT,
+		    REQ_BUFFER_DESC(descno));
+		virtio_virtq_desc_set(vdev, RQ_QUEUE, REQ_BUFFER_DESC(descno),
+		    virtio_blk->rq_buf_p[descno], len,
+		    VIRTQ_DESC_F_NEXT | buf_flags, REQ_FOOTER_DESC(descno));
+		virtio_virtq_desc_set(vdev, RQ_QUEUE, REQ_FOOTER_DESC(descno),
+		    virtio_blk->rq_footer_p[descno],
+		    sizeof(virtio_blk_req_footer_t), VIRTQ_DESC_F_WRITE, 0);
+	}
 
-	/*
-	 * Set the descriptors, chain them in the virtqueue and notify the
-	 * device.
-	 */
-	virtio_virtq_desc_set(vdev, RQ_QUEUE, REQ_HEADER_DESC(descno),
-	    virtio_blk->rq_header_p[descno], sizeof(virtio_blk_req_header_t),
-	    VIRTQ_DESC_F_NEXT, REQ_BUFFER_DESC(descno));
-	virtio_virtq_desc_set(vdev, RQ_QUEUE, REQ_BUFFER_DESC(descno),
-	    virtio_blk->rq_buf_p[descno], VIRTIO_BLK_BLOCK_SIZE,
-	    VIRTQ_DESC_F_NEXT | (read ? VIRTQ_DESC_F_WRITE : 0),
-	    REQ_FOOTER_DESC(descno));
-	virtio_virtq_desc_set(vdev, RQ_QUEUE, REQ_FOOTER_DESC(descno),
-	    virtio_blk->rq_footer_p[descno], sizeof(virtio_blk_req_footer_t),
-	    VIRTQ_DESC_F_WRITE, 0);
-	virtio_virtq_produce_available(vdev, RQ_QUEUE, descno);
+	virtio_virtq_enqueue_available(vdev, RQ_QUEUE, descno);
+}
 
-	/*
-	 * Wait for the completion of the request.
-	 */
-	fibril_condvar_wait(&virtio_blk->completion_cv[descno],
-	    &virtio_blk->completion_lock[descno]);
+/** Wait for completion of a submitted request
+ *
+ * @param virtio_blk  Virtio-blk device
+ * @param descno      Request slot
+ *
+ * @return EOK on success or an error code returned by the device
+ */
+static errno_t virtio_blk_rq_wait(virtio_blk_t *virtio_blk, uint16_t descno)
+{
+	fibril_mutex_lock(&virtio_blk->completion_lock[descno]);
+	while (!virtio_blk->completion_done[descno]) {
+		fibril_condvar_wait(&virtio_blk->completion_cv[descno],
+		    &virtio_blk->completion_lock[descno]);
+	}
+	virtio_blk->completion_done[descno] = false;
 	fibril_mutex_unlock(&virtio_blk->completion_lock[descno]);
 
-	errno_t rc;
 	virtio_blk_req_footer_t *footer =
 	    (virtio_blk_req_footer_t *) virtio_blk->rq_footer[descno];
 	switch (footer->status) {
 	case VIRTIO_BLK_S_OK:
-		rc = EOK;
-		break;
+		return EOK;
 	case VIRTIO_BLK_S_IOERR:
-		rc = EIO;
-		break;
+		return EIO;
 	case VIRTIO_BLK_S_UNSUPP:
-		rc = ENOTSUP;
-		break;
+		return ENOTSUP;
 	default:
 		ddf_msg(LVL_DEBUG, "device returned unknown status=%d\n",
 		    (int) footer->status);
-		rc = EIO;
-		break;
+		return EIO;
 	}
-
-	/* Copy read data from the request */
-	if (rc == EOK && read)
-		memcpy(buf, virtio_blk->rq_buf[descno], VIRTIO_BLK_BLOCK_SIZE);
-
-	/* Free the descriptor and buffer */
-	fibril_mutex_lock(&virtio_blk->free_lock);
-	virtio_free_desc(vdev, RQ_QUEUE, &virtio_blk->rq_free_head, descno);
-	fibril_condvar_signal(&virtio_blk->free_cv);
-	fibril_mutex_unlock(&virtio_blk->free_lock);
-
-	return rc;
 }
 
+/** Read or write blocks
+ *
+ * The transfer is split into requests of up to RQ_BUF_BLOCKS blocks each.
+ * As many requests as there are free slots are submitted before the device
+ * is notified once for the whole batch. Only the first request of a batch
+ * may wait for a free slot, the rest is deferred to the next batch, so that
+ * a fibril never sleeps while it holds unsubmitted slots.
+ */
 static errno_t virtio_blk_bd_rw_blocks(bd_srv_t *bd, aoff64_t ba, size_t cnt,
     void *buf, size_t size, bool read)
 {
 	virtio_blk_t *virtio_blk = (virtio_blk_t *) bd->srvs->sarg;
-	aoff64_t i;
-	errno_t rc;
+	virtio_dev_t *vdev = &virtio_blk->virtio_dev;
+	uint16_t rq_descno[RQ_BUFFERS];
+	size_t rq_cnt[RQ_BUFFERS];
+	errno_t rc = EOK;
 
 	if (size != cnt * VIRTIO_BLK_BLOCK_SIZE)
 		return EINVAL;
 
-	for (i = 0; i < cnt; i++) {
-		rc = virtio_blk_rw_block(virtio_blk, read, ba + i,
-		    buf + i * VIRTIO_BLK_BLOCK_SIZE);
-		if (rc != EOK)
-			return rc;
+	while (cnt > 0 && rc == EOK) {
+		unsigned n = 0;
+		uint8_t *bp = buf;
+
+		while (n < RQ_BUFFERS && cnt > 0) {
+			uint16_t descno = virtio_blk_rq_alloc(virtio_blk,
+			    n == 0);
+			if (descno == (uint16_t) -1U)
+				break;
+
+			size_t nblocks = min(cnt, (size_t) RQ_BUF_BLOCKS);
+
+			/* Copy write data to the request. */
+			if (!read) {
+				memcpy(virtio_blk->rq_buf[descno], buf,
+				    nblocks * VIRTIO_BLK_BLOCK_SIZE);
+			}
+
+			virtio_blk_rq_submit(virtio_blk, descno, read, ba,
+			    nblocks);
+
+			rq_descno[n] = descno;
+			rq_cnt[n] = nblocks;
+			n++;
+
+			ba += nblocks;
+			cnt -= nblocks;
+			buf += nblocks * VIRTIO_BLK_BLOCK_SIZE;
+		}
+
+		virtio_virtq_notify(vdev, RQ_QUEUE);
+
+		for (unsigned i = 0; i < n; i++) {
+			errno_t rrc = virtio_blk_rq_wait(virtio_blk,
+			    rq_descno[i]);
+
+			/* Copy read data from the request */
+			if (rrc == EOK && read) {
+				memcpy(bp, virtio_blk->rq_buf[rq_descno[i]],
+				    rq_cnt[i] * VIRTIO_BLK_BLOCK_SIZE);
+			}
+			if (rc == EOK)
+				rc = rrc;
+
+			bp += rq_cnt[i] * VIRTIO_BLK_BLOCK_SIZE;
+			virtio_blk_rq_free(virtio_blk, rq_descno[i]);
+		}
 	}
 
-	return EOK;
+	return rc;
 }
 
 static errno_t virtio_blk_bd_read_blocks(bd_srv_t *bd, aoff64_t ba, size_t cnt,
@@ -325,6 +427,7 @@ static errno_t virtio_blk_initialize(ddf_dev_t *dev)
 	bd_srvs_init(&virtio_blk->bds);
 	virtio_blk->bds.ops = &virtio_blk_bd_ops;
 	virtio_blk->bds.sarg = virtio_blk;
+	virtio_blk->bds.queue_depth = RQ_BUFFERS;
 
 	errno_t rc = virtio_pci_dev_initialize(dev, &virtio_blk->virtio_dev);
 	if (rc != EOK)
@@ -341,10 +444,12 @@ static errno_t virtio_blk_initialize(ddf_dev_t *dev)
 		goto fail;
 
 	/* Reset the device and negotiate the feature bits */
-	rc = virtio_device_setup_start(vdev, 0);
+	rc = virtio_device_setup_start_opt(vdev, 0, VIRTIO_F_INDIRECT_DESC);
 	if (rc != EOK)
 		goto fail;
 
+	bool indirect = (vdev->features & VIRTIO_F_INDIRECT_DESC) != 0;
+
 	/* Perform device-specific setup */
 
 	/*
@@ -364,8 +469,12 @@ static errno_t virtio_blk_initialize(ddf_dev_t *dev)
 		goto fail;
 	}
 
-	/* For each in/out request we need 3 descriptors */
-	rc = virtio_virtq_setup(vdev, RQ_QUEUE, 3 * RQ_BUFFERS);
+	/*
+	 * For each in/out request we need 3 descriptors, unless they are
+	 * indirect.
+	 */
+	rc = virtio_virtq_setup(vdev, RQ_QUEUE,
+	    indirect ? RQ_BUFFERS : 3 * RQ_BUFFERS);
 	if (rc != EOK)
 		goto fail;
 
@@ -376,7 +485,7 @@ static errno_t virtio_blk_initialize(ddf_dev_t *dev)
 	    true, virtio_blk->rq_header, virtio_blk->rq_header_p);
 	if (rc != EOK)
 		goto fail;
-	rc = virtio_setup_dma_bufs(RQ_BUFFERS, VIRTIO_BLK_BLOCK_SIZE,
+	rc = virtio_setup_dma_bufs(RQ_BUFFERS, RQ_BUF_SIZE,
 	    true, virtio_blk->rq_buf, virtio_blk->rq_buf_p);
 	if (rc != EOK)
 		goto fail;
@@ -384,6 +493,13 @@ static errno_t virtio_blk_initialize(ddf_dev_t *dev)
 	    false, virtio_blk->rq_footer, virtio_blk->rq_footer_p);
 	if (rc != EOK)
 		goto fail;
+	if (indirect) {
+		rc = virtio_setup_dma_bufs(RQ_BUFFERS,
+		    sizeof(virtq_desc_t[RQ_INDIRECT_DESCS]), true,
+		    virtio_blk->rq_indirect, virtio_blk->rq_indirect_p);
+		if (rc != EOK)
+			goto fail;
+	}
 
 	/*
 	 * Put all request descriptors on a free list. Because of the
@@ -415,6 +531,7 @@ fail:
 	virtio_teardown_dma_bufs(virtio_blk->rq_header);
 	virtio_teardown_dma_bufs(virtio_blk->rq_buf);
 	virtio_teardown_dma_bufs(virtio_blk->rq_footer);
+	virtio_teardown_dma_bufs(virtio_blk->rq_indirect);
 
 	virtio_device_setup_fail(vdev);
 	virtio_pci_dev_cleanup(vdev);
@@ -428,6 +545,7 @@ static void virtio_blk_uninitialize(ddf_dev_t *dev)
 	virtio_teardown_dma_bufs(virtio_blk->rq_header);
 	virtio_teardown_dma_bufs(virtio_blk->rq_buf);
 	virtio_teardown_dma_bufs(virtio_blk->rq_footer);
+	virtio_teardown_dma_bufs(virtio_blk->rq_indirect);
 
 	virtio_device_setup_fail(&virtio_blk->virtio_dev);
 	virtio_pci_dev_cleanup(&virtio_blk->virtio_dev);
@@ -46,8 +46,16 @@
 #define VIRTIO_BLK_S_IOERR	1
 #define VIRTIO_BLK_S_UNSUPP	2
 
+/** Number of requests that can be in flight at the same time */
 #define RQ_BUFFERS	32
 
+/** Size of the DMA data buffer of one request */
+#define RQ_BUF_SIZE	(64 * 1024)
+#define RQ_BUF_BLOCKS	(RQ_BUF_SIZE / VIRTIO_BLK_BLOCK_SIZE)
+
+/** Number of entries in the indirect descriptor table of one request */
+#define RQ_INDIRECT_DESCS	3
+
 /** Device is read-only. */
 #define VIRTIO_BLK_F_RO		(1U << 5)
 
@@ -77,6 +85,10 @@ typedef struct {
 	void *rq_footer[RQ_BUFFERS];
 	uintptr_t rq_footer_p[RQ_BUFFERS];
 
+	/** Indirect descriptor tables, used if VIRTIO_F_INDIRECT_DESC */
+	void *rq_indirect[RQ_BUFFERS];
+	uintptr_t rq_indirect_p[RQ_BUFFERS];
+
 	uint16_t rq_free_head;
 
 	int irq;
@@ -89,6 +101,7 @@ typedef struct {
 
 	fibril_mutex_t completion_lock[RQ_BUFFERS];
 	fibril_condvar_t completion_cv[RQ_BUFFERS];
+	bool completion_done[RQ_BUFFERS];
 } virtio_blk_t;
 
 #endif
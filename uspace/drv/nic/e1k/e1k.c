@@ -159,6 +159,9 @@ typedef struct {
 	/** Used milticast Receive addrress count */
 	unsigned int multicast_ra_count;
 
+	/** Value of the RXCSUM register */
+	uint32_t rxcsum;
+
 	/** The irq assigned */
 	int irq;
 
@@ -1159,7 +1162,32 @@ static uint32_t e1000_inc_tail(uint32_t tail, uint32_t descriptors_count)
 		return tail + 1;
 }
 
+/** Check result of hardware checksum verification
+ *
+ * @param rx_descriptor Receive descriptor
+ *
+ * @return false if the hardware found a bad checksum, true otherwise
+ *
+ */
+static bool e1000_rx_csum_ok(e1000_rx_descriptor_t *rx_descriptor)
+{
+	uint8_t errors = 0;
+
+	if ((rx_descriptor->status & RXDESCRIPTOR_STATUS_IXSM) != 0)
+		return true;
+
+	if ((rx_descriptor->status & RXDESCRIPTOR_STATUS_IPCS) != 0)
+		errors |= RXDESCRIPTOR_ERRORS_IPE;
+	if ((rx_descriptor->status & RXDESCRIPTOR_STATUS_TCPCS) != 0)
+		errors |= RXDESCRIPTOR_ERRORS_TCPE;
+
+	return (rx_descriptor->errors & errors) == 0;
+}
+
 /** Receive frames
+ *
+ * Frames which fail checksum verification in hardware (if enabled) are
+ * dropped so that the protocol stack does not need to verify them again.
  *
  * @param nic NIC data
  *
@@ -1176,14 +1204,21 @@ static void e1000_receive_frames(nic_t *nic)
 	e1000_rx_descriptor_t *rx_descriptor = (e1000_rx_descriptor_t *)
 	    (e1000->rx_ring_virt + next_tail * sizeof(e1000_rx_descriptor_t));
 
-	while (rx_descriptor->status & 0x01) {
+	while (rx_descriptor->status & RXDESCRIPTOR_STATUS_DD) {
 		uint32_t frame_size = rx_descriptor->length - E1000_CRC_SIZE;
 
-		nic_frame_t *frame = nic_alloc_frame(nic, frame_size);
+		nic_frame_t *frame = NULL;
+		if (e1000_rx_csum_ok(rx_descriptor)) {
+			frame = nic_alloc_frame(nic, frame_size);
+		} else {
+			/* Frame failed hardware checksum verification */
+			nic_report_receive_error(nic, NIC_REC_OTHER, 1);
+		}
+
 		if (frame != NULL) {
 			memcpy(frame->data, e1000->rx_frame_virt[next_tail], frame_size);
 			nic_received_frame(nic, frame);
-		} else {
+		} else if (e1000_rx_csum_ok(rx_descriptor)) {
 			ddf_msg(LVL_ERROR, "Memory allocation failed. Frame dropped.");
 		}
 
@@ -1363,6 +1398,40 @@ static void e1000_initialize_rx_registers(e1000_t *e1000)
 
 	/* Set Broadcast Enable Bit */
 	E1000_REG_WRITE(e1000, E1000_RCTL, RCTL_BAM);
+
+	E1000_REG_WRITE(e1000, E1000_RXCSUM, e1000->rxcsum);
+}
+
+/** Change active offload computations
+ *
+ * @param nic    NIC data
+ * @param active New set of active offloads
+ *
+ * @return EOK if succeed
+ * @return ENOTSUP if the combination is not supported
+ *
+ */
+static errno_t e1000_on_offload_change(nic_t *nic, uint32_t active)
+{
+	e1000_t *e1000 = DRIVER_DATA_NIC(nic);
+	uint32_t rxcsum = 0;
+
+	/* TCP and UDP checksum offload cannot be enabled separately */
+	if (((active & NIC_OFFLOAD_TCP_CSUM_RX) != 0) !=
+	    ((active & NIC_OFFLOAD_UDP_CSUM_RX) != 0))
+		return ENOTSUP;
+
+	if ((active & NIC_OFFLOAD_IPV4_CSUM_RX) != 0)
+		rxcsum |= RXCSUM_IPOFL;
+	if ((active & NIC_OFFLOAD_TCP_CSUM_RX) != 0)
+		rxcsum |= RXCSUM_TUOFL;
+
+	fibril_mutex_lock(&e1000->rx_lock);
+	e1000->rxcsum = rxcsum;
+	E1000_REG_WRITE(e1000, E1000_RXCSUM, rxcsum);
+	fibril_mutex_unlock(&e1000->rx_lock);
+
+	return EOK;
 }
 
 /** Initialize receive structure
@@ -1898,6 +1967,8 @@ static e1000_t *e1000_create_dev_data(ddf_dev_t *dev)
 	    e1000_on_unicast_mode_change, e1000_on_multicast_mode_change,
 	    e1000_on_broadcast_mode_change, NULL, e1000_on_vlan_mask_change);
 	nic_set_poll_handlers(nic, e1000_poll_mode_change, e1000_poll);
+	nic_set_offload_handler(nic, NIC_OFFLOAD_CSUM_RX, 0,
+	    e1000_on_offload_change);
 
 	fibril_mutex_initialize(&e1000->ctrl_lock);
 	fibril_mutex_initialize(&e1000->rx_lock);
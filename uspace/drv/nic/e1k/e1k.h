@@ -114,6 +114,20 @@ typedef enum {
 	TXDESCRIPTOR_COMMAND_EOP = (1 << 0)    /**< End Of Packet */
 } e1000_txdescriptor_command_t;
 
+/** Receive descriptor STATUS field bits */
+typedef enum {
+	RXDESCRIPTOR_STATUS_DD = (1 << 0),     /**< Descriptor Done */
+	RXDESCRIPTOR_STATUS_IXSM = (1 << 2),   /**< Ignore Checksum Indication */
+	RXDESCRIPTOR_STATUS_TCPCS = (1 << 5),  /**< TCP/UDP Checksum Calculated */
+	RXDESCRIPTOR_STATUS_IPCS = (1 << 6)    /**< IPv4 Checksum Calculated */
+} e1000_rxdescriptor_status_t;
+
+/** Receive descriptor ERRORS field bits */
+typedef enum {
+	RXDESCRIPTOR_ERRORS_TCPE = (1 << 5),  /**< TCP/UDP Checksum Error */
+	RXDESCRIPTOR_ERRORS_IPE = (1 << 6)    /**< IPv4 Checksum Error */
+} e1000_rxdescriptor_errors_t;
+
 /** Transmit descriptor STATUS field bits */
 typedef enum {
 	TXDESCRIPTOR_STATUS_DD = (1 << 0)  /**< Descriptor Done */
@@ -137,6 +151,7 @@ typedef enum {
 	E1000_RDLEN = 0x2808,  /**< Receive Descriptor Length */
 	E1000_RDH = 0x2810,    /**< Receive Descriptor Head */
 	E1000_RDT = 0x2818,    /**< Receive Descriptor Tail */
+	E1000_RXCSUM = 0x5000, /**< Receive Checksum Control */
 	E1000_RAL = 0x5400,    /**< Receive Address Low */
 	E1000_RAH = 0x5404,    /**< Receive Address High */
 	E1000_VFTA = 0x5600,   /**< VLAN Filter Table Array */
@@ -232,6 +247,12 @@ typedef enum {
 	RAH_AV = (1 << 31)   /**< Address Valid */
 } e1000_rah_t;
 
+/** RXCSUM register fields */
+typedef enum {
+	RXCSUM_IPOFL = (1 << 8),  /**< IPv4 Checksum Offload Enable */
+	RXCSUM_TUOFL = (1 << 9)   /**< TCP/UDP Checksum Offload Enable */
+} e1000_rxcsum_t;
+
 /** RCTL register fields */
 typedef enum {
 	RCTL_EN = (1 << 1),    /**< Receiver Enable */
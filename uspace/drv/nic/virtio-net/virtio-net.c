@@ -32,6 +32,7 @@
 #include <stdint.h>
 
 #include <as.h>
+#include <byteorder.h>
 #include <ddf/driver.h>
 #include <ddf/interrupt.h>
 #include <ddf/log.h>
@@ -56,6 +57,17 @@
 #define TX_BUF_SIZE	BUFFER_SIZE
 #define CT_BUF_SIZE	BUFFER_SIZE
 
+/* Frame layout needed to locate TCP and UDP checksums */
+#define ETH_HDR_SIZE	14
+#define ETYPE_IP	0x0800
+#define ETYPE_IPV6	0x86dd
+#define IPV4_HDR_MIN	20
+#define IPV6_HDR_SIZE	40
+#define IP_PROTO_TCP	6
+#define IP_PROTO_UDP	17
+#define TCP_CSUM_OFFSET	16
+#define UDP_CSUM_OFFSET	6
+
 static ddf_dev_ops_t virtio_net_dev_ops;
 
 static errno_t virtio_net_dev_add(ddf_dev_t *dev);
@@ -166,6 +178,27 @@ static errno_t virtio_net_register_interrupt(ddf_dev_t *dev)
 	    virtio_net_irq_handler, &irq_code, &virtio_net->irq_handle);
 }
 
+/** Change active offload computations
+ *
+ * The device completes checksums only for frames which ask for it, so
+ * transmit checksum offload can be switched at any time. The active set
+ * is consulted for every transmitted frame.
+ *
+ * @param nic    NIC data
+ * @param active New set of active offloads
+ *
+ * @return EOK
+ */
+static errno_t virtio_net_on_offload_change(nic_t *nic, uint32_t active)
+{
+	/* TCP and UDP checksum offload cannot be enabled separately */
+	if ((active & NIC_OFFLOAD_CSUM_TX) != 0 &&
+	    (active & NIC_OFFLOAD_CSUM_TX) != NIC_OFFLOAD_CSUM_TX)
+		return ENOTSUP;
+
+	return EOK;
+}
+
 static errno_t virtio_net_initialize(ddf_dev_t *dev)
 {
 	nic_t *nic = nic_create_and_bind(dev);
@@ -196,11 +229,16 @@ static errno_t virtio_net_initialize(ddf_dev_t *dev)
 		goto fail;
 
 	/* Reset the device and negotiate the feature bits */
-	rc = virtio_device_setup_start(vdev,
-	    VIRTIO_NET_F_MAC | VIRTIO_NET_F_CTRL_VQ);
+	rc = virtio_device_setup_start_opt(vdev,
+	    VIRTIO_NET_F_MAC | VIRTIO_NET_F_CTRL_VQ, VIRTIO_NET_F_CSUM);
 	if (rc != EOK)
 		goto fail;
 
+	if ((vdev->features & VIRTIO_NET_F_CSUM) != 0) {
+		nic_set_offload_handler(nic, NIC_OFFLOAD_CSUM_TX, 0,
+		    virtio_net_on_offload_change);
+	}
+
 	/* Perform device-specific setup */
 
 	/*
@@ -324,6 +362,69 @@ static void virtio_net_uninitialize(ddf_dev_t *dev)
 	virtio_pci_dev_cleanup(&virtio_net->virtio_dev);
 }
 
+/** Request completion of the TCP or UDP checksum of a frame by the device
+ *
+ * While transmit checksum offload is active, TCP and UDP segments in
+ * unfragmented IP datagrams carry the checksum of the pseudo-header only.
+ * Other frames are sent as they are.
+ *
+ * @param hdr  Packet header to fill in
+ * @param data Frame
+ * @param size Size of the frame
+ */
+static void virtio_net_tx_csum(virtio_net_hdr_t *hdr, const uint8_t *data,
+    size_t size)
+{
+	const uint8_t *ip = data + ETH_HDR_SIZE;
+	size_t start;
+	uint16_t offset;
+	uint8_t proto;
+
+	if (size < ETH_HDR_SIZE)
+		return;
+
+	switch ((data[12] << 8) | data[13]) {
+	case ETYPE_IP:
+		if (size < ETH_HDR_SIZE + IPV4_HDR_MIN)
+			return;
+
+		/* More fragments flag or fragment offset */
+		if ((((ip[6] & 0x3f) << 8) | ip[7]) != 0)
+			return;
+
+		start = ETH_HDR_SIZE + (ip[0] & 0x0f) * 4;
+		proto = ip[9];
+		break;
+	case ETYPE_IPV6:
+		if (size < ETH_HDR_SIZE + IPV6_HDR_SIZE)
+			return;
+
+		start = ETH_HDR_SIZE + IPV6_HDR_SIZE;
+		proto = ip[6];
+		break;
+	default:
+		return;
+	}
+
+	switch (proto) {
+	case IP_PROTO_TCP:
+		offset = TCP_CSUM_OFFSET;
+		break;
+	case IP_PROTO_UDP:
+		offset = UDP_CSUM_OFFSET;
+		break;
+	default:
+		return;
+	}
+
+	if (start + offset + sizeof(uint16_t) > size)
+		return;
+
+	hdr->flags = VIRTIO_NET_HDR_F_NEEDS_CSUM;
+	hdr->csum_start = host2uint16_t_le(start);
+	hdr->csum_offset = host2uint16_t_le(offset);
+}
+
 static void virtio_net_send(nic_t *nic, void *data, size_t size)
 {
 	virtio_net_t *virtio_net = nic_get_specific(nic);
@@ -348,6 +449,9 @@ static void virtio_net_send(nic_t *nic, void *data, size_t size)
 	hdr->gso_type = VIRTIO_NET_HDR_GSO_NONE;
 	hdr->num_buffers = 0;
 
+	if ((nic_query_offload(nic) & NIC_OFFLOAD_CSUM_TX) != 0)
+		virtio_net_tx_csum(hdr, data, size);
+
 	/* Copy packet data into the buffer just past the header */
 	memcpy(&hdr[1], data, size);
 
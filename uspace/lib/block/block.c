@@ -58,6 +58,11 @@
 
 #define MAX_WRITE_RETRIES 10
 
+/** Number of block device requests kept in flight by direct I/O */
+#define BD_SHM_DEPTH 8
+/** Largest transfer of one block device request */
+#define BD_SHM_SLOT_SIZE (64 * 1024)
+
 /** Lock protecting the device connection list */
 static FIBRIL_MUTEX_INITIALIZE(dcl_lock);
 /** Device connection list head. */
@@ -72,6 +77,8 @@ typedef struct {
 	hash_table_t block_hash;
 	list_t free_list;
 	enum cache_mode mode;
+	block_dirty_hook_t dirty_hook;  /**< Called when putting a dirty block */
+	void *dirty_arg;                /**< Argument of the dirty hook */
 } cache_t;
 
 typedef struct {
@@ -154,7 +161,7 @@ errno_t block_init(service_id_t service_id, size_t comm_size)
 		return ENOENT;
 	}
 
-	errno_t rc = bd_open(sess, &bd);
+	errno_t rc = bd_open_shm(sess, BD_SHM_DEPTH, BD_SHM_SLOT_SIZE, &bd);
 	if (rc != EOK) {
 		async_hangup(sess);
 		return rc;
@@ -286,6 +293,8 @@ errno_t block_cache_init(service_id_t service_id, size_t size, unsigned blocks,
 	cache->block_count = blocks;
 	cache->blocks_cached = 0;
 	cache->mode = mode;
+	cache->dirty_hook = NULL;
+	cache->dirty_arg = NULL;
 
 	/* Allow 1:1 or small-to-large block size translation */
 	if (cache->lblock_size % devcon->pblock_size != 0) {
@@ -346,6 +355,39 @@ errno_t block_cache_fini(service_id_t service_id)
 	return EOK;
 }
 
+/** Set hook to be called when a dirty block is put.
+ *
+ * The hook is called by block_put() before the reference is dropped and
+ * before the block could be written back. This allows the client (e.g. a
+ * journaling file system) to take its own reference to the block and
+ * thereby hold it in the cache until the client writes it back itself.
+ *
+ * @param service_id	Service ID of the block device.
+ * @param hook		Hook function or @c NULL to remove the hook.
+ * @param arg		Argument passed to the hook.
+ *
+ * @return		EOK on success or an error code.
+ */
+errno_t block_cache_set_dirty_hook(service_id_t service_id,
+    block_dirty_hook_t hook, void *arg)
+{
+	devcon_t *devcon = devcon_search(service_id);
+	cache_t *cache;
+
+	if (!devcon)
+		return ENOENT;
+	if (!devcon->cache)
+		return ENOENT;
+	cache = devcon->cache;
+
+	fibril_mutex_lock(&cache->lock);
+	cache->dirty_hook = hook;
+	cache->dirty_arg = arg;
+	fibril_mutex_unlock(&cache->lock);
+
+	return EOK;
+}
+
 #define CACHE_LO_WATERMARK	10
 #define CACHE_HI_WATERMARK	20
 static bool cache_can_grow(cache_t *cache)
@@ -583,6 +625,8 @@ errno_t block_put(block_t *block)
 	cache_t *cache;
 	unsigned blocks_cached;
 	enum cache_mode mode;
+	block_dirty_hook_t hook;
+	void *hook_arg;
 	errno_t rc = EOK;
 
 	assert(devcon);
@@ -591,6 +635,18 @@ errno_t block_put(block_t *block)
 
 	cache = devcon->cache;
 
+	fibril_mutex_lock(&cache->lock);
+	hook = cache->dirty_hook;
+	hook_arg = cache->dirty_arg;
+	fibril_mutex_unlock(&cache->lock);
+
+	/*
+	 * Give the client a chance to take over the dirty block before we
+	 * possibly write it back.
+	 */
+	if (hook != NULL && block->dirty && !block->toxic)
+		hook(block, hook_arg);
+
 retry:
 	fibril_mutex_lock(&cache->lock);
 	blocks_cached = cache->blocks_cached;
@@ -787,6 +843,126 @@ errno_t block_write_direct(service_id_t service_id, aoff64_t ba, size_t cnt,
 	return write_blocks(devcon, ba, cnt, (void *)data, devcon->pblock_size * cnt);
 }
 
+/** Read logical blocks, bypassing the cache where possible.
+ *
+ * The whole range is transferred from the device in one request. Blocks
+ * that are present in the cache are then taken from there instead, since
+ * the cache may hold data that have not been written back yet.
+ *
+ * @param service_id	Service ID of the block device.
+ * @param lba		Address of first logical block.
+ * @param cnt		Number of logical blocks.
+ * @param buf		Buffer for storing the data.
+ *
+ * @return		EOK on success or an error code on failure.
+ */
+errno_t block_read_lblocks(service_id_t service_id, aoff64_t lba, size_t cnt,
+    void *buf)
+{
+	devcon_t *devcon;
+	cache_t *cache;
+	errno_t rc;
+
+	devcon = devcon_search(service_id);
+	assert(devcon);
+	assert(devcon->cache);
+	cache = devcon->cache;
+
+	rc = read_blocks(devcon, ba_ltop(devcon, lba),
+	    cnt * cache->blocks_cluster, buf, cnt * cache->lblock_size);
+	if (rc != EOK)
+		return rc;
+
+	fibril_mutex_lock(&cache->lock);
+	for (size_t i = 0; i < cnt; i++) {
+		aoff64_t ba = lba + i;
+		ht_link_t *hlink = hash_table_find(&cache->block_hash, &ba);
+		if (hlink == NULL)
+			continue;
+
+		block_t *b = hash_table_get_inst(hlink, block_t, hash_link);
+		fibril_mutex_lock(&b->lock);
+		if (!b->toxic) {
+			memcpy((uint8_t *) buf + i * cache->lblock_size,
+			    b->data, cache->lblock_size);
+		}
+		fibril_mutex_unlock(&b->lock);
+	}
+	fibril_mutex_unlock(&cache->lock);
+
+	return EOK;
+}
+
+/** Write logical blocks, bypassing the cache.
+ *
+ * The whole range is transferred to the device in one request. Cached
+ * copies of the blocks are updated with the new data so that they do not
+ * go stale.
+ *
+ * @param service_id	Service ID of the block device.
+ * @param lba		Address of first logical block.
+ * @param cnt		Number of logical blocks.
+ * @param data		The data to be written.
+ *
+ * @return		EOK on success or an error code on failure.
+ */
+errno_t block_write_lblocks(service_id_t service_id, aoff64_t lba, size_t cnt,
+    const void *data)
+{
+	devcon_t *devcon;
+	cache_t *cache;
+	errno_t rc;
+
+	devcon = devcon_search(service_id);
+	assert(devcon);
+	assert(devcon->cache);
+	cache = devcon->cache;
+
+	/*
+	 * Update the cached copies first so that a concurrent write-back
+	 * cannot overwrite the new data with old contents.
+	 */
+	fibril_mutex_lock(&cache->lock);
+	for (size_t i = 0; i < cnt; i++) {
+		aoff64_t ba = lba + i;
+		ht_link_t *hlink = hash_table_find(&cache->block_hash, &ba);
+		if (hlink == NULL)
+			continue;
+
+		block_t *b = hash_table_get_inst(hlink, block_t, hash_link);
+		fibril_mutex_lock(&b->lock);
+		memcpy(b->data, (const uint8_t *) data + i * cache->lblock_size,
+		    cache->lblock_size);
+		b->dirty = false;
+		b->toxic = false;
+		fibril_mutex_unlock(&b->lock);
+	}
+	fibril_mutex_unlock(&cache->lock);
+
+	rc = write_blocks(devcon, ba_ltop(devcon, lba),
+	    cnt * cache->blocks_cluster, (void *) data,
+	    cnt * cache->lblock_size);
+	if (rc == EOK)
+		return EOK;
+
+	/* Let the cache retry writing the blocks it holds */
+	fibril_mutex_lock(&cache->lock);
+	for (size_t i = 0; i < cnt; i++) {
+		aoff64_t ba = lba + i;
+		ht_link_t *hlink = hash_table_find(&cache->block_hash, &ba);
+		if (hlink == NULL)
+			continue;
+
+		block_t *b = hash_table_get_inst(hlink, block_t, hash_link);
+		fibril_mutex_lock(&b->lock);
+		b->dirty = true;
+		fibril_mutex_unlock(&b->lock);
+	}
+	fibril_mutex_unlock(&cache->lock);
+
+	return rc;
+}
+
 /** Synchronize blocks to persistent storage.
  *
  * @param service_id	Service ID of the block device.
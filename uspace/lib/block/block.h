@@ -98,6 +98,9 @@ enum cache_mode {
 	CACHE_MODE_WB
 };
 
+/** Hook called by block_put() when a dirty block is put. */
+typedef void (*block_dirty_hook_t)(block_t *, void *);
+
 extern errno_t block_init(service_id_t, size_t);
 extern void block_fini(service_id_t);
 
@@ -106,6 +109,8 @@ extern void *block_bb_get(service_id_t);
 
 extern errno_t block_cache_init(service_id_t, size_t, unsigned, enum cache_mode);
 extern errno_t block_cache_fini(service_id_t);
+extern errno_t block_cache_set_dirty_hook(service_id_t, block_dirty_hook_t,
+    void *);
 
 extern errno_t block_get(block_t **, service_id_t, aoff64_t, int);
 extern errno_t block_put(block_t *);
@@ -119,6 +124,9 @@ extern errno_t block_read_toc(service_id_t, uint8_t, void *, size_t);
 extern errno_t block_read_direct(service_id_t, aoff64_t, size_t, void *);
 extern errno_t block_read_bytes_direct(service_id_t, aoff64_t, size_t, void *);
 extern errno_t block_write_direct(service_id_t, aoff64_t, size_t, const void *);
+extern errno_t block_read_lblocks(service_id_t, aoff64_t, size_t, void *);
+extern errno_t block_write_lblocks(service_id_t, aoff64_t, size_t,
+    const void *);
 extern errno_t block_sync_cache(service_id_t, aoff64_t, size_t);
 
 #endif
@@ -38,6 +38,11 @@
 #define PAGE_WIDTH	12
 #define PAGE_SIZE	(1 << PAGE_WIDTH)
 
+/* Functions provided in src/string.S */
+#define LIBARCH_MEMCHR
+#define LIBARCH_MEMCMP
+#define LIBARCH_STRLEN
+
 #endif
 
 /** @}
@@ -118,8 +118,7 @@ void rela_table_process(module_t *m, elf_rela_t *rt, size_t rt_size)
 
 		if (sym->st_name != 0) {
 			DPRINTF("rel_type: %x, rel_offset: 0x%zx\n", rel_type, r_offset);
-			sym_def = symbol_def_find(str_tab + sym->st_name,
-			    m, ssf_none, &dest);
+			sym_def = symbol_reloc_find(m, sym_idx, &dest);
 			DPRINTF("dest name: '%s'\n", dest->dyn.soname);
 			DPRINTF("dest bias: 0x%zx\n", dest->bias);
 			if (sym_def) {
@@ -233,6 +232,75 @@ void rela_table_process(module_t *m, elf_rela_t *rt, size_t rt_size)
 	}
 }
 
+/** Lazy PLT binding entry point (in plt.S). */
+extern void plt_lazy_entry(void);
+uintptr_t plt_lazy_bind(module_t *, size_t);
+
+/** Prepare lazy binding of PLT entries.
+ *
+ * The GOT slots of the PLT initially point back to the second instruction
+ * of their PLT entry which pushes the relocation index and jumps to the PLT
+ * header. It suffices to relocate the slots and fill in GOT[1] and GOT[2].
+ *
+ * @param m Module
+ * @return @c true if the PLT will be bound lazily, @c false if the
+ *         relocations need to be processed eagerly.
+ */
+bool module_plt_lazy_arch(module_t *m)
+{
+	elf_rela_t *rt = m->dyn.jmp_rel;
+	size_t rt_entries = m->dyn.plt_rel_sz / sizeof(elf_rela_t);
+	uintptr_t *got = m->dyn.plt_got;
+	size_t i;
+
+	if (got == NULL || m->dyn.plt_rel != DT_RELA)
+		return false;
+
+	for (i = 0; i < rt_entries; i++) {
+		if (ELF64_R_TYPE(rt[i].r_info) != R_X86_64_JUMP_SLOT)
+			return false;
+	}
+
+	for (i = 0; i < rt_entries; i++)
+		*(uintptr_t *)(rt[i].r_offset + m->bias) += m->bias;
+
+	got[1] = (uintptr_t) m;
+	got[2] = (uintptr_t) plt_lazy_entry;
+
+	DPRINTF("module '%s': %zu PLT entries bound lazily\n", m->dyn.soname,
+	    rt_entries);
+	return true;
+}
+
+/** Bind a PLT entry on its first call.
+ *
+ * Called from plt_lazy_entry.
+ *
+ * @param m Module containing the PLT
+ * @param idx Index of the relocation in the PLT relocation table
+ * @return Address of the function
+ */
+uintptr_t plt_lazy_bind(module_t *m, size_t idx)
+{
+	elf_rela_t *rel = &((elf_rela_t *) m->dyn.jmp_rel)[idx];
+	elf_word sym_idx = ELF64_R_SYM(rel->r_info);
+	elf_symbol_t *sym_def;
+	module_t *dest;
+	uintptr_t sym_addr;
+
+	sym_def = symbol_reloc_find(m, sym_idx, &dest);
+	if (sym_def == NULL) {
+		elf_symbol_t *sym = &((elf_symbol_t *) m->dyn.sym_tab)[sym_idx];
+		printf("Definition of '%s' not found.\n",
+		    m->dyn.str_tab + sym->st_name);
+		abort();
+	}
+
+	sym_addr = (uintptr_t) symbol_get_addr(sym_def, dest, NULL);
+	*(uintptr_t *)(rel->r_offset + m->bias) = sym_addr;
+	return sym_addr;
+}
+
 /** Get the adress of a function.
  *
  * @param sym Symbol
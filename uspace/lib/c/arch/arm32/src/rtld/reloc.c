@@ -104,8 +104,7 @@ void rel_table_process(module_t *m, elf_rel_t *rt, size_t rt_size)
 #if 0
 			DPRINTF("rel_type: %x, rel_offset: 0x%x\n", rel_type, r_offset);
 #endif
-			sym_def = symbol_def_find(str_tab + sym->st_name,
-			    m, ssf_none, &dest);
+			sym_def = symbol_reloc_find(m, sym_idx, &dest);
 			DPRINTF("dest name: '%s'\n", dest->dyn.soname);
 			DPRINTF("dest bias: 0x%x\n", dest->bias);
 			if (sym_def) {
@@ -215,6 +214,18 @@ void rela_table_process(module_t *m, elf_rela_t *rt, size_t rt_size)
 	(void) rt_size;
 }
 
+/** Prepare lazy binding of PLT entries.
+ *
+ * Lazy binding is not implemented on this architecture.
+ *
+ * @param m Module
+ * @return @c false, the relocations need to be processed eagerly.
+ */
+bool module_plt_lazy_arch(module_t *m)
+{
+	return false;
+}
+
 /** Get the adress of a function.
  *
  * @param sym Symbol
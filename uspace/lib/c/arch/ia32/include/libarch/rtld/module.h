@@ -43,6 +43,9 @@
  */
 #define RTLD_MODULE_LDF ELDF_RW
 
+/** Relocated images can be snapshotted */
+#define RTLD_MODULE_SNAPSHOT true
+
 #endif
 
 /** @}
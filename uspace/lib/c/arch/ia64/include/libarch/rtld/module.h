@@ -40,6 +40,12 @@
 /** ELF module load flags */
 #define RTLD_MODULE_LDF 0
 
+/*
+ * Relocated images cannot be snapshotted, relocations may refer to
+ * function descriptors allocated on the heap.
+ */
+#define RTLD_MODULE_SNAPSHOT false
+
 #endif
 
 /** @}
@@ -40,6 +40,9 @@
 /** ELF module load flags */
 #define RTLD_MODULE_LDF 0
 
+/** Relocated images can be snapshotted */
+#define RTLD_MODULE_SNAPSHOT true
+
 #endif
 
 /** @}
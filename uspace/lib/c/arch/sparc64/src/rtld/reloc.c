@@ -123,8 +123,7 @@ void rela_table_process(module_t *m, elf_rela_t *rt, size_t rt_size)
 
 		if (sym->st_name != 0) {
 			DPRINTF("rel_type: %x, rel_offset: 0x%zx\n", rel_type, r_offset);
-			sym_def = symbol_def_find(str_tab + sym->st_name,
-			    m, ssf_none, &dest);
+			sym_def = symbol_reloc_find(m, sym_idx, &dest);
 			DPRINTF("dest name: '%s'\n", dest->dyn.soname);
 			DPRINTF("dest bias: 0x%zx\n", dest->bias);
 			if (sym_def) {
@@ -298,6 +297,18 @@ static void fill_plt_entry_generic(uint32_t *plte, uintptr_t ta)
 	}
 }
 
+/** Prepare lazy binding of PLT entries.
+ *
+ * Lazy binding is not implemented on this architecture.
+ *
+ * @param m Module
+ * @return @c false, the relocations need to be processed eagerly.
+ */
+bool module_plt_lazy_arch(module_t *m)
+{
+	return false;
+}
+
 /** Get the adress of a function.
  *
  * @param sym Symbol
@@ -195,7 +195,8 @@ void hash_table_insert(hash_table_t *h, ht_link_t *item)
 	assert(h && h->bucket);
 	assert(!h->apply_ongoing);
 
-	size_t idx = h->op->hash(item) % h->bucket_cnt;
+	item->hash = h->op->hash(item);
+	size_t idx = item->hash % h->bucket_cnt;
 
 	list_append(&item->link, &h->bucket[idx]);
 	++h->item_cnt;
@@ -217,15 +218,13 @@ bool hash_table_insert_unique(hash_table_t *h, ht_link_t *item)
 	assert(h->op && h->op->hash && h->op->equal);
 	assert(!h->apply_ongoing);
 
-	size_t idx = h->op->hash(item) % h->bucket_cnt;
+	item->hash = h->op->hash(item);
+	size_t idx = item->hash % h->bucket_cnt;
 
 	/* Check for duplicates. */
 	list_foreach(h->bucket[idx], link, ht_link_t, cur_link) {
-		/*
-		 * We could filter out items using their hashes first, but
-		 * calling equal() might very well be just as fast.
-		 */
-		if (h->op->equal(cur_link, item))
+		/* Filter out items using their cached hashes first. */
+		if (cur_link->hash == item->hash && h->op->equal(cur_link, item))
 			return false;
 	}
 
@@ -248,15 +247,15 @@ ht_link_t *hash_table_find(const hash_table_t *h, const void *key)
 {
 	assert(h && h->bucket);
 
-	size_t idx = h->op->key_hash(key) % h->bucket_cnt;
+	size_t hash = h->op->key_hash(key);
+	size_t idx = hash % h->bucket_cnt;
 
 	list_foreach(h->bucket[idx], link, ht_link_t, cur_link) {
 		/*
-		 * Is this is the item we are looking for? We could have first
-		 * checked if the hashes match but op->key_equal() may very well be
-		 * just as fast as op->hash().
+		 * Is this is the item we are looking for? Comparing the cached
+		 * hashes first avoids touching the keys of most other items.
 		 */
-		if (h->op->key_equal(key, cur_link)) {
+		if (cur_link->hash == hash && h->op->key_equal(key, cur_link)) {
 			return cur_link;
 		}
 	}
@@ -271,7 +270,7 @@ hash_table_find_next(const hash_table_t *h, ht_link_t *first, ht_link_t *item)
 	assert(item);
 	assert(h && h->bucket);
 
-	size_t idx = h->op->hash(item) % h->bucket_cnt;
+	size_t idx = item->hash % h->bucket_cnt;
 
 	/* Traverse the circular list until we reach the starting item again. */
 	for (link_t *cur = item->link.next; cur != &first->link;
@@ -282,12 +281,8 @@ hash_table_find_next(const hash_table_t *h, ht_link_t *first, ht_link_t *item)
 			continue;
 
 		ht_link_t *cur_link = member_to_inst(cur, ht_link_t, link);
-		/*
-		 * Is this is the item we are looking for? We could have first
-		 * checked if the hashes match but op->equal() may very well be
-		 * just as fast as op->hash().
-		 */
-		if (h->op->equal(cur_link, item)) {
+		/* Is this is the item we are looking for? */
+		if (cur_link->hash == item->hash && h->op->equal(cur_link, item)) {
 			return cur_link;
 		}
 	}
@@ -310,14 +305,15 @@ size_t hash_table_remove(hash_table_t *h, const void *key)
 	assert(h && h->bucket);
 	assert(!h->apply_ongoing);
 
-	size_t idx = h->op->key_hash(key) % h->bucket_cnt;
+	size_t hash = h->op->key_hash(key);
+	size_t idx = hash % h->bucket_cnt;
 
 	size_t removed = 0;
 
 	list_foreach_safe(h->bucket[idx], cur, next) {
 		ht_link_t *cur_link = member_to_inst(cur, ht_link_t, link);
 
-		if (h->op->key_equal(key, cur_link)) {
+		if (cur_link->hash == hash && h->op->key_equal(key, cur_link)) {
 			++removed;
 			list_remove(cur);
 			h->op->remove_callback(cur_link);
@@ -454,7 +450,7 @@ static void resize(hash_table_t *h, size_t new_bucket_cnt)
 			list_foreach_safe(h->bucket[old_idx], cur, next) {
 				ht_link_t *cur_link = member_to_inst(cur, ht_link_t, link);
 
-				size_t new_idx = h->op->hash(cur_link) % new_bucket_cnt;
+				size_t new_idx = cur_link->hash % new_bucket_cnt;
 				list_remove(cur);
 				list_append(cur, &new_buckets[new_idx]);
 			}
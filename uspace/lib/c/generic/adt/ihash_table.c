@@ -0,0 +1,536 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libc
+ * @{
+ */
+/** @file
+ */
+
+/*
+ * This is an implementation of a chained hash table which is resized
+ * incrementally.
+ *
+ * When the table needs to grow or shrink, a new array of buckets is
+ * allocated, but the items are not rehashed all at once. Instead, each
+ * subsequent insertion or removal moves the items of a few old buckets
+ * to the new ones. An item therefore lives either in its old bucket, if
+ * that bucket has not been migrated yet, or in its new bucket. No single
+ * operation has to touch all the items of a large table.
+ *
+ * The number of buckets is a power of two. The hashes returned by the
+ * operations are mixed before use and cached in the items, so that chains
+ * can be searched without calling key_equal() for items with different
+ * hashes.
+ */
+
+#include <adt/hash.h>
+#include <adt/hash_table.h>
+#include <adt/ihash_table.h>
+#include <adt/list.h>
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/* Minimal number of buckets, must be a power of two. */
+#define IHT_MIN_BUCKETS  64
+/* The table is resized when the average load per bucket exceeds this number. */
+#define IHT_MAX_LOAD     2
+/* Number of old buckets migrated by each insertion or removal. */
+#define IHT_MIGRATE_STEP  4
+
+static size_t round_up_size(size_t);
+static bool alloc_table(size_t, list_t **);
+static list_t *bucket_get(const ihash_table_t *, size_t);
+static void clear_items(ihash_table_t *);
+static void migrate(ihash_table_t *, size_t);
+static void resize(ihash_table_t *, size_t);
+static void grow_if_needed(ihash_table_t *);
+static void shrink_if_needed(ihash_table_t *);
+
+/* Dummy do nothing callback to invoke in place of remove_callback == NULL. */
+static void nop_remove_callback(ht_link_t *item)
+{
+	/* no-op */
+}
+
+/** Create incrementally resized hash table.
+ *
+ * @param h        Hash table structure. Will be initialized by this call.
+ * @param init_size Initial desired number of hash table buckets. Pass zero
+ *                 if you want the default initial size.
+ * @param max_load The table is resized when the average load per bucket
+ *                 exceeds this number. Pass zero if you want the default.
+ * @param op       Hash table operations structure, see hash_table_create().
+ *
+ * @return True on success
+ *
+ */
+bool ihash_table_create(ihash_table_t *h, size_t init_size, size_t max_load,
+    hash_table_ops_t *op)
+{
+	assert(h);
+	assert(op && op->hash && op->key_hash && op->key_equal);
+
+	/* Check for compulsory ops. */
+	if (!op || !op->hash || !op->key_hash || !op->key_equal)
+		return false;
+
+	h->bucket_cnt = round_up_size(init_size);
+
+	if (!alloc_table(h->bucket_cnt, &h->bucket))
+		return false;
+
+	h->old_bucket = NULL;
+	h->old_bucket_cnt = 0;
+	h->migrate_idx = 0;
+	h->max_load = (max_load == 0) ? IHT_MAX_LOAD : max_load;
+	h->item_cnt = 0;
+	h->op = op;
+	h->full_item_cnt = h->max_load * h->bucket_cnt;
+	h->apply_ongoing = false;
+
+	if (h->op->remove_callback == NULL) {
+		h->op->remove_callback = nop_remove_callback;
+	}
+
+	return true;
+}
+
+/** Destroy a hash table instance.
+ *
+ * @param h Hash table to be destroyed.
+ *
+ */
+void ihash_table_destroy(ihash_table_t *h)
+{
+	assert(h && h->bucket);
+	assert(!h->apply_ongoing);
+
+	clear_items(h);
+
+	free(h->old_bucket);
+	free(h->bucket);
+
+	h->old_bucket = NULL;
+	h->old_bucket_cnt = 0;
+	h->migrate_idx = 0;
+	h->bucket = NULL;
+	h->bucket_cnt = 0;
+}
+
+/** Returns true if there are no items in the table. */
+bool ihash_table_empty(ihash_table_t *h)
+{
+	assert(h && h->bucket);
+	return h->item_cnt == 0;
+}
+
+/** Returns the number of items in the table. */
+size_t ihash_table_size(ihash_table_t *h)
+{
+	assert(h && h->bucket);
+	return h->item_cnt;
+}
+
+/** Remove all elements from the hash table
+ *
+ * @param h Hash table to be cleared
+ */
+void ihash_table_clear(ihash_table_t *h)
+{
+	assert(h && h->bucket);
+	assert(!h->apply_ongoing);
+
+	clear_items(h);
+
+	/* The table is empty, there is nothing left to migrate. */
+	free(h->old_bucket);
+	h->old_bucket = NULL;
+	h->old_bucket_cnt = 0;
+	h->migrate_idx = 0;
+
+	/* Shrink the table to its minimum size if possible. */
+	list_t *new_buckets;
+	if (IHT_MIN_BUCKETS < h->bucket_cnt &&
+	    alloc_table(IHT_MIN_BUCKETS, &new_buckets)) {
+		free(h->bucket);
+		h->bucket = new_buckets;
+		h->bucket_cnt = IHT_MIN_BUCKETS;
+		h->full_item_cnt = h->max_load * h->bucket_cnt;
+	}
+}
+
+/** Unlinks and removes all items but does not resize. */
+static void clear_items(ihash_table_t *h)
+{
+	if (h->item_cnt == 0)
+		return;
+
+	for (size_t idx = h->migrate_idx; idx < h->old_bucket_cnt; ++idx) {
+		list_foreach_safe(h->old_bucket[idx], cur, next) {
+			ht_link_t *cur_link = member_to_inst(cur, ht_link_t, link);
+
+			list_remove(cur);
+			h->op->remove_callback(cur_link);
+		}
+	}
+
+	for (size_t idx = 0; idx < h->bucket_cnt; ++idx) {
+		list_foreach_safe(h->bucket[idx], cur, next) {
+			ht_link_t *cur_link = member_to_inst(cur, ht_link_t, link);
+
+			list_remove(cur);
+			h->op->remove_callback(cur_link);
+		}
+	}
+
+	h->item_cnt = 0;
+}
+
+/** Insert item into a hash table.
+ *
+ * @param h    Hash table.
+ * @param item Item to be inserted into the hash table.
+ */
+void ihash_table_insert(ihash_table_t *h, ht_link_t *item)
+{
+	assert(item);
+	assert(h && h->bucket);
+	assert(!h->apply_ongoing);
+
+	item->hash = hash_mix(h->op->hash(item));
+
+	list_append(&item->link, bucket_get(h, item->hash));
+	++h->item_cnt;
+
+	migrate(h, IHT_MIGRATE_STEP);
+	grow_if_needed(h);
+}
+
+/** Insert item into a hash table if not already present.
+ *
+ * @param h    Hash table.
+ * @param item Item to be inserted into the hash table.
+ *
+ * @return False if such an item had already been inserted.
+ * @return True if the inserted item was the only item with such a lookup key.
+ */
+bool ihash_table_insert_unique(ihash_table_t *h, ht_link_t *item)
+{
+	assert(item);
+	assert(h && h->bucket && h->bucket_cnt);
+	assert(h->op && h->op->hash && h->op->equal);
+	assert(!h->apply_ongoing);
+
+	item->hash = hash_mix(h->op->hash(item));
+	list_t *bucket = bucket_get(h, item->hash);
+
+	/* Check for duplicates. */
+	list_foreach(*bucket, link, ht_link_t, cur_link) {
+		if (cur_link->hash == item->hash && h->op->equal(cur_link, item))
+			return false;
+	}
+
+	list_append(&item->link, bucket);
+	++h->item_cnt;
+
+	migrate(h, IHT_MIGRATE_STEP);
+	grow_if_needed(h);
+
+	return true;
+}
+
+/** Search hash table for an item matching keys.
+ *
+ * @param h   Hash table.
+ * @param key Array of all keys needed to compute hash index.
+ *
+ * @return Matching item on success, NULL if there is no such item.
+ *
+ */
+ht_link_t *ihash_table_find(const ihash_table_t *h, const void *key)
+{
+	assert(h && h->bucket);
+
+	size_t hash = hash_mix(h->op->key_hash(key));
+
+	list_foreach(*bucket_get(h, hash), link, ht_link_t, cur_link) {
+		if (cur_link->hash == hash && h->op->key_equal(key, cur_link))
+			return cur_link;
+	}
+
+	return NULL;
+}
+
+/** Find the next item equal to item. */
+ht_link_t *
+ihash_table_find_next(const ihash_table_t *h, ht_link_t *first,
+    ht_link_t *item)
+{
+	assert(item);
+	assert(h && h->bucket);
+
+	/* Equal items have equal hashes, so they share the bucket. */
+	list_t *bucket = bucket_get(h, item->hash);
+
+	/* Traverse the circular list until we reach the starting item again. */
+	for (link_t *cur = item->link.next; cur != &first->link;
+	    cur = cur->next) {
+		assert(cur);
+
+		if (cur == &bucket->head)
+			continue;
+
+		ht_link_t *cur_link = member_to_inst(cur, ht_link_t, link);
+		if (cur_link->hash == item->hash && h->op->equal(cur_link, item))
+			return cur_link;
+	}
+
+	return NULL;
+}
+
+/** Remove all matching items from hash table.
+ *
+ * For each removed item, h->remove_callback() is called.
+ *
+ * @param h    Hash table.
+ * @param key  Array of keys that will be compared against items of
+ *             the hash table.
+ *
+ * @return Returns the number of removed items.
+ */
+size_t ihash_table_remove(ihash_table_t *h, const void *key)
+{
+	assert(h && h->bucket);
+	assert(!h->apply_ongoing);
+
+	size_t hash = hash_mix(h->op->key_hash(key));
+	size_t removed = 0;
+
+	list_foreach_safe(*bucket_get(h, hash), cur, next) {
+		ht_link_t *cur_link = member_to_inst(cur, ht_link_t, link);
+
+		if (cur_link->hash == hash && h->op->key_equal(key, cur_link)) {
+			++removed;
+			list_remove(cur);
+			h->op->remove_callback(cur_link);
+		}
+	}
+
+	h->item_cnt -= removed;
+
+	migrate(h, IHT_MIGRATE_STEP);
+	shrink_if_needed(h);
+
+	return removed;
+}
+
+/** Removes an item already present in the table. The item must be in the table.*/
+void ihash_table_remove_item(ihash_table_t *h, ht_link_t *item)
+{
+	assert(item);
+	assert(h && h->bucket);
+	assert(link_in_use(&item->link));
+
+	list_remove(&item->link);
+	--h->item_cnt;
+	h->op->remove_callback(item);
+
+	migrate(h, IHT_MIGRATE_STEP);
+	shrink_if_needed(h);
+}
+
+/** Apply function to all items in hash table.
+ *
+ * @param h   Hash table.
+ * @param f   Function to be applied. Return false if no more items
+ *            should be visited. The functor may only delete the supplied
+ *            item. It must not delete the successor of the item passed
+ *            in the first argument.
+ * @param arg Argument to be passed to the function.
+ */
+void ihash_table_apply(ihash_table_t *h, bool (*f)(ht_link_t *, void *),
+    void *arg)
+{
+	assert(f);
+	assert(h && h->bucket);
+
+	if (h->item_cnt == 0)
+		return;
+
+	/* No items are migrated while the table is being traversed. */
+	h->apply_ongoing = true;
+
+	for (size_t idx = h->migrate_idx; idx < h->old_bucket_cnt; ++idx) {
+		list_foreach_safe(h->old_bucket[idx], cur, next) {
+			ht_link_t *cur_link = member_to_inst(cur, ht_link_t, link);
+			if (!f(cur_link, arg))
+				goto out;
+		}
+	}
+
+	for (size_t idx = 0; idx < h->bucket_cnt; ++idx) {
+		list_foreach_safe(h->bucket[idx], cur, next) {
+			ht_link_t *cur_link = member_to_inst(cur, ht_link_t, link);
+			/*
+			 * The next pointer had already been saved. f() may safely
+			 * delete cur (but not next!).
+			 */
+			if (!f(cur_link, arg))
+				goto out;
+		}
+	}
+out:
+	h->apply_ongoing = false;
+
+	shrink_if_needed(h);
+	grow_if_needed(h);
+}
+
+/** Rounds up size to the nearest suitable table size. */
+static size_t round_up_size(size_t size)
+{
+	size_t rounded_size = IHT_MIN_BUCKETS;
+
+	while (rounded_size < size) {
+		rounded_size = 2 * rounded_size;
+	}
+
+	return rounded_size;
+}
+
+/** Allocates and initializes the desired number of buckets. True if successful.*/
+static bool alloc_table(size_t bucket_cnt, list_t **pbuckets)
+{
+	assert(pbuckets && IHT_MIN_BUCKETS <= bucket_cnt);
+
+	list_t *buckets = malloc(bucket_cnt * sizeof(list_t));
+	if (!buckets)
+		return false;
+
+	for (size_t i = 0; i < bucket_cnt; i++)
+		list_initialize(&buckets[i]);
+
+	*pbuckets = buckets;
+	return true;
+}
+
+/** Returns the bucket which holds the items with the given hash. */
+static list_t *bucket_get(const ihash_table_t *h, size_t hash)
+{
+	if (h->old_bucket != NULL) {
+		size_t old_idx = hash & (h->old_bucket_cnt - 1);
+		if (h->migrate_idx <= old_idx)
+			return &h->old_bucket[old_idx];
+	}
+
+	return &h->bucket[hash & (h->bucket_cnt - 1)];
+}
+
+/** Moves items of up to @a steps old buckets to the new buckets.
+ *
+ * The old buckets are freed once all of them have been migrated.
+ */
+static void migrate(ihash_table_t *h, size_t steps)
+{
+	if (h->old_bucket == NULL || h->apply_ongoing)
+		return;
+
+	while (steps > 0 && h->migrate_idx < h->old_bucket_cnt) {
+		list_foreach_safe(h->old_bucket[h->migrate_idx], cur, next) {
+			ht_link_t *cur_link = member_to_inst(cur, ht_link_t, link);
+
+			size_t new_idx = cur_link->hash & (h->bucket_cnt - 1);
+			list_remove(cur);
+			list_append(cur, &h->bucket[new_idx]);
+		}
+
+		++h->migrate_idx;
+		--steps;
+	}
+
+	if (h->migrate_idx == h->old_bucket_cnt) {
+		free(h->old_bucket);
+		h->old_bucket = NULL;
+		h->old_bucket_cnt = 0;
+		h->migrate_idx = 0;
+	}
+}
+
+/** Shrinks the table if the table is only sparely populated. */
+static inline void shrink_if_needed(ihash_table_t *h)
+{
+	if (h->item_cnt <= h->full_item_cnt / 4 && IHT_MIN_BUCKETS < h->bucket_cnt)
+		resize(h, h->bucket_cnt / 2);
+}
+
+/** Grows the table if table load exceeds the maximum allowed. */
+static inline void grow_if_needed(ihash_table_t *h)
+{
+	if (h->full_item_cnt < h->item_cnt)
+		resize(h, 2 * h->bucket_cnt);
+}
+
+/** Allocates a new table and starts migrating the items to it. */
+static void resize(ihash_table_t *h, size_t new_bucket_cnt)
+{
+	assert(h && h->bucket);
+	assert(IHT_MIN_BUCKETS <= new_bucket_cnt);
+
+	/* We are traversing the table and resizing would mess up the buckets. */
+	if (h->apply_ongoing)
+		return;
+
+	/*
+	 * Finish the previous resize first. This is rare, because a resize
+	 * is only triggered after at least as many operations as there are
+	 * buckets, each of which migrates several buckets.
+	 */
+	if (h->old_bucket != NULL)
+		migrate(h, SIZE_MAX);
+
+	list_t *new_buckets;
+
+	/* Leave the table as is if we cannot resize. */
+	if (!alloc_table(new_bucket_cnt, &new_buckets))
+		return;
+
+	h->old_bucket = h->bucket;
+	h->old_bucket_cnt = h->bucket_cnt;
+	h->migrate_idx = 0;
+
+	h->bucket = new_buckets;
+	h->bucket_cnt = new_bucket_cnt;
+	h->full_item_cnt = h->max_load * h->bucket_cnt;
+
+	migrate(h, IHT_MIGRATE_STEP);
+}
+
+/** @}
+ */
@@ -0,0 +1,324 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libc
+ * @{
+ */
+/** @file
+ */
+
+/*
+ * This is an implementation of an open addressing hash table with linear
+ * probing.
+ *
+ * The slots hold the (mixed) hashes of the keys next to the pointers to
+ * the items. A lookup thus scans consecutive memory and only calls
+ * key_equal() for items whose hash matches. Removal shifts the following
+ * items of the probe sequence back, so that no tombstones are needed.
+ *
+ * The number of slots is a power of two and the table is kept at most
+ * three quarters full.
+ */
+
+#include <adt/hash.h>
+#include <adt/ohash_table.h>
+#include <assert.h>
+#include <errno.h>
+#include <stdlib.h>
+
+/* Minimal number of slots, must be a power of two. */
+#define OHT_MIN_SLOTS  16
+
+static size_t round_up_size(size_t);
+static errno_t resize(ohash_table_t *, size_t);
+
+/** Create open addressing hash table.
+ *
+ * @param h         Hash table structure. Will be initialized by this call.
+ * @param init_size Initial desired number of items. Pass zero if you want
+ *                  the default initial size.
+ * @param op        Hash table operations structure. All operations are
+ *                  mandatory.
+ *
+ * @return EOK on success, ENOMEM if out of memory.
+ */
+errno_t ohash_table_create(ohash_table_t *h, size_t init_size,
+    const ohash_table_ops_t *op)
+{
+	assert(h);
+	assert(op && op->key && op->key_hash && op->key_equal);
+
+	h->op = op;
+	h->slot_cnt = round_up_size(init_size + init_size / 3);
+	h->item_cnt = 0;
+
+	h->slot = calloc(h->slot_cnt, sizeof(ohash_slot_t));
+	if (h->slot == NULL)
+		return ENOMEM;
+
+	return EOK;
+}
+
+/** Destroy a hash table instance.
+ *
+ * The items themselves are not freed.
+ *
+ * @param h Hash table to be destroyed.
+ */
+void ohash_table_destroy(ohash_table_t *h)
+{
+	assert(h && h->slot);
+
+	free(h->slot);
+	h->slot = NULL;
+	h->slot_cnt = 0;
+	h->item_cnt = 0;
+}
+
+/** Returns true if there are no items in the table. */
+bool ohash_table_empty(ohash_table_t *h)
+{
+	assert(h && h->slot);
+	return h->item_cnt == 0;
+}
+
+/** Returns the number of items in the table. */
+size_t ohash_table_size(ohash_table_t *h)
+{
+	assert(h && h->slot);
+	return h->item_cnt;
+}
+
+/** Remove all items from the hash table.
+ *
+ * The items themselves are not freed.
+ *
+ * @param h Hash table to be cleared
+ */
+void ohash_table_clear(ohash_table_t *h)
+{
+	assert(h && h->slot);
+
+	for (size_t i = 0; i < h->slot_cnt; i++)
+		h->slot[i].item = NULL;
+
+	h->item_cnt = 0;
+
+	/* Shrink the table to its minimum size if possible. */
+	if (OHT_MIN_SLOTS < h->slot_cnt)
+		(void) resize(h, OHT_MIN_SLOTS);
+}
+
+/** Insert item into a hash table.
+ *
+ * @param h    Hash table.
+ * @param item Item to be inserted into the hash table.
+ *
+ * @return EOK on success, EEXIST if an item with the same key is
+ *         already present, ENOMEM if the table could not be grown.
+ */
+errno_t ohash_table_insert(ohash_table_t *h, void *item)
+{
+	assert(item);
+	assert(h && h->slot);
+
+	const void *key = h->op->key(item);
+	size_t hash = hash_mix(h->op->key_hash(key));
+	size_t mask = h->slot_cnt - 1;
+	size_t idx;
+
+	for (idx = hash & mask; h->slot[idx].item != NULL;
+	    idx = (idx + 1) & mask) {
+		if (h->slot[idx].hash == hash &&
+		    h->op->key_equal(key, h->op->key(h->slot[idx].item)))
+			return EEXIST;
+	}
+
+	/* Keep the table at most three quarters full. */
+	if (4 * (h->item_cnt + 1) > 3 * h->slot_cnt) {
+		errno_t rc = resize(h, 2 * h->slot_cnt);
+		if (rc != EOK)
+			return rc;
+
+		mask = h->slot_cnt - 1;
+		for (idx = hash & mask; h->slot[idx].item != NULL;
+		    idx = (idx + 1) & mask)
+			;
+	}
+
+	h->slot[idx].hash = hash;
+	h->slot[idx].item = item;
+	h->item_cnt++;
+
+	return EOK;
+}
+
+/** Find the slot holding the item with the given key.
+ *
+ * @return Slot index or the number of slots if not found.
+ */
+static size_t find_slot(const ohash_table_t *h, const void *key)
+{
+	size_t hash = hash_mix(h->op->key_hash(key));
+	size_t mask = h->slot_cnt - 1;
+
+	for (size_t idx = hash & mask; h->slot[idx].item != NULL;
+	    idx = (idx + 1) & mask) {
+		if (h->slot[idx].hash == hash &&
+		    h->op->key_equal(key, h->op->key(h->slot[idx].item)))
+			return idx;
+	}
+
+	return h->slot_cnt;
+}
+
+/** Search hash table for an item matching the key.
+ *
+ * @param h   Hash table.
+ * @param key Lookup key.
+ *
+ * @return Matching item on success, NULL if there is no such item.
+ */
+void *ohash_table_find(const ohash_table_t *h, const void *key)
+{
+	assert(h && h->slot);
+
+	size_t idx = find_slot(h, key);
+	if (idx == h->slot_cnt)
+		return NULL;
+
+	return h->slot[idx].item;
+}
+
+/** Remove the item matching the key from the hash table.
+ *
+ * @param h   Hash table.
+ * @param key Lookup key.
+ *
+ * @return The removed item or NULL if there is no such item.
+ */
+void *ohash_table_remove(ohash_table_t *h, const void *key)
+{
+	assert(h && h->slot);
+
+	size_t idx = find_slot(h, key);
+	if (idx == h->slot_cnt)
+		return NULL;
+
+	void *item = h->slot[idx].item;
+	size_t mask = h->slot_cnt - 1;
+
+	/*
+	 * Move back the following items of the probe sequence which would
+	 * not be found anymore once the slot is freed.
+	 */
+	size_t next = idx;
+	while (true) {
+		next = (next + 1) & mask;
+		if (h->slot[next].item == NULL)
+			break;
+
+		/* Distance of the item from its home slot */
+		size_t dist = (next - (h->slot[next].hash & mask)) & mask;
+		if (dist >= ((next - idx) & mask)) {
+			h->slot[idx] = h->slot[next];
+			idx = next;
+		}
+	}
+
+	h->slot[idx].item = NULL;
+	h->item_cnt--;
+
+	/* Shrink the table if it is only sparsely populated. */
+	if (OHT_MIN_SLOTS < h->slot_cnt && 8 * h->item_cnt < h->slot_cnt)
+		(void) resize(h, h->slot_cnt / 2);
+
+	return item;
+}
+
+/** Apply function to all items in hash table.
+ *
+ * @param h   Hash table.
+ * @param f   Function to be applied. Return false if no more items
+ *            should be visited. The function must not modify the table.
+ * @param arg Argument to be passed to the function.
+ */
+void ohash_table_apply(ohash_table_t *h, bool (*f)(void *, void *), void *arg)
+{
+	assert(f);
+	assert(h && h->slot);
+
+	for (size_t i = 0; i < h->slot_cnt; i++) {
+		if (h->slot[i].item != NULL && !f(h->slot[i].item, arg))
+			break;
+	}
+}
+
+/** Rounds up size to the nearest suitable table size. */
+static size_t round_up_size(size_t size)
+{
+	size_t rounded_size = OHT_MIN_SLOTS;
+
+	while (rounded_size < size)
+		rounded_size = 2 * rounded_size;
+
+	return rounded_size;
+}
+
+/** Allocates new slots and rehashes the items into them. */
+static errno_t resize(ohash_table_t *h, size_t new_slot_cnt)
+{
+	assert(OHT_MIN_SLOTS <= new_slot_cnt);
+	assert(h->item_cnt < new_slot_cnt);
+
+	ohash_slot_t *new_slot = calloc(new_slot_cnt, sizeof(ohash_slot_t));
+	if (new_slot == NULL)
+		return ENOMEM;
+
+	size_t mask = new_slot_cnt - 1;
+
+	for (size_t i = 0; i < h->slot_cnt; i++) {
+		if (h->slot[i].item == NULL)
+			continue;
+
+		size_t idx = h->slot[i].hash & mask;
+		while (new_slot[idx].item != NULL)
+			idx = (idx + 1) & mask;
+
+		new_slot[idx] = h->slot[i];
+	}
+
+	free(h->slot);
+	h->slot = new_slot;
+	h->slot_cnt = new_slot_cnt;
+
+	return EOK;
+}
+
+/** @}
+ */
@@ -152,20 +152,52 @@ static void amsg_destroy(amsg_t *msg)
 	free(msg);
 }
 
-/** Mutex protecting inactive_exch_list and avail_phone_cv.
- *
- */
-static FIBRIL_MUTEX_INITIALIZE(async_sess_mutex);
+/** Number of shards of the parallel exchange bookkeeping. */
+#define ASYNC_SESS_SHARDS  8
 
-/** List of all currently inactive exchanges.
+/** Shard of the parallel exchange bookkeeping.
+ *
+ * Each session belongs to one shard according to its address. The shard
+ * mutex protects the inactive exchanges and the exchange limit of its
+ * sessions.
  *
  */
-static LIST_INITIALIZE(inactive_exch_list);
+typedef struct {
+	/** Mutex protecting the shard and the sessions in it. */
+	fibril_mutex_t mutex;
+
+	/** Inactive parallel exchanges of all sessions in the shard. */
+	list_t inactive_exch_list;
+
+	/** Condition variable to wait for a phone to become available. */
+	fibril_condvar_t avail_phone_cv;
+} async_sess_shard_t;
+
+static async_sess_shard_t sess_shards[ASYNC_SESS_SHARDS];
+
+static async_sess_shard_t *async_sess_shard(async_sess_t *sess)
+{
+	return &sess_shards[hash_mix((size_t) sess) % ASYNC_SESS_SHARDS];
+}
 
-/** Condition variable to wait for a phone to become available.
+/** Initialize exchange management of a new session.
+ *
+ * @param sess Session.
  *
  */
-static FIBRIL_CONDVAR_INITIALIZE(avail_phone_cv);
+void async_sess_init(async_sess_t *sess)
+{
+	fibril_mutex_initialize(&sess->remote_state_mtx);
+	sess->remote_state_data = NULL;
+
+	list_initialize(&sess->exch_list);
+	fibril_mutex_initialize(&sess->mutex);
+	fibril_condvar_initialize(&sess->exch_cv);
+	sess->idle_exch = NULL;
+	sess->exch_active = 0;
+	sess->exch_limit = 0;
+	memset(&sess->stats, 0, sizeof(sess->stats));
+}
 
 /** Initialize the async framework.
  *
@@ -175,6 +207,12 @@ void __async_client_init(void)
 	if (fibril_rmutex_initialize(&message_mutex) != EOK)
 		abort();
 
+	for (size_t i = 0; i < ASYNC_SESS_SHARDS; i++) {
+		fibril_mutex_initialize(&sess_shards[i].mutex);
+		list_initialize(&sess_shards[i].inactive_exch_list);
+		fibril_condvar_initialize(&sess_shards[i].avail_phone_cv);
+	}
+
 	session_ns.iface = 0;
 	session_ns.mgmt = EXCHANGE_ATOMIC;
 	session_ns.phone = PHONE_NS;
@@ -182,12 +220,7 @@ void __async_client_init(void)
 	session_ns.arg2 = 0;
 	session_ns.arg3 = 0;
 
-	fibril_mutex_initialize(&session_ns.remote_state_mtx);
-	session_ns.remote_state_data = NULL;
-
-	list_initialize(&session_ns.exch_list);
-	fibril_mutex_initialize(&session_ns.mutex);
-	session_ns.exchanges = 0;
+	async_sess_init(&session_ns);
 }
 
 void __async_client_fini(void)
@@ -928,9 +961,7 @@ async_sess_t *async_connect_me_to(async_exch_t *exch, iface_t iface,
 	sess->arg2 = arg2;
 	sess->arg3 = arg3;
 
-	fibril_mutex_initialize(&sess->remote_state_mtx);
-	list_initialize(&sess->exch_list);
-	fibril_mutex_initialize(&sess->mutex);
+	async_sess_init(sess);
 
 	return sess;
 }
@@ -1003,9 +1034,7 @@ async_sess_t *async_connect_me_to_blocking(async_exch_t *exch, iface_t iface,
 	sess->arg2 = arg2;
 	sess->arg3 = arg3;
 
-	fibril_mutex_initialize(&sess->remote_state_mtx);
-	list_initialize(&sess->exch_list);
-	fibril_mutex_initialize(&sess->mutex);
+	async_sess_init(sess);
 
 	return sess;
 }
@@ -1042,9 +1071,7 @@ async_sess_t *async_connect_kbox(task_id_t id, errno_t *rc)
 	sess->mgmt = EXCHANGE_ATOMIC;
 	sess->phone = phone;
 
-	fibril_mutex_initialize(&sess->remote_state_mtx);
-	list_initialize(&sess->exch_list);
-	fibril_mutex_initialize(&sess->mutex);
+	async_sess_init(sess);
 
 	return sess;
 }
@@ -1067,128 +1094,271 @@ errno_t async_hangup(async_sess_t *sess)
 
 	assert(sess);
 
-	fibril_mutex_lock(&async_sess_mutex);
+	async_sess_shard_t *shard = async_sess_shard(sess);
+
+	fibril_mutex_lock(&shard->mutex);
 
-	if (sess->exchanges > 0) {
-		fibril_mutex_unlock(&async_sess_mutex);
+	if (sess->exch_active > 0 ||
+	    __atomic_load_n(&sess->stats.in_flight, __ATOMIC_RELAXED) > 0) {
+		fibril_mutex_unlock(&shard->mutex);
 		return EBUSY;
 	}
 
 	errno_t rc = async_hangup_internal(sess->phone);
 
-	while (!list_empty(&sess->exch_list)) {
-		exch = (async_exch_t *)
-		    list_get_instance(list_first(&sess->exch_list),
-		    async_exch_t, sess_link);
-
-		list_remove(&exch->sess_link);
+	while ((exch = list_pop(&sess->exch_list, async_exch_t,
+	    sess_link)) != NULL) {
 		list_remove(&exch->global_link);
 		async_hangup_internal(exch->phone);
 		free(exch);
 	}
 
-	free(sess);
+	fibril_mutex_unlock(&shard->mutex);
 
-	fibril_mutex_unlock(&async_sess_mutex);
+	/* The idle exchange shares the session phone. */
+	free(sess->idle_exch);
+	free(sess);
 
 	return rc;
 }
 
-/** Start new exchange in a session.
+static exch_mgmt_t async_sess_mgmt(async_sess_t *sess)
+{
+	if (sess->iface != 0)
+		return sess->iface & IFACE_EXCHANGE_MASK;
+
+	return sess->mgmt;
+}
+
+static async_exch_t *async_exch_create(async_sess_t *sess,
+    cap_phone_handle_t phone)
+{
+	async_exch_t *exch = (async_exch_t *) malloc(sizeof(async_exch_t));
+	if (exch == NULL)
+		return NULL;
+
+	link_initialize(&exch->sess_link);
+	link_initialize(&exch->global_link);
+	exch->sess = sess;
+	exch->phone = phone;
+	return exch;
+}
+
+/** Close an inactive parallel exchange of any session to free a phone.
  *
- * @param session Session.
+ * Must be called without any shard mutex held.
  *
- * @return New exchange or NULL on error.
+ * @return True if an exchange was closed.
  *
  */
-async_exch_t *async_exchange_begin(async_sess_t *sess)
+static bool async_exch_reclaim(void)
 {
-	if (sess == NULL)
-		return NULL;
+	for (size_t i = 0; i < ASYNC_SESS_SHARDS; i++) {
+		async_sess_shard_t *shard = &sess_shards[i];
 
-	exch_mgmt_t mgmt = sess->mgmt;
-	if (sess->iface != 0)
-		mgmt = sess->iface & IFACE_EXCHANGE_MASK;
+		fibril_mutex_lock(&shard->mutex);
+
+		async_exch_t *exch = list_pop(&shard->inactive_exch_list,
+		    async_exch_t, global_link);
+		if (exch != NULL)
+			list_remove(&exch->sess_link);
+
+		fibril_mutex_unlock(&shard->mutex);
+
+		if (exch != NULL) {
+			async_hangup_internal(exch->phone);
+			free(exch);
+			return true;
+		}
+	}
 
+	return false;
+}
+
+/** Get an exchange of a parallel session.
+ *
+ * Each parallel exchange uses a connection of its own. Inactive connections
+ * of the session are reused, new connections are made up to the exchange
+ * limit of the session.
+ *
+ * @param sess   Session.
+ * @param waited Set to true if the caller had to wait.
+ * @param start  Set to the time the wait started if the caller had to wait.
+ *
+ * @return New exchange or NULL on error.
+ *
+ */
+static async_exch_t *async_exch_get_parallel(async_sess_t *sess,
+    bool *waited, struct timespec *start)
+{
+	async_sess_shard_t *shard = async_sess_shard(sess);
 	async_exch_t *exch = NULL;
 
-	fibril_mutex_lock(&async_sess_mutex);
+	fibril_mutex_lock(&shard->mutex);
+
+	while (sess->exch_limit != 0 && sess->exch_active >= sess->exch_limit) {
+		if (!*waited) {
+			getuptime(start);
+			*waited = true;
+		}
+
+		fibril_condvar_wait(&sess->exch_cv, &shard->mutex);
+	}
+
+	/* Count the exchange in so that the limit holds while we connect. */
+	sess->exch_active++;
+
+	while (true) {
+		exch = list_pop(&sess->exch_list, async_exch_t, sess_link);
+		if (exch != NULL) {
+			/*
+			 * There are inactive exchanges in the session.
+			 */
+			list_remove(&exch->global_link);
+			break;
+		}
+
+		fibril_mutex_unlock(&shard->mutex);
 
-	if (!list_empty(&sess->exch_list)) {
 		/*
-		 * There are inactive exchanges in the session.
+		 * Make a one-time attempt to connect a new data phone.
 		 */
-		exch = (async_exch_t *)
-		    list_get_instance(list_first(&sess->exch_list),
-		    async_exch_t, sess_link);
+		cap_phone_handle_t phone;
+		errno_t rc = async_connect_me_to_internal(sess->phone,
+		    sess->arg1, sess->arg2, sess->arg3, 0, &phone);
+		if (rc == EOK) {
+			exch = async_exch_create(sess, phone);
+			if (exch == NULL)
+				async_hangup_internal(phone);
+
+			fibril_mutex_lock(&shard->mutex);
+			break;
+		}
 
-		list_remove(&exch->sess_link);
-		list_remove(&exch->global_link);
-	} else {
 		/*
-		 * There are no available exchanges in the session.
+		 * We did not manage to connect a new phone. But we can try
+		 * to close some of the currently inactive connections in
+		 * other sessions and try again.
 		 */
+		if (async_exch_reclaim()) {
+			fibril_mutex_lock(&shard->mutex);
+			continue;
+		}
 
-		if ((mgmt == EXCHANGE_ATOMIC) ||
-		    (mgmt == EXCHANGE_SERIALIZE)) {
-			exch = (async_exch_t *) malloc(sizeof(async_exch_t));
-			if (exch != NULL) {
-				link_initialize(&exch->sess_link);
-				link_initialize(&exch->global_link);
-				exch->sess = sess;
-				exch->phone = sess->phone;
-			}
-		} else if (mgmt == EXCHANGE_PARALLEL) {
-			cap_phone_handle_t phone;
-			errno_t rc;
-
-		retry:
-			/*
-			 * Make a one-time attempt to connect a new data phone.
-			 */
-			rc = async_connect_me_to_internal(sess->phone, sess->arg1,
-			    sess->arg2, sess->arg3, 0, &phone);
-			if (rc == EOK) {
-				exch = (async_exch_t *) malloc(sizeof(async_exch_t));
-				if (exch != NULL) {
-					link_initialize(&exch->sess_link);
-					link_initialize(&exch->global_link);
-					exch->sess = sess;
-					exch->phone = phone;
-				} else
-					async_hangup_internal(phone);
-			} else if (!list_empty(&inactive_exch_list)) {
-				/*
-				 * We did not manage to connect a new phone. But we
-				 * can try to close some of the currently inactive
-				 * connections in other sessions and try again.
-				 */
-				exch = (async_exch_t *)
-				    list_get_instance(list_first(&inactive_exch_list),
-				    async_exch_t, global_link);
-
-				list_remove(&exch->sess_link);
-				list_remove(&exch->global_link);
-				async_hangup_internal(exch->phone);
-				free(exch);
-				goto retry;
-			} else {
-				/*
-				 * Wait for a phone to become available.
-				 */
-				fibril_condvar_wait(&avail_phone_cv, &async_sess_mutex);
-				goto retry;
-			}
+		fibril_mutex_lock(&shard->mutex);
+
+		/*
+		 * Unless we are out of phones and another exchange of this
+		 * session is going to return one, give up. Waiting would
+		 * never end e.g. if the server is gone.
+		 */
+		if (rc != ELIMIT || sess->exch_active <= 1)
+			break;
+
+		/*
+		 * Wait for a phone to become available. Exchanges of the
+		 * session end in the same shard and wake us up.
+		 */
+		if (!*waited) {
+			getuptime(start);
+			*waited = true;
 		}
+
+		fibril_condvar_wait(&shard->avail_phone_cv, &shard->mutex);
 	}
 
-	if (exch != NULL)
-		sess->exchanges++;
+	if (exch == NULL) {
+		sess->exch_active--;
+		fibril_condvar_signal(&sess->exch_cv);
+	}
+
+	fibril_mutex_unlock(&shard->mutex);
+
+	return exch;
+}
+
+/** Update the session statistics at the beginning of an exchange.
+ *
+ * @param sess   Session.
+ * @param waited True if the exchange had to wait.
+ * @param start  Time when the wait started.
+ *
+ */
+static void async_sess_stats_begin(async_sess_t *sess, bool waited,
+    struct timespec *start)
+{
+	async_sess_stats_t *stats = &sess->stats;
+
+	__atomic_add_fetch(&stats->exchanges, 1, __ATOMIC_RELAXED);
+	size_t in_flight = __atomic_add_fetch(&stats->in_flight, 1,
+	    __ATOMIC_RELAXED);
+
+	size_t max = __atomic_load_n(&stats->in_flight_max, __ATOMIC_RELAXED);
+	while (in_flight > max) {
+		if (__atomic_compare_exchange_n(&stats->in_flight_max, &max,
+		    in_flight, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+			break;
+	}
+
+	if (!waited)
+		return;
+
+	struct timespec now;
+	getuptime(&now);
+	usec_t wait = NSEC2USEC(ts_sub_diff(&now, start));
 
-	fibril_mutex_unlock(&async_sess_mutex);
+	/* Waiting is the slow path anyway, the shard mutex will do. */
+	async_sess_shard_t *shard = async_sess_shard(sess);
 
-	if (exch != NULL && mgmt == EXCHANGE_SERIALIZE)
+	fibril_mutex_lock(&shard->mutex);
+	stats->waits++;
+	stats->wait_time += wait;
+	if (wait > stats->wait_max)
+		stats->wait_max = wait;
+	fibril_mutex_unlock(&shard->mutex);
+}
+
+/** Start new exchange in a session.
+ *
+ * @param session Session.
+ *
+ * @return New exchange or NULL on error.
+ *
+ */
+async_exch_t *async_exchange_begin(async_sess_t *sess)
+{
+	if (sess == NULL)
+		return NULL;
+
+	exch_mgmt_t mgmt = async_sess_mgmt(sess);
+
+	async_exch_t *exch;
+	struct timespec start;
+	bool waited = false;
+
+	if (mgmt == EXCHANGE_PARALLEL) {
+		exch = async_exch_get_parallel(sess, &waited, &start);
+	} else {
+		/*
+		 * Atomic and serialized exchanges all use the session phone.
+		 * Reuse the idle exchange of the session if there is one.
+		 */
+		exch = __atomic_exchange_n(&sess->idle_exch, NULL,
+		    __ATOMIC_ACQUIRE);
+		if (exch == NULL)
+			exch = async_exch_create(sess, sess->phone);
+	}
+
+	if (exch == NULL)
+		return NULL;
+
+	if (mgmt == EXCHANGE_SERIALIZE && !fibril_mutex_trylock(&sess->mutex)) {
+		getuptime(&start);
+		waited = true;
 		fibril_mutex_lock(&sess->mutex);
+	}
+
+	async_sess_stats_begin(sess, waited, &start);
 
 	return exch;
 }
@@ -1206,22 +1376,82 @@ void async_exchange_end(async_exch_t *exch)
 	async_sess_t *sess = exch->sess;
 	assert(sess != NULL);
 
-	exch_mgmt_t mgmt = sess->mgmt;
-	if (sess->iface != 0)
-		mgmt = sess->iface & IFACE_EXCHANGE_MASK;
+	exch_mgmt_t mgmt = async_sess_mgmt(sess);
 
 	if (mgmt == EXCHANGE_SERIALIZE)
 		fibril_mutex_unlock(&sess->mutex);
 
-	fibril_mutex_lock(&async_sess_mutex);
+	__atomic_sub_fetch(&sess->stats.in_flight, 1, __ATOMIC_RELAXED);
 
-	sess->exchanges--;
+	if (mgmt == EXCHANGE_PARALLEL) {
+		async_sess_shard_t *shard = async_sess_shard(sess);
+
+		fibril_mutex_lock(&shard->mutex);
+
+		sess->exch_active--;
+
+		list_append(&exch->sess_link, &sess->exch_list);
+		list_append(&exch->global_link, &shard->inactive_exch_list);
+		fibril_condvar_signal(&sess->exch_cv);
+		/* Every waiter must re-check whether to keep waiting. */
+		fibril_condvar_broadcast(&shard->avail_phone_cv);
+
+		fibril_mutex_unlock(&shard->mutex);
+		return;
+	}
+
+	/* Keep the exchange for reuse unless there already is one. */
+	async_exch_t *idle = NULL;
+	if (!__atomic_compare_exchange_n(&sess->idle_exch, &idle, exch, false,
+	    __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+		free(exch);
+}
+
+/** Limit the number of exchanges of a parallel session.
+ *
+ * Every parallel exchange uses a connection of its own. The limit bounds
+ * the number of connections the session makes to the server. Fibrils
+ * starting an exchange above the limit wait for another exchange to end.
+ *
+ * @param sess  Session with the EXCHANGE_PARALLEL management style.
+ * @param limit Maximum number of exchanges in progress, zero for no limit.
+ *
+ */
+void async_sess_exch_limit_set(async_sess_t *sess, size_t limit)
+{
+	assert(async_sess_mgmt(sess) == EXCHANGE_PARALLEL);
+
+	async_sess_shard_t *shard = async_sess_shard(sess);
+
+	fibril_mutex_lock(&shard->mutex);
+	sess->exch_limit = limit;
+	fibril_condvar_broadcast(&sess->exch_cv);
+	fibril_mutex_unlock(&shard->mutex);
+}
+
+/** Get exchange statistics of a session.
+ *
+ * The statistics show how much the fibrils using the session wait for each
+ * other, e.g. because of a serialized session or an exchange limit.
+ *
+ * @param sess  Session.
+ * @param stats Place to store the statistics.
+ *
+ */
+void async_sess_stats_get(async_sess_t *sess, async_sess_stats_t *stats)
+{
+	async_sess_shard_t *shard = async_sess_shard(sess);
 
-	list_append(&exch->sess_link, &sess->exch_list);
-	list_append(&exch->global_link, &inactive_exch_list);
-	fibril_condvar_signal(&avail_phone_cv);
+	fibril_mutex_lock(&shard->mutex);
+	*stats = sess->stats;
+	fibril_mutex_unlock(&shard->mutex);
 
-	fibril_mutex_unlock(&async_sess_mutex);
+	stats->exchanges = __atomic_load_n(&sess->stats.exchanges,
+	    __ATOMIC_RELAXED);
+	stats->in_flight = __atomic_load_n(&sess->stats.in_flight,
+	    __ATOMIC_RELAXED);
+	stats->in_flight_max = __atomic_load_n(&sess->stats.in_flight_max,
+	    __ATOMIC_RELAXED);
 }
 
 /** Wrapper for IPC_M_SHARE_IN calls using the async framework.
@@ -78,6 +78,9 @@ typedef struct {
 
 	/** Client data */
 	void *data;
+
+	/** Worker pool handling the connections or NULL */
+	async_pool_t *pool;
 } port_t;
 
 /** Default fallback fibril function.
@@ -97,6 +100,7 @@ static void default_fallback_port_handler(ipc_call_t *call, void *arg)
 static async_port_handler_t fallback_port_handler =
     default_fallback_port_handler;
 static void *fallback_port_data = NULL;
+static async_pool_t *fallback_port_pool = NULL;
 
 /** Futex guarding the interface hash table. */
 static fibril_rmutex_t interface_mutex;
@@ -181,7 +185,7 @@ static interface_t *async_new_interface(iface_t iface)
 }
 
 static port_t *async_new_port(interface_t *interface,
-    async_port_handler_t handler, void *data)
+    async_port_handler_t handler, void *data, async_pool_t *pool)
 {
 	// TODO: Move the malloc out of critical section.
 	port_t *port = (port_t *) malloc(sizeof(port_t));
@@ -194,6 +198,7 @@ static port_t *async_new_port(interface_t *interface,
 	port->id = id;
 	port->handler = handler;
 	port->data = data;
+	port->pool = pool;
 
 	hash_table_insert(&interface->port_hash_table, &port->link);
 
@@ -201,7 +206,7 @@ static port_t *async_new_port(interface_t *interface,
 }
 
 errno_t async_create_port_internal(iface_t iface, async_port_handler_t handler,
-    void *data, port_id_t *port_id)
+    void *data, async_pool_t *pool, port_id_t *port_id)
 {
 	interface_t *interface;
 
@@ -218,7 +223,7 @@ errno_t async_create_port_internal(iface_t iface, async_port_handler_t handler,
 		return ENOMEM;
 	}
 
-	port_t *port = async_new_port(interface, handler, data);
+	port_t *port = async_new_port(interface, handler, data, pool);
 	if (!port) {
 		fibril_rmutex_unlock(&interface_mutex);
 		return ENOMEM;
@@ -237,7 +242,29 @@ errno_t async_create_port(iface_t iface, async_port_handler_t handler,
 	if ((iface & IFACE_MOD_MASK) == IFACE_MOD_CALLBACK)
 		return EINVAL;
 
-	return async_create_port_internal(iface, handler, data, port_id);
+	return async_create_port_internal(iface, handler, data, NULL, port_id);
+}
+
+/** Create a port whose connections are handled by a worker pool.
+ *
+ * @param iface   Interface of the port.
+ * @param handler Call handler, see async_pool_create().
+ * @param data    Client data passed to the handler.
+ * @param pool    Worker pool.
+ * @param port_id Place to store the ID of the new port.
+ *
+ * @return EOK on success or an error code.
+ *
+ */
+errno_t async_create_port_pooled(iface_t iface, async_port_handler_t handler,
+    void *data, async_pool_t *pool, port_id_t *port_id)
+{
+	if ((iface & IFACE_MOD_MASK) == IFACE_MOD_CALLBACK)
+		return EINVAL;
+
+	assert(pool != NULL);
+
+	return async_create_port_internal(iface, handler, data, pool, port_id);
 }
 
 void async_set_fallback_port_handler(async_port_handler_t handler, void *data)
@@ -246,6 +273,25 @@ void async_set_fallback_port_handler(async_port_handler_t handler, void *data)
 
 	fallback_port_handler = handler;
 	fallback_port_data = data;
+	fallback_port_pool = NULL;
+}
+
+/** Set the fallback port handler and let a worker pool run it.
+ *
+ * @param handler Call handler, see async_pool_create().
+ * @param data    Client data passed to the handler.
+ * @param pool    Worker pool.
+ *
+ */
+void async_set_fallback_port_handler_pooled(async_port_handler_t handler,
+    void *data, async_pool_t *pool)
+{
+	assert(handler != NULL);
+	assert(pool != NULL);
+
+	fallback_port_handler = handler;
+	fallback_port_data = data;
+	fallback_port_pool = pool;
 }
 
 static port_t *async_find_port(iface_t iface, port_id_t port_id)
@@ -270,17 +316,20 @@ static port_t *async_find_port(iface_t iface, port_id_t port_id)
 }
 
 async_port_handler_t async_get_port_handler(iface_t iface, port_id_t port_id,
-    void **data)
+    void **data, async_pool_t **pool)
 {
 	assert(data);
+	assert(pool);
 
 	async_port_handler_t handler = fallback_port_handler;
 	*data = fallback_port_data;
+	*pool = fallback_port_pool;
 
 	port_t *port = async_find_port(iface, port_id);
 	if (port) {
 		handler = port->handler;
 		*data = port->data;
+		*pool = port->pool;
 	}
 
 	return handler;
@@ -156,8 +156,51 @@ typedef struct {
 
 	/** Client data */
 	void *data;
+
+	/** Worker pool handling the connection or NULL if it has a fibril. */
+	async_pool_t *pool;
+
+	/** Link to async_pool_t.ready. */
+	link_t pool_link;
+
+	/** Number of routed calls not received by the handler yet. */
+	size_t pending;
+
+	/** Connection is in the ready list or being handled by a worker. */
+	bool scheduled;
+
+	/** Opening call has been handled. */
+	bool opened;
+
+	/** Opening call has been accepted. */
+	bool accepted;
+
+	/** Hangup has been received by the handler. */
+	bool hungup;
 } connection_t;
 
+/** Worker pool
+ *
+ * Instead of having a fibril of their own, connections of pooled ports are
+ * handed to a fixed number of worker fibrils. A connection with pending calls
+ * waits in the ready list until a worker picks it up. A worker takes exclusive
+ * ownership of the connection until the handler of one call returns, so calls
+ * of a connection are handled one at a time and in order.
+ */
+struct async_pool {
+	/** Protects the ready list, scheduling of connections and stats. */
+	fibril_rmutex_t mutex;
+
+	/** Counts connections in the ready list. */
+	fibril_semaphore_t ready_sem;
+
+	/** Connections waiting for a worker. */
+	list_t ready;
+
+	/** Statistics. */
+	async_pool_stats_t stats;
+};
+
 /* Member of notification_t::msg_list. */
 typedef struct {
 	link_t link;
@@ -378,11 +421,339 @@ sysarg_t async_get_label(void)
 	return (sysarg_t) fibril_connection;
 }
 
-/** Create a new fibril for a new connection.
+/** Add a connection to the ready list of its pool.
+ *
+ * Must be called with the pool mutex held.
+ *
+ * @param conn Pooled connection.
+ *
+ * @return True if the connection was added and a worker should be woken up.
+ *
+ */
+static bool async_pool_schedule(connection_t *conn)
+{
+	if (conn->scheduled)
+		return false;
+
+	conn->scheduled = true;
+	list_append(&conn->pool_link, &conn->pool->ready);
+	return true;
+}
+
+/** Update the queue statistics of a pool after an item was queued.
+ *
+ * Must be called with the pool mutex held.
+ *
+ */
+static void async_pool_queued(async_pool_t *pool)
+{
+	pool->stats.queued++;
+	if (pool->stats.queued > pool->stats.queued_max)
+		pool->stats.queued_max = pool->stats.queued;
+}
+
+/** Admit a new connection to its pool.
+ *
+ * The opening call waits in the ready list like any other call. New
+ * connections are refused while the pool is over its queue limit, calls on
+ * the existing connections are always queued.
+ *
+ * @param conn Pooled connection.
+ *
+ * @return EOK on success, ELIMIT if the pool is overloaded.
+ *
+ */
+static errno_t async_pool_admit(connection_t *conn)
+{
+	async_pool_t *pool = conn->pool;
+
+	fibril_rmutex_lock(&pool->mutex);
+
+	if (pool->stats.queue_limit != 0 &&
+	    pool->stats.queued >= pool->stats.queue_limit) {
+		pool->stats.refused++;
+		fibril_rmutex_unlock(&pool->mutex);
+		return ELIMIT;
+	}
+
+	async_pool_queued(pool);
+	bool wakeup = async_pool_schedule(conn);
+
+	fibril_rmutex_unlock(&pool->mutex);
+
+	if (wakeup)
+		fibril_semaphore_up(&pool->ready_sem);
+
+	return EOK;
+}
+
+/** Route a call to a pooled connection.
+ *
+ * The call is sent and accounted for under the pool mutex so that the worker
+ * cannot destroy the connection in between.
+ *
+ * @param conn Pooled connection.
+ * @param call Data of the incoming call.
+ *
+ * @return EOK on success or an error code.
+ *
+ */
+static errno_t async_pool_route_call(connection_t *conn, ipc_call_t *call)
+{
+	async_pool_t *pool = conn->pool;
+	bool wakeup = false;
+
+	fibril_rmutex_lock(&pool->mutex);
+
+	errno_t rc = mpsc_send(conn->msg_channel, call);
+	if (rc == EOK) {
+		conn->pending++;
+		async_pool_queued(pool);
+		wakeup = async_pool_schedule(conn);
+	}
+
+	if (ipc_get_imethod(call) == IPC_M_PHONE_HUNGUP)
+		mpsc_close(conn->msg_channel);
+
+	fibril_rmutex_unlock(&pool->mutex);
+
+	if (wakeup)
+		fibril_semaphore_up(&pool->ready_sem);
+
+	return rc;
+}
+
+/** Account for a call received from the channel of a pooled connection.
+ *
+ * @param conn Pooled connection.
+ *
+ */
+static void async_pool_received(connection_t *conn)
+{
+	async_pool_t *pool = conn->pool;
+
+	fibril_rmutex_lock(&pool->mutex);
+	assert(conn->pending > 0);
+	conn->pending--;
+	pool->stats.queued--;
+	fibril_rmutex_unlock(&pool->mutex);
+}
+
+/** Pass the opening call of a pooled connection to the handler.
+ *
+ * The handler is responsible for answering the opening call. The connection
+ * is kept only if the handler accepts it using async_accept_0().
+ *
+ * @param conn Pooled connection.
+ *
+ */
+static void async_pool_conn_open(connection_t *conn)
+{
+	conn->opened = true;
+
+	client_t *client = async_client_get(conn->in_task_id, true);
+	if (!client) {
+		ipc_answer_0(conn->call.cap_handle, ENOMEM);
+		return;
+	}
+
+	conn->client = client;
+	conn->handler(&conn->call, conn->data);
+}
+
+/** Pass the next call of a pooled connection to the handler.
+ *
+ * A hangup is answered on behalf of the handler if it did not do so.
+ *
+ * @param conn Pooled connection.
+ *
+ */
+static void async_pool_conn_handle(connection_t *conn)
+{
+	ipc_call_t call;
+
+	async_get_call(&call);
+	conn->handler(&call, conn->data);
+
+	if (!ipc_get_imethod(&call) && call.cap_handle != CAP_NIL)
+		async_answer_0(&call, EOK);
+}
+
+/** Destroy a pooled connection which is not going to receive more calls.
+ *
+ * @param conn Pooled connection.
+ *
+ */
+static void async_pool_conn_destroy(connection_t *conn)
+{
+	if (conn->client)
+		async_client_put(conn->client);
+
+	mpsc_close(conn->msg_channel);
+
+	ipc_call_t call;
+	while (mpsc_receive(conn->msg_channel, &call, NULL) == EOK) {
+		async_pool_received(conn);
+		ipc_answer_0(call.cap_handle, EHANGUP);
+	}
+
+	mpsc_destroy(conn->msg_channel);
+	free(conn);
+}
+
+/** Function implementing a pool worker fibril. Never returns. */
+static errno_t async_pool_worker(void *arg)
+{
+	async_pool_t *pool = (async_pool_t *) arg;
+
+	while (true) {
+		fibril_semaphore_down(&pool->ready_sem);
+
+		fibril_rmutex_lock(&pool->mutex);
+
+		/*
+		 * The semaphore ensures that if we get this far,
+		 * the ready list must be non-empty.
+		 */
+		connection_t *conn = list_pop(&pool->ready, connection_t,
+		    pool_link);
+		assert(conn);
+
+		/* The opening call does not go through the channel. */
+		if (!conn->opened)
+			pool->stats.queued--;
+
+		pool->stats.busy++;
+
+		fibril_rmutex_unlock(&pool->mutex);
+
+		fibril_connection = conn;
+
+		bool done;
+		if (!conn->opened) {
+			async_pool_conn_open(conn);
+			done = !conn->accepted;
+		} else {
+			async_pool_conn_handle(conn);
+			done = false;
+		}
+
+		/* The handler may have received the hangup by itself. */
+		done = done || conn->hungup;
+
+		fibril_connection = NULL;
+
+		fibril_rmutex_lock(&pool->mutex);
+
+		pool->stats.busy--;
+		pool->stats.handled++;
+
+		/*
+		 * Calls that arrived while we were handling the connection
+		 * did not schedule it, do it now.
+		 */
+		conn->scheduled = false;
+		bool wakeup = false;
+		if (!done && conn->pending > 0)
+			wakeup = async_pool_schedule(conn);
+
+		fibril_rmutex_unlock(&pool->mutex);
+
+		if (wakeup)
+			fibril_semaphore_up(&pool->ready_sem);
+
+		if (done)
+			async_pool_conn_destroy(conn);
+	}
+
+	/* Not reached. */
+	return EOK;
+}
+
+/** Create a pool of worker fibrils for handling connections.
+ *
+ * Connections of ports created with async_create_port_pooled() are handled
+ * by the workers of the pool instead of dedicated connection fibrils. The
+ * port handler is called once for each call, including the opening call and
+ * the hangup, and must not block for long as it occupies one of the workers.
+ * Calls of a single connection are always handled one after another in the
+ * order of their arrival.
+ *
+ * Currently, there is no way to destroy the pool after it is created.
+ *
+ * @param workers     Number of worker fibrils.
+ * @param queue_limit Number of queued calls and connections above which new
+ *                    connections are refused with ELIMIT. Zero for no limit.
+ * @param rpool       Place to store the pointer to the new pool.
+ *
+ * @return EOK on success or an error code.
+ *
+ */
+errno_t async_pool_create(size_t workers, size_t queue_limit,
+    async_pool_t **rpool)
+{
+	if (workers == 0)
+		return EINVAL;
+
+	async_pool_t *pool = calloc(1, sizeof(async_pool_t));
+	fid_t *fids = calloc(workers, sizeof(fid_t));
+	if (!pool || !fids) {
+		free(pool);
+		free(fids);
+		return ENOMEM;
+	}
+
+	if (fibril_rmutex_initialize(&pool->mutex) != EOK) {
+		free(pool);
+		free(fids);
+		return ENOMEM;
+	}
+
+	fibril_semaphore_initialize(&pool->ready_sem, 0);
+	list_initialize(&pool->ready);
+	pool->stats.workers = workers;
+	pool->stats.queue_limit = queue_limit;
+
+	for (size_t i = 0; i < workers; i++) {
+		fids[i] = fibril_create(async_pool_worker, pool);
+		if (fids[i] == 0) {
+			while (i-- > 0)
+				fibril_destroy(fids[i]);
+
+			fibril_rmutex_destroy(&pool->mutex);
+			free(pool);
+			free(fids);
+			return ENOMEM;
+		}
+	}
+
+	for (size_t i = 0; i < workers; i++)
+		fibril_add_ready(fids[i]);
+
+	free(fids);
+
+	*rpool = pool;
+	return EOK;
+}
+
+/** Get statistics of a worker pool.
+ *
+ * @param pool  Worker pool.
+ * @param stats Place to store the statistics.
+ *
+ */
+void async_pool_stats_get(async_pool_t *pool, async_pool_stats_t *stats)
+{
+	fibril_rmutex_lock(&pool->mutex);
+	*stats = pool->stats;
+	fibril_rmutex_unlock(&pool->mutex);
+}
+
+/** Set up a new connection.
  *
- * Create new fibril for connection, fill in connection structures and insert it
- * into the hash table, so that later we can easily do routing of messages to
- * particular fibrils.
+ * Create new fibril for connection or hand it over to a worker pool, fill in
+ * connection structures and insert it into the hash table, so that later we
+ * can easily do routing of messages to particular fibrils.
  *
  * @param conn        Pointer to the connection structure. Will be used as the
  *                    label of the connected phone and request_label of incoming
@@ -394,17 +765,25 @@ sysarg_t async_get_label(void)
  *                    directly by the server.
  * @param handler     Connection handler.
  * @param data        Client argument to pass to the connection handler.
+ * @param pool        Worker pool handling the connection or NULL to create
+ *                    a new fibril. Must be NULL if call is NULL.
  *
- * @return  New fibril id or NULL on failure.
+ * @return EOK on success or an error code.
  *
  */
-static fid_t async_new_connection(connection_t *conn, task_id_t in_task_id,
-    ipc_call_t *call, async_port_handler_t handler, void *data)
+static errno_t async_new_connection(connection_t *conn, task_id_t in_task_id,
+    ipc_call_t *call, async_port_handler_t handler, void *data,
+    async_pool_t *pool)
 {
+	errno_t rc = ENOMEM;
+
+	assert(call != NULL || pool == NULL);
+
 	conn->in_task_id = in_task_id;
 	conn->msg_channel = mpsc_create(sizeof(ipc_call_t));
 	conn->handler = handler;
 	conn->data = data;
+	conn->pool = pool;
 
 	if (!conn->msg_channel)
 		goto error;
@@ -414,6 +793,14 @@ static fid_t async_new_connection(connection_t *conn, task_id_t in_task_id,
 	else
 		conn->call.cap_handle = CAP_NIL;
 
+	if (pool) {
+		rc = async_pool_admit(conn);
+		if (rc != EOK)
+			goto error;
+
+		return EOK;
+	}
+
 	/* We will activate the fibril ASAP */
 	conn->fid = fibril_create(connection_fibril, conn);
 
@@ -422,7 +809,7 @@ static fid_t async_new_connection(connection_t *conn, task_id_t in_task_id,
 
 	fibril_start(conn->fid);
 
-	return conn->fid;
+	return EOK;
 
 error:
 	if (conn->msg_channel)
@@ -430,9 +817,9 @@ error:
 	free(conn);
 
 	if (call)
-		ipc_answer_0(call->cap_handle, ENOMEM);
+		ipc_answer_0(call->cap_handle, rc);
 
-	return (fid_t) NULL;
+	return rc;
 }
 
 /** Wrapper for making IPC_M_CONNECT_TO_ME calls using the async framework.
@@ -474,18 +861,14 @@ errno_t async_create_callback_port(async_exch_t *exch, iface_t iface, sysarg_t a
 		return rc;
 	}
 
-	rc = async_create_port_internal(iface, handler, data, port_id);
+	rc = async_create_port_internal(iface, handler, data, NULL, port_id);
 	if (rc != EOK) {
 		free(conn);
 		return rc;
 	}
 
-	fid_t fid = async_new_connection(conn, answer.task_id, NULL, handler,
-	    data);
-	if (fid == (fid_t) NULL)
-		return ENOMEM;
-
-	return EOK;
+	return async_new_connection(conn, answer.task_id, NULL, handler, data,
+	    NULL);
 }
 
 static size_t notification_key_hash(const void *key)
@@ -542,6 +925,9 @@ static errno_t route_call(ipc_call_t *call)
 
 	assert(conn->msg_channel);
 
+	if (conn->pool)
+		return async_pool_route_call(conn, call);
+
 	errno_t rc = mpsc_send(conn->msg_channel, call);
 
 	if (ipc_get_imethod(call) == IPC_M_PHONE_HUNGUP) {
@@ -862,6 +1248,9 @@ bool async_get_call_timeout(ipc_call_t *call, usec_t usecs)
 	if (rc == ETIMEOUT)
 		return false;
 
+	if (rc == EOK && fibril_connection->pool)
+		async_pool_received(fibril_connection);
+
 	if (rc != EOK) {
 		/*
 		 * The async_get_call_timeout() interface doesn't support
@@ -873,6 +1262,9 @@ bool async_get_call_timeout(ipc_call_t *call, usec_t usecs)
 		call->cap_handle = CAP_NIL;
 	}
 
+	if (!ipc_get_imethod(call))
+		fibril_connection->hungup = true;
+
 	return true;
 }
 
@@ -953,10 +1345,12 @@ static void handle_call(ipc_call_t *call)
 
 		// TODO: Currently ignores all ports but the first one.
 		void *data;
+		async_pool_t *pool;
 		async_port_handler_t handler =
-		    async_get_port_handler(iface, 0, &data);
+		    async_get_port_handler(iface, 0, &data, &pool);
 
-		async_new_connection(conn, call->task_id, call, handler, data);
+		async_new_connection(conn, call->task_id, call, handler, data,
+		    pool);
 		return;
 	}
 
@@ -1044,6 +1438,10 @@ errno_t async_accept_0(ipc_call_t *call)
 	cap_call_handle_t chandle = call->cap_handle;
 	assert(chandle != CAP_NIL);
 	call->cap_handle = CAP_NIL;
+
+	if (fibril_connection)
+		fibril_connection->accepted = true;
+
 	return ipc_answer_5(chandle, EOK, 0, 0, 0, 0, async_get_label());
 }
 
@@ -1748,9 +2146,7 @@ async_sess_t *async_callback_receive(exch_mgmt_t mgmt)
 	sess->mgmt = mgmt;
 	sess->phone = phandle;
 
-	fibril_mutex_initialize(&sess->remote_state_mtx);
-	list_initialize(&sess->exch_list);
-	fibril_mutex_initialize(&sess->mutex);
+	async_sess_init(sess);
 
 	/* Acknowledge the connected phone */
 	async_answer_0(&call, EOK);
@@ -1788,9 +2184,7 @@ async_sess_t *async_callback_receive_start(exch_mgmt_t mgmt, ipc_call_t *call)
 	sess->mgmt = mgmt;
 	sess->phone = phandle;
 
-	fibril_mutex_initialize(&sess->remote_state_mtx);
-	list_initialize(&sess->exch_list);
-	fibril_mutex_initialize(&sess->mutex);
+	async_sess_init(sess);
 
 	return sess;
 }
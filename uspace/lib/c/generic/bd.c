@@ -34,6 +34,8 @@
  * @brief Block device client interface
  */
 
+#include <align.h>
+#include <as.h>
 #include <async.h>
 #include <assert.h>
 #include <bd.h>
@@ -42,6 +44,7 @@
 #include <ipc/services.h>
 #include <loc.h>
 #include <macros.h>
+#include <mem.h>
 #include <stdlib.h>
 #include <offset.h>
 
@@ -54,6 +57,9 @@ errno_t bd_open(async_sess_t *sess, bd_t **rbd)
 		return ENOMEM;
 
 	bd->sess = sess;
+	fibril_mutex_initialize(&bd->lock);
+	fibril_condvar_initialize(&bd->free_cv);
+	fibril_condvar_initialize(&bd->done_cv);
 
 	async_exch_t *exch = async_exchange_begin(sess);
 
@@ -76,14 +82,320 @@ error:
 	return rc;
 }
 
+/** Open block device with a shared data area.
+ *
+ * In addition to bd_open() this negotiates a data area shared with the
+ * server. The area is divided into @a depth slots of @a slot_size bytes,
+ * one for each request tag. Tagged requests transfer their data through
+ * their slot and can be kept in flight simultaneously. bd_read_blocks()
+ * and bd_write_blocks() use them transparently.
+ *
+ * If the server does not accept the shared area, the block device is
+ * opened without it and the plain protocol is used.
+ *
+ * @param sess Session
+ * @param depth Requested queue depth (number of request tags)
+ * @param slot_size Size of data slot of one request in bytes
+ * @param rbd Place to store pointer to new block device
+ * @return EOK on success or an error code
+ */
+errno_t bd_open_shm(async_sess_t *sess, unsigned depth, size_t slot_size,
+    bd_t **rbd)
+{
+	bd_t *bd;
+	errno_t rc;
+
+	rc = bd_open(sess, &bd);
+	if (rc != EOK)
+		return rc;
+
+	depth = min(depth, (unsigned) BD_QUEUE_DEPTH_MAX);
+	if (depth == 0 || slot_size == 0)
+		goto done;
+
+	size_t size = ALIGN_UP(depth * slot_size, PAGE_SIZE);
+	void *shm = as_area_create(AS_AREA_ANY, size,
+	    AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE, AS_AREA_UNPAGED);
+	if (shm == AS_MAP_FAILED)
+		goto done;
+
+	async_exch_t *exch = async_exchange_begin(sess);
+
+	ipc_call_t answer;
+	aid_t req = async_send_2(exch, BD_SHM_SETUP, depth, slot_size,
+	    &answer);
+	rc = async_share_out_start(exch, shm, AS_AREA_READ | AS_AREA_WRITE);
+	async_exchange_end(exch);
+
+	if (rc != EOK) {
+		async_forget(req);
+		as_area_destroy(shm);
+		goto done;
+	}
+
+	errno_t retval;
+	async_wait_for(req, &retval);
+	if (retval != EOK || ipc_get_arg1(&answer) == 0 ||
+	    ipc_get_arg1(&answer) > depth) {
+		as_area_destroy(shm);
+		goto done;
+	}
+
+	bd->shm = shm;
+	bd->shm_size = size;
+	bd->slot_size = slot_size;
+	bd->depth = ipc_get_arg1(&answer);
+done:
+	*rbd = bd;
+	return EOK;
+}
+
 void bd_close(bd_t *bd)
 {
 	/* XXX Synchronize with bd_cb_conn */
+	if (bd->shm != NULL)
+		as_area_destroy(bd->shm);
 	free(bd);
 }
 
+/** Allocate request tag.
+ *
+ * @param bd Block device opened with bd_open_shm()
+ * @param wait @c true to wait until a tag is free
+ * @param rtag Place to store tag
+ * @param rbuf Place to store pointer to the data slot of the tag
+ *
+ * @return EOK on success, ENOTSUP if there is no shared area, EBUSY if
+ *         @a wait is @c false and no tag is free
+ */
+errno_t bd_req_alloc(bd_t *bd, bool wait, unsigned *rtag, void **rbuf)
+{
+	unsigned tag;
+
+	if (bd->shm == NULL)
+		return ENOTSUP;
+
+	fibril_mutex_lock(&bd->lock);
+	while (true) {
+		for (tag = 0; tag < bd->depth; tag++) {
+			if (bd->req[tag].state == bdrs_free)
+				break;
+		}
+
+		if (tag < bd->depth)
+			break;
+
+		if (!wait) {
+			fibril_mutex_unlock(&bd->lock);
+			return EBUSY;
+		}
+
+		fibril_condvar_wait(&bd->free_cv, &bd->lock);
+	}
+
+	bd->req[tag].state = bdrs_idle;
+	fibril_mutex_unlock(&bd->lock);
+
+	*rtag = tag;
+	*rbuf = bd->shm + tag * bd->slot_size;
+	return EOK;
+}
+
+/** Free request tag.
+ *
+ * The tag must not have a request in flight.
+ *
+ * @param bd Block device
+ * @param tag Tag
+ */
+void bd_req_free(bd_t *bd, unsigned tag)
+{
+	fibril_mutex_lock(&bd->lock);
+	assert(bd->req[tag].state == bdrs_idle);
+	bd->req[tag].state = bdrs_free;
+	fibril_condvar_signal(&bd->free_cv);
+	fibril_mutex_unlock(&bd->lock);
+}
+
+static errno_t bd_req_submit(bd_t *bd, bd_request_t method, unsigned tag,
+    aoff64_t ba, size_t cnt)
+{
+	if (tag >= bd->depth || cnt == 0)
+		return EINVAL;
+
+	fibril_mutex_lock(&bd->lock);
+	assert(bd->req[tag].state == bdrs_idle);
+	bd->req[tag].state = bdrs_pending;
+	fibril_mutex_unlock(&bd->lock);
+
+	async_exch_t *exch = async_exchange_begin(bd->sess);
+	async_msg_4(exch, method, tag, LOWER32(ba), UPPER32(ba), cnt);
+	async_exchange_end(exch);
+
+	return EOK;
+}
+
+/** Submit tagged read request.
+ *
+ * The data is read into the data slot of the tag. The function does not
+ * wait for the request to complete.
+ *
+ * @param bd Block device
+ * @param tag Allocated tag with no request in flight
+ * @param ba Address of first block
+ * @param cnt Number of blocks, must fit into the data slot
+ * @return EOK if the request was submitted or an error code
+ */
+errno_t bd_req_read(bd_t *bd, unsigned tag, aoff64_t ba, size_t cnt)
+{
+	return bd_req_submit(bd, BD_REQ_READ, tag, ba, cnt);
+}
+
+/** Submit tagged write request.
+ *
+ * The data is taken from the data slot of the tag. The function does not
+ * wait for the request to complete.
+ *
+ * @param bd Block device
+ * @param tag Allocated tag with no request in flight
+ * @param ba Address of first block
+ * @param cnt Number of blocks, must fit into the data slot
+ * @return EOK if the request was submitted or an error code
+ */
+errno_t bd_req_write(bd_t *bd, unsigned tag, aoff64_t ba, size_t cnt)
+{
+	return bd_req_submit(bd, BD_REQ_WRITE, tag, ba, cnt);
+}
+
+/** Wait for completion of tagged request.
+ *
+ * @param bd Block device
+ * @param tag Tag of submitted request
+ * @return Completion status of the request
+ */
+errno_t bd_req_wait(bd_t *bd, unsigned tag)
+{
+	errno_t rc;
+
+	fibril_mutex_lock(&bd->lock);
+	while (bd->req[tag].state == bdrs_pending)
+		fibril_condvar_wait(&bd->done_cv, &bd->lock);
+
+	assert(bd->req[tag].state == bdrs_done);
+	rc = bd->req[tag].rc;
+	bd->req[tag].state = bdrs_idle;
+	fibril_mutex_unlock(&bd->lock);
+
+	return rc;
+}
+
+/** Wait for completion of any tagged request.
+ *
+ * Requests can complete in a different order than they were submitted.
+ *
+ * @param bd Block device
+ * @param rtag Place to store tag of the completed request
+ * @param rrc Place to store completion status of the request
+ * @return EOK on success, ENOENT if there is no request in flight
+ */
+errno_t bd_req_wait_any(bd_t *bd, unsigned *rtag, errno_t *rrc)
+{
+	fibril_mutex_lock(&bd->lock);
+	while (true) {
+		bool pending = false;
+
+		for (unsigned tag = 0; tag < bd->depth; tag++) {
+			if (bd->req[tag].state == bdrs_done) {
+				bd->req[tag].state = bdrs_idle;
+				*rtag = tag;
+				*rrc = bd->req[tag].rc;
+				fibril_mutex_unlock(&bd->lock);
+				return EOK;
+			}
+
+			if (bd->req[tag].state == bdrs_pending)
+				pending = true;
+		}
+
+		if (!pending)
+			break;
+
+		fibril_condvar_wait(&bd->done_cv, &bd->lock);
+	}
+
+	fibril_mutex_unlock(&bd->lock);
+	return ENOENT;
+}
+
+/** Read or write blocks using tagged requests.
+ *
+ * The transfer is split into slot-sized requests which are all submitted
+ * before waiting for them. Only the first request of a batch waits for a
+ * free tag so that we never sleep while holding tags of unsubmitted
+ * requests.
+ */
+static errno_t bd_rw_blocks_shm(bd_t *bd, bool write, aoff64_t ba, size_t cnt,
+    void *data, size_t size)
+{
+	unsigned tags[BD_QUEUE_DEPTH_MAX];
+	void *bufs[BD_QUEUE_DEPTH_MAX];
+	size_t cnts[BD_QUEUE_DEPTH_MAX];
+	size_t bsize = size / cnt;
+	size_t slot_blocks = bd->slot_size / bsize;
+	uint8_t *dp = data;
+	errno_t rc = EOK;
+
+	while (cnt > 0 && rc == EOK) {
+		unsigned n = 0;
+		uint8_t *bp = dp;
+
+		while (n < bd->depth && cnt > 0) {
+			if (bd_req_alloc(bd, n == 0, &tags[n], &bufs[n]) != EOK)
+				break;
+
+			cnts[n] = min(cnt, slot_blocks);
+			if (write) {
+				memcpy(bufs[n], dp, cnts[n] * bsize);
+				(void) bd_req_write(bd, tags[n], ba, cnts[n]);
+			} else {
+				(void) bd_req_read(bd, tags[n], ba, cnts[n]);
+			}
+
+			ba += cnts[n];
+			cnt -= cnts[n];
+			dp += cnts[n] * bsize;
+			n++;
+		}
+
+		for (unsigned i = 0; i < n; i++) {
+			errno_t rrc = bd_req_wait(bd, tags[i]);
+			if (rrc == EOK && !write)
+				memcpy(bp, bufs[i], cnts[i] * bsize);
+			if (rc == EOK)
+				rc = rrc;
+
+			bp += cnts[i] * bsize;
+			bd_req_free(bd, tags[i]);
+		}
+	}
+
+	return rc;
+}
+
+/** Determine whether a transfer can go through the shared area. */
+static bool bd_shm_usable(bd_t *bd, size_t cnt, size_t size)
+{
+	if (bd->shm == NULL || cnt == 0 || size % cnt != 0)
+		return false;
+
+	return size / cnt > 0 && size / cnt <= bd->slot_size;
+}
+
 errno_t bd_read_blocks(bd_t *bd, aoff64_t ba, size_t cnt, void *data, size_t size)
 {
+	if (bd_shm_usable(bd, cnt, size))
+		return bd_rw_blocks_shm(bd, false, ba, cnt, data, size);
+
 	async_exch_t *exch = async_exchange_begin(bd->sess);
 
 	ipc_call_t answer;
@@ -132,6 +444,11 @@ errno_t bd_read_toc(bd_t *bd, uint8_t session, void *buf, size_t size)
 errno_t bd_write_blocks(bd_t *bd, aoff64_t ba, size_t cnt, const void *data,
     size_t size)
 {
+	if (bd_shm_usable(bd, cnt, size)) {
+		return bd_rw_blocks_shm(bd, true, ba, cnt, (void *) data,
+		    size);
+	}
+
 	async_exch_t *exch = async_exchange_begin(bd->sess);
 
 	ipc_call_t answer;
@@ -195,12 +512,26 @@ errno_t bd_get_num_blocks(bd_t *bd, aoff64_t *rnb)
 	return EOK;
 }
 
+static void bd_ev_req_done(bd_t *bd, ipc_call_t *call)
+{
+	unsigned tag = ipc_get_arg1(call);
+	errno_t rc = ipc_get_arg2(call);
+
+	fibril_mutex_lock(&bd->lock);
+	if (tag < bd->depth && bd->req[tag].state == bdrs_pending) {
+		bd->req[tag].rc = rc;
+		bd->req[tag].state = bdrs_done;
+		fibril_condvar_broadcast(&bd->done_cv);
+	}
+	fibril_mutex_unlock(&bd->lock);
+
+	async_answer_0(call, EOK);
+}
+
 static void bd_cb_conn(ipc_call_t *icall, void *arg)
 {
 	bd_t *bd = (bd_t *)arg;
 
-	(void)bd;
-
 	while (true) {
 		ipc_call_t call;
 		async_get_call(&call);
@@ -211,6 +542,9 @@ static void bd_cb_conn(ipc_call_t *icall, void *arg)
 		}
 
 		switch (ipc_get_imethod(&call)) {
+		case BD_EV_REQ_DONE:
+			bd_ev_req_done(bd, &call);
+			break;
 		default:
 			async_answer_0(&call, ENOTSUP);
 		}
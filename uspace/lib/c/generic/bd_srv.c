@@ -33,7 +33,10 @@
  * @file
  * @brief Block device server stub
  */
+#include <as.h>
+#include <assert.h>
 #include <errno.h>
+#include <fibril.h>
 #include <ipc/bd.h>
 #include <macros.h>
 #include <stdlib.h>
@@ -203,6 +206,171 @@ static void bd_get_num_blocks_srv(bd_srv_t *srv, ipc_call_t *call)
 	async_answer_2(call, rc, LOWER32(num_blocks), UPPER32(num_blocks));
 }
 
+static void bd_shm_setup_srv(bd_srv_t *srv, ipc_call_t *call)
+{
+	unsigned depth;
+	size_t slot_size;
+	size_t block_size;
+	unsigned int flags;
+	size_t size;
+	void *shm;
+	errno_t rc;
+
+	depth = ipc_get_arg1(call);
+	slot_size = ipc_get_arg2(call);
+
+	ipc_call_t scall;
+	if (!async_share_out_receive(&scall, &size, &flags)) {
+		async_answer_0(call, EINVAL);
+		return;
+	}
+
+	if (srv->shm != NULL || depth == 0 || depth > BD_QUEUE_DEPTH_MAX ||
+	    slot_size == 0 || size / depth < slot_size) {
+		async_answer_0(&scall, EINVAL);
+		async_answer_0(call, EINVAL);
+		return;
+	}
+
+	if (srv->srvs->ops->get_block_size == NULL) {
+		async_answer_0(&scall, ENOTSUP);
+		async_answer_0(call, ENOTSUP);
+		return;
+	}
+
+	rc = srv->srvs->ops->get_block_size(srv, &block_size);
+	if (rc != EOK || block_size == 0) {
+		async_answer_0(&scall, ENOTSUP);
+		async_answer_0(call, ENOTSUP);
+		return;
+	}
+
+	rc = async_share_out_finalize(&scall, &shm);
+	if (rc != EOK || shm == AS_MAP_FAILED) {
+		async_answer_0(call, ENOMEM);
+		return;
+	}
+
+	srv->shm = shm;
+	srv->slot_size = slot_size;
+	srv->block_size = block_size;
+	srv->depth = min(depth, max(srv->srvs->queue_depth, 1U));
+
+	async_answer_1(call, EOK, srv->depth);
+}
+
+/** Tagged request being processed by the server */
+typedef struct {
+	bd_srv_t *srv;
+	bool write;
+	unsigned tag;
+	aoff64_t ba;
+	size_t cnt;
+} bd_srv_req_t;
+
+static void bd_srv_req_done(bd_srv_t *srv, unsigned tag, errno_t rc)
+{
+	async_exch_t *exch = async_exchange_begin(srv->client_sess);
+	async_msg_2(exch, BD_EV_REQ_DONE, tag, rc);
+	async_exchange_end(exch);
+}
+
+static errno_t bd_srv_req_fibril(void *arg)
+{
+	bd_srv_req_t *req = (bd_srv_req_t *) arg;
+	bd_srv_t *srv = req->srv;
+	void *buf = srv->shm + req->tag * srv->slot_size;
+	size_t size = req->cnt * srv->block_size;
+	errno_t rc;
+
+	if (req->write) {
+		if (srv->srvs->ops->write_blocks != NULL) {
+			rc = srv->srvs->ops->write_blocks(srv, req->ba, req->cnt,
+			    buf, size);
+		} else {
+			rc = ENOTSUP;
+		}
+	} else {
+		if (srv->srvs->ops->read_blocks != NULL) {
+			rc = srv->srvs->ops->read_blocks(srv, req->ba, req->cnt,
+			    buf, size);
+		} else {
+			rc = ENOTSUP;
+		}
+	}
+
+	bd_srv_req_done(srv, req->tag, rc);
+	free(req);
+
+	fibril_mutex_lock(&srv->lock);
+	assert(srv->inflight > 0);
+	srv->inflight--;
+	fibril_condvar_broadcast(&srv->inflight_cv);
+	fibril_mutex_unlock(&srv->lock);
+
+	return EOK;
+}
+
+/** Start processing of a tagged request.
+ *
+ * The request is processed by a separate fibril so that the connection
+ * fibril can accept further requests. Completion is reported to the
+ * client by BD_EV_REQ_DONE.
+ */
+static void bd_req_srv(bd_srv_t *srv, ipc_call_t *call, bool write)
+{
+	bd_srv_req_t *req;
+	unsigned tag;
+	aoff64_t ba;
+	size_t cnt;
+	fid_t fid;
+
+	tag = ipc_get_arg1(call);
+	ba = MERGE_LOUP32(ipc_get_arg2(call), ipc_get_arg3(call));
+	cnt = ipc_get_arg4(call);
+	async_answer_0(call, EOK);
+
+	if (srv->shm == NULL || tag >= srv->depth || cnt == 0 ||
+	    cnt > srv->slot_size / srv->block_size) {
+		bd_srv_req_done(srv, tag, EINVAL);
+		return;
+	}
+
+	req = calloc(1, sizeof(bd_srv_req_t));
+	if (req == NULL) {
+		bd_srv_req_done(srv, tag, ENOMEM);
+		return;
+	}
+
+	req->srv = srv;
+	req->write = write;
+	req->tag = tag;
+	req->ba = ba;
+	req->cnt = cnt;
+
+	fid = fibril_create(bd_srv_req_fibril, req);
+	if (fid == 0) {
+		free(req);
+		bd_srv_req_done(srv, tag, ENOMEM);
+		return;
+	}
+
+	fibril_mutex_lock(&srv->lock);
+	srv->inflight++;
+	fibril_mutex_unlock(&srv->lock);
+
+	fibril_add_ready(fid);
+}
+
+/** Wait until all tagged requests of a client have completed. */
+static void bd_srv_drain(bd_srv_t *srv)
+{
+	fibril_mutex_lock(&srv->lock);
+	while (srv->inflight > 0)
+		fibril_condvar_wait(&srv->inflight_cv, &srv->lock);
+	fibril_mutex_unlock(&srv->lock);
+}
+
 static bd_srv_t *bd_srv_create(bd_srvs_t *srvs)
 {
 	bd_srv_t *srv;
@@ -212,6 +380,8 @@ static bd_srv_t *bd_srv_create(bd_srvs_t *srvs)
 		return NULL;
 
 	srv->srvs = srvs;
+	fibril_mutex_initialize(&srv->lock);
+	fibril_condvar_initialize(&srv->inflight_cv);
 	return srv;
 }
 
@@ -219,6 +389,7 @@ void bd_srvs_init(bd_srvs_t *srvs)
 {
 	srvs->ops = NULL;
 	srvs->sarg = NULL;
+	srvs->queue_depth = 1;
 }
 
 errno_t bd_conn(ipc_call_t *icall, bd_srvs_t *srvs)
@@ -254,6 +425,22 @@ errno_t bd_conn(ipc_call_t *icall, bd_srvs_t *srvs)
 			break;
 		}
 
+		if (method == BD_REQ_READ) {
+			bd_req_srv(srv, &call, false);
+			continue;
+		}
+
+		if (method == BD_REQ_WRITE) {
+			bd_req_srv(srv, &call, true);
+			continue;
+		}
+
+		/*
+		 * Other requests are not processed concurrently with
+		 * tagged requests.
+		 */
+		bd_srv_drain(srv);
+
 		switch (method) {
 		case BD_READ_BLOCKS:
 			bd_read_blocks_srv(srv, &call);
@@ -273,11 +460,18 @@ errno_t bd_conn(ipc_call_t *icall, bd_srvs_t *srvs)
 		case BD_GET_NUM_BLOCKS:
 			bd_get_num_blocks_srv(srv, &call);
 			break;
+		case BD_SHM_SETUP:
+			bd_shm_setup_srv(srv, &call);
+			break;
 		default:
 			async_answer_0(&call, EINVAL);
 		}
 	}
 
+	bd_srv_drain(srv);
+	if (srv->shm != NULL)
+		as_area_destroy(srv->shm);
+
 	rc = srvs->ops->close(srv);
 	free(srv);
 
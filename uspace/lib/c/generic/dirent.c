@@ -39,11 +39,21 @@
 #include <errno.h>
 #include <assert.h>
 #include <string.h>
+#include <str.h>
+
+/** Size of the buffer for directory entries read in a batch */
+#define DIR_BUF_SIZE 8192
 
 struct __dirstream {
 	int fd;
 	struct dirent res;
 	aoff64_t pos;
+	/** Entries read in a batch, @c NULL if batches are not supported */
+	uint8_t *buf;
+	/** Number of valid bytes in @c buf */
+	size_t buf_len;
+	/** Offset of the next entry in @c buf */
+	size_t buf_off;
 };
 
 /** Open directory.
@@ -78,6 +88,10 @@ DIR *opendir(const char *dirname)
 
 	dirp->fd = fd;
 	dirp->pos = 0;
+	/* Without a buffer we fall back to reading entries one by one */
+	dirp->buf = malloc(DIR_BUF_SIZE);
+	dirp->buf_len = 0;
+	dirp->buf_off = 0;
 	return dirp;
 }
 
@@ -92,6 +106,45 @@ struct dirent *readdir(DIR *dirp)
 	errno_t rc;
 	ssize_t len = 0;
 
+	if (dirp->buf != NULL) {
+		if (dirp->buf_off >= dirp->buf_len) {
+			size_t nread;
+
+			rc = vfs_readdir(dirp->fd, dirp->pos, 0, dirp->buf,
+			    DIR_BUF_SIZE, &nread);
+			if (rc == ENOTSUP) {
+				/* File system reads one entry at a time */
+				free(dirp->buf);
+				dirp->buf = NULL;
+				goto single;
+			}
+
+			if (rc != EOK) {
+				errno = rc;
+				return NULL;
+			}
+
+			if (nread == 0) {
+				errno = ENOENT;
+				return NULL;
+			}
+
+			dirp->buf_len = nread;
+			dirp->buf_off = 0;
+		}
+
+		vfs_dirent_t *de = (vfs_dirent_t *) (dirp->buf + dirp->buf_off);
+		assert(de->reclen > 0);
+		assert(dirp->buf_off + de->reclen <= dirp->buf_len);
+
+		str_cpy(dirp->res.d_name, sizeof(dirp->res.d_name), de->name);
+		dirp->pos = de->next;
+		dirp->buf_off += de->reclen;
+
+		return &dirp->res;
+	}
+
+single:
 	rc = vfs_read_short(dirp->fd, dirp->pos, dirp->res.d_name,
 	    sizeof(dirp->res.d_name), &len);
 	if (rc != EOK) {
@@ -113,6 +166,8 @@ struct dirent *readdir(DIR *dirp)
 void rewinddir(DIR *dirp)
 {
 	dirp->pos = 0;
+	dirp->buf_len = 0;
+	dirp->buf_off = 0;
 }
 
 /** Close directory.
@@ -123,6 +178,7 @@ void rewinddir(DIR *dirp)
 int closedir(DIR *dirp)
 {
 	errno_t rc = vfs_put(dirp->fd);
+	free(dirp->buf);
 	free(dirp);
 
 	if (rc == EOK) {
@@ -51,10 +51,12 @@
 /** Load ELF program.
  *
  * @param file File handle
+ * @param snap Snapshot of the relocated program or @c NULL,
+ *             see rtld_prog_process()
  * @param info Place to store ELF program information
  * @return EOK on success or an error code
  */
-errno_t elf_load(int file, elf_info_t *info)
+errno_t elf_load(int file, struct rtld_snapshot *snap, elf_info_t *info)
 {
 #ifdef CONFIG_RTLD
 	rtld_t *env;
@@ -78,7 +80,7 @@ errno_t elf_load(int file, elf_info_t *info)
 #ifdef CONFIG_RTLD
 	DPRINTF("- prog dynamic: %p\n", info->finfo.dynamic);
 
-	rc = rtld_prog_process(&info->finfo, &env);
+	rc = rtld_prog_process(&info->finfo, snap, &env);
 	info->env = env;
 #else
 	rc = ENOTSUP;
@@ -146,6 +146,42 @@ errno_t inet_send(inet_dgram_t *dgram, uint8_t ttl, inet_df_t df)
 	return retval;
 }
 
+/** Send a batch of datagrams.
+ *
+ * All datagrams are transferred to the Internet service in a single
+ * IPC exchange.
+ *
+ * @param batch Datagram batch
+ * @param ttl Time to live
+ * @param df Do-not-Fragment flag
+ * @return EOK on success or an error code (of the first datagram
+ *         that failed to be sent)
+ */
+errno_t inet_send_batch(inet_dgbatch_t *batch, uint8_t ttl, inet_df_t df)
+{
+	if (batch->count == 0)
+		return EOK;
+
+	async_exch_t *exch = async_exchange_begin(inet_sess);
+
+	ipc_call_t answer;
+	aid_t req = async_send_2(exch, INET_SEND_BATCH, ttl, df, &answer);
+
+	errno_t rc = async_data_write_start(exch, batch->buf, batch->size);
+
+	async_exchange_end(exch);
+
+	if (rc != EOK) {
+		async_forget(req);
+		return rc;
+	}
+
+	errno_t retval;
+	async_wait_for(req, &retval);
+
+	return retval;
+}
+
 errno_t inet_get_srcaddr(inet_addr_t *remote, uint8_t tos, inet_addr_t *local)
 {
 	async_exch_t *exch = async_exchange_begin(inet_sess);
@@ -233,6 +269,28 @@ static void inet_ev_recv(ipc_call_t *icall)
 	async_answer_0(icall, rc);
 }
 
+static void inet_ev_recv_batch(ipc_call_t *icall)
+{
+	inet_dgram_t dgram;
+	void *buf;
+	size_t size;
+	size_t offs;
+
+	errno_t rc = async_data_write_accept(&buf, false, 0,
+	    INET_DGBATCH_SIZE_MAX, 0, &size);
+	if (rc != EOK) {
+		async_answer_0(icall, rc);
+		return;
+	}
+
+	offs = 0;
+	while ((rc = inet_dgbatch_next(buf, size, &offs, &dgram)) == EOK)
+		(void) inet_ev_ops->recv(&dgram);
+
+	free(buf);
+	async_answer_0(icall, rc == ENOENT ? EOK : rc);
+}
+
 static void inet_cb_conn(ipc_call_t *icall, void *arg)
 {
 	while (true) {
@@ -248,6 +306,9 @@ static void inet_cb_conn(ipc_call_t *icall, void *arg)
 		case INET_EV_RECV:
 			inet_ev_recv(&call);
 			break;
+		case INET_EV_RECV_BATCH:
+			inet_ev_recv_batch(&call);
+			break;
 		default:
 			async_answer_0(&call, ENOTSUP);
 		}
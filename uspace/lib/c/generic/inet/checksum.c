@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libc
+ * @{
+ */
+/** @file Internet checksum.
+ *
+ * One's complement sum as used by IP, ICMP, UDP and TCP (RFC 1071).
+ * The sum is accumulated a machine word at a time in native byte order
+ * and only converted to network order once at the end, which is valid
+ * since the one's complement sum commutes with byte swapping.
+ */
+
+#include <byteorder.h>
+#include <inet/checksum.h>
+#include <mem.h>
+
+/** Add two 16-bit numbers in one's complement arithmetic. */
+static uint16_t inet_ocadd16(uint16_t a, uint16_t b)
+{
+	uint32_t s;
+
+	s = (uint32_t)a + (uint32_t)b;
+	return (s & 0xffff) + (s >> 16);
+}
+
+/** Add two 64-bit numbers in one's complement arithmetic. */
+static inline uint64_t inet_ocadd64(uint64_t a, uint64_t b)
+{
+	uint64_t s;
+
+	s = a + b;
+	return s + (s < b ? 1 : 0);
+}
+
+/** Fold 64-bit one's complement sum to 16 bits. */
+static uint16_t inet_ocfold64(uint64_t sum)
+{
+	sum = (sum & 0xffffffff) + (sum >> 32);
+	sum = (sum & 0xffffffff) + (sum >> 32);
+	sum = (sum & 0xffff) + (sum >> 16);
+	sum = (sum & 0xffff) + (sum >> 16);
+	return (uint16_t) sum;
+}
+
+/** Compute Internet checksum.
+ *
+ * The result of a previous call can be passed as @a ivalue to continue
+ * the computation with more data. All but the last chunk of data must
+ * have an even size.
+ *
+ * @param ivalue Initial value (@c INET_CHECKSUM_INIT or result of a previous
+ *               computation)
+ * @param data Data
+ * @param size Size of data in bytes
+ * @return Checksum in host byte order
+ */
+uint16_t inet_checksum_calc(uint16_t ivalue, const void *data, size_t size)
+{
+	const uint8_t *bdata = (const uint8_t *) data;
+	uint64_t sum = 0;
+	uint64_t w0, w1, w2, w3;
+
+	/* Main loop processes 32 bytes per iteration */
+	while (size >= 4 * sizeof(uint64_t)) {
+		memcpy(&w0, bdata, sizeof(uint64_t));
+		memcpy(&w1, bdata + 8, sizeof(uint64_t));
+		memcpy(&w2, bdata + 16, sizeof(uint64_t));
+		memcpy(&w3, bdata + 24, sizeof(uint64_t));
+
+		sum = inet_ocadd64(sum, w0);
+		sum = inet_ocadd64(sum, w1);
+		sum = inet_ocadd64(sum, w2);
+		sum = inet_ocadd64(sum, w3);
+
+		bdata += 4 * sizeof(uint64_t);
+		size -= 4 * sizeof(uint64_t);
+	}
+
+	while (size >= sizeof(uint64_t)) {
+		memcpy(&w0, bdata, sizeof(uint64_t));
+		sum = inet_ocadd64(sum, w0);
+
+		bdata += sizeof(uint64_t);
+		size -= sizeof(uint64_t);
+	}
+
+	/*
+	 * Tail. The offset of the tail is a multiple of eight so each byte
+	 * keeps its position within a 16-bit word (a trailing odd byte is
+	 * padded with zero).
+	 */
+	if (size > 0) {
+		w0 = 0;
+		memcpy(&w0, bdata, size);
+		sum = inet_ocadd64(sum, w0);
+	}
+
+	return ~inet_ocadd16(~ivalue, uint16_t_be2host(inet_ocfold64(sum)));
+}
+
+/** Update Internet checksum after changing a 16-bit field.
+ *
+ * Uses the incremental update of RFC 1624 so that the checksum does not
+ * have to be recomputed over the whole data.
+ *
+ * @param csum Original checksum in host byte order
+ * @param oval Original value of the field in host byte order
+ * @param nval New value of the field in host byte order
+ * @return Updated checksum in host byte order
+ */
+uint16_t inet_checksum_update16(uint16_t csum, uint16_t oval, uint16_t nval)
+{
+	return ~inet_ocadd16(inet_ocadd16(~csum, ~oval), nval);
+}
+
+/** Update Internet checksum after changing a 32-bit field.
+ *
+ * The field must be aligned on a 16-bit boundary relative to the start
+ * of the checksummed data.
+ *
+ * @param csum Original checksum in host byte order
+ * @param oval Original value of the field in host byte order
+ * @param nval New value of the field in host byte order
+ * @return Updated checksum in host byte order
+ */
+uint16_t inet_checksum_update32(uint16_t csum, uint32_t oval, uint32_t nval)
+{
+	csum = inet_checksum_update16(csum, oval >> 16, nval >> 16);
+	return inet_checksum_update16(csum, oval & 0xffff, nval & 0xffff);
+}
+
+/** @}
+ */
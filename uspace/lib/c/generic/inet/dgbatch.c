@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libc
+ * @{
+ */
+/** @file Internet datagram batch
+ *
+ * Each datagram is encoded as a fixed-size header followed by
+ * the datagram data, padded so that the next header is aligned.
+ */
+
+#include <align.h>
+#include <inet/dgbatch.h>
+#include <macros.h>
+#include <mem.h>
+#include <stdlib.h>
+
+/** Encoded datagram header */
+typedef struct {
+	/** Local IP link service ID */
+	service_id_t iplink;
+	/** Source address */
+	inet_addr_t src;
+	/** Destination address */
+	inet_addr_t dest;
+	/** Type of service */
+	uint8_t tos;
+	/** Size of datagram data following the header */
+	size_t size;
+} inet_dgbatch_hdr_t;
+
+/** Alignment of encoded datagram headers */
+#define DGBATCH_ALIGN (sizeof(sysarg_t))
+
+/** Size of encoded datagram.
+ *
+ * @param size Size of datagram data
+ * @return Number of bytes the datagram occupies in a batch
+ */
+static size_t inet_dgbatch_rec_size(size_t size)
+{
+	return ALIGN_UP(sizeof(inet_dgbatch_hdr_t) + size, DGBATCH_ALIGN);
+}
+
+/** Initialize empty datagram batch.
+ *
+ * @param batch Datagram batch
+ */
+void inet_dgbatch_init(inet_dgbatch_t *batch)
+{
+	memset(batch, 0, sizeof(inet_dgbatch_t));
+}
+
+/** Finalize datagram batch.
+ *
+ * @param batch Datagram batch
+ */
+void inet_dgbatch_fini(inet_dgbatch_t *batch)
+{
+	free(batch->buf);
+	batch->buf = NULL;
+	batch->bsize = 0;
+	inet_dgbatch_clear(batch);
+}
+
+/** Remove all datagrams from batch.
+ *
+ * The buffer is kept for reuse.
+ *
+ * @param batch Datagram batch
+ */
+void inet_dgbatch_clear(inet_dgbatch_t *batch)
+{
+	batch->size = 0;
+	batch->count = 0;
+}
+
+/** Determine if datagram would fit into batch.
+ *
+ * @param batch Datagram batch
+ * @param size Size of datagram data
+ * @return @c true if datagram can be added without exceeding batch limits
+ */
+bool inet_dgbatch_fits(inet_dgbatch_t *batch, size_t size)
+{
+	if (batch->count == 0)
+		return true;
+
+	if (batch->count >= INET_DGBATCH_COUNT_MAX)
+		return false;
+
+	return batch->size + inet_dgbatch_rec_size(size) <=
+	    INET_DGBATCH_SIZE_MAX;
+}
+
+/** Append datagram to batch.
+ *
+ * The datagram data are copied into the batch.
+ *
+ * @param batch Datagram batch
+ * @param dgram Datagram
+ * @return EOK on success, ELIMIT if batch is full, ENOMEM if out of memory
+ */
+errno_t inet_dgbatch_add(inet_dgbatch_t *batch, inet_dgram_t *dgram)
+{
+	inet_dgbatch_hdr_t hdr;
+	size_t rsize;
+	size_t nbsize;
+	void *nbuf;
+
+	if (!inet_dgbatch_fits(batch, dgram->size))
+		return ELIMIT;
+
+	rsize = inet_dgbatch_rec_size(dgram->size);
+	if (batch->size + rsize > batch->bsize) {
+		nbsize = max(batch->size + rsize, 2 * batch->bsize);
+		nbsize = max(nbsize, min(INET_DGBATCH_SIZE_MAX, 4 * rsize));
+		nbuf = realloc(batch->buf, nbsize);
+		if (nbuf == NULL)
+			return ENOMEM;
+
+		batch->buf = nbuf;
+		batch->bsize = nbsize;
+	}
+
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.iplink = dgram->iplink;
+	hdr.src = dgram->src;
+	hdr.dest = dgram->dest;
+	hdr.tos = dgram->tos;
+	hdr.size = dgram->size;
+
+	memcpy((uint8_t *) batch->buf + batch->size, &hdr, sizeof(hdr));
+	memcpy((uint8_t *) batch->buf + batch->size + sizeof(hdr), dgram->data,
+	    dgram->size);
+	batch->size += rsize;
+	++batch->count;
+
+	return EOK;
+}
+
+/** Decode next datagram from encoded batch.
+ *
+ * The decoded datagram data points into @a buf, they are not copied.
+ *
+ * @param buf Encoded batch
+ * @param size Size of encoded batch in bytes
+ * @param offs Offset of next datagram, updated on success
+ * @param dgram Place to store decoded datagram
+ * @return EOK on success, ENOENT if there are no more datagrams,
+ *         EINVAL if the batch is malformed
+ */
+errno_t inet_dgbatch_next(void *buf, size_t size, size_t *offs,
+    inet_dgram_t *dgram)
+{
+	inet_dgbatch_hdr_t hdr;
+
+	if (*offs >= size)
+		return ENOENT;
+
+	if (size - *offs < sizeof(hdr))
+		return EINVAL;
+
+	memcpy(&hdr, (uint8_t *) buf + *offs, sizeof(hdr));
+	if (hdr.size > size - *offs - sizeof(hdr))
+		return EINVAL;
+
+	dgram->iplink = hdr.iplink;
+	dgram->src = hdr.src;
+	dgram->dest = hdr.dest;
+	dgram->tos = hdr.tos;
+	dgram->data = (uint8_t *) buf + *offs + sizeof(hdr);
+	dgram->size = hdr.size;
+
+	*offs = min(size, *offs + inet_dgbatch_rec_size(hdr.size));
+	return EOK;
+}
+
+/** @}
+ */
@@ -0,0 +1,443 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libc
+ * @{
+ */
+/** @file Longest prefix match table
+ *
+ * Each trie node holds a prefix. A node only exists if it carries a value
+ * or if it is a branching point with two children, so the depth of the
+ * trie is bounded by the number of stored prefixes rather than by the
+ * address width. Keys are stored as big-endian byte strings, IPv4
+ * addresses using the first four bytes.
+ */
+
+#include <inet/lpm.h>
+#include <macros.h>
+#include <mem.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/** Trie node */
+struct inet_lpm_node {
+	/** Prefix, bits beyond @c len are zero */
+	addr128_t key;
+	/** Prefix length in bits */
+	uint8_t len;
+	/** @c true if the node carries a value */
+	bool has_value;
+	/** Value associated with the prefix */
+	void *value;
+	/** Children, indexed by the bit following the prefix */
+	inet_lpm_node_t *child[2];
+};
+
+/** Get bit of a key.
+ *
+ * @param key Key
+ * @param bit Bit index, 0 is the most significant bit
+ * @return Value of the bit
+ */
+static unsigned inet_lpm_bit(const addr128_t key, unsigned bit)
+{
+	return (key[bit / 8] >> (7 - bit % 8)) & 1;
+}
+
+/** Determine length of common prefix of two keys.
+ *
+ * @param a First key
+ * @param b Second key
+ * @param max Maximum number of bits to compare
+ * @return Number of leading bits that are equal, at most @a max
+ */
+static unsigned inet_lpm_common(const addr128_t a, const addr128_t b,
+    unsigned max)
+{
+	unsigned i;
+
+	for (i = 0; i < max; i += 8) {
+		uint8_t diff = a[i / 8] ^ b[i / 8];
+		if (diff != 0) {
+			while ((diff & 0x80) == 0) {
+				diff <<= 1;
+				i++;
+			}
+
+			return i < max ? i : max;
+		}
+	}
+
+	return max;
+}
+
+/** Convert network address to trie key.
+ *
+ * @param lpm Table
+ * @param naddr Network address
+ * @param key Place to store key, bits beyond prefix are cleared
+ * @param len Place to store prefix length
+ * @return Root pointer of the matching trie or @c NULL if the
+ *         address family is not supported or the prefix is invalid
+ */
+static inet_lpm_node_t **inet_lpm_key(inet_lpm_t *lpm,
+    const inet_naddr_t *naddr, addr128_t key, unsigned *len)
+{
+	unsigned width;
+	inet_lpm_node_t **root;
+
+	memset(key, 0, sizeof(addr128_t));
+
+	switch (naddr->version) {
+	case ip_v4:
+		key[0] = naddr->addr >> 24;
+		key[1] = naddr->addr >> 16;
+		key[2] = naddr->addr >> 8;
+		key[3] = naddr->addr;
+		width = 32;
+		root = &lpm->root4;
+		break;
+	case ip_v6:
+		memcpy(key, naddr->addr6, sizeof(addr128_t));
+		width = 128;
+		root = &lpm->root6;
+		break;
+	default:
+		return NULL;
+	}
+
+	if (naddr->prefix > width)
+		return NULL;
+
+	*len = naddr->prefix;
+	for (unsigned i = *len; i < width; i++)
+		key[i / 8] &= ~(0x80 >> (i % 8));
+
+	return root;
+}
+
+/** Create trie node.
+ *
+ * @param key Key
+ * @param len Prefix length
+ * @return New node or @c NULL if out of memory
+ */
+static inet_lpm_node_t *inet_lpm_node_create(const addr128_t key,
+    unsigned len)
+{
+	inet_lpm_node_t *node;
+
+	node = calloc(1, sizeof(inet_lpm_node_t));
+	if (node == NULL)
+		return NULL;
+
+	memcpy(node->key, key, sizeof(addr128_t));
+	for (unsigned i = len; i < 128; i++)
+		node->key[i / 8] &= ~(0x80 >> (i % 8));
+	node->len = len;
+	return node;
+}
+
+/** Destroy trie node and all its descendants.
+ *
+ * @param node Node or @c NULL
+ */
+static void inet_lpm_node_destroy(inet_lpm_node_t *node)
+{
+	if (node == NULL)
+		return;
+
+	inet_lpm_node_destroy(node->child[0]);
+	inet_lpm_node_destroy(node->child[1]);
+	free(node);
+}
+
+/** Initialize empty longest prefix match table.
+ *
+ * @param lpm Table
+ */
+void inet_lpm_init(inet_lpm_t *lpm)
+{
+	lpm->root4 = NULL;
+	lpm->root6 = NULL;
+	lpm->count = 0;
+}
+
+/** Finalize longest prefix match table.
+ *
+ * The stored values are not touched.
+ *
+ * @param lpm Table
+ */
+void inet_lpm_fini(inet_lpm_t *lpm)
+{
+	inet_lpm_node_destroy(lpm->root4);
+	inet_lpm_node_destroy(lpm->root6);
+	inet_lpm_init(lpm);
+}
+
+/** Insert prefix into table.
+ *
+ * @param lpm Table
+ * @param naddr Network prefix
+ * @param value Value to associate with the prefix
+ * @return EOK on success, EEXIST if the prefix is already present,
+ *         EINVAL if the prefix is not valid, ENOMEM if out of memory
+ */
+errno_t inet_lpm_insert(inet_lpm_t *lpm, const inet_naddr_t *naddr,
+    void *value)
+{
+	inet_lpm_node_t **link;
+	inet_lpm_node_t *node;
+	inet_lpm_node_t *nnode;
+	inet_lpm_node_t *inner;
+	addr128_t key;
+	unsigned len;
+	unsigned common;
+
+	link = inet_lpm_key(lpm, naddr, key, &len);
+	if (link == NULL)
+		return EINVAL;
+
+	while (*link != NULL) {
+		node = *link;
+		common = inet_lpm_common(node->key, key, min(node->len, len));
+
+		if (common == node->len) {
+			if (node->len == len) {
+				/* Exact match */
+				if (node->has_value)
+					return EEXIST;
+
+				node->has_value = true;
+				node->value = value;
+				lpm->count++;
+				return EOK;
+			}
+
+			/* Node prefix covers the new prefix, descend */
+			link = &node->child[inet_lpm_bit(key, node->len)];
+			continue;
+		}
+
+		nnode = inet_lpm_node_create(key, len);
+		if (nnode == NULL)
+			return ENOMEM;
+
+		nnode->has_value = true;
+		nnode->value = value;
+
+		if (common == len) {
+			/* New prefix covers the node, insert above it */
+			nnode->child[inet_lpm_bit(node->key, len)] = node;
+			*link = nnode;
+			lpm->count++;
+			return EOK;
+		}
+
+		/* Prefixes diverge, insert branching node */
+		inner = inet_lpm_node_create(key, common);
+		if (inner == NULL) {
+			free(nnode);
+			return ENOMEM;
+		}
+
+		inner->child[inet_lpm_bit(key, common)] = nnode;
+		inner->child[inet_lpm_bit(node->key, common)] = node;
+		*link = inner;
+		lpm->count++;
+		return EOK;
+	}
+
+	nnode = inet_lpm_node_create(key, len);
+	if (nnode == NULL)
+		return ENOMEM;
+
+	nnode->has_value = true;
+	nnode->value = value;
+	*link = nnode;
+	lpm->count++;
+	return EOK;
+}
+
+/** Remove prefix from table.
+ *
+ * @param lpm Table
+ * @param naddr Network prefix
+ * @return EOK on success, ENOENT if the prefix is not present
+ */
+errno_t inet_lpm_remove(inet_lpm_t *lpm, const inet_naddr_t *naddr)
+{
+	inet_lpm_node_t **link;
+	inet_lpm_node_t **plink = NULL;
+	inet_lpm_node_t *node;
+	inet_lpm_node_t *parent;
+	addr128_t key;
+	unsigned len;
+
+	link = inet_lpm_key(lpm, naddr, key, &len);
+	if (link == NULL)
+		return ENOENT;
+
+	while (*link != NULL) {
+		node = *link;
+		if (node->len > len ||
+		    inet_lpm_common(node->key, key, node->len) != node->len)
+			return ENOENT;
+
+		if (node->len == len)
+			break;
+
+		plink = link;
+		link = &node->child[inet_lpm_bit(key, node->len)];
+	}
+
+	node = *link;
+	if (node == NULL || !node->has_value)
+		return ENOENT;
+
+	node->has_value = false;
+	node->value = NULL;
+	lpm->count--;
+
+	if (node->child[0] != NULL && node->child[1] != NULL) {
+		/* Still a branching point */
+		return EOK;
+	}
+
+	if (node->child[0] != NULL || node->child[1] != NULL) {
+		/* Splice out node with a single child */
+		*link = node->child[0] != NULL ? node->child[0] :
+		    node->child[1];
+		free(node);
+		return EOK;
+	}
+
+	/* Leaf node */
+	*link = NULL;
+	free(node);
+
+	/* Parent may have become a branching point with a single child */
+	if (plink != NULL) {
+		parent = *plink;
+		if (!parent->has_value) {
+			*plink = parent->child[0] != NULL ? parent->child[0] :
+			    parent->child[1];
+			free(parent);
+		}
+	}
+
+	return EOK;
+}
+
+/** Find value associated with exactly the given prefix.
+ *
+ * @param lpm Table
+ * @param naddr Network prefix
+ * @return Value or @c NULL if the prefix is not present
+ */
+void *inet_lpm_find(inet_lpm_t *lpm, const inet_naddr_t *naddr)
+{
+	inet_lpm_node_t **link;
+	inet_lpm_node_t *node;
+	addr128_t key;
+	unsigned len;
+
+	link = inet_lpm_key(lpm, naddr, key, &len);
+	if (link == NULL)
+		return NULL;
+
+	node = *link;
+	while (node != NULL) {
+		if (node->len > len ||
+		    inet_lpm_common(node->key, key, node->len) != node->len)
+			return NULL;
+
+		if (node->len == len)
+			return node->has_value ? node->value : NULL;
+
+		node = node->child[inet_lpm_bit(key, node->len)];
+	}
+
+	return NULL;
+}
+
+/** Look up longest prefix matching an address.
+ *
+ * @param lpm Table
+ * @param addr Address
+ * @return Value associated with the most specific matching prefix
+ *         or @c NULL if no prefix matches
+ */
+void *inet_lpm_lookup(inet_lpm_t *lpm, const inet_addr_t *addr)
+{
+	inet_naddr_t naddr;
+	inet_lpm_node_t **link;
+	inet_lpm_node_t *node;
+	addr128_t key;
+	unsigned len;
+	void *best = NULL;
+
+	naddr.version = addr->version;
+	switch (addr->version) {
+	case ip_v4:
+		naddr.addr = addr->addr;
+		naddr.prefix = 32;
+		break;
+	case ip_v6:
+		memcpy(naddr.addr6, addr->addr6, sizeof(addr128_t));
+		naddr.prefix = 128;
+		break;
+	default:
+		return NULL;
+	}
+
+	link = inet_lpm_key(lpm, &naddr, key, &len);
+	if (link == NULL)
+		return NULL;
+
+	node = *link;
+	while (node != NULL) {
+		if (inet_lpm_common(node->key, key, node->len) != node->len)
+			break;
+
+		if (node->has_value)
+			best = node->value;
+
+		if (node->len == len)
+			break;
+
+		node = node->child[inet_lpm_bit(key, node->len)];
+	}
+
+	return best;
+}
+
+/** @}
+ */
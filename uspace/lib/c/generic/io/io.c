@@ -76,6 +76,12 @@ static __stream_ops_t stdio_vfs_ops = {
 	.flush = stdio_vfs_flush
 };
 
+/**
+ * Buffer size for streams backed by files. A buffer fill should amortize
+ * the cost of a request to VFS, so use the largest single transfer.
+ */
+#define STDIO_FILE_BUFSIZ  DATA_XFER_LIMIT
+
 static FILE stdin_null = {
 	.fd = -1,
 	.pos = 0,
@@ -296,6 +302,7 @@ void setbuf(FILE *stream, void *buf)
 static void _setvbuf(FILE *stream)
 {
 	/* FIXME: Use more complex rules for setting buffering options. */
+	vfs_stat_t st;
 
 	switch (stream->fd) {
 	case 1:
@@ -306,7 +313,12 @@ static void _setvbuf(FILE *stream)
 		setvbuf(stream, NULL, _IONBF, 0);
 		break;
 	default:
-		setvbuf(stream, NULL, _IOFBF, BUFSIZ);
+		/* Devices and other stream nodes keep the default buffer */
+		if (vfs_stat(stream->fd, &st) == EOK && st.is_file &&
+		    st.service == 0)
+			setvbuf(stream, NULL, _IOFBF, STDIO_FILE_BUFSIZ);
+		else
+			setvbuf(stream, NULL, _IOFBF, BUFSIZ);
 	}
 }
 
@@ -623,6 +635,21 @@ size_t fread(void *dest, size_t size, size_t nmemb, FILE *stream)
 	}
 
 	while ((!stream->error) && (!stream->eof) && (bytes_left > 0)) {
+		if (stream->buf_head == stream->buf_tail &&
+		    stream->ops == &stdio_vfs_ops &&
+		    bytes_left >= stream->buf_size) {
+			/*
+			 * Sequential read larger than the buffer, read directly
+			 * into the destination. vfs_read() keeps several requests
+			 * in flight for large transfers.
+			 */
+			now = _fread(dp, 1, bytes_left, stream);
+			dp += now;
+			bytes_left -= now;
+			total_read += now;
+			continue;
+		}
+
 		if (stream->buf_head == stream->buf_tail)
 			_ffillbuf(stream);
 
@@ -42,6 +42,7 @@
 #include <ipc/iplink.h>
 #include <ipc/services.h>
 #include <loc.h>
+#include <mem.h>
 #include <stdlib.h>
 
 static void iplink_cb_conn(ipc_call_t *icall, void *arg);
@@ -107,6 +108,75 @@ errno_t iplink_send(iplink_t *iplink, iplink_sdu_t *sdu)
 	return retval;
 }
 
+/** Send several SDUs in a single IPC exchange.
+ *
+ * @param iplink IP link
+ * @param sdu Array of SDUs
+ * @param count Number of SDUs, at most @c IPLINK_SEND_BATCH_MAX
+ * @return EOK on success or an error code
+ */
+errno_t iplink_send_batch(iplink_t *iplink, iplink_sdu_t *sdu, size_t count)
+{
+	iplink_sdu_desc_t desc[IPLINK_SEND_BATCH_MAX];
+	size_t total;
+	size_t offs;
+	size_t i;
+	void *data;
+
+	if (count > IPLINK_SEND_BATCH_MAX)
+		return EINVAL;
+
+	if (count == 1)
+		return iplink_send(iplink, &sdu[0]);
+
+	total = 0;
+	for (i = 0; i < count; i++) {
+		desc[i].src = sdu[i].src;
+		desc[i].dest = sdu[i].dest;
+		desc[i].size = sdu[i].size;
+		total += sdu[i].size;
+	}
+
+	data = malloc(total);
+	if (data == NULL)
+		return ENOMEM;
+
+	offs = 0;
+	for (i = 0; i < count; i++) {
+		memcpy((uint8_t *) data + offs, sdu[i].data, sdu[i].size);
+		offs += sdu[i].size;
+	}
+
+	async_exch_t *exch = async_exchange_begin(iplink->sess);
+
+	ipc_call_t answer;
+	aid_t req = async_send_1(exch, IPLINK_SEND_BATCH, count, &answer);
+
+	errno_t rc = async_data_write_start(exch, desc,
+	    count * sizeof(iplink_sdu_desc_t));
+	if (rc != EOK) {
+		async_exchange_end(exch);
+		async_forget(req);
+		free(data);
+		return rc;
+	}
+
+	rc = async_data_write_start(exch, data, total);
+
+	async_exchange_end(exch);
+	free(data);
+
+	if (rc != EOK) {
+		async_forget(req);
+		return rc;
+	}
+
+	errno_t retval;
+	async_wait_for(req, &retval);
+
+	return retval;
+}
+
 errno_t iplink_send6(iplink_t *iplink, iplink_sdu6_t *sdu)
 {
 	async_exch_t *exch = async_exchange_begin(iplink->sess);
@@ -152,6 +222,29 @@ errno_t iplink_get_mtu(iplink_t *iplink, size_t *rmtu)
 	return EOK;
 }
 
+/** Get offload computations performed by IP link.
+ *
+ * @param iplink   IP link
+ * @param roffload Place to store the offloads (IPLINK_OFFLOAD_* flags)
+ *
+ * @return EOK on success or an error code
+ */
+errno_t iplink_get_offload(iplink_t *iplink, uint32_t *roffload)
+{
+	async_exch_t *exch = async_exchange_begin(iplink->sess);
+
+	sysarg_t offload;
+	errno_t rc = async_req_0_1(exch, IPLINK_GET_OFFLOAD, &offload);
+
+	async_exchange_end(exch);
+
+	if (rc != EOK)
+		return rc;
+
+	*roffload = offload;
+	return EOK;
+}
+
 errno_t iplink_get_mac48(iplink_t *iplink, addr48_t *mac)
 {
 	async_exch_t *exch = async_exchange_begin(iplink->sess);
@@ -38,6 +38,7 @@
 #include <ipc/iplink.h>
 #include <stdlib.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <inet/addr.h>
 #include <inet/iplink_srv.h>
 
@@ -48,6 +49,18 @@ static void iplink_get_mtu_srv(iplink_srv_t *srv, ipc_call_t *call)
 	async_answer_1(call, rc, mtu);
 }
 
+static void iplink_get_offload_srv(iplink_srv_t *srv, ipc_call_t *call)
+{
+	uint32_t offload = 0;
+	errno_t rc = EOK;
+
+	/* Links without the operation do not offload anything */
+	if (srv->ops->get_offload != NULL)
+		rc = srv->ops->get_offload(srv, &offload);
+
+	async_answer_1(call, rc, offload);
+}
+
 static void iplink_get_mac48_srv(iplink_srv_t *srv, ipc_call_t *icall)
 {
 	addr48_t mac;
@@ -176,6 +189,71 @@ static void iplink_send_srv(iplink_srv_t *srv, ipc_call_t *icall)
 	async_answer_0(icall, rc);
 }
 
+static void iplink_send_batch_srv(iplink_srv_t *srv, ipc_call_t *icall)
+{
+	iplink_sdu_desc_t *desc;
+	iplink_sdu_t sdu;
+	void *data;
+	size_t count;
+	size_t size;
+	size_t total;
+	size_t offs;
+	size_t i;
+	errno_t rc;
+	errno_t retval;
+
+	count = ipc_get_arg1(icall);
+	if (count == 0 || count > IPLINK_SEND_BATCH_MAX) {
+		async_answer_0(icall, EINVAL);
+		return;
+	}
+
+	rc = async_data_write_accept((void **) &desc, false,
+	    count * sizeof(iplink_sdu_desc_t),
+	    count * sizeof(iplink_sdu_desc_t), 0, &size);
+	if (rc != EOK) {
+		async_answer_0(icall, rc);
+		return;
+	}
+
+	total = 0;
+	for (i = 0; i < count; i++) {
+		if (desc[i].size > SIZE_MAX - total) {
+			free(desc);
+			async_answer_0(icall, EINVAL);
+			return;
+		}
+
+		total += desc[i].size;
+	}
+
+	rc = async_data_write_accept(&data, false, total, total, 0, &size);
+	if (rc != EOK) {
+		free(desc);
+		async_answer_0(icall, rc);
+		return;
+	}
+
+	/* Send all SDUs, report the first failure */
+	retval = EOK;
+	offs = 0;
+	for (i = 0; i < count; i++) {
+		sdu.src = desc[i].src;
+		sdu.dest = desc[i].dest;
+		sdu.data = (uint8_t *) data + offs;
+		sdu.size = desc[i].size;
+		offs += desc[i].size;
+
+		rc = srv->ops->send(srv, &sdu);
+		if (rc != EOK && retval == EOK)
+			retval = rc;
+	}
+
+	free(data);
+	free(desc);
+	async_answer_0(icall, retval);
+}
+
 static void iplink_send6_srv(iplink_srv_t *srv, ipc_call_t *icall)
 {
 	iplink_sdu6_t sdu;
@@ -279,12 +357,18 @@ errno_t iplink_conn(ipc_call_t *icall, void *arg)
 		case IPLINK_SEND6:
 			iplink_send6_srv(srv, &call);
 			break;
+		case IPLINK_SEND_BATCH:
+			iplink_send_batch_srv(srv, &call);
+			break;
 		case IPLINK_ADDR_ADD:
 			iplink_addr_add_srv(srv, &call);
 			break;
 		case IPLINK_ADDR_REMOVE:
 			iplink_addr_remove_srv(srv, &call);
 			break;
+		case IPLINK_GET_OFFLOAD:
+			iplink_get_offload_srv(srv, &call);
+			break;
 		default:
 			async_answer_0(&call, EINVAL);
 		}
@@ -37,7 +37,9 @@
 #include <stdlib.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <libarch/config.h>
 #include "private/cc.h"
+#include "private/word.h"
 
 /** Fill memory block with a constant value. */
 ATTRIBUTE_OPTIMIZE_NO_TLDP
@@ -193,7 +195,8 @@ ATTRIBUTE_OPTIMIZE_NO_TLDP
 }
 
 /** Move memory block with possible overlapping. */
-void *memmove(void *dst, const void *src, size_t n)
+ATTRIBUTE_OPTIMIZE_NO_TLDP
+    void *memmove(void *dst, const void *src, size_t n)
 {
 	const uint8_t *sp;
 	uint8_t *dp;
@@ -213,20 +216,50 @@ void *memmove(void *dst, const void *src, size_t n)
 		sp = src;
 		dp = dst;
 
+		if (word_congruent(sp, dp)) {
+			while (n != 0 && !word_aligned(dp)) {
+				*dp++ = *sp++;
+				n--;
+			}
+
+			while (n >= WORD_SIZE) {
+				*(word_t *) dp = *(const word_t *) sp;
+				dp += WORD_SIZE;
+				sp += WORD_SIZE;
+				n -= WORD_SIZE;
+			}
+		}
+
 		while (n-- != 0)
 			*dp++ = *sp++;
 	} else {
 		/* Backwards. */
-		sp = src + (n - 1);
-		dp = dst + (n - 1);
+		sp = src + n;
+		dp = dst + n;
+
+		if (word_congruent(sp, dp)) {
+			while (n != 0 && !word_aligned(dp)) {
+				*--dp = *--sp;
+				n--;
+			}
+
+			while (n >= WORD_SIZE) {
+				dp -= WORD_SIZE;
+				sp -= WORD_SIZE;
+				*(word_t *) dp = *(const word_t *) sp;
+				n -= WORD_SIZE;
+			}
+		}
 
 		while (n-- != 0)
-			*dp-- = *sp--;
+			*--dp = *--sp;
 	}
 
 	return dst;
 }
 
+#ifndef LIBARCH_MEMCMP
+
 /** Compare two memory areas.
  *
  * @param s1  Pointer to the first area to compare.
@@ -240,11 +273,28 @@ void *memmove(void *dst, const void *src, size_t n)
  */
 int memcmp(const void *s1, const void *s2, size_t len)
 {
-	uint8_t *u1 = (uint8_t *) s1;
-	uint8_t *u2 = (uint8_t *) s2;
-	size_t i;
+	const uint8_t *u1 = s1;
+	const uint8_t *u2 = s2;
+
+	/* Skip equal words, the differing byte is found below. */
+	if (word_congruent(u1, u2)) {
+		while (len != 0 && !word_aligned(u1)) {
+			if (*u1 != *u2)
+				return (int)(*u1) - (int)(*u2);
+			++u1;
+			++u2;
+			--len;
+		}
+
+		while (len >= WORD_SIZE &&
+		    *(const word_t *) u1 == *(const word_t *) u2) {
+			u1 += WORD_SIZE;
+			u2 += WORD_SIZE;
+			len -= WORD_SIZE;
+		}
+	}
 
-	for (i = 0; i < len; i++) {
+	while (len-- != 0) {
 		if (*u1 != *u2)
 			return (int)(*u1) - (int)(*u2);
 		++u1;
@@ -254,6 +304,10 @@ int memcmp(const void *s1, const void *s2, size_t len)
 	return 0;
 }
 
+#endif
+
+#ifndef LIBARCH_MEMCHR
+
 /** Search memory area.
  *
  * @param s Memory area
@@ -265,17 +319,33 @@ int memcmp(const void *s1, const void *s2, size_t len)
  */
 void *memchr(const void *s, int c, size_t n)
 {
-	uint8_t *u = (uint8_t *) s;
-	unsigned char uc = (unsigned char) c;
-	size_t i;
+	const uint8_t *u = s;
+	uint8_t uc = (uint8_t) c;
+
+	while (n != 0 && !word_aligned(u)) {
+		if (*u == uc)
+			return (void *) u;
+		++u;
+		--n;
+	}
 
-	for (i = 0; i < n; i++) {
-		if (u[i] == uc)
-			return (void *) &u[i];
+	/* Skip words which do not contain the byte. */
+	word_t pattern = word_repeat(uc);
+	while (n >= WORD_SIZE && !word_has_zero(*(const word_t *) u ^ pattern)) {
+		u += WORD_SIZE;
+		n -= WORD_SIZE;
+	}
+
+	while (n-- != 0) {
+		if (*u == uc)
+			return (void *) u;
+		++u;
 	}
 
 	return NULL;
 }
 
+#endif
+
 /** @}
  */
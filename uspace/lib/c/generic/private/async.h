@@ -68,8 +68,20 @@ struct async_sess {
 	/** Exchange mutex */
 	fibril_mutex_t mutex;
 
-	/** Number of opened exchanges */
-	int exchanges;
+	/** Inactive exchange reused without locking (not for parallel sessions) */
+	async_exch_t *idle_exch;
+
+	/** Number of parallel exchanges in use (protected by the shard mutex) */
+	size_t exch_active;
+
+	/** Limit of parallel exchanges, zero for no limit */
+	size_t exch_limit;
+
+	/** Condition variable to wait for exch_active to drop below the limit */
+	fibril_condvar_t exch_cv;
+
+	/** Exchange statistics */
+	async_sess_stats_t stats;
 
 	/** Mutex for stateful connections */
 	fibril_mutex_t remote_state_mtx;
@@ -101,10 +113,12 @@ extern void __async_ports_init(void);
 extern void __async_ports_fini(void);
 
 extern errno_t async_create_port_internal(iface_t, async_port_handler_t,
-    void *, port_id_t *);
-extern async_port_handler_t async_get_port_handler(iface_t, port_id_t, void **);
+    void *, async_pool_t *, port_id_t *);
+extern async_port_handler_t async_get_port_handler(iface_t, port_id_t, void **,
+    async_pool_t **);
 
 extern void async_reply_received(ipc_call_t *);
+extern void async_sess_init(async_sess_t *);
 
 #endif
 
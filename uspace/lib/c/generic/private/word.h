@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libc
+ * @{
+ */
+/** @file
+ * Helpers for processing memory a machine word at a time.
+ *
+ * Words are only ever read from aligned addresses, so a word read never
+ * crosses a page boundary even if it extends past the end of the data.
+ */
+
+#ifndef _LIBC_PRIVATE_WORD_H_
+#define _LIBC_PRIVATE_WORD_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Machine word which may alias any other type */
+typedef unsigned long __attribute__((may_alias)) word_t;
+
+#define WORD_SIZE  sizeof(word_t)
+
+/** Word with all bytes set to 0x01 */
+#define WORD_ONES  ((word_t) -1 / 0xff)
+
+/** Word with all bytes set to 0x80 */
+#define WORD_HIGHS  (WORD_ONES << 7)
+
+/** Return true iff @a p is aligned to word size. */
+static inline bool word_aligned(const void *p)
+{
+	return ((uintptr_t) p & (WORD_SIZE - 1)) == 0;
+}
+
+/** Return true iff @a p and @a q have the same alignment within a word. */
+static inline bool word_congruent(const void *p, const void *q)
+{
+	return (((uintptr_t) p ^ (uintptr_t) q) & (WORD_SIZE - 1)) == 0;
+}
+
+/** Return word with all bytes set to @a b. */
+static inline word_t word_repeat(uint8_t b)
+{
+	return WORD_ONES * b;
+}
+
+/** Return true iff any byte of @a w is zero. */
+static inline bool word_has_zero(word_t w)
+{
+	return ((w - WORD_ONES) & ~w & WORD_HIGHS) != 0;
+}
+
+/** Return true iff all bytes of @a w are 7-bit ASCII characters. */
+static inline bool word_is_ascii(word_t w)
+{
+	return (w & WORD_HIGHS) == 0;
+}
+
+#endif
+
+/** @}
+ */
@@ -43,11 +43,14 @@
 #include <stdlib.h>
 #include <str.h>
 #include <macros.h>
+#include <vfs/vfs.h>
 
 #include <rtld/rtld.h>
 #include <rtld/rtld_debug.h>
 #include <rtld/dynamic.h>
 #include <rtld/rtld_arch.h>
+#include <rtld/snapshot.h>
+#include <rtld/symbol.h>
 #include <rtld/module.h>
 #include <libarch/rtld/module.h>
 
@@ -99,9 +102,11 @@ errno_t module_create_static_exec(rtld_t *rtld, module_t **rmodule)
 	return EOK;
 }
 
-/** (Eagerly) process all relocation tables in a module.
+/** Process all relocation tables in a module.
  *
- * Currently works as if LD_BIND_NOW was specified.
+ * If the architecture supports it and the module does not request
+ * immediate binding (DF_BIND_NOW), PLT entries are bound lazily on their
+ * first call. All other relocations are processed eagerly.
  */
 void module_process_relocs(module_t *m)
 {
@@ -113,10 +118,20 @@ void module_process_relocs(module_t *m)
 
 	module_process_pre_arch(m);
 
+	/*
+	 * Cache resolved symbols by index, a symbol tends to be referenced
+	 * by more than one relocation. The cache is optional.
+	 */
+	m->n_syms = symbol_count(m);
+	m->symcache = calloc(m->n_syms, sizeof(module_symcache_t));
+
 	/* jmp_rel table */
 	if (m->dyn.jmp_rel != NULL) {
 		DPRINTF("jmp_rel table\n");
-		if (m->dyn.plt_rel == DT_REL) {
+		if (!m->dyn.bind_now && module_plt_lazy_arch(m)) {
+			DPRINTF("jmp_rel table bound lazily\n");
+			m->plt_lazy = true;
+		} else if (m->dyn.plt_rel == DT_REL) {
 			DPRINTF("jmp_rel table type DT_REL\n");
 			rel_table_process(m, m->dyn.jmp_rel, m->dyn.plt_rel_sz);
 		} else {
@@ -138,6 +153,12 @@ void module_process_relocs(module_t *m)
 		rela_table_process(m, m->dyn.rela, m->dyn.rela_sz);
 	}
 
+	/* Lazily bound PLT entries keep using the cache. */
+	if (!m->plt_lazy) {
+		free(m->symcache);
+		m->symcache = NULL;
+	}
+
 	m->relocated = true;
 }
 
@@ -183,6 +204,7 @@ module_t *module_load(rtld_t *rtld, const char *name, mlflags_t flags)
 	elf_finfo_t info;
 	char name_buf[NAME_BUF_SIZE];
 	module_t *m;
+	int file;
 	errno_t rc;
 
 	m = calloc(1, sizeof(module_t));
@@ -208,13 +230,27 @@ module_t *module_load(rtld_t *rtld, const char *name, mlflags_t flags)
 
 	DPRINTF("filename:'%s'\n", name_buf);
 
-	rc = elf_load_file_name(name_buf, RTLD_MODULE_LDF, &info);
+	rc = vfs_lookup(name_buf, 0, &file);
+	if (rc != EOK) {
+		DPRINTF("Failed to look up '%s'\n", name_buf);
+		goto error;
+	}
+
+	rc = elf_load_file(file, RTLD_MODULE_LDF, &info);
+	if (rc == EOK && rtld->snapshot) {
+		/* Without the file identity the image is not snapshotted. */
+		(void) rtld_snapshot_file_get(file, &m->file);
+	}
+
+	vfs_put(file);
+
 	if (rc != EOK) {
 		DPRINTF("Failed to load '%s'\n", name_buf);
 		goto error;
 	}
 
 	m->bias = elf_get_bias(info.base);
+	m->base = info.base;
 
 	DPRINTF("loaded '%s' at 0x%zx\n", name_buf, m->bias);
 
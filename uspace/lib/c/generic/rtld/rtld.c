@@ -38,6 +38,7 @@
 #include <rtld/module.h>
 #include <rtld/rtld.h>
 #include <rtld/rtld_debug.h>
+#include <rtld/snapshot.h>
 #include <stdlib.h>
 #include <str.h>
 
@@ -65,11 +66,17 @@ errno_t rtld_init_static(void)
 }
 
 /** Initialize and process a dynamically linked executable.
+ *
+ * If @a snap is not @c NULL, the relocated image is restored from
+ * the snapshot @a snap->fd if it matches. Otherwise all relocations are
+ * processed eagerly so that a snapshot of the image can be saved.
  *
  * @param p_info Program info
+ * @param snap Snapshot or @c NULL
  * @return EOK on success or non-zero error code
  */
-errno_t rtld_prog_process(elf_finfo_t *p_info, rtld_t **rre)
+errno_t rtld_prog_process(elf_finfo_t *p_info, rtld_snapshot_t *snap,
+    rtld_t **rre)
 {
 	rtld_t *env;
 	module_t *prog;
@@ -82,6 +89,7 @@ errno_t rtld_prog_process(elf_finfo_t *p_info, rtld_t **rre)
 		return ENOMEM;
 
 	env->next_id = 1;
+	env->snapshot = snap != NULL;
 
 	prog = calloc(1, sizeof(module_t));
 	if (prog == NULL) {
@@ -97,6 +105,7 @@ errno_t rtld_prog_process(elf_finfo_t *p_info, rtld_t **rre)
 	DPRINTF("Parse program .dynamic section at %p\n", p_info->dynamic);
 	dynamic_parse(p_info->dynamic, 0, &prog->dyn);
 	prog->bias = 0;
+	prog->base = p_info->base;
 	prog->dyn.soname = "[program]";
 	prog->rtld = env;
 	prog->id = rtld_get_next_id(env);
@@ -132,6 +141,27 @@ errno_t rtld_prog_process(elf_finfo_t *p_info, rtld_t **rre)
 	/* Compute static TLS size */
 	modules_process_tls(env);
 
+	if (snap != NULL) {
+		prog->file = snap->prog;
+
+		if (snap->fd >= 0) {
+			rc = rtld_snapshot_apply(env, snap->fd);
+			if (rc == EOK) {
+				DPRINTF("Image restored from snapshot\n");
+				snap->applied = true;
+				*rre = env;
+				return EOK;
+			}
+
+			if (rc == EIO)
+				return rc;
+		}
+
+		/* Only a fully bound image can be snapshotted. */
+		list_foreach(env->modules, modules_link, module_t, m)
+			m->dyn.bind_now = true;
+	}
+
 	/*
 	 * Now relocate/link all modules together.
 	 */
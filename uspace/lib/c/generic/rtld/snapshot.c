@@ -0,0 +1,490 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libc
+ * @{
+ */
+/**
+ * @file Snapshots of relocated program images.
+ *
+ * A snapshot records the contents of all writable segments of a program
+ * and its libraries right after relocation, together with the identity of
+ * the files and the addresses the modules have been loaded at. When the
+ * same program is loaded again at the same addresses, the snapshot can be
+ * read over the writable segments instead of processing the relocations.
+ *
+ * Pages of a segment past the part initialized from the file (.bss) are
+ * zero-filled on demand. Only those which are not zero after relocation
+ * (e.g. targets of copy relocations) are stored, so that restoring the
+ * snapshot does not commit memory for the rest.
+ */
+
+#include <align.h>
+#include <as.h>
+#include <elf/elf.h>
+#include <errno.h>
+#include <macros.h>
+#include <stdlib.h>
+#include <vfs/vfs.h>
+
+#include <libarch/rtld/module.h>
+#include <rtld/rtld.h>
+#include <rtld/rtld_debug.h>
+#include <rtld/snapshot.h>
+
+#define SNAPSHOT_MAGIC 0x50414e53  /* 'SNAP' */
+#define SNAPSHOT_VERSION 2
+
+/** Snapshot file header */
+typedef struct {
+	uint32_t magic;
+	uint32_t version;
+	/** Number of module records */
+	size_t n_modules;
+	/** Number of segment records */
+	size_t n_segments;
+	/** Size of the static TLS */
+	size_t tls_size;
+} snapshot_header_t;
+
+/** Module record */
+typedef struct {
+	module_file_t file;
+	uintptr_t base;
+	size_t bias;
+	unsigned long id;
+	ptrdiff_t tpoff;
+} snapshot_module_t;
+
+/** Segment record, segment contents follow after all records */
+typedef struct {
+	uintptr_t addr;
+	size_t size;
+	/** Size of the part initialized from the file */
+	size_t filesz;
+} snapshot_segment_t;
+
+/** Run of zero-fill pages which are not zero, its contents follow */
+typedef struct {
+	uintptr_t addr;
+	size_t size;
+} snapshot_run_t;
+
+/** Get identity of a file.
+ *
+ * @param fd File handle
+ * @param file Place to store the identity
+ * @return EOK on success or an error code
+ */
+errno_t rtld_snapshot_file_get(int fd, module_file_t *file)
+{
+	vfs_stat_t stat;
+	errno_t rc;
+
+	rc = vfs_stat(fd, &stat);
+	if (rc != EOK)
+		return rc;
+
+	file->service_id = stat.service_id;
+	file->index = stat.index;
+	file->size = stat.size;
+	file->mtime = stat.mtime;
+	return EOK;
+}
+
+static bool snapshot_file_equal(const module_file_t *a, const module_file_t *b)
+{
+	return a->service_id == b->service_id && a->index == b->index &&
+	    a->size == b->size && a->mtime == b->mtime;
+}
+
+/** Fill in a module record.
+ *
+ * @return @c false if the module cannot be snapshotted.
+ */
+static bool snapshot_module_get(module_t *m, snapshot_module_t *rec)
+{
+	if (!RTLD_MODULE_SNAPSHOT || m->base == NULL || m->file.mtime == 0 ||
+	    m->dyn.text_rel || m->plt_lazy)
+		return false;
+
+	rec->file = m->file;
+	rec->base = (uintptr_t) m->base;
+	rec->bias = m->bias;
+	rec->id = m->id;
+	rec->tpoff = m->tpoff;
+	return true;
+}
+
+/** List writable segments of a module.
+ *
+ * @param m Module
+ * @param segs Array to fill in or @c NULL
+ * @return Number of writable segments
+ */
+static size_t snapshot_module_segs(module_t *m, snapshot_segment_t *segs)
+{
+	const elf_header_t *hdr = m->base;
+	const elf_segment_header_t *phdr =
+	    (const elf_segment_header_t *) ((uintptr_t) hdr + hdr->e_phoff);
+	size_t n = 0;
+
+	for (unsigned i = 0; i < hdr->e_phnum; i++) {
+		if (phdr[i].p_type != PT_LOAD || (phdr[i].p_flags & PF_W) == 0)
+			continue;
+
+		if (segs != NULL) {
+			segs[n].addr = phdr[i].p_vaddr + m->bias;
+			segs[n].size = phdr[i].p_memsz;
+			segs[n].filesz = min(phdr[i].p_filesz, phdr[i].p_memsz);
+		}
+		n++;
+	}
+
+	return n;
+}
+
+/** List writable segments of all modules.
+ *
+ * @param rtld Runtime linker
+ * @param rsegs Place to store a newly allocated array of segments
+ * @param rn Place to store the number of segments
+ * @return EOK on success, ENOMEM if out of memory
+ */
+static errno_t snapshot_segs(rtld_t *rtld, snapshot_segment_t **rsegs,
+    size_t *rn)
+{
+	snapshot_segment_t *segs;
+	size_t n = 0;
+
+	list_foreach(rtld->modules, modules_link, module_t, m)
+		n += snapshot_module_segs(m, NULL);
+
+	segs = calloc(n, sizeof(snapshot_segment_t));
+	if (segs == NULL && n > 0)
+		return ENOMEM;
+
+	n = 0;
+	list_foreach(rtld->modules, modules_link, module_t, m)
+		n += snapshot_module_segs(m, segs + n);
+
+	*rsegs = segs;
+	*rn = n;
+	return EOK;
+}
+
+/** Get end of the part of a segment which is always stored.
+ *
+ * This is the part initialized from the file, up to the end of its last
+ * page. The pages after it are zero-filled on demand.
+ *
+ * @param seg Segment
+ * @return End address of the stored part
+ */
+static uintptr_t snapshot_seg_data_end(const snapshot_segment_t *seg)
+{
+	uintptr_t data_end = ALIGN_UP(seg->addr + seg->filesz, PAGE_SIZE);
+
+	return min(data_end, seg->addr + seg->size);
+}
+
+/** Get end of the page containing address, clipped to segment.
+ *
+ * @param seg Segment
+ * @param addr Address within the segment
+ * @return End address
+ */
+static uintptr_t snapshot_page_end(const snapshot_segment_t *seg,
+    uintptr_t addr)
+{
+	uintptr_t page_end = ALIGN_DOWN(addr, PAGE_SIZE) + PAGE_SIZE;
+
+	return min(page_end, seg->addr + seg->size);
+}
+
+static bool snapshot_zero(uintptr_t addr, uintptr_t end)
+{
+	const uint8_t *p = (const uint8_t *) addr;
+
+	while (p < (const uint8_t *) end) {
+		if (*p++ != 0)
+			return false;
+	}
+
+	return true;
+}
+
+/** Find a run of zero-fill pages which are not zero.
+ *
+ * @param seg Segment
+ * @param start Page aligned address to start searching at
+ * @param rsize Place to store size of the run
+ * @return Start address of the run, end of the segment if there is none
+ */
+static uintptr_t snapshot_run_find(const snapshot_segment_t *seg,
+    uintptr_t start, size_t *rsize)
+{
+	uintptr_t end = seg->addr + seg->size;
+	uintptr_t addr = start;
+	uintptr_t run_end;
+
+	while (addr < end &&
+	    snapshot_zero(addr, snapshot_page_end(seg, addr)))
+		addr = snapshot_page_end(seg, addr);
+
+	run_end = addr;
+	while (run_end < end &&
+	    !snapshot_zero(run_end, snapshot_page_end(seg, run_end)))
+		run_end = snapshot_page_end(seg, run_end);
+
+	*rsize = run_end - addr;
+	return addr;
+}
+
+static errno_t snapshot_read(int fd, aoff64_t *pos, void *buf, size_t size)
+{
+	size_t nr;
+	errno_t rc;
+
+	rc = vfs_read(fd, pos, buf, size, &nr);
+	if (rc == EOK && nr != size)
+		rc = EIO;
+
+	return rc;
+}
+
+static errno_t snapshot_write(int fd, aoff64_t *pos, const void *buf,
+    size_t size)
+{
+	size_t nw;
+	errno_t rc;
+
+	rc = vfs_write(fd, pos, buf, size, &nw);
+	if (rc == EOK && nw != size)
+		rc = EIO;
+
+	return rc;
+}
+
+/** Restore relocated image from a snapshot.
+ *
+ * All modules of @a rtld must be loaded, with TLS offsets computed,
+ * but not relocated. The snapshot must match the files the modules
+ * have been loaded from and the addresses they have been loaded at.
+ * If the snapshot is applied, all modules are marked as relocated.
+ *
+ * @param rtld Runtime linker
+ * @param fd Snapshot file
+ * @return EOK on success, EIO if reading the snapshot failed after
+ *         the image has been partially overwritten, other error code
+ *         (ESTALE if the snapshot does not match) if the image has been
+ *         left untouched.
+ */
+errno_t rtld_snapshot_apply(rtld_t *rtld, int fd)
+{
+	snapshot_header_t hdr;
+	snapshot_module_t rec, mrec;
+	snapshot_segment_t *segs = NULL;
+	snapshot_segment_t seg;
+	aoff64_t pos = 0;
+	size_t n_segs;
+	size_t i;
+	errno_t rc;
+
+	rc = snapshot_read(fd, &pos, &hdr, sizeof(hdr));
+	if (rc != EOK)
+		return ESTALE;
+
+	if (hdr.magic != SNAPSHOT_MAGIC || hdr.version != SNAPSHOT_VERSION ||
+	    hdr.n_modules != list_count(&rtld->modules) ||
+	    hdr.tls_size != rtld->tls_size)
+		return ESTALE;
+
+	list_foreach(rtld->modules, modules_link, module_t, m) {
+		if (!snapshot_module_get(m, &mrec))
+			return ESTALE;
+
+		rc = snapshot_read(fd, &pos, &rec, sizeof(rec));
+		if (rc != EOK)
+			return ESTALE;
+
+		if (!snapshot_file_equal(&rec.file, &mrec.file) ||
+		    rec.base != mrec.base || rec.bias != mrec.bias ||
+		    rec.id != mrec.id || rec.tpoff != mrec.tpoff) {
+			DPRINTF("snapshot: module '%s' differs\n", m->dyn.soname);
+			return ESTALE;
+		}
+	}
+
+	rc = snapshot_segs(rtld, &segs, &n_segs);
+	if (rc != EOK)
+		return rc;
+
+	if (hdr.n_segments != n_segs) {
+		free(segs);
+		return ESTALE;
+	}
+
+	for (i = 0; i < n_segs; i++) {
+		rc = snapshot_read(fd, &pos, &seg, sizeof(seg));
+		if (rc != EOK || seg.addr != segs[i].addr ||
+		    seg.size != segs[i].size || seg.filesz != segs[i].filesz) {
+			free(segs);
+			return ESTALE;
+		}
+	}
+
+	/* From now on the image is being overwritten. */
+	for (i = 0; i < n_segs; i++) {
+		uintptr_t data_end = snapshot_seg_data_end(&segs[i]);
+		uintptr_t end = segs[i].addr + segs[i].size;
+		snapshot_run_t run;
+		size_t n_runs;
+
+		rc = snapshot_read(fd, &pos, (void *) segs[i].addr,
+		    data_end - segs[i].addr);
+		if (rc == EOK)
+			rc = snapshot_read(fd, &pos, &n_runs, sizeof(n_runs));
+
+		while (rc == EOK && n_runs-- > 0) {
+			rc = snapshot_read(fd, &pos, &run, sizeof(run));
+			if (rc != EOK)
+				break;
+
+			if (run.addr < data_end || run.addr > end ||
+			    run.size > end - run.addr) {
+				rc = EIO;
+				break;
+			}
+
+			rc = snapshot_read(fd, &pos, (void *) run.addr,
+			    run.size);
+		}
+
+		if (rc != EOK) {
+			free(segs);
+			return EIO;
+		}
+	}
+
+	free(segs);
+
+	list_foreach(rtld->modules, modules_link, module_t, m)
+		m->relocated = true;
+
+	DPRINTF("snapshot: applied %zu segments\n", n_segs);
+	return EOK;
+}
+
+/** Save a snapshot of relocated image.
+ *
+ * All modules of @a rtld must be relocated, with all PLT entries bound.
+ *
+ * @param rtld Runtime linker
+ * @param fd File to write the snapshot to
+ * @return EOK on success, ENOTSUP if the image cannot be snapshotted,
+ *         other error code if writing failed.
+ */
+errno_t rtld_snapshot_save(rtld_t *rtld, int fd)
+{
+	snapshot_header_t hdr;
+	snapshot_module_t rec;
+	snapshot_segment_t *segs;
+	aoff64_t pos;
+	size_t i;
+	errno_t rc;
+
+	list_foreach(rtld->modules, modules_link, module_t, m) {
+		if (!m->relocated || !snapshot_module_get(m, &rec))
+			return ENOTSUP;
+	}
+
+	rc = snapshot_segs(rtld, &segs, &hdr.n_segments);
+	if (rc != EOK)
+		return rc;
+
+	hdr.magic = SNAPSHOT_MAGIC;
+	hdr.version = SNAPSHOT_VERSION;
+	hdr.n_modules = list_count(&rtld->modules);
+	hdr.tls_size = rtld->tls_size;
+
+	pos = 0;
+	rc = snapshot_write(fd, &pos, &hdr, sizeof(hdr));
+
+	list_foreach(rtld->modules, modules_link, module_t, m) {
+		if (rc != EOK)
+			break;
+
+		(void) snapshot_module_get(m, &rec);
+		rc = snapshot_write(fd, &pos, &rec, sizeof(rec));
+	}
+
+	if (rc == EOK) {
+		rc = snapshot_write(fd, &pos, segs,
+		    hdr.n_segments * sizeof(snapshot_segment_t));
+	}
+
+	for (i = 0; i < hdr.n_segments && rc == EOK; i++) {
+		uintptr_t data_end = snapshot_seg_data_end(&segs[i]);
+		uintptr_t end = segs[i].addr + segs[i].size;
+		snapshot_run_t run;
+		size_t n_runs = 0;
+		uintptr_t addr;
+
+		rc = snapshot_write(fd, &pos, (void *) segs[i].addr,
+		    data_end - segs[i].addr);
+		if (rc != EOK)
+			break;
+
+		for (addr = snapshot_run_find(&segs[i], data_end, &run.size);
+		    addr < end;
+		    addr = snapshot_run_find(&segs[i], addr + run.size,
+		    &run.size))
+			n_runs++;
+
+		rc = snapshot_write(fd, &pos, &n_runs, sizeof(n_runs));
+
+		for (addr = snapshot_run_find(&segs[i], data_end, &run.size);
+		    addr < end && rc == EOK;
+		    addr = snapshot_run_find(&segs[i], addr + run.size,
+		    &run.size)) {
+			run.addr = addr;
+			rc = snapshot_write(fd, &pos, &run, sizeof(run));
+			if (rc == EOK) {
+				rc = snapshot_write(fd, &pos, (void *) run.addr,
+				    run.size);
+			}
+		}
+	}
+
+	free(segs);
+	return rc;
+}
+
+/** @}
+ */
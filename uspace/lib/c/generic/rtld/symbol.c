@@ -34,6 +34,7 @@
  * @file
  */
 
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <str.h>
@@ -44,6 +45,15 @@
 #include <rtld/rtld_debug.h>
 #include <rtld/symbol.h>
 
+/** Symbol name with its precomputed hash values */
+typedef struct {
+	const char *name;
+	/** SysV hash (DT_HASH) */
+	elf_word hash;
+	/** GNU hash (DT_GNU_HASH) */
+	elf_word gnu_hash;
+} symbol_key_t;
+
 /*
  * Hash tables are 32-bit (elf_word) even for 64-bit ELF files.
  */
@@ -62,38 +72,105 @@ static elf_word elf_hash(const unsigned char *name)
 	return h;
 }
 
-static elf_symbol_t *def_find_in_module(const char *name, module_t *m)
+static elf_word elf_gnu_hash(const unsigned char *name)
 {
-	elf_symbol_t *sym_table;
-	elf_symbol_t *s, *sym;
-	elf_word nbucket;
-	/*elf_word nchain;*/
-	elf_word i;
-	char *s_name;
-	elf_word bucket;
+	elf_word h = 5381;
 
-	DPRINTF("def_find_in_module('%s', %s)\n", name, m->dyn.soname);
+	while (*name)
+		h = h * 33 + *name++;
 
-	sym_table = m->dyn.sym_tab;
-	nbucket = m->dyn.hash[0];
-	/*nchain = m->dyn.hash[1]; XXX Use to check HT range*/
+	return h;
+}
 
-	bucket = elf_hash((unsigned char *)name) % nbucket;
-	i = m->dyn.hash[2 + bucket];
+static void symbol_key_init(symbol_key_t *key, const char *name)
+{
+	key->name = name;
+	key->hash = elf_hash((const unsigned char *) name);
+	key->gnu_hash = elf_gnu_hash((const unsigned char *) name);
+}
+
+/** Look a symbol up in the SysV hash table of a module. */
+static elf_symbol_t *def_find_sysv(const symbol_key_t *key, module_t *m)
+{
+	elf_symbol_t *sym_table = m->dyn.sym_tab;
+	elf_word nbucket = m->dyn.hash[0];
+	/*elf_word nchain = m->dyn.hash[1]; XXX Use to check HT range*/
+	elf_word bucket = key->hash % nbucket;
+	elf_word i = m->dyn.hash[2 + bucket];
 
-	sym = NULL;
 	while (i != STN_UNDEF) {
-		s = &sym_table[i];
-		s_name = m->dyn.str_tab + s->st_name;
+		elf_symbol_t *s = &sym_table[i];
 
-		if (str_cmp(name, s_name) == 0) {
-			sym = s;
-			break;
-		}
+		if (str_cmp(key->name, m->dyn.str_tab + s->st_name) == 0)
+			return s;
 
 		i = m->dyn.hash[2 + nbucket + i];
 	}
 
+	return NULL;
+}
+
+/** Look a symbol up in the GNU hash table of a module.
+ *
+ * The Bloom filter answers most lookups of symbols that are not defined in
+ * the module without touching the hash chains.
+ */
+static elf_symbol_t *def_find_gnu(const symbol_key_t *key, module_t *m)
+{
+	const unsigned word_bits = sizeof(uintptr_t) * 8;
+	elf_symbol_t *sym_table = m->dyn.sym_tab;
+	elf_word *ht = m->dyn.gnu_hash;
+	elf_word nbucket = ht[0];
+	elf_word symoffset = ht[1];
+	elf_word bloom_size = ht[2];
+	elf_word bloom_shift = ht[3];
+	uintptr_t *bloom = (uintptr_t *) &ht[4];
+	elf_word *buckets = (elf_word *) &bloom[bloom_size];
+	elf_word *chain = &buckets[nbucket];
+	elf_word h = key->gnu_hash;
+
+	uintptr_t word = bloom[(h / word_bits) % bloom_size];
+	uintptr_t mask = ((uintptr_t) 1 << (h % word_bits)) |
+	    ((uintptr_t) 1 << ((h >> bloom_shift) % word_bits));
+	if ((word & mask) != mask)
+		return NULL;
+
+	elf_word i = buckets[h % nbucket];
+	if (i < symoffset)
+		return NULL;
+
+	while (true) {
+		elf_word ch = chain[i - symoffset];
+
+		/* The lowest bit marks the end of the chain. */
+		if ((ch | 1) == (h | 1)) {
+			elf_symbol_t *s = &sym_table[i];
+			if (str_cmp(key->name, m->dyn.str_tab + s->st_name) == 0)
+				return s;
+		}
+
+		if ((ch & 1) != 0)
+			break;
+
+		++i;
+	}
+
+	return NULL;
+}
+
+static elf_symbol_t *def_find_in_module(const symbol_key_t *key, module_t *m)
+{
+	elf_symbol_t *sym;
+
+	DPRINTF("def_find_in_module('%s', %s)\n", key->name, m->dyn.soname);
+
+	if (m->dyn.gnu_hash != NULL)
+		sym = def_find_gnu(key, m);
+	else if (m->dyn.hash != NULL)
+		sym = def_find_sysv(key, m);
+	else
+		sym = NULL;
+
 	if (!sym)
 		return NULL;	/* Not found */
 
@@ -105,81 +182,126 @@ static elf_symbol_t *def_find_in_module(const char *name, module_t *m)
 	return sym; /* Found */
 }
 
-/** Find the definition of a symbol in a module and its deps.
+/** Get the number of entries in the symbol table of a module.
  *
- * Search the module dependency graph is breadth-first, beginning
- * from the module @a start. Thus, @start and all its dependencies
- * get searched.
+ * The dynamic section does not say, it has to be derived from the hash table.
  *
- * @param name		Name of the symbol to search for.
- * @param start		Module in which to start the search..
- * @param mod		(output) Will be filled with a pointer to the module
- *			that contains the symbol.
+ * @param m Module
+ * @return Number of symbols
  */
-elf_symbol_t *symbol_bfs_find(const char *name, module_t *start,
-    module_t **mod)
+size_t symbol_count(module_t *m)
 {
-	module_t *m, *dm;
-	elf_symbol_t *sym, *s;
-	list_t queue;
-	size_t i;
+	if (m->dyn.hash != NULL)
+		return m->dyn.hash[1];
+
+	if (m->dyn.gnu_hash == NULL)
+		return 0;
+
+	elf_word *ht = m->dyn.gnu_hash;
+	elf_word nbucket = ht[0];
+	elf_word symoffset = ht[1];
+	uintptr_t *bloom = (uintptr_t *) &ht[4];
+	elf_word *buckets = (elf_word *) &bloom[ht[2]];
+	elf_word *chain = &buckets[nbucket];
+
+	/* Find the last chain and walk it to its end. */
+	elf_word last = 0;
+	for (elf_word b = 0; b < nbucket; b++) {
+		if (buckets[b] > last)
+			last = buckets[b];
+	}
+
+	if (last < symoffset)
+		return symoffset;
+
+	while ((chain[last - symoffset] & 1) == 0)
+		++last;
+
+	return last + 1;
+}
 
-	/*
-	 * Do a BFS using the queue_link and bfs_tag fields.
-	 * Vertices (modules) are tagged the moment they are inserted
-	 * into the queue. This prevents from visiting the same vertex
-	 * more times in case of circular dependencies.
-	 */
+/** Compute the breadth-first search order of a module and its deps.
+ *
+ * Vertices (modules) are tagged the moment they are inserted into the
+ * queue. This prevents from visiting the same vertex more times in case
+ * of circular dependencies.
+ *
+ * @param start Root module
+ * @return EOK on success, ENOMEM if out of memory
+ */
+static errno_t symbol_scope_build(module_t *start)
+{
+	module_t **scope;
+	size_t n, i, j;
+
+	scope = malloc(list_count(&start->rtld->modules) * sizeof(module_t *));
+	if (scope == NULL)
+		return ENOMEM;
 
 	/* Mark all vertices (modules) as unvisited */
 	modules_untag(start->rtld);
 
-	/* Insert root (the program) into the queue and tag it */
-	list_initialize(&queue);
+	/* The array doubles as the queue. */
 	start->bfs_tag = true;
-	list_append(&start->queue_link, &queue);
-
-	/* If the symbol is found, it will be stored in 'sym' */
-	sym = NULL;
+	scope[0] = start;
+	n = 1;
 
-	/* While queue is not empty */
-	while (!list_empty(&queue)) {
-		/* Pop first element from the queue */
-		m = list_get_instance(list_first(&queue), module_t, queue_link);
-		list_remove(&m->queue_link);
-
-		/* If ssf_noroot is specified, do not look in start module */
-		s = def_find_in_module(name, m);
-		if (s != NULL) {
-			/* Symbol found */
-			sym = s;
-			*mod = m;
-			break;
-		}
+	for (i = 0; i < n; i++) {
+		module_t *m = scope[i];
 
 		/*
 		 * Insert m's untagged dependencies into the queue
 		 * and tag them.
 		 */
-		for (i = 0; i < m->n_deps; ++i) {
-			dm = m->deps[i];
+		for (j = 0; j < m->n_deps; ++j) {
+			module_t *dm = m->deps[j];
 
 			if (dm->bfs_tag == false) {
 				dm->bfs_tag = true;
-				list_append(&dm->queue_link, &queue);
+				scope[n++] = dm;
 			}
 		}
 	}
 
-	/* Empty the queue so that we leave it in a clean state */
-	while (!list_empty(&queue))
-		list_remove(list_first(&queue));
+	start->scope = scope;
+	start->n_scope = n;
+	return EOK;
+}
+
+/** Find the definition of a symbol in a module and its deps.
+ *
+ * Search the module dependency graph is breadth-first, beginning
+ * from the module @a start. Thus, @start and all its dependencies
+ * get searched. The search order is computed on the first lookup and
+ * kept with the module.
+ *
+ * @param name		Name of the symbol to search for.
+ * @param start		Module in which to start the search..
+ * @param mod		(output) Will be filled with a pointer to the module
+ *			that contains the symbol.
+ */
+elf_symbol_t *symbol_bfs_find(const char *name, module_t *start,
+    module_t **mod)
+{
+	symbol_key_t key;
+	elf_symbol_t *s;
+	size_t i;
+
+	if (start->scope == NULL && symbol_scope_build(start) != EOK)
+		return NULL;
+
+	symbol_key_init(&key, name);
 
-	if (!sym) {
-		return NULL; /* Not found */
+	for (i = 0; i < start->n_scope; i++) {
+		s = def_find_in_module(&key, start->scope[i]);
+		if (s != NULL) {
+			/* Symbol found */
+			*mod = start->scope[i];
+			return s;
+		}
 	}
 
-	return sym; /* Symbol found */
+	return NULL; /* Not found */
 }
 
 /** Find the definition of a symbol.
@@ -198,17 +320,21 @@ elf_symbol_t *symbol_bfs_find(const char *name, module_t *start,
 elf_symbol_t *symbol_def_find(const char *name, module_t *origin,
     symbol_search_flags_t flags, module_t **mod)
 {
+	symbol_key_t key;
 	elf_symbol_t *s;
 
 	DPRINTF("symbol_def_find('%s', origin='%s'\n",
 	    name, origin->dyn.soname);
+
+	symbol_key_init(&key, name);
+
 	if (origin->dyn.symbolic && (!origin->exec || (flags & ssf_noexec) == 0)) {
 		DPRINTF("symbolic->find '%s' in module '%s'\n", name, origin->dyn.soname);
 		/*
 		 * Origin module has a DT_SYMBOLIC flag.
 		 * Try this module first
 		 */
-		s = def_find_in_module(name, origin);
+		s = def_find_in_module(&key, origin);
 		if (s != NULL) {
 			/* Found */
 			*mod = origin;
@@ -222,7 +348,7 @@ elf_symbol_t *symbol_def_find(const char *name, module_t *origin,
 		DPRINTF("module '%s' local?\n", m->dyn.soname);
 		if (!m->local && (!m->exec || (flags & ssf_noexec) == 0)) {
 			DPRINTF("!local->find '%s' in module '%s'\n", name, m->dyn.soname);
-			s = def_find_in_module(name, m);
+			s = def_find_in_module(&key, m);
 			if (s != NULL) {
 				/* Found */
 				*mod = m;
@@ -237,7 +363,7 @@ elf_symbol_t *symbol_def_find(const char *name, module_t *origin,
 	    origin->dyn.soname);
 
 	if (!origin->exec || (flags & ssf_noexec) == 0) {
-		s = def_find_in_module(name, origin);
+		s = def_find_in_module(&key, origin);
 		if (s != NULL) {
 			/* Found */
 			*mod = origin;
@@ -249,6 +375,41 @@ elf_symbol_t *symbol_def_find(const char *name, module_t *origin,
 	return NULL;
 }
 
+/** Find the definition of a symbol referenced by a relocation.
+ *
+ * Relocations often refer to the same symbol several times, e.g. through
+ * the GOT and through the PLT. Resolved definitions are kept in the symbol
+ * cache of the module, if it has one.
+ *
+ * @param m		Module containing the relocation.
+ * @param sym_idx	Index of the symbol in the symbol table of @a m.
+ * @param mod		(output) Will be filled with a pointer to the module
+ *			that contains the symbol.
+ */
+elf_symbol_t *symbol_reloc_find(module_t *m, elf_word sym_idx, module_t **mod)
+{
+	elf_symbol_t *sym = &((elf_symbol_t *) m->dyn.sym_tab)[sym_idx];
+	module_symcache_t *entry = NULL;
+	elf_symbol_t *def;
+
+	if (m->symcache != NULL && sym_idx < m->n_syms) {
+		entry = &m->symcache[sym_idx];
+		if (entry->def != NULL) {
+			*mod = entry->mod;
+			return entry->def;
+		}
+	}
+
+	def = symbol_def_find(m->dyn.str_tab + sym->st_name, m, ssf_none, mod);
+	if (def != NULL && entry != NULL) {
+		/* Lazy binding may race here, def marks the entry as valid. */
+		entry->mod = *mod;
+		entry->def = def;
+	}
+
+	return def;
+}
+
 /** Get symbol address.
  *
  * @param sym Symbol
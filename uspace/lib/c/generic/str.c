@@ -117,6 +117,9 @@
 
 #include <align.h>
 #include <mem.h>
+#include <string.h>
+
+#include "private/word.h"
 
 /** Check the condition if wchar_t is signed */
 #ifdef __WCHAR_UNSIGNED__
@@ -321,6 +324,74 @@ errno_t chr_encode(const wchar_t ch, char *str, size_t *offset, size_t size)
 	return EOK;
 }
 
+/** Get length of the plain ASCII prefix of a string.
+ *
+ * Every byte of the prefix decodes to exactly one character, which lets
+ * the callers skip it without calling str_decode().
+ *
+ * @param str String to consider.
+ *
+ * @return Number of leading non-NULL 7-bit ASCII bytes in @a str.
+ *
+ */
+static size_t str_ascii_prefix(const char *str)
+{
+	const char *p = str;
+
+	while (!word_aligned(p)) {
+		if (*p == 0 || (*p & 0x80) != 0)
+			return p - str;
+		p++;
+	}
+
+	while (word_is_ascii(*(const word_t *) p) &&
+	    !word_has_zero(*(const word_t *) p))
+		p += WORD_SIZE;
+
+	while (*p != 0 && (*p & 0x80) == 0)
+		p++;
+
+	return p - str;
+}
+
+/** Get length of the common plain ASCII prefix of two strings.
+ *
+ * @param s1      First string to consider.
+ * @param s2      Second string to consider.
+ * @param max_len Maximum number of bytes to consider.
+ *
+ * @return Number of leading bytes (up to @a max_len) which are equal, not
+ *         NULL and 7-bit ASCII in both strings.
+ *
+ */
+static size_t str_ascii_common(const char *s1, const char *s2, size_t max_len)
+{
+	size_t off = 0;
+
+	if (word_congruent(s1, s2)) {
+		while (off < max_len && !word_aligned(s1 + off)) {
+			if (s1[off] != s2[off] || s1[off] == 0 ||
+			    (s1[off] & 0x80) != 0)
+				return off;
+			off++;
+		}
+
+		while (max_len - off >= WORD_SIZE) {
+			word_t w = *(const word_t *) (s1 + off);
+			if (w != *(const word_t *) (s2 + off) ||
+			    !word_is_ascii(w) || word_has_zero(w))
+				break;
+			off += WORD_SIZE;
+		}
+	}
+
+	while (off < max_len && s1[off] == s2[off] && s1[off] != 0 &&
+	    (s1[off] & 0x80) == 0)
+		off++;
+
+	return off;
+}
+
 /** Get size of string.
  *
  * Get the number of bytes which are used by the string @a str (excluding the
@@ -333,12 +404,7 @@ errno_t chr_encode(const wchar_t ch, char *str, size_t *offset, size_t size)
  */
 size_t str_size(const char *str)
 {
-	size_t size = 0;
-
-	while (*str++ != 0)
-		size++;
-
-	return size;
+	return strlen(str);
 }
 
 /** Get size of wide string.
@@ -397,12 +463,9 @@ size_t str_lsize(const char *str, size_t max_len)
  */
 size_t str_nsize(const char *str, size_t max_size)
 {
-	size_t size = 0;
+	const char *end = memchr(str, 0, max_size);
 
-	while ((*str++ != 0) && (size < max_size))
-		size++;
-
-	return size;
+	return (end != NULL) ? (size_t) (end - str) : max_size;
 }
 
 /** Get size of wide string with size limit.
@@ -448,8 +511,8 @@ size_t wstr_lsize(const wchar_t *str, size_t max_len)
  */
 size_t str_length(const char *str)
 {
-	size_t len = 0;
-	size_t offset = 0;
+	size_t len = str_ascii_prefix(str);
+	size_t offset = len;
 
 	while (str_decode(str, &offset, STR_NO_LIMIT) != 0)
 		len++;
@@ -591,8 +654,8 @@ int str_cmp(const char *s1, const char *s2)
 	wchar_t c1 = 0;
 	wchar_t c2 = 0;
 
-	size_t off1 = 0;
-	size_t off2 = 0;
+	size_t off1 = str_ascii_common(s1, s2, STR_NO_LIMIT);
+	size_t off2 = off1;
 
 	while (true) {
 		c1 = str_decode(s1, &off1, STR_NO_LIMIT);
@@ -638,10 +701,10 @@ int str_lcmp(const char *s1, const char *s2, size_t max_len)
 	wchar_t c1 = 0;
 	wchar_t c2 = 0;
 
-	size_t off1 = 0;
-	size_t off2 = 0;
+	size_t off1 = str_ascii_common(s1, s2, max_len);
+	size_t off2 = off1;
 
-	size_t len = 0;
+	size_t len = off1;
 
 	while (true) {
 		if (len >= max_len)
@@ -782,8 +845,8 @@ bool str_test_prefix(const char *s, const char *p)
 	wchar_t c1 = 0;
 	wchar_t c2 = 0;
 
-	size_t off1 = 0;
-	size_t off2 = 0;
+	size_t off1 = str_ascii_common(s, p, STR_NO_LIMIT);
+	size_t off2 = off1;
 
 	while (true) {
 		c1 = str_decode(s, &off1, STR_NO_LIMIT);
@@ -37,6 +37,8 @@
 #include <stdlib.h>
 #include <str_error.h>
 #include <string.h>
+#include <libarch/config.h>
+#include "private/word.h"
 
 /** Copy string.
  *
@@ -158,6 +160,22 @@ char *strncat(char *s1, const char *s2, size_t n)
  */
 int strcmp(const char *s1, const char *s2)
 {
+	/* Skip equal words without a terminator. */
+	if (word_congruent(s1, s2)) {
+		while (!word_aligned(s1)) {
+			if (*s1 != *s2 || *s1 == '\0')
+				return *s1 - *s2;
+			++s1;
+			++s2;
+		}
+
+		while (*(const word_t *) s1 == *(const word_t *) s2 &&
+		    !word_has_zero(*(const word_t *) s1)) {
+			s1 += WORD_SIZE;
+			s2 += WORD_SIZE;
+		}
+	}
+
 	while (*s1 == *s2 && *s1 != '\0') {
 		++s1;
 		++s2;
@@ -244,6 +262,19 @@ size_t strxfrm(char *s1, const char *s2, size_t n)
  */
 char *strchr(const char *s, int c)
 {
+	while (!word_aligned(s)) {
+		if (*s == (char) c)
+			return (char *) s;
+		if (*s++ == '\0')
+			return NULL;
+	}
+
+	/* Skip words containing neither the character nor the terminator. */
+	word_t pattern = word_repeat((uint8_t) c);
+	while (!word_has_zero(*(const word_t *) s) &&
+	    !word_has_zero(*(const word_t *) s ^ pattern))
+		s += WORD_SIZE;
+
 	do {
 		if (*s == (char) c)
 			return (char *) s;
@@ -483,6 +514,8 @@ char *strerror(int errnum)
 	return (char *) str_error(errnum);
 }
 
+#ifndef LIBARCH_STRLEN
+
 /** Return number of characters in string.
  *
  * @param s String
@@ -490,17 +523,26 @@ char *strerror(int errnum)
  */
 size_t strlen(const char *s)
 {
-	size_t n;
+	const char *p = s;
 
-	n = 0;
-	while (*s != '\0') {
-		++s;
-		++n;
+	while (!word_aligned(p)) {
+		if (*p == '\0')
+			return p - s;
+		++p;
 	}
 
-	return n;
+	/* Skip words without a terminator. */
+	while (!word_has_zero(*(const word_t *) p))
+		p += WORD_SIZE;
+
+	while (*p != '\0')
+		++p;
+
+	return p - s;
 }
 
+#endif
+
 /** Return number of characters in string with length limit.
  *
  * @param s String
@@ -509,15 +551,9 @@ size_t strlen(const char *s)
  */
 size_t strnlen(const char *s, size_t maxlen)
 {
-	size_t n;
-
-	n = 0;
-	while (n < maxlen && *s != '\0') {
-		++s;
-		++n;
-	}
+	const char *p = memchr(s, '\0', maxlen);
 
-	return n;
+	return p != NULL ? (size_t) (p - s) : maxlen;
 }
 
 /** Allocate a new duplicate of string.
@@ -83,6 +83,15 @@ typedef enum {
 	SWITCH_FROM_BLOCKED,
 } _switch_type_t;
 
+/** Maximum number of stacks and fibril structures kept for reuse. */
+#define FIBRIL_CACHE_MAX 64
+
+/** Cached stack, stored at the top of the stack it describes. */
+typedef struct {
+	link_t link;
+	void *stack;
+} _stack_cache_entry_t;
+
 static bool multithreaded = false;
 
 /* This futex serializes access to global data. */
@@ -94,6 +103,16 @@ static LIST_INITIALIZE(ready_list);
 static LIST_INITIALIZE(fibril_list);
 static LIST_INITIALIZE(timeout_list);
 
+/*
+ * Stacks and fibril structures of dead fibrils are kept for reuse, so that
+ * creating a fibril costs neither address space syscalls nor page faults
+ * warming up a fresh stack. Both caches are protected by fibril_futex.
+ */
+static LIST_INITIALIZE(stack_cache);
+static size_t stack_cache_count;
+static LIST_INITIALIZE(fibril_cache);
+static size_t fibril_cache_count;
+
 static futex_t ipc_lists_futex;
 static LIST_INITIALIZE(ipc_waiter_list);
 static LIST_INITIALIZE(ipc_buffer_list);
@@ -161,6 +180,21 @@ static void _fibril_main(void)
 /** Allocate a fibril structure and TCB, but don't do anything else with it. */
 fibril_t *fibril_alloc(void)
 {
+	futex_lock(&fibril_futex);
+
+	link_t *link = list_first(&fibril_cache);
+	if (link != NULL) {
+		list_remove(link);
+		fibril_cache_count--;
+
+		fibril_t *fibril = list_get_instance(link, fibril_t, link);
+		list_append(&fibril->all_link, &fibril_list);
+		futex_unlock(&fibril_futex);
+		return fibril;
+	}
+
+	futex_unlock(&fibril_futex);
+
 	tcb_t *tcb = tls_make(__progsymbols.elfstart);
 	if (!tcb)
 		return NULL;
@@ -201,6 +235,84 @@ void fibril_teardown(fibril_t *fibril)
 	}
 }
 
+/** Get a stack for a new fibril, preferably a cached one. */
+static void *_fibril_stack_alloc(size_t size)
+{
+	if (size == stack_size_get()) {
+		futex_lock(&fibril_futex);
+		link_t *link = list_first(&stack_cache);
+		if (link != NULL) {
+			list_remove(link);
+			stack_cache_count--;
+		}
+		futex_unlock(&fibril_futex);
+
+		if (link != NULL) {
+			return list_get_instance(link, _stack_cache_entry_t,
+			    link)->stack;
+		}
+	}
+
+	return as_area_create(AS_AREA_ANY, size,
+	    AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE | AS_AREA_GUARD |
+	    AS_AREA_LATE_RESERVE, AS_AREA_UNPAGED);
+}
+
+/** Return a stack of a dead fibril, it is cached if possible. */
+static void _fibril_stack_free(void *stack, size_t size)
+{
+	if (size == stack_size_get()) {
+		/* The top of the stack has been touched already. */
+		_stack_cache_entry_t *entry = stack + size - sizeof(*entry);
+		entry->stack = stack;
+
+		futex_lock(&fibril_futex);
+		bool cached = stack_cache_count < FIBRIL_CACHE_MAX;
+		if (cached) {
+			list_append(&entry->link, &stack_cache);
+			stack_cache_count++;
+		}
+		futex_unlock(&fibril_futex);
+
+		if (cached)
+			return;
+	}
+
+	as_area_destroy(stack);
+}
+
+/** Release resources of a fibril that is not running.
+ *
+ * The stack, the fibril structure and the TCB are cached for reuse if
+ * possible.
+ */
+static void _fibril_release(fibril_t *fibril)
+{
+	assert(fibril->stack);
+	_fibril_stack_free(fibril->stack, fibril->stack_size);
+
+	if (fibril->is_freeable) {
+		tcb_t *tcb = fibril->tcb;
+
+		futex_lock(&fibril_futex);
+		if (fibril_cache_count < FIBRIL_CACHE_MAX && tls_reset(tcb)) {
+			list_remove(&fibril->all_link);
+
+			memset(fibril, 0, sizeof(*fibril));
+			fibril->tcb = tcb;
+			fibril->is_freeable = true;
+
+			list_append(&fibril->link, &fibril_cache);
+			fibril_cache_count++;
+			futex_unlock(&fibril_futex);
+			return;
+		}
+		futex_unlock(&fibril_futex);
+	}
+
+	fibril_teardown(fibril);
+}
+
 /**
  * Event notification with a given reason.
  *
@@ -452,10 +564,7 @@ static void _fibril_cleanup_dead(void)
 	if (!srcf->clean_after_me)
 		return;
 
-	void *stack = srcf->clean_after_me->stack;
-	assert(stack);
-	as_area_destroy(stack);
-	fibril_teardown(srcf->clean_after_me);
+	_fibril_release(srcf->clean_after_me);
 	srcf->clean_after_me = NULL;
 }
 
@@ -550,9 +659,7 @@ fid_t fibril_create_generic(errno_t (*func)(void *), void *arg, size_t stksz)
 		return 0;
 
 	fibril->stack_size = stksz;
-	fibril->stack = as_area_create(AS_AREA_ANY, fibril->stack_size,
-	    AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE | AS_AREA_GUARD |
-	    AS_AREA_LATE_RESERVE, AS_AREA_UNPAGED);
+	fibril->stack = _fibril_stack_alloc(fibril->stack_size);
 	if (fibril->stack == AS_MAP_FAILED) {
 		fibril_teardown(fibril);
 		return 0;
@@ -590,9 +697,7 @@ void fibril_destroy(fid_t fid)
 	fibril_t *fibril = (fibril_t *) fid;
 
 	assert(!fibril->is_running);
-	assert(fibril->stack);
-	as_area_destroy(fibril->stack);
-	fibril_teardown(fibril);
+	_fibril_release(fibril);
 }
 
 static void _insert_timeout(_timeout_t *timeout)
@@ -0,0 +1,335 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libc
+ * @{
+ */
+/** @file
+ */
+
+#include <align.h>
+#include <errno.h>
+#include <fibril.h>
+#include <fibril_synch.h>
+#include <macros.h>
+#include <mem.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*
+ * A multi-producer, multi-consumer concurrent FIFO channel with a bounded
+ * buffer.
+ *
+ * The buffer is the lock-free ring by Dmitry Vyukov. Each cell carries a
+ * sequence number which tells whether the cell is ready to be written
+ * (it equals the position of the sender) or read (it equals the position
+ * of the receiver plus one). Senders and receivers claim positions by
+ * compare-and-swap and never wait for each other unless the buffer is
+ * full or empty.
+ *
+ * Only senders blocked on a full buffer and receivers blocked on an empty
+ * one sleep on a fibril condition variable. The count of sleepers lets the
+ * other side skip the wakeup when nobody is sleeping.
+ */
+
+/** Sleeping senders or receivers */
+typedef struct {
+	fibril_mutex_t mutex;
+	fibril_condvar_t cv;
+	/** Number of fibrils about to sleep or sleeping on @c cv */
+	size_t waiters;
+} mpmc_waitq_t;
+
+struct mpmc {
+	size_t elem_size;
+	/** Distance between two cells in bytes */
+	size_t cell_size;
+	/** Number of cells minus one, the number of cells is a power of two */
+	size_t mask;
+	unsigned char *cells;
+	/** Position of the next send */
+	size_t send_pos;
+	/** Position of the next receive */
+	size_t receive_pos;
+	/** Senders waiting for a free cell */
+	mpmc_waitq_t not_full;
+	/** Receivers waiting for a full cell */
+	mpmc_waitq_t not_empty;
+};
+
+typedef struct {
+	size_t seq;
+	unsigned char data[];
+} mpmc_cell_t;
+
+static mpmc_cell_t *mpmc_cell(mpmc_t *q, size_t pos)
+{
+	return (mpmc_cell_t *) (q->cells + (pos & q->mask) * q->cell_size);
+}
+
+static void mpmc_waitq_initialize(mpmc_waitq_t *wq)
+{
+	fibril_mutex_initialize(&wq->mutex);
+	fibril_condvar_initialize(&wq->cv);
+	wq->waiters = 0;
+}
+
+/** Wake up a fibril sleeping on the wait queue, if there is any. */
+static void mpmc_waitq_wakeup(mpmc_waitq_t *wq)
+{
+	/* Pairs with the increment in mpmc_waitq_sleep(). */
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+	if (__atomic_load_n(&wq->waiters, __ATOMIC_RELAXED) == 0)
+		return;
+
+	fibril_mutex_lock(&wq->mutex);
+	fibril_condvar_signal(&wq->cv);
+	fibril_mutex_unlock(&wq->mutex);
+}
+
+/** Sleep on the wait queue until @a try_op succeeds.
+ *
+ * The operation is retried after announcing the sleep, so either it
+ * succeeds or the fibril which makes it possible sees the announcement.
+ * The operation must not wake up anybody itself, as the wait queue
+ * mutex is held.
+ *
+ * @return EOK or ETIMEOUT if the deadline expired.
+ */
+static errno_t mpmc_waitq_sleep(mpmc_t *q, mpmc_waitq_t *wq,
+    errno_t (*try_op)(mpmc_t *, void *), void *b,
+    const struct timespec *expires)
+{
+	errno_t rc;
+
+	fibril_mutex_lock(&wq->mutex);
+	__atomic_fetch_add(&wq->waiters, 1, __ATOMIC_RELAXED);
+	/* Pairs with the fence in mpmc_waitq_wakeup(). */
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+	while ((rc = try_op(q, b)) == EAGAIN) {
+		usec_t timeout = 0;
+
+		if (expires != NULL) {
+			struct timespec now;
+			getuptime(&now);
+
+			if (ts_gteq(&now, expires)) {
+				rc = ETIMEOUT;
+				break;
+			}
+
+			/* Zero would mean no timeout. */
+			timeout = max(NSEC2USEC(ts_sub_diff(expires, &now)), 1);
+		}
+
+		(void) fibril_condvar_wait_timeout(&wq->cv, &wq->mutex, timeout);
+	}
+
+	__atomic_fetch_sub(&wq->waiters, 1, __ATOMIC_RELAXED);
+	fibril_mutex_unlock(&wq->mutex);
+
+	return rc;
+}
+
+/**
+ * Create a channel.
+ *
+ * @param elem_size Size of a message.
+ * @param capacity  Minimal number of messages the channel can buffer,
+ *                  rounded up to a power of two.
+ *
+ * @return New channel or NULL if out of memory.
+ */
+mpmc_t *mpmc_create(size_t elem_size, size_t capacity)
+{
+	size_t cell_cnt = 2;
+
+	while (cell_cnt < capacity)
+		cell_cnt *= 2;
+
+	mpmc_t *q = calloc(1, sizeof(mpmc_t));
+	if (q == NULL)
+		return NULL;
+
+	q->elem_size = elem_size;
+	q->cell_size = ALIGN_UP(sizeof(mpmc_cell_t) + elem_size,
+	    sizeof(size_t));
+	q->mask = cell_cnt - 1;
+
+	q->cells = malloc(cell_cnt * q->cell_size);
+	if (q->cells == NULL) {
+		free(q);
+		return NULL;
+	}
+
+	for (size_t i = 0; i < cell_cnt; i++)
+		mpmc_cell(q, i)->seq = i;
+
+	mpmc_waitq_initialize(&q->not_full);
+	mpmc_waitq_initialize(&q->not_empty);
+
+	return q;
+}
+
+/** Destroy a channel. There must be no fibrils using it. */
+void mpmc_destroy(mpmc_t *q)
+{
+	free(q->cells);
+	free(q);
+}
+
+static errno_t _mpmc_try_send(mpmc_t *q, void *b)
+{
+	mpmc_cell_t *cell;
+	size_t pos = __atomic_load_n(&q->send_pos, __ATOMIC_RELAXED);
+
+	while (true) {
+		cell = mpmc_cell(q, pos);
+		size_t seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+		intptr_t diff = (intptr_t) seq - (intptr_t) pos;
+
+		if (diff == 0) {
+			/* The cell is free, try to claim it. */
+			if (__atomic_compare_exchange_n(&q->send_pos, &pos,
+			    pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+				break;
+		} else if (diff < 0) {
+			/* The cell still holds a message from the last round. */
+			return EAGAIN;
+		} else {
+			/* Another sender claimed the position. */
+			pos = __atomic_load_n(&q->send_pos, __ATOMIC_RELAXED);
+		}
+	}
+
+	memcpy(cell->data, b, q->elem_size);
+	__atomic_store_n(&cell->seq, pos + 1, __ATOMIC_RELEASE);
+	return EOK;
+}
+
+static errno_t _mpmc_try_receive(mpmc_t *q, void *b)
+{
+	mpmc_cell_t *cell;
+	size_t pos = __atomic_load_n(&q->receive_pos, __ATOMIC_RELAXED);
+
+	while (true) {
+		cell = mpmc_cell(q, pos);
+		size_t seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+		intptr_t diff = (intptr_t) seq - (intptr_t) (pos + 1);
+
+		if (diff == 0) {
+			/* The cell is full, try to claim it. */
+			if (__atomic_compare_exchange_n(&q->receive_pos, &pos,
+			    pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+				break;
+		} else if (diff < 0) {
+			/* The cell has not been written yet. */
+			return EAGAIN;
+		} else {
+			/* Another receiver claimed the position. */
+			pos = __atomic_load_n(&q->receive_pos, __ATOMIC_RELAXED);
+		}
+	}
+
+	memcpy(b, cell->data, q->elem_size);
+	__atomic_store_n(&cell->seq, pos + q->mask + 1, __ATOMIC_RELEASE);
+	return EOK;
+}
+
+/**
+ * Send data on the channel without blocking.
+ * The length of data is equal to the `elem_size` value set in `mpmc_create`.
+ *
+ * @return EAGAIN if the channel is full.
+ */
+errno_t mpmc_try_send(mpmc_t *q, const void *b)
+{
+	errno_t rc = _mpmc_try_send(q, (void *) b);
+	if (rc == EOK)
+		mpmc_waitq_wakeup(&q->not_empty);
+
+	return rc;
+}
+
+/**
+ * Receive data from the channel without blocking.
+ *
+ * @return EAGAIN if the channel is empty.
+ */
+errno_t mpmc_try_receive(mpmc_t *q, void *b)
+{
+	errno_t rc = _mpmc_try_receive(q, b);
+	if (rc == EOK)
+		mpmc_waitq_wakeup(&q->not_full);
+
+	return rc;
+}
+
+/**
+ * Send data on the channel, waiting while the channel is full.
+ *
+ * @return ETIMEOUT if deadline expires.
+ */
+errno_t mpmc_send(mpmc_t *q, const void *b, const struct timespec *expires)
+{
+	errno_t rc = _mpmc_try_send(q, (void *) b);
+	if (rc == EAGAIN) {
+		rc = mpmc_waitq_sleep(q, &q->not_full, _mpmc_try_send,
+		    (void *) b, expires);
+	}
+
+	if (rc == EOK)
+		mpmc_waitq_wakeup(&q->not_empty);
+
+	return rc;
+}
+
+/**
+ * Receive data from the channel, waiting while the channel is empty.
+ *
+ * @return ETIMEOUT if deadline expires.
+ */
+errno_t mpmc_receive(mpmc_t *q, void *b, const struct timespec *expires)
+{
+	errno_t rc = _mpmc_try_receive(q, b);
+	if (rc == EAGAIN) {
+		rc = mpmc_waitq_sleep(q, &q->not_empty, _mpmc_try_receive, b,
+		    expires);
+	}
+
+	if (rc == EOK)
+		mpmc_waitq_wakeup(&q->not_full);
+
+	return rc;
+}
+
+/** @}
+ */
@@ -42,21 +42,36 @@
  * A multi-producer, single-consumer concurrent FIFO channel with unlimited
  * buffering.
  *
- * The current implementation is based on the super simple two-lock queue
- * by Michael and Scott
- * (http://www.cs.rochester.edu/~scott/papers/1996_PODC_queues.pdf)
+ * The queue is the lock-free intrusive queue by Dmitry Vyukov. A sender
+ * swaps its node into the tail and only then links it to its predecessor,
+ * so the receiver may briefly see a node whose successor is not linked yet.
+ * In that case, it waits just as if the queue was empty.
  *
- * The original algorithm uses one lock on each side. Since this queue is
- * single-consumer, we only use the tail lock.
+ * The receiver only sleeps on the event after announcing it in `waiting`,
+ * so that senders can skip the (globally locked) notification while the
+ * receiver is busy.
+ *
+ * Closing must not overtake sends which have already been accepted, the
+ * close node has to be the last node the receiver gets. The number of sends
+ * in progress is therefore tracked in `senders` together with the closed
+ * flag and the close node is only pushed once all of them are finished.
  */
 
+/** Flag in mpsc_t.senders set when the channel is closed */
+#define MPSC_CLOSED  ((size_t) 1 << (sizeof(size_t) * 8 - 1))
+
 typedef struct mpsc_node mpsc_node_t;
 
 struct mpsc {
 	size_t elem_size;
-	fibril_rmutex_t t_lock;
+	/** Last received node, only accessed by the receiver */
 	mpsc_node_t *head;
+	/** Last sent node */
 	mpsc_node_t *tail;
+	/** Number of sends in progress, possibly with MPSC_CLOSED */
+	size_t senders;
+	/** True if the receiver may be sleeping on the event */
+	bool waiting;
 	mpsc_node_t *close_node;
 	fibril_event_t event;
 };
@@ -79,13 +94,6 @@ mpsc_t *mpsc_create(size_t elem_size)
 		return NULL;
 	}
 
-	if (fibril_rmutex_initialize(&q->t_lock) != EOK) {
-		free(q);
-		free(n);
-		free(c);
-		return NULL;
-	}
-
 	q->elem_size = elem_size;
 	q->head = q->tail = n;
 	q->close_node = c;
@@ -102,27 +110,28 @@ void mpsc_destroy(mpsc_t *q)
 		n = next;
 	}
 
-	fibril_rmutex_destroy(&q->t_lock);
+	/* Unless the channel was closed, the close node is not linked. */
+	if ((q->senders & MPSC_CLOSED) == 0)
+		free(q->close_node);
 
 	free(q);
 }
 
-static errno_t _mpsc_push(mpsc_t *q, mpsc_node_t *n)
+static void _mpsc_push(mpsc_t *q, mpsc_node_t *n)
 {
-	fibril_rmutex_lock(&q->t_lock);
-
-	if (q->tail == q->close_node) {
-		fibril_rmutex_unlock(&q->t_lock);
-		return EINVAL;
-	}
+	mpsc_node_t *prev = __atomic_exchange_n(&q->tail, n, __ATOMIC_ACQ_REL);
 
-	__atomic_store_n(&q->tail->next, n, __ATOMIC_RELEASE);
-	q->tail = n;
+	/* Until now, the receiver cannot get past prev. */
+	__atomic_store_n(&prev->next, n, __ATOMIC_RELEASE);
+}
 
-	fibril_rmutex_unlock(&q->t_lock);
+static void _mpsc_wakeup(mpsc_t *q)
+{
+	/* Pairs with the fence in mpsc_receive(). */
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
 
-	fibril_notify(&q->event);
-	return EOK;
+	if (__atomic_load_n(&q->waiting, __ATOMIC_RELAXED))
+		fibril_notify(&q->event);
 }
 
 /**
@@ -142,7 +151,19 @@ errno_t mpsc_send(mpsc_t *q, const void *b)
 	n->next = NULL;
 	memcpy(n->data, b, q->elem_size);
 
-	return _mpsc_push(q, n);
+	size_t senders = __atomic_fetch_add(&q->senders, 1, __ATOMIC_ACQUIRE);
+	if (senders & MPSC_CLOSED) {
+		__atomic_fetch_sub(&q->senders, 1, __ATOMIC_RELEASE);
+		free(n);
+		return EINVAL;
+	}
+
+	_mpsc_push(q, n);
+
+	__atomic_fetch_sub(&q->senders, 1, __ATOMIC_RELEASE);
+
+	_mpsc_wakeup(q);
+	return EOK;
 }
 
 /**
@@ -153,16 +174,29 @@ errno_t mpsc_send(mpsc_t *q, const void *b)
  */
 errno_t mpsc_receive(mpsc_t *q, void *b, const struct timespec *expires)
 {
-	mpsc_node_t *n;
+	mpsc_node_t *n = q->head;
 	mpsc_node_t *new_head;
 
 	while (true) {
-		n = q->head;
 		new_head = __atomic_load_n(&n->next, __ATOMIC_ACQUIRE);
 		if (new_head)
 			break;
 
+		/*
+		 * Announce that we are going to sleep and check again,
+		 * a sender either sees the announcement or we see its node.
+		 */
+		__atomic_store_n(&q->waiting, true, __ATOMIC_RELAXED);
+		__atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+		new_head = __atomic_load_n(&n->next, __ATOMIC_ACQUIRE);
+		if (new_head) {
+			__atomic_store_n(&q->waiting, false, __ATOMIC_RELAXED);
+			break;
+		}
+
 		errno_t rc = fibril_wait_timeout(&q->event, expires);
+		__atomic_store_n(&q->waiting, false, __ATOMIC_RELAXED);
 		if (rc != EOK)
 			return rc;
 	}
@@ -184,5 +218,19 @@ errno_t mpsc_receive(mpsc_t *q, void *b, const struct timespec *expires)
  */
 void mpsc_close(mpsc_t *q)
 {
+	size_t senders = __atomic_fetch_or(&q->senders, MPSC_CLOSED,
+	    __ATOMIC_ACQUIRE);
+	if (senders & MPSC_CLOSED)
+		return;
+
+	/*
+	 * No new sends are accepted now. Wait for the sends in progress,
+	 * they never block, so that the close node comes after their nodes.
+	 */
+	while ((__atomic_load_n(&q->senders, __ATOMIC_ACQUIRE) &
+	    ~MPSC_CLOSED) != 0)
+		;
+
 	_mpsc_push(q, q->close_node);
+	_mpsc_wakeup(q);
 }
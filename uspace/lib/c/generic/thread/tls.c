@@ -189,6 +189,35 @@ void tls_free(tcb_t *tcb)
 	    max(tls->p_align, _Alignof(tcb_t)));
 }
 
+/** Reinitialize thread local data of a TCB created by tls_make().
+ *
+ * This allows reusing the TCB for another fibril.
+ *
+ * @param tcb TCB whose thread local data are to be reinitialized.
+ *
+ * @return True on success, false if the TCB cannot be reused.
+ */
+bool tls_reset(tcb_t *tcb)
+{
+#ifdef CONFIG_RTLD
+	/* Dynamic TLS blocks of loaded modules cannot be reset. */
+	if (runtime_env != NULL)
+		return false;
+#endif
+
+	const elf_segment_header_t *tls =
+	    elf_get_phdr(__progsymbols.elfstart, PT_TLS);
+	if (!tls)
+		return true;
+
+	uint8_t *data = (uint8_t *)tcb + _tcb_data_offset();
+	uintptr_t bias = elf_get_bias(__progsymbols.elfstart);
+
+	memcpy(data, (void *)(tls->p_vaddr + bias), tls->p_filesz);
+	memset(data + tls->p_filesz, 0, tls->p_memsz - tls->p_filesz);
+	return true;
+}
+
 #ifdef CONFIG_TLS_VARIANT_1
 /** Allocate TLS variant 1 data structures.
  *
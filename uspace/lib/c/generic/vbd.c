@@ -125,6 +125,56 @@ errno_t vbd_disk_info(vbd_t *vbd, service_id_t sid, vbd_disk_info_t *vinfo)
 	return EOK;
 }
 
+/** Get disk I/O statistics.
+ *
+ * @param vbd Virtual block device service
+ * @param sid Disk service ID
+ * @param stats Place to store statistics
+ * @return EOK on success or an error code
+ */
+errno_t vbd_disk_stats(vbd_t *vbd, service_id_t sid, vbd_disk_stats_t *stats)
+{
+	async_exch_t *exch;
+	errno_t retval;
+	ipc_call_t answer;
+
+	exch = async_exchange_begin(vbd->sess);
+	aid_t req = async_send_1(exch, VBD_DISK_STATS, sid, &answer);
+	errno_t rc = async_data_read_start(exch, stats,
+	    sizeof(vbd_disk_stats_t));
+	async_exchange_end(exch);
+
+	if (rc != EOK) {
+		async_forget(req);
+		return EIO;
+	}
+
+	async_wait_for(req, &retval);
+	if (retval != EOK)
+		return retval;
+
+	return EOK;
+}
+
+/** Enable or disable I/O scheduler of a disk.
+ *
+ * @param vbd Virtual block device service
+ * @param sid Disk service ID
+ * @param enable @c true to enable scheduler, @c false to disable it
+ * @return EOK on success or an error code
+ */
+errno_t vbd_disk_sched_set(vbd_t *vbd, service_id_t sid, bool enable)
+{
+	async_exch_t *exch;
+	errno_t retval;
+
+	exch = async_exchange_begin(vbd->sess);
+	retval = async_req_2_0(exch, VBD_DISK_SCHED_SET, sid, enable);
+	async_exchange_end(exch);
+
+	return retval;
+}
+
 errno_t vbd_label_create(vbd_t *vbd, service_id_t sid, label_type_t ltype)
 {
 	async_exch_t *exch;
@@ -37,6 +37,7 @@
 #include <vfs/vfs_mtab.h>
 #include <vfs/vfs_sess.h>
 #include <macros.h>
+#include <as.h>
 #include <stdlib.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -118,6 +119,9 @@
 static FIBRIL_MUTEX_INITIALIZE(vfs_mutex);
 static async_sess_t *vfs_sess = NULL;
 
+static FIBRIL_MUTEX_INITIALIZE(pager_mutex);
+static async_sess_t *pager_sess = NULL;
+
 static FIBRIL_MUTEX_INITIALIZE(cwd_mutex);
 
 static int cwd_fd = -1;
@@ -127,6 +131,9 @@ static size_t cwd_size = 0;
 static FIBRIL_MUTEX_INITIALIZE(root_mutex);
 static int root_fd = -1;
 
+/** Number of read requests vfs_read() keeps in flight for large transfers */
+static unsigned vfs_read_depth = 4;
+
 static errno_t get_parent_and_child(const char *path, int *parent, char **child)
 {
 	size_t size;
@@ -647,6 +654,57 @@ errno_t vfs_mount(int mp, const char *fs_name, service_id_t serv, const char *op
 	return rc1;
 }
 
+/** Map a file into the address space
+ *
+ * The pages of the mapping are supplied by the VFS pager on demand. Clean
+ * pages are shared with other tasks mapping the same file. The file handle
+ * must stay open for as long as the mapping exists.
+ *
+ * @param file          File handle to map
+ * @param pos           Page-aligned position in the file
+ * @param size          Size of the mapping
+ * @param flags         Address space area flags (AS_AREA_*)
+ * @param shared        Modifications are written back to the file if true,
+ *                      they are private to the mapping otherwise
+ * @param[in,out] addr  Requested address or AS_AREA_ANY on input, address of
+ *                      the mapping on output
+ *
+ * @return              EOK on success or an error code
+ */
+errno_t vfs_map(int file, aoff64_t pos, size_t size, unsigned int flags,
+    bool shared, void **addr)
+{
+	sysarg_t pager_flags = 0;
+	sysarg_t pgoff = pos / PAGE_SIZE;
+
+	if (pos % PAGE_SIZE != 0 || pgoff != pos / PAGE_SIZE)
+		return EINVAL;
+
+	if (flags & AS_AREA_WRITE)
+		pager_flags = shared ? VFS_PAGER_SHARED_WRITE : VFS_PAGER_PRIVATE;
+
+	fibril_mutex_lock(&pager_mutex);
+
+	if (pager_sess == NULL) {
+		pager_sess = service_connect_blocking(SERVICE_VFS,
+		    INTERFACE_PAGER, 0, NULL);
+		if (pager_sess == NULL) {
+			fibril_mutex_unlock(&pager_mutex);
+			return ENOENT;
+		}
+	}
+
+	fibril_mutex_unlock(&pager_mutex);
+
+	void *area = async_as_area_create(*addr, size,
+	    flags | AS_AREA_CACHEABLE, pager_sess, file, pager_flags, pgoff);
+	if (area == AS_MAP_FAILED)
+		return ENOMEM;
+
+	*addr = area;
+	return EOK;
+}
+
 /** Mount a file system
  *
  * @param[in] mp                Path representing the mount-point
@@ -821,6 +879,94 @@ errno_t vfs_receive_handle(bool high, int *handle)
 	return rc;
 }
 
+/** Read bytes from a file using several requests in flight
+ *
+ * Splits the transfer into requests of at most DATA_XFER_LIMIT bytes and
+ * sends up to vfs_read_depth of them in one exchange before waiting for
+ * the first answer, so that VFS and the file system server do not wait
+ * for the client between the requests. Only the leading part of the buffer
+ * which was read without any gaps is reported, so this must only be used
+ * on regular files, where the data past a short read can be read again.
+ *
+ * @param file          File handle to read from
+ * @param[in] pos       Position to read from
+ * @param buf           Buffer to read to
+ * @param nbyte         Maximum number of bytes to read
+ * @param[out] nread	Actual number of bytes read (0 or more)
+ *
+ * @return              EOK on success or an error code
+ */
+static errno_t vfs_read_pipelined(int file, aoff64_t pos, void *buf,
+    size_t nbyte, ssize_t *nread)
+{
+	ipc_call_t answer[VFS_READ_DEPTH_MAX];
+	aid_t req[VFS_READ_DEPTH_MAX];
+	aid_t dreq[VFS_READ_DEPTH_MAX];
+	size_t size[VFS_READ_DEPTH_MAX];
+	unsigned depth = min(vfs_read_depth, VFS_READ_DEPTH_MAX);
+	uint8_t *bp = (uint8_t *) buf;
+	size_t off = 0;
+	unsigned cnt;
+	unsigned i;
+
+	async_exch_t *exch = vfs_exchange_begin();
+
+	for (cnt = 0; cnt < depth && off < nbyte; cnt++) {
+		size[cnt] = min(nbyte - off, DATA_XFER_LIMIT);
+		req[cnt] = async_send_3(exch, VFS_IN_READ, file,
+		    LOWER32(pos + off), UPPER32(pos + off), &answer[cnt]);
+		dreq[cnt] = async_data_read(exch, bp + off, size[cnt], NULL);
+		if (dreq[cnt] == 0) {
+			async_forget(req[cnt]);
+			break;
+		}
+
+		off += size[cnt];
+	}
+
+	vfs_exchange_end(exch);
+
+	if (cnt == 0)
+		return ENOMEM;
+
+	/*
+	 * Wait for all the requests, as they are writing into our buffer,
+	 * but stop counting at the first short read or error.
+	 */
+	errno_t rc = EOK;
+	size_t nr = 0;
+	bool done = false;
+
+	for (i = 0; i < cnt; i++) {
+		errno_t drc;
+		errno_t rrc;
+
+		async_wait_for(dreq[i], &drc);
+		async_wait_for(req[i], &rrc);
+
+		if (done)
+			continue;
+
+		if (drc != EOK || rrc != EOK) {
+			if (nr == 0)
+				rc = (drc != EOK) ? drc : rrc;
+			done = true;
+			continue;
+		}
+
+		size_t n = ipc_get_arg1(&answer[i]);
+		nr += n;
+		if (n < size[i])
+			done = true;
+	}
+
+	if (rc != EOK)
+		return rc;
+
+	*nread = nr;
+	return EOK;
+}
+
 /** Read data
  *
  * Read up to @a nbytes bytes from file if available. This function always reads
@@ -838,27 +984,42 @@ errno_t vfs_receive_handle(bool high, int *handle)
  */
 errno_t vfs_read(int file, aoff64_t *pos, void *buf, size_t nbyte, size_t *nread)
 {
-	ssize_t cnt = 0;
+	ssize_t cnt;
 	size_t nr = 0;
 	uint8_t *bp = (uint8_t *) buf;
-	errno_t rc;
+	aoff64_t size = 0;
+	vfs_stat_t st;
+	errno_t rc = EOK;
+
+	/*
+	 * Only regular files are read with several requests in flight,
+	 * and never past their end. Reading ahead from a device or another
+	 * stream node would consume data which is then thrown away.
+	 */
+	if (nbyte > DATA_XFER_LIMIT && vfs_read_depth > 1 &&
+	    vfs_stat(file, &st) == EOK && st.is_file && st.service == 0)
+		size = st.size;
+
+	while (nr < nbyte) {
+		size_t avail = (*pos < size) ? min(size - *pos, nbyte - nr) : 0;
+
+		if (avail > DATA_XFER_LIMIT) {
+			rc = vfs_read_pipelined(file, *pos, bp + nr, avail,
+			    &cnt);
+		} else {
+			rc = vfs_read_short(file, *pos, bp + nr, nbyte - nr,
+			    &cnt);
+		}
+
+		if (rc != EOK || cnt == 0)
+			break;
 
-	do {
-		bp += cnt;
 		nr += cnt;
 		*pos += cnt;
-		rc = vfs_read_short(file, *pos, bp, nbyte - nr, &cnt);
-	} while (rc == EOK && cnt > 0 && (nbyte - nr - cnt) > 0);
-
-	if (rc != EOK) {
-		*nread = nr;
-		return rc;
 	}
 
-	nr += cnt;
-	*pos += cnt;
 	*nread = nr;
-	return EOK;
+	return rc;
 }
 
 /** Read bytes from a file
@@ -906,6 +1067,75 @@ errno_t vfs_read_short(int file, aoff64_t pos, void *buf, size_t nbyte,
 	return EOK;
 }
 
+/** Read a batch of directory entries
+ *
+ * Fills @a buf with as many packed directory entries (vfs_dirent_t) as fit,
+ * starting with the entry at @a pos. The @c next field of the last entry
+ * is the position to continue reading from. Zero bytes are returned at the
+ * end of the directory.
+ *
+ * @param file          Directory handle
+ * @param pos           Position to read from (zero or a returned @c next)
+ * @param flags         VFS_READDIR_STAT to get type and size of entries
+ * @param buf           Buffer for the entries
+ * @param size          Size of the buffer
+ * @param[out] nread    Number of bytes filled in
+ *
+ * @return              EOK on success, ENOTSUP if the file system cannot
+ *                      read directories in batches, or an error code
+ */
+errno_t vfs_readdir(int file, aoff64_t pos, unsigned flags, void *buf,
+    size_t size, size_t *nread)
+{
+	errno_t rc;
+	ipc_call_t answer;
+	aid_t req;
+
+	if (size > DATA_XFER_LIMIT)
+		size = DATA_XFER_LIMIT;
+
+	async_exch_t *exch = vfs_exchange_begin();
+
+	req = async_send_4(exch, VFS_IN_READDIR, file, LOWER32(pos),
+	    UPPER32(pos), flags, &answer);
+	rc = async_data_read_start(exch, buf, size);
+
+	vfs_exchange_end(exch);
+
+	if (rc == EOK)
+		async_wait_for(req, &rc);
+	else
+		async_forget(req);
+
+	if (rc != EOK)
+		return rc;
+
+	*nread = ipc_get_arg1(&answer);
+	return EOK;
+}
+
+/** Get the number of read requests kept in flight for large transfers
+ *
+ * @return              Number of requests
+ */
+unsigned vfs_read_depth_get(void)
+{
+	return vfs_read_depth;
+}
+
+/** Set the number of read requests kept in flight for large transfers
+ *
+ * vfs_read() splits transfers larger than DATA_XFER_LIMIT into requests
+ * which are sent without waiting for each other. A depth of one disables
+ * the large-transfer mode.
+ *
+ * @param depth         Number of requests, between 1 and VFS_READ_DEPTH_MAX
+ */
+void vfs_read_depth_set(unsigned depth)
+{
+	vfs_read_depth = max(1, min(depth, VFS_READ_DEPTH_MAX));
+}
+
 /** Rename a file or directory
  *
  * There is no file-handle-based variant to disallow attempts to introduce loops
@@ -44,6 +44,8 @@
 /** Opaque hash table link type. */
 typedef struct ht_link {
 	link_t link;
+	/** Hash of the item's lookup key, cached by the table on insertion. */
+	size_t hash;
 } ht_link_t;
 
 /** Set of operations for hash table. */
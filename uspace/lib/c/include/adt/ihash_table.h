@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libc
+ * @{
+ */
+/** @file
+ */
+
+#ifndef _LIBC_IHASH_TABLE_H_
+#define _LIBC_IHASH_TABLE_H_
+
+#include <adt/hash_table.h>
+#include <adt/list.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/** Incrementally resized hash table structure.
+ *
+ * Uses the same items (ht_link_t) and operations (hash_table_ops_t)
+ * as hash_table_t.
+ */
+typedef struct {
+	hash_table_ops_t *op;
+	/** Buckets, the number of buckets is a power of two. */
+	list_t *bucket;
+	size_t bucket_cnt;
+	/** Buckets being migrated to @c bucket or NULL if not resizing. */
+	list_t *old_bucket;
+	size_t old_bucket_cnt;
+	/** Index of the first old bucket which has not been migrated yet. */
+	size_t migrate_idx;
+	size_t full_item_cnt;
+	size_t item_cnt;
+	size_t max_load;
+	bool apply_ongoing;
+} ihash_table_t;
+
+extern bool ihash_table_create(ihash_table_t *, size_t, size_t,
+    hash_table_ops_t *);
+extern void ihash_table_destroy(ihash_table_t *);
+
+extern bool ihash_table_empty(ihash_table_t *);
+extern size_t ihash_table_size(ihash_table_t *);
+
+extern void ihash_table_clear(ihash_table_t *);
+extern void ihash_table_insert(ihash_table_t *, ht_link_t *);
+extern bool ihash_table_insert_unique(ihash_table_t *, ht_link_t *);
+extern ht_link_t *ihash_table_find(const ihash_table_t *, const void *);
+extern ht_link_t *ihash_table_find_next(const ihash_table_t *, ht_link_t *,
+    ht_link_t *);
+extern size_t ihash_table_remove(ihash_table_t *, const void *);
+extern void ihash_table_remove_item(ihash_table_t *, ht_link_t *);
+extern void ihash_table_apply(ihash_table_t *, bool (*)(ht_link_t *, void *),
+    void *);
+
+#endif
+
+/** @}
+ */
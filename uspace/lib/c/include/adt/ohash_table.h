@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libc
+ * @{
+ */
+/** @file
+ */
+
+#ifndef _LIBC_OHASH_TABLE_H_
+#define _LIBC_OHASH_TABLE_H_
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/** Set of operations for open addressing hash table. */
+typedef struct {
+	/** Returns the lookup key of the item. */
+	const void *(*key)(const void *item);
+
+	/** Returns the hash of the key. */
+	size_t (*key_hash)(const void *key);
+
+	/** Returns true if the keys are equal. */
+	bool (*key_equal)(const void *key1, const void *key2);
+} ohash_table_ops_t;
+
+/** Open addressing hash table slot. */
+typedef struct {
+	/** Hash of the item's key */
+	size_t hash;
+	/** Item or NULL if the slot is free */
+	void *item;
+} ohash_slot_t;
+
+/** Open addressing hash table structure.
+ *
+ * Unlike hash_table_t, the table stores pointers to the items, which
+ * do not need to contain any link.
+ */
+typedef struct {
+	const ohash_table_ops_t *op;
+	/** Slots, the number of slots is a power of two. */
+	ohash_slot_t *slot;
+	size_t slot_cnt;
+	size_t item_cnt;
+} ohash_table_t;
+
+extern errno_t ohash_table_create(ohash_table_t *, size_t,
+    const ohash_table_ops_t *);
+extern void ohash_table_destroy(ohash_table_t *);
+
+extern bool ohash_table_empty(ohash_table_t *);
+extern size_t ohash_table_size(ohash_table_t *);
+
+extern void ohash_table_clear(ohash_table_t *);
+extern errno_t ohash_table_insert(ohash_table_t *, void *);
+extern void *ohash_table_find(const ohash_table_t *, const void *);
+extern void *ohash_table_remove(ohash_table_t *, const void *);
+extern void ohash_table_apply(ohash_table_t *, bool (*)(void *, void *),
+    void *);
+
+#endif
+
+/** @}
+ */
@@ -68,6 +68,27 @@ typedef void (*async_port_handler_t)(ipc_call_t *, void *);
 /** Notification handler */
 typedef void (*async_notification_handler_t)(ipc_call_t *, void *);
 
+/** Worker pool for handling connections */
+typedef struct async_pool async_pool_t;
+
+/** Worker pool statistics */
+typedef struct {
+	/** Number of worker fibrils */
+	size_t workers;
+	/** Number of workers running a handler */
+	size_t busy;
+	/** Number of calls and connections waiting for a worker */
+	size_t queued;
+	/** Highest number of waiting calls and connections so far */
+	size_t queued_max;
+	/** Number of waiting items above which connections are refused */
+	size_t queue_limit;
+	/** Number of handled calls */
+	uint64_t handled;
+	/** Number of refused connections */
+	uint64_t refused;
+} async_pool_stats_t;
+
 /** Exchange management style
  *
  */
@@ -105,6 +126,22 @@ struct async_sess;
 typedef struct async_sess async_sess_t;
 typedef struct async_exch async_exch_t;
 
+/** Session exchange statistics */
+typedef struct {
+	/** Number of exchanges started */
+	size_t exchanges;
+	/** Number of exchanges in progress */
+	size_t in_flight;
+	/** Highest number of exchanges in progress at once */
+	size_t in_flight_max;
+	/** Number of exchanges that had to wait before they could start */
+	size_t waits;
+	/** Total time spent waiting for exchanges */
+	usec_t wait_time;
+	/** Longest wait for an exchange */
+	usec_t wait_max;
+} async_sess_stats_t;
+
 extern __noreturn void async_manager(void);
 
 extern bool async_get_call(ipc_call_t *);
@@ -134,6 +171,12 @@ extern void async_put_client_data_by_id(task_id_t);
 extern errno_t async_create_port(iface_t, async_port_handler_t, void *,
     port_id_t *);
 extern void async_set_fallback_port_handler(async_port_handler_t, void *);
+extern errno_t async_pool_create(size_t, size_t, async_pool_t **);
+extern void async_pool_stats_get(async_pool_t *, async_pool_stats_t *);
+extern errno_t async_create_port_pooled(iface_t, async_port_handler_t, void *,
+    async_pool_t *, port_id_t *);
+extern void async_set_fallback_port_handler_pooled(async_port_handler_t,
+    void *, async_pool_t *);
 extern errno_t async_create_callback_port(async_exch_t *, iface_t, sysarg_t,
     sysarg_t, async_port_handler_t, void *, port_id_t *);
 
@@ -285,6 +328,8 @@ extern errno_t async_hangup(async_sess_t *);
 
 extern async_exch_t *async_exchange_begin(async_sess_t *);
 extern void async_exchange_end(async_exch_t *);
+extern void async_sess_exch_limit_set(async_sess_t *, size_t);
+extern void async_sess_stats_get(async_sess_t *, async_sess_stats_t *);
 
 /*
  * FIXME These functions just work around problems with parallel exchange
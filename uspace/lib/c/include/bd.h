@@ -36,14 +36,59 @@
 #define _LIBC_BD_H_
 
 #include <async.h>
+#include <fibril_synch.h>
+#include <ipc/bd.h>
 #include <offset.h>
+#include <stdbool.h>
+
+/** State of a tagged request slot */
+typedef enum {
+	/** Slot is not allocated */
+	bdrs_free,
+	/** Slot is allocated, no request is in flight */
+	bdrs_idle,
+	/** Request has been submitted and has not completed yet */
+	bdrs_pending,
+	/** Request has completed, completion not collected yet */
+	bdrs_done
+} bd_req_state_t;
+
+typedef struct {
+	bd_req_state_t state;
+	/** Completion status */
+	errno_t rc;
+} bd_req_t;
 
 typedef struct {
 	async_sess_t *sess;
+
+	/** Data area shared with the server or @c NULL */
+	void *shm;
+	/** Size of the shared area */
+	size_t shm_size;
+	/** Size of the part of the shared area belonging to one tag */
+	size_t slot_size;
+	/** Negotiated queue depth, i.e. number of request tags */
+	unsigned depth;
+
+	/** Protects @c req */
+	fibril_mutex_t lock;
+	/** Signalled when a request slot is freed */
+	fibril_condvar_t free_cv;
+	/** Signalled when a request completes */
+	fibril_condvar_t done_cv;
+	bd_req_t req[BD_QUEUE_DEPTH_MAX];
 } bd_t;
 
 extern errno_t bd_open(async_sess_t *, bd_t **);
+extern errno_t bd_open_shm(async_sess_t *, unsigned, size_t, bd_t **);
 extern void bd_close(bd_t *);
+extern errno_t bd_req_alloc(bd_t *, bool, unsigned *, void **);
+extern void bd_req_free(bd_t *, unsigned);
+extern errno_t bd_req_read(bd_t *, unsigned, aoff64_t, size_t);
+extern errno_t bd_req_write(bd_t *, unsigned, aoff64_t, size_t);
+extern errno_t bd_req_wait(bd_t *, unsigned);
+extern errno_t bd_req_wait_any(bd_t *, unsigned *, errno_t *);
 extern errno_t bd_read_blocks(bd_t *, aoff64_t, size_t, void *, size_t);
 extern errno_t bd_read_toc(bd_t *, uint8_t, void *, size_t);
 extern errno_t bd_write_blocks(bd_t *, aoff64_t, size_t, const void *, size_t);
@@ -38,6 +38,7 @@
 #include <adt/list.h>
 #include <async.h>
 #include <fibril_synch.h>
+#include <ipc/bd.h>
 #include <stdbool.h>
 #include <offset.h>
 
@@ -47,6 +48,11 @@ typedef struct bd_ops bd_ops_t;
 typedef struct {
 	bd_ops_t *ops;
 	void *sarg;
+	/**
+	 * Number of read/write requests the ops can process concurrently
+	 * for one client. Defaults to one.
+	 */
+	unsigned queue_depth;
 } bd_srvs_t;
 
 /** Server structure (per client session) */
@@ -54,6 +60,22 @@ typedef struct {
 	bd_srvs_t *srvs;
 	async_sess_t *client_sess;
 	void *carg;
+
+	/** Data area shared with the client or @c NULL */
+	void *shm;
+	/** Size of the data slot of one request tag */
+	size_t slot_size;
+	/** Negotiated queue depth */
+	unsigned depth;
+	/** Block size, used to validate tagged requests */
+	size_t block_size;
+
+	/** Protects @c inflight */
+	fibril_mutex_t lock;
+	/** Signalled when a tagged request completes */
+	fibril_condvar_t inflight_cv;
+	/** Number of tagged requests in flight */
+	unsigned inflight;
 } bd_srv_t;
 
 struct bd_ops {
@@ -44,7 +44,9 @@ typedef struct {
 	struct rtld *env;
 } elf_info_t;
 
-extern errno_t elf_load(int, elf_info_t *);
+struct rtld_snapshot;
+
+extern errno_t elf_load(int, struct rtld_snapshot *, elf_info_t *);
 extern void elf_set_pcb(elf_info_t *, pcb_t *);
 
 #endif
@@ -196,6 +196,14 @@ extern errno_t mpsc_send(mpsc_t *, const void *);
 extern errno_t mpsc_receive(mpsc_t *, void *, const struct timespec *);
 extern void mpsc_close(mpsc_t *);
 
+typedef struct mpmc mpmc_t;
+extern mpmc_t *mpmc_create(size_t, size_t);
+extern void mpmc_destroy(mpmc_t *);
+extern errno_t mpmc_try_send(mpmc_t *, const void *);
+extern errno_t mpmc_try_receive(mpmc_t *, void *);
+extern errno_t mpmc_send(mpmc_t *, const void *, const struct timespec *);
+extern errno_t mpmc_receive(mpmc_t *, void *, const struct timespec *);
+
 __HELENOS_DECLS_END;
 
 #endif
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libc
+ * @{
+ */
+/** @file Internet datagram batch
+ */
+
+#ifndef _LIBC_INET_DGBATCH_H_
+#define _LIBC_INET_DGBATCH_H_
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <types/inet.h>
+
+/** Maximum size of an encoded datagram batch.
+ *
+ * A batch always accepts at least one datagram, so a single datagram
+ * may exceed this limit.
+ */
+#define INET_DGBATCH_SIZE_MAX (128 * 1024)
+
+/** Maximum number of datagrams in a batch */
+#define INET_DGBATCH_COUNT_MAX 64
+
+/** Datagram batch.
+ *
+ * Several datagrams packed into one buffer so that they can be
+ * transferred with a single IPC data write.
+ */
+typedef struct {
+	/** Encoded datagrams */
+	void *buf;
+	/** Size of @c buf */
+	size_t bsize;
+	/** Number of bytes used in @c buf */
+	size_t size;
+	/** Number of datagrams in batch */
+	size_t count;
+} inet_dgbatch_t;
+
+extern void inet_dgbatch_init(inet_dgbatch_t *);
+extern void inet_dgbatch_fini(inet_dgbatch_t *);
+extern void inet_dgbatch_clear(inet_dgbatch_t *);
+extern bool inet_dgbatch_fits(inet_dgbatch_t *, size_t);
+extern errno_t inet_dgbatch_add(inet_dgbatch_t *, inet_dgram_t *);
+extern errno_t inet_dgbatch_next(void *, size_t, size_t *, inet_dgram_t *);
+
+#endif
+
+/** @}
+ */
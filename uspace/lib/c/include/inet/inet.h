@@ -36,12 +36,14 @@
 #define _LIBC_INET_INET_H_
 
 #include <inet/addr.h>
+#include <inet/dgbatch.h>
 #include <ipc/loc.h>
 #include <stdint.h>
 #include <types/inet.h>
 
 extern errno_t inet_init(uint8_t, inet_ev_ops_t *);
 extern errno_t inet_send(inet_dgram_t *, uint8_t, inet_df_t);
+extern errno_t inet_send_batch(inet_dgbatch_t *, uint8_t, inet_df_t);
 extern errno_t inet_get_srcaddr(inet_addr_t *, uint8_t, inet_addr_t *);
 
 #endif
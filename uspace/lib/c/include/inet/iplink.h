@@ -46,6 +46,16 @@ typedef struct {
 	void *arg;
 } iplink_t;
 
+/** Offload computations performed by an IP link */
+typedef enum {
+	/**
+	 * TCP and UDP checksums of unfragmented datagrams are completed by
+	 * the link. The checksum field only needs to contain the checksum
+	 * of the pseudo-header (not complemented).
+	 */
+	IPLINK_OFFLOAD_CSUM_TX = 0x1
+} iplink_offload_t;
+
 /** IPv4 link Service Data Unit */
 typedef struct {
 	/** Local source address */
@@ -58,6 +68,19 @@ typedef struct {
 	size_t size;
 } iplink_sdu_t;
 
+/** Maximum number of SDUs sent with a single iplink_send_batch() call */
+#define IPLINK_SEND_BATCH_MAX 64
+
+/** IPv4 link Service Data Unit descriptor used for batched transfer */
+typedef struct {
+	/** Local source address */
+	addr32_t src;
+	/** Local destination address */
+	addr32_t dest;
+	/** Size of serialized IP packet in bytes */
+	size_t size;
+} iplink_sdu_desc_t;
+
 /** IPv6 link Service Data Unit */
 typedef struct {
 	/** Local MAC destination address */
@@ -85,9 +108,11 @@ extern errno_t iplink_open(async_sess_t *, iplink_ev_ops_t *, void *, iplink_t *
 extern void iplink_close(iplink_t *);
 extern errno_t iplink_send(iplink_t *, iplink_sdu_t *);
 extern errno_t iplink_send6(iplink_t *, iplink_sdu6_t *);
+extern errno_t iplink_send_batch(iplink_t *, iplink_sdu_t *, size_t);
 extern errno_t iplink_addr_add(iplink_t *, inet_addr_t *);
 extern errno_t iplink_addr_remove(iplink_t *, inet_addr_t *);
 extern errno_t iplink_get_mtu(iplink_t *, size_t *);
+extern errno_t iplink_get_offload(iplink_t *, uint32_t *);
 extern errno_t iplink_get_mac48(iplink_t *, addr48_t *);
 extern errno_t iplink_set_mac48(iplink_t *, addr48_t);
 extern void *iplink_get_userptr(iplink_t *);
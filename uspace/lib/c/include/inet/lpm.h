@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libc
+ * @{
+ */
+/** @file Longest prefix match table
+ */
+
+#ifndef _LIBC_INET_LPM_H_
+#define _LIBC_INET_LPM_H_
+
+#include <errno.h>
+#include <inet/addr.h>
+#include <stddef.h>
+
+typedef struct inet_lpm_node inet_lpm_node_t;
+
+/** Longest prefix match table.
+ *
+ * Maps network prefixes to arbitrary values. IPv4 and IPv6 prefixes
+ * are kept in separate path-compressed binary tries, so a lookup visits
+ * at most one node per distinct prefix length on the path to the address.
+ */
+typedef struct {
+	/** Root of the IPv4 trie */
+	inet_lpm_node_t *root4;
+	/** Root of the IPv6 trie */
+	inet_lpm_node_t *root6;
+	/** Number of prefixes in the table */
+	size_t count;
+} inet_lpm_t;
+
+extern void inet_lpm_init(inet_lpm_t *);
+extern void inet_lpm_fini(inet_lpm_t *);
+extern errno_t inet_lpm_insert(inet_lpm_t *, const inet_naddr_t *, void *);
+extern errno_t inet_lpm_remove(inet_lpm_t *, const inet_naddr_t *);
+extern void *inet_lpm_find(inet_lpm_t *, const inet_naddr_t *);
+extern void *inet_lpm_lookup(inet_lpm_t *, const inet_addr_t *);
+
+#endif
+
+/** @}
+ */
@@ -43,9 +43,20 @@ typedef enum {
 	BD_READ_BLOCKS,
 	BD_SYNC_CACHE,
 	BD_WRITE_BLOCKS,
-	BD_READ_TOC
+	BD_READ_TOC,
+	BD_SHM_SETUP,
+	BD_REQ_READ,
+	BD_REQ_WRITE
 } bd_request_t;
 
+/** Events on block device callback port */
+typedef enum {
+	BD_EV_REQ_DONE = IPC_FIRST_USER_METHOD
+} bd_event_t;
+
+/** Maximum number of tagged requests a client can have in flight */
+#define BD_QUEUE_DEPTH_MAX	32
+
 #endif
 
 /** @}
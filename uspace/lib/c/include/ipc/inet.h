@@ -42,12 +42,14 @@ typedef enum {
 	INET_CALLBACK_CREATE = IPC_FIRST_USER_METHOD,
 	INET_GET_SRCADDR,
 	INET_SEND,
+	INET_SEND_BATCH,
 	INET_SET_PROTO
 } inet_request_t;
 
 /** Events on Inet default port */
 typedef enum {
-	INET_EV_RECV = IPC_FIRST_USER_METHOD
+	INET_EV_RECV = IPC_FIRST_USER_METHOD,
+	INET_EV_RECV_BATCH
 } inet_event_t;
 
 /** Requests on Inet configuration port */
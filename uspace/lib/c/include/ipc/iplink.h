@@ -43,8 +43,10 @@ typedef enum {
 	IPLINK_SET_MAC48,
 	IPLINK_SEND,
 	IPLINK_SEND6,
+	IPLINK_SEND_BATCH,
 	IPLINK_ADDR_ADD,
-	IPLINK_ADDR_REMOVE
+	IPLINK_ADDR_REMOVE,
+	IPLINK_GET_OFFLOAD
 } iplink_request_t;
 
 typedef enum {
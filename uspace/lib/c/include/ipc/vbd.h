@@ -44,7 +44,9 @@ typedef enum {
 	VBD_PART_GET_INFO,
 	VBD_PART_CREATE,
 	VBD_PART_DELETE,
-	VBD_SUGGEST_PTYPE
+	VBD_SUGGEST_PTYPE,
+	VBD_DISK_STATS,
+	VBD_DISK_SCHED_SET
 } vbd_request_t;
 
 #endif
@@ -77,6 +77,7 @@ typedef enum {
 	VFS_IN_OPEN,
 	VFS_IN_PUT,
 	VFS_IN_READ,
+	VFS_IN_READDIR,
 	VFS_IN_REGISTER,
 	VFS_IN_RENAME,
 	VFS_IN_RESIZE,
@@ -100,6 +101,7 @@ typedef enum {
 	VFS_OUT_MOUNTED,
 	VFS_OUT_OPEN_NODE,
 	VFS_OUT_READ,
+	VFS_OUT_READDIR,
 	VFS_OUT_STAT,
 	VFS_OUT_STATFS,
 	VFS_OUT_SYNC,
@@ -183,6 +185,53 @@ enum {
 	VFS_MOUNT_NO_REF = 4,
 };
 
+/*
+ * Directory reading.
+ */
+
+/** Fill in the type and size of each directory entry */
+#define VFS_READDIR_STAT	1
+
+/** Type of a directory entry */
+typedef enum {
+	/** Type not known without looking at the node */
+	VFS_DIRENT_UNKNOWN,
+	VFS_DIRENT_FILE,
+	VFS_DIRENT_DIRECTORY
+} vfs_dirent_type_t;
+
+/** Directory entry as returned by VFS_IN_READDIR.
+ *
+ * Entries are packed one after another, each starting at an eight-byte
+ * aligned offset.
+ */
+typedef struct {
+	/** Position of the following entry, reading can be resumed from here */
+	uint64_t next;
+	/** Size of the node, valid only with VFS_READDIR_STAT */
+	uint64_t size;
+	/** Length of the whole record including the name and padding */
+	uint16_t reclen;
+	/** Entry type (vfs_dirent_type_t) */
+	uint8_t type;
+	uint8_t reserved;
+	/** Null-terminated name */
+	char name[];
+} vfs_dirent_t;
+
+/*
+ * Memory mapped files.
+ *
+ * A file mapping is an address space area paged by the VFS pager. The
+ * first pager object ID is the file handle, the second one holds the
+ * VFS_PAGER_* flags and the third one the file offset in pages.
+ */
+
+/** Writable shared mapping, pages are written back to the file */
+#define VFS_PAGER_SHARED_WRITE	1
+/** Writable private mapping, each task gets its own copy of the pages */
+#define VFS_PAGER_PRIVATE	2
+
 enum {
 	MODE_READ = 1,
 	MODE_WRITE = 2,
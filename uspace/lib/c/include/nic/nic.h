@@ -75,6 +75,28 @@
 #define NIC_DEFECTIVE_BAD_TCP_CHECKSUM   0x0080
 #define NIC_DEFECTIVE_BAD_UDP_CHECKSUM   0x0100
 
+/* Offload computations (see nic_offload_probe() and nic_offload_set()) */
+#define NIC_OFFLOAD_IPV4_CSUM_TX  0x0001
+#define NIC_OFFLOAD_IPV4_CSUM_RX  0x0002
+#define NIC_OFFLOAD_TCP_CSUM_TX   0x0004
+#define NIC_OFFLOAD_TCP_CSUM_RX   0x0008
+#define NIC_OFFLOAD_UDP_CSUM_TX   0x0010
+#define NIC_OFFLOAD_UDP_CSUM_RX   0x0020
+
+/** All receive checksum offloads */
+#define NIC_OFFLOAD_CSUM_RX \
+	(NIC_OFFLOAD_IPV4_CSUM_RX | NIC_OFFLOAD_TCP_CSUM_RX | \
+	NIC_OFFLOAD_UDP_CSUM_RX)
+
+/**
+ * TCP and UDP transmit checksum offloads. While they are active, the client
+ * fills the checksum field of TCP and UDP segments in unfragmented IP
+ * datagrams with the checksum of the pseudo-header only (not complemented)
+ * and the NIC completes it.
+ */
+#define NIC_OFFLOAD_CSUM_TX \
+	(NIC_OFFLOAD_TCP_CSUM_TX | NIC_OFFLOAD_UDP_CSUM_TX)
+
 /**
  * The bitmap uses single bit for each of the 2^12 = 4096 possible VLAN tags.
  * This means its size is 4096/8 = 512 bytes.
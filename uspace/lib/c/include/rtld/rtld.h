@@ -42,10 +42,13 @@
 #include <tls.h>
 #include <types/rtld/rtld.h>
 
+struct rtld_snapshot;
+
 extern rtld_t *runtime_env;
 
 extern errno_t rtld_init_static(void);
-extern errno_t rtld_prog_process(elf_finfo_t *, rtld_t **);
+extern errno_t rtld_prog_process(elf_finfo_t *, struct rtld_snapshot *,
+    rtld_t **);
 extern tcb_t *rtld_tls_make(rtld_t *);
 extern unsigned long rtld_get_next_id(rtld_t *);
 extern void *rtld_tls_get_addr(rtld_t *, tcb_t *, unsigned long, unsigned long);
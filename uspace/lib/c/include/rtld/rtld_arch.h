@@ -43,6 +43,7 @@ void module_process_pre_arch(module_t *m);
 void rel_table_process(module_t *m, elf_rel_t *rt, size_t rt_size);
 void rela_table_process(module_t *m, elf_rela_t *rt, size_t rt_size);
 void *func_get_addr(elf_symbol_t *, module_t *);
+bool module_plt_lazy_arch(module_t *m);
 
 void program_run(void *entry, pcb_t *pcb);
 
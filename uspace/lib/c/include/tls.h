@@ -71,6 +71,7 @@ extern tcb_t *tls_make(const void *);
 extern tcb_t *tls_make_initial(const void *);
 extern tcb_t *tls_alloc_arch(size_t, size_t);
 extern void tls_free(tcb_t *);
+extern bool tls_reset(tcb_t *);
 extern void tls_free_arch(tcb_t *, size_t, size_t);
 extern void *tls_get(void);
 
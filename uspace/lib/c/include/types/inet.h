@@ -56,8 +56,16 @@ typedef struct {
 	errno_t (*recv)(inet_dgram_t *);
 } inet_ev_ops_t;
 
+/** Datagram transmission flags */
 typedef enum {
-	INET_DF = 1
+	/** Do not fragment */
+	INET_DF = 1,
+	/**
+	 * The TCP or UDP checksum field contains only the checksum of the
+	 * pseudo-header (not complemented). The checksum is completed by
+	 * the Internet service or by the link.
+	 */
+	INET_CSUM_PARTIAL = 2
 } inet_df_t;
 
 #endif
@@ -36,13 +36,36 @@
 #define _LIBC_TYPES_RTLD_MODULE_H_
 
 #include <adt/list.h>
+#include <ipc/loc.h>
+#include <ipc/vfs.h>
+#include <offset.h>
 #include <stddef.h>
+#include <stdint.h>
 
 typedef enum {
 	/** Do not export symbols to global namespace */
 	mlf_local = 0x1
 } mlflags_t;
 
+struct module;
+
+/** Cached definition of a symbol referenced by a module */
+typedef struct {
+	/** Symbol definition or @c NULL if not resolved yet */
+	elf_symbol_t *def;
+	/** Module containing the definition */
+	struct module *mod;
+} module_symcache_t;
+
+/** Identity of the file a module has been loaded from */
+typedef struct {
+	service_id_t service_id;
+	fs_index_t index;
+	aoff64_t size;
+	/** Modification stamp, zero if not known */
+	uint64_t mtime;
+} module_file_t;
+
 /** Dynamically linked module */
 typedef struct module {
 	/** Module ID */
@@ -51,6 +74,10 @@ typedef struct module {
 	dyn_info_t dyn;
 	/** Load bias */
 	size_t bias;
+	/** ELF file header in memory */
+	void *base;
+	/** File the module has been loaded from (if recorded) */
+	module_file_t file;
 
 	/** tdata image start */
 	void *tdata;
@@ -71,16 +98,26 @@ typedef struct module {
 	/** Number of fields in deps */
 	size_t n_deps;
 
+	/** The module and its dependencies in breadth-first order or @c NULL */
+	struct module **scope;
+	/** Number of fields in scope */
+	size_t n_scope;
+
+	/** Definitions of the symbols used by relocations or @c NULL */
+	module_symcache_t *symcache;
+	/** Number of entries in the symbol table of the module */
+	size_t n_syms;
+
 	/** True iff relocations have already been processed in this module. */
 	bool relocated;
+	/** True iff PLT entries are bound on first call */
+	bool plt_lazy;
 
 	/** Link to list of all modules in runtime environment */
 	link_t modules_link;
 	/** Link to list of initial modules */
 	link_t imodules_link;
 
-	/** Link to BFS queue. Only used when doing a BFS of the module graph */
-	link_t queue_link;
 	/** Tag for modules already processed during a BFS */
 	bool bfs_tag;
 	/** If @c true, does not export symbols to global namespace */
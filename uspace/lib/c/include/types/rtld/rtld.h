@@ -37,6 +37,7 @@
 
 #include <adt/list.h>
 #include <elf/elf_mod.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
@@ -60,6 +61,9 @@ typedef struct rtld {
 
 	/** List of initial modules */
 	list_t imodules;
+
+	/** Record module files so that the image can be snapshotted */
+	bool snapshot;
 } rtld_t;
 
 #endif
@@ -39,6 +39,8 @@
 #include <loc.h>
 #include <types/label.h>
 #include <offset.h>
+#include <stdbool.h>
+#include <stdint.h>
 
 /** VBD service */
 typedef struct vbd {
@@ -62,6 +64,34 @@ typedef struct {
 	aoff64_t nblocks;
 } vbd_disk_info_t;
 
+/** Disk I/O statistics */
+typedef struct {
+	/** I/O scheduler is enabled */
+	bool sched;
+	/** Number of read requests */
+	uint64_t reads;
+	/** Number of write requests */
+	uint64_t writes;
+	/** Number of requests sent to the disk */
+	uint64_t dispatched;
+	/** Number of requests merged into an adjacent request */
+	uint64_t merged;
+	/** Number of requests dispatched because their deadline expired */
+	uint64_t expired;
+	/** Number of requests waiting in the scheduler queue */
+	unsigned queued;
+	/** Maximum number of requests waiting in the scheduler queue */
+	unsigned queued_max;
+	/** Number of requests in flight to the disk */
+	unsigned inflight;
+	/** Maximum number of requests in flight to the disk */
+	unsigned inflight_max;
+	/** Sum of request latencies in microseconds */
+	uint64_t lat_total_us;
+	/** Maximum request latency in microseconds */
+	uint64_t lat_max_us;
+} vbd_disk_stats_t;
+
 /** Specification of new partition */
 typedef struct {
 	/** Partition index */
@@ -98,6 +128,8 @@ extern errno_t vbd_create(vbd_t **);
 extern void vbd_destroy(vbd_t *);
 extern errno_t vbd_get_disks(vbd_t *, service_id_t **, size_t *);
 extern errno_t vbd_disk_info(vbd_t *, service_id_t, vbd_disk_info_t *);
+extern errno_t vbd_disk_stats(vbd_t *, service_id_t, vbd_disk_stats_t *);
+extern errno_t vbd_disk_sched_set(vbd_t *, service_id_t, bool);
 extern errno_t vbd_label_create(vbd_t *, service_id_t, label_type_t);
 extern errno_t vbd_label_delete(vbd_t *, service_id_t);
 extern errno_t vbd_label_get_parts(vbd_t *, service_id_t, service_id_t **,
@@ -44,6 +44,9 @@
 #include <async.h>
 #include <offset.h>
 
+/** Maximum number of read requests kept in flight by vfs_read() */
+#define VFS_READ_DEPTH_MAX  8
+
 enum vfs_change_state_type {
 	VFS_PASS_HANDLE
 };
@@ -62,6 +65,8 @@ typedef struct {
 	bool is_directory;
 	aoff64_t size;
 	service_id_t service;
+	/** Modification stamp in microseconds, zero if not supported */
+	uint64_t mtime;
 } vfs_stat_t;
 
 typedef struct {
@@ -93,6 +98,7 @@ extern errno_t vfs_link(int, const char *, vfs_file_kind_t, int *);
 extern errno_t vfs_link_path(const char *, vfs_file_kind_t, int *);
 extern errno_t vfs_lookup(const char *, int, int *);
 extern errno_t vfs_lookup_open(const char *, int, int, int *);
+extern errno_t vfs_map(int, aoff64_t, size_t, unsigned int, bool, void **);
 extern errno_t vfs_mount_path(const char *, const char *, const char *,
     const char *, unsigned int, unsigned int);
 extern errno_t vfs_mount(int, const char *, service_id_t, const char *, unsigned,
@@ -102,6 +108,10 @@ extern errno_t vfs_pass_handle(async_exch_t *, int, async_exch_t *);
 extern errno_t vfs_put(int);
 extern errno_t vfs_read(int, aoff64_t *, void *, size_t, size_t *);
 extern errno_t vfs_read_short(int, aoff64_t, void *, size_t, ssize_t *);
+extern errno_t vfs_readdir(int, aoff64_t, unsigned, void *, size_t,
+    size_t *);
+extern unsigned vfs_read_depth_get(void);
+extern void vfs_read_depth_set(unsigned);
 extern errno_t vfs_receive_handle(bool, int *);
 extern errno_t vfs_rename_path(const char *, const char *);
 extern errno_t vfs_resize(int, aoff64_t);
@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <adt/ihash_table.h>
+#include <pcut/pcut.h>
+#include <stdlib.h>
+
+/** Test entry */
+typedef struct {
+	ht_link_t link;
+	int key;
+	bool removed;
+} test_entry_t;
+
+enum {
+	/** Number of test entries, enough to make the table resize */
+	test_entry_cnt = 1000
+};
+
+static size_t test_key_hash(const void *key)
+{
+	return *(const int *) key;
+}
+
+static size_t test_hash(const ht_link_t *item)
+{
+	test_entry_t *e = hash_table_get_inst(item, test_entry_t, link);
+	return test_key_hash(&e->key);
+}
+
+static bool test_equal(const ht_link_t *item1, const ht_link_t *item2)
+{
+	test_entry_t *e1 = hash_table_get_inst(item1, test_entry_t, link);
+	test_entry_t *e2 = hash_table_get_inst(item2, test_entry_t, link);
+	return e1->key == e2->key;
+}
+
+static bool test_key_equal(const void *key, const ht_link_t *item)
+{
+	test_entry_t *e = hash_table_get_inst(item, test_entry_t, link);
+	return *(const int *) key == e->key;
+}
+
+static void test_remove_callback(ht_link_t *item)
+{
+	test_entry_t *e = hash_table_get_inst(item, test_entry_t, link);
+	e->removed = true;
+}
+
+static hash_table_ops_t test_ops = {
+	.hash = test_hash,
+	.key_hash = test_key_hash,
+	.equal = test_equal,
+	.key_equal = test_key_equal,
+	.remove_callback = test_remove_callback
+};
+
+static test_entry_t entries[test_entry_cnt];
+
+/** Count items visited by ihash_table_apply(). */
+static bool test_count(ht_link_t *item, void *arg)
+{
+	size_t *cnt = arg;
+	++*cnt;
+	return true;
+}
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(ihash_table);
+
+/** Items can be found while the table grows and shrinks. */
+PCUT_TEST(insert_find_remove)
+{
+	ihash_table_t h;
+	ht_link_t *item;
+	size_t cnt;
+	int i, key;
+
+	PCUT_ASSERT_TRUE(ihash_table_create(&h, 0, 0, &test_ops));
+	PCUT_ASSERT_TRUE(ihash_table_empty(&h));
+
+	for (i = 0; i < test_entry_cnt; i++) {
+		entries[i].key = i;
+		entries[i].removed = false;
+		PCUT_ASSERT_TRUE(ihash_table_insert_unique(&h, &entries[i].link));
+
+		/* Every item inserted so far must be found. */
+		for (key = 0; key <= i; key += 1 + i / 16) {
+			item = ihash_table_find(&h, &key);
+			PCUT_ASSERT_TRUE(item == &entries[key].link);
+		}
+	}
+
+	PCUT_ASSERT_INT_EQUALS(test_entry_cnt, ihash_table_size(&h));
+
+	/* Duplicates are rejected. */
+	PCUT_ASSERT_FALSE(ihash_table_insert_unique(&h, &entries[0].link));
+
+	cnt = 0;
+	ihash_table_apply(&h, test_count, &cnt);
+	PCUT_ASSERT_INT_EQUALS(test_entry_cnt, cnt);
+
+	for (i = 0; i < test_entry_cnt; i += 2) {
+		PCUT_ASSERT_INT_EQUALS(1, ihash_table_remove(&h, &i));
+		PCUT_ASSERT_TRUE(entries[i].removed);
+	}
+
+	for (i = 0; i < test_entry_cnt; i++) {
+		item = ihash_table_find(&h, &i);
+		if (i % 2 == 0)
+			PCUT_ASSERT_NULL(item);
+		else
+			PCUT_ASSERT_TRUE(item == &entries[i].link);
+	}
+
+	for (i = 1; i < test_entry_cnt; i += 2)
+		ihash_table_remove_item(&h, &entries[i].link);
+
+	PCUT_ASSERT_TRUE(ihash_table_empty(&h));
+	ihash_table_destroy(&h);
+}
+
+/** Items with equal keys can be enumerated. */
+PCUT_TEST(find_next)
+{
+	ihash_table_t h;
+	ht_link_t *first;
+	ht_link_t *item;
+	int i, key, cnt;
+
+	PCUT_ASSERT_TRUE(ihash_table_create(&h, 0, 0, &test_ops));
+
+	for (i = 0; i < test_entry_cnt; i++) {
+		entries[i].key = i % 10;
+		entries[i].removed = false;
+		ihash_table_insert(&h, &entries[i].link);
+	}
+
+	for (key = 0; key < 10; key++) {
+		cnt = 0;
+		first = ihash_table_find(&h, &key);
+		item = first;
+		while (item != NULL) {
+			PCUT_ASSERT_INT_EQUALS(key, hash_table_get_inst(item,
+			    test_entry_t, link)->key);
+			++cnt;
+			item = ihash_table_find_next(&h, first, item);
+		}
+
+		PCUT_ASSERT_INT_EQUALS(test_entry_cnt / 10, cnt);
+	}
+
+	ihash_table_clear(&h);
+	PCUT_ASSERT_TRUE(ihash_table_empty(&h));
+	for (i = 0; i < test_entry_cnt; i++)
+		PCUT_ASSERT_TRUE(entries[i].removed);
+
+	ihash_table_destroy(&h);
+}
+
+PCUT_EXPORT(ihash_table);
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <adt/ohash_table.h>
+#include <pcut/pcut.h>
+
+/** Test entry */
+typedef struct {
+	int key;
+} test_entry_t;
+
+enum {
+	/** Number of test entries, enough to make the table resize */
+	test_entry_cnt = 1000
+};
+
+static const void *test_key(const void *item)
+{
+	const test_entry_t *e = item;
+	return &e->key;
+}
+
+static size_t test_key_hash(const void *key)
+{
+	return *(const int *) key;
+}
+
+static bool test_key_equal(const void *key1, const void *key2)
+{
+	return *(const int *) key1 == *(const int *) key2;
+}
+
+static const ohash_table_ops_t test_ops = {
+	.key = test_key,
+	.key_hash = test_key_hash,
+	.key_equal = test_key_equal
+};
+
+static test_entry_t entries[test_entry_cnt];
+
+/** Count items visited by ohash_table_apply(). */
+static bool test_count(void *item, void *arg)
+{
+	size_t *cnt = arg;
+	++*cnt;
+	return true;
+}
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(ohash_table);
+
+/** Items can be found while the table grows and shrinks. */
+PCUT_TEST(insert_find_remove)
+{
+	ohash_table_t h;
+	size_t cnt;
+	int i;
+
+	PCUT_ASSERT_ERRNO_VAL(EOK, ohash_table_create(&h, 0, &test_ops));
+	PCUT_ASSERT_TRUE(ohash_table_empty(&h));
+
+	for (i = 0; i < test_entry_cnt; i++) {
+		entries[i].key = i;
+		PCUT_ASSERT_ERRNO_VAL(EOK, ohash_table_insert(&h, &entries[i]));
+	}
+
+	PCUT_ASSERT_INT_EQUALS(test_entry_cnt, ohash_table_size(&h));
+	PCUT_ASSERT_ERRNO_VAL(EEXIST, ohash_table_insert(&h, &entries[0]));
+
+	cnt = 0;
+	ohash_table_apply(&h, test_count, &cnt);
+	PCUT_ASSERT_INT_EQUALS(test_entry_cnt, cnt);
+
+	for (i = 0; i < test_entry_cnt; i++)
+		PCUT_ASSERT_TRUE(ohash_table_find(&h, &i) == &entries[i]);
+
+	/* Removal must not break the probe sequences of other items. */
+	for (i = 0; i < test_entry_cnt; i += 3)
+		PCUT_ASSERT_TRUE(ohash_table_remove(&h, &i) == &entries[i]);
+
+	for (i = 0; i < test_entry_cnt; i++) {
+		if (i % 3 == 0)
+			PCUT_ASSERT_NULL(ohash_table_find(&h, &i));
+		else
+			PCUT_ASSERT_TRUE(ohash_table_find(&h, &i) == &entries[i]);
+	}
+
+	for (i = 0; i < test_entry_cnt; i++) {
+		if (i % 3 != 0)
+			PCUT_ASSERT_TRUE(ohash_table_remove(&h, &i) == &entries[i]);
+	}
+
+	PCUT_ASSERT_TRUE(ohash_table_empty(&h));
+	PCUT_ASSERT_NULL(ohash_table_remove(&h, &i));
+
+	ohash_table_destroy(&h);
+}
+
+PCUT_EXPORT(ohash_table);
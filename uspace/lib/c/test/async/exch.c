@@ -0,0 +1,299 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <async.h>
+#include <errno.h>
+#include <fibril.h>
+#include <fibril_synch.h>
+#include <ipc/services.h>
+#include <loc.h>
+#include <pcut/pcut.h>
+#include <stdbool.h>
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(async_exch);
+
+static const char *test_exch_server = "test-async-exch";
+static const char *test_exch_svc = "test/async-exch";
+
+/*
+ * Any interface with parallel exchange management will do, the test server
+ * does not care.
+ */
+#define TEST_EXCH_IFACE INTERFACE_VFS
+
+enum {
+	TEST_EXCH_HOLD = IPC_FIRST_USER_METHOD,
+	TEST_EXCH_CLIENTS = 3
+};
+
+/** Test server */
+typedef struct {
+	fibril_mutex_t lock;
+	fibril_condvar_t cv;
+	/** Refuse new connections */
+	bool refuse;
+	/** Answer held calls */
+	bool release;
+	/** Number of calls being held */
+	int held;
+	/** Highest number of calls held at once */
+	int held_max;
+} test_exch_srv_t;
+
+/** Test client fibril */
+typedef struct {
+	async_sess_t *sess;
+	fibril_semaphore_t *done;
+	errno_t rc;
+} test_exch_client_t;
+
+static void test_exch_conn(ipc_call_t *icall, void *arg)
+{
+	test_exch_srv_t *srv = (test_exch_srv_t *) arg;
+	ipc_call_t call;
+
+	fibril_mutex_lock(&srv->lock);
+	bool refuse = srv->refuse;
+	fibril_mutex_unlock(&srv->lock);
+
+	if (refuse) {
+		async_answer_0(icall, ENOENT);
+		return;
+	}
+
+	async_accept_0(icall);
+
+	while (true) {
+		async_get_call(&call);
+
+		if (!ipc_get_imethod(&call)) {
+			async_answer_0(&call, EOK);
+			return;
+		}
+
+		/* Hold the call until the test releases it. */
+		fibril_mutex_lock(&srv->lock);
+
+		srv->held++;
+		if (srv->held > srv->held_max)
+			srv->held_max = srv->held;
+		fibril_condvar_broadcast(&srv->cv);
+
+		while (!srv->release)
+			fibril_condvar_wait(&srv->cv, &srv->lock);
+
+		srv->held--;
+		fibril_mutex_unlock(&srv->lock);
+
+		async_answer_0(&call, EOK);
+	}
+}
+
+static errno_t test_exch_client(void *arg)
+{
+	test_exch_client_t *client = (test_exch_client_t *) arg;
+
+	async_exch_t *exch = async_exchange_begin(client->sess);
+	if (exch == NULL) {
+		client->rc = ENOMEM;
+	} else {
+		client->rc = async_req_0_0(exch, TEST_EXCH_HOLD);
+		async_exchange_end(exch);
+	}
+
+	fibril_semaphore_up(client->done);
+	return EOK;
+}
+
+/** Register the test server and connect to it. */
+static async_sess_t *test_exch_open(test_exch_srv_t *srv, service_id_t *sid)
+{
+	fibril_mutex_initialize(&srv->lock);
+	fibril_condvar_initialize(&srv->cv);
+	srv->refuse = false;
+	srv->release = false;
+	srv->held = 0;
+	srv->held_max = 0;
+
+	async_set_fallback_port_handler(test_exch_conn, srv);
+
+	// FIXME This causes this test to be non-reentrant!
+	errno_t rc = loc_server_register(test_exch_server);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = loc_service_register(test_exch_svc, sid);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	async_sess_t *sess = loc_service_connect(*sid, TEST_EXCH_IFACE, 0);
+	PCUT_ASSERT_NOT_NULL(sess);
+
+	return sess;
+}
+
+static void test_exch_close(async_sess_t *sess, service_id_t sid)
+{
+	PCUT_ASSERT_ERRNO_VAL(EOK, async_hangup(sess));
+	PCUT_ASSERT_ERRNO_VAL(EOK, loc_service_unregister(sid));
+}
+
+/** Start client fibrils, each holding one exchange in a call. */
+static void test_exch_clients_start(async_sess_t *sess,
+    test_exch_client_t *clients, fibril_semaphore_t *done)
+{
+	fibril_semaphore_initialize(done, 0);
+
+	for (int i = 0; i < TEST_EXCH_CLIENTS; i++) {
+		clients[i].sess = sess;
+		clients[i].done = done;
+		clients[i].rc = EINVAL;
+
+		fid_t fid = fibril_create(test_exch_client, &clients[i]);
+		PCUT_ASSERT_NOT_NULL((void *) fid);
+		fibril_add_ready(fid);
+	}
+}
+
+/** Wait until the server holds @a count calls, or give up after a while. */
+static int test_exch_held_wait(test_exch_srv_t *srv, int count)
+{
+	errno_t rc = EOK;
+
+	fibril_mutex_lock(&srv->lock);
+
+	while (srv->held < count && rc == EOK)
+		rc = fibril_condvar_wait_timeout(&srv->cv, &srv->lock, 1000000);
+
+	int held = srv->held;
+	fibril_mutex_unlock(&srv->lock);
+
+	return held;
+}
+
+/** Release held calls and wait for the clients to finish. */
+static void test_exch_clients_finish(test_exch_srv_t *srv,
+    test_exch_client_t *clients, fibril_semaphore_t *done)
+{
+	fibril_mutex_lock(&srv->lock);
+	srv->release = true;
+	fibril_condvar_broadcast(&srv->cv);
+	fibril_mutex_unlock(&srv->lock);
+
+	for (int i = 0; i < TEST_EXCH_CLIENTS; i++)
+		fibril_semaphore_down(done);
+
+	for (int i = 0; i < TEST_EXCH_CLIENTS; i++)
+		PCUT_ASSERT_ERRNO_VAL(EOK, clients[i].rc);
+}
+
+/** Exchanges of a parallel session without a limit run at the same time. */
+PCUT_TEST(parallel_concurrent)
+{
+	test_exch_srv_t srv;
+	test_exch_client_t clients[TEST_EXCH_CLIENTS];
+	fibril_semaphore_t done;
+	async_sess_stats_t stats;
+	service_id_t sid;
+
+	async_sess_t *sess = test_exch_open(&srv, &sid);
+
+	test_exch_clients_start(sess, clients, &done);
+	PCUT_ASSERT_INT_EQUALS(TEST_EXCH_CLIENTS,
+	    test_exch_held_wait(&srv, TEST_EXCH_CLIENTS));
+	test_exch_clients_finish(&srv, clients, &done);
+
+	async_sess_stats_get(sess, &stats);
+	PCUT_ASSERT_INT_EQUALS(TEST_EXCH_CLIENTS, stats.exchanges);
+	PCUT_ASSERT_INT_EQUALS(0, stats.in_flight);
+	PCUT_ASSERT_INT_EQUALS(TEST_EXCH_CLIENTS, stats.in_flight_max);
+
+	test_exch_close(sess, sid);
+}
+
+/** Exchanges above the limit of a parallel session wait for their turn. */
+PCUT_TEST(parallel_limit)
+{
+	test_exch_srv_t srv;
+	test_exch_client_t clients[TEST_EXCH_CLIENTS];
+	fibril_semaphore_t done;
+	async_sess_stats_t stats;
+	service_id_t sid;
+
+	async_sess_t *sess = test_exch_open(&srv, &sid);
+	async_sess_exch_limit_set(sess, 1);
+
+	test_exch_clients_start(sess, clients, &done);
+	PCUT_ASSERT_INT_EQUALS(1, test_exch_held_wait(&srv, 1));
+
+	/* Give the other clients a chance to get past the limit. */
+	fibril_usleep(10000);
+	PCUT_ASSERT_INT_EQUALS(1, test_exch_held_wait(&srv, 1));
+
+	test_exch_clients_finish(&srv, clients, &done);
+	PCUT_ASSERT_INT_EQUALS(1, srv.held_max);
+
+	async_sess_stats_get(sess, &stats);
+	PCUT_ASSERT_INT_EQUALS(TEST_EXCH_CLIENTS, stats.exchanges);
+	PCUT_ASSERT_INT_EQUALS(1, stats.in_flight_max);
+	PCUT_ASSERT_INT_EQUALS(TEST_EXCH_CLIENTS - 1, stats.waits);
+
+	test_exch_close(sess, sid);
+}
+
+/** Starting an exchange fails if the server refuses the connection. */
+PCUT_TEST(parallel_connect_fail)
+{
+	test_exch_srv_t srv;
+	service_id_t sid;
+
+	async_sess_t *sess = test_exch_open(&srv, &sid);
+	async_sess_exch_limit_set(sess, 1);
+
+	fibril_mutex_lock(&srv.lock);
+	srv.refuse = true;
+	fibril_mutex_unlock(&srv.lock);
+
+	async_exch_t *exch = async_exchange_begin(sess);
+	PCUT_ASSERT_NULL(exch);
+
+	fibril_mutex_lock(&srv.lock);
+	srv.refuse = false;
+	srv.release = true;
+	fibril_mutex_unlock(&srv.lock);
+
+	/* The failed attempt must not count against the limit. */
+	exch = async_exchange_begin(sess);
+	PCUT_ASSERT_NOT_NULL(exch);
+	PCUT_ASSERT_ERRNO_VAL(EOK, async_req_0_0(exch, TEST_EXCH_HOLD));
+	async_exchange_end(exch);
+
+	test_exch_close(sess, sid);
+}
+
+PCUT_EXPORT(async_exch);
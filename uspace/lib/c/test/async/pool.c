@@ -0,0 +1,406 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <abi/ipc/methods.h>
+#include <async.h>
+#include <errno.h>
+#include <fibril.h>
+#include <fibril_synch.h>
+#include <ipc/services.h>
+#include <loc.h>
+#include <ns.h>
+#include <pcut/pcut.h>
+#include <stdbool.h>
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(async_pool);
+
+static const char *test_pool_server = "test-async-pool";
+static const char *test_pool_svc = "test/async-pool";
+
+enum {
+	/** Record a sequence number, arg1 is connection index, arg2 number */
+	TEST_POOL_SEQ = IPC_FIRST_USER_METHOD,
+	/** Keep the worker busy until released */
+	TEST_POOL_HOLD,
+	/** Return next expected sequence number, arg1 is connection index */
+	TEST_POOL_NEXT
+};
+
+enum {
+	TEST_POOL_CONNS = 2,
+	TEST_POOL_MSGS = 100,
+	TEST_POOL_QUEUED = 8
+};
+
+/** Test server */
+typedef struct {
+	fibril_mutex_t lock;
+	fibril_condvar_t cv;
+	/** Worker pool */
+	async_pool_t *pool;
+	/** Next expected sequence number for each connection */
+	sysarg_t next[TEST_POOL_CONNS];
+	/** Number of calls received out of order */
+	int misordered;
+	/** Answer held calls */
+	bool release;
+	/** Number of calls being held */
+	int held;
+	/** Number of hangups received */
+	int hangups;
+} test_pool_srv_t;
+
+/** Test client fibril */
+typedef struct {
+	test_pool_srv_t *srv;
+	service_id_t sid;
+	async_sess_t *sess;
+	fibril_semaphore_t done;
+	errno_t rc;
+} test_pool_client_t;
+
+static void test_pool_conn(ipc_call_t *call, void *arg)
+{
+	test_pool_srv_t *srv = (test_pool_srv_t *) arg;
+	sysarg_t idx = ipc_get_arg1(call);
+	sysarg_t next;
+
+	switch (ipc_get_imethod(call)) {
+	case IPC_M_CONNECT_ME_TO:
+		async_accept_0(call);
+		return;
+	case IPC_M_PHONE_HUNGUP:
+		fibril_mutex_lock(&srv->lock);
+		srv->hangups++;
+		fibril_condvar_broadcast(&srv->cv);
+		fibril_mutex_unlock(&srv->lock);
+		async_answer_0(call, EOK);
+		return;
+	case TEST_POOL_SEQ:
+		if (idx >= TEST_POOL_CONNS) {
+			async_answer_0(call, EINVAL);
+			return;
+		}
+
+		fibril_mutex_lock(&srv->lock);
+		if (ipc_get_arg2(call) != srv->next[idx])
+			srv->misordered++;
+		srv->next[idx]++;
+		fibril_mutex_unlock(&srv->lock);
+
+		/* Let the other worker run. */
+		fibril_yield();
+
+		async_answer_0(call, EOK);
+		return;
+	case TEST_POOL_HOLD:
+		fibril_mutex_lock(&srv->lock);
+
+		srv->held++;
+		fibril_condvar_broadcast(&srv->cv);
+
+		while (!srv->release)
+			fibril_condvar_wait(&srv->cv, &srv->lock);
+
+		srv->held--;
+		fibril_mutex_unlock(&srv->lock);
+
+		async_answer_0(call, EOK);
+		return;
+	case TEST_POOL_NEXT:
+		if (idx >= TEST_POOL_CONNS) {
+			async_answer_0(call, EINVAL);
+			return;
+		}
+
+		fibril_mutex_lock(&srv->lock);
+		next = srv->next[idx];
+		fibril_mutex_unlock(&srv->lock);
+
+		async_answer_1(call, EOK, next);
+		return;
+	default:
+		async_answer_0(call, ENOTSUP);
+		return;
+	}
+}
+
+/** Register the test server handled by a new worker pool. */
+static void test_pool_start(test_pool_srv_t *srv, size_t workers,
+    size_t queue_limit, service_id_t *sid)
+{
+	fibril_mutex_initialize(&srv->lock);
+	fibril_condvar_initialize(&srv->cv);
+	for (int i = 0; i < TEST_POOL_CONNS; i++)
+		srv->next[i] = 0;
+	srv->misordered = 0;
+	srv->release = false;
+	srv->held = 0;
+	srv->hangups = 0;
+
+	/* There is no way to destroy the pool, it leaks. */
+	errno_t rc = async_pool_create(workers, queue_limit, &srv->pool);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	async_set_fallback_port_handler_pooled(test_pool_conn, srv, srv->pool);
+
+	// FIXME This causes this test to be non-reentrant!
+	rc = loc_server_register(test_pool_server);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = loc_service_register(test_pool_svc, sid);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+}
+
+static async_sess_t *test_pool_connect(service_id_t sid, errno_t *rc)
+{
+	return service_connect(SERVICE_LOC, INTERFACE_IPC_TEST, sid, rc);
+}
+
+static errno_t test_pool_holder(void *arg)
+{
+	test_pool_client_t *client = (test_pool_client_t *) arg;
+
+	async_exch_t *exch = async_exchange_begin(client->sess);
+	client->rc = async_req_1_0(exch, TEST_POOL_HOLD, 0);
+	async_exchange_end(exch);
+
+	fibril_semaphore_up(&client->done);
+	return EOK;
+}
+
+static errno_t test_pool_connector(void *arg)
+{
+	test_pool_client_t *client = (test_pool_client_t *) arg;
+
+	client->sess = test_pool_connect(client->sid, &client->rc);
+
+	fibril_semaphore_up(&client->done);
+	return EOK;
+}
+
+/** Keep the only worker busy with a held call on a connection of @a client. */
+static void test_pool_hold(test_pool_srv_t *srv, test_pool_client_t *client)
+{
+	errno_t rc = EOK;
+
+	client->srv = srv;
+	fibril_semaphore_initialize(&client->done, 0);
+
+	fid_t fid = fibril_create(test_pool_holder, client);
+	PCUT_ASSERT_NOT_NULL((void *) fid);
+	fibril_add_ready(fid);
+
+	fibril_mutex_lock(&srv->lock);
+	while (srv->held == 0 && rc == EOK)
+		rc = fibril_condvar_wait_timeout(&srv->cv, &srv->lock, 1000000);
+	fibril_mutex_unlock(&srv->lock);
+
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+}
+
+/** Release the held call and wait for its client. */
+static void test_pool_release(test_pool_srv_t *srv, test_pool_client_t *client)
+{
+	fibril_mutex_lock(&srv->lock);
+	srv->release = true;
+	fibril_condvar_broadcast(&srv->cv);
+	fibril_mutex_unlock(&srv->lock);
+
+	fibril_semaphore_down(&client->done);
+	PCUT_ASSERT_ERRNO_VAL(EOK, client->rc);
+}
+
+/** Wait until the pool has at least @a queued calls waiting for a worker. */
+static size_t test_pool_queued_wait(async_pool_t *pool, size_t queued)
+{
+	async_pool_stats_t stats;
+
+	for (int i = 0; i < 100; i++) {
+		async_pool_stats_get(pool, &stats);
+		if (stats.queued >= queued)
+			break;
+
+		fibril_usleep(10000);
+	}
+
+	return stats.queued;
+}
+
+/** Calls of each connection are handled in the order they were sent. */
+PCUT_TEST(in_order)
+{
+	test_pool_srv_t srv;
+	async_sess_t *sess[TEST_POOL_CONNS];
+	async_exch_t *exch[TEST_POOL_CONNS];
+	async_pool_stats_t stats;
+	service_id_t sid;
+	sysarg_t next;
+	errno_t rc;
+
+	test_pool_start(&srv, 2, 0, &sid);
+
+	for (int i = 0; i < TEST_POOL_CONNS; i++) {
+		sess[i] = test_pool_connect(sid, &rc);
+		PCUT_ASSERT_NOT_NULL(sess[i]);
+		exch[i] = async_exchange_begin(sess[i]);
+		PCUT_ASSERT_NOT_NULL(exch[i]);
+	}
+
+	for (int n = 0; n < TEST_POOL_MSGS; n++) {
+		for (int i = 0; i < TEST_POOL_CONNS; i++)
+			async_msg_2(exch[i], TEST_POOL_SEQ, i, n);
+	}
+
+	for (int i = 0; i < TEST_POOL_CONNS; i++) {
+		rc = async_req_1_1(exch[i], TEST_POOL_NEXT, i, &next);
+		PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+		PCUT_ASSERT_INT_EQUALS(TEST_POOL_MSGS, next);
+
+		async_exchange_end(exch[i]);
+		PCUT_ASSERT_ERRNO_VAL(EOK, async_hangup(sess[i]));
+	}
+
+	PCUT_ASSERT_INT_EQUALS(0, srv.misordered);
+
+	async_pool_stats_get(srv.pool, &stats);
+	PCUT_ASSERT_INT_EQUALS(0, stats.refused);
+
+	PCUT_ASSERT_ERRNO_VAL(EOK, loc_service_unregister(sid));
+}
+
+/** New connections are refused with ELIMIT while the pool is full. */
+PCUT_TEST(limit)
+{
+	test_pool_srv_t srv;
+	test_pool_client_t holder;
+	test_pool_client_t connector;
+	async_pool_stats_t stats;
+	service_id_t sid;
+	errno_t rc;
+
+	test_pool_start(&srv, 1, 1, &sid);
+
+	holder.sess = test_pool_connect(sid, &rc);
+	PCUT_ASSERT_NOT_NULL(holder.sess);
+	test_pool_hold(&srv, &holder);
+
+	/* This connection fills the queue of the pool. */
+	connector.srv = &srv;
+	connector.sid = sid;
+	connector.sess = NULL;
+	fibril_semaphore_initialize(&connector.done, 0);
+
+	fid_t fid = fibril_create(test_pool_connector, &connector);
+	PCUT_ASSERT_NOT_NULL((void *) fid);
+	fibril_add_ready(fid);
+
+	PCUT_ASSERT_INT_EQUALS(1, test_pool_queued_wait(srv.pool, 1));
+
+	/* This one does not fit. */
+	async_sess_t *sess = test_pool_connect(sid, &rc);
+	PCUT_ASSERT_NULL(sess);
+	PCUT_ASSERT_ERRNO_VAL(ELIMIT, rc);
+
+	async_pool_stats_get(srv.pool, &stats);
+	PCUT_ASSERT_INT_EQUALS(1, stats.refused);
+
+	test_pool_release(&srv, &holder);
+
+	/* The queued connection is accepted once the worker is free. */
+	fibril_semaphore_down(&connector.done);
+	PCUT_ASSERT_ERRNO_VAL(EOK, connector.rc);
+	PCUT_ASSERT_NOT_NULL(connector.sess);
+
+	PCUT_ASSERT_ERRNO_VAL(EOK, async_hangup(connector.sess));
+	PCUT_ASSERT_ERRNO_VAL(EOK, async_hangup(holder.sess));
+	PCUT_ASSERT_ERRNO_VAL(EOK, loc_service_unregister(sid));
+}
+
+/** Calls queued before a hangup are still handled, then the hangup. */
+PCUT_TEST(hangup_queued)
+{
+	test_pool_srv_t srv;
+	test_pool_client_t holder;
+	ipc_call_t answer[TEST_POOL_QUEUED];
+	aid_t req[TEST_POOL_QUEUED];
+	async_pool_stats_t stats;
+	service_id_t sid;
+	errno_t rc;
+
+	test_pool_start(&srv, 1, 0, &sid);
+
+	holder.sess = test_pool_connect(sid, &rc);
+	PCUT_ASSERT_NOT_NULL(holder.sess);
+
+	async_sess_t *sess = test_pool_connect(sid, &rc);
+	PCUT_ASSERT_NOT_NULL(sess);
+
+	test_pool_hold(&srv, &holder);
+
+	/* Queue calls behind the busy worker and hang up. */
+	async_exch_t *exch = async_exchange_begin(sess);
+	PCUT_ASSERT_NOT_NULL(exch);
+
+	for (int n = 0; n < TEST_POOL_QUEUED; n++)
+		req[n] = async_send_2(exch, TEST_POOL_SEQ, 1, n, &answer[n]);
+
+	async_exchange_end(exch);
+	PCUT_ASSERT_ERRNO_VAL(EOK, async_hangup(sess));
+
+	PCUT_ASSERT_INT_EQUALS(TEST_POOL_QUEUED + 1,
+	    test_pool_queued_wait(srv.pool, TEST_POOL_QUEUED + 1));
+
+	test_pool_release(&srv, &holder);
+
+	for (int n = 0; n < TEST_POOL_QUEUED; n++) {
+		async_wait_for(req[n], &rc);
+		PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	}
+
+	/* Wait for the hangup to be handled. */
+	rc = EOK;
+	fibril_mutex_lock(&srv.lock);
+	while (srv.hangups == 0 && rc == EOK)
+		rc = fibril_condvar_wait_timeout(&srv.cv, &srv.lock, 1000000);
+	fibril_mutex_unlock(&srv.lock);
+
+	PCUT_ASSERT_INT_EQUALS(1, srv.hangups);
+	PCUT_ASSERT_INT_EQUALS(TEST_POOL_QUEUED, srv.next[1]);
+	PCUT_ASSERT_INT_EQUALS(0, srv.misordered);
+
+	async_pool_stats_get(srv.pool, &stats);
+	PCUT_ASSERT_INT_EQUALS(0, stats.queued);
+
+	PCUT_ASSERT_ERRNO_VAL(EOK, async_hangup(holder.sess));
+	PCUT_ASSERT_ERRNO_VAL(EOK, loc_service_unregister(sid));
+}
+
+PCUT_EXPORT(async_pool);
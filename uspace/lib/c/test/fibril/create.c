@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <fibril.h>
+#include <fibril_synch.h>
+#include <pcut/pcut.h>
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(fibril_create);
+
+enum {
+	/** More than what the fibril caches hold */
+	CHURN_FIBRILS = 200
+};
+
+static fibril_local int local_var = 0;
+static fibril_local int local_init = 7;
+
+typedef struct {
+	fibril_semaphore_t done;
+	int seen_var;
+	int seen_init;
+} churn_t;
+
+static errno_t churn_fibril(void *arg)
+{
+	churn_t *churn = (churn_t *) arg;
+
+	churn->seen_var = local_var;
+	churn->seen_init = local_init;
+
+	/* Dirty the fibril-local data for the next user of this fibril. */
+	local_var = 42;
+	local_init = 42;
+
+	fibril_semaphore_up(&churn->done);
+	return EOK;
+}
+
+/** Fibrils created one after another start with fresh fibril-local data. */
+PCUT_TEST(churn_fresh_locals)
+{
+	churn_t churn;
+
+	fibril_semaphore_initialize(&churn.done, 0);
+
+	for (int i = 0; i < CHURN_FIBRILS; i++) {
+		churn.seen_var = -1;
+		churn.seen_init = -1;
+
+		fid_t fid = fibril_create(churn_fibril, &churn);
+		PCUT_ASSERT_NOT_NULL((void *) fid);
+		fibril_add_ready(fid);
+
+		fibril_semaphore_down(&churn.done);
+		/* Let the fibril die and get cleaned up. */
+		fibril_yield();
+
+		PCUT_ASSERT_INT_EQUALS(0, churn.seen_var);
+		PCUT_ASSERT_INT_EQUALS(7, churn.seen_init);
+	}
+}
+
+static errno_t never_run_fibril(void *arg)
+{
+	return EOK;
+}
+
+/** Fibrils that never ran can be destroyed and their resources reused. */
+PCUT_TEST(create_destroy)
+{
+	for (int i = 0; i < CHURN_FIBRILS; i++) {
+		fid_t fid = fibril_create(never_run_fibril, NULL);
+		PCUT_ASSERT_NOT_NULL((void *) fid);
+		fibril_destroy(fid);
+	}
+}
+
+PCUT_EXPORT(fibril_create);
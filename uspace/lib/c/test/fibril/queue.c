@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <fibril.h>
+#include <fibril_synch.h>
+#include <pcut/pcut.h>
+#include <time.h>
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(fibril_queue);
+
+enum {
+	QUEUE_PRODUCERS = 4,
+	QUEUE_MESSAGES = 1000
+};
+
+typedef struct {
+	int producer;
+	int seq;
+} queue_msg_t;
+
+typedef struct {
+	mpsc_t *mpsc;
+	mpmc_t *mpmc;
+	int producer;
+	fibril_semaphore_t *done;
+} queue_producer_t;
+
+static errno_t mpsc_producer(void *arg)
+{
+	queue_producer_t *p = arg;
+
+	for (int i = 0; i < QUEUE_MESSAGES; i++) {
+		queue_msg_t msg = { .producer = p->producer, .seq = i };
+		if (mpsc_send(p->mpsc, &msg) != EOK)
+			break;
+
+		if (i % 16 == 0)
+			fibril_yield();
+	}
+
+	fibril_semaphore_up(p->done);
+	return EOK;
+}
+
+static errno_t mpmc_producer(void *arg)
+{
+	queue_producer_t *p = arg;
+
+	for (int i = 0; i < QUEUE_MESSAGES; i++) {
+		queue_msg_t msg = { .producer = p->producer, .seq = i };
+		if (mpmc_send(p->mpmc, &msg, NULL) != EOK)
+			break;
+	}
+
+	fibril_semaphore_up(p->done);
+	return EOK;
+}
+
+/** Messages from each producer arrive exactly once and in order. */
+PCUT_TEST(mpsc_producers)
+{
+	fibril_semaphore_t done;
+	queue_producer_t prod[QUEUE_PRODUCERS];
+	int next[QUEUE_PRODUCERS] = { 0 };
+
+	fibril_test_spawn_runners(2);
+	fibril_semaphore_initialize(&done, 0);
+
+	mpsc_t *q = mpsc_create(sizeof(queue_msg_t));
+	PCUT_ASSERT_NOT_NULL(q);
+
+	for (int i = 0; i < QUEUE_PRODUCERS; i++) {
+		prod[i].mpsc = q;
+		prod[i].producer = i;
+		prod[i].done = &done;
+
+		fid_t fid = fibril_create(mpsc_producer, &prod[i]);
+		PCUT_ASSERT_NOT_NULL((void *) fid);
+		fibril_add_ready(fid);
+	}
+
+	for (int n = 0; n < QUEUE_PRODUCERS * QUEUE_MESSAGES; n++) {
+		queue_msg_t msg;
+		PCUT_ASSERT_ERRNO_VAL(EOK, mpsc_receive(q, &msg, NULL));
+		PCUT_ASSERT_TRUE(msg.producer >= 0 && msg.producer < QUEUE_PRODUCERS);
+		PCUT_ASSERT_INT_EQUALS(next[msg.producer], msg.seq);
+		next[msg.producer]++;
+	}
+
+	for (int i = 0; i < QUEUE_PRODUCERS; i++)
+		fibril_semaphore_down(&done);
+
+	mpsc_close(q);
+
+	queue_msg_t msg = { .producer = 0, .seq = 0 };
+	PCUT_ASSERT_ERRNO_VAL(EINVAL, mpsc_send(q, &msg));
+	PCUT_ASSERT_ERRNO_VAL(ENOENT, mpsc_receive(q, &msg, NULL));
+
+	mpsc_destroy(q);
+}
+
+/** Receiving from an empty channel times out. */
+PCUT_TEST(mpsc_timeout)
+{
+	mpsc_t *q = mpsc_create(sizeof(int));
+	PCUT_ASSERT_NOT_NULL(q);
+
+	struct timespec expires;
+	getuptime(&expires);
+	ts_add_diff(&expires, MSEC2NSEC(10));
+
+	int v;
+	PCUT_ASSERT_ERRNO_VAL(ETIMEOUT, mpsc_receive(q, &v, &expires));
+
+	v = 7;
+	PCUT_ASSERT_ERRNO_VAL(EOK, mpsc_send(q, &v));
+	v = 0;
+	PCUT_ASSERT_ERRNO_VAL(EOK, mpsc_receive(q, &v, NULL));
+	PCUT_ASSERT_INT_EQUALS(7, v);
+
+	mpsc_destroy(q);
+}
+
+/** The buffer holds the capacity rounded up to a power of two. */
+PCUT_TEST(mpmc_try)
+{
+	mpmc_t *q = mpmc_create(sizeof(int), 3);
+	PCUT_ASSERT_NOT_NULL(q);
+
+	int v;
+	PCUT_ASSERT_ERRNO_VAL(EAGAIN, mpmc_try_receive(q, &v));
+
+	for (v = 0; v < 4; v++)
+		PCUT_ASSERT_ERRNO_VAL(EOK, mpmc_try_send(q, &v));
+	PCUT_ASSERT_ERRNO_VAL(EAGAIN, mpmc_try_send(q, &v));
+
+	struct timespec expires;
+	getuptime(&expires);
+	ts_add_diff(&expires, MSEC2NSEC(10));
+	PCUT_ASSERT_ERRNO_VAL(ETIMEOUT, mpmc_send(q, &v, &expires));
+
+	for (int i = 0; i < 4; i++) {
+		PCUT_ASSERT_ERRNO_VAL(EOK, mpmc_try_receive(q, &v));
+		PCUT_ASSERT_INT_EQUALS(i, v);
+	}
+	PCUT_ASSERT_ERRNO_VAL(EAGAIN, mpmc_try_receive(q, &v));
+
+	mpmc_destroy(q);
+}
+
+/** Producers block on a small buffer and every message gets through. */
+PCUT_TEST(mpmc_producers)
+{
+	fibril_semaphore_t done;
+	queue_producer_t prod[QUEUE_PRODUCERS];
+	int next[QUEUE_PRODUCERS] = { 0 };
+
+	fibril_test_spawn_runners(2);
+	fibril_semaphore_initialize(&done, 0);
+
+	mpmc_t *q = mpmc_create(sizeof(queue_msg_t), 2);
+	PCUT_ASSERT_NOT_NULL(q);
+
+	for (int i = 0; i < QUEUE_PRODUCERS; i++) {
+		prod[i].mpmc = q;
+		prod[i].producer = i;
+		prod[i].done = &done;
+
+		fid_t fid = fibril_create(mpmc_producer, &prod[i]);
+		PCUT_ASSERT_NOT_NULL((void *) fid);
+		fibril_add_ready(fid);
+	}
+
+	for (int n = 0; n < QUEUE_PRODUCERS * QUEUE_MESSAGES; n++) {
+		queue_msg_t msg;
+		PCUT_ASSERT_ERRNO_VAL(EOK, mpmc_receive(q, &msg, NULL));
+		PCUT_ASSERT_TRUE(msg.producer >= 0 && msg.producer < QUEUE_PRODUCERS);
+		PCUT_ASSERT_INT_EQUALS(next[msg.producer], msg.seq);
+		next[msg.producer]++;
+	}
+
+	for (int i = 0; i < QUEUE_PRODUCERS; i++)
+		fibril_semaphore_down(&done);
+
+	queue_msg_t msg;
+	PCUT_ASSERT_ERRNO_VAL(EAGAIN, mpmc_try_receive(q, &msg));
+
+	mpmc_destroy(q);
+}
+
+PCUT_EXPORT(fibril_queue);
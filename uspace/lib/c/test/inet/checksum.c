@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <inet/checksum.h>
+#include <pcut/pcut.h>
+#include <stdint.h>
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(checksum);
+
+/** Reference implementation processing one 16-bit word at a time */
+static uint16_t checksum_ref(uint16_t ivalue, const uint8_t *data,
+    size_t size)
+{
+	uint32_t sum;
+	size_t i;
+
+	sum = (uint16_t) ~ivalue;
+	for (i = 0; i < size; i++) {
+		sum += (i % 2 == 0) ? (uint32_t) data[i] << 8 : data[i];
+		sum = (sum & 0xffff) + (sum >> 16);
+	}
+
+	return ~sum;
+}
+
+/** Checksum of an IPv4 header example from RFC 1071 */
+PCUT_TEST(rfc1071_example)
+{
+	uint8_t data[] = {
+		0x00, 0x01, 0xf2, 0x03, 0xf4, 0xf5, 0xf6, 0xf7
+	};
+
+	/* The one's complement sum is 0xddf2 */
+	PCUT_ASSERT_INT_EQUALS((uint16_t) ~0xddf2,
+	    inet_checksum_calc(INET_CHECKSUM_INIT, data, sizeof(data)));
+}
+
+/** Result matches reference for all sizes and alignments */
+PCUT_TEST(calc_sizes)
+{
+	uint8_t data[80];
+	uint16_t exp;
+	uint16_t act;
+	size_t offs;
+	size_t size;
+	size_t i;
+
+	for (i = 0; i < sizeof(data); i++)
+		data[i] = 37 * i + 11;
+
+	for (offs = 0; offs < 8; offs++) {
+		for (size = 0; size <= sizeof(data) - offs; size++) {
+			exp = checksum_ref(INET_CHECKSUM_INIT, data + offs,
+			    size);
+			act = inet_checksum_calc(INET_CHECKSUM_INIT,
+			    data + offs, size);
+			PCUT_ASSERT_INT_EQUALS(exp, act);
+		}
+	}
+}
+
+/** Computation can be continued with more data */
+PCUT_TEST(calc_chained)
+{
+	uint8_t data[64];
+	uint16_t cs;
+	size_t i;
+
+	for (i = 0; i < sizeof(data); i++)
+		data[i] = 0xff - 3 * i;
+
+	cs = inet_checksum_calc(INET_CHECKSUM_INIT, data, 12);
+	cs = inet_checksum_calc(cs, data + 12, sizeof(data) - 12);
+
+	PCUT_ASSERT_INT_EQUALS(inet_checksum_calc(INET_CHECKSUM_INIT, data,
+	    sizeof(data)), cs);
+}
+
+/** Incremental update matches full recomputation */
+PCUT_TEST(update)
+{
+	uint8_t data[20];
+	uint16_t cs;
+	uint16_t ncs;
+	size_t i;
+
+	for (i = 0; i < sizeof(data); i++)
+		data[i] = 7 * i + 1;
+
+	cs = inet_checksum_calc(INET_CHECKSUM_INIT, data, sizeof(data));
+
+	/* Change 16-bit word at offset 8 from 0x3940 to 0x1234 */
+	data[8] = 0x12;
+	data[9] = 0x34;
+	ncs = inet_checksum_calc(INET_CHECKSUM_INIT, data, sizeof(data));
+	cs = inet_checksum_update16(cs, 0x3940, 0x1234);
+	PCUT_ASSERT_INT_EQUALS(ncs, cs);
+
+	/* Change 32-bit word at offset 12 from 0x555c636a to 0x0a000001 */
+	data[12] = 0x0a;
+	data[13] = 0x00;
+	data[14] = 0x00;
+	data[15] = 0x01;
+	ncs = inet_checksum_calc(INET_CHECKSUM_INIT, data, sizeof(data));
+	cs = inet_checksum_update32(cs, 0x555c636a, 0x0a000001);
+	PCUT_ASSERT_INT_EQUALS(ncs, cs);
+}
+
+PCUT_EXPORT(checksum);
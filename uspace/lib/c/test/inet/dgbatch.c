@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <inet/dgbatch.h>
+#include <mem.h>
+#include <pcut/pcut.h>
+#include <stdint.h>
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(dgbatch);
+
+/** Datagrams added to a batch can be decoded back */
+PCUT_TEST(add_next)
+{
+	inet_dgbatch_t batch;
+	inet_dgram_t dgram;
+	inet_dgram_t rdgram;
+	uint8_t data[3][17];
+	size_t offs;
+	errno_t rc;
+	size_t i;
+
+	inet_dgbatch_init(&batch);
+
+	for (i = 0; i < 3; i++) {
+		memset(data[i], 0x10 + i, sizeof(data[i]));
+		memset(&dgram, 0, sizeof(dgram));
+		dgram.iplink = 42 + i;
+		dgram.tos = i;
+		inet_addr(&dgram.src, 10, 0, 0, 1);
+		inet_addr(&dgram.dest, 10, 0, 0, 2 + i);
+		dgram.data = data[i];
+		dgram.size = 1 + 8 * i;
+
+		rc = inet_dgbatch_add(&batch, &dgram);
+		PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	}
+
+	PCUT_ASSERT_INT_EQUALS(3, batch.count);
+
+	offs = 0;
+	for (i = 0; i < 3; i++) {
+		rc = inet_dgbatch_next(batch.buf, batch.size, &offs, &rdgram);
+		PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+		PCUT_ASSERT_INT_EQUALS(42 + i, rdgram.iplink);
+		PCUT_ASSERT_INT_EQUALS(i, rdgram.tos);
+		PCUT_ASSERT_INT_EQUALS(1 + 8 * i, rdgram.size);
+		PCUT_ASSERT_INT_EQUALS(0,
+		    memcmp(rdgram.data, data[i], rdgram.size));
+
+		inet_addr(&dgram.dest, 10, 0, 0, 2 + i);
+		PCUT_ASSERT_TRUE(inet_addr_compare(&dgram.dest, &rdgram.dest));
+	}
+
+	rc = inet_dgbatch_next(batch.buf, batch.size, &offs, &rdgram);
+	PCUT_ASSERT_ERRNO_VAL(ENOENT, rc);
+
+	inet_dgbatch_fini(&batch);
+}
+
+/** Batch refuses datagrams beyond the count limit */
+PCUT_TEST(count_limit)
+{
+	inet_dgbatch_t batch;
+	inet_dgram_t dgram;
+	uint8_t byte = 0;
+	errno_t rc;
+	size_t i;
+
+	inet_dgbatch_init(&batch);
+	memset(&dgram, 0, sizeof(dgram));
+	dgram.data = &byte;
+	dgram.size = 1;
+
+	for (i = 0; i < INET_DGBATCH_COUNT_MAX; i++) {
+		rc = inet_dgbatch_add(&batch, &dgram);
+		PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	}
+
+	PCUT_ASSERT_FALSE(inet_dgbatch_fits(&batch, 1));
+	rc = inet_dgbatch_add(&batch, &dgram);
+	PCUT_ASSERT_ERRNO_VAL(ELIMIT, rc);
+
+	inet_dgbatch_clear(&batch);
+	PCUT_ASSERT_TRUE(inet_dgbatch_fits(&batch, 1));
+
+	inet_dgbatch_fini(&batch);
+}
+
+/** Truncated batch is reported as malformed */
+PCUT_TEST(next_truncated)
+{
+	inet_dgbatch_t batch;
+	inet_dgram_t dgram;
+	uint8_t data[8];
+	size_t offs;
+	errno_t rc;
+
+	inet_dgbatch_init(&batch);
+	memset(&dgram, 0, sizeof(dgram));
+	memset(data, 0, sizeof(data));
+	dgram.data = data;
+	dgram.size = sizeof(data);
+
+	rc = inet_dgbatch_add(&batch, &dgram);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	offs = 0;
+	rc = inet_dgbatch_next(batch.buf, batch.size - sizeof(data) - 1,
+	    &offs, &dgram);
+	PCUT_ASSERT_ERRNO_VAL(EINVAL, rc);
+
+	inet_dgbatch_fini(&batch);
+}
+
+PCUT_EXPORT(dgbatch);
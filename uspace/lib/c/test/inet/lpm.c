@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <inet/addr.h>
+#include <inet/lpm.h>
+#include <mem.h>
+#include <pcut/pcut.h>
+#include <stdint.h>
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(lpm);
+
+static int vals[8];
+
+/** Lookup returns the most specific IPv4 prefix */
+PCUT_TEST(lookup_v4)
+{
+	inet_lpm_t lpm;
+	inet_naddr_t naddr;
+	inet_addr_t addr;
+	errno_t rc;
+
+	inet_lpm_init(&lpm);
+
+	inet_naddr(&naddr, 0, 0, 0, 0, 0);
+	rc = inet_lpm_insert(&lpm, &naddr, &vals[0]);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	inet_naddr(&naddr, 10, 0, 0, 0, 8);
+	rc = inet_lpm_insert(&lpm, &naddr, &vals[1]);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	inet_naddr(&naddr, 10, 1, 0, 0, 16);
+	rc = inet_lpm_insert(&lpm, &naddr, &vals[2]);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	inet_naddr(&naddr, 10, 1, 2, 128, 25);
+	rc = inet_lpm_insert(&lpm, &naddr, &vals[3]);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	inet_naddr(&naddr, 192, 168, 0, 0, 16);
+	rc = inet_lpm_insert(&lpm, &naddr, &vals[4]);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	PCUT_ASSERT_INT_EQUALS(5, lpm.count);
+
+	inet_addr(&addr, 10, 1, 2, 200);
+	PCUT_ASSERT_EQUALS(&vals[3], inet_lpm_lookup(&lpm, &addr));
+	inet_addr(&addr, 10, 1, 2, 100);
+	PCUT_ASSERT_EQUALS(&vals[2], inet_lpm_lookup(&lpm, &addr));
+	inet_addr(&addr, 10, 2, 0, 1);
+	PCUT_ASSERT_EQUALS(&vals[1], inet_lpm_lookup(&lpm, &addr));
+	inet_addr(&addr, 192, 168, 7, 7);
+	PCUT_ASSERT_EQUALS(&vals[4], inet_lpm_lookup(&lpm, &addr));
+	inet_addr(&addr, 8, 8, 8, 8);
+	PCUT_ASSERT_EQUALS(&vals[0], inet_lpm_lookup(&lpm, &addr));
+
+	inet_lpm_fini(&lpm);
+}
+
+/** Inserting a prefix twice fails, bits beyond the prefix are ignored */
+PCUT_TEST(insert_exists)
+{
+	inet_lpm_t lpm;
+	inet_naddr_t naddr;
+	errno_t rc;
+
+	inet_lpm_init(&lpm);
+
+	inet_naddr(&naddr, 172, 16, 0, 0, 12);
+	rc = inet_lpm_insert(&lpm, &naddr, &vals[0]);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	inet_naddr(&naddr, 172, 16, 5, 1, 12);
+	rc = inet_lpm_insert(&lpm, &naddr, &vals[1]);
+	PCUT_ASSERT_ERRNO_VAL(EEXIST, rc);
+	PCUT_ASSERT_EQUALS(&vals[0], inet_lpm_find(&lpm, &naddr));
+
+	inet_naddr(&naddr, 172, 16, 0, 0, 33);
+	rc = inet_lpm_insert(&lpm, &naddr, &vals[1]);
+	PCUT_ASSERT_ERRNO_VAL(EINVAL, rc);
+
+	inet_lpm_fini(&lpm);
+}
+
+/** Removing prefixes restores less specific matches */
+PCUT_TEST(remove)
+{
+	inet_lpm_t lpm;
+	inet_naddr_t naddr;
+	inet_addr_t addr;
+	errno_t rc;
+	int i;
+
+	inet_lpm_init(&lpm);
+
+	/* Sibling prefixes create a branching node */
+	for (i = 0; i < 4; i++) {
+		inet_naddr(&naddr, 10, 0, i, 0, 24);
+		rc = inet_lpm_insert(&lpm, &naddr, &vals[i]);
+		PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	}
+
+	inet_naddr(&naddr, 10, 0, 0, 0, 22);
+	rc = inet_lpm_insert(&lpm, &naddr, &vals[4]);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	inet_naddr(&naddr, 10, 0, 2, 0, 24);
+	rc = inet_lpm_remove(&lpm, &naddr);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	rc = inet_lpm_remove(&lpm, &naddr);
+	PCUT_ASSERT_ERRNO_VAL(ENOENT, rc);
+
+	inet_addr(&addr, 10, 0, 2, 1);
+	PCUT_ASSERT_EQUALS(&vals[4], inet_lpm_lookup(&lpm, &addr));
+	inet_addr(&addr, 10, 0, 3, 1);
+	PCUT_ASSERT_EQUALS(&vals[3], inet_lpm_lookup(&lpm, &addr));
+
+	inet_naddr(&naddr, 10, 0, 0, 0, 22);
+	rc = inet_lpm_remove(&lpm, &naddr);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	inet_addr(&addr, 10, 0, 2, 1);
+	PCUT_ASSERT_NULL(inet_lpm_lookup(&lpm, &addr));
+	inet_addr(&addr, 10, 0, 1, 1);
+	PCUT_ASSERT_EQUALS(&vals[1], inet_lpm_lookup(&lpm, &addr));
+
+	for (i = 0; i < 4; i++) {
+		inet_naddr(&naddr, 10, 0, i, 0, 24);
+		(void) inet_lpm_remove(&lpm, &naddr);
+	}
+
+	PCUT_ASSERT_INT_EQUALS(0, lpm.count);
+	PCUT_ASSERT_NULL(lpm.root4);
+
+	inet_lpm_fini(&lpm);
+}
+
+/** IPv6 prefixes are matched independently of IPv4 */
+PCUT_TEST(lookup_v6)
+{
+	inet_lpm_t lpm;
+	inet_naddr_t naddr;
+	inet_addr_t addr;
+	addr128_t a6;
+	errno_t rc;
+
+	inet_lpm_init(&lpm);
+
+	memset(a6, 0, sizeof(a6));
+	a6[0] = 0x20;
+	a6[1] = 0x01;
+	a6[2] = 0x0d;
+	a6[3] = 0xb8;
+	inet_naddr_set6(a6, 32, &naddr);
+	rc = inet_lpm_insert(&lpm, &naddr, &vals[0]);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	a6[15] = 0x01;
+	inet_naddr_set6(a6, 127, &naddr);
+	rc = inet_lpm_insert(&lpm, &naddr, &vals[1]);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	inet_naddr(&naddr, 0, 0, 0, 0, 0);
+	rc = inet_lpm_insert(&lpm, &naddr, &vals[2]);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	inet_addr_set6(a6, &addr);
+	PCUT_ASSERT_EQUALS(&vals[1], inet_lpm_lookup(&lpm, &addr));
+
+	a6[15] = 0x02;
+	inet_addr_set6(a6, &addr);
+	PCUT_ASSERT_EQUALS(&vals[0], inet_lpm_lookup(&lpm, &addr));
+
+	a6[3] = 0xb9;
+	inet_addr_set6(a6, &addr);
+	PCUT_ASSERT_NULL(inet_lpm_lookup(&lpm, &addr));
+
+	inet_lpm_fini(&lpm);
+}
+
+PCUT_EXPORT(lpm);
@@ -31,18 +31,27 @@
 
 PCUT_INIT;
 
+PCUT_IMPORT(async_exch);
+PCUT_IMPORT(async_pool);
 PCUT_IMPORT(capa);
 PCUT_IMPORT(casting);
+PCUT_IMPORT(checksum);
 PCUT_IMPORT(circ_buf);
+PCUT_IMPORT(dgbatch);
 PCUT_IMPORT(double_to_str);
+PCUT_IMPORT(fibril_create);
+PCUT_IMPORT(fibril_queue);
 PCUT_IMPORT(fibril_timer);
 PCUT_IMPORT(getopt);
 PCUT_IMPORT(gsort);
 PCUT_IMPORT(ieee_double);
+PCUT_IMPORT(ihash_table);
 PCUT_IMPORT(imath);
 PCUT_IMPORT(inttypes);
+PCUT_IMPORT(lpm);
 PCUT_IMPORT(mem);
 PCUT_IMPORT(odict);
+PCUT_IMPORT(ohash_table);
 PCUT_IMPORT(perf);
 PCUT_IMPORT(perm);
 PCUT_IMPORT(qsort);
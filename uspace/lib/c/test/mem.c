@@ -65,6 +65,25 @@ PCUT_TEST(memmove)
 	PCUT_ASSERT_INT_EQUALS('d', buf[4]);
 }
 
+/** memmove function with overlapping areas in both directions */
+PCUT_TEST(memmove_overlap)
+{
+	char buf[64];
+	size_t i, j, k;
+
+	for (i = 0; i < 16; i++) {
+		for (j = 0; j < 16; j++) {
+			for (k = 0; k < sizeof(buf); k++)
+				buf[k] = k;
+
+			memmove(buf + j, buf + i, sizeof(buf) - 16);
+
+			for (k = 0; k < sizeof(buf) - 16; k++)
+				PCUT_ASSERT_INT_EQUALS(i + k, buf[j + k]);
+		}
+	}
+}
+
 /** memcmp function */
 PCUT_TEST(memcmp)
 {
@@ -98,6 +117,54 @@ PCUT_TEST(memchr)
 	PCUT_ASSERT_TRUE(p == NULL);
 }
 
+/** memcmp function with areas at all relative alignments */
+PCUT_TEST(memcmp_align)
+{
+	char buf1[64];
+	char buf2[64];
+	size_t i, j, n;
+
+	for (i = 0; i < sizeof(buf1); i++)
+		buf1[i] = buf2[i] = 'a' + i % 26;
+
+	for (i = 0; i < 16; i++) {
+		for (j = 0; j < 16; j++) {
+			n = sizeof(buf1) - 16;
+			memcpy(buf2 + j, buf1 + i, n);
+			PCUT_ASSERT_INT_EQUALS(0, memcmp(buf1 + i, buf2 + j, n));
+
+			buf2[j + n - 1]++;
+			PCUT_ASSERT_TRUE(memcmp(buf1 + i, buf2 + j, n) < 0);
+			PCUT_ASSERT_INT_EQUALS(0, memcmp(buf1 + i, buf2 + j,
+			    n - 1));
+		}
+	}
+}
+
+/** memchr function with areas at all alignments */
+PCUT_TEST(memchr_align)
+{
+	char buf[64];
+	size_t i, j;
+	void *p;
+
+	memset(buf, 'a', sizeof(buf));
+
+	for (i = 0; i < 16; i++) {
+		for (j = 0; j < sizeof(buf) - i; j++) {
+			buf[i + j] = 'b';
+
+			p = memchr(buf + i, 'b', sizeof(buf) - i);
+			PCUT_ASSERT_TRUE(p == buf + i + j);
+
+			p = memchr(buf + i, 'b', j);
+			PCUT_ASSERT_TRUE(p == NULL);
+
+			buf[i + j] = 'a';
+		}
+	}
+}
+
 /** memset function */
 PCUT_TEST(memset)
 {
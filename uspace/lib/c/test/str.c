@@ -114,4 +114,32 @@ PCUT_TEST(str_str_empty_n)
 	PCUT_ASSERT_TRUE((const char *)p == hs);
 }
 
+PCUT_TEST(str_length_mixed)
+{
+	PCUT_ASSERT_INT_EQUALS(0, str_length(""));
+	PCUT_ASSERT_INT_EQUALS(19, str_length("abcdefghijklmnopqrs"));
+	PCUT_ASSERT_INT_EQUALS(20, str_length("abcdefghijklmnopqrs\u010d"));
+	PCUT_ASSERT_INT_EQUALS(21, str_length("abcdefghijklmnopqrs\u010dt"));
+}
+
+PCUT_TEST(str_cmp_mixed)
+{
+	PCUT_ASSERT_INT_EQUALS(0, str_cmp("abcdefghijklm\u010d",
+	    "abcdefghijklm\u010d"));
+	PCUT_ASSERT_INT_EQUALS(-1, str_cmp("abcdefghijklmz",
+	    "abcdefghijklm\u010d"));
+	PCUT_ASSERT_INT_EQUALS(1, str_cmp("abcdefghijklm\u010d",
+	    "abcdefghijklm"));
+	PCUT_ASSERT_INT_EQUALS(-1, str_cmp("abcdefghijklm\u010c",
+	    "abcdefghijklm\u010d"));
+	PCUT_ASSERT_INT_EQUALS(0, str_lcmp("abcdefghijklmx",
+	    "abcdefghijklmy", 13));
+	PCUT_ASSERT_INT_EQUALS(-1, str_lcmp("abcdefghijklmx",
+	    "abcdefghijklmy", 14));
+	PCUT_ASSERT_TRUE(str_test_prefix("abcdefghijklm\u010d",
+	    "abcdefghijklm"));
+	PCUT_ASSERT_FALSE(str_test_prefix("abcdefghijklm",
+	    "abcdefghijklm\u010d"));
+}
+
 PCUT_EXPORT(str);
@@ -348,6 +348,30 @@ PCUT_TEST(strcmp_prefix)
 	PCUT_ASSERT_TRUE(strcmp("apple", "apples") < 0);
 }
 
+/** strcmp function with strings at the same alignment */
+PCUT_TEST(strcmp_align)
+{
+	char buf1[64];
+	char buf2[64];
+	size_t i, j;
+
+	memset(buf1, 'a', sizeof(buf1));
+	memset(buf2, 'a', sizeof(buf2));
+	buf1[sizeof(buf1) - 1] = '\0';
+	buf2[sizeof(buf2) - 1] = '\0';
+
+	for (i = 0; i < 16; i++) {
+		for (j = i; j < sizeof(buf1) - 1; j++) {
+			buf2[j] = 'b';
+			PCUT_ASSERT_TRUE(strcmp(buf1 + i, buf2 + i) < 0);
+			buf2[j] = '\0';
+			PCUT_ASSERT_TRUE(strcmp(buf1 + i, buf2 + i) > 0);
+			buf2[j] = 'a';
+			PCUT_ASSERT_INT_EQUALS(0, strcmp(buf1 + i, buf2 + i));
+		}
+	}
+}
+
 /** strcoll function */
 PCUT_TEST(strcoll)
 {
@@ -720,6 +744,24 @@ PCUT_TEST(strlen_nonempty)
 	PCUT_ASSERT_INT_EQUALS(3, strlen("abc"));
 }
 
+/** strlen function with strings at all alignments */
+PCUT_TEST(strlen_align)
+{
+	char buf[64];
+	size_t i, j;
+
+	memset(buf, 'a', sizeof(buf));
+
+	for (i = 0; i < 16; i++) {
+		for (j = 0; j < sizeof(buf) - i; j++) {
+			buf[i + j] = '\0';
+			PCUT_ASSERT_INT_EQUALS(j, strlen(buf + i));
+			PCUT_ASSERT_INT_EQUALS(j, strnlen(buf + i, sizeof(buf)));
+			buf[i + j] = 'a';
+		}
+	}
+}
+
 /** strlen function with empty string and non-zero limit */
 PCUT_TEST(strnlen_empty_short)
 {
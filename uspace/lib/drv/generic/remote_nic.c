@@ -38,6 +38,7 @@
 #include <async.h>
 #include <errno.h>
 #include <ipc/services.h>
+#include <as.h>
 #include <time.h>
 #include <macros.h>
 
@@ -85,7 +86,8 @@ typedef enum {
 	NIC_OFFLOAD_SET,
 	NIC_POLL_GET_MODE,
 	NIC_POLL_SET_MODE,
-	NIC_POLL_NOW
+	NIC_POLL_NOW,
+	NIC_RX_POOL_SHARE
 } nic_funcs_t;
 
 /** Send frame from NIC
@@ -1244,12 +1246,50 @@ errno_t nic_offload_set(async_sess_t *dev_sess, uint32_t mask, uint32_t active)
 {
 	async_exch_t *exch = async_exchange_begin(dev_sess);
 	errno_t rc = async_req_3_0(exch, DEV_IFACE_ID(NIC_DEV_IFACE),
-	    NIC_AUTONEG_RESTART, (sysarg_t) mask, (sysarg_t) active);
+	    NIC_OFFLOAD_SET, (sysarg_t) mask, (sysarg_t) active);
 	async_exchange_end(exch);
 
 	return rc;
 }
 
+/** Map the NIC receive frame pool into the caller's address space
+ *
+ * Frames received into the pool are announced with NIC_EV_RECEIVED_POOL
+ * carrying only their offset and size within the pool, so the client can
+ * read them in place instead of receiving a copy.
+ *
+ * @param[in]  dev_sess
+ * @param[out] pool     Address of the mapped pool
+ * @param[out] size     Size of the pool in bytes
+ *
+ * @return EOK If the operation was successfully completed
+ * @return ENOTSUP If the driver does not provide a receive pool
+ *
+ */
+errno_t nic_rx_pool_share(async_sess_t *dev_sess, void **pool, size_t *size)
+{
+	sysarg_t pool_size;
+
+	async_exch_t *exch = async_exchange_begin(dev_sess);
+	errno_t rc = async_req_1_1(exch, DEV_IFACE_ID(NIC_DEV_IFACE),
+	    NIC_RX_POOL_SHARE, &pool_size);
+	if (rc != EOK) {
+		async_exchange_end(exch);
+		return rc;
+	}
+
+	void *dst = NULL;
+	rc = async_share_in_start_0_0(exch, pool_size, &dst);
+	async_exchange_end(exch);
+
+	if (rc != EOK)
+		return rc;
+
+	*pool = dst;
+	*size = pool_size;
+	return EOK;
+}
+
 /** Query the current interrupt/poll mode of the NIC
  *
  * @param[in]  dev_sess
@@ -2485,6 +2525,38 @@ static void remote_nic_poll_now(ddf_fun_t *dev, void *iface,
 	async_answer_0(call, rc);
 }
 
+static void remote_nic_rx_pool_share(ddf_fun_t *dev, void *iface,
+    ipc_call_t *call)
+{
+	nic_iface_t *nic_iface = (nic_iface_t *) iface;
+	if (nic_iface->rx_pool_get == NULL) {
+		async_answer_0(call, ENOTSUP);
+		return;
+	}
+
+	void *pool;
+	size_t size;
+	errno_t rc = nic_iface->rx_pool_get(dev, &pool, &size);
+	async_answer_1(call, rc, size);
+	if (rc != EOK)
+		return;
+
+	ipc_call_t share;
+	size_t share_size;
+	if (!async_share_in_receive(&share, &share_size)) {
+		async_answer_0(&share, EINVAL);
+		return;
+	}
+
+	if (share_size != size) {
+		async_answer_0(&share, ELIMIT);
+		return;
+	}
+
+	async_share_in_finalize(&share, pool, AS_AREA_READ |
+	    AS_AREA_CACHEABLE);
+}
+
 /** Remote NIC interface operations.
  *
  */
@@ -2529,7 +2601,8 @@ static const remote_iface_func_ptr_t remote_nic_iface_ops[] = {
 	[NIC_OFFLOAD_SET] = remote_nic_offload_set,
 	[NIC_POLL_GET_MODE] = remote_nic_poll_get_mode,
 	[NIC_POLL_SET_MODE] = remote_nic_poll_set_mode,
-	[NIC_POLL_NOW] = remote_nic_poll_now
+	[NIC_POLL_NOW] = remote_nic_poll_now,
+	[NIC_RX_POOL_SHARE] = remote_nic_rx_pool_share
 };
 
 /** Remote NIC interface structure.
@@ -42,9 +42,17 @@
 typedef enum {
 	NIC_EV_ADDR_CHANGED = IPC_FIRST_USER_METHOD,
 	NIC_EV_RECEIVED,
-	NIC_EV_DEVICE_STATE
+	NIC_EV_DEVICE_STATE,
+	NIC_EV_RECEIVED_POOL
 } nic_event_t;
 
+/** Number of frame slots in a NIC receive pool */
+#define NIC_RX_POOL_SLOTS  64
+/** Size of one receive pool slot (fits a full Ethernet frame) */
+#define NIC_RX_POOL_SLOT_SIZE  2048
+/** Total size of a NIC receive pool */
+#define NIC_RX_POOL_SIZE  (NIC_RX_POOL_SLOTS * NIC_RX_POOL_SLOT_SIZE)
+
 extern errno_t nic_send_frame(async_sess_t *, void *, size_t);
 extern errno_t nic_callback_create(async_sess_t *, async_port_handler_t, void *);
 extern errno_t nic_get_state(async_sess_t *, nic_device_state_t *);
@@ -109,6 +117,8 @@ extern errno_t nic_poll_set_mode(async_sess_t *, nic_poll_mode_t,
     const struct timespec *);
 extern errno_t nic_poll_now(async_sess_t *);
 
+extern errno_t nic_rx_pool_share(async_sess_t *, void **, size_t *);
+
 #endif
 
 /** @}
@@ -123,6 +123,8 @@ extern errno_t ext4_superblock_set_volume_name(ext4_superblock_t *, const char *
 extern const char *ext4_superblock_get_last_mounted(ext4_superblock_t *);
 extern void ext4_superblock_set_last_mounted(ext4_superblock_t *, const char *);
 
+extern uint32_t ext4_superblock_get_journal_inode_number(ext4_superblock_t *);
+extern uint32_t ext4_superblock_get_journal_dev(ext4_superblock_t *);
 extern uint32_t ext4_superblock_get_last_orphan(ext4_superblock_t *);
 extern void ext4_superblock_set_last_orphan(ext4_superblock_t *, uint32_t);
 extern const uint32_t *ext4_superblock_get_hash_seed(ext4_superblock_t *);
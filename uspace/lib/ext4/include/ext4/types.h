@@ -227,11 +227,105 @@ typedef struct ext4_superblock {
 	EXT4_FEATURE_RO_COMPAT_GDT_CSUM | \
 	EXT4_FEATURE_RO_COMPAT_EXTRA_ISIZE)
 
+/*
+ * JBD2 journal
+ */
+#define EXT4_JOURNAL_MAGIC  0xC03B3998U
+
+#define EXT4_JOURNAL_DESCRIPTOR_BLOCK  1
+#define EXT4_JOURNAL_COMMIT_BLOCK      2
+#define EXT4_JOURNAL_SUPERBLOCK_V1     3
+#define EXT4_JOURNAL_SUPERBLOCK_V2     4
+#define EXT4_JOURNAL_REVOKE_BLOCK      5
+
+#define EXT4_JOURNAL_FEATURE_COMPAT_CHECKSUM        0x00000001
+
+#define EXT4_JOURNAL_FEATURE_INCOMPAT_REVOKE        0x00000001
+#define EXT4_JOURNAL_FEATURE_INCOMPAT_64BIT         0x00000002
+#define EXT4_JOURNAL_FEATURE_INCOMPAT_ASYNC_COMMIT  0x00000004
+#define EXT4_JOURNAL_FEATURE_INCOMPAT_CSUM_V2       0x00000008
+#define EXT4_JOURNAL_FEATURE_INCOMPAT_CSUM_V3       0x00000010
+#define EXT4_JOURNAL_FEATURE_INCOMPAT_FAST_COMMIT   0x00000020
+
+#define EXT4_JOURNAL_FEATURE_INCOMPAT_SUPP \
+	(EXT4_JOURNAL_FEATURE_INCOMPAT_REVOKE | \
+	EXT4_JOURNAL_FEATURE_INCOMPAT_64BIT | \
+	EXT4_JOURNAL_FEATURE_INCOMPAT_ASYNC_COMMIT | \
+	EXT4_JOURNAL_FEATURE_INCOMPAT_CSUM_V2 | \
+	EXT4_JOURNAL_FEATURE_INCOMPAT_CSUM_V3)
+
+#define EXT4_JOURNAL_FLAG_ESCAPE     1  /* Block had journal magic */
+#define EXT4_JOURNAL_FLAG_SAME_UUID  2  /* UUID not stored after the tag */
+#define EXT4_JOURNAL_FLAG_DELETED    4  /* Block deleted by this transaction */
+#define EXT4_JOURNAL_FLAG_LAST_TAG   8  /* Last tag in the descriptor */
+
+struct ext4_filesystem;
+
+typedef struct ext4_journal {
+	/** File system the journal belongs to */
+	struct ext4_filesystem *fs;
+	/** Copy of the journal superblock block (big-endian, on-disk format) */
+	uint8_t *jsb;
+	/** File system block of each journal block */
+	uint32_t *map;
+	/** First journal block usable for the log */
+	uint32_t first;
+	/** Number of journal blocks */
+	uint32_t maxlen;
+	uint32_t features_incompatible;
+	/** Size of a descriptor block tag */
+	size_t tag_size;
+	/** Size of descriptor block tail (checksum) */
+	size_t tail_size;
+	/** Checksum seed derived from the journal UUID */
+	uint32_t csum_seed;
+	/** The journal can be written by this driver */
+	bool writable;
+	/** ID of the next transaction */
+	uint32_t sequence;
+
+	/** Protects the fields below */
+	fibril_mutex_t lock;
+	/** Signalled when handles or committing change */
+	fibril_condvar_t cv;
+	/** Dirty blocks are captured in the running transaction */
+	bool active;
+	/** Number of open handles */
+	unsigned handles;
+	/** A transaction is being committed */
+	bool committing;
+	/** Blocks of the running transaction (pinned in the block cache) */
+	hash_table_t trans;
+	/** Number of blocks in the running transaction */
+	size_t trans_blocks;
+	/** Transaction size at which a commit is forced */
+	size_t trans_max;
+	/** Periodic commit fibril should quit */
+	bool quit;
+	/** Periodic commit fibril is running */
+	bool timer_running;
+	/** Wakes up the periodic commit fibril */
+	fibril_condvar_t timer_cv;
+
+	/** Staging buffer for sequential log and checkpoint writes */
+	uint8_t *buf;
+	/** Size of staging buffer in blocks */
+	size_t buf_blocks;
+	/** Number of blocks filled in the staging buffer */
+	size_t buf_fill;
+	/** Journal block where the staging buffer goes */
+	uint32_t buf_pos;
+	/** Descriptor block being built */
+	uint8_t *desc;
+} ext4_journal_t;
+
 typedef struct ext4_filesystem {
 	service_id_t device;
 	ext4_superblock_t *superblock;
 	aoff64_t inode_block_limits[4];
 	aoff64_t inode_blocks_per_level[4];
+	/** Journal or @c NULL if the file system does not have one */
+	ext4_journal_t *journal;
 } ext4_filesystem_t;
 
 /** Size of buffer for volume name. To hold 16 latin-1 chars encoded as UTF-8
@@ -537,6 +631,9 @@ typedef struct ext4_extent_path {
 
 #define EXT4_EXTENT_MAGIC  0xF30A
 
+/** Extents longer than this are uninitialized, the excess is the length */
+#define EXT4_EXTENT_MAX_INIT_LEN  32768
+
 #define	EXT4_EXTENT_FIRST(header) \
 	((ext4_extent_t *) (((void *) (header)) + sizeof(ext4_extent_header_t)))
 
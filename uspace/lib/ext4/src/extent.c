@@ -441,6 +441,116 @@ errno_t ext4_extent_find_block(ext4_inode_ref_t *inode_ref, uint32_t iblock,
 	return rc;
 }
 
+/** Find run of physical blocks in the extent tree by logical block number.
+ *
+ * Like ext4_extent_find_block(), but also determines how many logical
+ * blocks starting at @a iblock are mapped to consecutive physical blocks
+ * by the same extent. For an unallocated block, the number of following
+ * unallocated blocks up to the next extent in the leaf is returned.
+ * Blocks of an uninitialized extent read as zeros and are reported as
+ * unallocated.
+ *
+ * @param inode_ref I-node to load block from
+ * @param iblock    Logical block number to find
+ * @param fblock    Output value for physical block number,
+ *                  zero if the block is not allocated or not initialized
+ * @param count     Output value for length of the run (at least one)
+ *
+ * @return Error code
+ *
+ */
+errno_t ext4_extent_find_block_run(ext4_inode_ref_t *inode_ref,
+    uint32_t iblock, uint32_t *fblock, uint32_t *count)
+{
+	errno_t rc = EOK;
+	/* Compute bound defined by i-node size */
+	uint64_t inode_size =
+	    ext4_inode_get_size(inode_ref->fs->superblock, inode_ref->inode);
+
+	uint32_t block_size =
+	    ext4_superblock_get_block_size(inode_ref->fs->superblock);
+
+	uint32_t last_idx = (inode_size - 1) / block_size;
+
+	/* Check if requested iblock is not over size of i-node */
+	if (inode_size == 0 || iblock > last_idx) {
+		*fblock = 0;
+		*count = 1;
+		return EOK;
+	}
+
+	block_t *block = NULL;
+
+	/* Walk through extent tree */
+	ext4_extent_header_t *header =
+	    ext4_inode_get_extent_header(inode_ref->inode);
+
+	while (ext4_extent_header_get_depth(header) != 0) {
+		/* Search index in node */
+		ext4_extent_index_t *index;
+		ext4_extent_binsearch_idx(header, &index, iblock);
+
+		/* Load child node and set values for the next iteration */
+		uint64_t child = ext4_extent_index_get_leaf(index);
+
+		if (block != NULL) {
+			rc = block_put(block);
+			if (rc != EOK)
+				return rc;
+		}
+
+		rc = block_get(&block, inode_ref->fs->device, child,
+		    BLOCK_FLAGS_NONE);
+		if (rc != EOK)
+			return rc;
+
+		header = (ext4_extent_header_t *)block->data;
+	}
+
+	/* Search extent in the leaf block */
+	ext4_extent_t *extent = NULL;
+	ext4_extent_binsearch(header, &extent, iblock);
+
+	*fblock = 0;
+	*count = 1;
+
+	if (extent != NULL) {
+		uint32_t first = ext4_extent_get_first_block(extent);
+		uint32_t length = ext4_extent_get_block_count(extent);
+		ext4_extent_t *last = EXT4_EXTENT_FIRST(header) +
+		    ext4_extent_header_get_entries_count(header) - 1;
+
+		bool uninit = false;
+
+		/* Uninitialized extents store a biased length */
+		if (length > EXT4_EXTENT_MAX_INIT_LEN) {
+			length -= EXT4_EXTENT_MAX_INIT_LEN;
+			uninit = true;
+		}
+
+		if (iblock < first) {
+			/* Hole before the first extent */
+			*count = first - iblock;
+		} else if (iblock - first < length) {
+			if (!uninit) {
+				*fblock = ext4_extent_get_start(extent) +
+				    iblock - first;
+			}
+			*count = length - (iblock - first);
+		} else if (extent < last) {
+			/* Hole before the next extent */
+			*count = ext4_extent_get_first_block(extent + 1) -
+			    iblock;
+		}
+	}
+
+	/* Cleanup */
+	if (block != NULL)
+		rc = block_put(block);
+
+	return rc;
+}
+
 /** Find extent for specified iblock.
  *
  * This function is used for finding block in the extent tree with
@@ -36,6 +36,7 @@
  * @brief More complex filesystem operations.
  */
 
+#include <assert.h>
 #include <byteorder.h>
 #include <errno.h>
 #include <mem.h>
@@ -43,6 +44,7 @@
 #include <crypto.h>
 #include <ipc/vfs.h>
 #include <libfs.h>
+#include <macros.h>
 #include <stdlib.h>
 #include "ext4/balloc.h"
 #include "ext4/bitmap.h"
@@ -53,6 +55,7 @@
 #include "ext4/filesystem.h"
 #include "ext4/ialloc.h"
 #include "ext4/inode.h"
+#include "ext4/journal.h"
 #include "ext4/ops.h"
 #include "ext4/superblock.h"
 
@@ -61,6 +64,7 @@ static errno_t ext4_filesystem_init_block_groups(ext4_filesystem_t *);
 static errno_t ext4_filesystem_alloc_this_inode(ext4_filesystem_t *,
     uint32_t, ext4_inode_ref_t **, int);
 static uint32_t ext4_filesystem_inodes_per_block(ext4_superblock_t *);
+static errno_t ext4_filesystem_init_journal(ext4_filesystem_t *, bool);
 
 /** Initialize filesystem for opening.
  *
@@ -69,12 +73,13 @@ static uint32_t ext4_filesystem_inodes_per_block(ext4_superblock_t *);
  * @param fs         Filesystem instance to be initialized
  * @param service_id Block device to open
  * @param cmode      Cache mode
+ * @param replay     Replay the journal (otherwise the device is not written)
  *
  * @return Error code
  *
  */
 static errno_t ext4_filesystem_init(ext4_filesystem_t *fs, service_id_t service_id,
-    enum cache_mode cmode)
+    enum cache_mode cmode, bool replay)
 {
 	errno_t rc;
 	ext4_superblock_t *temp_superblock = NULL;
@@ -116,6 +121,12 @@ static errno_t ext4_filesystem_init(ext4_filesystem_t *fs, service_id_t service_
 
 	/* Return loaded superblock */
 	fs->superblock = temp_superblock;
+	temp_superblock = NULL;
+
+	/* Replay the journal before looking at anything else */
+	rc = ext4_filesystem_init_journal(fs, replay);
+	if (rc != EOK)
+		goto err_2;
 
 	uint16_t state = ext4_superblock_get_state(fs->superblock);
 
@@ -139,7 +150,13 @@ static errno_t ext4_filesystem_init(ext4_filesystem_t *fs, service_id_t service_
 
 	return EOK;
 err_2:
+	if (fs->journal != NULL) {
+		(void) ext4_journal_close(fs->journal);
+		fs->journal = NULL;
+	}
 	block_cache_fini(fs->device);
+	temp_superblock = fs->superblock;
+	fs->superblock = NULL;
 err_1:
 	block_fini(fs->device);
 err:
@@ -148,6 +165,78 @@ err:
 	return rc;
 }
 
+/** Open and replay the journal.
+ *
+ * If the file system has a journal with committed transactions, they are
+ * written to the file system and the superblock is read again. A volume
+ * which needs recovery cannot be mounted unless its journal is replayed.
+ *
+ * @param fs     File system with superblock loaded and block cache set up
+ * @param replay Replay the journal. If false, the journal is not opened
+ *               and the file system is only examined as is.
+ *
+ * @return Error code
+ *
+ */
+static errno_t ext4_filesystem_init_journal(ext4_filesystem_t *fs, bool replay)
+{
+	ext4_superblock_t *superblock;
+	errno_t rc;
+
+	bool recover = ext4_superblock_has_feature_incompatible(fs->superblock,
+	    EXT4_FEATURE_INCOMPAT_RECOVER);
+
+	if (!replay) {
+		/* Recovery will be done when mounting */
+		ext4_superblock_set_features_incompatible(fs->superblock,
+		    ext4_superblock_get_features_incompatible(fs->superblock) &
+		    ~EXT4_FEATURE_INCOMPAT_RECOVER);
+		return EOK;
+	}
+
+	if (!ext4_superblock_has_feature_compatible(fs->superblock,
+	    EXT4_FEATURE_COMPAT_HAS_JOURNAL)) {
+		/* Recovery flag without a journal, the volume is unusable */
+		return recover ? ENOTSUP : EOK;
+	}
+
+	rc = ext4_journal_open(fs, &fs->journal);
+	if (rc != EOK) {
+		/* Without a usable journal the volume is mounted unjournaled */
+		fs->journal = NULL;
+		return recover ? rc : EOK;
+	}
+
+	if (!ext4_journal_needs_recovery(fs->journal)) {
+		if (recover) {
+			/* Journal is empty, nothing to replay */
+			ext4_superblock_set_features_incompatible(fs->superblock,
+			    ext4_superblock_get_features_incompatible(
+			    fs->superblock) & ~EXT4_FEATURE_INCOMPAT_RECOVER);
+		}
+
+		return EOK;
+	}
+
+	rc = ext4_journal_recover(fs->journal);
+	if (rc != EOK)
+		return rc;
+
+	/* The superblock may have been replayed */
+	rc = ext4_superblock_read_direct(fs->device, &superblock);
+	if (rc != EOK)
+		return rc;
+
+	ext4_superblock_release(fs->superblock);
+	fs->superblock = superblock;
+
+	ext4_superblock_set_features_incompatible(fs->superblock,
+	    ext4_superblock_get_features_incompatible(fs->superblock) &
+	    ~EXT4_FEATURE_INCOMPAT_RECOVER);
+
+	return EOK;
+}
+
 /** Finalize filesystem.
  *
  * @param fs Filesystem to be finalized
@@ -155,6 +244,9 @@ err:
  */
 static void ext4_filesystem_fini(ext4_filesystem_t *fs)
 {
+	if (fs->journal != NULL)
+		(void) ext4_journal_close(fs->journal);
+
 	/* Release memory space for superblock */
 	free(fs->superblock);
 
@@ -300,7 +392,7 @@ errno_t ext4_filesystem_create(ext4_cfg_t *cfg, service_id_t service_id)
 		goto err;
 
 	/* Open file system */
-	rc = ext4_filesystem_init(fs, service_id, CACHE_MODE_WT);
+	rc = ext4_filesystem_init(fs, service_id, CACHE_MODE_WT, false);
 	if (rc != EOK)
 		goto err;
 
@@ -389,7 +481,7 @@ errno_t ext4_filesystem_probe(service_id_t service_id,
 		return ENOMEM;
 
 	/* Initialize the file system for opening */
-	rc = ext4_filesystem_init(fs, service_id, CACHE_MODE_WT);
+	rc = ext4_filesystem_init(fs, service_id, CACHE_MODE_WT, false);
 	if (rc != EOK) {
 		free(fs);
 		return rc;
@@ -434,7 +526,7 @@ errno_t ext4_filesystem_open(ext4_instance_t *inst, service_id_t service_id,
 	inst->filesystem = fs;
 
 	/* Initialize the file system for opening */
-	rc = ext4_filesystem_init(fs, service_id, cmode);
+	rc = ext4_filesystem_init(fs, service_id, cmode, true);
 	if (rc != EOK)
 		goto error;
 
@@ -445,8 +537,22 @@ errno_t ext4_filesystem_open(ext4_instance_t *inst, service_id_t service_id,
 	if (rc != EOK)
 		goto error;
 
-	/* Mark system as mounted */
-	ext4_superblock_set_state(fs->superblock, EXT4_SUPERBLOCK_STATE_ERROR_FS);
+	/*
+	 * With write-back caching, updates are journaled. A journaled volume
+	 * is marked mounted by the recovery flag as it is consistent after
+	 * replaying the journal.
+	 */
+	if (fs->journal != NULL && cmode == CACHE_MODE_WB &&
+	    ext4_journal_activate(fs->journal) == EOK) {
+		ext4_superblock_set_features_incompatible(fs->superblock,
+		    ext4_superblock_get_features_incompatible(fs->superblock) |
+		    EXT4_FEATURE_INCOMPAT_RECOVER);
+	} else {
+		/* Mark system as mounted */
+		ext4_superblock_set_state(fs->superblock,
+		    EXT4_SUPERBLOCK_STATE_ERROR_FS);
+	}
+
 	rc = ext4_superblock_write_direct(fs->device, fs->superblock);
 	if (rc != EOK)
 		goto error;
@@ -481,9 +587,22 @@ error:
  */
 errno_t ext4_filesystem_close(ext4_filesystem_t *fs)
 {
+	errno_t rc;
+
+	/* Commit outstanding updates and empty the journal */
+	if (fs->journal != NULL) {
+		rc = ext4_journal_close(fs->journal);
+		if (rc != EOK)
+			return rc;
+		fs->journal = NULL;
+	}
+
 	/* Write the superblock to the device */
 	ext4_superblock_set_state(fs->superblock, EXT4_SUPERBLOCK_STATE_VALID_FS);
-	errno_t rc = ext4_superblock_write_direct(fs->device, fs->superblock);
+	ext4_superblock_set_features_incompatible(fs->superblock,
+	    ext4_superblock_get_features_incompatible(fs->superblock) &
+	    ~EXT4_FEATURE_INCOMPAT_RECOVER);
+	rc = ext4_superblock_write_direct(fs->device, fs->superblock);
 	if (rc != EOK)
 		return rc;
 
@@ -1689,6 +1808,66 @@ errno_t ext4_filesystem_get_inode_data_block_index(ext4_inode_ref_t *inode_ref,
 	return EOK;
 }
 
+/** Get run of consecutive physical blocks by logical index of the block.
+ *
+ * Determines the physical address of @a iblock and how many of the
+ * following logical blocks map to consecutive physical blocks. For an
+ * unallocated block, the run consists of unallocated blocks.
+ *
+ * @param inode_ref I-node to read block addresses from
+ * @param iblock    Logical index of the first block
+ * @param max       Maximum length of the run
+ * @param fblock    Output pointer for physical address of the first block,
+ *                  zero if the block is not allocated
+ * @param count     Output pointer for length of the run (at least one)
+ *
+ * @return Error code
+ *
+ */
+errno_t ext4_filesystem_get_inode_data_block_run(ext4_inode_ref_t *inode_ref,
+    aoff64_t iblock, uint32_t max, uint32_t *fblock, uint32_t *count)
+{
+	ext4_filesystem_t *fs = inode_ref->fs;
+	uint32_t first;
+	uint32_t next;
+	uint32_t n;
+	errno_t rc;
+
+	assert(max > 0);
+
+	/* Handle i-node using extents */
+	if ((ext4_superblock_has_feature_incompatible(fs->superblock,
+	    EXT4_FEATURE_INCOMPAT_EXTENTS)) &&
+	    (ext4_inode_has_flag(inode_ref->inode, EXT4_INODE_FLAG_EXTENTS))) {
+		rc = ext4_extent_find_block_run(inode_ref, iblock, fblock, &n);
+		if (rc != EOK)
+			return rc;
+
+		*count = min(n, max);
+		return EOK;
+	}
+
+	/* Block map, follow the mapping block by block */
+	rc = ext4_filesystem_get_inode_data_block_index(inode_ref, iblock,
+	    &first);
+	if (rc != EOK)
+		return rc;
+
+	for (n = 1; n < max; n++) {
+		rc = ext4_filesystem_get_inode_data_block_index(inode_ref,
+		    iblock + n, &next);
+		if (rc != EOK)
+			return rc;
+
+		if (first == 0 ? next != 0 : next != first + n)
+			break;
+	}
+
+	*fblock = first;
+	*count = n;
+	return EOK;
+}
+
 /** Set physical block address for the block logical address into the i-node.
  *
  * @param inode_ref I-node to set block address to
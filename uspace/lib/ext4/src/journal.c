@@ -0,0 +1,1410 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libext4
+ * @{
+ */
+/**
+ * @file  journal.c
+ * @brief JBD2-compatible journal.
+ *
+ * The journal is replayed when the file system is mounted. While the file
+ * system is mounted in write-back mode, metadata blocks dirtied by file
+ * system operations are held in the block cache and collected into
+ * a compound transaction. The transaction is written to the journal
+ * sequentially, committed and then written back to its home location
+ * (checkpointed), after which the journal is empty again.
+ */
+
+#include <adt/hash.h>
+#include <adt/hash_table.h>
+#include <assert.h>
+#include <errno.h>
+#include <fibril.h>
+#include <fibril_synch.h>
+#include <macros.h>
+#include <mem.h>
+#include <stdlib.h>
+#include <time.h>
+#include "ext4/filesystem.h"
+#include "ext4/inode.h"
+#include "ext4/journal.h"
+#include "ext4/superblock.h"
+
+/*
+ * Journal superblock field offsets
+ */
+#define JSB_BLOCKTYPE         0x04
+#define JSB_BLOCKSIZE         0x0c
+#define JSB_MAXLEN            0x10
+#define JSB_FIRST             0x14
+#define JSB_SEQUENCE          0x18
+#define JSB_START             0x1c
+#define JSB_FEATURE_COMPAT    0x24
+#define JSB_FEATURE_INCOMPAT  0x28
+#define JSB_UUID              0x30
+#define JSB_CHECKSUM_TYPE     0x50
+#define JSB_CHECKSUM          0xfc
+/** Size of the journal superblock structure */
+#define JSB_SIZE              1024
+
+/** Size of the common block header (magic, type, sequence) */
+#define JHDR_SIZE  12
+/** Offset of the first checksum in the commit block */
+#define JCOMMIT_CHKSUM  0x10
+/** Offset of the commit time in the commit block */
+#define JCOMMIT_SEC     0x30
+#define JCOMMIT_NSEC    0x38
+/** Offset of the byte count in the revoke block */
+#define JREVOKE_COUNT   0x0c
+
+#define JSB_CHECKSUM_CRC32C  4
+
+/** Interval of the periodic commit (5 s) */
+#define EXT4_JOURNAL_COMMIT_INTERVAL  (5 * 1000 * 1000)
+/** Largest number of blocks in one transaction */
+#define EXT4_JOURNAL_TRANS_MAX  1024
+/** Number of blocks in the staging buffer */
+#define EXT4_JOURNAL_BUF_BLOCKS  16
+
+/** Recovery pass */
+typedef enum {
+	/** Find the end of the log */
+	ext4_jpass_scan,
+	/** Collect revoke records */
+	ext4_jpass_revoke,
+	/** Write logged blocks to their home location */
+	ext4_jpass_replay
+} ext4_journal_pass_t;
+
+/** Recovery state */
+typedef struct {
+	/** ID of the first transaction not to be replayed */
+	uint32_t end;
+	/** Revoked blocks */
+	hash_table_t revoked;
+} ext4_journal_recovery_t;
+
+/** Revoke record */
+typedef struct {
+	ht_link_t link;
+	uint64_t block;
+	/** Latest transaction which revoked the block */
+	uint32_t sequence;
+} ext4_journal_revoke_t;
+
+/** Block of the running transaction */
+typedef struct {
+	ht_link_t link;
+	block_t *block;
+} ext4_journal_entry_t;
+
+static uint32_t crc32c_table[256];
+static bool crc32c_ready;
+
+/** Compute CRC-32C (Castagnoli) without pre- and post-inversion.
+ *
+ * This is the checksum used by JBD2.
+ *
+ * @param crc  Initial value
+ * @param data Data
+ * @param size Size of data in bytes
+ *
+ * @return Updated checksum
+ *
+ */
+static uint32_t ext4_journal_crc32c(uint32_t crc, const void *data, size_t size)
+{
+	const uint8_t *p = data;
+
+	if (!crc32c_ready) {
+		for (unsigned i = 0; i < 256; i++) {
+			uint32_t c = i;
+			for (unsigned j = 0; j < 8; j++)
+				c = (c >> 1) ^ ((c & 1) ? 0x82f63b78U : 0);
+			crc32c_table[i] = c;
+		}
+		crc32c_ready = true;
+	}
+
+	while (size-- > 0)
+		crc = crc32c_table[(crc ^ *p++) & 0xff] ^ (crc >> 8);
+
+	return crc;
+}
+
+static uint32_t ext4_journal_get32(const uint8_t *p)
+{
+	return ((uint32_t) p[0] << 24) | ((uint32_t) p[1] << 16) |
+	    ((uint32_t) p[2] << 8) | p[3];
+}
+
+static uint16_t ext4_journal_get16(const uint8_t *p)
+{
+	return ((uint16_t) p[0] << 8) | p[1];
+}
+
+static void ext4_journal_set32(uint8_t *p, uint32_t value)
+{
+	p[0] = value >> 24;
+	p[1] = value >> 16;
+	p[2] = value >> 8;
+	p[3] = value;
+}
+
+static void ext4_journal_set16(uint8_t *p, uint16_t value)
+{
+	p[0] = value >> 8;
+	p[1] = value;
+}
+
+/** Check whether the journal uses checksums version 2 or 3. */
+static bool ext4_journal_has_csum(ext4_journal_t *journal)
+{
+	return (journal->features_incompatible &
+	    (EXT4_JOURNAL_FEATURE_INCOMPAT_CSUM_V2 |
+	    EXT4_JOURNAL_FEATURE_INCOMPAT_CSUM_V3)) != 0;
+}
+
+/** Get size of the journal block. */
+static size_t ext4_journal_block_size(ext4_journal_t *journal)
+{
+	return ext4_superblock_get_block_size(journal->fs->superblock);
+}
+
+/** Get journal block following @a pos in the circular log. */
+static uint32_t ext4_journal_next(ext4_journal_t *journal, uint32_t pos)
+{
+	return (pos + 1 < journal->maxlen) ? pos + 1 : journal->first;
+}
+
+/* Hash table interface for blocks of the running transaction */
+
+static size_t ext4_journal_entry_key_hash(const void *key)
+{
+	const aoff64_t *lba = key;
+	return hash_mix64(*lba);
+}
+
+static size_t ext4_journal_entry_hash(const ht_link_t *item)
+{
+	ext4_journal_entry_t *entry =
+	    hash_table_get_inst(item, ext4_journal_entry_t, link);
+	return hash_mix64(entry->block->lba);
+}
+
+static bool ext4_journal_entry_key_equal(const void *key,
+    const ht_link_t *item)
+{
+	const aoff64_t *lba = key;
+	ext4_journal_entry_t *entry =
+	    hash_table_get_inst(item, ext4_journal_entry_t, link);
+	return entry->block->lba == *lba;
+}
+
+static void ext4_journal_entry_remove(ht_link_t *item)
+{
+	free(hash_table_get_inst(item, ext4_journal_entry_t, link));
+}
+
+static hash_table_ops_t ext4_journal_entry_ops = {
+	.hash = ext4_journal_entry_hash,
+	.key_hash = ext4_journal_entry_key_hash,
+	.key_equal = ext4_journal_entry_key_equal,
+	.equal = NULL,
+	.remove_callback = ext4_journal_entry_remove
+};
+
+/* Hash table interface for revoke records */
+
+static size_t ext4_journal_revoke_key_hash(const void *key)
+{
+	const uint64_t *block = key;
+	return hash_mix64(*block);
+}
+
+static size_t ext4_journal_revoke_hash(const ht_link_t *item)
+{
+	ext4_journal_revoke_t *rec =
+	    hash_table_get_inst(item, ext4_journal_revoke_t, link);
+	return hash_mix64(rec->block);
+}
+
+static bool ext4_journal_revoke_key_equal(const void *key,
+    const ht_link_t *item)
+{
+	const uint64_t *block = key;
+	ext4_journal_revoke_t *rec =
+	    hash_table_get_inst(item, ext4_journal_revoke_t, link);
+	return rec->block == *block;
+}
+
+static void ext4_journal_revoke_remove(ht_link_t *item)
+{
+	free(hash_table_get_inst(item, ext4_journal_revoke_t, link));
+}
+
+static hash_table_ops_t ext4_journal_revoke_ops = {
+	.hash = ext4_journal_revoke_hash,
+	.key_hash = ext4_journal_revoke_key_hash,
+	.key_equal = ext4_journal_revoke_key_equal,
+	.equal = NULL,
+	.remove_callback = ext4_journal_revoke_remove
+};
+
+/** Read journal block.
+ *
+ * @param journal Journal
+ * @param pos     Journal block index
+ * @param buf     Buffer for one block
+ *
+ * @return Error code
+ *
+ */
+static errno_t ext4_journal_read(ext4_journal_t *journal, uint32_t pos,
+    void *buf)
+{
+	return block_read_lblocks(journal->fs->device, journal->map[pos], 1,
+	    buf);
+}
+
+/** Write journal superblock.
+ *
+ * @param journal Journal
+ * @param start   First block of the log, zero if the journal is empty
+ * @param seq     ID of the first transaction in the log
+ *
+ * @return Error code
+ *
+ */
+static errno_t ext4_journal_write_jsb(ext4_journal_t *journal, uint32_t start,
+    uint32_t seq)
+{
+	ext4_journal_set32(journal->jsb + JSB_START, start);
+	ext4_journal_set32(journal->jsb + JSB_SEQUENCE, seq);
+
+	if (ext4_journal_has_csum(journal)) {
+		ext4_journal_set32(journal->jsb + JSB_CHECKSUM, 0);
+		uint32_t csum = ext4_journal_crc32c(~0U, journal->jsb,
+		    JSB_SIZE);
+		ext4_journal_set32(journal->jsb + JSB_CHECKSUM, csum);
+	}
+
+	return block_write_lblocks(journal->fs->device, journal->map[0], 1,
+	    journal->jsb);
+}
+
+/** Flush write cache of the device.
+ *
+ * @param journal Journal
+ *
+ * @return Error code
+ *
+ */
+static errno_t ext4_journal_flush(ext4_journal_t *journal)
+{
+	errno_t rc = block_sync_cache(journal->fs->device, 0, 0);
+
+	/* Devices without a write cache need not support flushing */
+	return rc == ENOTSUP ? EOK : rc;
+}
+
+/** Map blocks of the journal i-node.
+ *
+ * @param journal   Journal
+ * @param inode_ref Journal i-node
+ *
+ * @return Error code
+ *
+ */
+static errno_t ext4_journal_map(ext4_journal_t *journal,
+    ext4_inode_ref_t *inode_ref)
+{
+	uint32_t iblock = 0;
+
+	journal->map = calloc(journal->maxlen, sizeof(uint32_t));
+	if (journal->map == NULL)
+		return ENOMEM;
+
+	while (iblock < journal->maxlen) {
+		uint32_t fblock;
+		uint32_t count;
+
+		errno_t rc = ext4_filesystem_get_inode_data_block_run(
+		    inode_ref, iblock, journal->maxlen - iblock, &fblock,
+		    &count);
+		if (rc != EOK)
+			return rc;
+
+		/* The journal must not have holes */
+		if (fblock == 0)
+			return EIO;
+
+		for (uint32_t i = 0; i < count; i++)
+			journal->map[iblock + i] = fblock + i;
+
+		iblock += count;
+	}
+
+	return EOK;
+}
+
+/** Open the journal of a file system.
+ *
+ * Reads the journal superblock and maps the journal blocks. The journal
+ * is not replayed and transactions are not started yet.
+ *
+ * @param fs       File system
+ * @param rjournal Output pointer to the journal
+ *
+ * @return Error code
+ *
+ */
+errno_t ext4_journal_open(ext4_filesystem_t *fs, ext4_journal_t **rjournal)
+{
+	ext4_superblock_t *sb = fs->superblock;
+	ext4_inode_ref_t *inode_ref = NULL;
+	ext4_journal_t *journal;
+	uint32_t fblock;
+	errno_t rc;
+
+	/* External journals are not supported */
+	if (ext4_superblock_get_journal_dev(sb) != 0)
+		return ENOTSUP;
+
+	uint32_t index = ext4_superblock_get_journal_inode_number(sb);
+	if (index == 0)
+		return ENOTSUP;
+
+	journal = calloc(1, sizeof(ext4_journal_t));
+	if (journal == NULL)
+		return ENOMEM;
+
+	journal->fs = fs;
+	fibril_mutex_initialize(&journal->lock);
+	fibril_condvar_initialize(&journal->cv);
+	fibril_condvar_initialize(&journal->timer_cv);
+
+	size_t bsize = ext4_superblock_get_block_size(sb);
+	journal->buf_blocks = EXT4_JOURNAL_BUF_BLOCKS;
+	journal->buf = malloc(journal->buf_blocks * bsize);
+	journal->jsb = malloc(bsize);
+	journal->desc = malloc(bsize);
+	if (journal->buf == NULL || journal->jsb == NULL ||
+	    journal->desc == NULL) {
+		rc = ENOMEM;
+		goto error;
+	}
+
+	rc = ext4_filesystem_get_inode_ref(fs, index, &inode_ref);
+	if (rc != EOK)
+		goto error;
+
+	/* Read journal superblock */
+	rc = ext4_filesystem_get_inode_data_block_index(inode_ref, 0, &fblock);
+	if (rc != EOK)
+		goto error;
+
+	if (fblock == 0) {
+		rc = EIO;
+		goto error;
+	}
+
+	rc = block_read_lblocks(fs->device, fblock, 1, journal->jsb);
+	if (rc != EOK)
+		goto error;
+
+	uint8_t *jsb = journal->jsb;
+	uint32_t blocktype = ext4_journal_get32(jsb + JSB_BLOCKTYPE);
+	if (ext4_journal_get32(jsb) != EXT4_JOURNAL_MAGIC ||
+	    (blocktype != EXT4_JOURNAL_SUPERBLOCK_V1 &&
+	    blocktype != EXT4_JOURNAL_SUPERBLOCK_V2)) {
+		rc = EINVAL;
+		goto error;
+	}
+
+	uint64_t isize = ext4_inode_get_size(sb, inode_ref->inode);
+	journal->maxlen = ext4_journal_get32(jsb + JSB_MAXLEN);
+	journal->first = ext4_journal_get32(jsb + JSB_FIRST);
+	if (ext4_journal_get32(jsb + JSB_BLOCKSIZE) != bsize ||
+	    journal->maxlen > isize / bsize || journal->first == 0 ||
+	    journal->first >= journal->maxlen) {
+		rc = EINVAL;
+		goto error;
+	}
+
+	uint32_t compat = 0;
+	if (blocktype == EXT4_JOURNAL_SUPERBLOCK_V2) {
+		compat = ext4_journal_get32(jsb + JSB_FEATURE_COMPAT);
+		journal->features_incompatible =
+		    ext4_journal_get32(jsb + JSB_FEATURE_INCOMPAT);
+	}
+
+	if (journal->features_incompatible &
+	    EXT4_JOURNAL_FEATURE_INCOMPAT_CSUM_V3) {
+		journal->tag_size = 16;
+	} else {
+		journal->tag_size = 12;
+		if (journal->features_incompatible &
+		    EXT4_JOURNAL_FEATURE_INCOMPAT_CSUM_V2)
+			journal->tag_size += 2;
+		if ((journal->features_incompatible &
+		    EXT4_JOURNAL_FEATURE_INCOMPAT_64BIT) == 0)
+			journal->tag_size -= 4;
+	}
+
+	if (ext4_journal_has_csum(journal)) {
+		journal->tail_size = sizeof(uint32_t);
+		journal->csum_seed = ext4_journal_crc32c(~0U, jsb + JSB_UUID,
+		    16);
+		jsb[JSB_CHECKSUM_TYPE] = JSB_CHECKSUM_CRC32C;
+	}
+
+	/*
+	 * Version 1 commit block checksums and fast commits are not
+	 * supported when writing the journal.
+	 */
+	journal->writable = (journal->features_incompatible &
+	    ~EXT4_JOURNAL_FEATURE_INCOMPAT_SUPP) == 0 &&
+	    (compat & EXT4_JOURNAL_FEATURE_COMPAT_CHECKSUM) == 0;
+
+	journal->sequence = ext4_journal_get32(jsb + JSB_SEQUENCE);
+
+	/* Keep the transaction comfortably within the log */
+	journal->trans_max = min((journal->maxlen - journal->first) / 4,
+	    EXT4_JOURNAL_TRANS_MAX);
+
+	rc = ext4_journal_map(journal, inode_ref);
+	if (rc != EOK)
+		goto error;
+
+	if (!hash_table_create(&journal->trans, 0, 0,
+	    &ext4_journal_entry_ops)) {
+		rc = ENOMEM;
+		goto error;
+	}
+
+	rc = ext4_filesystem_put_inode_ref(inode_ref);
+	inode_ref = NULL;
+	if (rc != EOK) {
+		hash_table_destroy(&journal->trans);
+		goto error;
+	}
+
+	*rjournal = journal;
+	return EOK;
+error:
+	if (inode_ref != NULL)
+		ext4_filesystem_put_inode_ref(inode_ref);
+	free(journal->map);
+	free(journal->jsb);
+	free(journal->desc);
+	free(journal->buf);
+	free(journal);
+	return rc;
+}
+
+/** Check whether the journal contains transactions to be replayed.
+ *
+ * @param journal Journal
+ *
+ * @return True if the journal needs to be replayed
+ *
+ */
+bool ext4_journal_needs_recovery(ext4_journal_t *journal)
+{
+	return ext4_journal_get32(journal->jsb + JSB_START) != 0;
+}
+
+/** Parse a descriptor block tag.
+ *
+ * @param journal Journal
+ * @param tag     Tag
+ * @param block   Output pointer for the home block number
+ * @param flags   Output pointer for the tag flags
+ *
+ */
+static void ext4_journal_parse_tag(ext4_journal_t *journal, const uint8_t *tag,
+    uint64_t *block, uint32_t *flags)
+{
+	*block = ext4_journal_get32(tag);
+
+	if (journal->features_incompatible &
+	    EXT4_JOURNAL_FEATURE_INCOMPAT_CSUM_V3)
+		*flags = ext4_journal_get32(tag + 4);
+	else
+		*flags = ext4_journal_get16(tag + 6);
+
+	if (journal->features_incompatible &
+	    EXT4_JOURNAL_FEATURE_INCOMPAT_64BIT)
+		*block |= (uint64_t) ext4_journal_get32(tag + 8) << 32;
+}
+
+/** Replay one logged block.
+ *
+ * @param journal  Journal
+ * @param recovery Recovery state
+ * @param seq      Transaction ID
+ * @param pos      Journal block holding the logged data
+ * @param block    Home location of the block
+ * @param flags    Tag flags
+ *
+ * @return Error code
+ *
+ */
+static errno_t ext4_journal_replay_block(ext4_journal_t *journal,
+    ext4_journal_recovery_t *recovery, uint32_t seq, uint32_t pos,
+    uint64_t block, uint32_t flags)
+{
+	size_t bsize = ext4_journal_block_size(journal);
+	uint8_t *data = journal->buf + bsize;
+
+	ht_link_t *link = hash_table_find(&recovery->revoked, &block);
+	if (link != NULL) {
+		ext4_journal_revoke_t *rec =
+		    hash_table_get_inst(link, ext4_journal_revoke_t, link);
+		/* Revoked by this or a later transaction */
+		if ((int32_t) (rec->sequence - seq) >= 0)
+			return EOK;
+	}
+
+	errno_t rc = ext4_journal_read(journal, pos, data);
+	if (rc != EOK)
+		return rc;
+
+	if (flags & EXT4_JOURNAL_FLAG_ESCAPE)
+		ext4_journal_set32(data, EXT4_JOURNAL_MAGIC);
+
+	return block_write_lblocks(journal->fs->device, block, 1, data);
+}
+
+/** Record revoke records of a revoke block.
+ *
+ * @param journal  Journal
+ * @param recovery Recovery state
+ * @param seq      Transaction ID
+ * @param rblock   Revoke block
+ *
+ * @return Error code
+ *
+ */
+static errno_t ext4_journal_add_revokes(ext4_journal_t *journal,
+    ext4_journal_recovery_t *recovery, uint32_t seq, const uint8_t *rblock)
+{
+	size_t bsize = ext4_journal_block_size(journal);
+	size_t rsize = (journal->features_incompatible &
+	    EXT4_JOURNAL_FEATURE_INCOMPAT_64BIT) ? 8 : 4;
+	size_t count = ext4_journal_get32(rblock + JREVOKE_COUNT);
+
+	if (count > bsize - journal->tail_size)
+		return EIO;
+
+	for (size_t off = JREVOKE_COUNT + 4; off + rsize <= count;
+	    off += rsize) {
+		uint64_t block;
+
+		if (rsize == 8) {
+			block = ((uint64_t) ext4_journal_get32(rblock + off) << 32) |
+			    ext4_journal_get32(rblock + off + 4);
+		} else {
+			block = ext4_journal_get32(rblock + off);
+		}
+
+		ht_link_t *link = hash_table_find(&recovery->revoked, &block);
+		if (link != NULL) {
+			ext4_journal_revoke_t *rec = hash_table_get_inst(link,
+			    ext4_journal_revoke_t, link);
+			if ((int32_t) (seq - rec->sequence) > 0)
+				rec->sequence = seq;
+			continue;
+		}
+
+		ext4_journal_revoke_t *rec = malloc(sizeof(ext4_journal_revoke_t));
+		if (rec == NULL)
+			return ENOMEM;
+
+		rec->block = block;
+		rec->sequence = seq;
+		hash_table_insert(&recovery->revoked, &rec->link);
+	}
+
+	return EOK;
+}
+
+/** Walk the log for one recovery pass.
+ *
+ * @param journal  Journal
+ * @param pass     Recovery pass
+ * @param recovery Recovery state
+ *
+ * @return Error code
+ *
+ */
+static errno_t ext4_journal_pass(ext4_journal_t *journal,
+    ext4_journal_pass_t pass, ext4_journal_recovery_t *recovery)
+{
+	size_t bsize = ext4_journal_block_size(journal);
+	uint8_t *hdr = journal->buf;
+	uint32_t seq = ext4_journal_get32(journal->jsb + JSB_SEQUENCE);
+	uint32_t pos = ext4_journal_get32(journal->jsb + JSB_START);
+	uint32_t visited = 0;
+	errno_t rc;
+
+	if (pos < journal->first || pos >= journal->maxlen)
+		return EIO;
+
+	while (true) {
+		if (pass != ext4_jpass_scan && seq == recovery->end)
+			break;
+
+		/* The log cannot be longer than the journal */
+		if (visited++ > journal->maxlen)
+			return EIO;
+
+		rc = ext4_journal_read(journal, pos, hdr);
+		if (rc != EOK)
+			return rc;
+
+		if (ext4_journal_get32(hdr) != EXT4_JOURNAL_MAGIC ||
+		    ext4_journal_get32(hdr + 8) != seq)
+			break;
+
+		uint32_t blocktype = ext4_journal_get32(hdr + 4);
+		pos = ext4_journal_next(journal, pos);
+
+		if (blocktype == EXT4_JOURNAL_COMMIT_BLOCK) {
+			seq++;
+			continue;
+		}
+
+		if (blocktype == EXT4_JOURNAL_REVOKE_BLOCK) {
+			if (pass == ext4_jpass_revoke) {
+				rc = ext4_journal_add_revokes(journal, recovery,
+				    seq, hdr);
+				if (rc != EOK)
+					return rc;
+			}
+			continue;
+		}
+
+		if (blocktype != EXT4_JOURNAL_DESCRIPTOR_BLOCK)
+			break;
+
+		/* Walk the tags, each of them describes one logged block */
+		size_t off = JHDR_SIZE;
+		while (off + journal->tag_size <= bsize - journal->tail_size) {
+			uint64_t block;
+			uint32_t flags;
+
+			ext4_journal_parse_tag(journal, hdr + off, &block,
+			    &flags);
+			off += journal->tag_size;
+			if ((flags & EXT4_JOURNAL_FLAG_SAME_UUID) == 0)
+				off += 16;
+
+			if (pass == ext4_jpass_replay) {
+				rc = ext4_journal_replay_block(journal,
+				    recovery, seq, pos, block, flags);
+				if (rc != EOK)
+					return rc;
+			}
+
+			pos = ext4_journal_next(journal, pos);
+			visited++;
+
+			if (flags & EXT4_JOURNAL_FLAG_LAST_TAG)
+				break;
+		}
+	}
+
+	if (pass == ext4_jpass_scan)
+		recovery->end = seq;
+
+	return EOK;
+}
+
+/** Replay the journal.
+ *
+ * Committed transactions are written to their home locations and the
+ * journal is marked empty. Checksums of the log are not verified,
+ * an incomplete transaction is recognized by its missing commit block.
+ *
+ * @param journal Journal
+ *
+ * @return Error code
+ *
+ */
+errno_t ext4_journal_recover(ext4_journal_t *journal)
+{
+	ext4_journal_recovery_t recovery;
+	errno_t rc;
+
+	if ((journal->features_incompatible &
+	    ~EXT4_JOURNAL_FEATURE_INCOMPAT_SUPP) != 0)
+		return ENOTSUP;
+
+	if (!hash_table_create(&recovery.revoked, 0, 0,
+	    &ext4_journal_revoke_ops))
+		return ENOMEM;
+
+	recovery.end = 0;
+
+	rc = ext4_journal_pass(journal, ext4_jpass_scan, &recovery);
+	if (rc == EOK)
+		rc = ext4_journal_pass(journal, ext4_jpass_revoke, &recovery);
+	if (rc == EOK)
+		rc = ext4_journal_pass(journal, ext4_jpass_replay, &recovery);
+
+	hash_table_destroy(&recovery.revoked);
+	if (rc != EOK)
+		return rc;
+
+	/* Replayed blocks must be on the disk before the log is dropped */
+	rc = ext4_journal_flush(journal);
+	if (rc != EOK)
+		return rc;
+
+	journal->sequence = recovery.end + 1;
+	rc = ext4_journal_write_jsb(journal, 0, journal->sequence);
+	if (rc != EOK)
+		return rc;
+
+	return ext4_journal_flush(journal);
+}
+
+/** Capture a dirty block in the running transaction.
+ *
+ * Called by libblock when a dirty block is put. The block is pinned in the
+ * cache by an extra reference until the transaction is checkpointed.
+ *
+ * @param block Dirty block
+ * @param arg   Journal
+ *
+ */
+static void ext4_journal_dirty_hook(block_t *block, void *arg)
+{
+	ext4_journal_t *journal = arg;
+
+	fibril_mutex_lock(&journal->lock);
+
+	if (!journal->active ||
+	    hash_table_find(&journal->trans, &block->lba) != NULL) {
+		fibril_mutex_unlock(&journal->lock);
+		return;
+	}
+
+	/* If we cannot pin the block, it will be written back unjournaled */
+	ext4_journal_entry_t *entry = malloc(sizeof(ext4_journal_entry_t));
+	if (entry == NULL) {
+		fibril_mutex_unlock(&journal->lock);
+		return;
+	}
+
+	errno_t rc = block_get(&entry->block, block->service_id, block->lba,
+	    BLOCK_FLAGS_NOREAD);
+	if (rc != EOK) {
+		free(entry);
+		fibril_mutex_unlock(&journal->lock);
+		return;
+	}
+
+	hash_table_insert(&journal->trans, &entry->link);
+	journal->trans_blocks++;
+
+	fibril_mutex_unlock(&journal->lock);
+}
+
+/** Write out the staging buffer to the log.
+ *
+ * @param journal Journal
+ *
+ * @return Error code
+ *
+ */
+static errno_t ext4_journal_log_flush(ext4_journal_t *journal)
+{
+	if (journal->buf_fill == 0)
+		return EOK;
+
+	errno_t rc = block_write_lblocks(journal->fs->device,
+	    journal->map[journal->buf_pos], journal->buf_fill, journal->buf);
+
+	journal->buf_pos += journal->buf_fill;
+	journal->buf_fill = 0;
+	return rc;
+}
+
+/** Get buffer for the next block of the log.
+ *
+ * Consecutive log blocks are gathered in the staging buffer so that
+ * they can be written with a single request.
+ *
+ * @param journal Journal
+ * @param rdata   Output pointer for the block buffer
+ *
+ * @return Error code
+ *
+ */
+static errno_t ext4_journal_log_append(ext4_journal_t *journal,
+    uint8_t **rdata)
+{
+	size_t bsize = ext4_journal_block_size(journal);
+	uint32_t pos = journal->buf_pos + journal->buf_fill;
+
+	if (journal->buf_fill > 0 &&
+	    (journal->buf_fill == journal->buf_blocks ||
+	    journal->map[pos] != journal->map[pos - 1] + 1)) {
+		errno_t rc = ext4_journal_log_flush(journal);
+		if (rc != EOK)
+			return rc;
+	}
+
+	*rdata = journal->buf + journal->buf_fill * bsize;
+	journal->buf_fill++;
+	return EOK;
+}
+
+/** Compute number of tags that fit in a descriptor block. */
+static size_t ext4_journal_tags_per_desc(ext4_journal_t *journal)
+{
+	size_t bsize = ext4_journal_block_size(journal);
+
+	/* The first tag is followed by the journal UUID */
+	return (bsize - JHDR_SIZE - journal->tail_size - 16) /
+	    journal->tag_size;
+}
+
+/** Fill in a descriptor block tag.
+ *
+ * @param journal Journal
+ * @param tag     Tag to fill in
+ * @param block   Home location of the logged block
+ * @param flags   Tag flags
+ * @param csum    Checksum of the logged block
+ *
+ */
+static void ext4_journal_set_tag(ext4_journal_t *journal, uint8_t *tag,
+    uint64_t block, uint32_t flags, uint32_t csum)
+{
+	memset(tag, 0, journal->tag_size);
+	ext4_journal_set32(tag, block);
+
+	if (journal->features_incompatible &
+	    EXT4_JOURNAL_FEATURE_INCOMPAT_CSUM_V3) {
+		ext4_journal_set32(tag + 4, flags);
+		ext4_journal_set32(tag + 12, csum);
+	} else {
+		ext4_journal_set16(tag + 4, csum);
+		ext4_journal_set16(tag + 6, flags);
+	}
+
+	if (journal->features_incompatible &
+	    EXT4_JOURNAL_FEATURE_INCOMPAT_64BIT)
+		ext4_journal_set32(tag + 8, block >> 32);
+}
+
+/** Write one descriptor block followed by the blocks it describes.
+ *
+ * @param journal Journal
+ * @param seq     Transaction ID
+ * @param blocks  Blocks to log
+ * @param cnt     Number of blocks
+ *
+ * @return Error code
+ *
+ */
+static errno_t ext4_journal_log_desc(ext4_journal_t *journal, uint32_t seq,
+    block_t **blocks, size_t cnt)
+{
+	size_t bsize = ext4_journal_block_size(journal);
+	bool csum = ext4_journal_has_csum(journal);
+	uint8_t *desc = journal->desc;
+	uint8_t *data;
+	uint8_t seq_be[4];
+	uint8_t zero[4] = { 0 };
+	errno_t rc;
+
+	ext4_journal_set32(seq_be, seq);
+
+	/* Build the descriptor first, the data follows it in the log */
+	memset(desc, 0, bsize);
+	ext4_journal_set32(desc, EXT4_JOURNAL_MAGIC);
+	ext4_journal_set32(desc + 4, EXT4_JOURNAL_DESCRIPTOR_BLOCK);
+	ext4_journal_set32(desc + 8, seq);
+
+	size_t off = JHDR_SIZE;
+	for (size_t i = 0; i < cnt; i++) {
+		const uint8_t *bdata = blocks[i]->data;
+		uint32_t flags = 0;
+		uint32_t tcsum = 0;
+
+		/* Logged data must not look like a journal block */
+		bool escape = ext4_journal_get32(bdata) == EXT4_JOURNAL_MAGIC;
+		if (escape)
+			flags |= EXT4_JOURNAL_FLAG_ESCAPE;
+		if (i > 0)
+			flags |= EXT4_JOURNAL_FLAG_SAME_UUID;
+		if (i == cnt - 1)
+			flags |= EXT4_JOURNAL_FLAG_LAST_TAG;
+
+		if (csum) {
+			tcsum = ext4_journal_crc32c(journal->csum_seed, seq_be,
+			    sizeof(seq_be));
+			tcsum = ext4_journal_crc32c(tcsum, escape ? zero : bdata,
+			    sizeof(zero));
+			tcsum = ext4_journal_crc32c(tcsum, bdata + sizeof(zero),
+			    bsize - sizeof(zero));
+		}
+
+		ext4_journal_set_tag(journal, desc + off, blocks[i]->lba, flags,
+		    tcsum);
+		off += journal->tag_size;
+		if (i == 0) {
+			memcpy(desc + off, journal->jsb + JSB_UUID, 16);
+			off += 16;
+		}
+	}
+
+	if (csum) {
+		uint32_t dcsum = ext4_journal_crc32c(journal->csum_seed, desc,
+		    bsize);
+		ext4_journal_set32(desc + bsize - journal->tail_size, dcsum);
+	}
+
+	rc = ext4_journal_log_append(journal, &data);
+	if (rc != EOK)
+		return rc;
+
+	memcpy(data, desc, bsize);
+
+	for (size_t i = 0; i < cnt; i++) {
+		rc = ext4_journal_log_append(journal, &data);
+		if (rc != EOK)
+			return rc;
+
+		memcpy(data, blocks[i]->data, bsize);
+		if (ext4_journal_get32(data) == EXT4_JOURNAL_MAGIC)
+			memset(data, 0, sizeof(uint32_t));
+	}
+
+	return EOK;
+}
+
+/** Write transaction to the log and commit it.
+ *
+ * @param journal Journal
+ * @param seq     Transaction ID
+ * @param blocks  Blocks of the transaction
+ * @param cnt     Number of blocks
+ *
+ * @return Error code
+ *
+ */
+static errno_t ext4_journal_write_trans(ext4_journal_t *journal, uint32_t seq,
+    block_t **blocks, size_t cnt)
+{
+	size_t bsize = ext4_journal_block_size(journal);
+	size_t per_desc = ext4_journal_tags_per_desc(journal);
+	uint8_t *commit;
+	errno_t rc;
+
+	/*
+	 * The previous transaction has been checkpointed, the log always
+	 * starts at the beginning of the journal. The superblock is written
+	 * along with the log, the transaction becomes valid only after its
+	 * commit block has been written.
+	 */
+	rc = ext4_journal_write_jsb(journal, journal->first, seq);
+	if (rc != EOK)
+		return rc;
+
+	journal->buf_pos = journal->first;
+	journal->buf_fill = 0;
+
+	for (size_t i = 0; i < cnt; i += per_desc) {
+		rc = ext4_journal_log_desc(journal, seq, blocks + i,
+		    min(per_desc, cnt - i));
+		if (rc != EOK)
+			return rc;
+	}
+
+	rc = ext4_journal_log_flush(journal);
+	if (rc != EOK)
+		return rc;
+
+	/* The log must be on the disk before the commit block */
+	rc = ext4_journal_flush(journal);
+	if (rc != EOK)
+		return rc;
+
+	rc = ext4_journal_log_append(journal, &commit);
+	if (rc != EOK)
+		return rc;
+
+	struct timespec ts;
+	getrealtime(&ts);
+
+	memset(commit, 0, bsize);
+	ext4_journal_set32(commit, EXT4_JOURNAL_MAGIC);
+	ext4_journal_set32(commit + 4, EXT4_JOURNAL_COMMIT_BLOCK);
+	ext4_journal_set32(commit + 8, seq);
+	ext4_journal_set32(commit + JCOMMIT_SEC, (uint64_t) ts.tv_sec >> 32);
+	ext4_journal_set32(commit + JCOMMIT_SEC + 4, ts.tv_sec);
+	ext4_journal_set32(commit + JCOMMIT_NSEC, ts.tv_nsec);
+
+	if (ext4_journal_has_csum(journal)) {
+		uint32_t csum = ext4_journal_crc32c(journal->csum_seed, commit,
+		    bsize);
+		ext4_journal_set32(commit + JCOMMIT_CHKSUM, csum);
+	}
+
+	rc = ext4_journal_log_flush(journal);
+	if (rc != EOK)
+		return rc;
+
+	return ext4_journal_flush(journal);
+}
+
+/** Write blocks of a committed transaction to their home locations.
+ *
+ * Blocks are sorted by address, consecutive blocks are written together.
+ *
+ * @param journal Journal
+ * @param blocks  Blocks of the transaction
+ * @param cnt     Number of blocks
+ *
+ * @return Error code
+ *
+ */
+static errno_t ext4_journal_checkpoint(ext4_journal_t *journal,
+    block_t **blocks, size_t cnt)
+{
+	size_t bsize = ext4_journal_block_size(journal);
+	errno_t rc = EOK;
+	size_t i = 0;
+
+	while (i < cnt) {
+		size_t n = 1;
+
+		memcpy(journal->buf, blocks[i]->data, bsize);
+		while (i + n < cnt && n < journal->buf_blocks &&
+		    blocks[i + n]->lba == blocks[i]->lba + n) {
+			memcpy(journal->buf + n * bsize, blocks[i + n]->data,
+			    bsize);
+			n++;
+		}
+
+		/* This also marks the cached blocks clean */
+		errno_t rc2 = block_write_lblocks(journal->fs->device,
+		    blocks[i]->lba, n, journal->buf);
+		if (rc2 != EOK && rc == EOK)
+			rc = rc2;
+
+		i += n;
+	}
+
+	if (rc == EOK)
+		rc = ext4_journal_flush(journal);
+
+	return rc;
+}
+
+static int ext4_journal_block_cmp(const void *a, const void *b)
+{
+	const block_t *ba = *(block_t * const *) a;
+	const block_t *bb = *(block_t * const *) b;
+
+	if (ba->lba < bb->lba)
+		return -1;
+	if (ba->lba > bb->lba)
+		return 1;
+	return 0;
+}
+
+typedef struct {
+	block_t **blocks;
+	size_t cnt;
+} ext4_journal_collect_t;
+
+static bool ext4_journal_collect(ht_link_t *item, void *arg)
+{
+	ext4_journal_collect_t *collect = arg;
+	ext4_journal_entry_t *entry =
+	    hash_table_get_inst(item, ext4_journal_entry_t, link);
+
+	collect->blocks[collect->cnt++] = entry->block;
+	return true;
+}
+
+/** Commit the running transaction.
+ *
+ * Waits until all handles are closed, writes the transaction to the log,
+ * commits it and checkpoints it.
+ *
+ * @param journal Journal
+ *
+ * @return Error code
+ *
+ */
+errno_t ext4_journal_commit(ext4_journal_t *journal)
+{
+	ext4_journal_collect_t collect;
+	errno_t rc;
+
+	if (journal == NULL)
+		return EOK;
+
+	fibril_mutex_lock(&journal->lock);
+	while (journal->handles > 0 || journal->committing)
+		fibril_condvar_wait(&journal->cv, &journal->lock);
+
+	if (journal->trans_blocks == 0) {
+		fibril_mutex_unlock(&journal->lock);
+		return EOK;
+	}
+
+	collect.blocks = malloc(journal->trans_blocks * sizeof(block_t *));
+	if (collect.blocks == NULL) {
+		fibril_mutex_unlock(&journal->lock);
+		return ENOMEM;
+	}
+
+	journal->committing = true;
+
+	/* Take over the blocks, dirty blocks go to a new transaction */
+	collect.cnt = 0;
+	hash_table_apply(&journal->trans, ext4_journal_collect, &collect);
+	hash_table_clear(&journal->trans);
+	journal->trans_blocks = 0;
+	uint32_t seq = journal->sequence++;
+
+	fibril_mutex_unlock(&journal->lock);
+
+	qsort(collect.blocks, collect.cnt, sizeof(block_t *),
+	    ext4_journal_block_cmp);
+
+	/*
+	 * A transaction too large for the log is only written back. This
+	 * cannot happen unless the journal is tiny.
+	 */
+	size_t per_desc = ext4_journal_tags_per_desc(journal);
+	size_t needed = collect.cnt + (collect.cnt + per_desc - 1) / per_desc + 1;
+	if (needed <= journal->maxlen - journal->first)
+		rc = ext4_journal_write_trans(journal, seq, collect.blocks,
+		    collect.cnt);
+	else
+		rc = EOK;
+
+	if (rc == EOK)
+		rc = ext4_journal_checkpoint(journal, collect.blocks,
+		    collect.cnt);
+
+	/*
+	 * Release the blocks. Blocks which failed to be written are still
+	 * dirty and will be captured again.
+	 */
+	for (size_t i = 0; i < collect.cnt; i++)
+		(void) block_put(collect.blocks[i]);
+
+	free(collect.blocks);
+
+	fibril_mutex_lock(&journal->lock);
+	journal->committing = false;
+	fibril_condvar_broadcast(&journal->cv);
+	fibril_mutex_unlock(&journal->lock);
+
+	return rc;
+}
+
+/** Periodic commit fibril.
+ *
+ * @param arg Journal
+ *
+ * @return EOK
+ *
+ */
+static errno_t ext4_journal_timer_fibril(void *arg)
+{
+	ext4_journal_t *journal = arg;
+
+	fibril_mutex_lock(&journal->lock);
+
+	while (!journal->quit) {
+		errno_t rc = fibril_condvar_wait_timeout(&journal->timer_cv,
+		    &journal->lock, EXT4_JOURNAL_COMMIT_INTERVAL);
+		if (rc != ETIMEOUT || journal->quit)
+			continue;
+
+		if (journal->trans_blocks > 0) {
+			fibril_mutex_unlock(&journal->lock);
+			(void) ext4_journal_commit(journal);
+			fibril_mutex_lock(&journal->lock);
+		}
+	}
+
+	journal->timer_running = false;
+	fibril_condvar_broadcast(&journal->timer_cv);
+	fibril_mutex_unlock(&journal->lock);
+
+	return EOK;
+}
+
+/** Start capturing file system updates in transactions.
+ *
+ * @param journal Journal
+ *
+ * @return Error code
+ *
+ */
+errno_t ext4_journal_activate(ext4_journal_t *journal)
+{
+	if (!journal->writable)
+		return ENOTSUP;
+
+	fid_t fid = fibril_create(ext4_journal_timer_fibril, journal);
+	if (fid == 0)
+		return ENOMEM;
+
+	errno_t rc = block_cache_set_dirty_hook(journal->fs->device,
+	    ext4_journal_dirty_hook, journal);
+	if (rc != EOK) {
+		fibril_destroy(fid);
+		return rc;
+	}
+
+	fibril_mutex_lock(&journal->lock);
+	journal->active = true;
+	journal->timer_running = true;
+	fibril_mutex_unlock(&journal->lock);
+
+	fibril_add_ready(fid);
+	return EOK;
+}
+
+/** Close the journal.
+ *
+ * Commits the running transaction and marks the journal empty.
+ *
+ * @param journal Journal
+ *
+ * @return Error code. On error the journal remains open.
+ *
+ */
+errno_t ext4_journal_close(ext4_journal_t *journal)
+{
+	errno_t rc;
+
+	if (journal->active) {
+		rc = ext4_journal_commit(journal);
+		if (rc != EOK)
+			return rc;
+
+		fibril_mutex_lock(&journal->lock);
+		journal->quit = true;
+		fibril_condvar_broadcast(&journal->timer_cv);
+		while (journal->timer_running)
+			fibril_condvar_wait(&journal->timer_cv, &journal->lock);
+		journal->active = false;
+		fibril_mutex_unlock(&journal->lock);
+
+		(void) block_cache_set_dirty_hook(journal->fs->device, NULL,
+		    NULL);
+
+		/* Commit blocks captured while the timer was stopping */
+		rc = ext4_journal_commit(journal);
+		if (rc != EOK)
+			return rc;
+
+		rc = ext4_journal_write_jsb(journal, 0, journal->sequence);
+		if (rc != EOK)
+			return rc;
+
+		rc = ext4_journal_flush(journal);
+		if (rc != EOK)
+			return rc;
+	}
+
+	hash_table_destroy(&journal->trans);
+	free(journal->map);
+	free(journal->jsb);
+	free(journal->desc);
+	free(journal->buf);
+	free(journal);
+	return EOK;
+}
+
+/** Open a handle.
+ *
+ * File system updates done while a handle is open go to the same
+ * transaction. Handles may nest.
+ *
+ * @param journal Journal or @c NULL
+ *
+ */
+void ext4_journal_begin(ext4_journal_t *journal)
+{
+	if (journal == NULL)
+		return;
+
+	fibril_mutex_lock(&journal->lock);
+	while (journal->committing)
+		fibril_condvar_wait(&journal->cv, &journal->lock);
+	journal->handles++;
+	fibril_mutex_unlock(&journal->lock);
+}
+
+/** Close a handle.
+ *
+ * Commits the running transaction if it became too large.
+ *
+ * @param journal Journal or @c NULL
+ *
+ */
+void ext4_journal_end(ext4_journal_t *journal)
+{
+	bool commit;
+
+	if (journal == NULL)
+		return;
+
+	fibril_mutex_lock(&journal->lock);
+	assert(journal->handles > 0);
+	journal->handles--;
+	commit = journal->handles == 0 &&
+	    journal->trans_blocks >= journal->trans_max;
+	if (journal->handles == 0)
+		fibril_condvar_broadcast(&journal->cv);
+	fibril_mutex_unlock(&journal->lock);
+
+	if (commit)
+		(void) ext4_journal_commit(journal);
+}
+
+/**
+ * @}
+ */
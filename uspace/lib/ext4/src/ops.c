@@ -50,11 +50,18 @@
 #include "ext4/directory_index.h"
 #include "ext4/extent.h"
 #include "ext4/inode.h"
+#include "ext4/journal.h"
 #include "ext4/ops.h"
 #include "ext4/filesystem.h"
 #include "ext4/fstypes.h"
 #include "ext4/superblock.h"
 
+/** Maximum number of bytes transferred by a single read or write */
+#define EXT4_IO_MAX  (256 * 1024)
+
+/** Zeros returned for holes in sparse files */
+static uint8_t ext4_zero_buf[16384];
+
 /* Forward declarations of auxiliary functions */
 
 static errno_t ext4_read_directory(ipc_call_t *, aoff64_t, size_t,
@@ -63,6 +70,10 @@ static errno_t ext4_read_file(ipc_call_t *, aoff64_t, size_t, ext4_instance_t *,
     ext4_inode_ref_t *, size_t *);
 static bool ext4_is_dots(const uint8_t *, size_t);
 static errno_t ext4_instance_get(service_id_t, ext4_instance_t **);
+static errno_t ext4_create_node_core(fs_node_t **, service_id_t, int);
+static errno_t ext4_destroy_node_core(fs_node_t *);
+static errno_t ext4_link_core(fs_node_t *, fs_node_t *, const char *);
+static errno_t ext4_unlink_core(fs_node_t *, fs_node_t *, const char *);
 
 /* Forward declarations of ext4 libfs operations. */
 
@@ -396,25 +407,51 @@ errno_t ext4_node_open(fs_node_t *fn)
  */
 errno_t ext4_node_put(fs_node_t *fn)
 {
+	ext4_node_t *enode = EXT4_NODE(fn);
+	ext4_journal_t *journal = enode->instance->filesystem->journal;
+	errno_t rc = EOK;
+
+	/* Writing back the i-node is part of the transaction */
+	ext4_journal_begin(journal);
 	fibril_mutex_lock(&open_nodes_lock);
 
-	ext4_node_t *enode = EXT4_NODE(fn);
 	assert(enode->references > 0);
 	enode->references--;
-	if (enode->references == 0) {
-		errno_t rc = ext4_node_put_core(enode);
-		if (rc != EOK) {
-			fibril_mutex_unlock(&open_nodes_lock);
-			return rc;
-		}
-	}
+	if (enode->references == 0)
+		rc = ext4_node_put_core(enode);
 
 	fibril_mutex_unlock(&open_nodes_lock);
+	ext4_journal_end(journal);
 
-	return EOK;
+	return rc;
+}
+
+/** Get journal of the file system a node belongs to. */
+static ext4_journal_t *ext4_node_journal(fs_node_t *fn)
+{
+	return EXT4_NODE(fn)->instance->filesystem->journal;
+}
+
+/** Get journal of the file system on a device.
+ *
+ * @param service_id Device identifier
+ *
+ * @return Journal or @c NULL if there is none
+ *
+ */
+static ext4_journal_t *ext4_service_journal(service_id_t service_id)
+{
+	ext4_instance_t *inst;
+
+	if (ext4_instance_get(service_id, &inst) != EOK)
+		return NULL;
+
+	return inst->filesystem->journal;
 }
 
 /** Create new node in filesystem.
+ *
+ * A wrapper for create_node_core operation executed in a journal handle.
  *
  * @param rfn        Output pointer to newly created node if successful
  * @param service_id Device identifier, where the filesystem is
@@ -424,6 +461,91 @@ errno_t ext4_node_put(fs_node_t *fn)
  *
  */
 errno_t ext4_create_node(fs_node_t **rfn, service_id_t service_id, int flags)
+{
+	ext4_journal_t *journal = ext4_service_journal(service_id);
+
+	ext4_journal_begin(journal);
+	errno_t rc = ext4_create_node_core(rfn, service_id, flags);
+	ext4_journal_end(journal);
+
+	return rc;
+}
+
+/** Destroy existing node.
+ *
+ * A wrapper for destroy_node_core operation executed in a journal handle.
+ *
+ * @param fn Node to destroy
+ *
+ * @return Error code
+ *
+ */
+errno_t ext4_destroy_node(fs_node_t *fn)
+{
+	ext4_journal_t *journal = ext4_node_journal(fn);
+
+	ext4_journal_begin(journal);
+	errno_t rc = ext4_destroy_node_core(fn);
+	ext4_journal_end(journal);
+
+	return rc;
+}
+
+/** Link the specfied node to directory.
+ *
+ * A wrapper for link_core operation executed in a journal handle.
+ *
+ * @param pfn  Parent node to link in
+ * @param cfn  Node to be linked
+ * @param name Name which will be assigned to directory entry
+ *
+ * @return Error code
+ *
+ */
+errno_t ext4_link(fs_node_t *pfn, fs_node_t *cfn, const char *name)
+{
+	ext4_journal_t *journal = ext4_node_journal(pfn);
+
+	ext4_journal_begin(journal);
+	errno_t rc = ext4_link_core(pfn, cfn, name);
+	ext4_journal_end(journal);
+
+	return rc;
+}
+
+/** Unlink node from specified directory.
+ *
+ * A wrapper for unlink_core operation executed in a journal handle.
+ *
+ * @param pfn  Parent node to delete node from
+ * @param cfn  Child node to be unlinked from directory
+ * @param name Name of entry that will be removed
+ *
+ * @return Error code
+ *
+ */
+errno_t ext4_unlink(fs_node_t *pfn, fs_node_t *cfn, const char *name)
+{
+	ext4_journal_t *journal = ext4_node_journal(pfn);
+
+	ext4_journal_begin(journal);
+	errno_t rc = ext4_unlink_core(pfn, cfn, name);
+	ext4_journal_end(journal);
+
+	return rc;
+}
+
+/** Create new node in filesystem.
+ *
+ * @param rfn        Output pointer to newly created node if successful
+ * @param service_id Device identifier, where the filesystem is
+ * @param flags      Flags for specification of new node parameters
+ *
+ * @return Error code
+ *
+ */
+static errno_t ext4_create_node_core(fs_node_t **rfn, service_id_t service_id,
+    int flags)
 {
 	/* Allocate enode */
 	ext4_node_t *enode;
@@ -484,7 +606,7 @@ errno_t ext4_create_node(fs_node_t **rfn, service_id_t service_id, int flags)
  * @return Error code
  *
  */
-errno_t ext4_destroy_node(fs_node_t *fn)
+static errno_t ext4_destroy_node_core(fs_node_t *fn)
 {
 	/* If directory, check for children */
 	bool has_children;
@@ -535,7 +657,7 @@ errno_t ext4_destroy_node(fs_node_t *fn)
  * @return Error code
  *
  */
-errno_t ext4_link(fs_node_t *pfn, fs_node_t *cfn, const char *name)
+static errno_t ext4_link_core(fs_node_t *pfn, fs_node_t *cfn, const char *name)
 {
 	/* Check maximum name length */
 	if (str_size(name) > EXT4_DIRECTORY_FILENAME_LEN)
@@ -608,7 +730,7 @@ errno_t ext4_link(fs_node_t *pfn, fs_node_t *cfn, const char *name)
  * @return Error code
  *
  */
-errno_t ext4_unlink(fs_node_t *pfn, fs_node_t *cfn, const char *name)
+static errno_t ext4_unlink_core(fs_node_t *pfn, fs_node_t *cfn, const char *name)
 {
 	bool has_children;
 	errno_t rc = ext4_has_children(&has_children, cfn);
@@ -1180,6 +1302,135 @@ errno_t ext4_read_directory(ipc_call_t *call, aoff64_t pos, size_t size,
 	}
 }
 
+/** Convert type of a directory entry.
+ *
+ * @param inode_type Directory entry file type
+ *
+ * @return VFS directory entry type
+ *
+ */
+static vfs_dirent_type_t ext4_dirent_type(uint8_t inode_type)
+{
+	switch (inode_type) {
+	case EXT4_DIRECTORY_FILETYPE_UNKNOWN:
+		return VFS_DIRENT_UNKNOWN;
+	case EXT4_DIRECTORY_FILETYPE_DIR:
+		return VFS_DIRENT_DIRECTORY;
+	default:
+		return VFS_DIRENT_FILE;
+	}
+}
+
+/** Read a batch of directory entries.
+ *
+ * Entries are packed into @a buf until it is full. The position of the
+ * entry following each packed entry is its byte offset in the directory,
+ * so reading can be resumed without scanning the directory again.
+ *
+ * @param service_id Device identifier
+ * @param index      I-node number of the directory
+ * @param pos        Byte offset in the directory to start at
+ * @param flags      VFS_READDIR_* flags
+ * @param buf        Buffer for packed entries
+ * @param size       Size of the buffer
+ * @param used       Output value - number of bytes filled in
+ *
+ * @return Error code
+ *
+ */
+static errno_t ext4_readdir(service_id_t service_id, fs_index_t index,
+    aoff64_t pos, unsigned flags, void *buf, size_t size, size_t *used)
+{
+	char name[EXT4_DIRECTORY_FILENAME_LEN + 1];
+	ext4_instance_t *inst;
+	ext4_inode_ref_t *inode_ref;
+	ext4_directory_iterator_t it;
+
+	errno_t rc = ext4_instance_get(service_id, &inst);
+	if (rc != EOK)
+		return rc;
+
+	ext4_filesystem_t *fs = inst->filesystem;
+
+	rc = ext4_filesystem_get_inode_ref(fs, index, &inode_ref);
+	if (rc != EOK)
+		return rc;
+
+	if (!ext4_inode_is_type(fs->superblock, inode_ref->inode,
+	    EXT4_INODE_MODE_DIRECTORY)) {
+		ext4_filesystem_put_inode_ref(inode_ref);
+		return ENOTDIR;
+	}
+
+	rc = ext4_directory_iterator_init(&it, inode_ref, pos);
+	if (rc != EOK) {
+		ext4_filesystem_put_inode_ref(inode_ref);
+		return rc;
+	}
+
+	*used = 0;
+	while (it.current != NULL) {
+		uint16_t name_size = ext4_directory_entry_ll_get_name_length(
+		    fs->superblock, it.current);
+
+		/* Skip unused entries as well as . and .. */
+		if (it.current->inode != 0 &&
+		    !ext4_is_dots(it.current->name, name_size)) {
+			vfs_dirent_type_t type;
+			aoff64_t fsize = 0;
+
+			memcpy(name, it.current->name, name_size);
+			name[name_size] = '\0';
+
+			type = ext4_dirent_type(
+			    ext4_directory_entry_ll_get_inode_type(
+			    fs->superblock, it.current));
+
+			if (flags & VFS_READDIR_STAT) {
+				ext4_inode_ref_t *child;
+
+				rc = ext4_filesystem_get_inode_ref(fs,
+				    ext4_directory_entry_ll_get_inode(it.current),
+				    &child);
+				if (rc != EOK)
+					break;
+
+				type = ext4_inode_is_type(fs->superblock,
+				    child->inode, EXT4_INODE_MODE_DIRECTORY) ?
+				    VFS_DIRENT_DIRECTORY : VFS_DIRENT_FILE;
+				fsize = ext4_inode_get_size(fs->superblock,
+				    child->inode);
+
+				rc = ext4_filesystem_put_inode_ref(child);
+				if (rc != EOK)
+					break;
+			}
+
+			aoff64_t next = it.current_offset +
+			    ext4_directory_entry_ll_get_entry_length(it.current);
+
+			if (!libfs_dirent_add(buf, size, used, name, type, fsize,
+			    next)) {
+				/* Not even a single entry fits */
+				if (*used == 0)
+					rc = ELIMIT;
+				break;
+			}
+		}
+
+		rc = ext4_directory_iterator_next(&it);
+		if (rc != EOK)
+			break;
+	}
+
+	errno_t rc2 = ext4_directory_iterator_fini(&it);
+	errno_t rc3 = ext4_filesystem_put_inode_ref(inode_ref);
+
+	if (rc != EOK)
+		return rc;
+	return rc2 != EOK ? rc2 : rc3;
+}
+
 /** Read data from file.
  *
  * @param call      IPC call
@@ -1205,46 +1456,66 @@ errno_t ext4_read_file(ipc_call_t *call, aoff64_t pos, size_t size,
 		return EOK;
 	}
 
-	/* For now, we only read data from one block at a time */
+	/* Read as many consecutive blocks as fit into one transfer */
 	uint32_t block_size = ext4_superblock_get_block_size(sb);
 	aoff64_t file_block = pos / block_size;
 	uint32_t offset_in_block = pos % block_size;
-	uint32_t bytes = min(block_size - offset_in_block, size);
-
-	/* Handle end of file */
-	if (pos + bytes > file_size)
-		bytes = file_size - pos;
+	aoff64_t end = min(pos + size, file_size);
+	uint32_t max_blocks = min((end - 1) / block_size - file_block + 1,
+	    EXT4_IO_MAX / block_size);
 
-	/* Get the real block number */
+	/* Get the real block numbers */
 	uint32_t fs_block;
-	errno_t rc = ext4_filesystem_get_inode_data_block_index(inode_ref,
-	    file_block, &fs_block);
+	uint32_t count;
+	errno_t rc = ext4_filesystem_get_inode_data_block_run(inode_ref,
+	    file_block, max_blocks, &fs_block, &count);
 	if (rc != EOK) {
 		async_answer_0(call, rc);
 		return rc;
 	}
 
+	size_t bytes = min((aoff64_t) count * block_size - offset_in_block,
+	    end - pos);
+
 	/*
 	 * Check for sparse file.
-	 * If ext4_filesystem_get_inode_data_block_index returned
-	 * fs_block == 0, it means that the given block is not allocated for the
-	 * file and we need to return a buffer of zeros
+	 * If the run is not allocated for the file, we need to return
+	 * zeros. Serve them from a static buffer, which may shorten the read.
 	 */
-	uint8_t *buffer;
 	if (fs_block == 0) {
-		buffer = malloc(bytes);
+		bytes = min(bytes, sizeof(ext4_zero_buf));
+		rc = async_data_read_finalize(call, ext4_zero_buf, bytes);
+		if (rc != EOK)
+			return rc;
+
+		*rbytes = bytes;
+		return EOK;
+	}
+
+	if (count > 1) {
+		/* Multiple blocks - read them from the device at once */
+		uint8_t *buffer = malloc((size_t) count * block_size);
 		if (buffer == NULL) {
 			async_answer_0(call, ENOMEM);
 			return ENOMEM;
 		}
 
-		memset(buffer, 0, bytes);
-
-		rc = async_data_read_finalize(call, buffer, bytes);
-		*rbytes = bytes;
+		rc = block_read_lblocks(inst->service_id, fs_block, count,
+		    buffer);
+		if (rc != EOK) {
+			free(buffer);
+			async_answer_0(call, rc);
+			return rc;
+		}
 
+		rc = async_data_read_finalize(call, buffer + offset_in_block,
+		    bytes);
 		free(buffer);
-		return rc;
+		if (rc != EOK)
+			return rc;
+
+		*rbytes = bytes;
+		return EOK;
 	}
 
 	/* Usual case - we need to read a block from device */
@@ -1270,6 +1541,155 @@ errno_t ext4_read_file(ipc_call_t *call, aoff64_t pos, size_t size,
 	return EOK;
 }
 
+/** Write several whole blocks to file at once.
+ *
+ * Handles the part of a write request which covers a run of already
+ * allocated consecutive blocks or which appends new blocks to a file
+ * using extents. Other requests are left to the single block path.
+ *
+ * @param call      IPC call of the write request
+ * @param inode_ref I-node to write to
+ * @param pos       Block aligned position in file to start writing at
+ * @param len       Number of bytes offered by the client
+ * @param wbytes    Output value - number of written bytes, zero if the
+ *                  request was not handled
+ *
+ * @return Error code
+ *
+ */
+static errno_t ext4_write_blocks(ipc_call_t *call, ext4_inode_ref_t *inode_ref,
+    aoff64_t pos, size_t len, size_t *wbytes)
+{
+	ext4_filesystem_t *fs = inode_ref->fs;
+	uint32_t block_size = ext4_superblock_get_block_size(fs->superblock);
+	uint32_t iblock = pos / block_size;
+	uint32_t max_blocks = min(len, EXT4_IO_MAX) / block_size;
+	uint32_t fblock;
+	uint32_t count;
+	uint8_t *buffer;
+	errno_t rc;
+
+	*wbytes = 0;
+	if (max_blocks < 2)
+		return EOK;
+
+	rc = ext4_filesystem_get_inode_data_block_run(inode_ref, iblock,
+	    max_blocks, &fblock, &count);
+	if (rc != EOK) {
+		async_answer_0(call, rc);
+		return rc;
+	}
+
+	if (fblock != 0) {
+		/* Overwrite of allocated blocks */
+		if (count < 2)
+			return EOK;
+
+		buffer = malloc((size_t) count * block_size);
+		if (buffer == NULL) {
+			async_answer_0(call, ENOMEM);
+			return ENOMEM;
+		}
+
+		rc = async_data_write_finalize(call, buffer,
+		    (size_t) count * block_size);
+		if (rc == EOK)
+			rc = block_write_lblocks(fs->device, fblock, count, buffer);
+
+		free(buffer);
+		if (rc != EOK)
+			return rc;
+
+		*wbytes = (size_t) count * block_size;
+		return EOK;
+	}
+
+	/* Only appending to a file using extents allocates more blocks */
+	if (!ext4_superblock_has_feature_incompatible(fs->superblock,
+	    EXT4_FEATURE_INCOMPAT_EXTENTS) ||
+	    !ext4_inode_has_flag(inode_ref->inode, EXT4_INODE_FLAG_EXTENTS))
+		return EOK;
+
+	uint64_t inode_size = ext4_inode_get_size(fs->superblock,
+	    inode_ref->inode);
+	if (iblock != (inode_size + block_size - 1) / block_size)
+		return EOK;
+
+	count = max_blocks;
+	buffer = malloc((size_t) count * block_size);
+	uint32_t *fblocks = malloc(count * sizeof(uint32_t));
+	if (buffer == NULL || fblocks == NULL) {
+		free(buffer);
+		free(fblocks);
+		async_answer_0(call, ENOMEM);
+		return ENOMEM;
+	}
+
+	rc = async_data_write_finalize(call, buffer,
+	    (size_t) count * block_size);
+	if (rc != EOK)
+		goto out;
+
+	/*
+	 * Allocate the blocks one by one, the allocator tends to place them
+	 * next to each other. If the filesystem fills up, write only the part
+	 * which got allocated.
+	 */
+	uint32_t n;
+	for (n = 0; n < count; n++) {
+		uint32_t new_iblock;
+		rc = ext4_extent_append_block(inode_ref, &new_iblock,
+		    &fblocks[n], true);
+		if (rc != EOK)
+			break;
+
+		assert(new_iblock == iblock + n);
+	}
+
+	if (n == 0)
+		goto out;
+
+	inode_ref->dirty = true;
+
+	/*
+	 * Appending the blocks has extended the i-node size. Keep the old
+	 * size until the data is on the device, the caller updates it
+	 * according to the number of written bytes.
+	 */
+	uint64_t alloc_size = ext4_inode_get_size(fs->superblock,
+	    inode_ref->inode);
+	ext4_inode_set_size(inode_ref->inode, inode_size);
+
+	/* Write each run of consecutive physical blocks at once */
+	uint32_t start = 0;
+	while (start < n) {
+		uint32_t run = 1;
+		while (start + run < n &&
+		    fblocks[start + run] == fblocks[start] + run)
+			run++;
+
+		rc = block_write_lblocks(fs->device, fblocks[start], run,
+		    buffer + (size_t) start * block_size);
+		if (rc != EOK) {
+			/* Release the blocks again, they hold no valid data */
+			ext4_inode_set_size(inode_ref->inode, alloc_size);
+			(void) ext4_filesystem_truncate_inode(inode_ref,
+			    inode_size);
+			goto out;
+		}
+
+		start += run;
+	}
+
+	*wbytes = (size_t) n * block_size;
+	rc = EOK;
+
+out:
+	free(buffer);
+	free(fblocks);
+	return rc;
+}
+
 /** Write bytes to file
  *
  * @param service_id Device identifier
@@ -1281,8 +1701,8 @@ errno_t ext4_read_file(ipc_call_t *call, aoff64_t pos, size_t size,
  * @return Error code
  *
  */
-static errno_t ext4_write(service_id_t service_id, fs_index_t index, aoff64_t pos,
-    size_t *wbytes, aoff64_t *nsize)
+static errno_t ext4_write_core(service_id_t service_id, fs_index_t index,
+    aoff64_t pos, size_t *wbytes, aoff64_t *nsize)
 {
 	fs_node_t *fn;
 	errno_t rc2;
@@ -1303,8 +1723,20 @@ static errno_t ext4_write(service_id_t service_id, fs_index_t index, aoff64_t po
 
 	uint32_t block_size = ext4_superblock_get_block_size(fs->superblock);
 
+	/* Write whole blocks at once if the request spans several of them */
+	ext4_inode_ref_t *inode_ref = enode->inode_ref;
+	size_t bytes;
+	if ((pos % block_size) == 0) {
+		rc = ext4_write_blocks(&call, inode_ref, pos, len, &bytes);
+		if (rc != EOK)
+			goto exit;
+
+		if (bytes > 0)
+			goto update_size;
+	}
+
 	/* Prevent writing to more than one block */
-	uint32_t bytes = min(len, block_size - (pos % block_size));
+	bytes = min(len, block_size - (pos % block_size));
 
 	int flags = BLOCK_FLAGS_NONE;
 	if (bytes == block_size)
@@ -1313,8 +1745,6 @@ static errno_t ext4_write(service_id_t service_id, fs_index_t index, aoff64_t po
 	uint32_t iblock =  pos / block_size;
 	uint32_t fblock;
 
-	/* Load inode */
-	ext4_inode_ref_t *inode_ref = enode->inode_ref;
 	rc = ext4_filesystem_get_inode_data_block_index(inode_ref, iblock,
 	    &fblock);
 	if (rc != EOK) {
@@ -1390,10 +1820,10 @@ static errno_t ext4_write(service_id_t service_id, fs_index_t index, aoff64_t po
 	if (rc != EOK)
 		goto exit;
 
+update_size:
 	/* Do some counting */
-	uint32_t old_inode_size = ext4_inode_get_size(fs->superblock,
-	    inode_ref->inode);
-	if (pos + bytes > old_inode_size) {
+	if (pos + bytes > ext4_inode_get_size(fs->superblock,
+	    inode_ref->inode)) {
 		ext4_inode_set_size(inode_ref->inode, pos + bytes);
 		inode_ref->dirty = true;
 	}
@@ -1406,6 +1836,31 @@ exit:
 	return rc == EOK ? rc2 : rc;
 }
 
+/** Write bytes to file
+ *
+ * A wrapper for write_core operation executed in a journal handle.
+ *
+ * @param service_id Device identifier
+ * @param index      I-node number of file
+ * @param pos        Position in file to start reading from
+ * @param wbytes     Output value - real number of written bytes
+ * @param nsize      Output value - new size of i-node
+ *
+ * @return Error code
+ *
+ */
+static errno_t ext4_write(service_id_t service_id, fs_index_t index, aoff64_t pos,
+    size_t *wbytes, aoff64_t *nsize)
+{
+	ext4_journal_t *journal = ext4_service_journal(service_id);
+
+	ext4_journal_begin(journal);
+	errno_t rc = ext4_write_core(service_id, index, pos, wbytes, nsize);
+	ext4_journal_end(journal);
+
+	return rc;
+}
+
 /** Truncate file.
  *
  * Only the direction to shorter file is supported.
@@ -1427,9 +1882,12 @@ static errno_t ext4_truncate(service_id_t service_id, fs_index_t index,
 
 	ext4_node_t *enode = EXT4_NODE(fn);
 	ext4_inode_ref_t *inode_ref = enode->inode_ref;
+	ext4_journal_t *journal = ext4_node_journal(fn);
 
+	ext4_journal_begin(journal);
 	rc = ext4_filesystem_truncate_inode(inode_ref, new_size);
 	errno_t const rc2 = ext4_node_put(fn);
+	ext4_journal_end(journal);
 
 	return rc == EOK ? rc2 : rc;
 }
@@ -1467,6 +1925,8 @@ static errno_t ext4_destroy(service_id_t service_id, fs_index_t index)
 }
 
 /** Enforce inode synchronization (write) to device.
+ *
+ * With a journal, the running transaction is committed.
  *
  * @param service_id Device identifier
  * @param index      I-node number.
@@ -1480,9 +1940,14 @@ static errno_t ext4_sync(service_id_t service_id, fs_index_t index)
 		return rc;
 
 	ext4_node_t *enode = EXT4_NODE(fn);
+	ext4_journal_t *journal = ext4_node_journal(fn);
 	enode->inode_ref->dirty = true;
 
-	return ext4_node_put(fn);
+	rc = ext4_node_put(fn);
+	if (rc != EOK)
+		return rc;
+
+	return ext4_journal_commit(journal);
 }
 
 /** VFS operations
@@ -1497,7 +1962,8 @@ vfs_out_ops_t ext4_ops = {
 	.truncate = ext4_truncate,
 	.close = ext4_close,
 	.destroy = ext4_destroy,
-	.sync = ext4_sync
+	.sync = ext4_sync,
+	.readdir = ext4_readdir
 };
 
 /**
@@ -36,6 +36,7 @@
 
 #include "libfs.h"
 #include <macros.h>
+#include <align.h>
 #include <errno.h>
 #include <async.h>
 #include <as.h>
@@ -166,6 +167,52 @@ static void vfs_out_read(ipc_call_t *req)
 		async_answer_0(req, rc);
 }
 
+static void vfs_out_readdir(ipc_call_t *req)
+{
+	service_id_t service_id = (service_id_t) ipc_get_arg1(req);
+	fs_index_t index = (fs_index_t) ipc_get_arg2(req);
+	aoff64_t pos = (aoff64_t) MERGE_LOUP32(ipc_get_arg3(req),
+	    ipc_get_arg4(req));
+	unsigned flags = ipc_get_arg5(req);
+	ipc_call_t call;
+	size_t size;
+	size_t used = 0;
+	errno_t rc;
+
+	if (!async_data_read_receive(&call, &size)) {
+		async_answer_0(&call, EINVAL);
+		async_answer_0(req, EINVAL);
+		return;
+	}
+
+	if (vfs_out_ops->readdir == NULL) {
+		async_answer_0(&call, ENOTSUP);
+		async_answer_0(req, ENOTSUP);
+		return;
+	}
+
+	size = min(size, DATA_XFER_LIMIT);
+	void *buf = malloc(size);
+	if (buf == NULL) {
+		async_answer_0(&call, ENOMEM);
+		async_answer_0(req, ENOMEM);
+		return;
+	}
+
+	rc = vfs_out_ops->readdir(service_id, index, pos, flags, buf, size,
+	    &used);
+	if (rc != EOK) {
+		free(buf);
+		async_answer_0(&call, rc);
+		async_answer_0(req, rc);
+		return;
+	}
+
+	rc = async_data_read_finalize(&call, buf, used);
+	free(buf);
+	async_answer_1(req, rc, used);
+}
+
 static void vfs_out_write(ipc_call_t *req)
 {
 	service_id_t service_id = (service_id_t) ipc_get_arg1(req);
@@ -313,6 +360,9 @@ static void vfs_connection(ipc_call_t *icall, void *arg)
 		case VFS_OUT_READ:
 			vfs_out_read(&call);
 			break;
+		case VFS_OUT_READDIR:
+			vfs_out_readdir(&call);
+			break;
 		case VFS_OUT_WRITE:
 			vfs_out_write(&call);
 			break;
@@ -433,6 +483,39 @@ void fs_node_initialize(fs_node_t *fn)
 	memset(fn, 0, sizeof(fs_node_t));
 }
 
+/** Append a directory entry to a VFS_OUT_READDIR reply.
+ *
+ * @param buf   Reply buffer
+ * @param size  Size of the reply buffer
+ * @param used  Number of bytes used in the buffer, updated
+ * @param name  Entry name
+ * @param type  Entry type
+ * @param fsize Size of the node (if known)
+ * @param next  Position of the following directory entry
+ *
+ * @return True if the entry was added, false if it does not fit
+ */
+bool libfs_dirent_add(void *buf, size_t size, size_t *used, const char *name,
+    vfs_dirent_type_t type, aoff64_t fsize, aoff64_t next)
+{
+	size_t nsize = str_size(name) + 1;
+	size_t reclen = ALIGN_UP(sizeof(vfs_dirent_t) + nsize, 8);
+
+	if (reclen > size - *used || reclen > UINT16_MAX)
+		return false;
+
+	vfs_dirent_t *de = (vfs_dirent_t *) ((uint8_t *) buf + *used);
+	memset(de, 0, reclen);
+	de->next = next;
+	de->size = fsize;
+	de->reclen = reclen;
+	de->type = type;
+	memcpy(de->name, name, nsize);
+
+	*used += reclen;
+	return true;
+}
+
 static char plb_get_char(unsigned pos)
 {
 	return reg.plb_ro[pos % PLB_SIZE];
@@ -743,6 +826,8 @@ void libfs_stat(libfs_ops_t *ops, fs_handle_t fs_handle, ipc_call_t *req)
 	stat.is_directory = ops->is_directory(fn);
 	stat.size = ops->size_get(fn);
 	stat.service = ops->service_get(fn);
+	if (ops->mtime_get != NULL)
+		stat.mtime = ops->mtime_get(fn);
 
 	ops->node_put(fn);
 
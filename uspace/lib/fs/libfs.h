@@ -52,6 +52,9 @@ typedef struct {
 	errno_t (*close)(service_id_t, fs_index_t);
 	errno_t (*destroy)(service_id_t, fs_index_t);
 	errno_t (*sync)(service_id_t, fs_index_t);
+	/** Read packed directory entries (optional) */
+	errno_t (*readdir)(service_id_t, fs_index_t, aoff64_t, unsigned,
+	    void *, size_t, size_t *);
 } vfs_out_ops_t;
 
 typedef struct {
@@ -80,6 +83,8 @@ typedef struct {
 	 */
 	fs_index_t (*index_get)(fs_node_t *);
 	aoff64_t (*size_get)(fs_node_t *);
+	/** Optional, modification stamp in microseconds */
+	uint64_t (*mtime_get)(fs_node_t *);
 	unsigned int (*lnkcnt_get)(fs_node_t *);
 	bool (*is_directory)(fs_node_t *);
 	bool (*is_file)(fs_node_t *);
@@ -98,6 +103,8 @@ extern errno_t fs_register(async_sess_t *, vfs_info_t *, vfs_out_ops_t *,
     libfs_ops_t *);
 
 extern void fs_node_initialize(fs_node_t *);
+extern bool libfs_dirent_add(void *, size_t, size_t *, const char *,
+    vfs_dirent_type_t, aoff64_t, aoff64_t);
 
 extern errno_t fs_instance_create(service_id_t, void *);
 extern errno_t fs_instance_get(service_id_t, void **);
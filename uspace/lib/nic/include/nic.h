@@ -68,6 +68,8 @@ typedef struct {
 	link_t link;
 	void *data;
 	size_t size;
+	/** Receive pool slot holding the data, -1 if allocated on heap */
+	int pool_slot;
 } nic_frame_t;
 
 typedef list_t nic_frame_list_t;
@@ -205,6 +207,17 @@ typedef errno_t (*poll_mode_change_handler)(nic_t *,
  */
 typedef void (*poll_request_handler)(nic_t *);
 
+/**
+ * Handler called when the set of active offload computations is changed.
+ *
+ * @param nic_data	NICF main structure
+ * @param active	New set of active offloads (NIC_OFFLOAD_* flags)
+ *
+ * @return EOK		If the offloads were set up successfully
+ * @return ENOTSUP	If this combination of offloads is not supported
+ */
+typedef errno_t (*offload_change_handler)(nic_t *, uint32_t);
+
 /* nic_t allocation and deallocation */
 extern nic_t *nic_create_and_bind(ddf_dev_t *);
 extern void nic_unbind_and_destroy(ddf_dev_t *);
@@ -228,6 +241,8 @@ extern void nic_set_wol_virtue_change_handlers(nic_t *,
     wol_virtue_add_handler, wol_virtue_remove_handler);
 extern void nic_set_poll_handlers(nic_t *,
     poll_mode_change_handler, poll_request_handler);
+extern void nic_set_offload_handler(nic_t *, uint32_t, uint32_t,
+    offload_change_handler);
 
 /* General driver functions */
 extern ddf_dev_t *nic_get_ddf_dev(nic_t *);
@@ -237,6 +252,7 @@ extern nic_t *nic_get_from_ddf_dev(ddf_dev_t *);
 extern nic_t *nic_get_from_ddf_fun(ddf_fun_t *);
 extern void *nic_get_specific(nic_t *);
 extern nic_device_state_t nic_query_state(nic_t *);
+extern uint32_t nic_query_offload(nic_t *);
 extern void nic_set_tx_busy(nic_t *, int);
 extern errno_t nic_report_address(nic_t *, const nic_address_t *);
 extern errno_t nic_report_poll_mode(nic_t *, nic_poll_mode_t, struct timespec *);
@@ -45,6 +45,8 @@
 #include <fibril_synch.h>
 #include <nic/nic.h>
 #include <async.h>
+#include <nic_iface.h>
+#include <stdbool.h>
 
 #include "nic.h"
 #include "nic_rx_control.h"
@@ -194,6 +196,28 @@ struct nic {
 	 * The implementation is optional.
 	 */
 	poll_request_handler on_poll_request;
+	/** Offload computations supported by the hardware (NIC_OFFLOAD_*) */
+	uint32_t offload_supported;
+	/** Currently active offload computations. Protected by main_lock */
+	uint32_t offload_active;
+	/**
+	 * Event handler called when the set of active offloads is changed.
+	 * The implementation is optional.
+	 * Called with main_lock locked for writing.
+	 */
+	offload_change_handler on_offload_change;
+	/**
+	 * Receive frame pool shared with the client, NULL until the client
+	 * asks for it. Frames allocated from the pool are passed to the client
+	 * by offset instead of being copied.
+	 */
+	void *rx_pool;
+	/** Pool slots currently holding a frame */
+	bool rx_pool_busy[NIC_RX_POOL_SLOTS];
+	/** Slot to try first on the next allocation */
+	size_t rx_pool_next;
+	/** Lock for the receive pool */
+	fibril_mutex_t rx_pool_lock;
 	/** Data specific for particular driver */
 	void *specific;
 };
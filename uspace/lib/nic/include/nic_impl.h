@@ -81,6 +81,9 @@ extern errno_t nic_poll_get_mode_impl(ddf_fun_t *,
 extern errno_t nic_poll_set_mode_impl(ddf_fun_t *,
     nic_poll_mode_t, const struct timespec *);
 extern errno_t nic_poll_now_impl(ddf_fun_t *);
+extern errno_t nic_offload_probe_impl(ddf_fun_t *, uint32_t *, uint32_t *);
+extern errno_t nic_offload_set_impl(ddf_fun_t *, uint32_t, uint32_t);
+extern errno_t nic_rx_pool_get_impl(ddf_fun_t *, void **, size_t *);
 
 extern void nic_default_handler_impl(ddf_fun_t *dev_fun, ipc_call_t *call);
 extern errno_t nic_open_impl(ddf_fun_t *fun);
@@ -143,6 +143,12 @@ void nic_driver_implement(driver_ops_t *driver_ops, ddf_dev_ops_t *dev_ops,
 			iface->poll_set_mode = nic_poll_set_mode_impl;
 		if (!iface->poll_now)
 			iface->poll_now = nic_poll_now_impl;
+		if (!iface->offload_probe)
+			iface->offload_probe = nic_offload_probe_impl;
+		if (!iface->offload_set)
+			iface->offload_set = nic_offload_set_impl;
+		if (!iface->rx_pool_get)
+			iface->rx_pool_get = nic_rx_pool_get_impl;
 	}
 }
 
@@ -232,6 +238,26 @@ void nic_set_poll_handlers(nic_t *nic_data,
 	nic_data->on_poll_request = on_poll_req;
 }
 
+/**
+ * Setup offload computations. The function must be called only in the
+ * add_device handler.
+ *
+ * @param nic_data
+ * @param supported	Offloads supported by the hardware (NIC_OFFLOAD_*)
+ * @param active	Offloads active after initialization
+ * @param on_change	Handler called when active offloads change. Can be NULL
+ * 			if the offloads cannot be switched off.
+ */
+void nic_set_offload_handler(nic_t *nic_data, uint32_t supported,
+    uint32_t active, offload_change_handler on_change)
+{
+	assert((active & ~supported) == 0);
+
+	nic_data->offload_supported = supported;
+	nic_data->offload_active = active;
+	nic_data->on_offload_change = on_change;
+}
+
 /**
  * Connect to the parent's driver and get HW resources list in parsed format.
  * Note: this function should be called only from add_device handler, therefore
@@ -255,7 +281,55 @@ errno_t nic_get_resources(nic_t *nic_data, hw_res_list_parsed_t *resources)
 	return hw_res_get_list_parsed(parent_sess, resources, 0);
 }
 
+/** Allocate a slot in the receive pool
+ *
+ * @param nic_data	The NIC driver data
+ * @param size		Frame size in bytes
+ *
+ * @return Slot number or -1 if there is no pool or no free slot
+ */
+static int nic_rx_pool_alloc(nic_t *nic_data, size_t size)
+{
+	int slot = -1;
+
+	if (size > NIC_RX_POOL_SLOT_SIZE)
+		return -1;
+
+	fibril_mutex_lock(&nic_data->rx_pool_lock);
+	if (nic_data->rx_pool != NULL) {
+		for (size_t i = 0; i < NIC_RX_POOL_SLOTS; i++) {
+			size_t idx = (nic_data->rx_pool_next + i) %
+			    NIC_RX_POOL_SLOTS;
+			if (!nic_data->rx_pool_busy[idx]) {
+				nic_data->rx_pool_busy[idx] = true;
+				nic_data->rx_pool_next = (idx + 1) %
+				    NIC_RX_POOL_SLOTS;
+				slot = idx;
+				break;
+			}
+		}
+	}
+	fibril_mutex_unlock(&nic_data->rx_pool_lock);
+
+	return slot;
+}
+
+/** Return a slot to the receive pool
+ *
+ * @param nic_data	The NIC driver data
+ * @param slot		Slot number
+ */
+static void nic_rx_pool_free(nic_t *nic_data, int slot)
+{
+	fibril_mutex_lock(&nic_data->rx_pool_lock);
+	nic_data->rx_pool_busy[slot] = false;
+	fibril_mutex_unlock(&nic_data->rx_pool_lock);
+}
+
 /** Allocate frame
+ *
+ * If the client has mapped the receive pool, the frame data is placed
+ * in the pool so that it can be handed over without copying.
  *
  *  @param nic_data 	The NIC driver data
  *  @param size	        Frame size in bytes
@@ -280,10 +354,16 @@ nic_frame_t *nic_alloc_frame(nic_t *nic_data, size_t size)
 		link_initialize(&frame->link);
 	}
 
-	frame->data = malloc(size);
-	if (frame->data == NULL) {
-		free(frame);
-		return NULL;
+	frame->pool_slot = nic_rx_pool_alloc(nic_data, size);
+	if (frame->pool_slot >= 0) {
+		frame->data = (uint8_t *) nic_data->rx_pool +
+		    (size_t) frame->pool_slot * NIC_RX_POOL_SLOT_SIZE;
+	} else {
+		frame->data = malloc(size);
+		if (frame->data == NULL) {
+			free(frame);
+			return NULL;
+		}
 	}
 
 	frame->size = size;
@@ -300,7 +380,12 @@ void nic_release_frame(nic_t *nic_data, nic_frame_t *frame)
 	if (!frame)
 		return;
 
-	if (frame->data != NULL) {
+	if (frame->pool_slot >= 0) {
+		nic_rx_pool_free(nic_data, frame->pool_slot);
+		frame->pool_slot = -1;
+		frame->data = NULL;
+		frame->size = 0;
+	} else if (frame->data != NULL) {
 		free(frame->data);
 		frame->data = NULL;
 		frame->size = 0;
@@ -543,8 +628,14 @@ void nic_received_frame(nic_t *nic_data, nic_frame_t *frame)
 			break;
 		}
 		fibril_rwlock_write_unlock(&nic_data->stats_lock);
-		nic_ev_received(nic_data->client_session, frame->data,
-		    frame->size);
+		if (frame->pool_slot >= 0) {
+			nic_ev_received_pool(nic_data->client_session,
+			    (size_t) frame->pool_slot * NIC_RX_POOL_SLOT_SIZE,
+			    frame->size);
+		} else {
+			nic_ev_received(nic_data->client_session, frame->data,
+			    frame->size);
+		}
 	} else {
 		switch (frame_type) {
 		case NIC_FRAME_UNICAST:
@@ -612,6 +703,12 @@ static nic_t *nic_create(ddf_dev_t *dev)
 	nic_data->poll_mode = NIC_POLL_IMMEDIATE;
 	nic_data->default_poll_mode = NIC_POLL_IMMEDIATE;
 	nic_data->send_frame = NULL;
+	nic_data->offload_supported = 0;
+	nic_data->offload_active = 0;
+	nic_data->on_offload_change = NULL;
+	nic_data->rx_pool = NULL;
+	memset(nic_data->rx_pool_busy, 0, sizeof(nic_data->rx_pool_busy));
+	nic_data->rx_pool_next = 0;
 	nic_data->on_activating = NULL;
 	nic_data->on_going_down = NULL;
 	nic_data->on_stopping = NULL;
@@ -621,6 +718,7 @@ static nic_t *nic_create(ddf_dev_t *dev)
 	fibril_rwlock_initialize(&nic_data->stats_lock);
 	fibril_rwlock_initialize(&nic_data->rxc_lock);
 	fibril_rwlock_initialize(&nic_data->wv_lock);
+	fibril_mutex_initialize(&nic_data->rx_pool_lock);
 
 	memset(&nic_data->mac, 0, sizeof(nic_address_t));
 	memset(&nic_data->default_mac, 0, sizeof(nic_address_t));
@@ -658,6 +756,8 @@ nic_t *nic_create_and_bind(ddf_dev_t *device)
  */
 static void nic_destroy(nic_t *nic_data)
 {
+	if (nic_data->rx_pool != NULL)
+		as_area_destroy(nic_data->rx_pool);
 	free(nic_data->specific);
 }
 
@@ -873,6 +973,19 @@ nic_device_state_t nic_query_state(nic_t *nic_data)
 	return nic_data->state;
 }
 
+/**
+ * Query active offload computations. Frames received or transmitted
+ * while an offload is being switched may still be processed according
+ * to the previous setting.
+ *
+ * @param	nic_data
+ * @return	Currently active offloads (NIC_OFFLOAD_* flags)
+ */
+uint32_t nic_query_offload(nic_t *nic_data)
+{
+	return nic_data->offload_active;
+}
+
 /**
  * @param nic_data
  * @return DDF device associated with this NIC.
@@ -93,5 +93,22 @@ errno_t nic_ev_received(async_sess_t *sess, void *data, size_t size)
 	return retval;
 }
 
+/** Frame received into the shared receive pool.
+ *
+ * Only the location of the frame is passed, the client reads the frame
+ * directly from its mapping of the pool. The frame must not be reused
+ * before this function returns.
+ */
+errno_t nic_ev_received_pool(async_sess_t *sess, size_t offs, size_t size)
+{
+	errno_t rc;
+
+	async_exch_t *exch = async_exchange_begin(sess);
+	rc = async_req_2_0(exch, NIC_EV_RECEIVED_POOL, offs, size);
+	async_exchange_end(exch);
+
+	return rc;
+}
+
 /** @}
  */
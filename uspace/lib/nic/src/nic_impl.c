@@ -35,6 +35,7 @@
  * @brief Default DDF NIC interface methods implementations
  */
 
+#include <as.h>
 #include <errno.h>
 #include <str_error.h>
 #include <ipc/services.h>
@@ -804,6 +805,99 @@ errno_t nic_poll_now_impl(ddf_fun_t *fun)
 	}
 }
 
+/**
+ * Default implementation of the offload_probe method.
+ *
+ * @param[in]	fun
+ * @param[out]	supported	Offloads supported by the hardware
+ * @param[out]	active		Currently active offloads
+ *
+ * @return EOK
+ */
+errno_t nic_offload_probe_impl(ddf_fun_t *fun, uint32_t *supported,
+    uint32_t *active)
+{
+	nic_t *nic_data = nic_get_from_ddf_fun(fun);
+	fibril_rwlock_read_lock(&nic_data->main_lock);
+	*supported = nic_data->offload_supported;
+	*active = nic_data->offload_active;
+	fibril_rwlock_read_unlock(&nic_data->main_lock);
+	return EOK;
+}
+
+/**
+ * Default implementation of the offload_set method.
+ *
+ * @param[in]	fun
+ * @param[in]	mask	Offloads to change
+ * @param[in]	active	New state of the offloads selected by mask
+ *
+ * @return EOK		If the operation was successfully completed
+ * @return ENOTSUP	Some of the offloads are not supported by the NIC
+ */
+errno_t nic_offload_set_impl(ddf_fun_t *fun, uint32_t mask, uint32_t active)
+{
+	nic_t *nic_data = nic_get_from_ddf_fun(fun);
+	errno_t rc = EOK;
+
+	fibril_rwlock_write_lock(&nic_data->main_lock);
+
+	uint32_t new_active = (nic_data->offload_active & ~mask) |
+	    (active & mask);
+	if ((new_active & ~nic_data->offload_supported) != 0) {
+		fibril_rwlock_write_unlock(&nic_data->main_lock);
+		return ENOTSUP;
+	}
+
+	if (new_active != nic_data->offload_active) {
+		if (nic_data->on_offload_change == NULL)
+			rc = ENOTSUP;
+		else
+			rc = nic_data->on_offload_change(nic_data, new_active);
+
+		if (rc == EOK)
+			nic_data->offload_active = new_active;
+	}
+
+	fibril_rwlock_write_unlock(&nic_data->main_lock);
+	return rc;
+}
+
+/**
+ * Default implementation of the rx_pool_get method. The pool is created
+ * on first use; frames allocated afterwards are placed in the pool.
+ *
+ * @param[in]	fun
+ * @param[out]	pool	Address of the receive pool
+ * @param[out]	size	Size of the receive pool
+ *
+ * @return EOK		If the operation was successfully completed
+ * @return ENOMEM	If the pool could not be created
+ */
+errno_t nic_rx_pool_get_impl(ddf_fun_t *fun, void **pool, size_t *size)
+{
+	nic_t *nic_data = nic_get_from_ddf_fun(fun);
+
+	fibril_mutex_lock(&nic_data->rx_pool_lock);
+	if (nic_data->rx_pool == NULL) {
+		void *area = as_area_create(AS_AREA_ANY, NIC_RX_POOL_SIZE,
+		    AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE,
+		    AS_AREA_UNPAGED);
+		if (area == AS_MAP_FAILED) {
+			fibril_mutex_unlock(&nic_data->rx_pool_lock);
+			return ENOMEM;
+		}
+
+		nic_data->rx_pool = area;
+	}
+
+	*pool = nic_data->rx_pool;
+	*size = NIC_RX_POOL_SIZE;
+	fibril_mutex_unlock(&nic_data->rx_pool_lock);
+
+	return EOK;
+}
+
 /**
  * Default handler for unknown methods (outside of the NIC interface).
  * Logs a warning message and returns ENOTSUP to the caller.
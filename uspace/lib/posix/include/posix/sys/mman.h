@@ -51,11 +51,16 @@
 #define PROT_WRITE  2
 #define PROT_EXEC   4
 
+#define MS_ASYNC       (1 << 0)
+#define MS_SYNC        (1 << 1)
+#define MS_INVALIDATE  (1 << 2)
+
 __C_DECLS_BEGIN;
 
 extern void *mmap(void *start, size_t length, int prot, int flags, int fd,
     off_t offset);
 extern int munmap(void *start, size_t length);
+extern int msync(void *start, size_t length, int flags);
 
 __C_DECLS_END;
 
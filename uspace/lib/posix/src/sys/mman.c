@@ -35,9 +35,26 @@
 #include "../internal/common.h"
 #include <sys/mman.h>
 #include <sys/types.h>
+#include <adt/list.h>
 #include <as.h>
+#include <fibril_synch.h>
+#include <stdlib.h>
 #include <unistd.h>
 
+/** File mapping.
+ *
+ * The VFS pager identifies the mapped file by its handle, so each mapping
+ * holds a private clone of the handle which is put when the mapping goes.
+ */
+typedef struct {
+	link_t link;
+	void *start;
+	int fd;
+} mmap_file_t;
+
+static FIBRIL_MUTEX_INITIALIZE(mmap_files_lock);
+static LIST_INITIALIZE(mmap_files);
+
 static int _prot_to_as(int prot)
 {
 	int ret = 0;
@@ -54,21 +71,72 @@ static int _prot_to_as(int prot)
 	return ret;
 }
 
+/** Find file mapping starting at the given address.
+ *
+ * Must be called with mmap_files_lock held.
+ */
+static mmap_file_t *mmap_file_find(void *start)
+{
+	list_foreach(mmap_files, link, mmap_file_t, mf) {
+		if (mf->start == start)
+			return mf;
+	}
+
+	return NULL;
+}
+
+static void *mmap_file(void *start, size_t length, int prot, bool shared,
+    int fd, off_t offset)
+{
+	mmap_file_t *mf = malloc(sizeof(mmap_file_t));
+	if (mf == NULL) {
+		errno = ENOMEM;
+		return MAP_FAILED;
+	}
+
+	if (failed(vfs_clone(fd, -1, false, &mf->fd))) {
+		free(mf);
+		return MAP_FAILED;
+	}
+
+	if (failed(vfs_map(mf->fd, offset, length, _prot_to_as(prot), shared,
+	    &start))) {
+		vfs_put(mf->fd);
+		free(mf);
+		return MAP_FAILED;
+	}
+
+	mf->start = start;
+
+	fibril_mutex_lock(&mmap_files_lock);
+	list_append(&mf->link, &mmap_files);
+	fibril_mutex_unlock(&mmap_files_lock);
+
+	return start;
+}
+
 void *mmap(void *start, size_t length, int prot, int flags, int fd,
     off_t offset)
 {
 	if (!start)
 		start = AS_AREA_ANY;
 
-#if 0
-	if (!((flags & MAP_SHARED) ^ (flags & MAP_PRIVATE)))
+	if (!((flags & MAP_SHARED) ^ (flags & MAP_PRIVATE)) || length == 0) {
+		errno = EINVAL;
 		return MAP_FAILED;
-#endif
+	}
+
+	if (flags & MAP_ANONYMOUS) {
+		return as_area_create(start, length, _prot_to_as(prot),
+		    AS_AREA_UNPAGED);
+	}
 
-	if (!(flags & MAP_ANONYMOUS))
+	if (offset < 0 || offset % PAGE_SIZE != 0) {
+		errno = EINVAL;
 		return MAP_FAILED;
+	}
 
-	return as_area_create(start, length, _prot_to_as(prot), AS_AREA_UNPAGED);
+	return mmap_file(start, length, prot, flags & MAP_SHARED, fd, offset);
 }
 
 int munmap(void *start, size_t length)
@@ -78,6 +146,45 @@ int munmap(void *start, size_t length)
 		errno = rc;
 		return -1;
 	}
+
+	fibril_mutex_lock(&mmap_files_lock);
+	mmap_file_t *mf = mmap_file_find(start);
+	if (mf != NULL)
+		list_remove(&mf->link);
+	fibril_mutex_unlock(&mmap_files_lock);
+
+	if (mf != NULL) {
+		/*
+		 * Putting the last handle of the file makes VFS write back
+		 * pages modified through shared mappings.
+		 */
+		vfs_put(mf->fd);
+		free(mf);
+	}
+
+	return 0;
+}
+
+int msync(void *start, size_t length, int flags)
+{
+	int fd = -1;
+
+	fibril_mutex_lock(&mmap_files_lock);
+	mmap_file_t *mf = mmap_file_find(start);
+	if (mf != NULL)
+		fd = mf->fd;
+	fibril_mutex_unlock(&mmap_files_lock);
+
+	/* Anonymous mappings have nothing to synchronize with. */
+	if (fd < 0)
+		return 0;
+
+	if ((flags & (MS_SYNC | MS_ASYNC)) == 0)
+		return 0;
+
+	if (failed(vfs_sync(fd)))
+		return -1;
+
 	return 0;
 }
 
@@ -63,6 +63,9 @@
 
 #define VIRTIO_F_VERSION_1	1
 
+/** Driver can use descriptors with the VIRTQ_DESC_F_INDIRECT flag set */
+#define VIRTIO_F_INDIRECT_DESC	(1U << 28)
+
 /** Common configuration structure layout according to VIRTIO version 1.0 */
 typedef struct virtio_pci_common_cfg {
 	ioport32_t device_feature_select;
@@ -181,12 +184,17 @@ typedef struct {
 
 	/** Virtqueues */
 	virtq_t *queues;
+
+	/** Negotiated device-specific feature flags */
+	uint32_t features;
 } virtio_dev_t;
 
 extern errno_t virtio_setup_dma_bufs(unsigned int, size_t, bool, void *[],
     uintptr_t []);
 extern void virtio_teardown_dma_bufs(void *[]);
 
+extern void virtio_desc_set(virtq_desc_t *, uint64_t, uint32_t, uint16_t,
+    uint16_t);
 extern void virtio_virtq_desc_set(virtio_dev_t *vdev, uint16_t, uint16_t,
     uint64_t, uint32_t, uint16_t, uint16_t);
 extern uint16_t virtio_virtq_desc_get_next(virtio_dev_t *vdev, uint16_t,
@@ -197,6 +205,8 @@ extern void virtio_create_desc_free_list(virtio_dev_t *, uint16_t, uint16_t,
 extern uint16_t virtio_alloc_desc(virtio_dev_t *, uint16_t, uint16_t *);
 extern void virtio_free_desc(virtio_dev_t *, uint16_t, uint16_t *, uint16_t);
 
+extern void virtio_virtq_enqueue_available(virtio_dev_t *, uint16_t, uint16_t);
+extern void virtio_virtq_notify(virtio_dev_t *, uint16_t);
 extern void virtio_virtq_produce_available(virtio_dev_t *, uint16_t, uint16_t);
 extern bool virtio_virtq_consume_used(virtio_dev_t *, uint16_t, uint16_t *,
     uint32_t *);
@@ -205,6 +215,8 @@ extern errno_t virtio_virtq_setup(virtio_dev_t *, uint16_t, uint16_t);
 extern void virtio_virtq_teardown(virtio_dev_t *, uint16_t);
 
 extern errno_t virtio_device_setup_start(virtio_dev_t *, uint32_t);
+extern errno_t virtio_device_setup_start_opt(virtio_dev_t *, uint32_t,
+    uint32_t);
 extern void virtio_device_setup_fail(virtio_dev_t *);
 extern void virtio_device_setup_finalize(virtio_dev_t *);
 
@@ -93,16 +93,27 @@ void virtio_teardown_dma_bufs(void *buf[])
 	}
 }
 
-void virtio_virtq_desc_set(virtio_dev_t *vdev, uint16_t num, uint16_t descno,
-    uint64_t addr, uint32_t len, uint16_t flags, uint16_t next)
+/** Fill in a VIRTIO descriptor
+ *
+ * The descriptor can be either a member of a virtqueue's descriptor table or
+ * an entry of an indirect descriptor table.
+ */
+void virtio_desc_set(virtq_desc_t *d, uint64_t addr, uint32_t len,
+    uint16_t flags, uint16_t next)
 {
-	virtq_desc_t *d = &vdev->queues[num].desc[descno];
 	pio_write_le64(&d->addr, addr);
 	pio_write_le32(&d->len, len);
 	pio_write_le16(&d->flags, flags);
 	pio_write_le16(&d->next, next);
 }
 
+void virtio_virtq_desc_set(virtio_dev_t *vdev, uint16_t num, uint16_t descno,
+    uint64_t addr, uint32_t len, uint16_t flags, uint16_t next)
+{
+	virtio_desc_set(&vdev->queues[num].desc[descno], addr, len, flags,
+	    next);
+}
+
 uint16_t virtio_virtq_desc_get_next(virtio_dev_t *vdev, uint16_t num,
     uint16_t descno)
 {
@@ -169,7 +180,19 @@ void virtio_free_desc(virtio_dev_t *vdev, uint16_t num, uint16_t *head,
 	fibril_mutex_unlock(&q->lock);
 }
 
-void virtio_virtq_produce_available(virtio_dev_t *vdev, uint16_t num,
+/** Make a descriptor chain available to the device without notifying it
+ *
+ * The chain is appended to the available ring and the ring index is
+ * advanced, so a device which is already processing the virtqueue may pick
+ * it up right away. A device which is idle only learns about it from a
+ * subsequent call to virtio_virtq_notify(), which lets the caller publish a
+ * whole batch of chains and notify the device once.
+ *
+ * @param vdev[in]    VIRTIO device.
+ * @param num[in]     Index of the virtqueue.
+ * @param descno[in]  Head of the descriptor chain.
+ */
+void virtio_virtq_enqueue_available(virtio_dev_t *vdev, uint16_t num,
     uint16_t descno)
 {
 	virtq_t *q = &vdev->queues[num];
@@ -179,11 +202,35 @@ void virtio_virtq_produce_available(virtio_dev_t *vdev, uint16_t num,
 	pio_write_le16(&q->avail->ring[idx % q->queue_size], descno);
 	write_barrier();
 	pio_write_le16(&q->avail->idx, idx + 1);
-	write_barrier();
-	pio_write_le16(q->notify, num);
 	fibril_mutex_unlock(&q->lock);
 }
 
+/** Notify the device about new available descriptor chains
+ *
+ * The notification is skipped if the device has indicated that it does not
+ * need to be notified because it is still processing the virtqueue.
+ *
+ * @param vdev[in]  VIRTIO device.
+ * @param num[in]   Index of the virtqueue.
+ */
+void virtio_virtq_notify(virtio_dev_t *vdev, uint16_t num)
+{
+	virtq_t *q = &vdev->queues[num];
+
+	fibril_mutex_lock(&q->lock);
+	memory_barrier();
+	if (!(pio_read_le16(&q->used->flags) & VIRTQ_USED_F_NO_NOTIFY))
+		pio_write_le16(q->notify, num);
+	fibril_mutex_unlock(&q->lock);
+}
+
+void virtio_virtq_produce_available(virtio_dev_t *vdev, uint16_t num,
+    uint16_t descno)
+{
+	virtio_virtq_enqueue_available(vdev, num, descno);
+	virtio_virtq_notify(vdev, num);
+}
+
 bool virtio_virtq_consume_used(virtio_dev_t *vdev, uint16_t num,
     uint16_t *descno, uint32_t *len)
 {
@@ -300,6 +347,19 @@ void virtio_virtq_teardown(virtio_dev_t *vdev, uint16_t num)
  * specification, steps 1 - 6.
  */
 errno_t virtio_device_setup_start(virtio_dev_t *vdev, uint32_t features)
+{
+	return virtio_device_setup_start_opt(vdev, features, 0);
+}
+
+/**
+ * Perform device initialization as described in section 3.1.1 of the
+ * specification, steps 1 - 6, accepting optional features.
+ *
+ * Features from @a optional are accepted only if offered by the device.
+ * The accepted feature set is stored in @c vdev->features.
+ */
+errno_t virtio_device_setup_start_opt(virtio_dev_t *vdev, uint32_t features,
+    uint32_t optional)
 {
 	virtio_pci_common_cfg_t *cfg = vdev->common_cfg;
 
@@ -328,7 +388,9 @@ errno_t virtio_device_setup_start(virtio_dev_t *vdev, uint32_t features)
 
 	if (features != (features & device_features))
 		return ENOTSUP;
+	features |= optional;
 	features &= device_features;
+	vdev->features = features;
 
 	if (reserved_features != (reserved_features & device_reserved_features))
 		return ENOTSUP;
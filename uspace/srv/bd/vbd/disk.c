@@ -48,6 +48,7 @@
 #include <vbd.h>
 
 #include "disk.h"
+#include "sched.h"
 #include "types/vbd.h"
 
 static fibril_mutex_t vbds_disks_lock;
@@ -319,6 +320,7 @@ static errno_t vbds_part_add(vbds_disk_t *disk, label_part_t *lpart,
 	}
 
 	fibril_rwlock_initialize(&part->lock);
+	vbds_sched_part_init(part);
 
 	part->lpart = lpart;
 	part->disk = disk;
@@ -331,6 +333,7 @@ static errno_t vbds_part_add(vbds_disk_t *disk, label_part_t *lpart,
 	bd_srvs_init(&part->bds);
 	part->bds.ops = &vbds_bd_ops;
 	part->bds.sarg = part;
+	part->bds.queue_depth = BD_QUEUE_DEPTH_MAX;
 
 	if (lpinfo.pkind != lpk_extended) {
 		rc = vbds_part_svc_register(part);
@@ -538,6 +541,14 @@ errno_t vbds_disk_add(service_id_t sid)
 	disk->nblocks = nblocks;
 	disk->present = true;
 
+	rc = vbds_sched_init(disk);
+	if (rc != EOK) {
+		log_msg(LOG_DEFAULT, LVL_ERROR, "Failed starting I/O scheduler "
+		    "for disk %s.", disk->svc_name);
+		rc = EIO;
+		goto error;
+	}
+
 	list_initialize(&disk->parts);
 	list_append(&disk->ldisks, &vbds_disks);
 
@@ -575,6 +586,7 @@ errno_t vbds_disk_remove(service_id_t sid)
 	}
 
 	list_remove(&disk->ldisks);
+	vbds_sched_fini(disk);
 	label_close(disk->label);
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "block_fini(%zu)", sid);
 	block_fini(sid);
@@ -638,6 +650,39 @@ errno_t vbds_disk_info(service_id_t sid, vbd_disk_info_t *info)
 	return EOK;
 }
 
+/** Get disk I/O statistics. */
+errno_t vbds_disk_stats(service_id_t sid, vbd_disk_stats_t *stats)
+{
+	vbds_disk_t *disk;
+	errno_t rc;
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "vbds_disk_stats(%zu)", sid);
+
+	rc = vbds_disk_by_svcid(sid, &disk);
+	if (rc != EOK)
+		return rc;
+
+	vbds_sched_get_stats(disk, stats);
+	return EOK;
+}
+
+/** Enable or disable disk I/O scheduler. */
+errno_t vbds_disk_sched_set(service_id_t sid, bool enable)
+{
+	vbds_disk_t *disk;
+	errno_t rc;
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "vbds_disk_sched_set(%zu, %d)", sid,
+	    (int) enable);
+
+	rc = vbds_disk_by_svcid(sid, &disk);
+	if (rc != EOK)
+		return rc;
+
+	vbds_sched_set_enabled(disk, enable);
+	return EOK;
+}
+
 errno_t vbds_get_parts(service_id_t sid, service_id_t *id_buf, size_t buf_size,
     size_t *act_size)
 {
@@ -987,7 +1032,7 @@ static errno_t vbds_bd_read_blocks(bd_srv_t *bd, aoff64_t ba, size_t cnt,
 		return ELIMIT;
 	}
 
-	rc = block_read_direct(part->disk->svc_id, gba, cnt, buf);
+	rc = vbds_sched_rw(part, false, gba, cnt, buf);
 	fibril_rwlock_read_unlock(&part->lock);
 
 	return rc;
@@ -1037,7 +1082,7 @@ static errno_t vbds_bd_write_blocks(bd_srv_t *bd, aoff64_t ba, size_t cnt,
 		return ELIMIT;
 	}
 
-	rc = block_write_direct(part->disk->svc_id, gba, cnt, buf);
+	rc = vbds_sched_rw(part, true, gba, cnt, (void *) buf);
 	fibril_rwlock_read_unlock(&part->lock);
 	return rc;
 }
@@ -47,6 +47,8 @@ extern errno_t vbds_disk_add(service_id_t);
 extern errno_t vbds_disk_remove(service_id_t);
 extern errno_t vbds_disk_get_ids(service_id_t *, size_t, size_t *);
 extern errno_t vbds_disk_info(service_id_t, vbd_disk_info_t *);
+extern errno_t vbds_disk_stats(service_id_t, vbd_disk_stats_t *);
+extern errno_t vbds_disk_sched_set(service_id_t, bool);
 extern errno_t vbds_get_parts(service_id_t, service_id_t *, size_t, size_t *);
 extern errno_t vbds_label_create(service_id_t, label_type_t);
 extern errno_t vbds_label_delete(service_id_t);
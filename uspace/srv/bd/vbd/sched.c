@@ -0,0 +1,526 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup vbd
+ * @{
+ */
+/**
+ * @file Disk I/O scheduler
+ *
+ * Requests submitted to the partitions of a disk are queued per partition,
+ * sorted by block address. A dispatcher fibril serves the partitions in
+ * round-robin order. From the partition being served it takes the first
+ * request at or after the address where the previous transfer ended
+ * (one-way elevator) and merges it with adjacent requests going in the
+ * same direction. Reads and writes are kept in separate FIFOs, too. A request
+ * that waited longer than its deadline is dispatched ahead of everything
+ * else, expired reads first.
+ *
+ * Up to VBDS_SCHED_DEPTH merged transfers are kept in flight, each of them
+ * performed by a separate fibril.
+ */
+
+#include <adt/list.h>
+#include <assert.h>
+#include <block.h>
+#include <errno.h>
+#include <fibril.h>
+#include <fibril_synch.h>
+#include <io/log.h>
+#include <macros.h>
+#include <mem.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "sched.h"
+#include "types/vbd.h"
+
+/** Maximum time a read request waits in the queue */
+#define VBDS_SCHED_READ_EXPIRE_USEC	500000
+/** Maximum time a write request waits in the queue */
+#define VBDS_SCHED_WRITE_EXPIRE_USEC	5000000
+/** Maximum size of a merged transfer */
+#define VBDS_SCHED_MERGE_MAX	(128 * 1024)
+
+static errno_t vbds_sched_fibril(void *);
+
+/** Initialize disk I/O scheduler and start the dispatcher fibril.
+ *
+ * @param disk Disk
+ * @return EOK on success or an error code
+ */
+errno_t vbds_sched_init(vbds_disk_t *disk)
+{
+	vbds_sched_t *sched = &disk->sched;
+	fid_t fid;
+
+	fibril_mutex_initialize(&sched->lock);
+	fibril_condvar_initialize(&sched->dispatch_cv);
+	fibril_condvar_initialize(&sched->done_cv);
+	list_initialize(&sched->active);
+	list_initialize(&sched->read_fifo);
+	list_initialize(&sched->write_fifo);
+	sched->enabled = true;
+	sched->quit = false;
+	sched->stopped = false;
+	sched->head = 0;
+	sched->direct = 0;
+	memset(&sched->stats, 0, sizeof(sched->stats));
+
+	for (unsigned i = 0; i < VBDS_SCHED_DEPTH; i++) {
+		sched->batch[i].busy = false;
+		sched->batch[i].disk = disk;
+		list_initialize(&sched->batch[i].reqs);
+	}
+
+	fid = fibril_create(vbds_sched_fibril, disk);
+	if (fid == 0)
+		return ENOMEM;
+
+	fibril_add_ready(fid);
+	return EOK;
+}
+
+/** Stop the dispatcher fibril of a disk.
+ *
+ * Requests still queued are dispatched first.
+ *
+ * @param disk Disk
+ */
+void vbds_sched_fini(vbds_disk_t *disk)
+{
+	vbds_sched_t *sched = &disk->sched;
+
+	fibril_mutex_lock(&sched->lock);
+	sched->quit = true;
+	fibril_condvar_broadcast(&sched->dispatch_cv);
+	while (!sched->stopped || sched->stats.inflight > 0 ||
+	    sched->direct > 0)
+		fibril_condvar_wait(&sched->done_cv, &sched->lock);
+	fibril_mutex_unlock(&sched->lock);
+}
+
+/** Initialize scheduler-related part of partition structure. */
+void vbds_sched_part_init(vbds_part_t *part)
+{
+	list_initialize(&part->sched_q);
+	link_initialize(&part->lsched);
+}
+
+/** Enable or disable I/O scheduler.
+ *
+ * Requests that are already queued are still dispatched by the
+ * scheduler.
+ */
+void vbds_sched_set_enabled(vbds_disk_t *disk, bool enabled)
+{
+	fibril_mutex_lock(&disk->sched.lock);
+	disk->sched.enabled = enabled;
+	fibril_mutex_unlock(&disk->sched.lock);
+}
+
+/** Get I/O statistics of a disk. */
+void vbds_sched_get_stats(vbds_disk_t *disk, vbd_disk_stats_t *stats)
+{
+	fibril_mutex_lock(&disk->sched.lock);
+	*stats = disk->sched.stats;
+	stats->sched = disk->sched.enabled;
+	fibril_mutex_unlock(&disk->sched.lock);
+}
+
+/** Account latency of a completed request. Called with lock held. */
+static void vbds_sched_account(vbds_sched_t *sched,
+    const struct timespec *start)
+{
+	struct timespec now;
+	uint64_t lat;
+
+	getuptime(&now);
+	lat = NSEC2USEC(ts_sub_diff(&now, start));
+	sched->stats.lat_total_us += lat;
+	sched->stats.lat_max_us = max(sched->stats.lat_max_us, lat);
+}
+
+/** Perform transfer directly on the disk. */
+static errno_t vbds_sched_xfer(vbds_disk_t *disk, bool write, aoff64_t ba,
+    size_t cnt, void *buf)
+{
+	if (write)
+		return block_write_direct(disk->svc_id, ba, cnt, buf);
+	else
+		return block_read_direct(disk->svc_id, ba, cnt, buf);
+}
+
+/** Queue request. Called with lock held. */
+static void vbds_sched_enqueue(vbds_sched_t *sched, vbds_ioreq_t *req)
+{
+	vbds_part_t *part = req->part;
+
+	/* Keep the partition queue sorted by address */
+	list_foreach_rev(part->sched_q, lpart, vbds_ioreq_t, qreq) {
+		if (qreq->ba <= req->ba) {
+			list_insert_after(&req->lpart, &qreq->lpart);
+			goto inserted;
+		}
+	}
+
+	list_prepend(&req->lpart, &part->sched_q);
+inserted:
+	list_append(&req->lfifo, req->write ? &sched->write_fifo :
+	    &sched->read_fifo);
+
+	if (!link_in_use(&part->lsched))
+		list_append(&part->lsched, &sched->active);
+
+	sched->stats.queued++;
+	sched->stats.queued_max = max(sched->stats.queued_max,
+	    sched->stats.queued);
+}
+
+/** Remove request from the queue. Called with lock held. */
+static void vbds_sched_dequeue(vbds_sched_t *sched, vbds_ioreq_t *req)
+{
+	vbds_part_t *part = req->part;
+
+	list_remove(&req->lpart);
+	list_remove(&req->lfifo);
+
+	if (list_empty(&part->sched_q))
+		list_remove(&part->lsched);
+
+	assert(sched->stats.queued > 0);
+	sched->stats.queued--;
+}
+
+/** Return the oldest request of a FIFO if its deadline has passed.
+ *
+ * @param fifo Read or write FIFO
+ * @param now Current time
+ * @return Expired request or @c NULL
+ */
+static vbds_ioreq_t *vbds_sched_expired(list_t *fifo,
+    const struct timespec *now)
+{
+	vbds_ioreq_t *oldest;
+
+	if (list_empty(fifo))
+		return NULL;
+
+	oldest = list_get_instance(list_first(fifo), vbds_ioreq_t, lfifo);
+	if (!ts_gteq(now, &oldest->deadline))
+		return NULL;
+
+	return oldest;
+}
+
+/** Choose request to dispatch next. Called with lock held. */
+static vbds_ioreq_t *vbds_sched_pick(vbds_sched_t *sched)
+{
+	struct timespec now;
+	vbds_ioreq_t *oldest;
+	vbds_part_t *part;
+
+	getuptime(&now);
+	oldest = vbds_sched_expired(&sched->read_fifo, &now);
+	if (oldest == NULL)
+		oldest = vbds_sched_expired(&sched->write_fifo, &now);
+	if (oldest != NULL) {
+		sched->stats.expired++;
+		return oldest;
+	}
+
+	/* Serve the partition at the head and move it to the tail */
+	part = list_get_instance(list_first(&sched->active), vbds_part_t,
+	    lsched);
+	list_remove(&part->lsched);
+	list_append(&part->lsched, &sched->active);
+
+	list_foreach(part->sched_q, lpart, vbds_ioreq_t, req) {
+		if (req->ba >= sched->head)
+			return req;
+	}
+
+	/* Nothing ahead of the head, start over from the lowest address */
+	return list_get_instance(list_first(&part->sched_q), vbds_ioreq_t,
+	    lpart);
+}
+
+/** Build batch from request and its mergeable neighbours.
+ *
+ * Called with lock held. The requests are removed from the queue.
+ */
+static void vbds_sched_batch(vbds_sched_t *sched, vbds_batch_t *batch,
+    vbds_ioreq_t *req)
+{
+	vbds_part_t *part = req->part;
+	size_t max_cnt = max(VBDS_SCHED_MERGE_MAX / part->disk->block_size,
+	    (size_t) 1);
+	vbds_ioreq_t *first = req;
+	vbds_ioreq_t *last = req;
+	size_t cnt = req->cnt;
+	link_t *link;
+
+	/* Extend backwards */
+	while ((link = list_prev(&first->lpart, &part->sched_q)) != NULL) {
+		vbds_ioreq_t *prev = list_get_instance(link, vbds_ioreq_t,
+		    lpart);
+		if (prev->write != req->write ||
+		    prev->ba + prev->cnt != first->ba ||
+		    cnt + prev->cnt > max_cnt)
+			break;
+		cnt += prev->cnt;
+		first = prev;
+	}
+
+	/* Extend forwards */
+	while ((link = list_next(&last->lpart, &part->sched_q)) != NULL) {
+		vbds_ioreq_t *next = list_get_instance(link, vbds_ioreq_t,
+		    lpart);
+		if (next->write != req->write ||
+		    last->ba + last->cnt != next->ba ||
+		    cnt + next->cnt > max_cnt)
+			break;
+		cnt += next->cnt;
+		last = next;
+	}
+
+	batch->busy = true;
+	batch->write = req->write;
+	batch->ba = first->ba;
+	batch->cnt = cnt;
+
+	while (true) {
+		link = list_next(&first->lpart, &part->sched_q);
+		bool end = first == last;
+
+		vbds_sched_dequeue(sched, first);
+		list_append(&first->lbatch, &batch->reqs);
+		if (end)
+			break;
+
+		first = list_get_instance(link, vbds_ioreq_t, lpart);
+	}
+
+	sched->stats.merged += list_count(&batch->reqs) - 1;
+	sched->head = batch->ba + batch->cnt;
+}
+
+/** Perform transfer of a batch and complete its requests. */
+static errno_t vbds_sched_io_fibril(void *arg)
+{
+	vbds_batch_t *batch = (vbds_batch_t *) arg;
+	vbds_disk_t *disk = batch->disk;
+	vbds_sched_t *sched = &disk->sched;
+	size_t bsize = disk->block_size;
+	vbds_ioreq_t *req;
+	uint8_t *buf;
+	errno_t rc;
+
+	if (list_count(&batch->reqs) == 1) {
+		req = list_get_instance(list_first(&batch->reqs),
+		    vbds_ioreq_t, lbatch);
+		req->rc = vbds_sched_xfer(disk, batch->write, batch->ba,
+		    batch->cnt, req->buf);
+	} else if ((buf = malloc(batch->cnt * bsize)) != NULL) {
+		if (batch->write) {
+			list_foreach(batch->reqs, lbatch, vbds_ioreq_t, breq) {
+				memcpy(buf + (breq->ba - batch->ba) * bsize,
+				    breq->buf, breq->cnt * bsize);
+			}
+		}
+
+		rc = vbds_sched_xfer(disk, batch->write, batch->ba,
+		    batch->cnt, buf);
+
+		list_foreach(batch->reqs, lbatch, vbds_ioreq_t, breq) {
+			if (rc == EOK && !batch->write) {
+				memcpy(breq->buf,
+				    buf + (breq->ba - batch->ba) * bsize,
+				    breq->cnt * bsize);
+			}
+			breq->rc = rc;
+		}
+
+		free(buf);
+	} else {
+		/* Cannot merge without a buffer, transfer one by one */
+		list_foreach(batch->reqs, lbatch, vbds_ioreq_t, breq) {
+			breq->rc = vbds_sched_xfer(disk, breq->write, breq->ba,
+			    breq->cnt, breq->buf);
+		}
+	}
+
+	fibril_mutex_lock(&sched->lock);
+
+	while ((req = list_pop(&batch->reqs, vbds_ioreq_t, lbatch)) != NULL)
+		req->done = true;
+
+	batch->busy = false;
+	assert(sched->stats.inflight > 0);
+	sched->stats.inflight--;
+	fibril_condvar_broadcast(&sched->done_cv);
+	fibril_condvar_signal(&sched->dispatch_cv);
+	fibril_mutex_unlock(&sched->lock);
+
+	return EOK;
+}
+
+/** Dispatcher fibril. */
+static errno_t vbds_sched_fibril(void *arg)
+{
+	vbds_disk_t *disk = (vbds_disk_t *) arg;
+	vbds_sched_t *sched = &disk->sched;
+	vbds_batch_t *batch;
+	vbds_ioreq_t *req;
+	fid_t fid;
+
+	fibril_mutex_lock(&sched->lock);
+
+	while (true) {
+		while ((sched->stats.queued == 0 && !sched->quit) ||
+		    sched->stats.inflight >= VBDS_SCHED_DEPTH) {
+			fibril_condvar_wait(&sched->dispatch_cv, &sched->lock);
+		}
+
+		if (sched->stats.queued == 0)
+			break;
+
+		batch = NULL;
+		for (unsigned i = 0; i < VBDS_SCHED_DEPTH; i++) {
+			if (!sched->batch[i].busy) {
+				batch = &sched->batch[i];
+				break;
+			}
+		}
+
+		assert(batch != NULL);
+
+		req = vbds_sched_pick(sched);
+		vbds_sched_batch(sched, batch, req);
+
+		sched->stats.dispatched++;
+		sched->stats.inflight++;
+		sched->stats.inflight_max = max(sched->stats.inflight_max,
+		    sched->stats.inflight);
+
+		fid = fibril_create(vbds_sched_io_fibril, batch);
+		if (fid == 0) {
+			log_msg(LOG_DEFAULT, LVL_WARN, "Failed creating I/O "
+			    "fibril, performing I/O synchronously.");
+			fibril_mutex_unlock(&sched->lock);
+			(void) vbds_sched_io_fibril(batch);
+			fibril_mutex_lock(&sched->lock);
+			continue;
+		}
+
+		fibril_add_ready(fid);
+	}
+
+	sched->stopped = true;
+	fibril_condvar_broadcast(&sched->done_cv);
+	fibril_mutex_unlock(&sched->lock);
+	return EOK;
+}
+
+/** Read or write blocks of a partition.
+ *
+ * If the scheduler is enabled, the request is queued and the function
+ * waits until it has been dispatched and completed. Otherwise the transfer
+ * is performed directly.
+ *
+ * @param part Partition
+ * @param write @c true to write, @c false to read
+ * @param ba Disk address of first block
+ * @param cnt Number of blocks
+ * @param buf Data buffer
+ * @return EOK on success or an error code
+ */
+errno_t vbds_sched_rw(vbds_part_t *part, bool write, aoff64_t ba, size_t cnt,
+    void *buf)
+{
+	vbds_disk_t *disk = part->disk;
+	vbds_sched_t *sched = &disk->sched;
+	struct timespec start;
+	vbds_ioreq_t req;
+	errno_t rc;
+
+	getuptime(&start);
+
+	fibril_mutex_lock(&sched->lock);
+	if (write)
+		sched->stats.writes++;
+	else
+		sched->stats.reads++;
+
+	if (!sched->enabled || cnt == 0) {
+		/*
+		 * Direct transfers do not occupy a batch, so they are not
+		 * counted as in flight.
+		 */
+		sched->stats.dispatched++;
+		sched->direct++;
+		fibril_mutex_unlock(&sched->lock);
+
+		rc = vbds_sched_xfer(disk, write, ba, cnt, buf);
+
+		fibril_mutex_lock(&sched->lock);
+		sched->direct--;
+		vbds_sched_account(sched, &start);
+		fibril_condvar_broadcast(&sched->done_cv);
+		fibril_mutex_unlock(&sched->lock);
+		return rc;
+	}
+
+	link_initialize(&req.lpart);
+	link_initialize(&req.lfifo);
+	link_initialize(&req.lbatch);
+	req.part = part;
+	req.write = write;
+	req.ba = ba;
+	req.cnt = cnt;
+	req.buf = buf;
+	req.deadline = start;
+	ts_add_diff(&req.deadline, USEC2NSEC(write ?
+	    VBDS_SCHED_WRITE_EXPIRE_USEC : VBDS_SCHED_READ_EXPIRE_USEC));
+	req.done = false;
+	req.rc = EOK;
+
+	vbds_sched_enqueue(sched, &req);
+	fibril_condvar_signal(&sched->dispatch_cv);
+
+	while (!req.done)
+		fibril_condvar_wait(&sched->done_cv, &sched->lock);
+
+	vbds_sched_account(sched, &start);
+	fibril_mutex_unlock(&sched->lock);
+
+	return req.rc;
+}
+
+/** @}
+ */
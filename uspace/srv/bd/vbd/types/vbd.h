@@ -39,12 +39,18 @@
 
 #include <adt/list.h>
 #include <bd_srv.h>
+#include <fibril_synch.h>
 #include <label/label.h>
 #include <loc.h>
 #include <refcount.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <time.h>
 #include <types/label.h>
+#include <vbd.h>
+
+/** Maximum number of merged requests the scheduler keeps in flight */
+#define VBDS_SCHED_DEPTH 8
 
 typedef sysarg_t vbds_part_id_t;
 
@@ -83,8 +89,84 @@ typedef struct {
 	aoff64_t nblocks;
 	/** Reference count */
 	atomic_refcount_t refcnt;
+	/** Requests queued in the disk scheduler, sorted by address */
+	list_t sched_q; /* of vbds_ioreq_t */
+	/** Link to vbds_sched_t.active */
+	link_t lsched;
 } vbds_part_t;
 
+/** I/O request queued in the disk scheduler */
+typedef struct {
+	/** Link to vbds_part_t.sched_q */
+	link_t lpart;
+	/** Link to vbds_sched_t.read_fifo or vbds_sched_t.write_fifo */
+	link_t lfifo;
+	/** Link to vbds_batch_t.reqs */
+	link_t lbatch;
+	/** Partition the request was submitted to */
+	vbds_part_t *part;
+	/** @c true for write, @c false for read */
+	bool write;
+	/** Disk address of first block */
+	aoff64_t ba;
+	/** Number of blocks */
+	size_t cnt;
+	/** Data buffer */
+	void *buf;
+	/** Time by which the request should be dispatched */
+	struct timespec deadline;
+	/** Request has completed */
+	bool done;
+	/** Completion status */
+	errno_t rc;
+} vbds_ioreq_t;
+
+/** Merged requests dispatched to the disk as one transfer */
+typedef struct {
+	/** Batch is in use */
+	bool busy;
+	/** Disk */
+	struct vbds_disk *disk;
+	/** Requests, sorted by address */
+	list_t reqs; /* of vbds_ioreq_t */
+	/** @c true for write, @c false for read */
+	bool write;
+	/** Disk address of first block */
+	aoff64_t ba;
+	/** Number of blocks */
+	size_t cnt;
+} vbds_batch_t;
+
+/** Per-disk I/O scheduler */
+typedef struct {
+	/** Protects scheduler state */
+	fibril_mutex_t lock;
+	/** Signalled when a request is queued or a batch completes */
+	fibril_condvar_t dispatch_cv;
+	/** Signalled when a request completes */
+	fibril_condvar_t done_cv;
+	/** Scheduler is enabled */
+	bool enabled;
+	/** Dispatcher fibril should terminate */
+	bool quit;
+	/** Dispatcher fibril has terminated */
+	bool stopped;
+	/** Partitions with queued requests in round-robin order */
+	list_t active; /* of vbds_part_t */
+	/** Queued read requests in order of arrival */
+	list_t read_fifo; /* of vbds_ioreq_t */
+	/** Queued write requests in order of arrival */
+	list_t write_fifo; /* of vbds_ioreq_t */
+	/** Transfers performed directly, bypassing the queue */
+	unsigned direct;
+	/** Address following the last dispatched request */
+	aoff64_t head;
+	/** Batches */
+	vbds_batch_t batch[VBDS_SCHED_DEPTH];
+	/** Statistics */
+	vbd_disk_stats_t stats;
+} vbds_sched_t;
+
 /** Disk */
 typedef struct vbds_disk {
 	/** Link to vbds_disks */
@@ -103,6 +185,8 @@ typedef struct vbds_disk {
 	aoff64_t nblocks;
 	/** Used to mark disks still present during re-discovery */
 	bool present;
+	/** I/O scheduler */
+	vbds_sched_t sched;
 } vbds_disk_t;
 
 #endif
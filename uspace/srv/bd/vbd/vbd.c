@@ -160,6 +160,59 @@ static void vbds_disk_info_srv(ipc_call_t *icall)
 	async_answer_0(icall, EOK);
 }
 
+static void vbds_disk_stats_srv(ipc_call_t *icall)
+{
+	service_id_t disk_sid;
+	vbd_disk_stats_t stats;
+	errno_t rc;
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "vbds_disk_stats_srv()");
+
+	disk_sid = ipc_get_arg1(icall);
+	rc = vbds_disk_stats(disk_sid, &stats);
+	if (rc != EOK) {
+		async_answer_0(icall, rc);
+		return;
+	}
+
+	ipc_call_t call;
+	size_t size;
+	if (!async_data_read_receive(&call, &size)) {
+		async_answer_0(&call, EREFUSED);
+		async_answer_0(icall, EREFUSED);
+		return;
+	}
+
+	if (size != sizeof(vbd_disk_stats_t)) {
+		async_answer_0(&call, EINVAL);
+		async_answer_0(icall, EINVAL);
+		return;
+	}
+
+	rc = async_data_read_finalize(&call, &stats, size);
+	if (rc != EOK) {
+		async_answer_0(&call, rc);
+		async_answer_0(icall, rc);
+		return;
+	}
+
+	async_answer_0(icall, EOK);
+}
+
+static void vbds_disk_sched_set_srv(ipc_call_t *icall)
+{
+	service_id_t disk_sid;
+	bool enable;
+	errno_t rc;
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "vbds_disk_sched_set_srv()");
+
+	disk_sid = ipc_get_arg1(icall);
+	enable = ipc_get_arg2(icall) != 0;
+	rc = vbds_disk_sched_set(disk_sid, enable);
+	async_answer_0(icall, rc);
+}
+
 static void vbds_label_create_srv(ipc_call_t *icall)
 {
 	service_id_t disk_sid;
@@ -405,6 +458,12 @@ static void vbds_ctl_conn(ipc_call_t *icall, void *arg)
 		case VBD_SUGGEST_PTYPE:
 			vbds_suggest_ptype_srv(&call);
 			break;
+		case VBD_DISK_STATS:
+			vbds_disk_stats_srv(&call);
+			break;
+		case VBD_DISK_SCHED_SET:
+			vbds_disk_sched_set_srv(&call);
+			break;
 		default:
 			async_answer_0(&call, EINVAL);
 		}
@@ -217,6 +217,96 @@ exfat_block_get_by_clst(block_t **block, exfat_bs_t *bs,
 	return rc;
 }
 
+/** Get a run of physically consecutive blocks of an exFAT node.
+ *
+ * @param bs		Buffer holding the boot sector of the file system.
+ * @param nodep		exFAT node.
+ * @param bn		Block number of the first block of the run.
+ * @param max		Maximum number of blocks in the run. The caller must
+ *			make sure that all of them are allocated to the node.
+ * @param pbn		Output argument holding the physical block number of
+ *			the first block of the run.
+ * @param count		Output argument holding the number of blocks in the
+ *			run.
+ *
+ * @return		EOK on success or an error code.
+ */
+errno_t
+exfat_block_run_get(exfat_bs_t *bs, exfat_node_t *nodep, aoff64_t bn,
+    uint32_t max, aoff64_t *pbn, uint32_t *count)
+{
+	service_id_t service_id = nodep->idx->service_id;
+	exfat_cluster_t c = nodep->firstc;
+	exfat_cluster_t next;
+	aoff64_t relbn = bn;
+	uint32_t clusters;
+	uint32_t n;
+	errno_t rc;
+
+	assert(max > 0);
+
+	if (!nodep->size)
+		return ELIMIT;
+
+	if (!nodep->fragmented) {
+		/* The whole node is stored in consecutive clusters. */
+		*pbn = DATA_FS(bs) + (c - EXFAT_CLST_FIRST) * SPC(bs) + bn;
+		*count = max;
+		return EOK;
+	}
+
+	if (((((nodep->size - 1) / BPS(bs)) / SPC(bs)) == bn / SPC(bs)) &&
+	    nodep->lastc_cached_valid) {
+		/*
+		 * The run starts within the last cluster, so it cannot extend
+		 * any further than that.
+		 */
+		*pbn = DATA_FS(bs) + (nodep->lastc_cached_value -
+		    EXFAT_CLST_FIRST) * SPC(bs) + (bn % SPC(bs));
+		*count = min(max, SPC(bs) - bn % SPC(bs));
+		return EOK;
+	}
+
+	if (nodep->currc_cached_valid && bn >= nodep->currc_cached_bn) {
+		/*
+		 * We can start with the cluster cached by the previous call to
+		 * exfat_block_get() or exfat_block_run_get().
+		 */
+		c = nodep->currc_cached_value;
+		relbn -= (nodep->currc_cached_bn / SPC(bs)) * SPC(bs);
+	}
+
+	rc = exfat_cluster_walk(bs, service_id, c, &c, &clusters,
+	    relbn / SPC(bs));
+	if (rc != EOK)
+		return rc;
+	assert(clusters == relbn / SPC(bs));
+
+	*pbn = DATA_FS(bs) + (c - EXFAT_CLST_FIRST) * SPC(bs) + (bn % SPC(bs));
+
+	/* Extend the run over physically consecutive clusters. */
+	n = SPC(bs) - bn % SPC(bs);
+	while (n < max) {
+		rc = exfat_get_cluster(bs, service_id, c, &next);
+		if (rc != EOK)
+			return rc;
+		if (next == EXFAT_CLST_EOF || next != c + 1)
+			break;
+		c = next;
+		n += SPC(bs);
+	}
+	*count = min(n, max);
+
+	/*
+	 * Update the "current" cluster cache with the last block of the run.
+	 */
+	nodep->currc_cached_valid = true;
+	nodep->currc_cached_bn = bn + *count - 1;
+	nodep->currc_cached_value = c;
+
+	return EOK;
+}
+
 /** Get cluster from the FAT.
  *
  * @param bs		Buffer holding the boot sector for the file system.
@@ -61,6 +61,9 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+/** Maximum number of bytes transferred by a single read or write. */
+#define EXFAT_IO_MAX	(256 * 1024)
+
 /** Mutex protecting the list of cached free FAT nodes. */
 static FIBRIL_MUTEX_INITIALIZE(ffn_mutex);
 
@@ -1317,6 +1320,138 @@ static errno_t exfat_unmounted(service_id_t service_id)
 	return EOK;
 }
 
+/** Read data from a regular file.
+ *
+ * @param call		Data read call to answer.
+ * @param bs		Buffer holding the boot sector of the file system.
+ * @param nodep		exFAT node of the file.
+ * @param pos		Position to read from, must be within the file.
+ * @param len		Number of bytes requested by the client.
+ * @param rbytes	Output argument holding the number of bytes read.
+ *
+ * @return		EOK on success or an error code.
+ */
+static errno_t
+exfat_read_file(ipc_call_t *call, exfat_bs_t *bs, exfat_node_t *nodep,
+    aoff64_t pos, size_t len, size_t *rbytes)
+{
+	service_id_t service_id = nodep->idx->service_id;
+	aoff64_t end = min(pos + len, nodep->size);
+	uint32_t nblocks;
+	uint32_t cnt = 1;
+	aoff64_t pbn;
+	size_t bytes;
+	block_t *b;
+	errno_t rc;
+
+	nblocks = min((end - 1) / BPS(bs) - pos / BPS(bs) + 1,
+	    EXFAT_IO_MAX / BPS(bs));
+	if (nblocks > 1) {
+		rc = exfat_block_run_get(bs, nodep, pos / BPS(bs), nblocks,
+		    &pbn, &cnt);
+		if (rc != EOK) {
+			async_answer_0(call, rc);
+			return rc;
+		}
+	}
+
+	if (cnt == 1) {
+		bytes = min(len, BPS(bs) - pos % BPS(bs));
+		bytes = min(bytes, nodep->size - pos);
+		rc = exfat_block_get(&b, bs, nodep, pos / BPS(bs),
+		    BLOCK_FLAGS_NONE);
+		if (rc != EOK) {
+			async_answer_0(call, rc);
+			return rc;
+		}
+		(void) async_data_read_finalize(call,
+		    b->data + pos % BPS(bs), bytes);
+		rc = block_put(b);
+		if (rc != EOK)
+			return rc;
+
+		*rbytes = bytes;
+		return EOK;
+	}
+
+	uint8_t *buf = malloc((size_t) cnt * BPS(bs));
+	if (!buf) {
+		async_answer_0(call, ENOMEM);
+		return ENOMEM;
+	}
+
+	rc = block_read_lblocks(service_id, pbn, cnt, buf);
+	if (rc != EOK) {
+		free(buf);
+		async_answer_0(call, rc);
+		return rc;
+	}
+
+	bytes = min((size_t) cnt * BPS(bs) - pos % BPS(bs), end - pos);
+	(void) async_data_read_finalize(call, buf + pos % BPS(bs), bytes);
+	free(buf);
+
+	*rbytes = bytes;
+	return EOK;
+}
+
+/** Receive whole blocks from the client and write them to a file.
+ *
+ * The blocks must already be allocated to the node. They are written
+ * directly to the device, one run of physically consecutive blocks at a
+ * time.
+ *
+ * @param call		Data write call to answer.
+ * @param bs		Buffer holding the boot sector of the file system.
+ * @param nodep		exFAT node of the file.
+ * @param bn		Number of the first block to write.
+ * @param bytes		Number of bytes to write, a multiple of the block size.
+ *
+ * @return		EOK on success or an error code.
+ */
+static errno_t
+exfat_write_blocks(ipc_call_t *call, exfat_bs_t *bs, exfat_node_t *nodep,
+    aoff64_t bn, size_t bytes)
+{
+	service_id_t service_id = nodep->idx->service_id;
+	uint32_t cnt = bytes / BPS(bs);
+	uint8_t *buf, *data;
+	aoff64_t pbn;
+	uint32_t n;
+	errno_t rc;
+
+	assert(bytes % BPS(bs) == 0);
+
+	buf = malloc(bytes);
+	if (!buf) {
+		async_answer_0(call, ENOMEM);
+		return ENOMEM;
+	}
+
+	rc = async_data_write_finalize(call, buf, bytes);
+	if (rc != EOK)
+		goto out;
+
+	data = buf;
+	while (cnt > 0) {
+		rc = exfat_block_run_get(bs, nodep, bn, cnt, &pbn, &n);
+		if (rc != EOK)
+			goto out;
+
+		rc = block_write_lblocks(service_id, pbn, n, data);
+		if (rc != EOK)
+			goto out;
+
+		data += (size_t) n * BPS(bs);
+		bn += n;
+		cnt -= n;
+	}
+
+out:
+	free(buf);
+	return rc;
+}
+
 static errno_t
 exfat_read(service_id_t service_id, fs_index_t index, aoff64_t pos,
     size_t *rbytes)
@@ -1325,7 +1460,6 @@ exfat_read(service_id_t service_id, fs_index_t index, aoff64_t pos,
 	exfat_node_t *nodep;
 	exfat_bs_t *bs;
 	size_t bytes = 0;
-	block_t *b;
 	errno_t rc;
 
 	rc = exfat_node_get(&fn, service_id, index);
@@ -1347,27 +1481,18 @@ exfat_read(service_id_t service_id, fs_index_t index, aoff64_t pos,
 
 	if (nodep->type == EXFAT_FILE) {
 		/*
-		 * Our strategy for regular file reads is to read one block at
-		 * most and make use of the possibility to return less data than
-		 * requested. This keeps the code very simple.
+		 * Our strategy for regular file reads is to read at most one
+		 * run of physically consecutive blocks and make use of the
+		 * possibility to return less data than requested. A single
+		 * block is read through the block cache, longer runs are read
+		 * from the device at once.
 		 */
 		if (pos >= nodep->size) {
 			/* reading beyond the EOF */
 			bytes = 0;
 			(void) async_data_read_finalize(&call, NULL, 0);
 		} else {
-			bytes = min(len, BPS(bs) - pos % BPS(bs));
-			bytes = min(bytes, nodep->size - pos);
-			rc = exfat_block_get(&b, bs, nodep, pos / BPS(bs),
-			    BLOCK_FLAGS_NONE);
-			if (rc != EOK) {
-				exfat_node_put(fn);
-				async_answer_0(&call, rc);
-				return rc;
-			}
-			(void) async_data_read_finalize(&call,
-			    b->data + pos % BPS(bs), bytes);
-			rc = block_put(b);
+			rc = exfat_read_file(&call, bs, nodep, pos, len, &bytes);
 			if (rc != EOK) {
 				exfat_node_put(fn);
 				return rc;
@@ -1489,18 +1614,25 @@ exfat_write(service_id_t service_id, fs_index_t index, aoff64_t pos,
 
 	bs = block_bb_get(service_id);
 
+	boundary = ROUND_UP(nodep->size, BPC(bs));
+
 	/*
-	 * In all scenarios, we will attempt to write out only one block worth
-	 * of data at maximum. There might be some more efficient approaches,
-	 * but this one greatly simplifies fat_write(). Note that we can afford
-	 * to do this because the client must be ready to handle the return
-	 * value signalizing a smaller number of bytes written.
+	 * Unless the client writes several whole blocks, we will attempt to
+	 * write out only one block worth of data at maximum. Whole blocks are
+	 * written in one go, but only up to the end of the allocated clusters
+	 * when overwriting. Note that we can afford to do this because the
+	 * client must be ready to handle the return value signalizing a
+	 * smaller number of bytes written.
 	 */
 	bytes = min(len, BPS(bs) - pos % BPS(bs));
+	if (pos % BPS(bs) == 0 && len >= 2 * BPS(bs)) {
+		bytes = ALIGN_DOWN(min(len, EXFAT_IO_MAX), BPS(bs));
+		if (pos < boundary)
+			bytes = min(bytes, boundary - pos);
+	}
 	if (bytes == BPS(bs))
 		flags |= BLOCK_FLAGS_NOREAD;
 
-	boundary = ROUND_UP(nodep->size, BPC(bs));
 	if (pos >= boundary) {
 		unsigned nclsts;
 		nclsts = (ROUND_UP(pos + bytes, BPC(bs)) - boundary) / BPC(bs);
@@ -1518,6 +1650,19 @@ exfat_write(service_id_t service_id, fs_index_t index, aoff64_t pos,
 		nodep->dirty = true;	/* need to sync node */
 	}
 
+	if (bytes > BPS(bs)) {
+		rc = exfat_write_blocks(&call, bs, nodep, pos / BPS(bs), bytes);
+		if (rc != EOK) {
+			(void) exfat_node_put(fn);
+			return rc;
+		}
+
+		*wbytes = bytes;
+		*nsize = nodep->size;
+		rc = exfat_node_put(fn);
+		return rc;
+	}
+
 	/*
 	 * This is the easier case - we are either overwriting already
 	 * existing contents or writing behind the EOF, but still within
@@ -224,6 +224,165 @@ _fat_block_get(block_t **block, fat_bs_t *bs, service_id_t service_id,
 	return rc;
 }
 
+/** Extend a run of blocks over physically consecutive clusters.
+ *
+ * @param bs		Buffer holding the boot sector of the file system.
+ * @param service_id	Service ID handle of the file system.
+ * @param c		Cluster containing the first block of the run.
+ * @param clp		If not NULL, address where the cluster containing the
+ *			last block of the run will be stored.
+ * @param bn		Block number of the first block of the run.
+ * @param max		Maximum number of blocks in the run.
+ * @param pbn		Output argument holding the physical block number of
+ *			the first block of the run.
+ * @param count		Output argument holding the number of blocks in the
+ *			run.
+ *
+ * @return		EOK on success or an error code.
+ */
+static errno_t
+fat_cluster_run(fat_bs_t *bs, service_id_t service_id, fat_cluster_t c,
+    fat_cluster_t *clp, aoff64_t bn, uint32_t max, aoff64_t *pbn,
+    uint32_t *count)
+{
+	fat_cluster_t next;
+	uint32_t n;
+	errno_t rc;
+
+	*pbn = CLBN2PBN(bs, c, bn);
+
+	n = SPC(bs) - bn % SPC(bs);
+	while (n < max) {
+		/* read FAT1 */
+		rc = fat_get_cluster(bs, service_id, FAT1, c, &next);
+		if (rc != EOK)
+			return rc;
+		if (next >= FAT_CLST_LAST1(bs) || next != c + 1)
+			break;
+		c = next;
+		n += SPC(bs);
+	}
+
+	*count = min(n, max);
+	if (clp)
+		*clp = c;
+
+	return EOK;
+}
+
+/** Get a run of physically consecutive blocks of a FAT node.
+ *
+ * @param bs		Buffer holding the boot sector of the file system.
+ * @param nodep		FAT node.
+ * @param bn		Block number of the first block of the run.
+ * @param max		Maximum number of blocks in the run. The caller must
+ *			make sure that all of them are allocated to the node.
+ * @param pbn		Output argument holding the physical block number of
+ *			the first block of the run.
+ * @param count		Output argument holding the number of blocks in the
+ *			run.
+ *
+ * @return		EOK on success or an error code.
+ */
+errno_t
+fat_block_run_get(struct fat_bs *bs, fat_node_t *nodep, aoff64_t bn,
+    uint32_t max, aoff64_t *pbn, uint32_t *count)
+{
+	fat_cluster_t firstc = nodep->firstc;
+	fat_cluster_t currc = 0;
+	aoff64_t relbn = bn;
+	errno_t rc;
+
+	if (!nodep->size)
+		return ELIMIT;
+
+	if (!FAT_IS_FAT32(bs) && nodep->firstc == FAT_CLST_ROOT)
+		goto fall_through;
+
+	if (((((nodep->size - 1) / BPS(bs)) / SPC(bs)) == bn / SPC(bs)) &&
+	    nodep->lastc_cached_valid) {
+		/*
+		 * The run starts within the last cluster, so it cannot extend
+		 * any further than that.
+		 */
+		*pbn = CLBN2PBN(bs, nodep->lastc_cached_value, bn);
+		*count = min(max, SPC(bs) - bn % SPC(bs));
+		return EOK;
+	}
+
+	if (nodep->currc_cached_valid && bn >= nodep->currc_cached_bn) {
+		/*
+		 * We can start with the cluster cached by the previous call to
+		 * fat_block_get() or fat_block_run_get().
+		 */
+		firstc = nodep->currc_cached_value;
+		relbn -= (nodep->currc_cached_bn / SPC(bs)) * SPC(bs);
+	}
+
+fall_through:
+	rc = _fat_block_run_get(bs, nodep->idx->service_id, firstc, &currc,
+	    relbn, max, pbn, count);
+	if (rc != EOK)
+		return rc;
+
+	/*
+	 * Update the "current" cluster cache with the last block of the run.
+	 */
+	nodep->currc_cached_valid = true;
+	nodep->currc_cached_bn = bn + *count - 1;
+	nodep->currc_cached_value = currc;
+
+	return rc;
+}
+
+/** Get a run of physically consecutive blocks of a cluster chain.
+ *
+ * @param bs		Buffer holding the boot sector of the file system.
+ * @param service_id	Service ID handle of the file system.
+ * @param fcl		First cluster of the chain.
+ * @param clp		If not NULL, address where the cluster containing the
+ *			last block of the run will be stored.
+ * @param bn		Block number of the first block of the run.
+ * @param max		Maximum number of blocks in the run.
+ * @param pbn		Output argument holding the physical block number of
+ *			the first block of the run.
+ * @param count		Output argument holding the number of blocks in the
+ *			run.
+ *
+ * @return		EOK on success or an error code.
+ */
+errno_t
+_fat_block_run_get(fat_bs_t *bs, service_id_t service_id, fat_cluster_t fcl,
+    fat_cluster_t *clp, aoff64_t bn, uint32_t max, aoff64_t *pbn,
+    uint32_t *count)
+{
+	uint32_t clusters;
+	uint32_t max_clusters;
+	fat_cluster_t c = 0;
+	errno_t rc;
+
+	assert(max > 0);
+
+	if (fcl == FAT_CLST_RES0)
+		return ELIMIT;
+
+	if (!FAT_IS_FAT32(bs) && fcl == FAT_CLST_ROOT) {
+		/* root directory special case */
+		assert(bn < RDS(bs));
+		*pbn = RSCNT(bs) + FATCNT(bs) * SF(bs) + bn;
+		*count = min(max, RDS(bs) - bn);
+		return EOK;
+	}
+
+	max_clusters = bn / SPC(bs);
+	rc = fat_cluster_walk(bs, service_id, fcl, &c, &clusters, max_clusters);
+	if (rc != EOK)
+		return rc;
+	assert(clusters == max_clusters);
+
+	return fat_cluster_run(bs, service_id, c, clp, bn, max, pbn, count);
+}
+
 /** Fill the gap between EOF and a new file position.
  *
  * @param bs		Buffer holding the boot sector for nodep.
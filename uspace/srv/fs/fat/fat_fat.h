@@ -114,6 +114,11 @@ extern errno_t fat_block_get(block_t **, struct fat_bs *, struct fat_node *,
     aoff64_t, int);
 extern errno_t _fat_block_get(block_t **, struct fat_bs *, service_id_t,
     fat_cluster_t, fat_cluster_t *, aoff64_t, int);
+extern errno_t fat_block_run_get(struct fat_bs *, struct fat_node *,
+    aoff64_t, uint32_t, aoff64_t *, uint32_t *);
+extern errno_t _fat_block_run_get(struct fat_bs *, service_id_t,
+    fat_cluster_t, fat_cluster_t *, aoff64_t, uint32_t, aoff64_t *,
+    uint32_t *);
 
 extern errno_t fat_append_clusters(struct fat_bs *, struct fat_node *,
     fat_cluster_t, fat_cluster_t);
@@ -63,6 +63,9 @@
 #define DPS(bs)		(BPS((bs)) / sizeof(fat_dentry_t))
 #define BPC(bs)		(BPS((bs)) * SPC((bs)))
 
+/** Maximum number of bytes transferred by a single read or write. */
+#define FAT_IO_MAX	(256 * 1024)
+
 /** Mutex protecting the list of cached free FAT nodes. */
 static FIBRIL_MUTEX_INITIALIZE(ffn_mutex);
 
@@ -1236,14 +1239,56 @@ fat_read(service_id_t service_id, fs_index_t index, aoff64_t pos,
 
 	if (nodep->type == FAT_FILE) {
 		/*
-		 * Our strategy for regular file reads is to read one block at
-		 * most and make use of the possibility to return less data than
-		 * requested. This keeps the code very simple.
+		 * Our strategy for regular file reads is to read at most one
+		 * run of physically consecutive blocks and make use of the
+		 * possibility to return less data than requested. A single
+		 * block is read through the block cache, longer runs are read
+		 * from the device at once.
 		 */
+		aoff64_t pbn;
+		uint32_t cnt = 1;
+
 		if (pos >= nodep->size) {
 			/* reading beyond the EOF */
 			bytes = 0;
 			(void) async_data_read_finalize(&call, NULL, 0);
+			goto done;
+		}
+
+		aoff64_t end = min(pos + len, nodep->size);
+		uint32_t nblocks = min((end - 1) / BPS(bs) - pos / BPS(bs) + 1,
+		    FAT_IO_MAX / BPS(bs));
+		if (nblocks > 1) {
+			rc = fat_block_run_get(bs, nodep, pos / BPS(bs), nblocks,
+			    &pbn, &cnt);
+			if (rc != EOK) {
+				fat_node_put(fn);
+				async_answer_0(&call, rc);
+				return rc;
+			}
+		}
+
+		if (cnt > 1) {
+			uint8_t *buf;
+
+			bytes = min((size_t) cnt * BPS(bs) - pos % BPS(bs),
+			    end - pos);
+			buf = malloc((size_t) cnt * BPS(bs));
+			if (!buf) {
+				fat_node_put(fn);
+				async_answer_0(&call, ENOMEM);
+				return ENOMEM;
+			}
+			rc = block_read_lblocks(service_id, pbn, cnt, buf);
+			if (rc != EOK) {
+				free(buf);
+				fat_node_put(fn);
+				async_answer_0(&call, rc);
+				return rc;
+			}
+			(void) async_data_read_finalize(&call,
+			    buf + pos % BPS(bs), bytes);
+			free(buf);
 		} else {
 			bytes = min(len, BPS(bs) - pos % BPS(bs));
 			bytes = min(bytes, nodep->size - pos);
@@ -1311,11 +1356,138 @@ fat_read(service_id_t service_id, fs_index_t index, aoff64_t pos,
 		bytes = (pos - spos) + 1;
 	}
 
+done:
 	rc = fat_node_put(fn);
 	*rbytes = bytes;
 	return rc;
 }
 
+static errno_t
+fat_readdir(service_id_t service_id, fs_index_t index, aoff64_t pos,
+    unsigned flags, void *buf, size_t size, size_t *used)
+{
+	char name[FAT_LFN_NAME_SIZE];
+	fs_node_t *fn;
+	fat_node_t *nodep;
+	fat_directory_t di;
+	fat_dentry_t *d;
+	errno_t rc, rc2;
+
+	rc = fat_node_get(&fn, service_id, index);
+	if (rc != EOK)
+		return rc;
+	if (!fn)
+		return ENOENT;
+	nodep = FAT_NODE(fn);
+
+	if (nodep->type != FAT_DIRECTORY) {
+		(void) fat_node_put(fn);
+		return ENOTDIR;
+	}
+
+	rc = fat_directory_open(nodep, &di);
+	if (rc != EOK) {
+		(void) fat_node_put(fn);
+		return rc;
+	}
+
+	/*
+	 * The position is the index of the dentry, the type and the size
+	 * come with the dentry for free.
+	 */
+	*used = 0;
+	rc = fat_directory_seek(&di, pos);
+	while (rc == EOK) {
+		rc = fat_directory_read(&di, name, &d);
+		if (rc != EOK)
+			break;
+
+		if (!libfs_dirent_add(buf, size, used, name,
+		    (d->attr & FAT_ATTR_SUBDIR) ? VFS_DIRENT_DIRECTORY :
+		    VFS_DIRENT_FILE, uint32_t_le2host(d->size), di.pos + 1)) {
+			if (*used == 0)
+				rc = ELIMIT;
+			break;
+		}
+
+		rc = fat_directory_next(&di);
+	}
+
+	/* Running off the end of the directory is not an error */
+	if (rc == ENOENT)
+		rc = EOK;
+
+	rc2 = fat_directory_close(&di);
+	if (rc == EOK)
+		rc = rc2;
+	rc2 = fat_node_put(fn);
+	return rc != EOK ? rc : rc2;
+}
+
+/** Receive whole blocks from the client and write them to the device.
+ *
+ * The blocks are written directly to the device, one run of physically
+ * consecutive blocks at a time.
+ *
+ * @param call		Data write call to answer.
+ * @param bs		Buffer holding the boot sector of the file system.
+ * @param service_id	Service ID of the device.
+ * @param nodep		FAT node to write to or NULL to write to an independent
+ *			cluster chain.
+ * @param fcl		First cluster of the independent cluster chain, ignored
+ *			if nodep is not NULL.
+ * @param bn		Number of the first block to write.
+ * @param bytes		Number of bytes to write, a multiple of the block size.
+ *
+ * @return		EOK on success or an error code.
+ */
+static errno_t
+fat_blocks_write(ipc_call_t *call, fat_bs_t *bs, service_id_t service_id,
+    fat_node_t *nodep, fat_cluster_t fcl, aoff64_t bn, size_t bytes)
+{
+	uint32_t cnt = bytes / BPS(bs);
+	uint8_t *buf, *data;
+	aoff64_t pbn;
+	uint32_t n;
+	errno_t rc;
+
+	assert(bytes % BPS(bs) == 0);
+
+	buf = malloc(bytes);
+	if (!buf) {
+		async_answer_0(call, ENOMEM);
+		return ENOMEM;
+	}
+
+	rc = async_data_write_finalize(call, buf, bytes);
+	if (rc != EOK)
+		goto out;
+
+	data = buf;
+	while (cnt > 0) {
+		if (nodep) {
+			rc = fat_block_run_get(bs, nodep, bn, cnt, &pbn, &n);
+		} else {
+			rc = _fat_block_run_get(bs, service_id, fcl, NULL, bn,
+			    cnt, &pbn, &n);
+		}
+		if (rc != EOK)
+			goto out;
+
+		rc = block_write_lblocks(service_id, pbn, n, data);
+		if (rc != EOK)
+			goto out;
+
+		data += (size_t) n * BPS(bs);
+		bn += n;
+		cnt -= n;
+	}
+
+out:
+	free(buf);
+	return rc;
+}
+
 static errno_t
 fat_write(service_id_t service_id, fs_index_t index, aoff64_t pos,
     size_t *wbytes, aoff64_t *nsize)
@@ -1346,18 +1518,25 @@ fat_write(service_id_t service_id, fs_index_t index, aoff64_t pos,
 
 	bs = block_bb_get(service_id);
 
+	boundary = ROUND_UP(nodep->size, BPC(bs));
+
 	/*
-	 * In all scenarios, we will attempt to write out only one block worth
-	 * of data at maximum. There might be some more efficient approaches,
-	 * but this one greatly simplifies fat_write(). Note that we can afford
-	 * to do this because the client must be ready to handle the return
-	 * value signalizing a smaller number of bytes written.
+	 * Unless the client writes several whole blocks, we will attempt to
+	 * write out only one block worth of data at maximum. Whole blocks are
+	 * written in one go, but only up to the end of the allocated clusters
+	 * when overwriting. Note that we can afford to do this because the
+	 * client must be ready to handle the return value signalizing a
+	 * smaller number of bytes written.
 	 */
 	bytes = min(len, BPS(bs) - pos % BPS(bs));
+	if (pos % BPS(bs) == 0 && len >= 2 * BPS(bs)) {
+		bytes = ALIGN_DOWN(min(len, FAT_IO_MAX), BPS(bs));
+		if (pos < boundary)
+			bytes = min(bytes, boundary - pos);
+	}
 	if (bytes == BPS(bs))
 		flags |= BLOCK_FLAGS_NOREAD;
 
-	boundary = ROUND_UP(nodep->size, BPC(bs));
 	if (pos < boundary) {
 		/*
 		 * This is the easier case - we are either overwriting already
@@ -1371,19 +1550,28 @@ fat_write(service_id_t service_id, fs_index_t index, aoff64_t pos,
 			async_answer_0(&call, rc);
 			return rc;
 		}
-		rc = fat_block_get(&b, bs, nodep, pos / BPS(bs), flags);
-		if (rc != EOK) {
-			(void) fat_node_put(fn);
-			async_answer_0(&call, rc);
-			return rc;
-		}
-		(void) async_data_write_finalize(&call,
-		    b->data + pos % BPS(bs), bytes);
-		b->dirty = true;		/* need to sync block */
-		rc = block_put(b);
-		if (rc != EOK) {
-			(void) fat_node_put(fn);
-			return rc;
+		if (bytes > BPS(bs)) {
+			rc = fat_blocks_write(&call, bs, service_id, nodep,
+			    FAT_CLST_RES0, pos / BPS(bs), bytes);
+			if (rc != EOK) {
+				(void) fat_node_put(fn);
+				return rc;
+			}
+		} else {
+			rc = fat_block_get(&b, bs, nodep, pos / BPS(bs), flags);
+			if (rc != EOK) {
+				(void) fat_node_put(fn);
+				async_answer_0(&call, rc);
+				return rc;
+			}
+			(void) async_data_write_finalize(&call,
+			    b->data + pos % BPS(bs), bytes);
+			b->dirty = true;	/* need to sync block */
+			rc = block_put(b);
+			if (rc != EOK) {
+				(void) fat_node_put(fn);
+				return rc;
+			}
 		}
 		if (pos + bytes > nodep->size) {
 			nodep->size = pos + bytes;
@@ -1418,22 +1606,32 @@ fat_write(service_id_t service_id, fs_index_t index, aoff64_t pos,
 			async_answer_0(&call, rc);
 			return rc;
 		}
-		rc = _fat_block_get(&b, bs, service_id, lcl, NULL,
-		    (pos / BPS(bs)) % SPC(bs), flags);
-		if (rc != EOK) {
-			(void) fat_free_clusters(bs, service_id, mcl);
-			(void) fat_node_put(fn);
-			async_answer_0(&call, rc);
-			return rc;
-		}
-		(void) async_data_write_finalize(&call,
-		    b->data + pos % BPS(bs), bytes);
-		b->dirty = true;		/* need to sync block */
-		rc = block_put(b);
-		if (rc != EOK) {
-			(void) fat_free_clusters(bs, service_id, mcl);
-			(void) fat_node_put(fn);
-			return rc;
+		if (bytes > BPS(bs)) {
+			rc = fat_blocks_write(&call, bs, service_id, NULL, mcl,
+			    (pos - boundary) / BPS(bs), bytes);
+			if (rc != EOK) {
+				(void) fat_free_clusters(bs, service_id, mcl);
+				(void) fat_node_put(fn);
+				return rc;
+			}
+		} else {
+			rc = _fat_block_get(&b, bs, service_id, lcl, NULL,
+			    (pos / BPS(bs)) % SPC(bs), flags);
+			if (rc != EOK) {
+				(void) fat_free_clusters(bs, service_id, mcl);
+				(void) fat_node_put(fn);
+				async_answer_0(&call, rc);
+				return rc;
+			}
+			(void) async_data_write_finalize(&call,
+			    b->data + pos % BPS(bs), bytes);
+			b->dirty = true;	/* need to sync block */
+			rc = block_put(b);
+			if (rc != EOK) {
+				(void) fat_free_clusters(bs, service_id, mcl);
+				(void) fat_node_put(fn);
+				return rc;
+			}
 		}
 		/*
 		 * Append the cluster chain starting in mcl to the end of the
@@ -1568,6 +1766,7 @@ vfs_out_ops_t fat_ops = {
 	.close = fat_close,
 	.destroy = fat_destroy,
 	.sync = fat_sync,
+	.readdir = fat_readdir,
 };
 
 /**
@@ -65,6 +65,7 @@ typedef struct tmpfs_node {
 	unsigned lnkcnt;	/**< Link count. */
 	size_t size;		/**< File size if type is TMPFS_FILE. */
 	void *data;		/**< File content's if type is TMPFS_FILE. */
+	uint64_t mtime;		/**< Modification stamp in microseconds. */
 	list_t cs_list;		/**< Child's siblings list. */
 } tmpfs_node_t;
 
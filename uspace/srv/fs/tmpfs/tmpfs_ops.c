@@ -46,6 +46,7 @@
 #include <str.h>
 #include <stdio.h>
 #include <assert.h>
+#include <time.h>
 #include <stddef.h>
 #include <adt/hash_table.h>
 #include <adt/hash.h>
@@ -58,6 +59,9 @@
 /** Global counter for assigning node indices. Shared by all instances. */
 fs_index_t tmpfs_next_index = 1;
 
+/** Last modification stamp handed out. Shared by all instances. */
+static uint64_t tmpfs_last_mtime = 0;
+
 /*
  * Implementation of the libfs interface.
  */
@@ -94,6 +98,11 @@ static aoff64_t tmpfs_size_get(fs_node_t *fn)
 	return TMPFS_NODE(fn)->size;
 }
 
+static uint64_t tmpfs_mtime_get(fs_node_t *fn)
+{
+	return TMPFS_NODE(fn)->mtime;
+}
+
 static unsigned tmpfs_lnkcnt_get(fs_node_t *fn)
 {
 	return TMPFS_NODE(fn)->lnkcnt;
@@ -128,6 +137,7 @@ libfs_ops_t tmpfs_libfs_ops = {
 	.has_children = tmpfs_has_children,
 	.index_get = tmpfs_index_get,
 	.size_get = tmpfs_size_get,
+	.mtime_get = tmpfs_mtime_get,
 	.lnkcnt_get = tmpfs_lnkcnt_get,
 	.is_directory = tmpfs_is_directory,
 	.is_file = tmpfs_is_file,
@@ -196,6 +206,24 @@ hash_table_ops_t nodes_ops = {
 	.remove_callback = nodes_remove_callback
 };
 
+/** Update the modification stamp of a node.
+ *
+ * The stamp is derived from the real time but kept strictly increasing so
+ * that two modifications never leave the same stamp behind.
+ */
+static void tmpfs_node_touch(tmpfs_node_t *nodep)
+{
+	struct timespec ts;
+
+	getrealtime(&ts);
+	uint64_t now = SEC2USEC(ts.tv_sec) + NSEC2USEC(ts.tv_nsec);
+	if (now <= tmpfs_last_mtime)
+		now = tmpfs_last_mtime + 1;
+
+	tmpfs_last_mtime = now;
+	nodep->mtime = now;
+}
+
 static void tmpfs_node_initialize(tmpfs_node_t *nodep)
 {
 	nodep->bp = NULL;
@@ -205,6 +233,7 @@ static void tmpfs_node_initialize(tmpfs_node_t *nodep)
 	nodep->lnkcnt = 0;
 	nodep->size = 0;
 	nodep->data = NULL;
+	nodep->mtime = 0;
 	list_initialize(&nodep->cs_list);
 }
 
@@ -330,6 +359,7 @@ errno_t tmpfs_create_node(fs_node_t **rfn, service_id_t service_id, int lflag)
 		nodep->type = TMPFS_DIRECTORY;
 	else
 		nodep->type = TMPFS_FILE;
+	tmpfs_node_touch(nodep);
 
 	/* Insert the new node into the nodes hash table. */
 	hash_table_insert(&nodes, &nodep->nh_link);
@@ -523,6 +553,49 @@ static errno_t tmpfs_read(service_id_t service_id, fs_index_t index, aoff64_t po
 	return EOK;
 }
 
+static errno_t tmpfs_readdir(service_id_t service_id, fs_index_t index,
+    aoff64_t pos, unsigned flags, void *buf, size_t size, size_t *used)
+{
+	node_key_t key = {
+		.service_id = service_id,
+		.index = index
+	};
+
+	ht_link_t *hlp = hash_table_find(&nodes, &key);
+	if (!hlp)
+		return ENOENT;
+
+	tmpfs_node_t *nodep = hash_table_get_inst(hlp, tmpfs_node_t, nh_link);
+	if (nodep->type != TMPFS_DIRECTORY)
+		return ENOTDIR;
+
+	/*
+	 * The position is the index of the child. Only the first entry of the
+	 * batch needs to be looked up, the rest follows in the list.
+	 */
+	*used = 0;
+	link_t *lnk = list_nth(&nodep->cs_list, pos);
+	while (lnk != NULL) {
+		tmpfs_dentry_t *dentryp = list_get_instance(lnk, tmpfs_dentry_t,
+		    link);
+		tmpfs_node_t *child = dentryp->node;
+
+		if (!libfs_dirent_add(buf, size, used, dentryp->name,
+		    child->type == TMPFS_DIRECTORY ? VFS_DIRENT_DIRECTORY :
+		    VFS_DIRENT_FILE, child->type == TMPFS_FILE ? child->size : 0,
+		    pos + 1)) {
+			if (*used == 0)
+				return ELIMIT;
+			break;
+		}
+
+		pos++;
+		lnk = list_next(lnk, &nodep->cs_list);
+	}
+
+	return EOK;
+}
+
 static errno_t
 tmpfs_write(service_id_t service_id, fs_index_t index, aoff64_t pos,
     size_t *wbytes, aoff64_t *nsize)
@@ -582,6 +655,9 @@ tmpfs_write(service_id_t service_id, fs_index_t index, aoff64_t pos,
 	(void) async_data_write_finalize(&call, nodep->data + pos, size);
 
 out:
+	if (size > 0)
+		tmpfs_node_touch(nodep);
+
 	*wbytes = size;
 	*nsize = nodep->size;
 	return EOK;
@@ -620,6 +696,7 @@ static errno_t tmpfs_truncate(service_id_t service_id, fs_index_t index,
 
 	nodep->size = size;
 	nodep->data = newdata;
+	tmpfs_node_touch(nodep);
 	return EOK;
 }
 
@@ -662,6 +739,7 @@ vfs_out_ops_t tmpfs_ops = {
 	.close = tmpfs_close,
 	.destroy = tmpfs_destroy,
 	.sync = tmpfs_sync,
+	.readdir = tmpfs_readdir,
 };
 
 /**
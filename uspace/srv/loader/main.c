@@ -62,10 +62,20 @@
 
 #ifdef CONFIG_RTLD
 #include <rtld/rtld.h>
+#include <rtld/snapshot.h>
 #endif
 
 #define DPRINTF(...) ((void) 0)
 
+#ifdef CONFIG_RTLD
+/**
+ * Directory with snapshots of relocated programs. Programs are only
+ * snapshotted if the directory exists.
+ */
+#define LDR_CACHE_DIR "/tmp/ldcache"
+#define LDR_CACHE_PATH_SIZE 64
+#endif
+
 /** File that will be loaded */
 static char *progname = NULL;
 static int program_fd = -1;
@@ -280,6 +290,74 @@ static void ldr_add_inbox(ipc_call_t *req)
 	async_answer_0(req, EOK);
 }
 
+#ifdef CONFIG_RTLD
+
+/** Look up a snapshot of the program in the cache.
+ *
+ * Snapshots are keyed by the identity of the program file. The files
+ * of the program and its libraries are checked when the snapshot is
+ * applied.
+ *
+ * @param snap Snapshot to fill in
+ * @param path Place to store the path of the snapshot
+ * @return @c true if the program should be loaded using the cache.
+ */
+static bool ldr_cache_lookup(rtld_snapshot_t *snap, char *path)
+{
+	vfs_stat_t stat;
+	int fd;
+
+	snap->fd = -1;
+	snap->applied = false;
+
+	if (vfs_stat_path(LDR_CACHE_DIR, &stat) != EOK || !stat.is_directory)
+		return false;
+
+	/* Without modification stamps the snapshot cannot be validated. */
+	if (rtld_snapshot_file_get(program_fd, &snap->prog) != EOK ||
+	    snap->prog.mtime == 0)
+		return false;
+
+	snprintf(path, LDR_CACHE_PATH_SIZE, "%s/%" PRIun "-%" PRIu32,
+	    LDR_CACHE_DIR, snap->prog.service_id, snap->prog.index);
+
+	if (vfs_lookup_open(path, WALK_REGULAR, MODE_READ, &fd) == EOK)
+		snap->fd = fd;
+
+	return true;
+}
+
+/** Store a snapshot of the loaded program in the cache.
+ *
+ * The snapshot is written under a temporary name first so that other
+ * loaders never see it incomplete.
+ *
+ * @param path Path of the snapshot
+ */
+static void ldr_cache_store(const char *path)
+{
+	char tmp[LDR_CACHE_PATH_SIZE + 24];
+	errno_t rc;
+	int fd;
+
+	snprintf(tmp, sizeof(tmp), "%s.%" PRIu64, path, task_get_id());
+
+	rc = vfs_lookup_open(tmp, WALK_REGULAR | WALK_MUST_CREATE, MODE_WRITE,
+	    &fd);
+	if (rc != EOK)
+		return;
+
+	rc = rtld_snapshot_save(prog_info.env, fd);
+	vfs_put(fd);
+
+	if (rc == EOK)
+		rc = vfs_rename_path(tmp, path);
+	if (rc != EOK)
+		(void) vfs_unlink_path(tmp);
+}
+
+#endif
+
 /** Load the previously selected program.
  *
  * @return 0 on success, !0 on error.
@@ -289,7 +367,23 @@ static int ldr_load(ipc_call_t *req)
 {
 	DPRINTF("LOADER_LOAD()\n");
 
-	errno_t rc = elf_load(program_fd, &prog_info);
+#ifdef CONFIG_RTLD
+	char cache_path[LDR_CACHE_PATH_SIZE];
+	rtld_snapshot_t snap;
+	bool cached = ldr_cache_lookup(&snap, cache_path);
+
+	errno_t rc = elf_load(program_fd, cached ? &snap : NULL, &prog_info);
+
+	if (cached && snap.fd >= 0)
+		vfs_put(snap.fd);
+
+	if (cached && rc == EOK && !snap.applied && prog_info.env != NULL)
+		ldr_cache_store(cache_path);
+	else if (cached && rc == EIO)
+		(void) vfs_unlink_path(cache_path);
+#else
+	errno_t rc = elf_load(program_fd, NULL, &prog_info);
+#endif
 	if (rc != EOK) {
 		DPRINTF("Failed to load executable for '%s'.\n", progname);
 		async_answer_0(req, EINVAL);
@@ -62,6 +62,14 @@ typedef struct ethip_nic {
 	/** MAC address */
 	addr48_t mac_addr;
 
+	/** NIC completes TCP and UDP checksums of transmitted frames */
+	bool csum_tx;
+
+	/** NIC receive frame pool mapped read-only or @c NULL */
+	void *rx_pool;
+	/** Size of the receive frame pool */
+	size_t rx_pool_size;
+
 	/**
 	 * List of IP addresses configured on this link
 	 * (of the type ethip_link_addr_t)
@@ -35,6 +35,7 @@
  */
 
 #include <adt/list.h>
+#include <as.h>
 #include <async.h>
 #include <stdbool.h>
 #include <errno.h>
@@ -138,6 +139,9 @@ static void ethip_nic_delete(ethip_nic_t *nic)
 	if (nic->svc_name != NULL)
 		free(nic->svc_name);
 
+	if (nic->rx_pool != NULL)
+		as_area_destroy(nic->rx_pool);
+
 	free(nic);
 }
 
@@ -146,6 +150,48 @@ static void ethip_link_addr_delete(ethip_link_addr_t *laddr)
 	free(laddr);
 }
 
+/** Enable checksum offloads supported by NIC.
+ *
+ * Frames failing receive checksum verification are dropped by the NIC.
+ * Transmit checksum offload is only used if the NIC completes both TCP
+ * and UDP checksums, the Internet service is told so via the IP link
+ * offload query. Failure is not fatal, the NIC just keeps its current
+ * setting.
+ *
+ * @param nic NIC
+ */
+static void ethip_nic_offload_setup(ethip_nic_t *nic)
+{
+	uint32_t supported;
+	uint32_t active;
+	uint32_t mask;
+	errno_t rc;
+
+	nic->csum_tx = false;
+
+	rc = nic_offload_probe(nic->sess, &supported, &active);
+	if (rc != EOK)
+		return;
+
+	mask = NIC_OFFLOAD_CSUM_RX;
+	if ((supported & NIC_OFFLOAD_CSUM_TX) == NIC_OFFLOAD_CSUM_TX)
+		mask |= NIC_OFFLOAD_CSUM_TX;
+
+	if ((active & mask) != (supported & mask)) {
+		rc = nic_offload_set(nic->sess, mask, supported & mask);
+		if (rc != EOK) {
+			log_msg(LOG_DEFAULT, LVL_NOTE, "Failed enabling "
+			    "checksum offload on '%s'.", nic->svc_name);
+		}
+
+		rc = nic_offload_probe(nic->sess, &supported, &active);
+		if (rc != EOK)
+			return;
+	}
+
+	nic->csum_tx = (active & NIC_OFFLOAD_CSUM_TX) == NIC_OFFLOAD_CSUM_TX;
+}
+
 static errno_t ethip_nic_open(service_id_t sid)
 {
 	bool in_list = false;
@@ -177,6 +223,21 @@ static errno_t ethip_nic_open(service_id_t sid)
 		goto error;
 	}
 
+	/*
+	 * Map the driver's receive pool so that frames can be processed
+	 * in place. Drivers without a pool keep sending copies.
+	 */
+	rc = nic_rx_pool_share(nic->sess, &nic->rx_pool, &nic->rx_pool_size);
+	if (rc != EOK) {
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "NIC '%s' has no receive pool",
+		    nic->svc_name);
+		nic->rx_pool = NULL;
+		nic->rx_pool_size = 0;
+	}
+
+	/* Before the IP link is registered, so that clients see the result */
+	ethip_nic_offload_setup(nic);
+
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "Opened NIC '%s'", nic->svc_name);
 	list_append(&nic->link, &ethip_nic_list);
 	in_list = true;
@@ -282,6 +343,31 @@ static void ethip_nic_received(ethip_nic_t *nic, ipc_call_t *call)
 	async_answer_0(call, rc);
 }
 
+/** Frame received into the shared receive pool.
+ *
+ * The frame stays owned by the driver until the call is answered,
+ * so it is processed directly in the pool without copying.
+ */
+static void ethip_nic_received_pool(ethip_nic_t *nic, ipc_call_t *call)
+{
+	size_t offs = ipc_get_arg1(call);
+	size_t size = ipc_get_arg2(call);
+	errno_t rc;
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "ethip_nic_received_pool() nic=%p "
+	    "offs=%zu size=%zu", nic, offs, size);
+
+	if (nic->rx_pool == NULL || offs > nic->rx_pool_size ||
+	    size > nic->rx_pool_size - offs) {
+		async_answer_0(call, EINVAL);
+		return;
+	}
+
+	rc = ethip_received(&nic->iplink, (uint8_t *)nic->rx_pool + offs,
+	    size);
+	async_answer_0(call, rc);
+}
+
 static void ethip_nic_device_state(ethip_nic_t *nic, ipc_call_t *call)
 {
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "ethip_nic_device_state()");
@@ -310,6 +396,9 @@ static void ethip_nic_cb_conn(ipc_call_t *icall, void *arg)
 		case NIC_EV_RECEIVED:
 			ethip_nic_received(nic, &call);
 			break;
+		case NIC_EV_RECEIVED_POOL:
+			ethip_nic_received_pool(nic, &call);
+			break;
 		case NIC_EV_DEVICE_STATE:
 			ethip_nic_device_state(nic, &call);
 			break;
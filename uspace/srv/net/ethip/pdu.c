@@ -73,7 +73,11 @@ errno_t eth_pdu_encode(eth_frame_t *frame, void **rdata, size_t *rsize)
 	return EOK;
 }
 
-/** Decode Ethernet PDU. */
+/** Decode Ethernet PDU.
+ *
+ * The decoded frame payload points into @a data, which must stay valid
+ * for as long as the frame is used.
+ */
 errno_t eth_pdu_decode(void *data, size_t size, eth_frame_t *frame)
 {
 	eth_header_t *hdr;
@@ -87,17 +91,13 @@ errno_t eth_pdu_decode(void *data, size_t size, eth_frame_t *frame)
 
 	hdr = (eth_header_t *)data;
 
-	frame->size = size - sizeof(eth_header_t);
-	frame->data = calloc(frame->size, 1);
-	if (frame->data == NULL)
-		return ENOMEM;
-
 	addr48(hdr->src, frame->src);
 	addr48(hdr->dest, frame->dest);
 	frame->etype_len = uint16_t_be2host(hdr->etype_len);
 
-	memcpy(frame->data, (uint8_t *)data + sizeof(eth_header_t),
-	    frame->size);
+	/* The payload is not copied, it refers to the PDU buffer */
+	frame->data = (uint8_t *)data + sizeof(eth_header_t);
+	frame->size = size - sizeof(eth_header_t);
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "Decoded Ethernet frame payload (%zu bytes)", frame->size);
 
@@ -34,9 +34,11 @@
  * @brief
  */
 
+#include <assert.h>
 #include <stdbool.h>
 #include <errno.h>
 #include <str_error.h>
+#include <fibril.h>
 #include <fibril_synch.h>
 #include <inet/iplink.h>
 #include <io/log.h>
@@ -54,6 +56,26 @@ static bool first_link6 = true;
 static FIBRIL_MUTEX_INITIALIZE(ip_ident_lock);
 static uint16_t ip_ident = 0;
 
+/** Maximum number of links with PDUs collected at the same time */
+#define INET_LINK_BATCH_LINKS 4
+
+/** IPv4 PDUs collected for transmission over one link */
+typedef struct {
+	/** Link to send the PDUs over */
+	inet_link_t *ilink;
+	/** Number of collected PDUs */
+	size_t count;
+	/** Collected PDUs */
+	iplink_sdu_t sdu[IPLINK_SEND_BATCH_MAX];
+} inet_link_batch_t;
+
+/** Nesting level of inet_link_batch_begin() in the current fibril */
+static fibril_local unsigned inet_link_batch_level;
+/** PDUs collected by the current fibril, one batch per link */
+static fibril_local inet_link_batch_t *inet_link_batch[INET_LINK_BATCH_LINKS];
+/** First error of sending PDUs collected by the current fibril */
+static fibril_local errno_t inet_link_batch_rc;
+
 static errno_t inet_iplink_recv(iplink_t *, iplink_recv_sdu_t *, ip_ver_t);
 static errno_t inet_iplink_change_addr(iplink_t *, addr48_t);
 static inet_link_t *inet_link_get_by_id_locked(sysarg_t);
@@ -115,7 +137,6 @@ static errno_t inet_iplink_recv(iplink_t *iplink, iplink_recv_sdu_t *sdu, ip_ver
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "call inet_recv_packet()");
 	rc = inet_recv_packet(&packet);
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "call inet_recv_packet -> %s", str_error_name(rc));
-	free(packet.data);
 
 	return rc;
 }
@@ -197,6 +218,12 @@ errno_t inet_link_open(service_id_t sid)
 		goto error;
 	}
 
+	/* Links which cannot tell do not offload anything */
+	uint32_t offload;
+	rc = iplink_get_offload(ilink->iplink, &offload);
+	ilink->csum_tx = (rc == EOK) &&
+	    ((offload & IPLINK_OFFLOAD_CSUM_TX) != 0);
+
 	/*
 	 * Get the MAC address of the link. If the link has a MAC
 	 * address, we assume that it supports NDP.
@@ -296,7 +323,111 @@ error:
 	return rc;
 }
 
+/** Send collected PDUs and release them.
+ *
+ * @param batch Batch of PDUs
+ * @return EOK on success or an error code
+ */
+static errno_t inet_link_batch_flush(inet_link_batch_t *batch)
+{
+	errno_t rc = EOK;
+	size_t i;
+
+	if (batch->count > 0)
+		rc = iplink_send_batch(batch->ilink->iplink, batch->sdu,
+		    batch->count);
+
+	for (i = 0; i < batch->count; i++)
+		free(batch->sdu[i].data);
+
+	batch->count = 0;
+	return rc;
+}
+
+/** Get batch collecting PDUs of the current fibril for link.
+ *
+ * If PDUs are already collected for the maximum number of links, the PDUs
+ * of one of them are sent to make room.
+ *
+ * @param ilink Internet link
+ * @return Batch or @c NULL if out of memory
+ */
+static inet_link_batch_t *inet_link_batch_get(inet_link_t *ilink)
+{
+	inet_link_batch_t **slot = NULL;
+	errno_t rc;
+	size_t i;
+
+	for (i = 0; i < INET_LINK_BATCH_LINKS; i++) {
+		if (inet_link_batch[i] == NULL) {
+			if (slot == NULL)
+				slot = &inet_link_batch[i];
+		} else if (inet_link_batch[i]->ilink == ilink) {
+			return inet_link_batch[i];
+		}
+	}
+
+	if (slot == NULL) {
+		slot = &inet_link_batch[0];
+		rc = inet_link_batch_flush(*slot);
+		if (rc != EOK && inet_link_batch_rc == EOK)
+			inet_link_batch_rc = rc;
+	} else {
+		*slot = malloc(sizeof(inet_link_batch_t));
+		if (*slot == NULL)
+			return NULL;
+
+		(*slot)->count = 0;
+	}
+
+	(*slot)->ilink = ilink;
+	return *slot;
+}
+
+/** Start collecting transmitted IPv4 PDUs.
+ *
+ * Until the matching call to inet_link_batch_end(), IPv4 PDUs sent by the
+ * current fibril are collected per link and then handed over to each link
+ * with a single iplink_send_batch() call. Calls can be nested.
+ */
+void inet_link_batch_begin(void)
+{
+	if (inet_link_batch_level++ == 0)
+		inet_link_batch_rc = EOK;
+}
+
+/** Send PDUs collected since inet_link_batch_begin().
+ *
+ * @return EOK on success or the first error encountered while sending
+ */
+errno_t inet_link_batch_end(void)
+{
+	errno_t rc;
+	size_t i;
+
+	assert(inet_link_batch_level > 0);
+	if (--inet_link_batch_level > 0)
+		return EOK;
+
+	for (i = 0; i < INET_LINK_BATCH_LINKS; i++) {
+		if (inet_link_batch[i] == NULL)
+			continue;
+
+		rc = inet_link_batch_flush(inet_link_batch[i]);
+		if (rc != EOK && inet_link_batch_rc == EOK)
+			inet_link_batch_rc = rc;
+
+		free(inet_link_batch[i]);
+		inet_link_batch[i] = NULL;
+	}
+
+	return inet_link_batch_rc;
+}
+
 /** Send IPv4 datagram over Internet link
+ *
+ * Between inet_link_batch_begin() and inet_link_batch_end() the PDUs are
+ * only collected, otherwise all fragments are sent in one go.
  *
  * @param ilink Internet link
  * @param lsrc  Source IPv4 address
@@ -304,7 +435,7 @@ error:
  * @param dgram IPv4 datagram body
  * @param proto Protocol
  * @param ttl   Time-to-live
- * @param df    Do-not-Fragment flag
+ * @param df    Do-not-Fragment and checksum flags (inet_df_t)
  *
  * @return EOK on success
  * @return ENOMEM when not enough memory to create the datagram
@@ -329,10 +460,17 @@ errno_t inet_link_send_dgram(inet_link_t *ilink, addr32_t lsrc, addr32_t ldest,
 	 * inet_pdu_encode().
 	 */
 
-	iplink_sdu_t sdu;
+	inet_link_batch_t local;
+	inet_link_batch_t *batch = NULL;
 
-	sdu.src = lsrc;
-	sdu.dest = ldest;
+	if (inet_link_batch_level > 0)
+		batch = inet_link_batch_get(ilink);
+
+	if (batch == NULL) {
+		local.ilink = ilink;
+		local.count = 0;
+		batch = &local;
+	}
 
 	inet_packet_t packet;
 
@@ -347,29 +485,51 @@ errno_t inet_link_send_dgram(inet_link_t *ilink, addr32_t lsrc, addr32_t ldest,
 	packet.ident = ++ip_ident;
 	fibril_mutex_unlock(&ip_ident_lock);
 
-	packet.df = df;
+	packet.df = (df & INET_DF) != 0;
 	packet.data = dgram->data;
 	packet.size = dgram->size;
 
-	errno_t rc;
+	inet_pdu_csum_prepare(&packet, (df & INET_CSUM_PARTIAL) != 0,
+	    ilink->csum_tx && inet_pdu_fits(&packet, ilink->def_mtu));
+
+	errno_t rc = EOK;
 	size_t offs = 0;
+	size_t first = batch->count;
+	size_t i;
 
 	do {
 		/* Encode one fragment */
 
 		size_t roffs;
+		iplink_sdu_t *sdu = &batch->sdu[batch->count];
+		sdu->src = lsrc;
+		sdu->dest = ldest;
 		rc = inet_pdu_encode(&packet, src_v4, dest_v4, offs, ilink->def_mtu,
-		    &sdu.data, &sdu.size, &roffs);
+		    &sdu->data, &sdu->size, &roffs);
 		if (rc != EOK)
-			return rc;
-
-		/* Send the PDU */
-		rc = iplink_send(ilink->iplink, &sdu);
+			break;
 
-		free(sdu.data);
+		++batch->count;
 		offs = roffs;
+
+		if (batch->count == IPLINK_SEND_BATCH_MAX) {
+			rc = inet_link_batch_flush(batch);
+			first = 0;
+			if (rc != EOK)
+				break;
+		}
 	} while (offs < packet.size);
 
+	if (rc != EOK) {
+		/* Drop fragments of this datagram which were not sent yet */
+		for (i = first; i < batch->count; i++)
+			free(batch->sdu[i].data);
+		batch->count = first;
+	}
+
+	if (batch == &local && local.count > 0)
+		rc = inet_link_batch_flush(&local);
+
 	return rc;
 }
 
@@ -380,7 +540,7 @@ errno_t inet_link_send_dgram(inet_link_t *ilink, addr32_t lsrc, addr32_t ldest,
  * @param dgram IPv6 datagram body
  * @param proto Next header
  * @param ttl   Hop limit
- * @param df    Do-not-Fragment flag (unused)
+ * @param df    Do-not-Fragment (unused) and checksum flags (inet_df_t)
  *
  * @return EOK on success
  * @return ENOMEM when not enough memory to create the datagram
@@ -420,10 +580,13 @@ errno_t inet_link_send_dgram6(inet_link_t *ilink, addr48_t ldest,
 	packet.ident = ++ip_ident;
 	fibril_mutex_unlock(&ip_ident_lock);
 
-	packet.df = df;
+	packet.df = (df & INET_DF) != 0;
 	packet.data = dgram->data;
 	packet.size = dgram->size;
 
+	inet_pdu_csum_prepare(&packet, (df & INET_CSUM_PARTIAL) != 0,
+	    ilink->csum_tx && inet_pdu_fits6(&packet, ilink->def_mtu));
+
 	errno_t rc;
 	size_t offs = 0;
 
@@ -42,6 +42,8 @@
 #include "inetsrv.h"
 
 extern errno_t inet_link_open(service_id_t);
+extern void inet_link_batch_begin(void);
+extern errno_t inet_link_batch_end(void);
 extern errno_t inet_link_send_dgram(inet_link_t *, addr32_t,
     addr32_t, inet_dgram_t *, uint8_t, uint8_t, int);
 extern errno_t inet_link_send_dgram6(inet_link_t *, addr48_t, inet_dgram_t *,
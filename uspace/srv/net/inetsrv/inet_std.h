@@ -134,6 +134,42 @@ typedef struct {
 /** Fragment offset is expressed in units of 8 bytes */
 #define FRAG_OFFS_UNIT 8
 
+#define IP_PROTO_TCP  6
+#define IP_PROTO_UDP  17
+
+/** Offset of checksum field in TCP header */
+#define TCP_CSUM_OFFS  16
+/** Offset of checksum field in UDP header */
+#define UDP_CSUM_OFFS  6
+
+/** TCP and UDP over IPv4 checksum pseudo-header */
+typedef struct {
+	/** Source address */
+	uint32_t src_addr;
+	/** Destination address */
+	uint32_t dest_addr;
+	/** Zero */
+	uint8_t zero;
+	/** Protocol */
+	uint8_t proto;
+	/** TCP or UDP length */
+	uint16_t length;
+} ip_phdr_t;
+
+/** TCP and UDP over IPv6 checksum pseudo-header */
+typedef struct {
+	/** Source address */
+	uint8_t src_addr[16];
+	/** Destination address */
+	uint8_t dest_addr[16];
+	/** TCP or UDP length */
+	uint32_t length;
+	/** Zeroes */
+	uint8_t zeroes[3];
+	/** Next header */
+	uint8_t next;
+} ip6_phdr_t;
+
 #endif
 
 /** @}
@@ -38,10 +38,12 @@
 #include <async.h>
 #include <errno.h>
 #include <str_error.h>
+#include <fibril.h>
 #include <fibril_synch.h>
 #include <io/log.h>
 #include <ipc/inet.h>
 #include <ipc/services.h>
+#include <inet/dgbatch.h>
 #include <loc.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -87,8 +89,12 @@ static errno_t inet_init(void)
 {
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "inet_init()");
 
+	errno_t rc = inet_reass_init();
+	if (rc != EOK)
+		return rc;
+
 	port_id_t port;
-	errno_t rc = async_create_port(INTERFACE_INET,
+	rc = async_create_port(INTERFACE_INET,
 	    inet_default_conn, NULL, &port);
 	if (rc != EOK)
 		return rc;
@@ -347,6 +353,49 @@ static void inet_send_srv(inet_client_t *client, ipc_call_t *icall)
 	async_answer_0(icall, rc);
 }
 
+static void inet_send_batch_srv(inet_client_t *client, ipc_call_t *icall)
+{
+	inet_dgram_t dgram;
+	void *buf;
+	size_t size;
+	size_t offs;
+	errno_t rc;
+	errno_t retval;
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "inet_send_batch_srv()");
+
+	uint8_t ttl = ipc_get_arg1(icall);
+	int df = ipc_get_arg2(icall);
+
+	rc = async_data_write_accept(&buf, false, 0, INET_DGBATCH_SIZE_MAX, 0,
+	    &size);
+	if (rc != EOK) {
+		async_answer_0(icall, rc);
+		return;
+	}
+
+	/* Send PDUs going over the same link together */
+	inet_link_batch_begin();
+
+	retval = EOK;
+	offs = 0;
+	while ((rc = inet_dgbatch_next(buf, size, &offs, &dgram)) == EOK) {
+		rc = inet_send(client, &dgram, client->protocol, ttl, df);
+		if (rc != EOK && retval == EOK)
+			retval = rc;
+	}
+
+	if (rc != ENOENT && retval == EOK)
+		retval = rc;
+
+	rc = inet_link_batch_end();
+	if (rc != EOK && retval == EOK)
+		retval = rc;
+
+	free(buf);
+	async_answer_0(icall, retval);
+}
+
 static void inet_set_proto_srv(inet_client_t *client, ipc_call_t *call)
 {
 	sysarg_t proto;
@@ -363,23 +412,132 @@ static void inet_set_proto_srv(inet_client_t *client, ipc_call_t *call)
 	async_answer_0(call, EOK);
 }
 
-static void inet_client_init(inet_client_t *client)
+/** Deliver a batch of datagrams to client.
+ *
+ * @param client Client
+ * @param batch Datagram batch
+ * @return EOK on success or an error code
+ */
+static errno_t inet_ev_recv_batch(inet_client_t *client,
+    inet_dgbatch_t *batch)
+{
+	async_exch_t *exch = async_exchange_begin(client->sess);
+
+	ipc_call_t answer;
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "inet_ev_recv_batch: count=%zu",
+	    batch->count);
+
+	aid_t req = async_send_0(exch, INET_EV_RECV_BATCH, &answer);
+
+	errno_t rc = async_data_write_start(exch, batch->buf, batch->size);
+
+	async_exchange_end(exch);
+
+	if (rc != EOK) {
+		async_forget(req);
+		return rc;
+	}
+
+	errno_t retval;
+	async_wait_for(req, &retval);
+
+	return retval;
+}
+
+/** Client datagram delivery fibril.
+ *
+ * Takes all datagrams queued for the client and delivers them in a single
+ * IPC exchange, so that a burst of received datagrams costs only one
+ * round trip to the client.
+ *
+ * @param arg Client
+ * @return EOK
+ */
+static errno_t inet_client_deliver_fibril(void *arg)
+{
+	inet_client_t *client = (inet_client_t *) arg;
+	inet_dgbatch_t batch;
+	inet_dgbatch_t tmp;
+	errno_t rc;
+
+	inet_dgbatch_init(&batch);
+
+	fibril_mutex_lock(&client->rq_lock);
+
+	while (true) {
+		while (client->rq.count == 0 && !client->rq_stop)
+			fibril_condvar_wait(&client->rq_cv, &client->rq_lock);
+
+		if (client->rq.count == 0)
+			break;
+
+		/* Take over queued datagrams, leave an empty batch behind */
+		tmp = client->rq;
+		client->rq = batch;
+		batch = tmp;
+		fibril_mutex_unlock(&client->rq_lock);
+
+		rc = inet_ev_recv_batch(client, &batch);
+		if (rc != EOK) {
+			log_msg(LOG_DEFAULT, LVL_DEBUG, "Failed delivering "
+			    "%zu datagrams to client: %s", batch.count,
+			    str_error(rc));
+		}
+
+		inet_dgbatch_clear(&batch);
+		fibril_mutex_lock(&client->rq_lock);
+	}
+
+	client->rq_done = true;
+	fibril_condvar_broadcast(&client->rq_cv);
+	fibril_mutex_unlock(&client->rq_lock);
+
+	inet_dgbatch_fini(&batch);
+	return EOK;
+}
+
+static errno_t inet_client_init(inet_client_t *client)
 {
 	client->sess = NULL;
+	fibril_mutex_initialize(&client->rq_lock);
+	fibril_condvar_initialize(&client->rq_cv);
+	inet_dgbatch_init(&client->rq);
+	client->rq_stop = false;
+	client->rq_done = false;
+
+	client->rq_fibril = fibril_create(inet_client_deliver_fibril, client);
+	if (client->rq_fibril == 0)
+		return ENOMEM;
+
+	fibril_add_ready(client->rq_fibril);
 
 	fibril_mutex_lock(&client_list_lock);
 	list_append(&client->client_list, &client_list);
 	fibril_mutex_unlock(&client_list_lock);
+
+	return EOK;
 }
 
 static void inet_client_fini(inet_client_t *client)
 {
-	async_hangup(client->sess);
-	client->sess = NULL;
-
 	fibril_mutex_lock(&client_list_lock);
 	list_remove(&client->client_list);
 	fibril_mutex_unlock(&client_list_lock);
+
+	/* Flush queued datagrams and wait for delivery fibril to finish */
+	fibril_mutex_lock(&client->rq_lock);
+	client->rq_stop = true;
+	fibril_condvar_broadcast(&client->rq_cv);
+	while (!client->rq_done)
+		fibril_condvar_wait(&client->rq_cv, &client->rq_lock);
+	fibril_mutex_unlock(&client->rq_lock);
+
+	inet_dgbatch_fini(&client->rq);
+
+	if (client->sess != NULL)
+		async_hangup(client->sess);
+	client->sess = NULL;
 }
 
 static void inet_default_conn(ipc_call_t *icall, void *arg)
@@ -388,11 +546,14 @@ static void inet_default_conn(ipc_call_t *icall, void *arg)
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "inet_default_conn()");
 
+	if (inet_client_init(&client) != EOK) {
+		async_answer_0(icall, ENOMEM);
+		return;
+	}
+
 	/* Accept the connection */
 	async_accept_0(icall);
 
-	inet_client_init(&client);
-
 	while (true) {
 		ipc_call_t call;
 		async_get_call(&call);
@@ -401,7 +562,7 @@ static void inet_default_conn(ipc_call_t *icall, void *arg)
 		if (!method) {
 			/* The other side has hung up */
 			async_answer_0(&call, EOK);
-			return;
+			break;
 		}
 
 		switch (method) {
@@ -414,6 +575,9 @@ static void inet_default_conn(ipc_call_t *icall, void *arg)
 		case INET_SEND:
 			inet_send_srv(&client, &call);
 			break;
+		case INET_SEND_BATCH:
+			inet_send_batch_srv(&client, &call);
+			break;
 		case INET_SET_PROTO:
 			inet_set_proto_srv(&client, &call);
 			break;
@@ -440,45 +604,47 @@ static inet_client_t *inet_client_find(uint8_t proto)
 	return NULL;
 }
 
+/** Queue datagram for delivery to client.
+ *
+ * The datagram is copied into the client's receive queue and delivered
+ * asynchronously by the client's delivery fibril. If the queue is full,
+ * the datagram is dropped so that a slow client cannot stall delivery
+ * to other clients.
+ *
+ * @param client Client
+ * @param dgram Datagram
+ * @return EOK on success or an error code
+ */
 errno_t inet_ev_recv(inet_client_t *client, inet_dgram_t *dgram)
 {
-	async_exch_t *exch = async_exchange_begin(client->sess);
-
-	ipc_call_t answer;
+	errno_t rc;
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "inet_ev_recv: iplink=%zu",
 	    dgram->iplink);
 
-	aid_t req = async_send_2(exch, INET_EV_RECV, dgram->tos,
-	    dgram->iplink, &answer);
+	if (client->sess == NULL)
+		return ENOENT;
 
-	errno_t rc = async_data_write_start(exch, &dgram->src, sizeof(inet_addr_t));
-	if (rc != EOK) {
-		async_exchange_end(exch);
-		async_forget(req);
-		return rc;
-	}
+	fibril_mutex_lock(&client->rq_lock);
 
-	rc = async_data_write_start(exch, &dgram->dest, sizeof(inet_addr_t));
-	if (rc != EOK) {
-		async_exchange_end(exch);
-		async_forget(req);
-		return rc;
+	if (client->rq_stop) {
+		fibril_mutex_unlock(&client->rq_lock);
+		return ENOENT;
 	}
 
-	rc = async_data_write_start(exch, dgram->data, dgram->size);
-
-	async_exchange_end(exch);
-
-	if (rc != EOK) {
-		async_forget(req);
-		return rc;
+	if (!inet_dgbatch_fits(&client->rq, dgram->size)) {
+		fibril_mutex_unlock(&client->rq_lock);
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "Client receive queue full. "
+		    "Datagram dropped.");
+		return ELIMIT;
 	}
 
-	errno_t retval;
-	async_wait_for(req, &retval);
+	rc = inet_dgbatch_add(&client->rq, dgram);
+	if (rc == EOK && client->rq.count == 1)
+		fibril_condvar_broadcast(&client->rq_cv);
 
-	return retval;
+	fibril_mutex_unlock(&client->rq_lock);
+	return rc;
 }
 
 errno_t inet_recv_dgram_local(inet_dgram_t *dgram, uint8_t proto)
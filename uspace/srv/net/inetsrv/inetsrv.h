@@ -38,8 +38,11 @@
 #define INETSRV_H_
 
 #include <adt/list.h>
+#include <fibril.h>
+#include <fibril_synch.h>
 #include <stdbool.h>
 #include <inet/addr.h>
+#include <inet/dgbatch.h>
 #include <inet/iplink.h>
 #include <ipc/loc.h>
 #include <stddef.h>
@@ -52,6 +55,18 @@ typedef struct {
 	async_sess_t *sess;
 	uint8_t protocol;
 	link_t client_list;
+	/** Protects receive queue */
+	fibril_mutex_t rq_lock;
+	/** Signalled when receive queue changes */
+	fibril_condvar_t rq_cv;
+	/** Datagrams waiting to be delivered to the client */
+	inet_dgbatch_t rq;
+	/** Delivery fibril should terminate */
+	bool rq_stop;
+	/** Delivery fibril has terminated */
+	bool rq_done;
+	/** Delivery fibril */
+	fid_t rq_fibril;
 } inet_client_t;
 
 /** Inetping Client */
@@ -108,6 +123,8 @@ typedef struct {
 	async_sess_t *sess;
 	iplink_t *iplink;
 	size_t def_mtu;
+	/** Link completes TCP and UDP checksums of unfragmented datagrams */
+	bool csum_tx;
 	addr48_t mac;
 	bool mac_valid;
 } inet_link_t;
@@ -47,40 +47,120 @@
 #include "inet_std.h"
 #include "pdu.h"
 
-/** One's complement addition.
+/** Determine whether IPv4 packet is sent without fragmentation.
  *
- * Result is a + b + carry.
+ * @param packet Packet
+ * @param mtu    MTU (Maximum Transmission Unit) in bytes
+ *
+ * @return @c true if inet_pdu_encode() encodes the packet in one PDU
+ */
+bool inet_pdu_fits(inet_packet_t *packet, size_t mtu)
+{
+	size_t hdr_size = sizeof(ip_header_t);
+	if (hdr_size >= mtu)
+		return false;
+
+	/* Same computation as in inet_pdu_encode() */
+	size_t spc_avail = mtu - hdr_size;
+	spc_avail -= (spc_avail % FRAG_OFFS_UNIT);
+
+	return packet->size <= spc_avail;
+}
+
+/** Determine whether IPv6 packet is sent without fragmentation.
+ *
+ * @param packet Packet
+ * @param mtu    MTU (Maximum Transmission Unit) in bytes
+ *
+ * @return @c true if inet_pdu_encode6() encodes the packet in one PDU
+ */
+bool inet_pdu_fits6(inet_packet_t *packet, size_t mtu)
+{
+	return packet->size + sizeof(ip6_header_t) <= mtu;
+}
+
+/** Compute checksum of TCP or UDP pseudo-header.
+ *
+ * @param packet Packet
+ *
+ * @return Checksum of the pseudo-header in the form returned by
+ *         inet_checksum_calc()
  */
-static uint16_t inet_ocadd16(uint16_t a, uint16_t b)
+static uint16_t inet_pdu_phdr_csum(inet_packet_t *packet)
 {
-	uint32_t s;
+	addr32_t src_v4;
+	addr128_t src_v6;
+	addr32_t dest_v4;
+	addr128_t dest_v6;
+	ip_phdr_t phdr;
+	ip6_phdr_t phdr6;
+
+	ip_ver_t ver = inet_addr_get(&packet->src, &src_v4, &src_v6);
+	(void) inet_addr_get(&packet->dest, &dest_v4, &dest_v6);
+
+	if (ver == ip_v4) {
+		phdr.src_addr = host2uint32_t_be(src_v4);
+		phdr.dest_addr = host2uint32_t_be(dest_v4);
+		phdr.zero = 0;
+		phdr.proto = packet->proto;
+		phdr.length = host2uint16_t_be(packet->size);
+		return inet_checksum_calc(INET_CHECKSUM_INIT, &phdr,
+		    sizeof(ip_phdr_t));
+	}
 
-	s = (uint32_t)a + (uint32_t)b;
-	return (s & 0xffff) + (s >> 16);
+	host2addr128_t_be(src_v6, phdr6.src_addr);
+	host2addr128_t_be(dest_v6, phdr6.dest_addr);
+	phdr6.length = host2uint32_t_be(packet->size);
+	memset(phdr6.zeroes, 0, 3);
+	phdr6.next = packet->proto;
+	return inet_checksum_calc(INET_CHECKSUM_INIT, &phdr6,
+	    sizeof(ip6_phdr_t));
 }
 
-uint16_t inet_checksum_calc(uint16_t ivalue, void *data, size_t size)
+/** Prepare TCP or UDP checksum of packet for transmission.
+ *
+ * A client sending with INET_CSUM_PARTIAL leaves only the checksum of the
+ * pseudo-header in the checksum field. It is completed here unless the
+ * link does so. Conversely, a link completing checksums expects the
+ * partial checksum in the field even if the client computed the full one.
+ * Other protocols are left alone.
+ *
+ * @param packet  Packet, the payload is modified in place
+ * @param partial Checksum field contains the partial checksum
+ * @param offload Link completes the checksum
+ */
+void inet_pdu_csum_prepare(inet_packet_t *packet, bool partial, bool offload)
 {
-	uint16_t sum;
-	uint16_t w;
-	size_t words, i;
-	uint8_t *bdata;
-
-	sum = ~ivalue;
-	words = size / 2;
-	bdata = (uint8_t *)data;
-
-	for (i = 0; i < words; i++) {
-		w = ((uint16_t)bdata[2 * i] << 8) | bdata[2 * i + 1];
-		sum = inet_ocadd16(sum, w);
+	size_t offs;
+	uint16_t csum;
+
+	switch (packet->proto) {
+	case IP_PROTO_TCP:
+		offs = TCP_CSUM_OFFS;
+		break;
+	case IP_PROTO_UDP:
+		offs = UDP_CSUM_OFFS;
+		break;
+	default:
+		return;
 	}
 
-	if (size % 2 != 0) {
-		w = ((uint16_t)bdata[2 * words] << 8);
-		sum = inet_ocadd16(sum, w);
+	if (partial == offload || packet->size < offs + sizeof(uint16_t))
+		return;
+
+	if (offload) {
+		csum = ~inet_pdu_phdr_csum(packet);
+	} else {
+		csum = inet_checksum_calc(INET_CHECKSUM_INIT, packet->data,
+		    packet->size);
+
+		/* Zero checksum means no checksum in UDP */
+		if (csum == 0 && packet->proto == IP_PROTO_UDP)
+			csum = 0xffff;
 	}
 
-	return ~sum;
+	csum = host2uint16_t_be(csum);
+	memcpy((uint8_t *) packet->data + offs, &csum, sizeof(uint16_t));
 }
 
 /** Encode IPv4 PDU.
@@ -300,11 +380,11 @@ errno_t inet_pdu_encode6(inet_packet_t *packet, addr128_t src, addr128_t dest,
  * @param data    Serialized IPv4 datagram
  * @param size    Length of serialized IPv4 datagram
  * @param link_id Link on which PDU was received
- * @param packet  IP datagram structure to be filled
+ * @param packet  IP datagram structure to be filled. The payload is not
+ *                copied, it points into @a data.
  *
  * @return EOK on success
  * @return EINVAL if the datagram is invalid or damaged
- * @return ENOMEM if not enough memory
  *
  */
 errno_t inet_pdu_decode(void *data, size_t size, service_id_t link_id,
@@ -360,13 +440,7 @@ errno_t inet_pdu_decode(void *data, size_t size, service_id_t link_id,
 	    BIT_RANGE_EXTRACT(uint8_t, VI_IHL_h, VI_IHL_l, hdr->ver_ihl);
 
 	packet->size = tot_len - data_offs;
-	packet->data = calloc(packet->size, 1);
-	if (packet->data == NULL) {
-		log_msg(LOG_DEFAULT, LVL_WARN, "Out of memory.");
-		return ENOMEM;
-	}
-
-	memcpy(packet->data, (uint8_t *) data + data_offs, packet->size);
+	packet->data = (uint8_t *) data + data_offs;
 	packet->link_id = link_id;
 
 	return EOK;
@@ -377,11 +451,11 @@ errno_t inet_pdu_decode(void *data, size_t size, service_id_t link_id,
  * @param data    Serialized IPv6 datagram
  * @param size    Length of serialized IPv6 datagram
  * @param link_id Link on which PDU was received
- * @param packet  IP datagram structure to be filled
+ * @param packet  IP datagram structure to be filled. The payload is not
+ *                copied, it points into @a data.
  *
  * @return EOK on success
  * @return EINVAL if the datagram is invalid or damaged
- * @return ENOMEM if not enough memory
  *
  */
 errno_t inet_pdu_decode6(void *data, size_t size, service_id_t link_id,
@@ -454,13 +528,7 @@ errno_t inet_pdu_decode6(void *data, size_t size, service_id_t link_id,
 	packet->offs = foff * FRAG_OFFS_UNIT;
 
 	packet->size = payload_len;
-	packet->data = calloc(packet->size, 1);
-	if (packet->data == NULL) {
-		log_msg(LOG_DEFAULT, LVL_WARN, "Out of memory.");
-		return ENOMEM;
-	}
-
-	memcpy(packet->data, (uint8_t *) data + data_offs, packet->size);
+	packet->data = (uint8_t *) data + data_offs;
 	packet->link_id = link_id;
 	return EOK;
 }
@@ -37,20 +37,20 @@
 #ifndef INET_PDU_H_
 #define INET_PDU_H_
 
+#include <inet/checksum.h>
 #include <loc.h>
 #include <stddef.h>
 #include <stdint.h>
 #include "inetsrv.h"
 #include "ndp.h"
 
-#define INET_CHECKSUM_INIT 0xffff
-
-extern uint16_t inet_checksum_calc(uint16_t, void *, size_t);
-
 extern errno_t inet_pdu_encode(inet_packet_t *, addr32_t, addr32_t, size_t, size_t,
     void **, size_t *, size_t *);
 extern errno_t inet_pdu_encode6(inet_packet_t *, addr128_t, addr128_t, size_t,
     size_t, void **, size_t *, size_t *);
+extern bool inet_pdu_fits(inet_packet_t *, size_t);
+extern bool inet_pdu_fits6(inet_packet_t *, size_t);
+extern void inet_pdu_csum_prepare(inet_packet_t *, bool, bool);
 extern errno_t inet_pdu_decode(void *, size_t, service_id_t, inet_packet_t *);
 extern errno_t inet_pdu_decode6(void *, size_t, service_id_t, inet_packet_t *);
 
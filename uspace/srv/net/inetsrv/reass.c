@@ -34,24 +34,50 @@
  * @brief Datagram reassembly.
  */
 
+#include <adt/hash.h>
+#include <adt/hash_table.h>
 #include <errno.h>
 #include <fibril_synch.h>
 #include <io/log.h>
 #include <macros.h>
 #include <mem.h>
 #include <stdlib.h>
+#include <time.h>
 
 #include "inetsrv.h"
 #include "inet_std.h"
 #include "reass.h"
 
-/** Datagram being reassembled.
+/** Maximum number of datagrams being reassembled at the same time */
+#define REASS_DGRAM_MAX 64
+/** Maximum amount of fragment data held for reassembly */
+#define REASS_BYTES_MAX (256 * 1024)
+/** Time after which an incomplete datagram is discarded (RFC 791) */
+#define REASS_TIMEOUT_SEC 15
+
+/** Datagram identification.
  *
- * Uniquely identified by (source address, destination address, protocol,
- * identification) per RFC 791 sec. 2.3 / Fragmentation.
+ * Uniquely identifies datagram per RFC 791 sec. 2.3 / Fragmentation.
  */
 typedef struct {
-	link_t map_link;
+	inet_addr_t src;
+	inet_addr_t dest;
+	uint8_t proto;
+	uint16_t ident;
+} reass_key_t;
+
+/** Datagram being reassembled. */
+typedef struct {
+	/** Link to reass_dgram_map */
+	ht_link_t map_link;
+	/** Link to reass_dgram_age, oldest datagram first */
+	link_t age_link;
+	/** Datagram identification */
+	reass_key_t key;
+	/** Time when the datagram is discarded if still incomplete */
+	struct timespec expires;
+	/** Amount of fragment data held */
+	size_t bytes;
 	/** List of fragments, @c reass_frag_t */
 	list_t frags;
 } reass_dgram_t;
@@ -62,12 +88,29 @@ typedef struct {
 	inet_packet_t packet;
 } reass_frag_t;
 
-/** Datagram map, list of reass_dgram_t */
-static LIST_INITIALIZE(reass_dgram_map);
+static size_t reass_dgram_map_hash(const ht_link_t *);
+static size_t reass_dgram_map_key_hash(const void *);
+static bool reass_dgram_map_key_equal(const void *, const ht_link_t *);
+static bool reass_dgram_map_equal(const ht_link_t *, const ht_link_t *);
+
+static hash_table_ops_t reass_dgram_map_ops = {
+	.hash = reass_dgram_map_hash,
+	.key_hash = reass_dgram_map_key_hash,
+	.key_equal = reass_dgram_map_key_equal,
+	.equal = reass_dgram_map_equal,
+	.remove_callback = NULL
+};
+
+/** Datagram map, of reass_dgram_t, keyed by reass_key_t */
+static hash_table_t reass_dgram_map;
+/** Datagrams in order of arrival of their first fragment */
+static LIST_INITIALIZE(reass_dgram_age);
+/** Amount of fragment data held by all datagrams */
+static size_t reass_bytes;
 /** Protects access to @c reass_dgram_map */
 static FIBRIL_MUTEX_INITIALIZE(reass_dgram_map_lock);
 
-static reass_dgram_t *reass_dgram_new(void);
+static reass_dgram_t *reass_dgram_new(reass_key_t *);
 static reass_dgram_t *reass_dgram_get(inet_packet_t *);
 static errno_t reass_dgram_insert_frag(reass_dgram_t *, inet_packet_t *);
 static bool reass_dgram_complete(reass_dgram_t *);
@@ -75,6 +118,114 @@ static void reass_dgram_remove(reass_dgram_t *);
 static errno_t reass_dgram_deliver(reass_dgram_t *);
 static void reass_dgram_destroy(reass_dgram_t *);
 
+/** Compute hash of an IP address. */
+static size_t reass_addr_hash(size_t hash, const inet_addr_t *addr)
+{
+	uint32_t w;
+
+	hash = hash_combine(hash, addr->version);
+	switch (addr->version) {
+	case ip_v4:
+		hash = hash_combine(hash, addr->addr);
+		break;
+	case ip_v6:
+		for (size_t i = 0; i < sizeof(addr128_t); i += sizeof(w)) {
+			memcpy(&w, addr->addr6 + i, sizeof(w));
+			hash = hash_combine(hash, w);
+		}
+		break;
+	default:
+		break;
+	}
+
+	return hash;
+}
+
+static size_t reass_dgram_map_key_hash(const void *arg)
+{
+	const reass_key_t *key = arg;
+	size_t hash;
+
+	hash = hash_combine(key->ident, key->proto);
+	hash = reass_addr_hash(hash, &key->src);
+	return reass_addr_hash(hash, &key->dest);
+}
+
+static size_t reass_dgram_map_hash(const ht_link_t *item)
+{
+	reass_dgram_t *rdg = hash_table_get_inst(item, reass_dgram_t,
+	    map_link);
+	return reass_dgram_map_key_hash(&rdg->key);
+}
+
+static bool reass_dgram_map_key_equal(const void *arg, const ht_link_t *item)
+{
+	const reass_key_t *key = arg;
+	reass_dgram_t *rdg = hash_table_get_inst(item, reass_dgram_t,
+	    map_link);
+
+	return inet_addr_compare(&rdg->key.src, &key->src) &&
+	    inet_addr_compare(&rdg->key.dest, &key->dest) &&
+	    rdg->key.proto == key->proto &&
+	    rdg->key.ident == key->ident;
+}
+
+static bool reass_dgram_map_equal(const ht_link_t *item1,
+    const ht_link_t *item2)
+{
+	reass_dgram_t *rdg = hash_table_get_inst(item1, reass_dgram_t,
+	    map_link);
+	return reass_dgram_map_key_equal(&rdg->key, item2);
+}
+
+/** Initialize datagram reassembly.
+ *
+ * @return EOK on success or ENOMEM.
+ */
+errno_t inet_reass_init(void)
+{
+	if (!hash_table_create(&reass_dgram_map, 0, 0, &reass_dgram_map_ops))
+		return ENOMEM;
+
+	return EOK;
+}
+
+/** Discard datagrams to make room for more fragment data.
+ *
+ * Datagrams that have expired are always discarded. If @a size more bytes
+ * would exceed the limits, the oldest datagrams are discarded until
+ * the new data fits.
+ *
+ * @param size Size of new fragment data
+ * @param new_dgram @c true if a new datagram is about to be created
+ */
+static void reass_dgram_purge(size_t size, bool new_dgram)
+{
+	struct timespec now;
+
+	assert(fibril_mutex_is_locked(&reass_dgram_map_lock));
+
+	getuptime(&now);
+
+	while (!list_empty(&reass_dgram_age)) {
+		reass_dgram_t *rdg = list_get_instance(
+		    list_first(&reass_dgram_age), reass_dgram_t, age_link);
+
+		bool expired = ts_gteq(&now, &rdg->expires);
+		bool full = reass_bytes + size > REASS_BYTES_MAX ||
+		    (new_dgram &&
+		    hash_table_size(&reass_dgram_map) >= REASS_DGRAM_MAX);
+
+		if (!expired && !full)
+			break;
+
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "Discarding incomplete "
+		    "datagram (%s).", expired ? "expired" : "out of space");
+		reass_dgram_remove(rdg);
+		reass_dgram_destroy(rdg);
+	}
+}
+
 /** Queue packet for datagram reassembly.
  *
  * @param packet	Packet
@@ -87,6 +238,12 @@ errno_t inet_reass_queue_packet(inet_packet_t *packet)
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "inet_reass_queue_packet()");
 
+	if (packet->size > REASS_BYTES_MAX) {
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "Fragment too large, packet "
+		    "dropped.");
+		return ELIMIT;
+	}
+
 	fibril_mutex_lock(&reass_dgram_map_lock);
 
 	/* Get existing or new datagram */
@@ -100,8 +257,15 @@ errno_t inet_reass_queue_packet(inet_packet_t *packet)
 
 	/* Insert fragment into the datagram */
 	rc = reass_dgram_insert_frag(rdg, packet);
-	if (rc != EOK)
+	if (rc != EOK) {
+		if (list_empty(&rdg->frags)) {
+			reass_dgram_remove(rdg);
+			reass_dgram_destroy(rdg);
+		}
+
+		fibril_mutex_unlock(&reass_dgram_map_lock);
 		return ENOMEM;
+	}
 
 	/* Check if datagram is complete */
 	if (reass_dgram_complete(rdg)) {
@@ -120,39 +284,44 @@ errno_t inet_reass_queue_packet(inet_packet_t *packet)
 }
 
 /** Get datagram reassembly structure for packet.
+ *
+ * Makes room for the packet data, discarding old datagrams if needed.
  *
  * @param packet	Packet
  * @return		Datagram reassembly structure matching @a packet
  */
 static reass_dgram_t *reass_dgram_get(inet_packet_t *packet)
 {
+	reass_key_t key;
+	ht_link_t *link;
+
 	assert(fibril_mutex_is_locked(&reass_dgram_map_lock));
 
-	list_foreach(reass_dgram_map, map_link, reass_dgram_t, rdg) {
-		link_t *f1_link = list_first(&rdg->frags);
-		assert(f1_link != NULL);
+	key.src = packet->src;
+	key.dest = packet->dest;
+	key.proto = packet->proto;
+	key.ident = packet->ident;
 
-		reass_frag_t *f1 = list_get_instance(f1_link, reass_frag_t,
-		    dgram_link);
+	link = hash_table_find(&reass_dgram_map, &key);
+	reass_dgram_purge(packet->size, link == NULL);
 
-		if ((inet_addr_compare(&f1->packet.src, &packet->src)) &&
-		    (inet_addr_compare(&f1->packet.dest, &packet->dest)) &&
-		    (f1->packet.proto == packet->proto) &&
-		    (f1->packet.ident == packet->ident)) {
-			/* Match */
-			return rdg;
-		}
-	}
+	/* Purging could have discarded the datagram */
+	if (link != NULL)
+		link = hash_table_find(&reass_dgram_map, &key);
+
+	if (link != NULL)
+		return hash_table_get_inst(link, reass_dgram_t, map_link);
 
 	/* No existing reassembly structure. Create a new one. */
-	return reass_dgram_new();
+	return reass_dgram_new(&key);
 }
 
 /** Create new datagram reassembly structure.
  *
- * @return New datagram reassembly structure.
+ * @param key	Datagram identification
+ * @return	New datagram reassembly structure.
  */
-static reass_dgram_t *reass_dgram_new(void)
+static reass_dgram_t *reass_dgram_new(reass_key_t *key)
 {
 	reass_dgram_t *rdg;
 
@@ -160,9 +329,14 @@ static reass_dgram_t *reass_dgram_new(void)
 	if (rdg == NULL)
 		return NULL;
 
-	list_append(&rdg->map_link, &reass_dgram_map);
+	rdg->key = *key;
+	getuptime(&rdg->expires);
+	rdg->expires.tv_sec += REASS_TIMEOUT_SEC;
 	list_initialize(&rdg->frags);
 
+	hash_table_insert(&reass_dgram_map, &rdg->map_link);
+	list_append(&rdg->age_link, &reass_dgram_age);
+
 	return rdg;
 }
 
@@ -188,6 +362,8 @@ static errno_t reass_dgram_insert_frag(reass_dgram_t *rdg, inet_packet_t *packet
 	assert(fibril_mutex_is_locked(&reass_dgram_map_lock));
 
 	frag = reass_frag_new();
+	if (frag == NULL)
+		return ENOMEM;
 
 	/* Clone the packet */
 
@@ -202,6 +378,9 @@ static errno_t reass_dgram_insert_frag(reass_dgram_t *rdg, inet_packet_t *packet
 	frag->packet = *packet;
 	frag->packet.data = data_copy;
 
+	rdg->bytes += packet->size;
+	reass_bytes += packet->size;
+
 	/*
 	 * XXX Make resource-consuming attacks harder, eliminate any duplicate
 	 * data immediately. Possibly eliminate redundant packet headers.
@@ -282,7 +461,9 @@ static bool reass_dgram_complete(reass_dgram_t *rdg)
 static void reass_dgram_remove(reass_dgram_t *rdg)
 {
 	assert(fibril_mutex_is_locked(&reass_dgram_map_lock));
-	list_remove(&rdg->map_link);
+	hash_table_remove_item(&reass_dgram_map, &rdg->map_link);
+	list_remove(&rdg->age_link);
+	reass_bytes -= rdg->bytes;
 }
 
 /** Deliver complete datagram.
@@ -34,9 +34,11 @@
  * @brief
  */
 
+#include <assert.h>
 #include <bitops.h>
 #include <errno.h>
 #include <fibril_synch.h>
+#include <inet/lpm.h>
 #include <io/log.h>
 #include <ipc/loc.h>
 #include <stdlib.h>
@@ -47,6 +49,11 @@
 
 static FIBRIL_MUTEX_INITIALIZE(sroute_list_lock);
 static LIST_INITIALIZE(sroute_list);
+/**
+ * Longest prefix match table over sroute_list. Holds the first route
+ * of the list for each destination prefix. A zeroed table is empty.
+ */
+static inet_lpm_t sroute_lpm;
 static sysarg_t sroute_id = 0;
 
 inet_sroute_t *inet_sroute_new(void)
@@ -74,10 +81,32 @@ void inet_sroute_delete(inet_sroute_t *sroute)
 	free(sroute);
 }
 
+/** Make sure each destination prefix in the route list has a route
+ * in the lookup table.
+ */
+static void inet_sroute_lpm_fill(void)
+{
+	errno_t rc;
+
+	assert(fibril_mutex_is_locked(&sroute_list_lock));
+
+	list_foreach(sroute_list, sroute_list, inet_sroute_t, sroute) {
+		if (inet_lpm_find(&sroute_lpm, &sroute->dest) != NULL)
+			continue;
+
+		rc = inet_lpm_insert(&sroute_lpm, &sroute->dest, sroute);
+		if (rc != EOK) {
+			log_msg(LOG_DEFAULT, LVL_ERROR, "Failed inserting "
+			    "static route into lookup table.");
+		}
+	}
+}
+
 void inet_sroute_add(inet_sroute_t *sroute)
 {
 	fibril_mutex_lock(&sroute_list_lock);
 	list_append(&sroute->sroute_list, &sroute_list);
+	inet_sroute_lpm_fill();
 	fibril_mutex_unlock(&sroute_list_lock);
 }
 
@@ -85,6 +114,11 @@ void inet_sroute_remove(inet_sroute_t *sroute)
 {
 	fibril_mutex_lock(&sroute_list_lock);
 	list_remove(&sroute->sroute_list);
+	if (inet_lpm_find(&sroute_lpm, &sroute->dest) == sroute) {
+		(void) inet_lpm_remove(&sroute_lpm, &sroute->dest);
+		/* Another route to the same destination may take over */
+		inet_sroute_lpm_fill();
+	}
 	fibril_mutex_unlock(&sroute_list_lock);
 }
 
@@ -94,34 +128,12 @@ void inet_sroute_remove(inet_sroute_t *sroute)
  */
 inet_sroute_t *inet_sroute_find(inet_addr_t *addr)
 {
-	ip_ver_t addr_ver = inet_addr_get(addr, NULL, NULL);
-
-	inet_sroute_t *best = NULL;
-	uint8_t best_bits = 0;
+	inet_sroute_t *best;
 
 	fibril_mutex_lock(&sroute_list_lock);
 
-	list_foreach(sroute_list, sroute_list, inet_sroute_t, sroute) {
-		uint8_t dest_bits;
-		ip_ver_t dest_ver = inet_naddr_get(&sroute->dest, NULL, NULL,
-		    &dest_bits);
-
-		/* Skip comparison with different address family */
-		if (addr_ver != dest_ver)
-			continue;
-
-		/* Look for the most specific route */
-		if ((best != NULL) && (best_bits >= dest_bits))
-			continue;
-
-		if (inet_naddr_compare_mask(&sroute->dest, addr)) {
-			log_msg(LOG_DEFAULT, LVL_DEBUG, "inet_sroute_find: found candidate %p",
-			    sroute);
-
-			best = sroute;
-			best_bits = dest_bits;
-		}
-	}
+	/* Look for the most specific route */
+	best = inet_lpm_lookup(&sroute_lpm, addr);
 
 	if (best == NULL)
 		log_msg(LOG_DEFAULT, LVL_DEBUG, "inet_sroute_find: Not found");
@@ -42,6 +42,7 @@
 #include <nettl/amap.h>
 #include <stdbool.h>
 #include <stdlib.h>
+#include <time.h>
 #include "conn.h"
 #include "inet.h"
 #include "iqueue.h"
@@ -49,12 +50,31 @@
 #include "rqueue.h"
 #include "segment.h"
 #include "seq_no.h"
+#include "std.h"
 #include "tcp_type.h"
 #include "tqueue.h"
 #include "ucall.h"
 
-#define RCV_BUF_SIZE 4096/*2*/
-#define SND_BUF_SIZE 4096
+/** Initial receive buffer size */
+#define RCV_BUF_SIZE (32 * 1024)
+/** Maximum size the receive buffer can be auto-tuned to */
+#define RCV_BUF_MAX (4 * 1024 * 1024)
+#define SND_BUF_SIZE (128 * 1024)
+
+/** Maximum amount of data sent in one segment unless peer sends smaller MSS.
+ *
+ * Larger segments are fragmented by the IP layer.
+ */
+#define SND_MSS_DEFAULT 4096
+
+/** Maximum segment size advertised to the peer.
+ *
+ * Segments of this size fit into a single Ethernet frame.
+ */
+#define RCV_MSS_DEFAULT 1460
+
+/** Receive buffer tuning period if RTT has not been measured (ms) */
+#define RCV_TUNE_PERIOD_DEFAULT 100
 
 #define MAX_SEGMENT_LIFETIME	(15*1000*1000) //(2*60*1000*1000)
 #define TIME_WAIT_TIMEOUT	(2*MAX_SEGMENT_LIFETIME)
@@ -77,6 +97,7 @@ static void tcp_conn_tw_timer_clear(tcp_conn_t *);
 static void tcp_transmit_segment(inet_ep2_t *, tcp_segment_t *);
 static void tcp_conn_trim_seg_to_wnd(tcp_conn_t *, tcp_segment_t *);
 static void tcp_reply_rst(inet_ep2_t *, tcp_segment_t *);
+static void tcp_conn_opts_negotiate(tcp_conn_t *, tcp_segment_t *);
 
 static tcp_tqueue_cb_t tcp_conn_tqueue_cb = {
 	.transmit_seg = tcp_transmit_segment
@@ -105,6 +126,36 @@ void tcp_conns_fini(void)
 	amap = NULL;
 }
 
+/** Get current value of the timestamp clock.
+ *
+ * The timestamp clock ticks once per millisecond and wraps around.
+ *
+ * @return	Current timestamp clock value
+ */
+uint32_t tcp_ts_now(void)
+{
+	struct timespec ts;
+
+	getuptime(&ts);
+	return (uint32_t)(SEC2MSEC(ts.tv_sec) + NSEC2MSEC(ts.tv_nsec));
+}
+
+/** Determine receive window scale shift count.
+ *
+ * @return	Smallest shift count that allows advertising a window
+ *		of RCV_BUF_MAX bytes
+ */
+static uint8_t tcp_conn_rcv_wscale(void)
+{
+	uint8_t shift;
+
+	shift = 0;
+	while (shift < TCP_WSCALE_MAX && (RCV_BUF_MAX >> shift) > TCP_WND_MAX)
+		++shift;
+
+	return shift;
+}
+
 /** Create new connection structure.
  *
  * @param epp		Endpoint pair (will be deeply copied)
@@ -140,6 +191,9 @@ tcp_conn_t *tcp_conn_new(inet_ep2_t *epp)
 	if (conn->rcv_buf == NULL)
 		goto error;
 
+	conn->rcv_tune_copied = 0;
+	conn->rcv_tune_time = tcp_ts_now();
+
 	/** Allocate send buffer */
 	fibril_condvar_initialize(&conn->snd_buf_cv);
 	conn->snd_buf_size = SND_BUF_SIZE;
@@ -152,6 +206,17 @@ tcp_conn_t *tcp_conn_new(inet_ep2_t *epp)
 	/* Set up receive window. */
 	conn->rcv_wnd = conn->rcv_buf_size;
 
+	/*
+	 * Offer window scaling and timestamps. This is revised once
+	 * we see the peer's SYN.
+	 */
+	conn->ws_enabled = true;
+	conn->ts_enabled = true;
+	conn->rcv_wscale = tcp_conn_rcv_wscale();
+	conn->snd_wscale = 0;
+	conn->snd_mss = SND_MSS_DEFAULT;
+	conn->rcv_mss = RCV_MSS_DEFAULT;
+
 	/* Initialize incoming segment queue */
 	tcp_iqueue_init(&conn->incoming, conn);
 
@@ -511,6 +576,149 @@ bool tcp_conn_got_syn(tcp_conn_t *conn)
 	assert(false);
 }
 
+/** Determine if timestamp @a a is older than timestamp @a b.
+ *
+ * @param a	Timestamp
+ * @param b	Timestamp
+ * @return	@c true if @a a precedes @a b modulo 2^32
+ */
+static bool tcp_ts_older(uint32_t a, uint32_t b)
+{
+	return (int32_t)(a - b) < 0;
+}
+
+/** Process options of the SYN segment received from peer.
+ *
+ * Window scaling and timestamps are only used if both sides
+ * sent the respective option in their SYN (RFC 7323).
+ *
+ * @param conn		Connection
+ * @param seg		SYN segment
+ */
+static void tcp_conn_opts_negotiate(tcp_conn_t *conn, tcp_segment_t *seg)
+{
+	if (conn->ws_enabled && (seg->opts & SOPT_WSCALE) != 0) {
+		conn->snd_wscale = min(seg->wscale, TCP_WSCALE_MAX);
+	} else {
+		conn->ws_enabled = false;
+		conn->snd_wscale = 0;
+		conn->rcv_wscale = 0;
+	}
+
+	if (conn->ts_enabled && (seg->opts & SOPT_TS) != 0) {
+		conn->ts_recent = seg->ts_val;
+	} else {
+		conn->ts_enabled = false;
+	}
+
+	if ((seg->opts & SOPT_MSS) != 0 && seg->mss != 0)
+		conn->snd_mss = min(conn->snd_mss, seg->mss);
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "%s: SND.WS=%u RCV.WS=%u TS=%d MSS=%zu",
+	    conn->name, (unsigned) conn->snd_wscale,
+	    (unsigned) conn->rcv_wscale, (int) conn->ts_enabled,
+	    conn->snd_mss);
+}
+
+/** Determine if segment should be rejected based on its timestamp.
+ *
+ * Implements the PAWS check (RFC 7323 5.3 R1).
+ *
+ * @param conn		Connection
+ * @param seg		Segment
+ * @return		@c true if segment is an old duplicate
+ */
+static bool tcp_conn_paws_reject(tcp_conn_t *conn, tcp_segment_t *seg)
+{
+	if (!conn->ts_enabled || (seg->opts & SOPT_TS) == 0)
+		return false;
+
+	if ((seg->ctrl & CTL_RST) != 0)
+		return false;
+
+	return tcp_ts_older(seg->ts_val, conn->ts_recent);
+}
+
+/** Update timestamp state based on acceptable incoming segment.
+ *
+ * Records the timestamp to echo (RFC 7323 4.3) and takes
+ * a round-trip time sample from the echoed timestamp.
+ *
+ * @param conn		Connection
+ * @param seg		Segment
+ */
+static void tcp_conn_ts_update(tcp_conn_t *conn, tcp_segment_t *seg)
+{
+	uint32_t rtt;
+
+	if (!conn->ts_enabled || (seg->opts & SOPT_TS) == 0)
+		return;
+
+	if (!tcp_ts_older(seg->ts_val, conn->ts_recent) &&
+	    !tcp_ts_older(conn->last_ack_sent, seg->seq))
+		conn->ts_recent = seg->ts_val;
+
+	if ((seg->ctrl & CTL_ACK) == 0 || seg->ts_ecr == 0)
+		return;
+
+	rtt = max(tcp_ts_now() - seg->ts_ecr, 1);
+
+	/* Exponentially weighted moving average with gain 1/8 */
+	if (conn->srtt == 0)
+		conn->srtt = rtt;
+	else
+		conn->srtt = (7 * conn->srtt + rtt) / 8;
+}
+
+/** Account for data consumed by user and possibly grow receive buffer.
+ *
+ * If the user consumed more than half of the receive buffer within
+ * one round-trip time, the receive window limits throughput. Grow
+ * the buffer to twice the amount consumed per round trip (to allow
+ * for the sender doubling its rate), up to RCV_BUF_MAX. The buffer
+ * is never shrunk, as that would shrink the advertised window.
+ *
+ * @param conn		Connection
+ * @param copied	Number of bytes just consumed by user
+ */
+void tcp_conn_rcv_buf_tune(tcp_conn_t *conn, size_t copied)
+{
+	uint32_t now;
+	uint32_t period;
+	size_t limit;
+	size_t nsize;
+	uint8_t *nbuf;
+
+	assert(fibril_mutex_is_locked(&conn->lock));
+
+	now = tcp_ts_now();
+	conn->rcv_tune_copied += copied;
+
+	period = conn->srtt != 0 ? conn->srtt : RCV_TUNE_PERIOD_DEFAULT;
+	if (now - conn->rcv_tune_time < period)
+		return;
+
+	/* Without window scaling we cannot advertise more anyway */
+	limit = conn->ws_enabled ? RCV_BUF_MAX : min(RCV_BUF_MAX, TCP_WND_MAX);
+
+	if (conn->rcv_tune_copied > conn->rcv_buf_size / 2 &&
+	    conn->rcv_buf_size < limit) {
+		nsize = min(2 * conn->rcv_tune_copied, limit);
+		nbuf = realloc(conn->rcv_buf, nsize);
+		if (nbuf != NULL) {
+			log_msg(LOG_DEFAULT, LVL_DEBUG, "%s: Receive buffer "
+			    "%zu -> %zu bytes", conn->name, conn->rcv_buf_size,
+			    nsize);
+			conn->rcv_wnd += nsize - conn->rcv_buf_size;
+			conn->rcv_buf = nbuf;
+			conn->rcv_buf_size = nsize;
+		}
+	}
+
+	conn->rcv_tune_copied = 0;
+	conn->rcv_tune_time = now;
+}
+
 /** Segment arrived in Listen state.
  *
  * @param conn		Connection
@@ -560,6 +768,8 @@ static void tcp_conn_sa_listen(tcp_conn_t *conn, tcp_segment_t *seg)
 	conn->snd_wl1 = seg->seq;
 	conn->snd_wl2 = seg->seq;
 
+	tcp_conn_opts_negotiate(conn, seg);
+
 	tcp_conn_state_set(conn, st_syn_received);
 
 	tcp_tqueue_ctrl_seg(conn, CTL_SYN | CTL_ACK /* XXX */);
@@ -615,6 +825,8 @@ static void tcp_conn_sa_syn_sent(tcp_conn_t *conn, tcp_segment_t *seg)
 	conn->rcv_nxt = seg->seq + 1;
 	conn->irs = seg->seq;
 
+	tcp_conn_opts_negotiate(conn, seg);
+
 	if ((seg->ctrl & CTL_ACK) != 0) {
 		conn->snd_una = seg->ack;
 
@@ -665,6 +877,14 @@ static void tcp_conn_sa_queue(tcp_conn_t *conn, tcp_segment_t *seg)
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "tcp_conn_sa_seq(%p, %p)", conn, seg);
 
+	/* Protection against wrapped sequence numbers */
+	if (tcp_conn_paws_reject(conn, seg)) {
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "Replying ACK to old timestamp.");
+		tcp_tqueue_ctrl_seg(conn, CTL_ACK);
+		tcp_segment_delete(seg);
+		return;
+	}
+
 	/* Discard unacceptable segments ("old duplicates") */
 	if (!seq_no_segment_acceptable(conn, seg)) {
 		log_msg(LOG_DEFAULT, LVL_DEBUG, "Replying ACK to unacceptable segment.");
@@ -673,6 +893,8 @@ static void tcp_conn_sa_queue(tcp_conn_t *conn, tcp_segment_t *seg)
 		return;
 	}
 
+	tcp_conn_ts_update(conn, seg);
+
 	/* Queue for processing */
 	tcp_iqueue_insert_seg(&conn->incoming, seg);
 
@@ -835,7 +1057,7 @@ static cproc_t tcp_conn_seg_proc_ack_est(tcp_conn_t *conn, tcp_segment_t *seg)
 	}
 
 	if (seq_no_new_wnd_update(conn, seg)) {
-		conn->snd_wnd = seg->wnd;
+		conn->snd_wnd = seg->wnd << conn->snd_wscale;
 		conn->snd_wl1 = seg->seq;
 		conn->snd_wl2 = seg->ack;
 
@@ -57,6 +57,8 @@ extern void tcp_conn_segment_arrived(tcp_conn_t *, inet_ep2_t *,
     tcp_segment_t *);
 extern void tcp_unexpected_segment(inet_ep2_t *, tcp_segment_t *);
 extern void tcp_ep2_flipped(inet_ep2_t *, inet_ep2_t *);
+extern void tcp_conn_rcv_buf_tune(tcp_conn_t *, size_t);
+extern uint32_t tcp_ts_now(void);
 
 extern tcp_lb_t tcp_conn_lb;
 
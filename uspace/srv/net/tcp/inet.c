@@ -34,9 +34,12 @@
  * @file TCP inet interfacing
  */
 
+#include <assert.h>
 #include <bitops.h>
 #include <byteorder.h>
 #include <errno.h>
+#include <fibril.h>
+#include <inet/dgbatch.h>
 #include <inet/inet.h>
 #include <mem.h>
 #include <io/log.h>
@@ -56,6 +59,11 @@ static inet_ev_ops_t tcp_inet_ev_ops = {
 	.recv = tcp_inet_ev_recv
 };
 
+/** Transmit batching nesting level of the current fibril */
+static fibril_local unsigned tcp_inet_batch_level;
+/** PDUs waiting to be transmitted by the current fibril */
+static fibril_local inet_dgbatch_t tcp_inet_batch;
+
 /** Received datagram callback */
 static errno_t tcp_inet_ev_recv(inet_dgram_t *dgram)
 {
@@ -118,7 +126,49 @@ static errno_t tcp_inet_ev_recv(inet_dgram_t *dgram)
 	return EOK;
 }
 
-/** Transmit PDU over network layer. */
+/** Transmit all PDUs collected in the batch of the current fibril. */
+static void tcp_inet_batch_flush(void)
+{
+	errno_t rc;
+
+	if (tcp_inet_batch.count == 0)
+		return;
+
+	rc = inet_send_batch(&tcp_inet_batch, INET_TTL_MAX,
+	    INET_CSUM_PARTIAL);
+	if (rc != EOK)
+		log_msg(LOG_DEFAULT, LVL_ERROR, "Failed to transmit PDUs.");
+
+	inet_dgbatch_clear(&tcp_inet_batch);
+}
+
+/** Start collecting transmitted PDUs.
+ *
+ * Until the matching call to tcp_inet_batch_end(), PDUs transmitted by
+ * the current fibril are collected and then handed over to the Internet
+ * service in a single IPC exchange. Calls can be nested.
+ */
+void tcp_inet_batch_begin(void)
+{
+	++tcp_inet_batch_level;
+}
+
+/** Transmit PDUs collected since tcp_inet_batch_begin(). */
+void tcp_inet_batch_end(void)
+{
+	assert(tcp_inet_batch_level > 0);
+	if (--tcp_inet_batch_level > 0)
+		return;
+
+	tcp_inet_batch_flush();
+	inet_dgbatch_fini(&tcp_inet_batch);
+}
+
+/** Transmit PDU over network layer.
+ *
+ * Between tcp_inet_batch_begin() and tcp_inet_batch_end() the PDU is
+ * added to the current batch instead of being sent immediately.
+ */
 void tcp_transmit_pdu(tcp_pdu_t *pdu)
 {
 	errno_t rc;
@@ -144,7 +194,18 @@ void tcp_transmit_pdu(tcp_pdu_t *pdu)
 	dgram.data = pdu_raw;
 	dgram.size = pdu_raw_size;
 
-	rc = inet_send(&dgram, INET_TTL_MAX, 0);
+	if (tcp_inet_batch_level > 0) {
+		if (!inet_dgbatch_fits(&tcp_inet_batch, dgram.size))
+			tcp_inet_batch_flush();
+
+		rc = inet_dgbatch_add(&tcp_inet_batch, &dgram);
+		if (rc == EOK) {
+			free(pdu_raw);
+			return;
+		}
+	}
+
+	rc = inet_send(&dgram, INET_TTL_MAX, INET_CSUM_PARTIAL);
 	if (rc != EOK)
 		log_msg(LOG_DEFAULT, LVL_ERROR, "Failed to transmit PDU.");
 
@@ -39,6 +39,8 @@
 
 extern errno_t tcp_inet_init(void);
 extern void tcp_transmit_pdu(tcp_pdu_t *);
+extern void tcp_inet_batch_begin(void);
+extern void tcp_inet_batch_end(void);
 
 #endif
 
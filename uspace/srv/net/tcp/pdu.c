@@ -37,6 +37,7 @@
 #include <bitops.h>
 #include <byteorder.h>
 #include <errno.h>
+#include <inet/checksum.h>
 #include <inet/endpoint.h>
 #include <mem.h>
 #include <stdlib.h>
@@ -46,44 +47,6 @@
 #include "std.h"
 #include "tcp_type.h"
 
-#define TCP_CHECKSUM_INIT 0xffff
-
-/** One's complement addition.
- *
- * Result is a + b + carry.
- */
-static uint16_t tcp_ocadd16(uint16_t a, uint16_t b)
-{
-	uint32_t s;
-
-	s = (uint32_t)a + (uint32_t)b;
-	return (s & 0xffff) + (s >> 16);
-}
-
-static uint16_t tcp_checksum_calc(uint16_t ivalue, void *data, size_t size)
-{
-	uint16_t sum;
-	uint16_t w;
-	size_t words, i;
-	uint8_t *bdata;
-
-	sum = ~ivalue;
-	words = size / 2;
-	bdata = (uint8_t *)data;
-
-	for (i = 0; i < words; i++) {
-		w = ((uint16_t)bdata[2 * i] << 8) | bdata[2 * i + 1];
-		sum = tcp_ocadd16(sum, w);
-	}
-
-	if (size % 2 != 0) {
-		w = ((uint16_t)bdata[2 * words] << 8);
-		sum = tcp_ocadd16(sum, w);
-	}
-
-	return ~sum;
-}
-
 static void tcp_header_decode_flags(uint16_t doff_flags, tcp_control_t *rctl)
 {
 	tcp_control_t ctl;
@@ -125,7 +88,143 @@ static void tcp_header_encode_flags(tcp_control_t ctl, uint16_t doff_flags0,
 	*rdoff_flags = doff_flags;
 }
 
-static void tcp_header_setup(inet_ep2_t *epp, tcp_segment_t *seg, tcp_header_t *hdr)
+/** Determine size of encoded options.
+ *
+ * @param seg	Segment
+ * @return	Size of encoded options in bytes (multiple of four)
+ */
+static size_t tcp_options_size(tcp_segment_t *seg)
+{
+	size_t size;
+
+	size = 0;
+
+	if ((seg->opts & SOPT_MSS) != 0)
+		size += OPT_MAX_SEG_SIZE_LEN;
+	/* Window scale is preceded by a NOP to keep alignment */
+	if ((seg->opts & SOPT_WSCALE) != 0)
+		size += 1 + OPT_WINDOW_SCALE_LEN;
+	/* Timestamps are preceded by two NOPs (RFC 7323 appendix A) */
+	if ((seg->opts & SOPT_TS) != 0)
+		size += 2 + OPT_TIMESTAMP_LEN;
+
+	assert(size % sizeof(uint32_t) == 0);
+	return size;
+}
+
+/** Encode segment options.
+ *
+ * @param seg	Segment
+ * @param opt	Destination buffer, must be at least tcp_options_size(seg)
+ *		bytes long
+ */
+static void tcp_options_encode(tcp_segment_t *seg, uint8_t *opt)
+{
+	uint16_t mss;
+	uint32_t ts_val;
+	uint32_t ts_ecr;
+
+	if ((seg->opts & SOPT_MSS) != 0) {
+		mss = host2uint16_t_be(seg->mss);
+		*opt++ = OPT_MAX_SEG_SIZE;
+		*opt++ = OPT_MAX_SEG_SIZE_LEN;
+		memcpy(opt, &mss, sizeof(uint16_t));
+		opt += sizeof(uint16_t);
+	}
+
+	if ((seg->opts & SOPT_WSCALE) != 0) {
+		*opt++ = OPT_NOP;
+		*opt++ = OPT_WINDOW_SCALE;
+		*opt++ = OPT_WINDOW_SCALE_LEN;
+		*opt++ = seg->wscale;
+	}
+
+	if ((seg->opts & SOPT_TS) != 0) {
+		ts_val = host2uint32_t_be(seg->ts_val);
+		ts_ecr = host2uint32_t_be(seg->ts_ecr);
+		*opt++ = OPT_NOP;
+		*opt++ = OPT_NOP;
+		*opt++ = OPT_TIMESTAMP;
+		*opt++ = OPT_TIMESTAMP_LEN;
+		memcpy(opt, &ts_val, sizeof(uint32_t));
+		opt += sizeof(uint32_t);
+		memcpy(opt, &ts_ecr, sizeof(uint32_t));
+		opt += sizeof(uint32_t);
+	}
+}
+
+/** Decode segment options.
+ *
+ * Unknown options are skipped. Parsing stops at the first malformed
+ * option, options decoded up to that point are kept.
+ *
+ * @param opt	Encoded options
+ * @param size	Size of encoded options in bytes
+ * @param seg	Segment to fill in
+ */
+static void tcp_options_decode(uint8_t *opt, size_t size, tcp_segment_t *seg)
+{
+	uint8_t kind;
+	uint8_t len;
+	uint16_t mss;
+	uint32_t ts_val;
+	uint32_t ts_ecr;
+
+	seg->opts = 0;
+
+	while (size > 0) {
+		kind = opt[0];
+		if (kind == OPT_END_LIST)
+			break;
+
+		if (kind == OPT_NOP) {
+			++opt;
+			--size;
+			continue;
+		}
+
+		if (size < 2)
+			break;
+
+		len = opt[1];
+		if (len < 2 || len > size)
+			break;
+
+		switch (kind) {
+		case OPT_MAX_SEG_SIZE:
+			if (len != OPT_MAX_SEG_SIZE_LEN)
+				break;
+			memcpy(&mss, opt + 2, sizeof(uint16_t));
+			seg->mss = uint16_t_be2host(mss);
+			seg->opts |= SOPT_MSS;
+			break;
+		case OPT_WINDOW_SCALE:
+			if (len != OPT_WINDOW_SCALE_LEN)
+				break;
+			seg->wscale = opt[2];
+			seg->opts |= SOPT_WSCALE;
+			break;
+		case OPT_TIMESTAMP:
+			if (len != OPT_TIMESTAMP_LEN)
+				break;
+			memcpy(&ts_val, opt + 2, sizeof(uint32_t));
+			memcpy(&ts_ecr, opt + 6, sizeof(uint32_t));
+			seg->ts_val = uint32_t_be2host(ts_val);
+			seg->ts_ecr = uint32_t_be2host(ts_ecr);
+			seg->opts |= SOPT_TS;
+			break;
+		default:
+			/* Unknown option, skip */
+			break;
+		}
+
+		opt += len;
+		size -= len;
+	}
+}
+
+static void tcp_header_setup(inet_ep2_t *epp, tcp_segment_t *seg,
+    tcp_header_t *hdr, size_t hdr_size)
 {
 	uint16_t doff_flags;
 	uint16_t doff;
@@ -135,7 +234,7 @@ static void tcp_header_setup(inet_ep2_t *epp, tcp_segment_t *seg, tcp_header_t *
 	hdr->seq = host2uint32_t_be(seg->seq);
 	hdr->ack = host2uint32_t_be(seg->ack);
 
-	doff = (sizeof(tcp_header_t) / sizeof(uint32_t)) << DF_DATA_OFFSET_l;
+	doff = (hdr_size / sizeof(uint32_t)) << DF_DATA_OFFSET_l;
 	tcp_header_encode_flags(seg->ctrl, doff, &doff_flags);
 
 	hdr->doff_flags = host2uint16_t_be(doff_flags);
@@ -194,14 +293,19 @@ static errno_t tcp_header_encode(inet_ep2_t *epp, tcp_segment_t *seg,
     void **header, size_t *size)
 {
 	tcp_header_t *hdr;
+	size_t hdr_size;
+
+	hdr_size = sizeof(tcp_header_t) + tcp_options_size(seg);
+	assert(hdr_size <= TCP_HEADER_MAX_SIZE);
 
-	hdr = calloc(1, sizeof(tcp_header_t));
+	hdr = calloc(1, hdr_size);
 	if (hdr == NULL)
 		return ENOMEM;
 
-	tcp_header_setup(epp, seg, hdr);
+	tcp_header_setup(epp, seg, hdr, hdr_size);
+	tcp_options_encode(seg, (uint8_t *)(hdr + 1));
 	*header = hdr;
-	*size = sizeof(tcp_header_t);
+	*size = hdr_size;
 
 	return EOK;
 }
@@ -260,29 +364,35 @@ void tcp_pdu_delete(tcp_pdu_t *pdu)
 	free(pdu);
 }
 
-static uint16_t tcp_pdu_checksum_calc(tcp_pdu_t *pdu)
+/** Compute partial checksum of outgoing PDU.
+ *
+ * Only the pseudo-header is summed. The checksum is completed by the
+ * Internet service or by the link (INET_CSUM_PARTIAL).
+ *
+ * @param pdu PDU
+ * @return Value for the checksum field
+ */
+static uint16_t tcp_pdu_checksum_partial(tcp_pdu_t *pdu)
 {
 	uint16_t cs_phdr;
-	uint16_t cs_headers;
 	tcp_phdr_t phdr;
 	tcp_phdr6_t phdr6;
 
 	ip_ver_t ver = tcp_phdr_setup(pdu, &phdr, &phdr6);
 	switch (ver) {
 	case ip_v4:
-		cs_phdr = tcp_checksum_calc(TCP_CHECKSUM_INIT, (void *) &phdr,
+		cs_phdr = inet_checksum_calc(INET_CHECKSUM_INIT, &phdr,
 		    sizeof(tcp_phdr_t));
 		break;
 	case ip_v6:
-		cs_phdr = tcp_checksum_calc(TCP_CHECKSUM_INIT, (void *) &phdr6,
+		cs_phdr = inet_checksum_calc(INET_CHECKSUM_INIT, &phdr6,
 		    sizeof(tcp_phdr6_t));
 		break;
 	default:
 		assert(false);
 	}
 
-	cs_headers = tcp_checksum_calc(cs_phdr, pdu->header, pdu->header_size);
-	return tcp_checksum_calc(cs_headers, pdu->text, pdu->text_size);
+	return ~cs_phdr;
 }
 
 static void tcp_pdu_set_checksum(tcp_pdu_t *pdu, uint16_t checksum)
@@ -306,6 +416,12 @@ errno_t tcp_pdu_decode(tcp_pdu_t *pdu, inet_ep2_t *epp, tcp_segment_t **seg)
 	tcp_header_decode(pdu->header, nseg);
 	nseg->len += seq_no_control_len(nseg->ctrl);
 
+	if (pdu->header_size > sizeof(tcp_header_t)) {
+		tcp_options_decode((uint8_t *)pdu->header +
+		    sizeof(tcp_header_t), pdu->header_size -
+		    sizeof(tcp_header_t), nseg);
+	}
+
 	hdr = (tcp_header_t *)pdu->header;
 
 	epp->local.port = uint16_t_be2host(hdr->dest_port);
@@ -349,7 +465,7 @@ errno_t tcp_pdu_encode(inet_ep2_t *epp, tcp_segment_t *seg, tcp_pdu_t **pdu)
 	memcpy(npdu->text, seg->data, text_size);
 
 	/* Checksum calculation */
-	checksum = tcp_pdu_checksum_calc(npdu);
+	checksum = tcp_pdu_checksum_partial(npdu);
 	tcp_pdu_set_checksum(npdu, checksum);
 
 	*pdu = npdu;
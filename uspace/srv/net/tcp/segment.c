@@ -74,6 +74,11 @@ tcp_segment_t *tcp_segment_dup(tcp_segment_t *seg)
 	scopy->len = seg->len;
 	scopy->wnd = seg->wnd;
 	scopy->up = seg->up;
+	scopy->opts = seg->opts;
+	scopy->mss = seg->mss;
+	scopy->wscale = seg->wscale;
+	scopy->ts_val = seg->ts_val;
+	scopy->ts_ecr = seg->ts_ecr;
 
 	tsize = tcp_segment_text_size(seg);
 	scopy->data = calloc(tsize, 1);
@@ -254,6 +259,16 @@ void tcp_segment_dump(tcp_segment_t *seg)
 	log_msg(LOG_DEFAULT, LVL_DEBUG2, " - len = %" PRIu32, seg->len);
 	log_msg(LOG_DEFAULT, LVL_DEBUG2, " - wnd = %" PRIu32, seg->wnd);
 	log_msg(LOG_DEFAULT, LVL_DEBUG2, " - up = %" PRIu32, seg->up);
+	if ((seg->opts & SOPT_MSS) != 0)
+		log_msg(LOG_DEFAULT, LVL_DEBUG2, " - mss = %u", (unsigned)seg->mss);
+	if ((seg->opts & SOPT_WSCALE) != 0) {
+		log_msg(LOG_DEFAULT, LVL_DEBUG2, " - wscale = %u",
+		    (unsigned)seg->wscale);
+	}
+	if ((seg->opts & SOPT_TS) != 0) {
+		log_msg(LOG_DEFAULT, LVL_DEBUG2, " - ts_val = %" PRIu32
+		    ", ts_ecr = %" PRIu32, seg->ts_val, seg->ts_ecr);
+	}
 }
 
 /**
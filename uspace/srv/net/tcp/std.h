@@ -31,7 +31,7 @@
  */
 /** @file TCP header definitions
  *
- * Based on IETF RFC 793
+ * Based on IETF RFC 793 and RFC 7323
  */
 
 #ifndef STD_H
@@ -109,9 +109,32 @@ enum opt_kind {
 	/** No-operation */
 	OPT_NOP			= 1,
 	/** Maximum segment size */
-	OPT_MAX_SEG_SIZE	= 2
+	OPT_MAX_SEG_SIZE	= 2,
+	/** Window scale */
+	OPT_WINDOW_SCALE	= 3,
+	/** Timestamps */
+	OPT_TIMESTAMP		= 8
 };
 
+/** Option length (including kind and length octets) */
+enum opt_len {
+	/** Maximum segment size */
+	OPT_MAX_SEG_SIZE_LEN	= 4,
+	/** Window scale */
+	OPT_WINDOW_SCALE_LEN	= 3,
+	/** Timestamps */
+	OPT_TIMESTAMP_LEN	= 10
+};
+
+/** Maximum window scale shift count (RFC 7323 2.3) */
+#define TCP_WSCALE_MAX 14
+
+/** Maximum value of the (unscaled) window field */
+#define TCP_WND_MAX 0xffff
+
+/** Maximum size of TCP header including options */
+#define TCP_HEADER_MAX_SIZE 60
+
 #endif
 
 /** @}
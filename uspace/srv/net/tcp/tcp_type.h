@@ -120,6 +120,19 @@ typedef enum {
 	CTL_ACK		= 0x8
 } tcp_control_t;
 
+/** Segment options present
+ *
+ * Note this is not the actual on-the-wire encoding
+ */
+typedef enum {
+	/** Maximum segment size */
+	SOPT_MSS	= 0x1,
+	/** Window scale */
+	SOPT_WSCALE	= 0x2,
+	/** Timestamps */
+	SOPT_TS		= 0x4
+} tcp_segopt_t;
+
 /** Connection incoming segments queue */
 typedef struct {
 	struct tcp_conn *conn;
@@ -169,6 +182,17 @@ typedef struct {
 	/** Segment urgent pointer */
 	uint32_t up;
 
+	/** Options present in segment */
+	tcp_segopt_t opts;
+	/** Maximum segment size (if SOPT_MSS) */
+	uint16_t mss;
+	/** Window scale shift count (if SOPT_WSCALE) */
+	uint8_t wscale;
+	/** Timestamp value (if SOPT_TS) */
+	uint32_t ts_val;
+	/** Timestamp echo reply (if SOPT_TS) */
+	uint32_t ts_ecr;
+
 	/** Segment data, may be moved when trimming segment */
 	void *data;
 	/** Segment data, original pointer used to free data */
@@ -281,6 +305,10 @@ struct tcp_conn {
 	bool rcv_buf_fin;
 	/** Receive buffer CV. Broadcast when new data is inserted */
 	fibril_condvar_t rcv_buf_cv;
+	/** Bytes consumed by user since @c rcv_tune_time */
+	size_t rcv_tune_copied;
+	/** Start of current receive buffer tuning period (ms) */
+	uint32_t rcv_tune_time;
 
 	/** Send buffer */
 	uint8_t *snd_buf;
@@ -307,6 +335,10 @@ struct tcp_conn {
 	uint32_t snd_wl2;
 	/** Initial send sequence number */
 	uint32_t iss;
+	/** Send window scale shift count */
+	uint8_t snd_wscale;
+	/** Maximum amount of data to send in one segment */
+	size_t snd_mss;
 
 	/** Receive next */
 	uint32_t rcv_nxt;
@@ -316,6 +348,21 @@ struct tcp_conn {
 	uint32_t rcv_up;
 	/** Initial receive sequence number */
 	uint32_t irs;
+	/** Receive window scale shift count */
+	uint8_t rcv_wscale;
+	/** Maximum segment size advertised to the peer */
+	uint16_t rcv_mss;
+
+	/** Window scaling is (to be) used on this connection */
+	bool ws_enabled;
+	/** Timestamps are (to be) used on this connection */
+	bool ts_enabled;
+	/** Most recent timestamp value to be echoed (TS.Recent) */
+	uint32_t ts_recent;
+	/** Last acknowledgement number sent (Last.ACK.sent) */
+	uint32_t last_ack_sent;
+	/** Smoothed round-trip time in ms, zero if not measured yet */
+	uint32_t srtt;
 };
 
 /** Continuation of processing.
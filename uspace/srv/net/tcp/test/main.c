@@ -42,6 +42,15 @@ void test_seg_same(tcp_segment_t *a, tcp_segment_t *b)
 	PCUT_ASSERT_INT_EQUALS(a->len, b->len);
 	PCUT_ASSERT_INT_EQUALS(a->wnd, b->wnd);
 	PCUT_ASSERT_INT_EQUALS(a->up, b->up);
+	PCUT_ASSERT_INT_EQUALS(a->opts, b->opts);
+	if ((a->opts & SOPT_MSS) != 0)
+		PCUT_ASSERT_INT_EQUALS(a->mss, b->mss);
+	if ((a->opts & SOPT_WSCALE) != 0)
+		PCUT_ASSERT_INT_EQUALS(a->wscale, b->wscale);
+	if ((a->opts & SOPT_TS) != 0) {
+		PCUT_ASSERT_INT_EQUALS(a->ts_val, b->ts_val);
+		PCUT_ASSERT_INT_EQUALS(a->ts_ecr, b->ts_ecr);
+	}
 	PCUT_ASSERT_INT_EQUALS(tcp_segment_text_size(a),
 	    tcp_segment_text_size(b));
 	if (tcp_segment_text_size(a) != 0)
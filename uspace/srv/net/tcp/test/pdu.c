@@ -27,6 +27,7 @@
  */
 
 #include <errno.h>
+#include <byteorder.h>
 #include <inet/endpoint.h>
 #include <mem.h>
 #include <pcut/pcut.h>
@@ -35,6 +36,7 @@
 #include "main.h"
 #include "../pdu.h"
 #include "../segment.h"
+#include "../std.h"
 
 PCUT_INIT;
 
@@ -108,4 +110,83 @@ PCUT_TEST(encdec_data)
 	free(data);
 }
 
+/** Test encode/decode round trip for PDU with options */
+PCUT_TEST(encdec_opts)
+{
+	tcp_segment_t *seg, *dseg;
+	tcp_pdu_t *pdu;
+	inet_ep2_t epp, depp;
+	errno_t rc;
+
+	inet_ep2_init(&epp);
+	inet_addr(&epp.local.addr, 1, 2, 3, 4);
+	inet_addr(&epp.remote.addr, 5, 6, 7, 8);
+
+	seg = tcp_segment_make_ctrl(CTL_SYN | CTL_ACK);
+	PCUT_ASSERT_NOT_NULL(seg);
+
+	seg->seq = 20;
+	seg->ack = 19;
+	seg->wnd = 18;
+	seg->up = 17;
+	seg->opts = SOPT_MSS | SOPT_WSCALE | SOPT_TS;
+	seg->mss = 1460;
+	seg->wscale = 7;
+	seg->ts_val = 0x12345678;
+	seg->ts_ecr = 0x9abcdef0;
+
+	rc = tcp_pdu_encode(&epp, seg, &pdu);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_INT_EQUALS(sizeof(tcp_header_t) + 20, pdu->header_size);
+	rc = tcp_pdu_decode(pdu, &depp, &dseg);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	test_seg_same(seg, dseg);
+	tcp_segment_delete(seg);
+	tcp_segment_delete(dseg);
+	tcp_pdu_delete(pdu);
+}
+
+/** Test decoding PDU with malformed and unknown options */
+PCUT_TEST(decode_bad_opts)
+{
+	tcp_segment_t *dseg;
+	tcp_pdu_t *pdu;
+	inet_ep2_t depp;
+	uint8_t hdr[sizeof(tcp_header_t) + 8];
+	uint8_t *opt;
+	errno_t rc;
+
+	memset(hdr, 0, sizeof(hdr));
+	((tcp_header_t *)hdr)->doff_flags = host2uint16_t_be(
+	    (sizeof(hdr) / sizeof(uint32_t)) << DF_DATA_OFFSET_l);
+
+	opt = hdr + sizeof(tcp_header_t);
+	/* Unknown option with valid length, skipped */
+	opt[0] = 42;
+	opt[1] = 3;
+	opt[2] = 0;
+	/* Window scale */
+	opt[3] = OPT_WINDOW_SCALE;
+	opt[4] = OPT_WINDOW_SCALE_LEN;
+	opt[5] = 3;
+	/* Option length overflows the header, parsing stops */
+	opt[6] = OPT_TIMESTAMP;
+	opt[7] = OPT_TIMESTAMP_LEN;
+
+	pdu = tcp_pdu_create(hdr, sizeof(hdr), NULL, 0);
+	PCUT_ASSERT_NOT_NULL(pdu);
+	inet_addr(&pdu->src, 1, 2, 3, 4);
+	inet_addr(&pdu->dest, 5, 6, 7, 8);
+
+	rc = tcp_pdu_decode(pdu, &depp, &dseg);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	PCUT_ASSERT_INT_EQUALS(SOPT_WSCALE, dseg->opts);
+	PCUT_ASSERT_INT_EQUALS(3, dseg->wscale);
+
+	tcp_segment_delete(dseg);
+	tcp_pdu_delete(pdu);
+}
+
 PCUT_EXPORT(pdu);
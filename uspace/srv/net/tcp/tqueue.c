@@ -49,6 +49,7 @@
 #include "rqueue.h"
 #include "segment.h"
 #include "seq_no.h"
+#include "std.h"
 #include "tqueue.h"
 #include "tcp_type.h"
 
@@ -173,6 +174,9 @@ static void tcp_prepare_transmit_segment(tcp_conn_t *conn, tcp_segment_t *seg)
 }
 
 /** Transmit data from the send buffer.
+ *
+ * Sends out as much data as the send window allows, in segments
+ * of at most SND.MSS bytes.
  *
  * @param conn	Connection
  */
@@ -182,6 +186,7 @@ void tcp_tqueue_new_data(tcp_conn_t *conn)
 	size_t xfer_seqlen;
 	size_t snd_buf_seqlen;
 	size_t data_size;
+	size_t sent;
 	tcp_control_t ctrl;
 	bool send_fin;
 
@@ -189,52 +194,72 @@ void tcp_tqueue_new_data(tcp_conn_t *conn)
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "%s: tcp_tqueue_new_data()", conn->name);
 
-	/* Number of free sequence numbers in send window */
-	avail_wnd = (conn->snd_una + conn->snd_wnd) - conn->snd_nxt;
-	snd_buf_seqlen = conn->snd_buf_used + (conn->snd_buf_fin ? 1 : 0);
+	sent = 0;
 
-	xfer_seqlen = min(snd_buf_seqlen, avail_wnd);
-	log_msg(LOG_DEFAULT, LVL_DEBUG, "%s: snd_buf_seqlen = %zu, SND.WND = %" PRIu32 ", "
-	    "xfer_seqlen = %zu", conn->name, snd_buf_seqlen, conn->snd_wnd,
-	    xfer_seqlen);
+	/* Hand all segments over to the network layer at once */
+	tcp_inet_batch_begin();
 
-	if (xfer_seqlen == 0)
-		return;
+	while (true) {
+		/* Number of free sequence numbers in send window */
+		avail_wnd = (conn->snd_una + conn->snd_wnd) - conn->snd_nxt;
+		snd_buf_seqlen = conn->snd_buf_used - sent +
+		    (conn->snd_buf_fin ? 1 : 0);
 
-	/* XXX Do not always send immediately */
+		xfer_seqlen = min(snd_buf_seqlen, avail_wnd);
+		xfer_seqlen = min(xfer_seqlen, conn->snd_mss);
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "%s: snd_buf_seqlen = %zu, "
+		    "SND.WND = %" PRIu32 ", xfer_seqlen = %zu", conn->name,
+		    snd_buf_seqlen, conn->snd_wnd, xfer_seqlen);
 
-	send_fin = conn->snd_buf_fin && xfer_seqlen == snd_buf_seqlen;
-	data_size = xfer_seqlen - (send_fin ? 1 : 0);
+		if (xfer_seqlen == 0)
+			break;
 
-	if (send_fin) {
-		log_msg(LOG_DEFAULT, LVL_DEBUG, "%s: Sending out FIN.", conn->name);
-		/* We are sending out FIN */
-		ctrl = CTL_FIN;
-	} else {
-		ctrl = 0;
+		/* XXX Do not always send immediately */
+
+		send_fin = conn->snd_buf_fin && xfer_seqlen == snd_buf_seqlen;
+		data_size = xfer_seqlen - (send_fin ? 1 : 0);
+
+		if (send_fin) {
+			log_msg(LOG_DEFAULT, LVL_DEBUG, "%s: Sending out FIN.",
+			    conn->name);
+			/* We are sending out FIN */
+			ctrl = CTL_FIN;
+		} else {
+			ctrl = 0;
+		}
+
+		seg = tcp_segment_make_data(ctrl, conn->snd_buf + sent,
+		    data_size);
+		if (seg == NULL) {
+			log_msg(LOG_DEFAULT, LVL_ERROR, "Memory allocation failure.");
+			break;
+		}
+
+		sent += data_size;
+
+		if (send_fin) {
+			conn->snd_buf_fin = false;
+			tcp_conn_fin_sent(conn);
+		}
+
+		tcp_tqueue_seg(conn, seg);
+		tcp_segment_delete(seg);
+
+		if (send_fin)
+			break;
 	}
 
-	seg = tcp_segment_make_data(ctrl, conn->snd_buf, data_size);
-	if (seg == NULL) {
-		log_msg(LOG_DEFAULT, LVL_ERROR, "Memory allocation failure.");
+	tcp_inet_batch_end();
+
+	if (sent == 0)
 		return;
-	}
 
 	/* Remove data from send buffer */
-	memmove(conn->snd_buf, conn->snd_buf + data_size,
-	    conn->snd_buf_used - data_size);
-	conn->snd_buf_used -= data_size;
-
-	if (send_fin)
-		conn->snd_buf_fin = false;
+	memmove(conn->snd_buf, conn->snd_buf + sent,
+	    conn->snd_buf_used - sent);
+	conn->snd_buf_used -= sent;
 
 	fibril_condvar_broadcast(&conn->snd_buf_cv);
-
-	if (send_fin)
-		tcp_conn_fin_sent(conn);
-
-	tcp_tqueue_seg(conn, seg);
-	tcp_segment_delete(seg);
 }
 
 /** Remove ACKed segments from retransmission queue and possibly transmit
@@ -293,12 +318,33 @@ static void tcp_conn_transmit_segment(tcp_conn_t *conn, tcp_segment_t *seg)
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "%s: tcp_conn_transmit_segment(%p, %p)",
 	    conn->name, conn, seg);
 
-	seg->wnd = conn->rcv_wnd;
+	seg->opts = 0;
+
+	if ((seg->ctrl & CTL_SYN) != 0) {
+		/* Window in SYN segment is never scaled (RFC 7323 2.2) */
+		seg->wnd = min(conn->rcv_wnd, TCP_WND_MAX);
+		seg->opts |= SOPT_MSS;
+		seg->mss = conn->rcv_mss;
+		if (conn->ws_enabled) {
+			seg->opts |= SOPT_WSCALE;
+			seg->wscale = conn->rcv_wscale;
+		}
+	} else {
+		seg->wnd = min(conn->rcv_wnd >> conn->rcv_wscale, TCP_WND_MAX);
+	}
 
-	if ((seg->ctrl & CTL_ACK) != 0)
+	if ((seg->ctrl & CTL_ACK) != 0) {
 		seg->ack = conn->rcv_nxt;
-	else
+		conn->last_ack_sent = seg->ack;
+	} else {
 		seg->ack = 0;
+	}
+
+	if (conn->ts_enabled) {
+		seg->opts |= SOPT_TS;
+		seg->ts_val = tcp_ts_now();
+		seg->ts_ecr = (seg->ctrl & CTL_ACK) != 0 ? conn->ts_recent : 0;
+	}
 
 	tcp_tqueue_send_immed(conn, seg);
 }
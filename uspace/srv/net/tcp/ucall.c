@@ -226,6 +226,9 @@ tcp_error_t tcp_uc_receive(tcp_conn_t *conn, void *buf, size_t size,
 	conn->rcv_buf_used -= xfer_size;
 	conn->rcv_wnd += xfer_size;
 
+	/* Grow receive buffer if it limits throughput */
+	tcp_conn_rcv_buf_tune(conn, xfer_size);
+
 	/* TODO */
 	*xflags = 0;
 
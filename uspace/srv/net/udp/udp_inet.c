@@ -90,7 +90,7 @@ errno_t udp_transmit_pdu(udp_pdu_t *pdu)
 	dgram.data = pdu->data;
 	dgram.size = pdu->data_size;
 
-	rc = inet_send(&dgram, INET_TTL_MAX, 0);
+	rc = inet_send(&dgram, INET_TTL_MAX, INET_CSUM_PARTIAL);
 	if (rc != EOK)
 		log_msg(LOG_DEFAULT, LVL_ERROR, "Failed to transmit PDU.");
 
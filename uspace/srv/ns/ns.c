@@ -48,87 +48,102 @@
 #include "clonable.h"
 #include "task.h"
 
-static void ns_connection(ipc_call_t *icall, void *arg)
+/** Number of worker fibrils handling the connections. */
+#define NS_POOL_WORKERS  4
+
+/*
+ * Every task connects to the naming service when it starts, refusing
+ * connections would make the tasks fail. Do not limit the queue.
+ */
+#define NS_POOL_QUEUE_LIMIT  0
+
+static void ns_call(ipc_call_t *call)
 {
-	ipc_call_t call;
 	iface_t iface;
 	service_t service;
+	task_id_t id;
+	errno_t retval;
+
+	switch (ipc_get_imethod(call)) {
+	case IPC_M_CONNECT_ME_TO:
+		iface = ipc_get_arg1(call);
+		service = ipc_get_arg2(call);
+		if (service != 0) {
+			/*
+			 * Client requests to be connected to a service.
+			 */
+			if (ns_service_is_clonable(service, iface)) {
+				ns_clonable_forward(service, iface, call);
+			} else {
+				ns_service_forward(service, iface, call);
+			}
+		} else {
+			async_accept_0(call);
+		}
+
+		return;
+	case IPC_M_PHONE_HUNGUP:
+		(void) ns_task_disconnect(call);
+		async_answer_0(call, EOK);
+		return;
+	case NS_REGISTER:
+		service = ipc_get_arg1(call);
+		iface = ipc_get_arg2(call);
 
-	iface = ipc_get_arg1(icall);
-	service = ipc_get_arg2(icall);
-	if (service != 0) {
 		/*
-		 * Client requests to be connected to a service.
+		 * Server requests service registration.
 		 */
 		if (ns_service_is_clonable(service, iface)) {
-			ns_clonable_forward(service, iface, icall);
+			ns_clonable_register(call);
+			return;
 		} else {
-			ns_service_forward(service, iface, icall);
+			retval = ns_service_register(service, iface);
 		}
 
+		break;
+	case NS_REGISTER_BROKER:
+		service = ipc_get_arg1(call);
+		retval = ns_service_register_broker(service);
+		break;
+	case NS_PING:
+		retval = EOK;
+		break;
+	case NS_TASK_WAIT:
+		id = (task_id_t)
+		    MERGE_LOUP32(ipc_get_arg1(call), ipc_get_arg2(call));
+		wait_for_task(id, call);
 		return;
+	case NS_ID_INTRO:
+		retval = ns_task_id_intro(call);
+		break;
+	case NS_RETVAL:
+		retval = ns_task_retval(call);
+		break;
+	default:
+		printf("%s: Method not supported (%" PRIun ")\n",
+		    NAME, ipc_get_imethod(call));
+		retval = ENOTSUP;
+		break;
 	}
 
-	async_accept_0(icall);
-
-	while (true) {
-		ns_pending_conn_process();
-
-		async_get_call(&call);
-		if (!ipc_get_imethod(&call))
-			break;
-
-		task_id_t id;
-		errno_t retval;
-
-		service_t service;
-
-		switch (ipc_get_imethod(&call)) {
-		case NS_REGISTER:
-			service = ipc_get_arg1(&call);
-			iface = ipc_get_arg2(&call);
-
-			/*
-			 * Server requests service registration.
-			 */
-			if (ns_service_is_clonable(service, iface)) {
-				ns_clonable_register(&call);
-				continue;
-			} else {
-				retval = ns_service_register(service, iface);
-			}
-
-			break;
-		case NS_REGISTER_BROKER:
-			service = ipc_get_arg1(&call);
-			retval = ns_service_register_broker(service);
-			break;
-		case NS_PING:
-			retval = EOK;
-			break;
-		case NS_TASK_WAIT:
-			id = (task_id_t)
-			    MERGE_LOUP32(ipc_get_arg1(&call), ipc_get_arg2(&call));
-			wait_for_task(id, &call);
-			continue;
-		case NS_ID_INTRO:
-			retval = ns_task_id_intro(&call);
-			break;
-		case NS_RETVAL:
-			retval = ns_task_retval(&call);
-			break;
-		default:
-			printf("%s: Method not supported (%" PRIun ")\n",
-			    NAME, ipc_get_imethod(&call));
-			retval = ENOTSUP;
-			break;
-		}
+	async_answer_0(call, retval);
+}
 
-		async_answer_0(&call, retval);
-	}
+/** Handle one call of a naming service connection.
+ *
+ * The connections are handled by a worker pool, the function is called once
+ * for each call of the connection, starting with the opening call.
+ *
+ * @param call Incoming call.
+ * @param arg  Unused.
+ *
+ */
+static void ns_connection(ipc_call_t *call, void *arg)
+{
+	ns_call(call);
 
-	(void) ns_task_disconnect(&call);
-	async_answer_0(&call, EOK);
+	/* The call might have made some pending connections possible. */
+	ns_pending_conn_process();
 }
 
 int main(int argc, char **argv)
@@ -147,7 +162,12 @@ int main(int argc, char **argv)
 	if (rc != EOK)
 		return rc;
 
-	async_set_fallback_port_handler(ns_connection, NULL);
+	async_pool_t *pool;
+	rc = async_pool_create(NS_POOL_WORKERS, NS_POOL_QUEUE_LIMIT, &pool);
+	if (rc != EOK)
+		return rc;
+
+	async_set_fallback_port_handler_pooled(ns_connection, NULL, pool);
 
 	printf("%s: Accepting connections\n", NAME);
 	async_manager();
@@ -44,6 +44,7 @@
 #include <ipc/vfs.h>
 #include <task.h>
 #include <vfs/vfs.h>
+#include <as.h>
 
 #ifndef dprintf
 #define dprintf(...)
@@ -124,8 +125,52 @@ typedef struct _vfs_node {
 	fibril_rwlock_t contents_rwlock;
 
 	struct _vfs_node *mount;
+
+	/** Clusters of this node in the page cache, protected by the cache. */
+	list_t clusters;
 } vfs_node_t;
 
+/** Number of pages in a page cache cluster. */
+#define VFS_CLUSTER_PAGES	16
+/** Size of a page cache cluster. */
+#define VFS_CLUSTER_SIZE	(VFS_CLUSTER_PAGES * PAGE_SIZE)
+
+/**
+ * Instances of this type represent a cluster of consecutive file pages kept
+ * in the page cache. Clusters are the unit of read-around for the pager.
+ */
+typedef struct {
+	ht_link_t link;		/**< Page cache hash table link. */
+	link_t node_link;	/**< Link to vfs_node_t.clusters. */
+	link_t lru_link;	/**< Link to the list of reclaimable clusters. */
+
+	vfs_node_t *node;
+	/** File position of the first byte of the cluster. */
+	aoff64_t pos;
+	/** Cluster data, VFS_CLUSTER_SIZE bytes. */
+	uint8_t *data;
+
+	/** Number of users, the cluster is only reclaimed when zero. */
+	unsigned refcnt;
+	/** Serializes filling and writing back the cluster data. */
+	fibril_mutex_t lock;
+	/** The data has been read from the file. */
+	bool valid;
+	/** The cluster was removed from the cache and goes with the last user. */
+	bool removed;
+	/**
+	 * Pages of the cluster were handed out to a writable shared mapping.
+	 * Such a cluster is kept until the node is released.
+	 */
+	bool mapped_rw;
+	/**
+	 * Copy of the data as last read from or written to the file, present
+	 * if mapped_rw is set. Pages whose data differ from it are dirty and
+	 * get written back on sync.
+	 */
+	uint8_t *clean;
+} vfs_cluster_t;
+
 /**
  * Instances of this type represent an open file. If the file is opened by more
  * than one task, there will be a separate structure allocated for each task.
@@ -214,6 +259,7 @@ extern errno_t vfs_op_mtab_get(void);
 extern errno_t vfs_op_open(int fd, int flags);
 extern errno_t vfs_op_put(int fd);
 extern errno_t vfs_op_read(int fd, aoff64_t, size_t *out_bytes);
+extern errno_t vfs_op_readdir(int fd, aoff64_t, unsigned, void *, size_t *);
 extern errno_t vfs_op_rename(int basefd, char *old, char *new);
 extern errno_t vfs_op_resize(int fd, int64_t size);
 extern errno_t vfs_op_stat(int fd);
@@ -229,12 +275,17 @@ extern void vfs_register(ipc_call_t *);
 
 extern void vfs_page_in(ipc_call_t *);
 
-typedef struct {
-	void *buffer;
-	size_t size;
-} rdwr_io_chunk_t;
-
-extern errno_t vfs_rdwr_internal(int, aoff64_t, bool, rdwr_io_chunk_t *);
+extern bool vfs_pagecache_init(void);
+extern errno_t vfs_pagecache_get(vfs_node_t *, aoff64_t, vfs_cluster_t **);
+extern void vfs_pagecache_put(vfs_cluster_t *);
+extern errno_t vfs_pagecache_pin(vfs_cluster_t *);
+extern errno_t vfs_pagecache_writeback(vfs_node_t *);
+extern errno_t vfs_pagecache_sync(vfs_node_t *);
+extern bool vfs_pagecache_cached(vfs_node_t *);
+extern errno_t vfs_pagecache_write(async_exch_t *, vfs_node_t *, aoff64_t,
+    ipc_call_t *);
+extern void vfs_pagecache_truncate(vfs_node_t *, aoff64_t);
+extern void vfs_pagecache_release(vfs_node_t *, bool);
 
 extern void vfs_connection(ipc_call_t *, void *);
 
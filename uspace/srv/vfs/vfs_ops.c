@@ -369,6 +369,9 @@ static errno_t rdwr_ipc_client(async_exch_t *exch, vfs_file_t *file, aoff64_t po
 		rc = async_data_read_forward_4_1(exch, VFS_OUT_READ,
 		    file->node->service_id, file->node->index,
 		    LOWER32(pos), UPPER32(pos), answer);
+	} else if (vfs_pagecache_cached(file->node)) {
+		/* Mappings of the file must see the new data. */
+		rc = vfs_pagecache_write(exch, file->node, pos, answer);
 	} else {
 		rc = async_data_write_forward_4_1(exch, VFS_OUT_WRITE,
 		    file->node->service_id, file->node->index,
@@ -379,34 +382,6 @@ static errno_t rdwr_ipc_client(async_exch_t *exch, vfs_file_t *file, aoff64_t po
 	return rc;
 }
 
-static errno_t rdwr_ipc_internal(async_exch_t *exch, vfs_file_t *file, aoff64_t pos,
-    ipc_call_t *answer, bool read, void *data)
-{
-	rdwr_io_chunk_t *chunk = (rdwr_io_chunk_t *) data;
-
-	if (exch == NULL)
-		return ENOENT;
-
-	aid_t msg = async_send_4(exch, read ? VFS_OUT_READ : VFS_OUT_WRITE,
-	    file->node->service_id, file->node->index, LOWER32(pos),
-	    UPPER32(pos), answer);
-	if (msg == 0)
-		return EINVAL;
-
-	errno_t retval = async_data_read_start(exch, chunk->buffer, chunk->size);
-	if (retval != EOK) {
-		async_forget(msg);
-		return retval;
-	}
-
-	errno_t rc;
-	async_wait_for(msg, &rc);
-
-	chunk->size = ipc_get_arg1(answer);
-
-	return (errno_t) rc;
-}
-
 static errno_t vfs_rdwr(int fd, aoff64_t pos, bool read, rdwr_ipc_cb_t ipc_cb,
     void *ipc_cb_data)
 {
@@ -467,18 +442,29 @@ static errno_t vfs_rdwr(int fd, aoff64_t pos, bool read, rdwr_ipc_cb_t ipc_cb,
 		fibril_rwlock_read_lock(&namespace_rwlock);
 	}
 
-	async_exch_t *fs_exch = vfs_exchange_grab(file->node->fs_handle);
-
-	if (!read && file->append)
-		pos = file->node->size;
-
 	/*
-	 * Handle communication with the endpoint FS.
+	 * Pages modified through shared mappings must reach the file before
+	 * the write does, otherwise they would overwrite it later.
 	 */
 	ipc_call_t answer;
-	errno_t rc = ipc_cb(fs_exch, file, pos, &answer, read, ipc_cb_data);
+	errno_t rc = EOK;
+	if (!read)
+		rc = vfs_pagecache_writeback(file->node);
 
-	vfs_exchange_release(fs_exch);
+	if (rc == EOK) {
+		async_exch_t *fs_exch =
+		    vfs_exchange_grab(file->node->fs_handle);
+
+		if (!read && file->append)
+			pos = file->node->size;
+
+		/*
+		 * Handle communication with the endpoint FS.
+		 */
+		rc = ipc_cb(fs_exch, file, pos, &answer, read, ipc_cb_data);
+
+		vfs_exchange_release(fs_exch);
+	}
 
 	if (file->node->type == VFS_NODE_DIRECTORY)
 		fibril_rwlock_read_unlock(&namespace_rwlock);
@@ -500,14 +486,64 @@ static errno_t vfs_rdwr(int fd, aoff64_t pos, bool read, rdwr_ipc_cb_t ipc_cb,
 	return rc;
 }
 
-errno_t vfs_rdwr_internal(int fd, aoff64_t pos, bool read, rdwr_io_chunk_t *chunk)
+errno_t vfs_op_read(int fd, aoff64_t pos, size_t *out_bytes)
 {
-	return vfs_rdwr(fd, pos, read, rdwr_ipc_internal, chunk);
+	return vfs_rdwr(fd, pos, true, rdwr_ipc_client, out_bytes);
 }
 
-errno_t vfs_op_read(int fd, aoff64_t pos, size_t *out_bytes)
+/** Read a batch of directory entries.
+ *
+ * @param fd    Directory file descriptor
+ * @param pos   Position to read from
+ * @param flags VFS_READDIR_* flags
+ * @param buf   Buffer for packed entries
+ * @param size  Size of the buffer on input, bytes filled in on output
+ *
+ * @return EOK on success or an error code
+ */
+errno_t vfs_op_readdir(int fd, aoff64_t pos, unsigned flags, void *buf,
+    size_t *size)
 {
-	return vfs_rdwr(fd, pos, true, rdwr_ipc_client, out_bytes);
+	vfs_file_t *file = vfs_file_get(fd);
+	if (!file)
+		return EBADF;
+
+	if (!file->open_read) {
+		vfs_file_put(file);
+		return EINVAL;
+	}
+
+	if (file->node->type != VFS_NODE_DIRECTORY) {
+		vfs_file_put(file);
+		return ENOTDIR;
+	}
+
+	/* Make sure that no one is modifying the namespace meanwhile. */
+	fibril_rwlock_read_lock(&file->node->contents_rwlock);
+	fibril_rwlock_read_lock(&namespace_rwlock);
+
+	async_exch_t *exch = vfs_exchange_grab(file->node->fs_handle);
+
+	ipc_call_t answer;
+	aid_t msg = async_send_5(exch, VFS_OUT_READDIR, file->node->service_id,
+	    file->node->index, LOWER32(pos), UPPER32(pos), flags, &answer);
+
+	errno_t rc = async_data_read_start(exch, buf, *size);
+	vfs_exchange_release(exch);
+
+	if (rc == EOK) {
+		async_wait_for(msg, &rc);
+		if (rc == EOK)
+			*size = ipc_get_arg1(&answer);
+	} else {
+		async_forget(msg);
+	}
+
+	fibril_rwlock_read_unlock(&namespace_rwlock);
+	fibril_rwlock_read_unlock(&file->node->contents_rwlock);
+	vfs_file_put(file);
+
+	return rc;
 }
 
 errno_t vfs_op_rename(int basefd, char *old, char *new)
@@ -626,8 +662,10 @@ errno_t vfs_op_resize(int fd, int64_t size)
 
 	errno_t rc = vfs_truncate_internal(file->node->fs_handle,
 	    file->node->service_id, file->node->index, size);
-	if (rc == EOK)
+	if (rc == EOK) {
 		file->node->size = size;
+		vfs_pagecache_truncate(file->node, size);
+	}
 
 	fibril_rwlock_write_unlock(&file->node->contents_rwlock);
 	vfs_file_put(file);
@@ -674,6 +712,8 @@ errno_t vfs_op_sync(int fd)
 	if (!file)
 		return EBADF;
 
+	errno_t wbrc = vfs_pagecache_sync(file->node);
+
 	async_exch_t *fs_exch = vfs_exchange_grab(file->node->fs_handle);
 
 	aid_t msg;
@@ -687,7 +727,7 @@ errno_t vfs_op_sync(int fd)
 	async_wait_for(msg, &rc);
 
 	vfs_file_put(file);
-	return rc;
+	return rc != EOK ? rc : wbrc;
 
 }
 
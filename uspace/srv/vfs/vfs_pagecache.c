@@ -0,0 +1,707 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup vfs
+ * @{
+ */
+
+/**
+ * @file vfs_pagecache.c
+ * @brief VFS page cache.
+ *
+ * The page cache keeps file data for the VFS pager. Data are cached in
+ * clusters of VFS_CLUSTER_PAGES pages, so that a single page-in reads the
+ * neighbouring pages from the file system as well. The pager hands out the
+ * frames of the cached pages directly, which makes tasks mapping the same
+ * file share them.
+ *
+ * The frames of writable shared mappings are modified without VFS noticing.
+ * A cluster handed out to such a mapping therefore keeps a clean copy of its
+ * data and only the pages which differ from it are written back.
+ */
+
+#include "vfs.h"
+#include <adt/hash.h>
+#include <adt/hash_table.h>
+#include <adt/list.h>
+#include <align.h>
+#include <as.h>
+#include <assert.h>
+#include <async.h>
+#include <errno.h>
+#include <fibril_synch.h>
+#include <macros.h>
+#include <mem.h>
+#include <stdlib.h>
+
+/** Soft limit on the number of cached clusters. */
+#define PAGECACHE_CLUSTERS_MAX	256
+
+typedef struct {
+	vfs_triplet_t triplet;
+	aoff64_t pos;
+} pagecache_key_t;
+
+/** Protects the cache hash table, the LRU list and the node cluster lists. */
+static FIBRIL_MUTEX_INITIALIZE(pagecache_mutex);
+
+/** Page cache hash table. */
+static hash_table_t pagecache;
+
+/** Unused clusters that can be reclaimed, least recently used first. */
+static LIST_INITIALIZE(pagecache_lru);
+
+/** Number of clusters in the cache. */
+static size_t pagecache_count;
+
+static size_t pagecache_key_hash(const void *key)
+{
+	const pagecache_key_t *k = key;
+	size_t hash = hash_combine(k->triplet.fs_handle, k->triplet.index);
+	hash = hash_combine(hash, k->triplet.service_id);
+	return hash_combine(hash, k->pos / VFS_CLUSTER_SIZE);
+}
+
+static size_t pagecache_hash(const ht_link_t *item)
+{
+	vfs_cluster_t *cluster = hash_table_get_inst(item, vfs_cluster_t, link);
+	pagecache_key_t key = {
+		.triplet = {
+			.fs_handle = cluster->node->fs_handle,
+			.service_id = cluster->node->service_id,
+			.index = cluster->node->index
+		},
+		.pos = cluster->pos
+	};
+
+	return pagecache_key_hash(&key);
+}
+
+static bool pagecache_key_equal(const void *key, const ht_link_t *item)
+{
+	const pagecache_key_t *k = key;
+	vfs_cluster_t *cluster = hash_table_get_inst(item, vfs_cluster_t, link);
+
+	return cluster->node->fs_handle == k->triplet.fs_handle &&
+	    cluster->node->service_id == k->triplet.service_id &&
+	    cluster->node->index == k->triplet.index &&
+	    cluster->pos == k->pos;
+}
+
+static hash_table_ops_t pagecache_ops = {
+	.hash = pagecache_hash,
+	.key_hash = pagecache_key_hash,
+	.key_equal = pagecache_key_equal,
+	.equal = NULL,
+	.remove_callback = NULL
+};
+
+/** Initialize the page cache.
+ *
+ * @return True on success, false on failure.
+ */
+bool vfs_pagecache_init(void)
+{
+	return hash_table_create(&pagecache, 0, 0, &pagecache_ops);
+}
+
+/** Transfer data between a buffer and a file bypassing the page cache.
+ *
+ * The caller must hold the contents lock of the node.
+ *
+ * @param node   VFS node
+ * @param pos    Position in the file
+ * @param read   Read from the file if true, write to it otherwise
+ * @param buf    Buffer
+ * @param size   Number of bytes to transfer
+ * @param nbytes Place to store the number of bytes transferred
+ *
+ * @return EOK on success or an error code.
+ */
+static errno_t pagecache_io(vfs_node_t *node, aoff64_t pos, bool read,
+    uint8_t *buf, size_t size, size_t *nbytes)
+{
+	async_exch_t *exch = vfs_exchange_grab(node->fs_handle);
+	size_t done = 0;
+	errno_t rc = EOK;
+
+	/* File systems may transfer less than asked for, e.g. one block. */
+	while (done < size) {
+		size_t chunk = min(size - done, DATA_XFER_LIMIT);
+		ipc_call_t answer;
+
+		aid_t msg = async_send_4(exch,
+		    read ? VFS_OUT_READ : VFS_OUT_WRITE, node->service_id,
+		    node->index, LOWER32(pos + done), UPPER32(pos + done),
+		    &answer);
+
+		if (read)
+			rc = async_data_read_start(exch, buf + done, chunk);
+		else
+			rc = async_data_write_start(exch, buf + done, chunk);
+
+		if (rc != EOK) {
+			async_forget(msg);
+			break;
+		}
+
+		async_wait_for(msg, &rc);
+		if (rc != EOK)
+			break;
+
+		if (!read) {
+			node->size = MERGE_LOUP32(ipc_get_arg2(&answer),
+			    ipc_get_arg3(&answer));
+		}
+
+		size_t n = ipc_get_arg1(&answer);
+		if (n == 0)
+			break;
+
+		done += n;
+	}
+
+	vfs_exchange_release(exch);
+
+	*nbytes = done;
+	return rc;
+}
+
+/** Free a cluster which is not in the cache any more. */
+static void pagecache_cluster_destroy(vfs_cluster_t *cluster)
+{
+	as_area_destroy(cluster->data);
+	free(cluster->clean);
+	free(cluster);
+}
+
+/** Remove a cluster from the cache.
+ *
+ * Must be called with pagecache_mutex held.
+ *
+ * @return True if the caller should destroy the cluster.
+ */
+static bool pagecache_cluster_remove(vfs_cluster_t *cluster)
+{
+	assert(fibril_mutex_is_locked(&pagecache_mutex));
+	assert(!cluster->removed);
+
+	hash_table_remove_item(&pagecache, &cluster->link);
+	list_remove(&cluster->node_link);
+	if (link_in_use(&cluster->lru_link))
+		list_remove(&cluster->lru_link);
+
+	pagecache_count--;
+	cluster->removed = true;
+	return cluster->refcnt == 0;
+}
+
+/** Get a cluster from the page cache.
+ *
+ * If the cluster is not cached yet, it is read from the file. The returned
+ * cluster must be returned by vfs_pagecache_put().
+ *
+ * @param node       VFS node
+ * @param pos        Position in the file
+ * @param[out] rcluster Cluster containing the position
+ *
+ * @return EOK on success or an error code.
+ */
+errno_t vfs_pagecache_get(vfs_node_t *node, aoff64_t pos,
+    vfs_cluster_t **rcluster)
+{
+	vfs_cluster_t *cluster;
+	vfs_cluster_t *victim = NULL;
+	pagecache_key_t key = {
+		.triplet = {
+			.fs_handle = node->fs_handle,
+			.service_id = node->service_id,
+			.index = node->index
+		},
+		.pos = ALIGN_DOWN(pos, VFS_CLUSTER_SIZE)
+	};
+
+	fibril_mutex_lock(&pagecache_mutex);
+
+	ht_link_t *link = hash_table_find(&pagecache, &key);
+	if (link != NULL) {
+		cluster = hash_table_get_inst(link, vfs_cluster_t, link);
+		if (link_in_use(&cluster->lru_link))
+			list_remove(&cluster->lru_link);
+		cluster->refcnt++;
+	} else {
+		cluster = calloc(1, sizeof(vfs_cluster_t));
+		if (cluster == NULL) {
+			fibril_mutex_unlock(&pagecache_mutex);
+			return ENOMEM;
+		}
+
+		cluster->data = as_area_create(AS_AREA_ANY, VFS_CLUSTER_SIZE,
+		    AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE,
+		    AS_AREA_UNPAGED);
+		if (cluster->data == AS_MAP_FAILED) {
+			fibril_mutex_unlock(&pagecache_mutex);
+			free(cluster);
+			return ENOMEM;
+		}
+
+		link_initialize(&cluster->node_link);
+		link_initialize(&cluster->lru_link);
+		fibril_mutex_initialize(&cluster->lock);
+		cluster->node = node;
+		cluster->pos = key.pos;
+		cluster->refcnt = 1;
+
+		hash_table_insert(&pagecache, &cluster->link);
+		list_append(&cluster->node_link, &node->clusters);
+		pagecache_count++;
+
+		if (pagecache_count > PAGECACHE_CLUSTERS_MAX &&
+		    !list_empty(&pagecache_lru)) {
+			victim = list_get_instance(list_first(&pagecache_lru),
+			    vfs_cluster_t, lru_link);
+			if (!pagecache_cluster_remove(victim))
+				victim = NULL;
+		}
+	}
+
+	fibril_mutex_unlock(&pagecache_mutex);
+
+	if (victim != NULL)
+		pagecache_cluster_destroy(victim);
+
+	errno_t rc = EOK;
+
+	fibril_rwlock_read_lock(&node->contents_rwlock);
+	fibril_mutex_lock(&cluster->lock);
+
+	if (!cluster->valid) {
+		size_t nread;
+
+		rc = pagecache_io(node, cluster->pos, true, cluster->data,
+		    VFS_CLUSTER_SIZE, &nread);
+		if (rc == EOK) {
+			/* Make sure all pages are backed by frames. */
+			memset(cluster->data + nread, 0,
+			    VFS_CLUSTER_SIZE - nread);
+			cluster->valid = true;
+		}
+	}
+
+	fibril_mutex_unlock(&cluster->lock);
+	fibril_rwlock_read_unlock(&node->contents_rwlock);
+
+	if (rc != EOK) {
+		vfs_pagecache_put(cluster);
+		return rc;
+	}
+
+	*rcluster = cluster;
+	return EOK;
+}
+
+/** Return a cluster obtained by vfs_pagecache_get().
+ *
+ * @param cluster Cluster
+ */
+void vfs_pagecache_put(vfs_cluster_t *cluster)
+{
+	bool destroy = false;
+
+	fibril_mutex_lock(&pagecache_mutex);
+
+	assert(cluster->refcnt > 0);
+	cluster->refcnt--;
+	if (cluster->refcnt == 0) {
+		if (cluster->removed) {
+			destroy = true;
+		} else if (!cluster->valid) {
+			/* Do not keep clusters that failed to read. */
+			destroy = pagecache_cluster_remove(cluster);
+		} else if (!cluster->mapped_rw) {
+			list_append(&cluster->lru_link, &pagecache_lru);
+		}
+	}
+
+	fibril_mutex_unlock(&pagecache_mutex);
+
+	if (destroy)
+		pagecache_cluster_destroy(cluster);
+}
+
+/** Mark a cluster as mapped by a writable shared mapping.
+ *
+ * @param cluster Cluster obtained by vfs_pagecache_get()
+ *
+ * @return EOK on success or ENOMEM if there is no memory for the clean copy.
+ */
+errno_t vfs_pagecache_pin(vfs_cluster_t *cluster)
+{
+	fibril_mutex_lock(&cluster->lock);
+
+	if (cluster->clean == NULL) {
+		/* No writable mapping yet, so the data are still clean. */
+		uint8_t *clean = malloc(VFS_CLUSTER_SIZE);
+		if (clean == NULL) {
+			fibril_mutex_unlock(&cluster->lock);
+			return ENOMEM;
+		}
+
+		memcpy(clean, cluster->data, VFS_CLUSTER_SIZE);
+		cluster->clean = clean;
+	}
+
+	fibril_mutex_unlock(&cluster->lock);
+
+	fibril_mutex_lock(&pagecache_mutex);
+	cluster->mapped_rw = true;
+	fibril_mutex_unlock(&pagecache_mutex);
+
+	return EOK;
+}
+
+/** Find the next cluster of a node which satisfies a predicate.
+ *
+ * Must be called with pagecache_mutex held. The returned cluster has its
+ * reference count incremented.
+ */
+static vfs_cluster_t *pagecache_node_next(vfs_node_t *node,
+    vfs_cluster_t *cur, bool (*pred)(vfs_cluster_t *, void *), void *arg)
+{
+	link_t *link = cur ? list_next(&cur->node_link, &node->clusters) :
+	    list_first(&node->clusters);
+
+	while (link != NULL) {
+		vfs_cluster_t *cluster = list_get_instance(link, vfs_cluster_t,
+		    node_link);
+		if (pred(cluster, arg)) {
+			if (link_in_use(&cluster->lru_link))
+				list_remove(&cluster->lru_link);
+			cluster->refcnt++;
+			return cluster;
+		}
+		link = list_next(link, &node->clusters);
+	}
+
+	return NULL;
+}
+
+/** Iterate over clusters of a node which satisfy a predicate.
+ *
+ * The visitor is called without pagecache_mutex held. The caller must hold
+ * the contents lock of the node so that the clusters cannot be removed.
+ */
+static errno_t pagecache_node_apply(vfs_node_t *node,
+    bool (*pred)(vfs_cluster_t *, void *),
+    errno_t (*visit)(vfs_cluster_t *, void *), void *arg)
+{
+	errno_t rc = EOK;
+
+	fibril_mutex_lock(&pagecache_mutex);
+	vfs_cluster_t *cluster = pagecache_node_next(node, NULL, pred, arg);
+	fibril_mutex_unlock(&pagecache_mutex);
+
+	while (cluster != NULL) {
+		errno_t vrc = visit(cluster, arg);
+		if (rc == EOK)
+			rc = vrc;
+
+		fibril_mutex_lock(&pagecache_mutex);
+		vfs_cluster_t *next = pagecache_node_next(node, cluster, pred,
+		    arg);
+		fibril_mutex_unlock(&pagecache_mutex);
+
+		vfs_pagecache_put(cluster);
+		cluster = next;
+	}
+
+	return rc;
+}
+
+static bool pagecache_is_mapped_rw(vfs_cluster_t *cluster, void *arg)
+{
+	return cluster->mapped_rw;
+}
+
+/** Check whether a page of a cluster differs from its clean copy. */
+static bool pagecache_page_dirty(vfs_cluster_t *cluster, size_t page)
+{
+	size_t off = page * PAGE_SIZE;
+
+	return memcmp(cluster->data + off, cluster->clean + off,
+	    PAGE_SIZE) != 0;
+}
+
+static errno_t pagecache_cluster_writeback(vfs_cluster_t *cluster, void *arg)
+{
+	vfs_node_t *node = cluster->node;
+	errno_t rc = EOK;
+
+	fibril_mutex_lock(&cluster->lock);
+
+	if (!cluster->valid || cluster->clean == NULL ||
+	    cluster->pos >= node->size) {
+		fibril_mutex_unlock(&cluster->lock);
+		return EOK;
+	}
+
+	/* Write-back never extends the file. */
+	size_t size = min(node->size - cluster->pos, VFS_CLUSTER_SIZE);
+	size_t pages = ALIGN_UP(size, PAGE_SIZE) / PAGE_SIZE;
+	size_t page = 0;
+
+	/* Write each run of dirty pages at once. */
+	while (page < pages) {
+		if (!pagecache_page_dirty(cluster, page)) {
+			page++;
+			continue;
+		}
+
+		size_t first = page;
+		while (page < pages && pagecache_page_dirty(cluster, page))
+			page++;
+
+		size_t off = first * PAGE_SIZE;
+		size_t len = min(page * PAGE_SIZE, size) - off;
+		size_t nwritten;
+
+		rc = pagecache_io(node, cluster->pos + off, false,
+		    cluster->data + off, len, &nwritten);
+		if (rc == EOK && nwritten < len)
+			rc = EIO;
+		if (rc != EOK)
+			break;
+
+		memcpy(cluster->clean + off, cluster->data + off, len);
+	}
+
+	fibril_mutex_unlock(&cluster->lock);
+	return rc;
+}
+
+/** Write back dirty pages of a node modified through shared mappings.
+ *
+ * The caller must hold the contents lock of the node.
+ *
+ * @param node VFS node
+ *
+ * @return EOK on success or an error code.
+ */
+errno_t vfs_pagecache_writeback(vfs_node_t *node)
+{
+	return pagecache_node_apply(node, pagecache_is_mapped_rw,
+	    pagecache_cluster_writeback, NULL);
+}
+
+/** Write back clusters of a node modified through shared mappings.
+ *
+ * @param node VFS node
+ *
+ * @return EOK on success or an error code.
+ */
+errno_t vfs_pagecache_sync(vfs_node_t *node)
+{
+	fibril_rwlock_write_lock(&node->contents_rwlock);
+	errno_t rc = vfs_pagecache_writeback(node);
+	fibril_rwlock_write_unlock(&node->contents_rwlock);
+
+	return rc;
+}
+
+typedef struct {
+	aoff64_t pos;
+	size_t size;
+	const uint8_t *buf;
+} pagecache_range_t;
+
+static bool pagecache_overlaps(vfs_cluster_t *cluster, void *arg)
+{
+	pagecache_range_t *range = arg;
+
+	return cluster->pos < range->pos + range->size &&
+	    range->pos < cluster->pos + VFS_CLUSTER_SIZE;
+}
+
+static errno_t pagecache_cluster_update(vfs_cluster_t *cluster, void *arg)
+{
+	pagecache_range_t *range = arg;
+
+	aoff64_t start = max(range->pos, cluster->pos);
+	aoff64_t end = min(range->pos + range->size,
+	    cluster->pos + VFS_CLUSTER_SIZE);
+	size_t off = start - cluster->pos;
+	const uint8_t *src = range->buf + (start - range->pos);
+
+	fibril_mutex_lock(&cluster->lock);
+
+	if (cluster->valid) {
+		memcpy(cluster->data + off, src, end - start);
+		/* The file has the same data now. */
+		if (cluster->clean != NULL)
+			memcpy(cluster->clean + off, src, end - start);
+	}
+
+	fibril_mutex_unlock(&cluster->lock);
+	return EOK;
+}
+
+/** Check whether a node has any data in the page cache.
+ *
+ * @param node VFS node
+ *
+ * @return True if some clusters of the node are cached.
+ */
+bool vfs_pagecache_cached(vfs_node_t *node)
+{
+	fibril_mutex_lock(&pagecache_mutex);
+	bool cached = !list_empty(&node->clusters);
+	fibril_mutex_unlock(&pagecache_mutex);
+
+	return cached;
+}
+
+/** Write data from the client to a file and update the cached pages.
+ *
+ * Unlike forwarding the client's data to the file system, this receives the
+ * data in VFS, so that the cached pages and thus all mappings of the file can
+ * be updated from them. The caller must hold the contents lock of the node.
+ *
+ * @param exch   Exchange with the file system
+ * @param node   VFS node
+ * @param pos    Position of the write
+ * @param answer Place to store the answer of the file system
+ *
+ * @return EOK on success or an error code.
+ */
+errno_t vfs_pagecache_write(async_exch_t *exch, vfs_node_t *node,
+    aoff64_t pos, ipc_call_t *answer)
+{
+	uint8_t *buf;
+	size_t size;
+
+	/* Nothing was written unless the file system answers otherwise. */
+	memset(answer, 0, sizeof(*answer));
+
+	errno_t rc = async_data_write_accept((void **) &buf, false, 0,
+	    DATA_XFER_LIMIT, 0, &size);
+	if (rc != EOK)
+		return rc;
+
+	aid_t msg = async_send_4(exch, VFS_OUT_WRITE, node->service_id,
+	    node->index, LOWER32(pos), UPPER32(pos), answer);
+
+	rc = async_data_write_start(exch, buf, size);
+	if (rc != EOK) {
+		async_forget(msg);
+		free(buf);
+		return rc;
+	}
+
+	async_wait_for(msg, &rc);
+	if (rc == EOK) {
+		/* The file system may have written less than received. */
+		pagecache_range_t range = {
+			.pos = pos,
+			.size = min(ipc_get_arg1(answer), size),
+			.buf = buf
+		};
+
+		if (range.size > 0) {
+			(void) pagecache_node_apply(node, pagecache_overlaps,
+			    pagecache_cluster_update, &range);
+		}
+	}
+
+	free(buf);
+	return rc;
+}
+
+/** Drop cached data of a node beyond its new size.
+ *
+ * The caller must hold the contents lock of the node for writing.
+ *
+ * @param node VFS node
+ * @param size New size of the file
+ */
+void vfs_pagecache_truncate(vfs_node_t *node, aoff64_t size)
+{
+	list_t destroy;
+
+	list_initialize(&destroy);
+
+	fibril_mutex_lock(&pagecache_mutex);
+
+	list_foreach_safe(node->clusters, cur, next) {
+		vfs_cluster_t *cluster = list_get_instance(cur, vfs_cluster_t,
+		    node_link);
+
+		if (cluster->pos >= size) {
+			if (pagecache_cluster_remove(cluster))
+				list_append(&cluster->lru_link, &destroy);
+		} else if (cluster->pos + VFS_CLUSTER_SIZE > size &&
+		    cluster->valid) {
+			/*
+			 * The cluster is not being filled, the caller holds
+			 * the contents lock.
+			 */
+			size_t off = size - cluster->pos;
+			memset(cluster->data + off, 0, VFS_CLUSTER_SIZE - off);
+			if (cluster->clean != NULL) {
+				memset(cluster->clean + off, 0,
+				    VFS_CLUSTER_SIZE - off);
+			}
+		}
+	}
+
+	fibril_mutex_unlock(&pagecache_mutex);
+
+	list_foreach_safe(destroy, cur, next) {
+		list_remove(cur);
+		pagecache_cluster_destroy(list_get_instance(cur, vfs_cluster_t,
+		    lru_link));
+	}
+}
+
+/** Release all cached data of a node.
+ *
+ * Called when the last reference to the node goes away.
+ *
+ * @param node      VFS node
+ * @param writeback Write back clusters of shared mappings first
+ */
+void vfs_pagecache_release(vfs_node_t *node, bool writeback)
+{
+	if (writeback)
+		(void) vfs_pagecache_sync(node);
+
+	vfs_pagecache_truncate(node, 0);
+}
+
+/**
+ * @}
+ */
@@ -40,52 +40,85 @@
 #include <fibril_synch.h>
 #include <errno.h>
 #include <as.h>
+#include <macros.h>
+#include <mem.h>
 
+/** Handle a page-in request from the kernel.
+ *
+ * The pager object IDs are the file handle, VFS_PAGER_* flags and the offset
+ * of the mapping in the file in pages. The request is satisfied from the page
+ * cache. Up to the requested window of pages is handed out in one reply if
+ * the pages are in the same cache cluster.
+ *
+ * @param req Page-in request
+ */
 void vfs_page_in(ipc_call_t *req)
 {
 	aoff64_t offset = ipc_get_arg1(req);
-	size_t page_size = ipc_get_arg2(req);
+	size_t window = ipc_get_arg2(req) / PAGE_SIZE;
 	int fd = ipc_get_arg3(req);
-	void *page;
+	sysarg_t flags = ipc_get_arg4(req);
+	aoff64_t pos = (aoff64_t) ipc_get_arg5(req) * PAGE_SIZE + offset;
+	vfs_cluster_t *cluster;
 	errno_t rc;
 
-	page = as_area_create(AS_AREA_ANY, page_size,
-	    AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE,
-	    AS_AREA_UNPAGED);
+	vfs_file_t *file = vfs_file_get(fd);
+	if (!file) {
+		async_answer_0(req, EBADF);
+		return;
+	}
 
-	if (page == AS_MAP_FAILED) {
-		async_answer_0(req, ENOMEM);
+	if (!file->open_read || file->node->type != VFS_NODE_FILE ||
+	    ((flags & VFS_PAGER_SHARED_WRITE) && !file->open_write)) {
+		vfs_file_put(file);
+		async_answer_0(req, EPERM);
 		return;
 	}
 
-	rdwr_io_chunk_t chunk = {
-		.buffer = page,
-		.size = page_size
-	};
+	vfs_node_t *node = file->node;
+	vfs_node_addref(node);
+	vfs_file_put(file);
 
-	size_t total = 0;
-	aoff64_t pos = offset;
-	do {
-		rc = vfs_rdwr_internal(fd, pos, true, &chunk);
-		if (rc != EOK)
-			break;
-		if (chunk.size == 0)
-			break;
-		total += chunk.size;
-		pos += chunk.size;
-		chunk.buffer += chunk.size;
-		chunk.size = page_size - total;
-	} while (total < page_size);
+	rc = vfs_pagecache_get(node, pos, &cluster);
+	if (rc != EOK) {
+		vfs_node_put(node);
+		async_answer_0(req, rc);
+		return;
+	}
+
+	size_t first = (pos - cluster->pos) / PAGE_SIZE;
+	size_t count = min(max(window, 1), VFS_CLUSTER_PAGES - first);
+	uint8_t *page = cluster->data + first * PAGE_SIZE;
 
-	async_answer_1(req, rc, (sysarg_t) page);
+	if (flags & VFS_PAGER_PRIVATE) {
+		/*
+		 * Writes to a private mapping must not be seen by anybody
+		 * else, give the task its own copy of the pages.
+		 */
+		void *copy = as_area_create(AS_AREA_ANY, count * PAGE_SIZE,
+		    AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE,
+		    AS_AREA_UNPAGED);
+		if (copy == AS_MAP_FAILED) {
+			async_answer_0(req, ENOMEM);
+		} else {
+			memcpy(copy, page, count * PAGE_SIZE);
+			async_answer_2(req, EOK, (sysarg_t) copy, count);
+			/* The task holds its own references to the frames. */
+			as_area_destroy(copy);
+		}
+	} else {
+		rc = EOK;
+		if (flags & VFS_PAGER_SHARED_WRITE)
+			rc = vfs_pagecache_pin(cluster);
+
+		if (rc != EOK)
+			async_answer_0(req, rc);
+		else
+			async_answer_2(req, EOK, (sysarg_t) page, count);
+	}
 
-	/*
-	 * FIXME:
-	 * This is just for now until we implement proper page cache
-	 * management.  Not keeping the pages around in a cache results in
-	 * inherently non-coherent private mappings.
-	 */
-	as_area_destroy(page);
+	vfs_pagecache_put(cluster);
+	vfs_node_put(node);
 }
 
 /**